@@ -0,0 +1,202 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include "mongo/benchmark/benchmark.h"
+
+#include <iostream>
+
+#include "mongo/util/assert_util.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+namespace benchmark {
+
+    namespace {
+
+        /**
+         * Reads the CPU cycle counter.  Returns -1 on platforms without one;
+         * cycle figures are then omitted from the results.
+         */
+        inline long long cycleNow() {
+#if defined(__x86_64__) || defined(__i386__)
+            unsigned lo, hi;
+            __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+            return (static_cast<long long>(hi) << 32) | lo;
+#else
+            return -1;
+#endif
+        }
+
+    }  // namespace
+
+    BSONObj BenchmarkResult::toBSON() const {
+        BSONObjBuilder b;
+        b.append("name", name);
+        b.appendNumber("iterations", iterations);
+        b.appendNumber("totalMicros", totalMicros);
+        b.append("nsPerOp", nsPerOp);
+        if (cyclesPerOp >= 0)
+            b.append("cyclesPerOp", cyclesPerOp);
+        return b.obj();
+    }
+
+    Registry& Registry::get() {
+        static Registry instance;
+        return instance;
+    }
+
+    void Registry::add(const std::string& name, BenchmarkFn fn) {
+        bool inserted = _benchmarks.insert(std::make_pair(name, fn)).second;
+        fassert(17521, inserted);
+    }
+
+    std::vector<std::string> Registry::names() const {
+        std::vector<std::string> out;
+        for (std::map<std::string, BenchmarkFn>::const_iterator it = _benchmarks.begin();
+             it != _benchmarks.end(); ++it) {
+            out.push_back(it->first);
+        }
+        return out;
+    }
+
+    void Registry::run(const std::string& filter,
+                       const BenchmarkOptions& options,
+                       std::vector<BenchmarkResult>* results) const {
+        for (std::map<std::string, BenchmarkFn>::const_iterator it = _benchmarks.begin();
+             it != _benchmarks.end(); ++it) {
+            if (!filter.empty() && it->first.find(filter) == std::string::npos)
+                continue;
+
+            BenchmarkFn fn = it->second;
+
+            // Calibrate: grow the iteration count until one run takes at least
+            // options.minTimeMicros, so short operations aren't swamped by
+            // timer granularity.
+            long long iterations = 1;
+            long long micros = 0;
+            for (;;) {
+                Timer t;
+                fn(static_cast<int>(iterations));
+                micros = t.micros();
+                if (micros >= options.minTimeMicros)
+                    break;
+                long long next = iterations * 10;
+                if (micros > 0) {
+                    // aim straight for the target, with slack for noise
+                    long long direct = iterations * options.minTimeMicros / micros * 2;
+                    if (direct < next)
+                        next = direct;
+                }
+                if (next <= iterations)
+                    next = iterations + 1;
+                iterations = next;
+            }
+
+            // Measure: the fastest of several runs is the least disturbed one.
+            BenchmarkResult result;
+            result.name = it->first;
+            result.iterations = iterations;
+            result.totalMicros = micros;
+            long long bestCycles = -1;
+            for (int rep = 0; rep < options.repeat; rep++) {
+                Timer t;
+                const long long startCycles = cycleNow();
+                fn(static_cast<int>(iterations));
+                const long long endCycles = cycleNow();
+                const long long elapsed = t.micros();
+                if (elapsed < result.totalMicros) {
+                    result.totalMicros = elapsed;
+                    bestCycles = startCycles >= 0 ? endCycles - startCycles : -1;
+                }
+                else if (bestCycles < 0 && startCycles >= 0 && rep == 0) {
+                    bestCycles = endCycles - startCycles;
+                }
+            }
+            result.nsPerOp = result.totalMicros * 1000.0 / iterations;
+            result.cyclesPerOp =
+                bestCycles >= 0 ? static_cast<double>(bestCycles) / iterations : -1;
+
+            std::cout << result.name << "\t" << iterations << " ops\t"
+                      << result.nsPerOp << " ns/op";
+            if (result.cyclesPerOp >= 0)
+                std::cout << "\t" << result.cyclesPerOp << " cycles/op";
+            std::cout << std::endl;
+
+            results->push_back(result);
+        }
+    }
+
+    BSONObj resultsToBSON(const std::vector<BenchmarkResult>& results) {
+        BSONObjBuilder b;
+        b.append("version", 1);
+        BSONArrayBuilder arr(b.subarrayStart("benchmarks"));
+        for (size_t i = 0; i < results.size(); i++)
+            arr.append(results[i].toBSON());
+        arr.done();
+        return b.obj();
+    }
+
+    int compareToBaseline(const std::vector<BenchmarkResult>& results,
+                          const BSONObj& baseline,
+                          double regressionThreshold) {
+        uassert(17522, "baseline file has an unsupported layout",
+                baseline["version"].numberInt() == 1 &&
+                baseline["benchmarks"].type() == Array);
+
+        std::map<std::string, double> baselineNsPerOp;
+        BSONObjIterator it(baseline["benchmarks"].Obj());
+        while (it.more()) {
+            BSONObj entry = it.next().Obj();
+            baselineNsPerOp[entry["name"].String()] = entry["nsPerOp"].numberDouble();
+        }
+
+        int regressions = 0;
+        for (size_t i = 0; i < results.size(); i++) {
+            const BenchmarkResult& r = results[i];
+            std::map<std::string, double>::const_iterator base =
+                baselineNsPerOp.find(r.name);
+            if (base == baselineNsPerOp.end()) {
+                std::cout << r.name << "\tnot in baseline" << std::endl;
+                continue;
+            }
+            const double delta = base->second > 0
+                ? (r.nsPerOp - base->second) / base->second : 0;
+            std::cout << r.name << "\tbaseline " << base->second << " ns/op\tnow "
+                      << r.nsPerOp << " ns/op\t" << (delta >= 0 ? "+" : "")
+                      << delta * 100 << "%";
+            if (delta > regressionThreshold) {
+                std::cout << "\tREGRESSION";
+                regressions++;
+            }
+            std::cout << std::endl;
+        }
+        return regressions;
+    }
+
+}  // namespace benchmark
+}  // namespace mongo
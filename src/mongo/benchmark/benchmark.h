@@ -0,0 +1,138 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#pragma once
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+
+/**
+ * Microbenchmark harness.  Benchmark bodies are plain functions registered at
+ * static initialization time:
+ *
+ *     MONGO_BENCHMARK(BSONBuildFlat) {
+ *         for (int i = 0; i < iterations; i++) {
+ *             ... one measured operation ...
+ *         }
+ *     }
+ *
+ * The harness calibrates the iteration count until a timed run lasts long
+ * enough to be stable, reports the fastest of several runs, and can emit the
+ * results as JSON and compare them against a baseline file from an earlier
+ * run.  See benchmark_main.cpp for the command line driver.
+ */
+namespace mongo {
+namespace benchmark {
+
+    /** Tunables for a harness run; set from the command line by the driver. */
+    struct BenchmarkOptions {
+        BenchmarkOptions()
+            : minTimeMicros(500 * 1000),
+              repeat(3),
+              regressionThreshold(0.10) {}
+
+        long long minTimeMicros;    // grow the iteration count until a run lasts this long
+        int repeat;                 // timed runs per benchmark; the fastest is reported
+        double regressionThreshold; // fractional slowdown vs. baseline that counts as a regression
+    };
+
+    /** The body of a benchmark: performs the measured operation 'iterations' times. */
+    typedef void (*BenchmarkFn)(int iterations);
+
+    /** One timed benchmark result. */
+    struct BenchmarkResult {
+        BenchmarkResult() : iterations(0), totalMicros(0), nsPerOp(0), cyclesPerOp(-1) {}
+
+        std::string name;
+        long long iterations;  // of the reported (fastest) run
+        long long totalMicros; // wall time of the reported run
+        double nsPerOp;
+        double cyclesPerOp;    // from the CPU cycle counter; -1 when unavailable
+
+        BSONObj toBSON() const;
+    };
+
+    /** All registered benchmarks, keyed by name. */
+    class Registry {
+    public:
+        static Registry& get();
+
+        /** Fails at startup on duplicate names. */
+        void add(const std::string& name, BenchmarkFn fn);
+
+        std::vector<std::string> names() const;
+
+        /**
+         * Runs every benchmark whose name contains 'filter' (every benchmark when
+         * 'filter' is empty), appending one entry per benchmark to 'results'.
+         */
+        void run(const std::string& filter,
+                 const BenchmarkOptions& options,
+                 std::vector<BenchmarkResult>* results) const;
+
+    private:
+        std::map<std::string, BenchmarkFn> _benchmarks;
+    };
+
+    /** Helper for MONGO_BENCHMARK; constructed once per benchmark at startup. */
+    class Registration {
+    public:
+        Registration(const std::string& name, BenchmarkFn fn) {
+            Registry::get().add(name, fn);
+        }
+    };
+
+    /**
+     * Wraps 'results' in the document layout written to --output and read back
+     * by --baseline: { version: 1, benchmarks: [ ... ] }.
+     */
+    BSONObj resultsToBSON(const std::vector<BenchmarkResult>& results);
+
+    /**
+     * Compares 'results' against 'baseline' (a document from resultsToBSON),
+     * logging a per-benchmark comparison.  Returns the number of benchmarks
+     * slower than their baseline nsPerOp by more than the threshold; benchmarks
+     * missing from the baseline are reported but never counted.
+     */
+    int compareToBaseline(const std::vector<BenchmarkResult>& results,
+                          const BSONObj& baseline,
+                          double regressionThreshold);
+
+#define MONGO_BENCHMARK(NAME)                                                \
+    static void benchmark_##NAME(int iterations);                            \
+    namespace {                                                              \
+        ::mongo::benchmark::Registration registration_##NAME(                \
+                #NAME, benchmark_##NAME);                                    \
+    }                                                                        \
+    static void benchmark_##NAME(int iterations)
+
+}  // namespace benchmark
+}  // namespace mongo
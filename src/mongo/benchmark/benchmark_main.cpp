@@ -0,0 +1,156 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/**
+ * Command line driver for the microbenchmark harness.
+ *
+ *     benchmark [--filter=SUBSTRING] [--output=FILE] [--baseline=FILE]
+ *               [--threshold=FRACTION] [--minTimeMicros=N] [--repeat=N] [--list]
+ *
+ * --output writes the results as JSON; a later run can read that file back with
+ * --baseline to flag regressions.  The exit code is the number of regressions,
+ * so a build can gate on it directly.
+ */
+
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "mongo/base/initializer.h"
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/db/json.h"
+
+using namespace mongo;
+
+namespace {
+
+    bool parseFlag(const std::string& arg, const std::string& name, std::string* value) {
+        const std::string prefix = "--" + name + "=";
+        if (arg.compare(0, prefix.size(), prefix) != 0)
+            return false;
+        *value = arg.substr(prefix.size());
+        return true;
+    }
+
+    void usage() {
+        std::cout << "usage: benchmark [--filter=SUBSTRING] [--output=FILE]\n"
+                  << "                 [--baseline=FILE] [--threshold=FRACTION]\n"
+                  << "                 [--minTimeMicros=N] [--repeat=N] [--list]"
+                  << std::endl;
+    }
+
+}  // namespace
+
+int main(int argc, char** argv, char** envp) {
+    runGlobalInitializersOrDie(argc, argv, envp);
+
+    benchmark::BenchmarkOptions options;
+    std::string filter;
+    std::string outputFile;
+    std::string baselineFile;
+    bool listOnly = false;
+
+    for (int i = 1; i < argc; i++) {
+        const std::string arg = argv[i];
+        std::string value;
+        if (arg == "--list") {
+            listOnly = true;
+        }
+        else if (arg == "--help" || arg == "-h") {
+            usage();
+            return EXIT_SUCCESS;
+        }
+        else if (parseFlag(arg, "filter", &value)) {
+            filter = value;
+        }
+        else if (parseFlag(arg, "output", &value)) {
+            outputFile = value;
+        }
+        else if (parseFlag(arg, "baseline", &value)) {
+            baselineFile = value;
+        }
+        else if (parseFlag(arg, "threshold", &value)) {
+            options.regressionThreshold = atof(value.c_str());
+        }
+        else if (parseFlag(arg, "minTimeMicros", &value)) {
+            options.minTimeMicros = atoll(value.c_str());
+        }
+        else if (parseFlag(arg, "repeat", &value)) {
+            options.repeat = atoi(value.c_str());
+        }
+        else {
+            std::cerr << "unknown option: " << arg << std::endl;
+            usage();
+            return EXIT_FAILURE;
+        }
+    }
+
+    if (listOnly) {
+        const std::vector<std::string> names = benchmark::Registry::get().names();
+        for (size_t i = 0; i < names.size(); i++)
+            std::cout << names[i] << std::endl;
+        return EXIT_SUCCESS;
+    }
+
+    std::vector<benchmark::BenchmarkResult> results;
+    benchmark::Registry::get().run(filter, options, &results);
+    if (results.empty()) {
+        std::cerr << "no benchmarks matched filter: " << filter << std::endl;
+        return EXIT_FAILURE;
+    }
+
+    if (!outputFile.empty()) {
+        std::ofstream out(outputFile.c_str());
+        if (!out) {
+            std::cerr << "couldn't open output file: " << outputFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        out << benchmark::resultsToBSON(results).jsonString(Strict, 1) << std::endl;
+    }
+
+    int regressions = 0;
+    if (!baselineFile.empty()) {
+        std::ifstream in(baselineFile.c_str());
+        if (!in) {
+            std::cerr << "couldn't open baseline file: " << baselineFile << std::endl;
+            return EXIT_FAILURE;
+        }
+        std::stringstream contents;
+        contents << in.rdbuf();
+        regressions = benchmark::compareToBaseline(results,
+                                                   fromjson(contents.str()),
+                                                   options.regressionThreshold);
+        if (regressions > 0)
+            std::cerr << regressions << " benchmark(s) regressed" << std::endl;
+    }
+
+    return regressions;
+}
@@ -0,0 +1,127 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/** Benchmarks for BSON building, validation and traversal. */
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/bson/bson_validate.h"
+#include "mongo/db/jsobj.h"
+
+namespace {
+
+    using namespace mongo;
+
+    BSONObj makeFlatObj() {
+        BSONObjBuilder b;
+        b.append("_id", OID::gen());
+        b.append("name", "benchmark document");
+        b.append("count", 12345);
+        b.append("total", 987654321LL);
+        b.append("ratio", 0.577215664901);
+        b.append("active", true);
+        b.appendDate("when", 1370023370000LL);
+        return b.obj();
+    }
+
+    BSONObj makeNestedObj() {
+        return BSON("_id" << OID::gen()
+                    << "header" << BSON("op" << "i" << "ns" << "bench.coll" << "v" << 2)
+                    << "payload" << BSON("x" << 1 << "y" << BSON_ARRAY(1 << 2 << 3 << 4)
+                                         << "z" << BSON("deep" << "er" << "deeper" << 2.5))
+                    << "trailer" << "the end");
+    }
+
+}  // namespace
+
+namespace mongo {
+
+    MONGO_BENCHMARK(BSONBuildFlat) {
+        for (int i = 0; i < iterations; i++) {
+            BSONObjBuilder b;
+            b.append("_id", i);
+            b.append("name", "benchmark document");
+            b.append("count", i);
+            b.append("total", 987654321LL);
+            b.append("ratio", 0.577215664901);
+            b.append("active", true);
+            BSONObj o = b.obj();
+            verify(!o.isEmpty());
+        }
+    }
+
+    MONGO_BENCHMARK(BSONBuildNested) {
+        for (int i = 0; i < iterations; i++) {
+            BSONObjBuilder b;
+            b.append("_id", i);
+            {
+                BSONObjBuilder header(b.subobjStart("header"));
+                header.append("op", "i");
+                header.append("ns", "bench.coll");
+                header.append("v", 2);
+                header.done();
+            }
+            {
+                BSONArrayBuilder arr(b.subarrayStart("values"));
+                for (int j = 0; j < 8; j++)
+                    arr.append(j);
+                arr.done();
+            }
+            BSONObj o = b.obj();
+            verify(!o.isEmpty());
+        }
+    }
+
+    MONGO_BENCHMARK(BSONValidate) {
+        const BSONObj obj = makeNestedObj();
+        for (int i = 0; i < iterations; i++) {
+            Status s = validateBSON(obj.objdata(), obj.objsize());
+            verify(s.isOK());
+        }
+    }
+
+    MONGO_BENCHMARK(BSONIterate) {
+        const BSONObj obj = makeNestedObj();
+        long long total = 0;
+        for (int i = 0; i < iterations; i++) {
+            BSONObjIterator it(obj);
+            while (it.more())
+                total += it.next().size();
+        }
+        verify(total > 0);
+    }
+
+    MONGO_BENCHMARK(BSONFieldLookup) {
+        const BSONObj obj = makeFlatObj();
+        long long total = 0;
+        for (int i = 0; i < iterations; i++) {
+            total += obj["total"].numberLong();
+        }
+        verify(total != 0);
+    }
+
+}  // namespace mongo
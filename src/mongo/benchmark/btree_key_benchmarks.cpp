@@ -0,0 +1,84 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/**
+ * Benchmarks for btree key packing and comparison — the CPU cost that
+ * dominates both btree insert and search.  Exercising the buckets themselves
+ * requires an initialized storage context, so that stays in the dbtests perf
+ * cases.
+ */
+
+#include <vector>
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/structure/btree/key.h"
+
+namespace {
+
+    using namespace mongo;
+
+    std::vector<BSONObj> makeKeyObjs(int n) {
+        std::vector<BSONObj> out;
+        for (int i = 0; i < n; i++)
+            out.push_back(BSON("" << (i * 7919 % n) << "" << "suffix"));
+        return out;
+    }
+
+}  // namespace
+
+namespace mongo {
+
+    MONGO_BENCHMARK(BtreeKeyPack) {
+        const std::vector<BSONObj> objs = makeKeyObjs(64);
+        for (int i = 0; i < iterations; i++) {
+            KeyV1Owned key(objs[i % objs.size()]);
+            verify(key.dataSize() > 0);
+        }
+    }
+
+    MONGO_BENCHMARK(BtreeKeyCompare) {
+        const Ordering ordering = Ordering::make(BSON("a" << 1 << "b" << 1));
+        const std::vector<BSONObj> objs = makeKeyObjs(64);
+        std::vector<KeyV1Owned*> keys;
+        for (size_t i = 0; i < objs.size(); i++)
+            keys.push_back(new KeyV1Owned(objs[i]));
+
+        long long total = 0;
+        for (int i = 0; i < iterations; i++) {
+            const KeyV1Owned& l = *keys[i % keys.size()];
+            const KeyV1Owned& r = *keys[(i + 1) % keys.size()];
+            total += l.woCompare(r, ordering);
+        }
+        verify(total != 0 || iterations < 2);
+
+        for (size_t i = 0; i < keys.size(); i++)
+            delete keys[i];
+    }
+
+}  // namespace mongo
@@ -0,0 +1,84 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/**
+ * Benchmarks for the CPU-bound parts of journal section preparation: the
+ * write-intent buffer assembly and section checksumming.  The full PREPLOGBUFFER
+ * path needs durability started up, so it stays in the dbtests perf cases.
+ */
+
+#include <vector>
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/util/alignedbuilder.h"
+#include "mongo/util/checksum.h"
+
+namespace {
+
+    std::vector<char> makeBuffer(size_t size) {
+        std::vector<char> buf(size);
+        for (size_t i = 0; i < size; i++)
+            buf[i] = static_cast<char>(i * 131);
+        return buf;
+    }
+
+}  // namespace
+
+namespace mongo {
+
+    MONGO_BENCHMARK(JournalChecksumSmall) {
+        const std::vector<char> buf = makeBuffer(8 * 1024);
+        for (int i = 0; i < iterations; i++) {
+            Checksum c;
+            c.gen(&buf[0], buf.size());
+        }
+    }
+
+    MONGO_BENCHMARK(JournalChecksumLarge) {
+        const std::vector<char> buf = makeBuffer(1024 * 1024);
+        for (int i = 0; i < iterations; i++) {
+            Checksum c;
+            c.gen(&buf[0], buf.size());
+        }
+    }
+
+    MONGO_BENCHMARK(JournalIntentAssembly) {
+        // mimics the per-commit copy pattern: many small intents appended into
+        // one aligned section buffer
+        const std::vector<char> intent = makeBuffer(200);
+        for (int i = 0; i < iterations; i++) {
+            AlignedBuilder b(32 * 1024);
+            for (int j = 0; j < 128; j++) {
+                b.appendNum(static_cast<int>(intent.size()));
+                b.appendBuf(&intent[0], intent.size());
+            }
+            verify(b.len() > 0);
+        }
+    }
+
+}  // namespace mongo
@@ -0,0 +1,95 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/** Benchmarks for match expression parsing and evaluation. */
+
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_parser.h"
+
+namespace {
+
+    using namespace mongo;
+
+    MatchExpression* parseOrDie(const BSONObj& query) {
+        StatusWithMatchExpression result = MatchExpressionParser::parse(query);
+        verify(result.isOK());
+        return result.getValue();
+    }
+
+}  // namespace
+
+namespace mongo {
+
+    MONGO_BENCHMARK(MatcherParseSimple) {
+        const BSONObj query = BSON("a" << BSON("$gt" << 5) << "b" << "needle");
+        for (int i = 0; i < iterations; i++) {
+            boost::scoped_ptr<MatchExpression> me(parseOrDie(query));
+        }
+    }
+
+    MONGO_BENCHMARK(MatcherEvalEquality) {
+        boost::scoped_ptr<MatchExpression> me(parseOrDie(BSON("b" << "needle")));
+        const BSONObj matching = BSON("a" << 1 << "b" << "needle" << "c" << 3);
+        const BSONObj nonMatching = BSON("a" << 1 << "b" << "haystack" << "c" << 3);
+        int hits = 0;
+        for (int i = 0; i < iterations; i++) {
+            if (me->matchesBSON(i % 2 ? matching : nonMatching))
+                hits++;
+        }
+        verify(hits > 0 || iterations < 2);
+    }
+
+    MONGO_BENCHMARK(MatcherEvalRange) {
+        boost::scoped_ptr<MatchExpression> me(
+                parseOrDie(BSON("a" << BSON("$gte" << 100 << "$lt" << 200))));
+        int hits = 0;
+        for (int i = 0; i < iterations; i++) {
+            if (me->matchesBSON(BSON("a" << (i % 300))))
+                hits++;
+        }
+        verify(hits > 0 || iterations < 200);
+    }
+
+    MONGO_BENCHMARK(MatcherEvalCompound) {
+        boost::scoped_ptr<MatchExpression> me(parseOrDie(
+                BSON("$or" << BSON_ARRAY(BSON("a" << BSON("$in" << BSON_ARRAY(1 << 3 << 5 << 7)))
+                                         << BSON("b.c" << BSON("$exists" << true))))));
+        const BSONObj doc = BSON("a" << 2 << "b" << BSON("c" << "here"));
+        int hits = 0;
+        for (int i = 0; i < iterations; i++) {
+            if (me->matchesBSON(doc))
+                hits++;
+        }
+        verify(hits == iterations);
+    }
+
+}  // namespace mongo
@@ -0,0 +1,81 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/** Benchmarks for wire message assembly and parsing. */
+
+#include <cstring>
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/db/dbmessage.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/net/message.h"
+
+namespace {
+
+    using namespace mongo;
+
+    const char* const kNs = "bench.coll";
+
+    void buildInsertMessage(Message* out, int ndocs) {
+        BufBuilder b;
+        b.appendNum(0); // reserved
+        b.appendStr(kNs);
+        for (int i = 0; i < ndocs; i++) {
+            BSONObj doc = BSON("_id" << i << "payload" << "forty two bytes of assorted text here"
+                               << "n" << i * 2);
+            b.appendBuf(doc.objdata(), doc.objsize());
+        }
+        out->setData(dbInsert, b.buf(), b.len());
+    }
+
+}  // namespace
+
+namespace mongo {
+
+    MONGO_BENCHMARK(MessageAssembleInsert) {
+        for (int i = 0; i < iterations; i++) {
+            Message m;
+            buildInsertMessage(&m, 10);
+            verify(!m.empty());
+        }
+    }
+
+    MONGO_BENCHMARK(MessageParseInsert) {
+        Message m;
+        buildInsertMessage(&m, 10);
+        long long total = 0;
+        for (int i = 0; i < iterations; i++) {
+            DbMessage d(m);
+            verify(strcmp(d.getns(), kNs) == 0);
+            while (d.moreJSObjs())
+                total += d.nextJsObj().objsize();
+        }
+        verify(total > 0);
+    }
+
+}  // namespace mongo
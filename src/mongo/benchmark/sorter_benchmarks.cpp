@@ -0,0 +1,117 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/** Benchmarks for the external sorter: in-memory sort, spill to disk, merge. */
+
+#include "mongo/platform/basic.h"
+
+#include "mongo/db/sorter/sorter.h"
+
+#include <boost/filesystem.hpp>
+#include <boost/scoped_ptr.hpp>
+
+#include "mongo/benchmark/benchmark.h"
+
+// Need access to the template implementation, as in sorter_test.cpp
+#include "mongo/db/sorter/sorter.cpp"
+
+namespace {
+
+    using namespace mongo;
+    using namespace mongo::sorter;
+
+    class IntWrapper {
+    public:
+        IntWrapper(int i = 0) : _i(i) {}
+        operator const int&() const { return _i; }
+
+        /// members for Sorter
+        struct SorterDeserializeSettings {}; // unused
+        void serializeForSorter(BufBuilder& buf) const { buf.appendNum(_i); }
+        static IntWrapper deserializeForSorter(BufReader& buf,
+                                               const SorterDeserializeSettings&) {
+            return buf.read<int>();
+        }
+        int memUsageForSorter() const { return sizeof(IntWrapper); }
+        IntWrapper getOwned() const { return *this; }
+
+    private:
+        int _i;
+    };
+
+    typedef std::pair<IntWrapper, IntWrapper> IWPair;
+    typedef SortIteratorInterface<IntWrapper, IntWrapper> IWIterator;
+    typedef Sorter<IntWrapper, IntWrapper> IWSorter;
+
+    class IWComparator {
+    public:
+        int operator()(const IWPair& lhs, const IWPair& rhs) const {
+            if (lhs.first == rhs.first)
+                return 0;
+            return lhs.first < rhs.first ? -1 : 1;
+        }
+    };
+
+    const char* const kTempDir = "benchmark_sorter_tmp";
+
+    /** Sorts 'n' pseudo-randomly ordered pairs through the sorter and drains it. */
+    void sortN(int n, const SortOptions& opts) {
+        boost::scoped_ptr<IWSorter> sorter(IWSorter::make(opts, IWComparator()));
+        for (int j = 0; j < n; j++)
+            sorter->add(j * 7919 % n, j);
+        boost::scoped_ptr<IWIterator> it(sorter->done());
+        int last = -1;
+        while (it->more()) {
+            IWPair p = it->next();
+            verify(last <= p.first);
+            last = p.first;
+        }
+        verify(last == n - 1);
+    }
+
+}  // namespace
+
+namespace mongo {
+
+    MONGO_BENCHMARK(SorterInMemory) {
+        for (int i = 0; i < iterations; i++)
+            sortN(10 * 1000, SortOptions());
+    }
+
+    MONGO_BENCHMARK(SorterSpillAndMerge) {
+        // a deliberately tiny memory limit forces several spills and a file merge
+        const SortOptions opts = SortOptions()
+                                     .MaxMemoryUsageBytes(16 * 1024)
+                                     .ExtSortAllowed()
+                                     .TempDir(kTempDir);
+        for (int i = 0; i < iterations; i++)
+            sortN(10 * 1000, opts);
+        boost::filesystem::remove_all(kTempDir);
+    }
+
+}  // namespace mongo
@@ -0,0 +1,73 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+/** Benchmarks for WorkingSet member churn, as seen by query execution stages. */
+
+#include "mongo/benchmark/benchmark.h"
+#include "mongo/db/exec/working_set.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    MONGO_BENCHMARK(WorkingSetAllocFree) {
+        WorkingSet ws;
+        for (int i = 0; i < iterations; i++) {
+            WorkingSetID id = ws.allocate();
+            ws.free(id);
+        }
+    }
+
+    MONGO_BENCHMARK(WorkingSetOwnedObjChurn) {
+        WorkingSet ws;
+        const BSONObj obj = BSON("_id" << 1 << "a" << "some owned payload" << "b" << 2.5);
+        for (int i = 0; i < iterations; i++) {
+            WorkingSetID id = ws.allocate();
+            WorkingSetMember* member = ws.get(id);
+            member->obj = obj;
+            member->state = WorkingSetMember::OWNED_OBJ;
+            ws.free(id);
+        }
+    }
+
+    MONGO_BENCHMARK(WorkingSetFieldDotted) {
+        WorkingSet ws;
+        WorkingSetID id = ws.allocate();
+        WorkingSetMember* member = ws.get(id);
+        member->obj = BSON("a" << BSON("b" << BSON("c" << 42)));
+        member->state = WorkingSetMember::OWNED_OBJ;
+        long long total = 0;
+        for (int i = 0; i < iterations; i++) {
+            BSONElement e;
+            if (member->getFieldDotted("a.b.c", &e))
+                total += e.numberLong();
+        }
+        ws.free(id);
+        verify(total == 42LL * iterations);
+    }
+
+}  // namespace mongo
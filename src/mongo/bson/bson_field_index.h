@@ -0,0 +1,120 @@
+/* bson_field_index.h */
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/bson/bsonobj.h"
+#include "mongo/bson/bsonobjiterator.h"
+
+namespace mongo {
+
+    /**
+     * A side table of fieldname->offset for a single BSONObj, turning repeated
+     * getField() calls (each a linear scan) into O(1) hash probes.
+     *
+     * The table is open-addressed with linear probing and is built lazily: the first
+     * getField() call walks the object once and records every top-level element's
+     * offset.  Worth using whenever several fields are extracted from the same wide
+     * document, e.g. multi-field projections or compound index key generation.
+     *
+     * The index does not own the object's buffer; the BSONObj it was given must stay
+     * valid (and unmodified) for the life of the index.
+     */
+    class BSONFieldIndex {
+    public:
+        BSONFieldIndex() {}
+
+        explicit BSONFieldIndex( const BSONObj& obj ) : _obj( obj ) {}
+
+        /** Points the index at a new object; the table is rebuilt lazily. */
+        void reset( const BSONObj& obj ) {
+            _obj = obj;
+            _table.clear();
+        }
+
+        /** As BSONObj::getField(): returns eoo if the field is missing. */
+        BSONElement getField( const StringData& name ) const {
+            if ( _table.empty() )
+                _build();
+            if ( _table.size() == 1 ) // sentinel: object is empty
+                return BSONElement();
+            const unsigned mask = _table.size() - 1;
+            unsigned slot = _hash( name ) & mask;
+            while ( true ) {
+                const unsigned offsetPlusOne = _table[slot];
+                if ( offsetPlusOne == 0 )
+                    return BSONElement();
+                BSONElement e( _obj.objdata() + ( offsetPlusOne - 1 ) );
+                if ( name == StringData( e.fieldName(), e.fieldNameSize() - 1 ) )
+                    return e;
+                slot = ( slot + 1 ) & mask;
+            }
+        }
+
+        bool hasField( const StringData& name ) const {
+            return !getField( name ).eoo();
+        }
+
+    private:
+        static unsigned _hash( const StringData& name ) {
+            // FNV-1a
+            unsigned h = 2166136261U;
+            for ( size_t i = 0; i < name.size(); i++ ) {
+                h ^= static_cast<unsigned char>( name[i] );
+                h *= 16777619U;
+            }
+            return h;
+        }
+
+        void _build() const {
+            int n = 0;
+            {
+                BSONObjIterator it( _obj );
+                while ( it.more() ) {
+                    it.next();
+                    n++;
+                }
+            }
+            if ( n == 0 ) {
+                _table.resize( 1 ); // sentinel so we don't rebuild every call
+                return;
+            }
+            // power of two, load factor <= 0.5
+            unsigned capacity = 4;
+            while ( capacity < static_cast<unsigned>( n ) * 2 )
+                capacity *= 2;
+            _table.assign( capacity, 0 );
+            const unsigned mask = capacity - 1;
+
+            BSONObjIterator it( _obj );
+            while ( it.more() ) {
+                BSONElement e = it.next();
+                unsigned slot = _hash( StringData( e.fieldName(),
+                                                   e.fieldNameSize() - 1 ) ) & mask;
+                while ( _table[slot] != 0 )
+                    slot = ( slot + 1 ) & mask;
+                _table[slot] = static_cast<unsigned>( e.rawdata() - _obj.objdata() ) + 1;
+            }
+        }
+
+        BSONObj _obj;
+        mutable std::vector<unsigned> _table;
+    };
+
+} // namespace mongo
@@ -0,0 +1,67 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/db/jsobj.h"
+#include "mongo/bson/bson_field_index.h"
+#include "mongo/unittest/unittest.h"
+#include "mongo/util/mongoutils/str.h"
+
+namespace {
+
+    using namespace mongo;
+
+    TEST( BSONFieldIndex, Basic ) {
+        BSONObj obj = BSON( "a" << 1 << "b" << "two" << "c" << BSON( "x" << 1 ) );
+        BSONFieldIndex idx( obj );
+
+        ASSERT_EQUALS( 1, idx.getField( "a" ).numberInt() );
+        ASSERT_EQUALS( std::string( "two" ), idx.getField( "b" ).str() );
+        ASSERT_EQUALS( 1, idx.getField( "c" ).Obj()["x"].numberInt() );
+        ASSERT_TRUE( idx.getField( "missing" ).eoo() );
+        ASSERT_TRUE( idx.hasField( "a" ) );
+        ASSERT_FALSE( idx.hasField( "x" ) ); // nested fields are not indexed
+    }
+
+    TEST( BSONFieldIndex, EmptyObject ) {
+        BSONObj empty;
+        BSONFieldIndex idx( empty );
+        ASSERT_TRUE( idx.getField( "a" ).eoo() );
+    }
+
+    TEST( BSONFieldIndex, WideDocument ) {
+        BSONObjBuilder bob;
+        for ( int i = 0; i < 200; i++ ) {
+            const std::string name = mongoutils::str::stream() << "field" << i;
+            bob.append( name, i );
+        }
+        BSONObj obj = bob.obj();
+
+        BSONFieldIndex idx( obj );
+        for ( int i = 0; i < 200; i++ ) {
+            const std::string name = mongoutils::str::stream() << "field" << i;
+            ASSERT_EQUALS( i, idx.getField( name ).numberInt() );
+        }
+        ASSERT_TRUE( idx.getField( "field200" ).eoo() );
+    }
+
+    TEST( BSONFieldIndex, Reset ) {
+        BSONFieldIndex idx( BSON( "a" << 1 ) );
+        ASSERT_EQUALS( 1, idx.getField( "a" ).numberInt() );
+        idx.reset( BSON( "b" << 2 ) );
+        ASSERT_TRUE( idx.getField( "a" ).eoo() );
+        ASSERT_EQUALS( 2, idx.getField( "b" ).numberInt() );
+    }
+
+}  // namespace
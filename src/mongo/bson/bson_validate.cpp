@@ -18,6 +18,11 @@
 #include <cstring>
 #include <deque>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define MONGO_BSON_VALIDATE_SSE2 1
+#include <emmintrin.h>
+#endif
+
 #include "mongo/bson/bson_validate.h"
 #include "mongo/bson/oid.h"
 #include "mongo/db/jsobj.h"
@@ -26,6 +31,47 @@ namespace mongo {
 
     namespace {
 
+        /**
+         * Returns a pointer to the first NUL byte in [ p, end ), or NULL if there isn't one.
+         *
+         * This is the hot loop of validation: every element has a c-string field name, so on
+         * ingest-heavy workloads we scan terminators in 16-byte chunks rather than
+         * byte-by-byte.  SSE2 is part of the x86-64 baseline so the vector path needs no
+         * runtime dispatch; other architectures use an 8-byte SWAR scan.
+         */
+        inline const char* scanForNul( const char* p, const char* end ) {
+#if defined(MONGO_BSON_VALIDATE_SSE2)
+            const __m128i zero = _mm_setzero_si128();
+            while ( p + 16 <= end ) {
+                const __m128i chunk = _mm_loadu_si128( reinterpret_cast<const __m128i*>( p ) );
+                const int mask = _mm_movemask_epi8( _mm_cmpeq_epi8( chunk, zero ) );
+                if ( mask )
+                    return p + __builtin_ctz( mask );
+                p += 16;
+            }
+#else
+            // SWAR: a byte is zero iff (v - 0x01..) & ~v & 0x80.. has its high bit set.
+            while ( p + 8 <= end ) {
+                uint64_t v;
+                memcpy( &v, p, 8 );
+                const uint64_t found = ( v - 0x0101010101010101ULL ) & ~v & 0x8080808080808080ULL;
+                if ( found ) {
+                    for ( int i = 0; i < 8; i++ ) {
+                        if ( p[i] == 0 )
+                            return p + i;
+                    }
+                }
+                p += 8;
+            }
+#endif
+            while ( p < end ) {
+                if ( *p == 0 )
+                    return p;
+                p++;
+            }
+            return NULL;
+        }
+
         /**
          * Creates a status with InvalidBSON code and adds information about _id if available.
          * WARNING: only pass in a non-EOO idElem if it has been fully validated already!
@@ -43,13 +89,16 @@ namespace mongo {
         class Buffer {
         public:
             Buffer( const char* buffer, uint64_t maxLength )
-                : _buffer( buffer ), _position( 0 ), _maxLength( maxLength ) {
+                : _buffer( buffer ), _position( 0 ), _maxLength( maxLength ),
+                  _hitEnd( false ) {
             }
 
             template<typename N>
             bool readNumber( N* out ) {
-                if ( ( _position + sizeof(N) ) > _maxLength )
+                if ( ( _position + sizeof(N) ) > _maxLength ) {
+                    _hitEnd = true;
                     return false;
+                }
                 if ( out ) {
                     const N* temp = reinterpret_cast<const N*>(_buffer + _position);
                     *out = *temp;
@@ -59,10 +108,12 @@ namespace mongo {
             }
 
             Status readCString( StringData* out ) {
-                const void* x = memchr( _buffer + _position, 0, _maxLength - _position );
-                if ( !x )
+                const char* x = scanForNul( _buffer + _position, _buffer + _maxLength );
+                if ( !x ) {
+                    _hitEnd = true;
                     return makeError("no end of c-string", _idElem);
-                uint64_t len = static_cast<uint64_t>( static_cast<const char*>(x) - ( _buffer + _position ) );
+                }
+                uint64_t len = static_cast<uint64_t>( x - ( _buffer + _position ) );
 
                 StringData data( _buffer + _position, len );
                 _position += len + 1;
@@ -97,13 +148,29 @@ namespace mongo {
 
             bool skip( uint64_t sz ) {
                 _position += sz;
-                return _position < _maxLength;
+                if ( _position >= _maxLength ) {
+                    _hitEnd = true;
+                    return false;
+                }
+                return true;
             }
 
             uint64_t position() const {
                 return _position;
             }
 
+            void setPosition( uint64_t position ) {
+                _position = position;
+            }
+
+            /**
+             * True if a read has failed because it ran off the end of the buffer, i.e. the
+             * data seen so far may still be a valid prefix of a larger object.
+             */
+            bool hitEnd() const {
+                return _hitEnd;
+            }
+
             const char* getBasePtr() const {
                 return _buffer;
             }
@@ -119,6 +186,7 @@ namespace mongo {
             const char* _buffer;
             uint64_t _position;
             uint64_t _maxLength;
+            bool _hitEnd;
             BSONElement _idElem;
         };
 
@@ -177,6 +245,31 @@ namespace mongo {
             if ( !status.isOK() )
                 return status;
 
+            // Fast path for fixed-width types: a table lookup instead of the full switch.
+            // Runs of numeric/date/oid elements (the common case in machine-generated
+            // documents) take only this branch per element.  0 means "not fixed width".
+            static const uint8_t fixedWidths[JSTypeMax + 1] = {
+                0,                // EOO
+                sizeof(int64_t),  // NumberDouble
+                0,                // String
+                0, 0, 0,          // Object, Array, BinData
+                0,                // Undefined (no payload, handled below)
+                sizeof(OID),      // jstOID
+                sizeof(int8_t),   // Bool
+                sizeof(int64_t),  // Date
+                0,                // jstNULL (no payload, handled below)
+                0, 0, 0, 0,       // RegEx, DBRef, Code, Symbol
+                0,                // CodeWScope
+                sizeof(int32_t),  // NumberInt
+                sizeof(int64_t),  // Timestamp
+                sizeof(int64_t),  // NumberLong
+            };
+            if ( type > 0 && type <= JSTypeMax && fixedWidths[type] ) {
+                if ( !buffer->skip( fixedWidths[type] ) )
+                    return makeError("invalid bson", idElem);
+                return Status::OK();
+            }
+
             switch ( type ) {
             case MinKey:
             case MaxKey:
@@ -254,104 +347,194 @@ namespace mongo {
             }
         }
 
-        Status validateBSONIterative(Buffer* buffer) {
-            std::deque<ValidationObjectFrame> frames;
-            ValidationObjectFrame* curr = NULL;
-            ValidationState::State state = ValidationState::BeginObj;
+        /**
+         * The validation state machine, factored out of validateBSONIterative so that a
+         * streaming caller can suspend it at an element boundary when the buffer runs dry
+         * and resume once more bytes have arrived.
+         */
+        class ValidationMachine {
+        public:
+            ValidationMachine()
+                : _state( ValidationState::BeginObj ), _idElemStartPos( 0 ), _idElemPos( 0 ),
+                  _hasDuplicateId( false ), _hasDollarField( false ),
+                  _hasZeroTimestamp( false ) {
+            }
 
-            uint64_t idElemStartPos = 0; // will become idElem once validated
-            BSONElement idElem;
+            /**
+             * Runs until done, error, or -- when 'streaming' -- until more data is needed.
+             * In the streaming case the machine rolls back to the start of the element it
+             * could not finish, sets *suspended, and returns OK; call run() again with a
+             * longer buffer to resume.
+             */
+            Status run( Buffer* buffer, bool streaming, bool* suspended );
 
-            while (state != ValidationState::Done) {
-                switch (state) {
-                case ValidationState::BeginObj:
-                    frames.push_back(ValidationObjectFrame());
-                    curr = &frames.back();
-                    curr->setStartPosition(buffer->position());
-                    curr->setIsCodeWithScope(false);
-                    if (!buffer->readNumber<int>(&curr->expectedSize)) {
-                        return makeError("bson size is larger than buffer size", idElem);
-                    }
-                    state = ValidationState::WithinObj;
-                    // fall through
-                case ValidationState::WithinObj: {
-                    const bool atTopLevel = frames.size() == 1;
-                    // check if we've finished validating idElem and are at start of next element.
-                    if (atTopLevel && idElemStartPos) {
-                        idElem = BSONElement(buffer->getBasePtr() + idElemStartPos);
-                        buffer->setIdElem(idElem);
-                        idElemStartPos = 0;
-                    }
+            bool done() const { return _state == ValidationState::Done; }
 
-                    const uint64_t elemStartPos = buffer->position();
-                    ValidationState::State nextState = state;
-                    Status status = validateElementInfo(buffer, &nextState, idElem);
-                    if (!status.isOK())
-                        return status;
-
-                    // we've already validated that fieldname is safe to access as long as we aren't
-                    // at the end of the object, since EOO doesn't have a fieldname.
-                    if (nextState != ValidationState::EndObj && idElem.eoo() && atTopLevel) {
-                        if (strcmp(buffer->getBasePtr() + elemStartPos + 1/*type*/, "_id") == 0) {
-                            idElemStartPos = elemStartPos;
-                        }
+            /** per-document facts noticed during the scan; meaningful once done() */
+            void fillInfo( ValidatedDocInfo* info ) const {
+                info->idOffset = _idElemPos ? _idElemPos : _idElemStartPos;
+                info->hasDuplicateId = _hasDuplicateId;
+                info->hasDollarField = _hasDollarField;
+                info->hasZeroTimestamp = _hasZeroTimestamp;
+            }
+
+        private:
+            /** executes one state transition, updating the members */
+            Status _step( Buffer* buffer );
+
+            std::deque<ValidationObjectFrame> _frames;
+            ValidationState::State _state;
+            uint64_t _idElemStartPos; // will become the idElem once validated
+            uint64_t _idElemPos;      // offset of the validated _id element, 0 if none
+            bool _hasDuplicateId;     // a second top-level _id was seen
+            bool _hasDollarField;     // a top-level field name starts with '$'
+            bool _hasZeroTimestamp;   // a top-level Timestamp(0,0) was seen
+        };
+
+        Status ValidationMachine::run( Buffer* buffer, bool streaming, bool* suspended ) {
+            if ( suspended )
+                *suspended = false;
+            while ( _state != ValidationState::Done ) {
+                // Snapshot so a streaming run can roll back to this element boundary if
+                // the buffer runs dry mid-element.
+                const uint64_t checkpointPos = buffer->position();
+                const ValidationState::State checkpointState = _state;
+                std::deque<ValidationObjectFrame> checkpointFrames;
+                if ( streaming )
+                    checkpointFrames = _frames;
+
+                Status status = _step( buffer );
+                if ( !status.isOK() ) {
+                    if ( streaming && buffer->hitEnd() ) {
+                        // Not invalid, just truncated: restore the element boundary.
+                        buffer->setPosition( checkpointPos );
+                        _state = checkpointState;
+                        _frames.swap( checkpointFrames );
+                        *suspended = true;
+                        return Status::OK();
                     }
+                    return status;
+                }
+            }
+            return Status::OK();
+        }
+
+        Status ValidationMachine::_step( Buffer* buffer ) {
+            ValidationObjectFrame* curr = _frames.empty() ? NULL : &_frames.back();
 
-                    state = nextState;
-                    break;
+            BSONElement idElem;
+            if ( _idElemPos != 0 ) {
+                idElem = BSONElement( buffer->getBasePtr() + _idElemPos );
+                buffer->setIdElem( idElem );
+            }
+
+            switch (_state) {
+            case ValidationState::BeginObj:
+                _frames.push_back(ValidationObjectFrame());
+                curr = &_frames.back();
+                curr->setStartPosition(buffer->position());
+                curr->setIsCodeWithScope(false);
+                if (!buffer->readNumber<int>(&curr->expectedSize)) {
+                    return makeError("bson size is larger than buffer size", idElem);
                 }
-                case ValidationState::EndObj: {
-                    int actualLength = buffer->position() - curr->startPosition();
-                    if ( actualLength != curr->expectedSize ) {
-                        return makeError("bson length doesn't match what we found", idElem);
-                    }
-                    frames.pop_back();
-                    if (frames.empty()) {
-                        state = ValidationState::Done;
-                    }
-                    else {
-                        curr = &frames.back();
-                        if (curr->isCodeWithScope())
-                            state = ValidationState::EndCodeWScope;
+                _state = ValidationState::WithinObj;
+                break;
+            case ValidationState::WithinObj: {
+                const bool atTopLevel = _frames.size() == 1;
+                // check if we've finished validating idElem and are at start of next element.
+                if (atTopLevel && _idElemStartPos) {
+                    _idElemPos = _idElemStartPos;
+                    idElem = BSONElement(buffer->getBasePtr() + _idElemPos);
+                    buffer->setIdElem(idElem);
+                    _idElemStartPos = 0;
+                }
+
+                const uint64_t elemStartPos = buffer->position();
+                ValidationState::State nextState = _state;
+                Status status = validateElementInfo(buffer, &nextState, idElem);
+                if (!status.isOK())
+                    return status;
+
+                // we've already validated that fieldname is safe to access as long as we aren't
+                // at the end of the object, since EOO doesn't have a fieldname.
+                if (nextState != ValidationState::EndObj && atTopLevel) {
+                    const char* fieldName = buffer->getBasePtr() + elemStartPos + 1/*type*/;
+                    if (strcmp(fieldName, "_id") == 0) {
+                        if (idElem.eoo() && !_idElemStartPos)
+                            _idElemStartPos = elemStartPos;
                         else
-                            state = ValidationState::WithinObj;
+                            _hasDuplicateId = true;
+                    }
+                    if (fieldName[0] == '$')
+                        _hasDollarField = true;
+                    // a Timestamp's 8-byte payload is the last thing consumed above
+                    if (*(buffer->getBasePtr() + elemStartPos) == Timestamp) {
+                        long long ts;
+                        memcpy(&ts, buffer->getBasePtr() + buffer->position() - 8, 8);
+                        if (ts == 0)
+                            _hasZeroTimestamp = true;
                     }
-                    break;
                 }
-                case ValidationState::BeginCodeWScope: {
-                    frames.push_back(ValidationObjectFrame());
-                    curr = &frames.back();
-                    curr->setStartPosition(buffer->position());
-                    curr->setIsCodeWithScope(true);
-                    if ( !buffer->readNumber<int>( &curr->expectedSize ) )
-                        return makeError("invalid bson CodeWScope size", idElem);
-                    Status status = buffer->readUTF8String( NULL );
-                    if ( !status.isOK() )
-                        return status;
-                    state = ValidationState::BeginObj;
-                    break;
+
+                _state = nextState;
+                break;
+            }
+            case ValidationState::EndObj: {
+                int actualLength = buffer->position() - curr->startPosition();
+                if ( actualLength != curr->expectedSize ) {
+                    return makeError("bson length doesn't match what we found", idElem);
                 }
-                case ValidationState::EndCodeWScope: {
-                    int actualLength = buffer->position() - curr->startPosition();
-                    if ( actualLength != curr->expectedSize ) {
-                        return makeError("bson length for CodeWScope doesn't match what we found",
-                                         idElem);
-                    }
-                    frames.pop_back();
-                    if (frames.empty())
-                        return makeError("unnested CodeWScope", idElem);
-                    curr = &frames.back();
-                    state = ValidationState::WithinObj;
-                    break;
+                _frames.pop_back();
+                if (_frames.empty()) {
+                    _state = ValidationState::Done;
                 }
-                case ValidationState::Done:
-                    break;
+                else {
+                    curr = &_frames.back();
+                    if (curr->isCodeWithScope())
+                        _state = ValidationState::EndCodeWScope;
+                    else
+                        _state = ValidationState::WithinObj;
+                }
+                break;
+            }
+            case ValidationState::BeginCodeWScope: {
+                _frames.push_back(ValidationObjectFrame());
+                curr = &_frames.back();
+                curr->setStartPosition(buffer->position());
+                curr->setIsCodeWithScope(true);
+                if ( !buffer->readNumber<int>( &curr->expectedSize ) )
+                    return makeError("invalid bson CodeWScope size", idElem);
+                Status status = buffer->readUTF8String( NULL );
+                if ( !status.isOK() )
+                    return status;
+                _state = ValidationState::BeginObj;
+                break;
+            }
+            case ValidationState::EndCodeWScope: {
+                int actualLength = buffer->position() - curr->startPosition();
+                if ( actualLength != curr->expectedSize ) {
+                    return makeError("bson length for CodeWScope doesn't match what we found",
+                                     idElem);
                 }
+                _frames.pop_back();
+                if (_frames.empty())
+                    return makeError("unnested CodeWScope", idElem);
+                curr = &_frames.back();
+                _state = ValidationState::WithinObj;
+                break;
+            }
+            case ValidationState::Done:
+                break;
             }
 
             return Status::OK();
         }
 
+        Status validateBSONIterative(Buffer* buffer) {
+            ValidationMachine machine;
+            return machine.run( buffer, /*streaming=*/false, NULL );
+        }
+
     }  // namespace
 
     Status validateBSON( const char* originalBuffer, uint64_t maxLength ) {
@@ -363,4 +546,72 @@ namespace mongo {
         return validateBSONIterative( &buf );
     }
 
+    Status validateBSON( const char* originalBuffer, uint64_t maxLength, ValidatedDocInfo* info ) {
+        if ( maxLength < 5 ) {
+            return Status( ErrorCodes::InvalidBSON, "bson data has to be at least 5 bytes" );
+        }
+
+        Buffer buf( originalBuffer, maxLength );
+        ValidationMachine machine;
+        Status status = machine.run( &buf, /*streaming=*/false, NULL );
+        if ( !status.isOK() )
+            return status;
+
+        info->objSize = buf.position();
+        machine.fillInfo( info );
+        return Status::OK();
+    }
+
+    class IncrementalBSONValidator::Session {
+    public:
+        Session() : validatedBytes( 0 ), complete( false ) {}
+        ValidationMachine machine;
+        uint64_t validatedBytes;
+        bool complete;
+    };
+
+    IncrementalBSONValidator::IncrementalBSONValidator() : _session( new Session() ) {
+    }
+
+    IncrementalBSONValidator::~IncrementalBSONValidator() {
+        delete _session;
+    }
+
+    Status IncrementalBSONValidator::feed( const char* buf,
+                                           uint64_t maxLength,
+                                           bool* complete ) {
+        *complete = _session->complete;
+        if ( _session->complete )
+            return Status::OK();
+
+        // An object is at least 5 bytes; don't start the machine before that so the
+        // one-shot path's minimum-size error message is preserved.
+        if ( maxLength < 5 )
+            return Status::OK();
+
+        Buffer buffer( buf, maxLength );
+        buffer.setPosition( _session->validatedBytes );
+
+        bool suspended = false;
+        Status status = _session->machine.run( &buffer, /*streaming=*/true, &suspended );
+        if ( !status.isOK() )
+            return status;
+
+        _session->validatedBytes = buffer.position();
+        if ( !suspended && _session->machine.done() ) {
+            _session->complete = true;
+            *complete = true;
+        }
+        return Status::OK();
+    }
+
+    uint64_t IncrementalBSONValidator::objectSize() const {
+        return _session->validatedBytes;
+    }
+
+    void IncrementalBSONValidator::reset() {
+        delete _session;
+        _session = new Session();
+    }
+
 }  // namespace mongo
@@ -31,5 +31,72 @@ namespace mongo {
      */
     Status validateBSON( const char* buf, uint64_t maxLength );
 
+    /**
+     * Facts about a top-level object collected as a side effect of validation, so
+     * callers that need them (the insert path) don't re-walk the bytes.
+     */
+    struct ValidatedDocInfo {
+        ValidatedDocInfo()
+            : objSize( 0 ), idOffset( 0 ), hasDuplicateId( false ),
+              hasDollarField( false ), hasZeroTimestamp( false ) {}
+
+        uint64_t objSize;      // total size of the validated object
+        uint64_t idOffset;     // offset of the top-level _id element, 0 if absent
+        bool hasDuplicateId;   // more than one top-level field is named _id
+        bool hasDollarField;   // some top-level field name starts with '$'
+        bool hasZeroTimestamp; // a top-level Timestamp(0,0) wants filling in at insert
+    };
+
+    /**
+     * As validateBSON() above, additionally filling in *info (valid only when the
+     * returned status is OK).
+     */
+    Status validateBSON( const char* buf, uint64_t maxLength, ValidatedDocInfo* info );
+
+    /**
+     * Validates a single BSON object that is arriving incrementally, e.g. while the rest
+     * of its message is still being read from a socket.  Feed it the same contiguous
+     * buffer with a growing valid length as bytes arrive; validation resumes where the
+     * previous call left off, so by the time the last byte is in, almost all of the work
+     * is already done.
+     *
+     * Usage:
+     *     IncrementalBSONValidator validator;
+     *     bool complete = false;
+     *     while ( !complete ) {
+     *         // ... read more into buf, growing 'len' ...
+     *         Status s = validator.feed( buf, len, &complete );
+     *         if ( !s.isOK() ) // invalid bson, no point reading further
+     *     }
+     *     // validator.objectSize() bytes were consumed; reset() to validate the next
+     *     // object in the buffer.
+     */
+    class IncrementalBSONValidator {
+    public:
+        IncrementalBSONValidator();
+        ~IncrementalBSONValidator();
+
+        /**
+         * Continues validation over buf[0, maxLength).  'buf' must be the same logical
+         * buffer on every call (the underlying memory may have been realloc'd, but the
+         * contents already fed must be unchanged), with maxLength non-decreasing.
+         *
+         * Returns a non-OK status as soon as the data seen so far cannot be a prefix of
+         * any valid BSON object.  Otherwise returns OK and sets *complete to true once
+         * one whole object has been validated.
+         */
+        Status feed( const char* buf, uint64_t maxLength, bool* complete );
+
+        /** Once complete, the total size of the validated object. */
+        uint64_t objectSize() const;
+
+        /** Makes the validator ready to validate another object from scratch. */
+        void reset();
+
+    private:
+        class Session;
+        Session* _session;
+    };
+
 }
 
@@ -273,4 +273,71 @@ namespace {
         ASSERT_NOT_OK(status);
         ASSERT_EQUALS(status.reason(), "not null terminated string in object with unknown _id");
     }
+
+    TEST(BSONValidateIncremental, ByteAtATime) {
+        BSONObj x = BSON( "a" << 1
+                       << "b" << "some string"
+                       << "c" << BSON( "nested" << BSON_ARRAY( 1 << 2 << 3 ) )
+                       << "_id" << 17 );
+        IncrementalBSONValidator validator;
+        bool complete = false;
+        for ( int len = 1; len <= x.objsize(); len++ ) {
+            ASSERT_OK( validator.feed( x.objdata(), len, &complete ) );
+            if ( len < x.objsize() ) {
+                ASSERT_FALSE( complete );
+            }
+        }
+        ASSERT_TRUE( complete );
+        ASSERT_EQUALS( static_cast<uint64_t>( x.objsize() ), validator.objectSize() );
+    }
+
+    TEST(BSONValidateIncremental, DetectsInvalidEarly) {
+        BufBuilder bb;
+        BSONObjBuilder ob(bb);
+        appendInvalidStringElement("foo", &bb);
+        ob.append("trailing", 1);
+        const BSONObj x = ob.done();
+
+        // feed everything but the last few bytes: the bad string is fully present, so
+        // the validator must fail before the object is complete
+        IncrementalBSONValidator validator;
+        bool complete = false;
+        Status status = Status::OK();
+        for ( int len = 1; len <= x.objsize() - 4 && status.isOK(); len++ ) {
+            status = validator.feed( x.objdata(), len, &complete );
+        }
+        ASSERT_NOT_OK( status );
+    }
+
+    TEST(BSONValidateIncremental, Reset) {
+        BSONObj x = BSON( "a" << 1 );
+        IncrementalBSONValidator validator;
+        bool complete = false;
+        ASSERT_OK( validator.feed( x.objdata(), x.objsize(), &complete ) );
+        ASSERT_TRUE( complete );
+
+        validator.reset();
+        complete = false;
+        ASSERT_OK( validator.feed( x.objdata(), x.objsize(), &complete ) );
+        ASSERT_TRUE( complete );
+
+        // matches the one-shot validator on the same data
+        ASSERT_OK( validateBSON( x.objdata(), x.objsize() ) );
+    }
+
+    TEST(BSONValidateFast, LongFieldNames) {
+        // Field names of every length up to well past the 16-byte scan width, so
+        // terminators land on every offset within (and straddle) vector chunks.
+        for ( int len = 1; len <= 100; len++ ) {
+            const std::string name( len, 'x' );
+            BSONObj x = BSON( name << 1 );
+            ASSERT_OK( validateBSON( x.objdata(), x.objsize() ) );
+
+            BufBuilder bb;
+            BSONObjBuilder ob(bb);
+            appendInvalidStringElement( name.c_str(), &bb );
+            const BSONObj bad = ob.done();
+            ASSERT_NOT_OK( validateBSON( bad.objdata(), bad.objsize() ) );
+        }
+    }
 }
@@ -39,5 +39,27 @@ namespace mutablebson {
 
     typedef std::vector<DamageEvent> DamageVector;
 
+    // Merges damage events that are contiguous in both the source and the target buffer
+    // into single events, in place.  Many small writes (e.g. a $set rewriting a value and
+    // its neighboring type byte) become one memcpy when the damages are applied to the
+    // target view.  Only exactly-adjacent events are merged, so the result of applying
+    // the vector in order is unchanged.
+    inline void coalesceDamages(DamageVector* damages) {
+        if (damages->size() < 2)
+            return;
+        DamageVector::iterator out = damages->begin();
+        for (DamageVector::iterator in = out + 1; in != damages->end(); ++in) {
+            if ((out->targetOffset + out->size == in->targetOffset) &&
+                (out->sourceOffset + out->size == in->sourceOffset)) {
+                out->size += in->size;
+            }
+            else {
+                ++out;
+                *out = *in;
+            }
+        }
+        damages->erase(out + 1, damages->end());
+    }
+
 } // namespace mutablebson
 } // namespace mongo
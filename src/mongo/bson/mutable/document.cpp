@@ -973,6 +973,10 @@ namespace mutablebson {
             damages->swap(_damages);
             _damages.clear();
 
+            // Merge adjacent damages so applying them to the target does fewer, larger
+            // memcpy calls.
+            coalesceDamages(damages);
+
             return true;
         }
 
@@ -3010,4 +3010,45 @@ namespace {
         ASSERT_NOT_EQUALS(mmb::unordered(b1), mmb::unordered(b2));
     }
 
+    static mmb::DamageEvent makeDamage(uint32_t targetOffset,
+                                       uint32_t sourceOffset,
+                                       size_t size) {
+        mmb::DamageEvent event;
+        event.targetOffset = targetOffset;
+        event.sourceOffset = sourceOffset;
+        event.size = size;
+        return event;
+    }
+
+    TEST(DamageVector, CoalesceAdjacent) {
+        mmb::DamageVector damages;
+        damages.push_back(makeDamage(0, 0, 4));
+        damages.push_back(makeDamage(4, 4, 8));   // adjacent in both buffers: merged
+        damages.push_back(makeDamage(12, 20, 4)); // adjacent in target only: kept
+        damages.push_back(makeDamage(16, 24, 2)); // adjacent in both buffers: merged
+        damages.push_back(makeDamage(40, 26, 2)); // gap in target: kept
+
+        mmb::coalesceDamages(&damages);
+
+        ASSERT_EQUALS(3U, damages.size());
+        ASSERT_EQUALS(0U, damages[0].targetOffset);
+        ASSERT_EQUALS(12U, damages[0].size);
+        ASSERT_EQUALS(12U, damages[1].targetOffset);
+        ASSERT_EQUALS(20U, damages[1].sourceOffset);
+        ASSERT_EQUALS(6U, damages[1].size);
+        ASSERT_EQUALS(40U, damages[2].targetOffset);
+        ASSERT_EQUALS(2U, damages[2].size);
+    }
+
+    TEST(DamageVector, CoalesceDegenerate) {
+        mmb::DamageVector empty;
+        mmb::coalesceDamages(&empty);
+        ASSERT_EQUALS(0U, empty.size());
+
+        mmb::DamageVector one;
+        one.push_back(makeDamage(8, 0, 4));
+        mmb::coalesceDamages(&one);
+        ASSERT_EQUALS(1U, one.size());
+    }
+
 } // namespace
@@ -25,6 +25,7 @@
 #include "mongo/bson/bsonobjbuilder.h"
 #include "mongo/bson/oid.h"
 #include "mongo/bson/util/atomic_int.h"
+#include "mongo/util/concurrency/threadlocal.h"
 
 #define verify MONGO_verify
 
@@ -96,9 +97,25 @@ namespace mongo {
         ourMachineAndPid = x;
     }
 
+    // Threads reserve blocks of counter values and hand them out locally, so the common
+    // case of generating an _id touches no shared cacheline.  Blocks being consumed out
+    // of global order is fine: the counter is only 3 bytes and wraps anyway; uniqueness
+    // within one (time, machine, pid) second is what matters, and distinct blocks never
+    // collide.
+    const unsigned kOIDIncBlockSize = 1024;
+
+    struct OIDIncBlock {
+        OIDIncBlock() : next( 0 ), remaining( 0 ) {}
+        unsigned next;
+        unsigned remaining;
+    };
+
+    TSP_DECLARE( OIDIncBlock, oidIncBlock )
+    TSP_DEFINE( OIDIncBlock, oidIncBlock )
+
     void OID::init() {
-        static AtomicUInt inc = static_cast<unsigned>(
-            scoped_ptr<SecureRandom>(SecureRandom::create())->nextInt64());
+        static AtomicUInt32 inc( static_cast<unsigned>(
+            scoped_ptr<SecureRandom>(SecureRandom::create())->nextInt64()) );
 
         {
             unsigned t = (unsigned) time(0);
@@ -112,7 +129,14 @@ namespace mongo {
         _machineAndPid = ourMachineAndPid;
 
         {
-            int new_inc = inc++;
+            OIDIncBlock* block = oidIncBlock.getMake();
+            if ( block->remaining == 0 ) {
+                // one shared atomic op per block instead of per OID
+                block->next = inc.fetchAndAdd( kOIDIncBlockSize );
+                block->remaining = kOIDIncBlockSize;
+            }
+            unsigned new_inc = block->next++;
+            block->remaining--;
             unsigned char *T = (unsigned char *) &new_inc;
             _inc[0] = T[2];
             _inc[1] = T[1];
@@ -0,0 +1,196 @@
+/* arena.h */
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <stdlib.h>
+#include <string.h>
+#include <vector>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/bson/util/builder.h"
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    /**
+     * A bump-pointer arena for short-lived, per-operation allocations.
+     *
+     * Allocations are satisfied from geometrically growing chunks and are never freed
+     * individually; reset() rewinds the arena in one shot, keeping the largest chunk for
+     * reuse so a steady-state operation makes no malloc calls at all.
+     *
+     * Memory handed out by an arena is only valid until reset() -- anything that must
+     * outlive the operation (e.g. a BSONObj returned to a caller) has to be copied out
+     * first.  In particular, never release ownership of an arena-backed buffer to code
+     * that will eventually free() it.
+     *
+     * Not thread safe; intended to be owned by a Client and used by one thread.
+     */
+    class Arena {
+        MONGO_DISALLOW_COPYING(Arena);
+    public:
+        explicit Arena( size_t initialChunkSize = 16 * 1024 )
+            : _initialChunkSize( initialChunkSize ),
+              _current( 0 ), _end( 0 ), _allocated( 0 ) {
+        }
+
+        ~Arena() {
+            for ( size_t i = 0; i < _chunks.size(); i++ )
+                free( _chunks[i].base );
+        }
+
+        void* allocate( size_t sz ) {
+            sz = ( sz + 7 ) & ~size_t( 7 ); // keep everything 8-byte aligned
+            if ( _current + sz > _end )
+                _grow( sz );
+            void* p = _current;
+            _current += sz;
+            return p;
+        }
+
+        /**
+         * Rewinds the arena, invalidating everything ever returned by allocate().  The
+         * largest chunk is kept so the next operation starts warm.
+         */
+        void reset() {
+            if ( _chunks.empty() )
+                return;
+            // move the largest chunk to slot 0, free the rest
+            size_t largest = 0;
+            for ( size_t i = 1; i < _chunks.size(); i++ ) {
+                if ( _chunks[i].size > _chunks[largest].size )
+                    largest = i;
+            }
+            std::swap( _chunks[0], _chunks[largest] );
+            for ( size_t i = 1; i < _chunks.size(); i++ )
+                free( _chunks[i].base );
+            _chunks.resize( 1 );
+            _current = _chunks[0].base;
+            _end = _current + _chunks[0].size;
+            _allocated = _chunks[0].size;
+        }
+
+        /**
+         * Like reset(), but also frees the retained chunk unless the arena is already
+         * at or below floorBytes.  Use to stop an idle connection from pinning a large
+         * chunk it needed once during a burst; the next allocation starts cold again.
+         */
+        void shrink( size_t floorBytes ) {
+            reset();
+            if ( _allocated <= floorBytes )
+                return;
+            for ( size_t i = 0; i < _chunks.size(); i++ )
+                free( _chunks[i].base );
+            _chunks.clear();
+            _current = _end = 0;
+            _allocated = 0;
+        }
+
+        /** total bytes of backing memory currently owned by the arena */
+        size_t allocatedBytes() const { return _allocated; }
+
+        /** bytes handed out since the last reset (approximate: partially filled
+            earlier chunks count in full) */
+        size_t usedBytes() const { return _allocated - ( _end - _current ); }
+
+    private:
+        struct Chunk {
+            char* base;
+            size_t size;
+        };
+
+        void _grow( size_t atLeast ) {
+            size_t sz = _chunks.empty() ? _initialChunkSize : _chunks.back().size * 2;
+            if ( sz < atLeast )
+                sz = atLeast;
+            Chunk c;
+            c.base = static_cast<char*>( malloc( sz ) );
+            if ( c.base == 0 )
+                msgasserted( 17450, "out of memory Arena" );
+            c.size = sz;
+            _chunks.push_back( c );
+            _current = c.base;
+            _end = c.base + sz;
+            _allocated += sz;
+        }
+
+        const size_t _initialChunkSize;
+        std::vector<Chunk> _chunks;
+        char* _current;
+        char* _end;
+        size_t _allocated;
+    };
+
+    /**
+     * Adapter giving _BufBuilder the TrivialAllocator interface on top of an Arena.
+     *
+     * Default-constructed it degrades to plain malloc/free, so an ArenaBufBuilder built
+     * without an arena behaves exactly like BufBuilder.  When backed by an arena, Free()
+     * is a no-op (the arena reclaims everything on reset) and Realloc copies, since the
+     * arena records each block's size in a small header.
+     */
+    class ArenaAllocator {
+    public:
+        ArenaAllocator() : _arena( 0 ) {}
+        explicit ArenaAllocator( Arena* arena ) : _arena( arena ) {}
+
+        void* Malloc( size_t sz ) {
+            if ( !_arena )
+                return malloc( sz );
+            size_t* p = static_cast<size_t*>( _arena->allocate( sz + sizeof( size_t ) ) );
+            *p = sz;
+            return p + 1;
+        }
+
+        void* Realloc( void* p, size_t sz ) {
+            if ( !_arena )
+                return realloc( p, sz );
+            if ( !p )
+                return Malloc( sz );
+            size_t oldSz = *( static_cast<size_t*>( p ) - 1 );
+            if ( sz <= oldSz )
+                return p;
+            void* n = Malloc( sz );
+            memcpy( n, p, oldSz );
+            return n;
+        }
+
+        void Free( void* p ) {
+            if ( !_arena )
+                free( p );
+            // arena-backed blocks are reclaimed wholesale by Arena::reset()
+        }
+
+    private:
+        Arena* _arena;
+    };
+
+    /** A BufBuilder drawing from a per-operation arena; see Arena for lifetime rules. */
+    typedef _BufBuilder<ArenaAllocator> ArenaBufBuilder;
+
+    /** Rewinds an arena when the scope exits, regardless of which path returns. */
+    class ArenaReset {
+        MONGO_DISALLOW_COPYING(ArenaReset);
+    public:
+        explicit ArenaReset( Arena& arena ) : _arena( arena ) {}
+        ~ArenaReset() { _arena.reset(); }
+    private:
+        Arena& _arena;
+    };
+
+} // namespace mongo
@@ -111,6 +111,21 @@ namespace mongo {
             }
             l = 0;
         }
+
+        /** for stateful allocators (e.g. ArenaAllocator) that must be constructed
+            with their backing store */
+        explicit _BufBuilder(const Allocator& allocator, int initsize = 512)
+            : al(allocator), size(initsize) {
+            if ( size > 0 ) {
+                data = (char *) al.Malloc(size);
+                if( data == 0 )
+                    msgasserted(10000, "out of memory BufBuilder");
+            }
+            else {
+                data = 0;
+            }
+            l = 0;
+        }
         ~_BufBuilder() { kill(); }
 
         void kill() {
@@ -17,6 +17,7 @@
 
 #include "mongo/unittest/unittest.h"
 
+#include "mongo/bson/util/arena.h"
 #include "mongo/bson/util/builder.h"
 
 namespace mongo {
@@ -31,4 +32,44 @@ namespace mongo {
         ASSERT_EQUALS( 0, strcmp( bb.buf(), "eliot" ) );
         ASSERT_EQUALS( 0, strcmp( "eliot", bb.buf() ) );
     }
+
+    TEST( Builder, ArenaBacked ) {
+        Arena arena( 64 ); // tiny initial chunk to force growth
+        ArenaAllocator alloc( &arena );
+        {
+            ArenaBufBuilder bb( alloc );
+            for ( int i = 0; i < 1000; i++ )
+                bb.appendNum( i );
+            ASSERT_EQUALS( 1000 * (int)sizeof(int), bb.len() );
+            for ( int i = 0; i < 1000; i++ )
+                ASSERT_EQUALS( i, reinterpret_cast<const int*>( bb.buf() )[i] );
+        }
+        ASSERT_GREATER_THAN( arena.allocatedBytes(), 0U );
+        arena.reset();
+
+        // repeated same-sized builds must converge: the retained chunk doubles each
+        // pass until it covers the whole realloc chain, after which a build allocates
+        // no new chunks and allocatedBytes stops changing
+        for ( int pass = 0; pass < 8; pass++ ) {
+            ArenaBufBuilder bb( alloc );
+            for ( int i = 0; i < 1000; i++ )
+                bb.appendNum( i );
+            arena.reset();
+        }
+        const size_t steady = arena.allocatedBytes();
+        {
+            ArenaBufBuilder bb( alloc );
+            for ( int i = 0; i < 1000; i++ )
+                bb.appendNum( i );
+        }
+        arena.reset();
+        ASSERT_EQUALS( steady, arena.allocatedBytes() );
+    }
+
+    TEST( Builder, ArenaAllocatorHeapFallback ) {
+        // with no arena attached, ArenaBufBuilder behaves exactly like BufBuilder
+        ArenaBufBuilder bb;
+        bb.appendStr( "eliot" );
+        ASSERT_EQUALS( 0, strcmp( bb.buf(), "eliot" ) );
+    }
 }
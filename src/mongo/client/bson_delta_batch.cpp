@@ -0,0 +1,195 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/client/bson_delta_batch.h"
+
+#include <map>
+
+#include "mongo/util/mongoutils/str.h"
+
+namespace mongo {
+
+    namespace str = mongoutils::str;
+
+    namespace {
+
+        const char markerLiteral = 0;
+        const char markerRepeat = 1;
+        const char markerEndOfDoc = 2;
+
+        void appendVarInt( BufBuilder& b, unsigned n ) {
+            while ( n >= 0x80 ) {
+                b.appendChar( static_cast<char>( ( n & 0x7f ) | 0x80 ) );
+                n >>= 7;
+            }
+            b.appendChar( static_cast<char>( n ) );
+        }
+
+        unsigned readVarInt( const char*& p, const char* end ) {
+            unsigned n = 0;
+            int shift = 0;
+            while ( p < end ) {
+                const unsigned char c = static_cast<unsigned char>( *p++ );
+                n |= static_cast<unsigned>( c & 0x7f ) << shift;
+                if ( ( c & 0x80 ) == 0 )
+                    return n;
+                shift += 7;
+                uassert( 17507, "varint too long in delta batch payload", shift < 32 );
+            }
+            uasserted( 17508, "truncated varint in delta batch payload" );
+            return 0;
+        }
+
+    } // namespace
+
+    BSONObj BSONDeltaBatch::encode( const std::vector<BSONObj>& docs ) {
+        if ( docs.size() < 2 )
+            return BSONObj();
+
+        // Dictionary of every top level field name seen in the batch, in first-use order.
+        std::vector<std::string> names;
+        std::map<std::string,unsigned> nameIndex;
+        long long rawSize = 0;
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            rawSize += docs[i].objsize();
+            BSONObjIterator it( docs[i] );
+            while ( it.more() ) {
+                const std::string name = it.next().fieldName();
+                if ( nameIndex.insert( std::make_pair( name, names.size() ) ).second )
+                    names.push_back( name );
+            }
+        }
+
+        BufBuilder payload;
+        BSONObj prev;
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            BSONObjIterator it( docs[i] );
+            while ( it.more() ) {
+                BSONElement e = it.next();
+                const unsigned idx = nameIndex[e.fieldName()];
+                BSONElement p = prev.isEmpty() ? BSONElement() : prev[e.fieldName()];
+                if ( ! p.eoo() && p.type() == e.type() && p.valuesize() == e.valuesize() &&
+                     memcmp( p.value(), e.value(), e.valuesize() ) == 0 ) {
+                    payload.appendChar( markerRepeat );
+                    appendVarInt( payload, idx );
+                }
+                else {
+                    payload.appendChar( markerLiteral );
+                    payload.appendChar( static_cast<char>( e.type() ) );
+                    appendVarInt( payload, idx );
+                    appendVarInt( payload, e.valuesize() );
+                    payload.appendBuf( e.value(), e.valuesize() );
+                }
+            }
+            payload.appendChar( markerEndOfDoc );
+            prev = docs[i];
+        }
+
+        BSONObjBuilder b;
+        b.append( "$deltaBatch", CurrentVersion );
+        b.append( "n", static_cast<int>( docs.size() ) );
+        {
+            BSONArrayBuilder dict( b.subarrayStart( "dict" ) );
+            for ( size_t i = 0; i < names.size(); i++ )
+                dict.append( names[i] );
+            dict.done();
+        }
+        b.appendBinData( "data", payload.len(), BinDataGeneral, payload.buf() );
+
+        BSONObj envelope = b.obj();
+        if ( envelope.objsize() >= rawSize )
+            return BSONObj();
+        return envelope;
+    }
+
+    bool BSONDeltaBatch::isDeltaBatch( const BSONObj& obj ) {
+        BSONElement first = obj.firstElement();
+        return first.isNumber() && str::equals( first.fieldName(), "$deltaBatch" );
+    }
+
+    int BSONDeltaBatch::decode( const BSONObj& envelope, BufBuilder& out ) {
+        uassert( 17509,
+                 str::stream() << "unsupported delta batch envelope: "
+                               << envelope.firstElement().toString(),
+                 isDeltaBatch( envelope ) &&
+                 envelope.firstElement().numberInt() == CurrentVersion );
+
+        const int n = envelope["n"].numberInt();
+        uassert( 17510, "invalid document count in delta batch", n > 0 );
+
+        BSONElement dictElt = envelope["dict"];
+        uassert( 17511, "missing field name dictionary in delta batch",
+                 dictElt.type() == Array );
+        std::vector<std::string> names;
+        BSONObjIterator di( dictElt.Obj() );
+        while ( di.more() )
+            names.push_back( di.next().String() );
+
+        BSONElement dataElt = envelope["data"];
+        uassert( 17512, "missing payload in delta batch", dataElt.type() == BinData );
+        int payloadLen = 0;
+        const char* p = dataElt.binData( payloadLen );
+        const char* end = p + payloadLen;
+
+        BSONObj prev;
+        BufBuilder docBuf;
+        for ( int i = 0; i < n; i++ ) {
+            docBuf.reset();
+            docBuf.skip( 4 ); // total length, filled in below
+            for ( ;; ) {
+                uassert( 17513, "truncated delta batch payload", p < end );
+                const char marker = *p++;
+                if ( marker == markerEndOfDoc )
+                    break;
+                if ( marker == markerRepeat ) {
+                    const unsigned idx = readVarInt( p, end );
+                    uassert( 17514, "field name index out of range in delta batch",
+                             idx < names.size() );
+                    BSONElement pe = prev[names[idx]];
+                    uassert( 17515, "repeated element missing from previous document",
+                             ! pe.eoo() );
+                    docBuf.appendBuf( pe.rawdata(), pe.size() );
+                }
+                else {
+                    uassert( 17516, "unknown marker byte in delta batch payload",
+                             marker == markerLiteral );
+                    uassert( 17517, "truncated delta batch payload", p < end );
+                    const char type = *p++;
+                    const unsigned idx = readVarInt( p, end );
+                    uassert( 17518, "field name index out of range in delta batch",
+                             idx < names.size() );
+                    const unsigned valSize = readVarInt( p, end );
+                    uassert( 17519, "element value overruns delta batch payload",
+                             valSize <= static_cast<unsigned>( end - p ) );
+                    docBuf.appendChar( type );
+                    docBuf.appendStr( names[idx] );
+                    docBuf.appendBuf( p, valSize );
+                    p += valSize;
+                }
+            }
+            docBuf.appendChar( EOO );
+            reinterpret_cast<int*>( docBuf.buf() )[0] = docBuf.len();
+            out.appendBuf( docBuf.buf(), docBuf.len() );
+            // keep an owned copy: docBuf is reused for the next document
+            prev = BSONObj( docBuf.buf() ).getOwned();
+        }
+
+        uassert( 17520, "trailing bytes in delta batch payload", p == end );
+        return n;
+    }
+
+} // namespace mongo
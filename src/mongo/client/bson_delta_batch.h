@@ -0,0 +1,69 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    /**
+     * Per-batch dictionary/delta encoding for a run of BSON documents.
+     *
+     * Consecutive entries pulled off a tailable cursor over a capped collection (most
+     * notably the oplog) tend to repeat both their field names and much of their element
+     * data.  An encoded batch replaces the run of documents with a single envelope
+     * document:
+     *
+     *     { $deltaBatch : <version>,
+     *       n           : <number of documents>,
+     *       dict        : [ <field name>, ... ],
+     *       data        : BinData(<payload>) }
+     *
+     * The payload is a stream of per-document element records, each introduced by a
+     * marker byte: a literal element carries its type byte, a varint index into the
+     * field name dictionary, a varint value length and the value bytes verbatim, while a
+     * repeat carries only a dictionary index and means "the same-named top level element
+     * of the previous document in the batch, byte for byte".  Nested objects are treated
+     * as opaque values.
+     *
+     * The encoding says nothing about the transport; it stacks with any wire level
+     * compression the connection may also be using.
+     */
+    class BSONDeltaBatch {
+    public:
+        static const int CurrentVersion = 1;
+
+        /**
+         * Encodes 'docs' into a single envelope document.  Returns an empty BSONObj when
+         * the encoded form would not be smaller than the documents themselves; the
+         * caller should then send the batch unencoded.
+         */
+        static BSONObj encode( const std::vector<BSONObj>& docs );
+
+        /** @return true if 'obj' looks like an envelope produced by encode() */
+        static bool isDeltaBatch( const BSONObj& obj );
+
+        /**
+         * Decodes 'envelope', appending the documents' raw BSON back to back onto
+         * 'out'.  uasserts if the envelope is malformed.
+         * @return the number of documents appended
+         */
+        static int decode( const BSONObj& envelope, BufBuilder& out );
+    };
+
+} // namespace mongo
@@ -0,0 +1,133 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects
+ *    for all of the code used other than as permitted herein. If you modify
+ *    file(s) with this exception, you may extend this exception to your
+ *    version of the file(s), but you are not obligated to do so. If you do not
+ *    wish to do so, delete this exception statement from your version. If you
+ *    delete this exception statement from all source files in the program,
+ *    then also delete it in the license file.
+ */
+
+#include <vector>
+
+#include "mongo/client/bson_delta_batch.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/unittest/unittest.h"
+
+namespace {
+
+    using namespace mongo;
+    using std::vector;
+
+    // Decode 'envelope' and split the concatenated raw documents back out.
+    vector<BSONObj> decodeAll( const BSONObj& envelope ) {
+        BufBuilder out;
+        const int n = BSONDeltaBatch::decode( envelope, out );
+        vector<BSONObj> docs;
+        const char* p = out.buf();
+        for ( int i = 0; i < n; i++ ) {
+            BSONObj o( p );
+            docs.push_back( o.getOwned() );
+            p += o.objsize();
+        }
+        ASSERT_EQUALS( p - out.buf(), out.len() );
+        return docs;
+    }
+
+    TEST( BSONDeltaBatch, OplogLikeRoundTrip ) {
+        // consecutive oplog inserts: op/ns/v repeat, ts/h/o differ
+        vector<BSONObj> docs;
+        for ( int i = 0; i < 10; i++ ) {
+            docs.push_back( BSON( "ts" << i << "h" << ( 1000LL + i ) << "v" << 2
+                                  << "op" << "i" << "ns" << "test.coll"
+                                  << "o" << BSON( "_id" << i << "x" << "some payload" ) ) );
+        }
+
+        BSONObj envelope = BSONDeltaBatch::encode( docs );
+        ASSERT( ! envelope.isEmpty() );
+        ASSERT( BSONDeltaBatch::isDeltaBatch( envelope ) );
+
+        long long rawSize = 0;
+        for ( size_t i = 0; i < docs.size(); i++ )
+            rawSize += docs[i].objsize();
+        ASSERT_LESS_THAN( envelope.objsize(), rawSize );
+
+        vector<BSONObj> decoded = decodeAll( envelope );
+        ASSERT_EQUALS( docs.size(), decoded.size() );
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            ASSERT_EQUALS( docs[i].objsize(), decoded[i].objsize() );
+            ASSERT_EQUALS( 0, memcmp( docs[i].objdata(), decoded[i].objdata(),
+                                      docs[i].objsize() ) );
+        }
+    }
+
+    TEST( BSONDeltaBatch, MixedShapesRoundTrip ) {
+        // documents that add, drop and retype fields between entries
+        vector<BSONObj> docs;
+        docs.push_back( BSON( "a" << 1 << "b" << "one" ) );
+        docs.push_back( BSON( "a" << 1 << "c" << BSON_ARRAY( 1 << 2 << 3 ) ) );
+        docs.push_back( BSON( "b" << 2.5 << "a" << 1 ) );
+        docs.push_back( BSONObj() );
+        docs.push_back( BSON( "a" << 1 << "b" << 2.5 ) );
+
+        BSONObj envelope = BSONDeltaBatch::encode( docs );
+        if ( envelope.isEmpty() )
+            return; // encoder declined: nothing to verify
+        vector<BSONObj> decoded = decodeAll( envelope );
+        ASSERT_EQUALS( docs.size(), decoded.size() );
+        for ( size_t i = 0; i < docs.size(); i++ )
+            ASSERT_EQUALS( 0, docs[i].woCompare( decoded[i] ) );
+    }
+
+    TEST( BSONDeltaBatch, DeclinesWhenNotSmaller ) {
+        // a single document can never win, nor can tiny unrelated documents
+        vector<BSONObj> docs;
+        docs.push_back( BSON( "a" << 1 ) );
+        ASSERT( BSONDeltaBatch::encode( docs ).isEmpty() );
+
+        docs.push_back( BSON( "b" << 2 ) );
+        ASSERT( BSONDeltaBatch::encode( docs ).isEmpty() );
+    }
+
+    TEST( BSONDeltaBatch, MalformedEnvelopeAsserts ) {
+        vector<BSONObj> docs;
+        for ( int i = 0; i < 4; i++ )
+            docs.push_back( BSON( "op" << "i" << "ns" << "test.coll" << "x" << i ) );
+        BSONObj envelope = BSONDeltaBatch::encode( docs );
+        ASSERT( ! envelope.isEmpty() );
+
+        BufBuilder out;
+        // wrong version
+        BSONObj badVersion = BSON( "$deltaBatch" << 99 << "n" << 1 );
+        ASSERT_THROWS( BSONDeltaBatch::decode( badVersion, out ), UserException );
+
+        // truncated payload
+        BSONObjBuilder b;
+        b.append( "$deltaBatch", BSONDeltaBatch::CurrentVersion );
+        b.append( "n", envelope["n"].numberInt() );
+        b.append( envelope["dict"] );
+        int len = 0;
+        const char* payload = envelope["data"].binData( len );
+        b.appendBinData( "data", len / 2, BinDataGeneral, payload );
+        ASSERT_THROWS( BSONDeltaBatch::decode( b.obj(), out ), UserException );
+    }
+
+}  // namespace
@@ -0,0 +1,196 @@
+// bulk_operation_builder.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/client/bulk_operation_builder.h"
+
+#include "mongo/db/namespace_string.h"
+#include "mongo/s/write_ops/batched_delete_document.h"
+#include "mongo/s/write_ops/batched_update_document.h"
+
+namespace mongo {
+
+    // Leave room for the command fields around the op payload
+    static const int maxSubBatchSizeBytes = BSONObjMaxUserSize - ( 16 * 1024 );
+
+    BulkOperationBuilder::BulkOperationBuilder( DBClientBase* client,
+                                                const std::string& ns,
+                                                bool ordered ) :
+        _client( client ), _ns( ns ), _ordered( ordered ), _numOps( 0 ), _executed( false ) {
+        verify( _client );
+        for ( int i = 0; i < 3; i++ )
+            _openSubBatch[i] = -1;
+    }
+
+    BulkOperationBuilder::SubBatch* BulkOperationBuilder::_targetSubBatch(
+            BatchedCommandRequest::BatchType type, int opSizeBytes ) {
+
+        // Ordered batches must replay in append order, so an op of a different type
+        // than the last one always starts a new sub-batch
+        if ( _ordered && ! _subBatches.empty() &&
+             _subBatches.back().request->getBatchType() != type ) {
+            _openSubBatch[type] = -1;
+        }
+
+        int open = _ordered ? ( _subBatches.empty() ? -1 : (int)_subBatches.size() - 1 )
+                            : _openSubBatch[type];
+
+        if ( open >= 0 && _subBatches[open].request->getBatchType() == type &&
+             (int)_subBatches[open].request->sizeWriteOps() <
+                     BatchedCommandRequest::kMaxWriteBatchSize &&
+             _subBatches[open].sizeBytes + opSizeBytes <= maxSubBatchSizeBytes ) {
+            return &_subBatches[open];
+        }
+
+        _subBatches.push_back( SubBatch( new BatchedCommandRequest( type ) ) );
+        _openSubBatch[type] = (int)_subBatches.size() - 1;
+        return &_subBatches.back();
+    }
+
+    void BulkOperationBuilder::insert( const BSONObj& doc ) {
+        verify( ! _executed );
+        SubBatch* subBatch =
+            _targetSubBatch( BatchedCommandRequest::BatchType_Insert, doc.objsize() );
+
+        subBatch->request->getInsertRequest()->addToDocuments( doc );
+        subBatch->opIndexes.push_back( (int)_numOps++ );
+        subBatch->sizeBytes += doc.objsize();
+    }
+
+    void BulkOperationBuilder::update( const BSONObj& query,
+                                       const BSONObj& updateExpr,
+                                       bool upsert,
+                                       bool multi ) {
+        verify( ! _executed );
+        const int opSizeBytes = query.objsize() + updateExpr.objsize();
+        SubBatch* subBatch =
+            _targetSubBatch( BatchedCommandRequest::BatchType_Update, opSizeBytes );
+
+        auto_ptr<BatchedUpdateDocument> updateDoc( new BatchedUpdateDocument );
+        updateDoc->setQuery( query );
+        updateDoc->setUpdateExpr( updateExpr );
+        updateDoc->setUpsert( upsert );
+        updateDoc->setMulti( multi );
+
+        subBatch->request->getUpdateRequest()->addToUpdates( updateDoc.release() );
+        subBatch->opIndexes.push_back( (int)_numOps++ );
+        subBatch->sizeBytes += opSizeBytes;
+    }
+
+    void BulkOperationBuilder::remove( const BSONObj& query, int limit ) {
+        verify( ! _executed );
+        SubBatch* subBatch =
+            _targetSubBatch( BatchedCommandRequest::BatchType_Delete, query.objsize() );
+
+        auto_ptr<BatchedDeleteDocument> deleteDoc( new BatchedDeleteDocument );
+        deleteDoc->setQuery( query );
+        deleteDoc->setLimit( limit );
+
+        subBatch->request->getDeleteRequest()->addToDeletes( deleteDoc.release() );
+        subBatch->opIndexes.push_back( (int)_numOps++ );
+        subBatch->sizeBytes += query.objsize();
+    }
+
+    bool BulkOperationBuilder::execute( const BSONObj& writeConcern,
+                                        BatchedCommandResponse* response ) {
+        verify( ! _executed );
+        _executed = true;
+
+        const NamespaceString nss( _ns );
+
+        response->clear();
+        response->setOk( true );
+
+        long long n = 0;
+        bool hadError = false;
+
+        for ( size_t i = 0; i < _subBatches.size(); i++ ) {
+
+            SubBatch& subBatch = _subBatches[i];
+            BatchedCommandRequest* request = subBatch.request.get();
+
+            // We use the full namespace internally, but the command is sent to a
+            // database with the collection name in the request
+            request->setNS( nss.coll() );
+            request->setOrdered( _ordered );
+            if ( ! writeConcern.isEmpty() )
+                request->setWriteConcern( writeConcern );
+
+            BSONObj result;
+            _client->runCommand( nss.db().toString(), request->toBSON(), result );
+
+            BatchedCommandResponse subResponse;
+            string errMsg;
+            if ( ! subResponse.parseBSON( result, &errMsg ) ) {
+                response->setOk( false );
+                response->setErrCode( ErrorCodes::FailedToParse );
+                const string parseErrMsg = str::stream()
+                    << "could not parse write command response: " << errMsg;
+                response->setErrMessage( parseErrMsg );
+                return false;
+            }
+
+            if ( ! subResponse.getOk() ) {
+                // The whole sub-batch failed to apply
+                response->setOk( false );
+                if ( subResponse.isErrCodeSet() )
+                    response->setErrCode( subResponse.getErrCode() );
+                if ( subResponse.isErrMessageSet() )
+                    response->setErrMessage( subResponse.getErrMessage() );
+                return false;
+            }
+
+            if ( subResponse.isNSet() )
+                n += subResponse.getN();
+
+            // Remap upserted ids and write errors back to append-order indexes
+            if ( subResponse.isUpsertDetailsSet() ) {
+                const vector<BatchedUpsertDetail*>& upserts = subResponse.getUpsertDetails();
+                for ( size_t j = 0; j < upserts.size(); j++ ) {
+                    auto_ptr<BatchedUpsertDetail> upsert( new BatchedUpsertDetail );
+                    upserts[j]->cloneTo( upsert.get() );
+                    upsert->setIndex( subBatch.opIndexes[upserts[j]->getIndex()] );
+                    response->addToUpsertDetails( upsert.release() );
+                }
+            }
+
+            if ( subResponse.isErrDetailsSet() ) {
+                hadError = true;
+                const vector<WriteErrorDetail*>& errors = subResponse.getErrDetails();
+                for ( size_t j = 0; j < errors.size(); j++ ) {
+                    auto_ptr<WriteErrorDetail> error( new WriteErrorDetail );
+                    errors[j]->cloneTo( error.get() );
+                    error->setIndex( subBatch.opIndexes[errors[j]->getIndex()] );
+                    response->addToErrDetails( error.release() );
+                }
+
+                if ( _ordered )
+                    break;
+            }
+
+            if ( subResponse.isWriteConcernErrorSet() &&
+                 ! response->isWriteConcernErrorSet() ) {
+                response->setWriteConcernError( *subResponse.getWriteConcernError() );
+            }
+        }
+
+        response->setN( n );
+        return ! hadError;
+    }
+
+} // namespace mongo
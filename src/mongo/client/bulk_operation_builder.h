@@ -0,0 +1,110 @@
+/** @file bulk_operation_builder.h */
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+#include <string>
+#include <vector>
+
+#include "mongo/client/dbclientinterface.h"
+#include "mongo/client/export_macros.h"
+#include "mongo/s/write_ops/batched_command_request.h"
+#include "mongo/s/write_ops/batched_command_response.h"
+
+namespace mongo {
+
+    /**
+     * Accumulates client-side writes into server write command batches
+     * ("insert"/"update"/"delete" commands) and dispatches them on execute(),
+     * so callers get the server's batch write path without hand-rolling the
+     * batching.  Sub-batches split automatically at the server's op count cap
+     * and at the maximum command size.
+     *
+     * An ordered builder preserves append order: consecutive ops of the same
+     * type form one sub-batch, sub-batches run one after another, and execution
+     * stops at the first error.  An unordered builder groups ops of the same
+     * type together regardless of append order and keeps executing after
+     * errors.
+     *
+     * Write errors in the merged response are reported with the index the op
+     * had in append order, as a caller of insert()/update()/remove() saw them.
+     *
+     * Not thread safe.  Single use: append ops, then execute() once.
+     */
+    class MONGO_CLIENT_API BulkOperationBuilder : boost::noncopyable {
+    public:
+
+        /**
+         * @param client connection the batches will be dispatched on
+         * @param ns full namespace the writes apply to
+         * @param ordered whether the ops must be applied in append order
+         */
+        BulkOperationBuilder( DBClientBase* client, const std::string& ns, bool ordered );
+
+        void insert( const BSONObj& doc );
+
+        void update( const BSONObj& query, const BSONObj& updateExpr, bool upsert, bool multi );
+
+        /** @param limit 0 removes all matching documents, 1 removes only the first */
+        void remove( const BSONObj& query, int limit = 0 );
+
+        /** @return number of ops appended so far */
+        std::size_t numOps() const { return _numOps; }
+
+        /**
+         * Dispatches all accumulated sub-batches and merges their results into
+         * response (n, upserted ids and write errors, with op indexes mapped
+         * back to append order).
+         *
+         * @param writeConcern write concern for every sub-batch, may be empty
+         * @return true if every op applied without a write error
+         */
+        bool execute( const BSONObj& writeConcern, BatchedCommandResponse* response );
+
+    private:
+
+        /** One write command request plus the append-order index of each of its ops. */
+        struct SubBatch {
+            SubBatch( BatchedCommandRequest* request ) :
+                request( request ), sizeBytes( 0 ) {
+            }
+
+            boost::shared_ptr<BatchedCommandRequest> request;
+            std::vector<int> opIndexes;
+            int sizeBytes;
+        };
+
+        /**
+         * @return the sub-batch the next op should be appended to, opening a new one
+         * when the type changes (ordered only), the op cap is reached, or adding
+         * opSizeBytes would exceed the command size budget.
+         */
+        SubBatch* _targetSubBatch( BatchedCommandRequest::BatchType type, int opSizeBytes );
+
+        DBClientBase* _client;
+        const std::string _ns;
+        const bool _ordered;
+
+        std::vector<SubBatch> _subBatches;
+        // per-type index into _subBatches of the open sub-batch, -1 if none (unordered)
+        int _openSubBatch[3];
+        std::size_t _numOps;
+        bool _executed;
+    };
+
+} // namespace mongo
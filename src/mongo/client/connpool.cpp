@@ -24,6 +24,7 @@
 #include "mongo/client/dbclient_rs.h"
 #include "mongo/client/syncclusterconnection.h"
 #include "mongo/s/shard.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -167,29 +168,40 @@ namespace mongo {
     }
 
     unsigned PoolForHost::_maxPerHost = 50;
+    unsigned PoolForHost::_minIdlePerHost = 0;
 
     // ------ DBConnectionPool ------
 
     DBConnectionPool pool;
 
-    DBConnectionPool::DBConnectionPool() 
-        : _mutex("DBConnectionPool") , 
-          _name( "dbconnectionpool" ) , 
-          _hooks( new list<DBConnectionHook*>() ) { 
+    DBConnectionPool::DBConnectionPool()
+        : _name( "dbconnectionpool" ) ,
+          _hooks( new list<DBConnectionHook*>() ) {
+    }
+
+    DBConnectionPool::Stripe& DBConnectionPool::_stripeFor( const string& ident ) {
+        // hosts whose names compare equal under serverNameCompare share a map
+        // entry, so hash only the part of the name that comparison looks at
+        size_t h = 0;
+        for ( const char* p = ident.c_str(); *p && *p != '/'; ++p )
+            h = h * 131 + (unsigned char)*p;
+        return _stripes[ h % NumStripes ];
     }
 
     DBClientBase* DBConnectionPool::_get(const string& ident , double socketTimeout ) {
         verify( ! inShutdown() );
-        scoped_lock L(_mutex);
-        PoolForHost& p = _pools[PoolKey(ident,socketTimeout)];
+        Stripe& stripe = _stripeFor( ident );
+        scoped_lock L(stripe.mutex);
+        PoolForHost& p = stripe.pools[PoolKey(ident,socketTimeout)];
         p.initializeHostName(ident);
         return p.get( this , socketTimeout );
     }
 
     DBClientBase* DBConnectionPool::_finishCreate( const string& host , double socketTimeout , DBClientBase* conn ) {
         {
-            scoped_lock L(_mutex);
-            PoolForHost& p = _pools[PoolKey(host,socketTimeout)];
+            Stripe& stripe = _stripeFor( host );
+            scoped_lock L(stripe.mutex);
+            PoolForHost& p = stripe.pools[PoolKey(host,socketTimeout)];
             p.initializeHostName(host);
             p.createdOne( conn );
         }
@@ -207,6 +219,8 @@ namespace mongo {
     }
 
     DBClientBase* DBConnectionPool::get(const ConnectionString& url, double socketTimeout) {
+        Timer acquireTimer;
+
         DBClientBase * c = _get( url.toString() , socketTimeout );
         if ( c ) {
             try {
@@ -216,6 +230,7 @@ namespace mongo {
                 delete c;
                 throw;
             }
+            _recordAcquire( acquireTimer.micros() , false );
             return c;
         }
 
@@ -223,10 +238,14 @@ namespace mongo {
         c = url.connect( errmsg, socketTimeout );
         uassert( 13328 ,  _name + ": connect failed " + url.toString() + " : " + errmsg , c );
 
-        return _finishCreate( url.toString() , socketTimeout , c );
+        c = _finishCreate( url.toString() , socketTimeout , c );
+        _recordAcquire( acquireTimer.micros() , true );
+        return c;
     }
 
     DBClientBase* DBConnectionPool::get(const string& host, double socketTimeout) {
+        Timer acquireTimer;
+
         DBClientBase * c = _get( host , socketTimeout );
         if ( c ) {
             try {
@@ -236,6 +255,7 @@ namespace mongo {
                 delete c;
                 throw;
             }
+            _recordAcquire( acquireTimer.micros() , false );
             return c;
         }
 
@@ -246,12 +266,22 @@ namespace mongo {
         c = cs.connect( errmsg, socketTimeout );
         if ( ! c )
             throw SocketException( SocketException::CONNECT_ERROR , host , 11002 , str::stream() << _name << " error: " << errmsg );
-        return _finishCreate( host , socketTimeout , c );
+        c = _finishCreate( host , socketTimeout , c );
+        _recordAcquire( acquireTimer.micros() , true );
+        return c;
+    }
+
+    void DBConnectionPool::_recordAcquire( long long micros , bool newConn ) {
+        _numAcquires.fetchAndAdd( 1 );
+        if ( newConn )
+            _numAcquiresNewConn.fetchAndAdd( 1 );
+        _acquireWaitMicros.fetchAndAdd( micros );
     }
 
     void DBConnectionPool::release(const string& host, DBClientBase *c) {
-        scoped_lock L(_mutex);
-        _pools[PoolKey(host,c->getSoTimeout())].done(this,c);
+        Stripe& stripe = _stripeFor( host );
+        scoped_lock L(stripe.mutex);
+        stripe.pools[PoolKey(host,c->getSoTimeout())].done(this,c);
     }
 
 
@@ -260,25 +290,30 @@ namespace mongo {
     }
 
     void DBConnectionPool::flush() {
-        scoped_lock L(_mutex);
-        for ( PoolMap::iterator i = _pools.begin(); i != _pools.end(); i++ ) {
-            PoolForHost& p = i->second;
-            p.flush();
+        for ( int s = 0; s < NumStripes; s++ ) {
+            scoped_lock L(_stripes[s].mutex);
+            for ( PoolMap::iterator i = _stripes[s].pools.begin(); i != _stripes[s].pools.end(); i++ ) {
+                PoolForHost& p = i->second;
+                p.flush();
+            }
         }
     }
 
     void DBConnectionPool::clear() {
-        scoped_lock L(_mutex);
         LOG(2) << "Removing connections on all pools owned by " << _name  << endl;
-        for (PoolMap::iterator iter = _pools.begin(); iter != _pools.end(); ++iter) {
-            iter->second.clear();
+        for ( int s = 0; s < NumStripes; s++ ) {
+            scoped_lock L(_stripes[s].mutex);
+            for (PoolMap::iterator iter = _stripes[s].pools.begin(); iter != _stripes[s].pools.end(); ++iter) {
+                iter->second.clear();
+            }
         }
     }
 
     void DBConnectionPool::removeHost( const string& host ) {
-        scoped_lock L(_mutex);
         LOG(2) << "Removing connections from all pools for host: " << host << endl;
-        for ( PoolMap::iterator i = _pools.begin(); i != _pools.end(); ++i ) {
+        Stripe& stripe = _stripeFor( host );
+        scoped_lock L(stripe.mutex);
+        for ( PoolMap::iterator i = stripe.pools.begin(); i != stripe.pools.end(); ++i ) {
             const string& poolHost = i->first.ident;
             if ( !serverNameCompare()(host, poolHost) && !serverNameCompare()(poolHost, host) ) {
                 // hosts are the same
@@ -329,9 +364,9 @@ namespace mongo {
         set<string> replicaSets;
         
         BSONObjBuilder bb( b.subobjStart( "hosts" ) );
-        {
-            scoped_lock lk( _mutex );
-            for ( PoolMap::iterator i=_pools.begin(); i!=_pools.end(); ++i ) {
+        for ( int si = 0; si < NumStripes; si++ ) {
+            scoped_lock lk( _stripes[si].mutex );
+            for ( PoolMap::iterator i=_stripes[si].pools.begin(); i!=_stripes[si].pools.end(); ++i ) {
                 if ( i->second.numCreated() == 0 )
                     continue;
 
@@ -379,6 +414,10 @@ namespace mongo {
 
         b.append( "totalAvailable" , avail );
         b.appendNumber( "totalCreated" , created );
+
+        b.appendNumber( "acquires" , _numAcquires.load() );
+        b.appendNumber( "acquiresWithNewConnection" , _numAcquiresNewConn.load() );
+        b.appendNumber( "acquireWaitTimeMicros" , _acquireWaitMicros.load() );
     }
 
     bool DBConnectionPool::serverNameCompare::operator()( const string& a , const string& b ) const{
@@ -427,8 +466,9 @@ namespace mongo {
         }
 
         {
-            scoped_lock sl(_mutex);
-            PoolForHost& pool = _pools[PoolKey(hostName, conn->getSoTimeout())];
+            Stripe& stripe = _stripeFor(hostName);
+            scoped_lock sl(stripe.mutex);
+            PoolForHost& pool = stripe.pools[PoolKey(hostName, conn->getSoTimeout())];
             if (pool.isBadSocketCreationTime(conn->getSockCreationMicroSec())) {
                 return false;
             }
@@ -437,15 +477,36 @@ namespace mongo {
         return true;
     }
 
-    void DBConnectionPool::taskDoWork() { 
+    void DBConnectionPool::taskDoWork() {
         vector<DBClientBase*> toDelete;
-        
-        {
+
+        struct WarmTarget {
+            string ident;
+            double timeout;
+            int need;
+        };
+        vector<WarmTarget> toWarm;
+
+        const unsigned minIdle = PoolForHost::getMinIdlePerHost();
+
+        for ( int si = 0; si < NumStripes; si++ ) {
             // we need to get the connections inside the lock
             // but we can actually delete them outside
-            scoped_lock lk( _mutex );
-            for ( PoolMap::iterator i=_pools.begin(); i!=_pools.end(); ++i ) {
+            scoped_lock lk( _stripes[si].mutex );
+            for ( PoolMap::iterator i=_stripes[si].pools.begin(); i!=_stripes[si].pools.end(); ++i ) {
                 i->second.getStaleConnections( toDelete );
+
+                // only warm hosts we've actually talked to, so the pool doesn't
+                // keep connecting to hosts nothing uses anymore
+                if ( minIdle > 0 &&
+                     i->second.numCreated() > 0 &&
+                     i->second.numAvailable() < (int)minIdle ) {
+                    WarmTarget t;
+                    t.ident = i->first.ident;
+                    t.timeout = i->first.timeout;
+                    t.need = minIdle - i->second.numAvailable();
+                    toWarm.push_back( t );
+                }
             }
         }
 
@@ -458,6 +519,40 @@ namespace mongo {
                 // we don't care if there was a socket error
             }
         }
+
+        // replace aged-out connections and keep minIdle warm ones per host, off
+        // the user's request path
+        for ( size_t i=0; i<toWarm.size(); i++ ) {
+            const WarmTarget& t = toWarm[i];
+            for ( int n = 0; n < t.need; n++ ) {
+                try {
+                    string errmsg;
+                    ConnectionString cs = ConnectionString::parse( t.ident , errmsg );
+                    if ( ! cs.isValid() )
+                        break;
+
+                    DBClientBase* c = cs.connect( errmsg, t.timeout );
+                    if ( ! c ) {
+                        LOG(1) << "connection pool warmer couldn't connect to "
+                               << t.ident << causedBy( errmsg ) << endl;
+                        break;
+                    }
+
+                    onCreate( c );
+
+                    Stripe& stripe = _stripeFor( t.ident );
+                    scoped_lock lk( stripe.mutex );
+                    PoolForHost& p = stripe.pools[PoolKey(t.ident,t.timeout)];
+                    p.createdOne( c );
+                    p.done( this, c );
+                }
+                catch ( const std::exception& e ) {
+                    LOG(1) << "connection pool warmer error for " << t.ident
+                           << causedBy( e ) << endl;
+                    break;
+                }
+            }
+        }
     }
 
     // ------ ScopedDbConnection ------
@@ -21,6 +21,7 @@
 
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/client/export_macros.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/cstdint.h"
 #include "mongo/util/background.h"
 
@@ -87,6 +88,14 @@ namespace mongo {
 
         static void setMaxPerHost( unsigned max ) { _maxPerHost = max; }
         static unsigned getMaxPerHost() { return _maxPerHost; }
+
+        /**
+         * Minimum number of idle connections the background task keeps warm per
+         * host, so a pool miss during a spike doesn't pay connect+auth latency
+         * on the user's query. 0 (the default) disables warming.
+         */
+        static void setMinIdlePerHost( unsigned min ) { _minIdlePerHost = min; }
+        static unsigned getMinIdlePerHost() { return _minIdlePerHost; }
     private:
 
         struct StoredConnection {
@@ -106,6 +115,7 @@ namespace mongo {
         ConnectionString::ConnectionType _type;
 
         static unsigned _maxPerHost;
+        static unsigned _minIdlePerHost;
     };
 
     class DBConnectionHook {
@@ -189,6 +199,8 @@ namespace mongo {
 
         DBClientBase* _finishCreate( const string& ident , double socketTimeout, DBClientBase* conn );
 
+        void _recordAcquire( long long micros , bool newConn );
+
         struct PoolKey {
             PoolKey( const std::string& i , double t ) : ident( i ) , timeout( t ) {}
             string ident;
@@ -201,10 +213,29 @@ namespace mongo {
 
         typedef map<PoolKey,PoolForHost,poolKeyCompare> PoolMap; // servername -> pool
 
-        mongo::mutex _mutex;
+        /**
+         * The pool map is striped by host so checkouts against different hosts
+         * don't serialize on one global mutex. Hosts whose names compare equal
+         * under serverNameCompare always map to the same stripe.
+         */
+        enum { NumStripes = 16 };
+
+        struct Stripe {
+            Stripe() : mutex( "DBConnectionPool::Stripe" ) {}
+            mongo::mutex mutex;
+            PoolMap pools;
+        };
+
+        Stripe& _stripeFor( const string& ident );
+
         string _name;
 
-        PoolMap _pools;
+        Stripe _stripes[NumStripes];
+
+        // lifetime acquisition metrics, reported by appendInfo()
+        AtomicInt64 _numAcquires;
+        AtomicInt64 _numAcquiresNewConn;
+        AtomicInt64 _acquireWaitMicros;
 
         // pointers owned by me, right now they leak on shutdown
         // _hooks itself also leaks because it creates a shutdown race condition
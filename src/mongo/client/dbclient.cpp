@@ -32,6 +32,7 @@
 #include "mongo/util/assert_util.h"
 #include "mongo/util/md5.hpp"
 #include "mongo/util/net/ssl_manager.h"
+#include "mongo/util/time_support.h"
 #include "mongo/util/net/ssl_options.h"
 
 namespace mongo {
@@ -724,6 +725,31 @@ namespace mongo {
         return ok;
     }
 
+    bool DBClientConnection::negotiateWireCompression() {
+        if ( port().isWireCompressed() )
+            return true;
+
+        BSONObj res;
+        if ( ! runCommand( "admin",
+                           BSON( "ismaster" << 1 << "compression" << BSON_ARRAY( "snappy" ) ),
+                           res ) )
+            return false;
+
+        BSONElement accepted = res["compression"];
+        if ( accepted.type() != Array )
+            return false;
+
+        BSONForEach( e , accepted.Obj() ) {
+            if ( e.type() == String && e.str() == "snappy" ) {
+                // the server compresses its side as soon as it sees our offer, so it can
+                // already decode dbCompressed; safe to compress what we send it too
+                port().setWireCompression( true );
+                return true;
+            }
+        }
+        return false;
+    }
+
     bool DBClientWithCommands::createCollection(const string &ns, long long size, bool capped, int max, BSONObj *info) {
         verify(!capped||size);
         BSONObj o;
@@ -1358,6 +1384,10 @@ namespace mongo {
 
     void DBClientConnection::say( Message &toSend, bool isRetry , string * actualServer ) {
         checkConnection();
+        if ( _writeBatchMaxBytes > 0 && !doesOpGetAResponse( toSend.operation() ) ) {
+            _bufferForWriteBatch( toSend );
+            return;
+        }
         try {
             port().say( toSend );
         }
@@ -1367,11 +1397,59 @@ namespace mongo {
         }
     }
 
+    void DBClientConnection::setWriteBatching( int maxBytes, int maxMillis ) {
+        if ( maxBytes <= 0 ) {
+            flushWriteBatch();
+            maxBytes = 0;
+        }
+        _writeBatchMaxBytes = maxBytes;
+        _writeBatchMaxMillis = maxMillis;
+    }
+
+    void DBClientConnection::flushWriteBatch() {
+        if ( _writeBatch.len() == 0 )
+            return;
+        try {
+            port().send( _writeBatch.buf(), _writeBatch.len(), "writeBatch" );
+        }
+        catch( SocketException & ) {
+            _failed = true;
+            _writeBatch.reset();
+            throw;
+        }
+        _writeBatch.reset();
+    }
+
+    void DBClientConnection::_bufferForWriteBatch( Message& toSend ) {
+        // if the oldest buffered message has been waiting too long, push it out before
+        // buffering more; there is no background flusher, so the time bound is only
+        // checked when traffic arrives
+        if ( _writeBatch.len() &&
+             curTimeMillis64() - _writeBatchFirstMillis >=
+                 static_cast<unsigned long long>( _writeBatchMaxMillis ) ) {
+            flushWriteBatch();
+        }
+
+        // fill in the header the way MessagingPort::say would have
+        toSend.header()->id = nextMessageId();
+        toSend.header()->responseTo = 0;
+        toSend.concat();
+        MsgData* md = toSend.singleData();
+
+        if ( _writeBatch.len() == 0 )
+            _writeBatchFirstMillis = curTimeMillis64();
+        _writeBatch.appendBuf( md, md->len );
+
+        if ( _writeBatch.len() >= _writeBatchMaxBytes )
+            flushWriteBatch();
+    }
+
     void DBClientConnection::sayPiggyBack( Message &toSend ) {
         port().piggyBack( toSend );
     }
 
     bool DBClientConnection::recv( Message &m ) {
+        flushWriteBatch();
         if (port().recv(m)) {
             return true;
         }
@@ -1387,6 +1465,7 @@ namespace mongo {
         */
         checkConnection();
         try {
+            flushWriteBatch();
             if ( !port().call(toSend, response) ) {
                 _failed = true;
                 if ( assertOk )
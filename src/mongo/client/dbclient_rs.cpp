@@ -19,6 +19,7 @@
 
 #include "mongo/client/dbclient_rs.h"
 
+#include <boost/thread/thread.hpp>
 #include <fstream>
 #include <memory>
 
@@ -929,42 +930,172 @@ namespace mongo {
         return isMaster;
     }
 
+    /**
+     * One in-flight isMaster probe. Filled in by probeIsMaster so the results of
+     * concurrent probes can be merged serially afterwards.
+     */
+    struct IsMasterProbe {
+        IsMasterProbe() : nodesOffset( -1 ), ok( false ), isMaster( false ),
+                          commandTimeMillis( 0 ) {}
+
+        shared_ptr<DBClientConnection> conn;
+        int nodesOffset;
+
+        // probe results
+        bool ok; // the isMaster call succeeded
+        bool isMaster;
+        int commandTimeMillis;
+        BSONObj reply;
+    };
+
+    /**
+     * Thread body: issues the isMaster call for a single probe. Only touches the
+     * probe and its private connection so probes can run concurrently; failures
+     * are recorded, never thrown. The connection's socket timeout bounds the wait.
+     */
+    static void probeIsMaster( IsMasterProbe* probe ) {
+        try {
+            Timer t;
+            BSONObj o;
+            bool isMaster = false;
+            probe->conn->isMaster( isMaster, &o );
+            probe->commandTimeMillis = t.millis();
+            probe->isMaster = isMaster;
+            probe->reply = o.getOwned();
+            probe->ok = true;
+        }
+        catch ( const std::exception& e ) {
+            LOG(1) << "ReplicaSetMonitor isMaster probe to " << probe->conn->toString()
+                   << " failed: " << e.what() << endl;
+        }
+        catch ( ... ) {
+            LOG(1) << "ReplicaSetMonitor isMaster probe to " << probe->conn->toString()
+                   << " failed with an unknown exception" << endl;
+        }
+    }
+
     void ReplicaSetMonitor::_check() {
         LOG(1) <<  "_check : " << getServerAddress() << endl;
 
+        // One topology refresh at a time. This also keeps isMaster replies matched to
+        // their requests the same way _checkConnection does for single probes.
+        scoped_lock chk( _checkConnectionLock );
+
         int newMaster = -1;
-        shared_ptr<DBClientConnection> nodeConn;
 
         for ( int retry = 0; retry < 2; retry++ ) {
-            for ( unsigned i = 0; /* should not check while outside of lock! */ ; i++ ) {
+
+            // Snapshot the nodes and issue all the isMaster probes concurrently: an
+            // unreachable member costs one socket timeout for the whole pass instead
+            // of a timeout per node, and _lock is never held across a network call.
+            vector<IsMasterProbe> probes;
+            {
+                scoped_lock lk( _lock );
+                probes.resize( _nodes.size() );
+                for ( unsigned i = 0; i < _nodes.size(); i++ ) {
+                    probes[i].nodesOffset = i;
+                    probes[i].conn = _getConnWithRefresh( _nodes[i] );
+                }
+            }
+
+            vector<shared_ptr<boost::thread> > probeThreads;
+            for ( unsigned i = 0; i < probes.size(); i++ ) {
+                if ( probes[i].conn.get() == NULL )
+                    continue;
+                probeThreads.push_back( shared_ptr<boost::thread>(
+                        new boost::thread( boost::bind( probeIsMaster, &probes[i] ) ) ) );
+            }
+
+            for ( unsigned i = 0; i < probeThreads.size(); i++ ) {
+                probeThreads[i]->join();
+            }
+
+            // Merge the results serially
+            for ( unsigned i = 0; i < probes.size(); i++ ) {
+                IsMasterProbe& probe = probes[i];
+
+                if ( probe.conn.get() == NULL )
+                    continue;
+
+                if ( ! probe.ok ) {
+                    scoped_lock lk( _lock );
+                    // Make sure _checkHosts didn't modify the _nodes structure
+                    if ( _checkConnMatch_inlock( probe.conn.get(), probe.nodesOffset ) ) {
+                        _nodes[probe.nodesOffset].ok = false;
+                    }
+                    continue;
+                }
+
+                const BSONObj& o = probe.reply;
+
+                if ( o["setName"].type() != String || o["setName"].String() != _name ) {
+                    warning() << "node: " << probe.conn->getServerAddress()
+                              << " isn't a part of set: " << _name
+                              << " ismaster: " << o << endl;
+
+                    scoped_lock lk( _lock );
+                    if ( _checkConnMatch_inlock( probe.conn.get(), probe.nodesOffset ) ) {
+                        _nodes[probe.nodesOffset].ok = false;
+                    }
+                    continue;
+                }
+
                 {
                     scoped_lock lk( _lock );
-                    if ( i >= _nodes.size() ) break;
-                    nodeConn = _getConnWithRefresh(_nodes[i]);
-                    if (nodeConn.get() == NULL) continue;
+                    if ( _checkConnMatch_inlock( probe.conn.get(), probe.nodesOffset ) ) {
+                        Node& node = _nodes[probe.nodesOffset];
+
+                        if (node.pingTimeMillis == 0) {
+                            node.pingTimeMillis = probe.commandTimeMillis;
+                        }
+                        else {
+                            // update ping time with smoothed moving averaged (1/4th the delta)
+                            node.pingTimeMillis += (probe.commandTimeMillis - node.pingTimeMillis) / 4;
+                        }
+
+                        node.hidden = o["hidden"].trueValue();
+                        node.secondary = o["secondary"].trueValue();
+                        node.ismaster = o["ismaster"].trueValue();
+                        node.ok = node.secondary || node.ismaster;
+
+                        node.lastIsMaster = o.copy();
+                    }
                 }
 
-                string maybePrimary;
-                if ( _checkConnection( nodeConn.get(), maybePrimary, retry, i ) ) {
+                LOG( retry ? 0 : 1 ) << "ReplicaSetMonitor::_check: " << probe.conn->toString()
+                                 << ' ' << o << endl;
+
+                // add other nodes
+                BSONArrayBuilder b;
+                if ( o["hosts"].type() == Array ) {
+                    BSONObjIterator it( o["hosts"].Obj() );
+                    while( it.more() ) b.append( it.next() );
+                }
+
+                if (o.hasField("passives") && o["passives"].type() == Array) {
+                    BSONObjIterator it( o["passives"].Obj() );
+                    while( it.more() ) b.append( it.next() );
+                }
+
+                bool changed = false;
+                _checkHosts( b.arr(), changed );
+
+                if ( changed && _hook )
+                    _hook( this );
+
+                if ( probe.isMaster ) {
                     scoped_lock lk( _lock );
-                    if ( _checkConnMatch_inlock( nodeConn.get(), i )) {
-                        newMaster = i;
+                    if ( _checkConnMatch_inlock( probe.conn.get(), probe.nodesOffset ) ) {
+                        newMaster = probe.nodesOffset;
                         if ( newMaster != _master ) {
                             log() << "Primary for replica set " << _name
                                   << " changed to " << _nodes[newMaster].addr << endl;
                         }
-                        _master = i;
-                    }
-                    else {
-                        /*
-                         * Somebody modified _nodes and most likely set the new
-                         * _master, so try again.
-                         */
-                        break;
+                        _master = probe.nodesOffset;
                     }
                 }
             }
-            
+
             if ( newMaster >= 0 )
                 return;
 
@@ -1080,9 +1211,23 @@ namespace mongo {
         HostAndPort candidate;
 
         {
+            // Select from a snapshot of the topology so selection never waits behind
+            // a refresh merging probe results into _nodes.
+            vector<Node> nodesSnapshot;
+            HostAndPort lastHost;
+            int localThresholdMillis;
+            {
+                scoped_lock lk(_lock);
+                nodesSnapshot = _nodes;
+                lastHost = _lastReadPrefHost;
+                localThresholdMillis = _localThresholdMillis;
+            }
+
+            candidate = ReplicaSetMonitor::selectNode(nodesSnapshot, preference, tags,
+                    localThresholdMillis, &lastHost, isPrimarySelected);
+
             scoped_lock lk(_lock);
-            candidate = ReplicaSetMonitor::selectNode(_nodes, preference, tags,
-                    _localThresholdMillis, &_lastReadPrefHost, isPrimarySelected);
+            _lastReadPrefHost = lastHost;
         }
 
         if (candidate.empty()) {
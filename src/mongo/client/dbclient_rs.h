@@ -303,7 +303,8 @@ namespace mongo {
 
         /**
          * Checks all connections from the host list and sets the current
-         * master.
+         * master. Members are probed concurrently, so one unreachable node
+         * delays the refresh by a single socket timeout, not one per node.
          */
         void _check();
 
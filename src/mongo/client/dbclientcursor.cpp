@@ -19,6 +19,7 @@
 
 #include "mongo/client/dbclientcursor.h"
 
+#include "mongo/client/bson_delta_batch.h"
 #include "mongo/client/connpool.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/namespace_string.h"
@@ -158,6 +159,70 @@ namespace mongo {
         }
     }
 
+    void DBClientCursor::requestMoreLazy() {
+        verify( cursorId );
+        verify( !haveLimit ); // nToReturn bookkeeping would be wrong until the reply arrives
+        verify( !_moreRequested );
+
+        BufBuilder b;
+        b.appendNum(opts);
+        b.appendStr(ns);
+        b.appendNum(nextBatchSize());
+        b.appendNum(cursorId);
+
+        Message toSend;
+        toSend.setData(dbGetMore, b.buf(), b.len());
+
+        if ( ! _client ) {
+            // detached cursor: check a connection out of the pool and hold it until
+            // the reply is consumed, as requestMore() does for a single round trip
+            verify( _scopedHost.size() );
+            _lazyConn.reset( new ScopedDbConnection( _scopedHost ) );
+            _client = _lazyConn->get();
+        }
+
+        _client->say( toSend );
+        _moreRequested = true;
+    }
+
+    void DBClientCursor::requestMoreLazyFinish() {
+        verify( _moreRequested );
+        _moreRequested = false;
+
+        auto_ptr<Message> response(new Message());
+        if ( !_client->recv(*response) ) {
+            if ( _lazyConn ) {
+                // don't return a connection with a missing reply to the pool
+                _lazyConn->kill();
+                _lazyConn.reset();
+                _client = 0;
+            }
+            uasserted( 17468, "recv failed while waiting for a lazily requested batch" );
+        }
+        batch.m = response;
+        dataReceived();
+
+        if ( _lazyConn ) {
+            _client = 0;
+            _lazyConn->done();
+            _lazyConn.reset();
+        }
+    }
+
+    void DBClientCursor::prefetchMore() {
+        if ( _moreRequested || cursorId == 0 || haveLimit )
+            return;
+        if ( opts & ( QueryOption_Exhaust | QueryOption_CursorTailable ) )
+            return;
+        if ( _client && ! _client->lazySupported() )
+            return;
+        if ( ! _client && _scopedHost.empty() )
+            return;
+        if ( batch.pos * 2 < batch.nReturned )
+            return; // less than half consumed, too early to ask for more
+        requestMoreLazy();
+    }
+
     /** with QueryOption_Exhaust, the server just blasts data at us (marked at end with cursorid==0). */
     void DBClientCursor::exhaustReceiveMore() {
         verify( cursorId && batch.pos == batch.nReturned );
@@ -198,6 +263,19 @@ namespace mongo {
         batch.pos = 0;
         batch.data = qr->data();
 
+        if ( ( opts & QueryOption_DeltaBatch ) && ! wasError && batch.nReturned == 1 ) {
+            // the server may have replaced the batch with a single delta-encoded
+            // envelope document; decode it so next() walks plain documents as usual.
+            // _deltaDecoded stays valid until the next batch arrives, matching the
+            // lifetime of a normal batch buffer.
+            BSONObj first( batch.data );
+            if ( BSONDeltaBatch::isDeltaBatch( first ) ) {
+                _deltaDecoded.reset();
+                batch.nReturned = BSONDeltaBatch::decode( first, _deltaDecoded );
+                batch.data = _deltaDecoded.buf();
+            }
+        }
+
         _client->checkResponse( batch.data, batch.nReturned, &retry, &host ); // watches for "not master"
 
         if( qr->resultFlags() & ResultFlag_ShardConfigStale ) {
@@ -227,7 +305,12 @@ namespace mongo {
         if ( cursorId == 0 )
             return false;
 
-        requestMore();
+        if ( _moreRequested )
+            requestMoreLazyFinish();
+        else if ( opts & QueryOption_Exhaust )
+            exhaustReceiveMore(); // the server streams batches on its own; just receive
+        else
+            requestMore();
         return batch.pos < batch.nReturned;
     }
 
@@ -245,6 +328,10 @@ namespace mongo {
         BSONObj o(batch.data);
         batch.data += o.objsize();
         /* todo would be good to make data null at end of batch for safety */
+
+        if ( _prefetch )
+            prefetchMore(); // no-op until the batch is half drained, or if one is in flight
+
         return o;
     }
 
@@ -322,6 +409,12 @@ namespace mongo {
 
         DESTRUCTOR_GUARD (
 
+        if ( _moreRequested ) {
+            // a lazily requested reply is still in flight; receive it so the
+            // connection is left in a usable state
+            requestMoreLazyFinish();
+        }
+
         if ( cursorId && _ownCursor && ! inShutdown() ) {
             BufBuilder b;
             b.appendNum( (int)0 ); // reserved
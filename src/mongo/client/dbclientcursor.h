@@ -30,6 +30,7 @@
 namespace mongo {
 
     class AScopedConnection;
+    class ScopedDbConnection;
 
     /** for mock purposes only -- do not create variants of DBClientCursor, nor hang code here
         @see DBClientMockCursor
@@ -133,6 +134,35 @@ namespace mongo {
         /// Change batchSize after construction. Can change after requesting first batch.
         void setBatchSize(int newBatchSize) { batchSize = newBatchSize; }
 
+        /** Sends the getMore request for the next batch without waiting for the reply, so
+            the server can prepare it while the caller does other work (e.g. drains other
+            cursors). more() completes the exchange when the data is needed. May be called
+            mid-batch; the current batch stays readable until the reply is consumed. On a
+            cursor detached from its connection (see attach()) this checks a connection out
+            of the pool and holds it until the reply arrives. A connection with a lazily
+            requested batch outstanding must not be handed back to a pool.
+        */
+        void requestMoreLazy();
+
+        /** Blocks until the batch requested by requestMoreLazy() has been received. */
+        void requestMoreLazyFinish();
+
+        /** True if a requestMoreLazy() reply has not been received yet. */
+        bool moreRequested() const { return _moreRequested; }
+
+        /** Calls requestMoreLazy() once the current batch is at least half consumed, so
+            the next batch streams in while the caller drains the remainder. No-op when a
+            request is already outstanding or the cursor can't pipeline (dead, limited,
+            tailable, exhaust, or on a connection without lazy support).
+        */
+        void prefetchMore();
+
+        /** Opt in to automatic prefetching: next() calls prefetchMore() as the batch
+            drains, so sequential scans overlap the next getMore with local work and
+            more() rarely blocks. Same restrictions as prefetchMore(); off by default.
+        */
+        void setPrefetch( bool on ) { _prefetch = on; }
+
         DBClientCursor( DBClientBase* client, const string &_ns, BSONObj _query, int _nToReturn,
                         int _nToSkip, const BSONObj *_fieldsToReturn, int queryOptions , int bs ) :
             _client(client),
@@ -147,7 +177,9 @@ namespace mongo {
             resultFlags(0),
             cursorId(),
             _ownCursor( true ),
-            wasError( false ) {
+            wasError( false ),
+            _moreRequested( false ),
+            _prefetch( false ) {
             _finishConsInit();
         }
 
@@ -163,7 +195,9 @@ namespace mongo {
             resultFlags(0),
             cursorId(_cursorId),
             _ownCursor(true),
-            wasError(false) {
+            wasError(false),
+            _moreRequested(false),
+            _prefetch(false) {
             _finishConsInit();
         }
 
@@ -237,6 +271,10 @@ namespace mongo {
         string _scopedHost;
         string _lazyHost;
         bool wasError;
+        bool _moreRequested; // see requestMoreLazy()
+        bool _prefetch; // see setPrefetch()
+        scoped_ptr<ScopedDbConnection> _lazyConn; // held while a lazy batch is in flight on a detached cursor
+        BufBuilder _deltaDecoded; // decoded documents when the server delta-encoded a batch; batch.data points here
 
         void dataReceived() { bool retry; string lazyHost; dataReceived( retry, lazyHost ); }
         void dataReceived( bool& retry, string& lazyHost );
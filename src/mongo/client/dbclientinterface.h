@@ -84,7 +84,16 @@ namespace mongo {
          */
         QueryOption_PartialResults = 1 << 7 ,
 
-        QueryOption_AllSupported = QueryOption_CursorTailable | QueryOption_SlaveOk | QueryOption_OplogReplay | QueryOption_NoCursorTimeout | QueryOption_AwaitData | QueryOption_Exhaust | QueryOption_PartialResults
+        /** Use with QueryOption_CursorTailable on a capped collection (e.g. the oplog).
+            The server may then replace a getMore batch with a single delta-encoded
+            envelope document which DBClientCursor decodes transparently; consecutive
+            oplog entries share most of their bytes so this can cut tailing bandwidth
+            severalfold.  Independent of (and stackable with) wire compression.
+            See BSONDeltaBatch.
+         */
+        QueryOption_DeltaBatch = 1 << 8 ,
+
+        QueryOption_AllSupported = QueryOption_CursorTailable | QueryOption_SlaveOk | QueryOption_OplogReplay | QueryOption_NoCursorTimeout | QueryOption_AwaitData | QueryOption_Exhaust | QueryOption_PartialResults | QueryOption_DeltaBatch
 
     };
 
@@ -1170,11 +1179,20 @@ namespace mongo {
            Connect timeout is fixed, but short, at 5 seconds.
          */
         DBClientConnection(bool _autoReconnect=false, DBClientReplicaSet* cp=0, double so_timeout=0) :
-            clientSet(cp), _failed(false), autoReconnect(_autoReconnect), autoReconnectBackoff(1000, 2000), _so_timeout(so_timeout) {
+            clientSet(cp), _failed(false), autoReconnect(_autoReconnect), autoReconnectBackoff(1000, 2000), _so_timeout(so_timeout),
+            _writeBatchMaxBytes(0), _writeBatchMaxMillis(0), _writeBatchFirstMillis(0) {
             _numConnections++;
         }
 
         virtual ~DBClientConnection() {
+            if ( _writeBatch.len() ) {
+                try {
+                    flushWriteBatch();
+                }
+                catch ( ... ) {
+                    // connection is going away; these writes were unacknowledged anyway
+                }
+            }
             _numConnections--;
         }
 
@@ -1229,6 +1247,13 @@ namespace mongo {
          */
         virtual void logout(const string& dbname, BSONObj& info);
 
+        /** Offer the server (via isMaster) snappy compression of messages on this
+            connection.  If the server accepts, both directions are compressed from
+            here on.  No-op against servers that don't support wire compression.
+            @return true if compression is now enabled
+        */
+        bool negotiateWireCompression();
+
         virtual auto_ptr<DBClientCursor> query(const string &ns, Query query=Query(), int nToReturn = 0, int nToSkip = 0,
                                                const BSONObj *fieldsToReturn = 0, int queryOptions = 0 , int batchSize = 0 ) {
             checkConnection();
@@ -1280,6 +1305,19 @@ namespace mongo {
 
         virtual bool lazySupported() const { return true; }
 
+        /** Coalesce consecutive fire-and-forget say() messages (insert/update/delete/
+            killcursors) and write them to the socket in one send.  The buffer is
+            flushed when it reaches maxBytes, when the oldest buffered message is
+            older than maxMillis at the time another arrives, and always before
+            anything that reads from the connection (call()/recv()), so ordering is
+            preserved.  maxBytes of 0 (the default) disables batching and flushes
+            anything pending.
+        */
+        void setWriteBatching( int maxBytes, int maxMillis = 10 );
+
+        /** send any say() messages buffered by setWriteBatching() now */
+        void flushWriteBatch();
+
         static int getNumConnections() {
             return _numConnections;
         }
@@ -1321,6 +1359,13 @@ namespace mongo {
 
         map<string, BSONObj> authCache;
         double _so_timeout;
+
+        // write batching - see setWriteBatching()
+        void _bufferForWriteBatch( Message& toSend );
+        BufBuilder _writeBatch;
+        int _writeBatchMaxBytes;
+        int _writeBatchMaxMillis;
+        unsigned long long _writeBatchFirstMillis;
         bool _connect( string& errmsg );
 
         static AtomicUInt _numConnections;
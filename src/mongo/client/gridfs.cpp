@@ -40,6 +40,10 @@ namespace mongo {
 
     const unsigned DEFAULT_CHUNK_SIZE = 256 * 1024;
 
+    // Chunks are batched into single insert messages up to this many bytes on
+    // upload, so throughput isn't bounded by one message per chunk.
+    const unsigned MAX_PENDING_INSERT_BYTES = 4 * 1024 * 1024;
+
     GridFSChunk::GridFSChunk( BSONObj o ) {
         _data = o;
     }
@@ -83,15 +87,27 @@ namespace mongo {
         BSONObj idObj = BSON("_id" << id);
 
         int chunkNumber = 0;
+        vector<BSONObj> pending;
+        unsigned pendingBytes = 0;
         while (data < end) {
             int chunkLen = MIN(_chunkSize, (unsigned)(end-data));
             GridFSChunk c(idObj, chunkNumber, data, chunkLen);
-            _client.insert( _chunksNS.c_str() , c._data );
+            pending.push_back( c._data );
+            pendingBytes += c._data.objsize();
+
+            if ( pendingBytes >= MAX_PENDING_INSERT_BYTES ) {
+                _client.insert( _chunksNS.c_str() , pending );
+                pending.clear();
+                pendingBytes = 0;
+            }
 
             chunkNumber++;
             data += chunkLen;
         }
 
+        if ( ! pending.empty() )
+            _client.insert( _chunksNS.c_str() , pending );
+
         return insertFile(remoteName, id, length, contentType);
     }
 
@@ -112,6 +128,8 @@ namespace mongo {
 
         int chunkNumber = 0;
         gridfs_offset length = 0;
+        vector<BSONObj> pending;
+        unsigned pendingBytes = 0;
         while (!feof(fd)) {
             //boost::scoped_array<char>buf (new char[_chunkSize+1]);
             char * buf = new char[_chunkSize+1];
@@ -126,13 +144,23 @@ namespace mongo {
             }
 
             GridFSChunk c(idObj, chunkNumber, buf, chunkLen);
-            _client.insert( _chunksNS.c_str() , c._data );
+            pending.push_back( c._data ); // the chunk owns a copy of buf's bytes
+            pendingBytes += c._data.objsize();
+
+            if ( pendingBytes >= MAX_PENDING_INSERT_BYTES ) {
+                _client.insert( _chunksNS.c_str() , pending );
+                pending.clear();
+                pendingBytes = 0;
+            }
 
             length += chunkLen;
             chunkNumber++;
             delete[] buf;
         }
 
+        if ( ! pending.empty() )
+            _client.insert( _chunksNS.c_str() , pending );
+
         if (fd != stdin)
             fclose( fd );
 
@@ -232,14 +260,35 @@ namespace mongo {
 
         const int num = getNumChunks();
 
-        for ( int i=0; i<num; i++ ) {
-            GridFSChunk c = getChunk( i );
+        // Stream every chunk from one range query ordered by chunk number instead of
+        // a findOne round trip per chunk. The cursor prefetches the next batch while
+        // the current one is written out, overlapping the transfer with the output.
+        BSONObjBuilder b;
+        b.appendAs( _obj["_id"] , "files_id" );
+        Query q( b.obj() );
+        q.sort( BSON( "n" << 1 ) );
+
+        auto_ptr<DBClientCursor> cursor = _grid->_client.query( _grid->_chunksNS.c_str() , q );
+        uassert( 17476 , "couldn't open cursor to fetch GridFS chunks" , cursor.get() );
+        cursor->setPrefetch( true );
+
+        int n = 0;
+        while ( cursor->more() ) {
+            BSONObj o = cursor->next();
+            uassert( 17477 , str::stream() << "chunks out of order or missing for file: "
+                     << getFilename() << ", expected chunk: " << n ,
+                     o["n"].numberInt() == n );
 
+            GridFSChunk c( o );
             int len;
             const char * data = c.data( len );
             out.write( data , len );
+            n++;
         }
 
+        uassert( 10014 , str::stream() << "chunk is empty! expected: " << num
+                 << " chunks, got: " << n , n == num );
+
         return getContentLength();
     }
 
@@ -243,6 +243,11 @@ namespace mongo {
 
         while ( _cursor->more() ) {
             _next = _cursor->next();
+
+            // once half of this batch is consumed the next one is requested, so it
+            // streams in from the shard while the merge drains the remainder
+            _cursor->prefetchMore();
+
             if ( _matcher.matches( _next ) ) {
                 if ( ! _cursor->moreInCurrentBatch() )
                     _next = _next.getOwned();
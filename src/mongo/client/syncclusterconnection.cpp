@@ -20,6 +20,8 @@
 
 #include "mongo/client/syncclusterconnection.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/dbmessage.h"
@@ -78,50 +80,87 @@ namespace mongo {
         return fsync( errmsg );
     }
 
+    /**
+     * Thread body: runs the fsync round against a single server. Only touches its own
+     * connection and output slot, so the rounds for all servers can run concurrently;
+     * failures are recorded, never thrown.
+     */
+    static void syncFsyncOne( DBClientConnection* conn, string* err ) {
+        try {
+            // this is fsync=true
+            // which with journalling on is a journal commit
+            // without journalling, is a full fsync
+            conn->simpleCommand( "admin", NULL, "resetError" );
+            *err = conn->getLastError( true );
+        }
+        catch ( DBException& e ) {
+            *err = e.toString();
+        }
+        catch ( ... ) {
+            *err = "unknown failure";
+        }
+    }
+
+    /**
+     * Thread body: runs the post-write fsync getlasterror against a single server.
+     */
+    static void syncCheckLastOne( DBClientConnection* conn, BSONObj* res, string* err ) {
+        try {
+            if ( ! conn->runCommand( "admin" , BSON( "getlasterror" << 1 << "fsync" << 1 ) , *res ) )
+                *err = "cmd failed: ";
+        }
+        catch ( std::exception& e ) {
+            *err += e.what();
+        }
+        catch ( ... ) {
+            *err += "unknown failure";
+        }
+        *res = res->getOwned();
+    }
+
     bool SyncClusterConnection::fsync( string& errmsg ) {
         bool ok = true;
         errmsg = "";
-        for ( size_t i=0; i<_conns.size(); i++ ) {
-            string singleErr;
-            try {
-                // this is fsync=true
-                // which with journalling on is a journal commit
-                // without journalling, is a full fsync
-                _conns[i]->simpleCommand( "admin", NULL, "resetError" );
-                singleErr = _conns[i]->getLastError( true );
 
-                if ( singleErr.size() == 0 )
-                    continue;
+        // Fsync every server concurrently - the journal commits overlap, so this
+        // costs the slowest server's round trip instead of the sum of all three.
+        vector<string> errors( _conns.size() );
+        vector<shared_ptr<boost::thread> > threads;
+        for ( size_t i=0; i<_conns.size(); i++ ) {
+            threads.push_back( shared_ptr<boost::thread>(
+                    new boost::thread( boost::bind( syncFsyncOne, _conns[i], &errors[i] ) ) ) );
+        }
+        for ( size_t i=0; i<threads.size(); i++ ) {
+            threads[i]->join();
+        }
 
-            }
-            catch ( DBException& e ) {
-                singleErr = e.toString();
-            }
+        for ( size_t i=0; i<_conns.size(); i++ ) {
+            if ( errors[i].size() == 0 )
+                continue;
             ok = false;
-            errmsg += " " + _conns[i]->toString() + ":" + singleErr;
+            errmsg += " " + _conns[i]->toString() + ":" + errors[i];
         }
         return ok;
     }
 
     void SyncClusterConnection::_checkLast() {
         _lastErrors.clear();
-        vector<string> errors;
 
+        // Gather the fsync getlasterror from every server concurrently, same as fsync()
+        vector<BSONObj> results( _conns.size() );
+        vector<string> errors( _conns.size() );
+        vector<shared_ptr<boost::thread> > threads;
         for ( size_t i=0; i<_conns.size(); i++ ) {
-            BSONObj res;
-            string err;
-            try {
-                if ( ! _conns[i]->runCommand( "admin" , BSON( "getlasterror" << 1 << "fsync" << 1 ) , res ) )
-                    err = "cmd failed: ";
-            }
-            catch ( std::exception& e ) {
-                err += e.what();
-            }
-            catch ( ... ) {
-                err += "unknown failure";
-            }
-            _lastErrors.push_back( res.getOwned() );
-            errors.push_back( err );
+            threads.push_back( shared_ptr<boost::thread>(
+                    new boost::thread( boost::bind( syncCheckLastOne,
+                                                    _conns[i], &results[i], &errors[i] ) ) ) );
+        }
+        for ( size_t i=0; i<threads.size(); i++ ) {
+            threads[i]->join();
+        }
+
+        for ( size_t i=0; i<_conns.size(); i++ ) {
+            _lastErrors.push_back( results[i].getOwned() );
         }
 
         verify( _lastErrors.size() == errors.size() && _lastErrors.size() == _conns.size() );
@@ -0,0 +1,276 @@
+// admission_control.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/admission_control.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/spin_lock.h"
+#include "mongo/util/histogram.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+
+    // gate operations through the read/write ticket pools below.  startup-only:
+    // toggling gating while operations may already hold tickets is not supported.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(admissionControl, bool, false);
+
+    // ceilings for the two pools; the controller never grows past these, and starts
+    // from them.  settable at runtime, picked up on the next controller tick.
+    MONGO_EXPORT_SERVER_PARAMETER(admissionMaxReadConcurrency, int, 128);
+    MONGO_EXPORT_SERVER_PARAMETER(admissionMaxWriteConcurrency, int, 64);
+
+    namespace {
+
+        const int kMinConcurrency = 4;          // never shrink a pool below this
+        const double kDegradeFactor = 2.0;      // p95 beyond baseline*this = degraded
+        const long long kQueueingWaitMicros = 1000; // avg wait above this = queueing
+
+        TicketHolder readPool( 128 );
+        TicketHolder writePool( 64 );
+
+        // interval stats, reset each controller tick
+        AtomicInt64 admitted;
+        AtomicInt64 waitMicrosTotal;
+        AtomicInt32 currentQueued;
+
+        // cumulative, for serverStatus
+        AtomicInt64 totalAdmitted;
+        AtomicInt64 totalWaitMicros;
+
+        SpinLock histLock;
+        Histogram* latencyHist = NULL;  // operation latency (usecs) this interval
+
+        Histogram* newLatencyHistogram() {
+            // exponential buckets from 250usec up to ~4sec
+            Histogram::Options opts;
+            opts.numBuckets = 15;
+            opts.bucketSize = 250;
+            opts.exponential = true;
+            return new Histogram( opts );
+        }
+
+        // smallest bucket boundary at or above the pct-th percentile, 0 if empty
+        uint32_t percentile( const Histogram& h, double pct ) {
+            uint64_t total = 0;
+            for ( uint32_t i = 0; i < h.getBucketsNum(); i++ )
+                total += h.getCount( i );
+            if ( total == 0 )
+                return 0;
+            const uint64_t target = static_cast<uint64_t>( total * pct ) + 1;
+            uint64_t seen = 0;
+            for ( uint32_t i = 0; i < h.getBucketsNum(); i++ ) {
+                seen += h.getCount( i );
+                if ( seen >= target )
+                    return h.getBoundary( i );
+            }
+            return h.getBoundary( h.getBucketsNum() - 1 );
+        }
+
+        // shrink refuses to go below tickets currently handed out
+        void resizeClamped( TicketHolder& pool, int target, int ceiling ) {
+            target = std::min( target, ceiling );
+            target = std::max( target, kMinConcurrency );
+            target = std::max( target, pool.used() );
+            if ( target != pool.outof() )
+                pool.resize( target );
+        }
+
+        class AdmissionController : public BackgroundJob {
+        public:
+            AdmissionController() : _baselineP95( 0 ) {}
+            virtual ~AdmissionController() {}
+
+            virtual string name() const { return "AdmissionController"; }
+
+            virtual void run() {
+                Client::initThread( name().c_str() );
+                while ( !inShutdown() ) {
+                    sleepsecs( 1 );
+                    _tick();
+                }
+                cc().shutdown();
+            }
+
+        private:
+            void _tick() {
+                Histogram* interval;
+                {
+                    scoped_spinlock lk( histLock );
+                    interval = latencyHist;
+                    latencyHist = newLatencyHistogram();
+                }
+                const long long ops = admitted.load();
+                const long long waited = waitMicrosTotal.load();
+                admitted.store( 0 );
+                waitMicrosTotal.store( 0 );
+
+                if ( ops > 0 ) {
+                    const double p95 = percentile( *interval, 0.95 );
+                    const long long avgWait = waited / ops;
+                    const bool queueing = avgWait > kQueueingWaitMicros ||
+                                          currentQueued.load() > 0;
+
+                    if ( _baselineP95 == 0 ) {
+                        _baselineP95 = p95;
+                    }
+                    else if ( queueing && p95 > kDegradeFactor * _baselineP95 ) {
+                        // latency is degrading while ops queue: multiplicative
+                        // decrease, so a bad plan sheds concurrency fast
+                        LOG(1) << "admission: p95 " << p95 << "us (baseline "
+                               << _baselineP95 << "us), shrinking pools" << endl;
+                        resizeClamped( readPool, readPool.outof() * 4 / 5,
+                                       admissionMaxReadConcurrency );
+                        resizeClamped( writePool, writePool.outof() * 4 / 5,
+                                       admissionMaxWriteConcurrency );
+                        delete interval;
+                        return;
+                    }
+                    else {
+                        // healthy: let the baseline drift with the workload
+                        _baselineP95 = 0.95 * _baselineP95 + 0.05 * p95;
+                    }
+                }
+                delete interval;
+
+                // additive increase back toward the ceilings
+                resizeClamped( readPool, readPool.outof() + kMinConcurrency,
+                               admissionMaxReadConcurrency );
+                resizeClamped( writePool, writePool.outof() + kMinConcurrency,
+                               admissionMaxWriteConcurrency );
+            }
+
+            double _baselineP95;  // slow EWMA of healthy interval p95 (usecs)
+        };
+
+        class AdmissionServerStatus : public ServerStatusSection {
+        public:
+            AdmissionServerStatus() : ServerStatusSection( "admission" ) {}
+            virtual bool includeByDefault() const { return admissionControl; }
+
+            virtual BSONObj generateSection( const BSONElement& configElement ) const {
+                BSONObjBuilder b;
+                b.append( "enabled", admissionControl );
+                {
+                    BSONObjBuilder r( b.subobjStart( "readPool" ) );
+                    r.append( "out", readPool.used() );
+                    r.append( "available", readPool.available() );
+                    r.append( "totalTickets", readPool.outof() );
+                    r.done();
+                }
+                {
+                    BSONObjBuilder w( b.subobjStart( "writePool" ) );
+                    w.append( "out", writePool.used() );
+                    w.append( "available", writePool.available() );
+                    w.append( "totalTickets", writePool.outof() );
+                    w.done();
+                }
+                b.appendNumber( "currentQueued", currentQueued.load() );
+                b.appendNumber( "totalAdmitted", totalAdmitted.load() );
+                b.appendNumber( "totalQueueMicros", totalWaitMicros.load() );
+                return b.obj();
+            }
+        } admissionServerStatus;
+
+    }  // namespace
+
+    AdmissionTicket::AdmissionTicket( int op, bool isCommand )
+        : _pool( NULL ), _waitMicros( 0 ) {
+
+        if ( !admissionControl || isCommand )
+            return;
+
+        // nested ops run under the top-level op's ticket; taking a second one
+        // here could deadlock against ourselves
+        if ( haveClient() && cc().curop() && cc().curop()->active() )
+            return;
+
+        switch ( op ) {
+        case dbQuery:
+        case dbGetMore:
+            _pool = &readPool;
+            break;
+        case dbInsert:
+        case dbUpdate:
+        case dbDelete:
+            _pool = &writePool;
+            break;
+        default:
+            return;
+        }
+
+        if ( !_pool->tryAcquire() ) {
+            currentQueued.fetchAndAdd( 1 );
+            _pool->waitForTicket();
+            currentQueued.fetchAndAdd( -1 );
+            _waitMicros = _timer.micros();
+        }
+
+        admitted.fetchAndAdd( 1 );
+        waitMicrosTotal.fetchAndAdd( _waitMicros );
+        totalAdmitted.fetchAndAdd( 1 );
+        totalWaitMicros.fetchAndAdd( _waitMicros );
+    }
+
+    AdmissionTicket::~AdmissionTicket() {
+        if ( !_pool )
+            return;
+        const long long execMicros = _timer.micros() - _waitMicros;
+        {
+            scoped_spinlock lk( histLock );
+            if ( latencyHist )
+                latencyHist->insert( static_cast<uint32_t>(
+                    std::min( execMicros, (long long)std::numeric_limits<int>::max() ) ) );
+        }
+        _pool->release();
+    }
+
+    void startAdmissionControl() {
+        if ( !admissionControl )
+            return;
+        {
+            scoped_spinlock lk( histLock );
+            latencyHist = newLatencyHistogram();
+        }
+        readPool.resize( std::max( (int)admissionMaxReadConcurrency, kMinConcurrency ) );
+        writePool.resize( std::max( (int)admissionMaxWriteConcurrency, kMinConcurrency ) );
+        AdmissionController* controller = new AdmissionController();
+        controller->go();
+        log() << "admission control enabled: " << readPool.outof() << " read / "
+              << writePool.outof() << " write tickets" << endl;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,73 @@
+// admission_control.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include "mongo/util/concurrency/ticketholder.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    /**
+     * Admission control: read and write ticket pools that gate operation start in
+     * assembleResponse(), so the number of operations contending for locks and
+     * memory stays bounded when traffic spikes or a bad plan slows everything down.
+     * A feedback controller watches per-interval queue wait and operation latency
+     * and shrinks the pools when latency degrades under queueing, growing them back
+     * toward the configured ceilings when things are healthy.
+     *
+     * Off by default; enable with --setParameter admissionControl=true.
+     */
+
+    /**
+     * RAII admission gate for one operation.  Acquires a ticket from the read pool
+     * (queries, getmores) or write pool (inserts, updates, deletes) for the life of
+     * the operation; a no-op when admission control is disabled, for commands, for
+     * nested operations (DBDirectClient -- the top-level op already holds a ticket),
+     * and for ops that are neither reads nor writes.
+     */
+    class AdmissionTicket : boost::noncopyable {
+    public:
+        AdmissionTicket( int op, bool isCommand );
+        ~AdmissionTicket();
+
+    private:
+        TicketHolder* _pool;  // NULL when this op is not gated
+        Timer _timer;
+        long long _waitMicros;
+    };
+
+    /** launch the feedback controller thread; call once at startup.
+        no-op unless admissionControl is enabled. */
+    void startAdmissionControl();
+
+}  // namespace mongo
@@ -184,7 +184,8 @@ namespace {
             << ActionType::writeBacksQueued
             << ActionType::cursorInfo
             << ActionType::inprog
-            << ActionType::shardingState;
+            << ActionType::shardingState
+            << ActionType::queryShapeStats;
 
         // clusterMonitor role actions that target a database (or collection) resource
         clusterMonitorRoleDatabaseActions
@@ -228,7 +229,8 @@ namespace {
             << ActionType::removeShard
             << ActionType::listShards // clusterMonitor gets this also
             << ActionType::flushRouterConfig // hostManager gets this also
-            << ActionType::cleanupOrphaned;
+            << ActionType::cleanupOrphaned
+            << ActionType::balancerDryRun;
 
         clusterManagerRoleDatabaseActions
             << ActionType::splitChunk
@@ -0,0 +1,280 @@
+// background_scheduler.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/background_scheduler.h"
+
+#include <deque>
+
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    // size of the shared background worker pool
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER( backgroundWorkerThreads, int, 2 );
+
+    // per-second work-unit budgets for the throttled classes.  0 means unlimited.
+    MONGO_EXPORT_SERVER_PARAMETER( backgroundMaintenanceUnitsPerSecond, int, 0 );
+    MONGO_EXPORT_SERVER_PARAMETER( backgroundLowUnitsPerSecond, int, 0 );
+
+    namespace {
+        const char* priorityName( int pri ) {
+            switch ( pri ) {
+            case BackgroundScheduler::Critical:    return "critical";
+            case BackgroundScheduler::Maintenance: return "maintenance";
+            case BackgroundScheduler::Low:         return "low";
+            }
+            return "unknown";
+        }
+    }
+
+    struct BackgroundScheduler::ClassState {
+        ClassState() : windowStartMillis( 0 ), usedInWindow( 0 ) { }
+
+        std::deque<Task> pending;            // guarded by _mutex
+
+        // current one second budget window; guarded by _mutex
+        unsigned long long windowStartMillis;
+        long long usedInWindow;
+
+        AtomicInt64 scheduled;
+        AtomicInt64 completed;
+        AtomicInt64 unitsUsed;
+        AtomicInt64 throttledMicros;
+    };
+
+    BackgroundScheduler::BackgroundScheduler()
+        : _mutex( "BackgroundScheduler" ),
+          _classes( new ClassState[NumPriorities] ),
+          _pool( NULL ) {
+    }
+
+    long long BackgroundScheduler::_unitsPerSecond( int pri ) const {
+        switch ( pri ) {
+        case Maintenance: return backgroundMaintenanceUnitsPerSecond;
+        case Low:         return backgroundLowUnitsPerSecond;
+        default:          return 0;  // Critical is never throttled
+        }
+    }
+
+    ThreadPool& BackgroundScheduler::_getPool() {
+        SimpleMutex::scoped_lock lk( _mutex );
+        if ( !_pool ) {
+            int n = backgroundWorkerThreads;
+            if ( n < 1 )
+                n = 1;
+            _pool = new ThreadPool( n );
+        }
+        return *_pool;
+    }
+
+    bool BackgroundScheduler::_tryAcquire_inlock( int pri,
+                                                  long long cost,
+                                                  long long* retryMillis ) {
+        const long long budget = _unitsPerSecond( pri );
+        ClassState& cs = _classes[pri];
+
+        unsigned long long now = curTimeMillis64();
+        if ( now - cs.windowStartMillis >= 1000 ) {
+            cs.windowStartMillis = now;
+            cs.usedInWindow = 0;
+        }
+
+        // a class is allowed to overshoot by one batch; what matters is that the
+        // average stays on budget
+        if ( budget <= 0 || cs.usedInWindow < budget ) {
+            cs.usedInWindow += cost;
+            cs.unitsUsed.fetchAndAdd( cost );
+            return true;
+        }
+
+        *retryMillis = cs.windowStartMillis + 1000 - now;
+        if ( *retryMillis < 1 )
+            *retryMillis = 1;
+        return false;
+    }
+
+    void BackgroundScheduler::schedule( Priority pri, const Task& task ) {
+        {
+            SimpleMutex::scoped_lock lk( _mutex );
+            _classes[pri].pending.push_back( task );
+        }
+        _classes[pri].scheduled.fetchAndAdd( 1 );
+        // one pump per submitted task; the pump runs whatever is most urgent
+        _getPool().schedule( boost::bind( &BackgroundScheduler::_runNext, this ) );
+    }
+
+    void BackgroundScheduler::_runNext() {
+        while ( !inShutdown() ) {
+            Task task;
+            int found = -1;
+            long long sleepFor = 0;
+            bool anyPending = false;
+            {
+                SimpleMutex::scoped_lock lk( _mutex );
+                for ( int pri = 0; pri < NumPriorities; pri++ ) {
+                    ClassState& cs = _classes[pri];
+                    if ( cs.pending.empty() )
+                        continue;
+                    anyPending = true;
+                    long long retryMillis;
+                    if ( _tryAcquire_inlock( pri, 1, &retryMillis ) ) {
+                        task = cs.pending.front();
+                        cs.pending.pop_front();
+                        found = pri;
+                        break;
+                    }
+                    if ( sleepFor == 0 || retryMillis < sleepFor )
+                        sleepFor = retryMillis;
+                }
+            }
+
+            if ( found >= 0 ) {
+                task();
+                _classes[found].completed.fetchAndAdd( 1 );
+                return;
+            }
+
+            if ( !anyPending ) {
+                // our task was picked up by another pump
+                return;
+            }
+
+            // everything pending is over budget; sleep out the window
+            sleepmillis( static_cast<int>( sleepFor ) );
+        }
+    }
+
+    void BackgroundScheduler::throttle( Priority pri, long long cost ) {
+        if ( _unitsPerSecond( pri ) <= 0 )
+            return;
+
+        Timer t;
+        while ( !inShutdown() ) {
+            long long retryMillis;
+            {
+                SimpleMutex::scoped_lock lk( _mutex );
+                if ( _tryAcquire_inlock( pri, cost, &retryMillis ) )
+                    break;
+            }
+            sleepmillis( static_cast<int>( retryMillis ) );
+        }
+
+        long long waited = t.micros();
+        if ( waited > 0 )
+            _classes[pri].throttledMicros.fetchAndAdd( waited );
+    }
+
+    void BackgroundScheduler::appendStats( BSONObjBuilder& b ) const {
+        for ( int pri = 0; pri < NumPriorities; pri++ ) {
+            const ClassState& cs = _classes[pri];
+            BSONObjBuilder c( b.subobjStart( priorityName( pri ) ) );
+            c.appendNumber( "unitsPerSecond", _unitsPerSecond( pri ) );
+            c.appendNumber( "scheduled", cs.scheduled.load() );
+            c.appendNumber( "completed", cs.completed.load() );
+            {
+                SimpleMutex::scoped_lock lk( _mutex );
+                c.appendNumber( "pending", (long long)cs.pending.size() );
+            }
+            c.appendNumber( "unitsUsed", cs.unitsUsed.load() );
+            c.appendNumber( "throttledMicros", cs.throttledMicros.load() );
+            c.done();
+        }
+    }
+
+    //
+    // Batch
+    //
+
+    BackgroundScheduler::Batch::Batch()
+        : _m( "BackgroundScheduler::Batch" ),
+          _outstanding( 0 ) {
+    }
+
+    void BackgroundScheduler::Batch::schedule( Priority pri, const Task& task ) {
+        {
+            scoped_lock lk( _m );
+            _outstanding++;
+        }
+        backgroundScheduler().schedule(
+            pri, boost::bind( &BackgroundScheduler::Batch::_run, this, task ) );
+    }
+
+    void BackgroundScheduler::Batch::_run( Task task ) {
+        try {
+            task();
+        }
+        catch ( ... ) {
+            _taskDone();
+            throw;
+        }
+        _taskDone();
+    }
+
+    void BackgroundScheduler::Batch::_taskDone() {
+        scoped_lock lk( _m );
+        if ( --_outstanding == 0 )
+            _done.notify_all();
+    }
+
+    void BackgroundScheduler::Batch::join() {
+        scoped_lock lk( _m );
+        while ( _outstanding > 0 )
+            _done.wait( lk.boost() );
+    }
+
+    BackgroundScheduler& backgroundScheduler() {
+        // never deleted: workers may still be draining at shutdown
+        static BackgroundScheduler* scheduler = new BackgroundScheduler();
+        return *scheduler;
+    }
+
+    namespace {
+        class BackgroundSchedulerServerStatus : public ServerStatusSection {
+        public:
+            BackgroundSchedulerServerStatus()
+                : ServerStatusSection( "backgroundScheduler" ) {}
+            virtual bool includeByDefault() const { return false; }
+
+            virtual BSONObj generateSection( const BSONElement& configElement ) const {
+                BSONObjBuilder b;
+                backgroundScheduler().appendStats( b );
+                return b.obj();
+            }
+        } backgroundSchedulerServerStatus;
+    }
+
+}  // namespace mongo
@@ -0,0 +1,115 @@
+// background_scheduler.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/thread_pool.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Shared scheduler for maintenance work (TTL deletes, orphan cleanup, ...) so
+     * background jobs stop competing blindly with foreground operations.  Work is
+     * submitted under a priority class; each throttled class has a work-unit budget
+     * per second (a unit is whatever the job charges -- a deleted document, a
+     * scanned page) and workers sleep out the rest of the window once a class goes
+     * over budget.  Per-class consumption is surfaced in the 'backgroundScheduler'
+     * serverStatus section.
+     *
+     * Loop-style jobs that keep their own thread can participate in the budgets
+     * without moving to the pool by calling throttle() between batches.
+     */
+    class BackgroundScheduler : boost::noncopyable {
+    public:
+        enum Priority {
+            Critical = 0,     // journal/flusher style work; never throttled
+            Maintenance = 1,  // TTL deletes, range/orphan cleanup
+            Low = 2,          // opportunistic work; first to be starved
+            NumPriorities = 3
+        };
+
+        typedef threadpool::Task Task;
+
+        BackgroundScheduler();
+
+        /** run 'task' on the shared worker pool when 'pri' has budget.  higher
+            priority classes are drained first. */
+        void schedule( Priority pri, const Task& task );
+
+        /** charge 'cost' work units against 'pri' and sleep out the rest of the
+            current one second window if the class is over budget.  call between
+            batches, with no locks held. */
+        void throttle( Priority pri, long long cost );
+
+        void appendStats( BSONObjBuilder& b ) const;
+
+        /**
+         * Tracks completion of a group of tasks scheduled together, for jobs that
+         * fan out one pass over the shared pool and need to wait for just their own
+         * tasks (ThreadPool::join would wait on everybody's).
+         */
+        class Batch : boost::noncopyable {
+        public:
+            Batch();
+            void schedule( Priority pri, const Task& task );
+            /** waits for the tasks scheduled through this Batch to finish. */
+            void join();
+        private:
+            void _run( Task task );
+            void _taskDone();
+
+            mongo::mutex _m;
+            boost::condition _done;
+            int _outstanding;
+        };
+
+    private:
+        struct ClassState;
+
+        ThreadPool& _getPool();
+        void _runNext();
+        long long _unitsPerSecond( int pri ) const;
+
+        /** takes 'cost' units from 'pri' if the current window has room.  on
+            refusal returns false and sets millis until the window rolls over. */
+        bool _tryAcquire_inlock( int pri, long long cost, long long* retryMillis );
+
+        mutable SimpleMutex _mutex;
+        ClassState* _classes;  // NumPriorities of them
+        ThreadPool* _pool;     // created on first schedule()
+    };
+
+    /** the process-wide scheduler */
+    BackgroundScheduler& backgroundScheduler();
+
+}  // namespace mongo
@@ -51,9 +51,11 @@
 #include "mongo/db/index_names.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
+#include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/ops/delete.h"
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/repl/rs.h" // this is ugly
+#include "mongo/db/stats/index_usage.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
@@ -447,6 +449,8 @@ namespace mongo {
                                             idxNo );
         }
 
+        // any scan checkpoint refers to an index that no longer exists
+        removeIndexBuildCheckpoint( _ns, _indexName );
     }
 
     void IndexCatalog::IndexBuildBlock::abort() {
@@ -460,9 +464,21 @@ namespace mongo {
 
         fassert( 17207, _catalog->_collection->ok() );
 
+        IndexDescriptor* desc = _catalog->findIndexByName( _indexName, true );
+        fassert( 17330, desc );
+        IndexCatalogEntry* entry = _catalog->_entries.find( desc );
+        fassert( 17331, entry && entry == _entry );
+
+        _catalog->_markIndexReady( _indexName );
+
+        // a checkpointed background build finished normally; forget the checkpoint
+        removeIndexBuildCheckpoint( _ns, _indexName );
+    }
+
+    void IndexCatalog::_markIndexReady( const string& indexName ) {
         NamespaceDetails* nsd = _collection->details();
 
-        int idxNo = nsd->_catalogFindIndexByName( _indexName, true );
+        int idxNo = nsd->_catalogFindIndexByName( indexName, true );
         fassert( 17202, idxNo >= 0 );
 
         // Make sure the newly created index is relocated to nIndexes, if it isn't already there
@@ -480,17 +496,73 @@ namespace mongo {
         getDur().writingInt( nsd->_indexBuildsInProgress ) -= 1;
         getDur().writingInt( nsd->_nIndexes ) += 1;
 
-        _catalog->_collection->infoCache()->addedIndex();
+        _collection->infoCache()->addedIndex();
 
-        IndexDescriptor* desc = _catalog->findIndexByName( _indexName, true );
-        fassert( 17330, desc );
-        IndexCatalogEntry* entry = _catalog->_entries.find( desc );
-        fassert( 17331, entry && entry == _entry );
+        IndexDescriptor* desc = findIndexByName( indexName, true );
+        fassert( 17459, desc );
+        IndexCatalogEntry* entry = _entries.find( desc );
+        fassert( 17460, entry );
 
         entry->setIsReady( true );
 
-        IndexLegacy::postBuildHook( _catalog->_collection,
-                                    _catalog->findIndexByName( _indexName )->keyPattern() );
+        IndexLegacy::postBuildHook( _collection,
+                                    findIndexByName( indexName )->keyPattern() );
+    }
+
+    Status IndexCatalog::resumeUnfinishedIndex( const BSONObj& spec, const DiskLoc& resumeAt ) {
+        Lock::assertWriteLocked( _collection->_database->name() );
+        _checkMagic();
+
+        const string indexName = spec["name"].String();
+
+        int idxNo = _details->_catalogFindIndexByName( indexName, true );
+        if ( idxNo < 0 || idxNo < numIndexesReady() )
+            return Status( ErrorCodes::InternalError,
+                           "unfinished index not found in catalog" );
+
+        if ( _details->idx( idxNo ).head.isNull() )
+            return Status( ErrorCodes::InternalError,
+                           "no partial index data to resume from" );
+
+        // from here this index is either finished or, on error, dropped like a
+        // failed build -- it is no longer 'unfinished' either way
+        for ( vector<BSONObj>::iterator i = _unfinishedIndexes.begin();
+              i != _unfinishedIndexes.end();
+              ++i ) {
+            if ( (*i)["name"].String() == indexName ) {
+                _unfinishedIndexes.erase( i );
+                break;
+            }
+        }
+
+        // adopt the partial index: the entry picks up the surviving btree head and
+        // reads as not ready, so normal writes maintain it while the scan yields
+        IndexCatalogEntry* entry =
+            _setupInMemoryStructures( new IndexDescriptor( _collection, spec.getOwned() ) );
+        verify( !entry->isReady() );
+
+        const string ns = _collection->ns().ns();
+
+        try {
+            resumeAnIndexBuild( _collection, entry, resumeAt );
+            _markIndexReady( indexName );
+        }
+        catch ( const AssertionException& exc ) {
+            log() << "resumed index build failed."
+                  << " spec: " << spec
+                  << " error: " << exc;
+
+            _dropIndex( entry );
+            removeIndexBuildCheckpoint( ns, indexName );
+
+            ErrorCodes::Error codeToUse = ErrorCodes::fromInt( exc.getCode() );
+            if ( codeToUse == ErrorCodes::UnknownError )
+                return Status( ErrorCodes::InternalError, exc.what(), exc.getCode() );
+            return Status( codeToUse, exc.what() );
+        }
+
+        removeIndexBuildCheckpoint( ns, indexName );
+        return Status::OK();
     }
 
 
@@ -600,6 +672,27 @@ namespace mongo {
                                          << "not allow document removal." );
         }
 
+        BSONElement filterElement = spec["filter"];
+        if ( !filterElement.eoo() ) {
+            if ( filterElement.type() != Object )
+                return Status( ErrorCodes::CannotCreateIndex,
+                               "'filter' for an index has to be a document" );
+
+            if ( IndexDetails::isIdIndexPattern( key ) )
+                return Status( ErrorCodes::CannotCreateIndex,
+                               "cannot create a filtered (partial) _id index" );
+
+            // make sure the filter parses; the parsed form is cached by the
+            // IndexCatalogEntry once the index is created
+            StatusWithMatchExpression res =
+                MatchExpressionParser::parse( filterElement.Obj() );
+            if ( !res.isOK() )
+                return Status( ErrorCodes::CannotCreateIndex,
+                               str::stream() << "failed to parse index filter: "
+                                             << res.getStatus().reason() );
+            delete res.getValue();
+        }
+
         if ( !IndexDetails::isIdIndexPattern( key ) ) {
             // for non _id indexes, we check to see if replication has turned off all indexes
             // we _always_ created _id index
@@ -819,6 +912,9 @@ namespace mongo {
         _entries.remove( entry->descriptor() );
         entry = NULL;
 
+        // forget usage counters so a recreated index starts at zero
+        indexUsageTracker.erase( indexNamespace );
+
         try {
             _details->clearSystemFlag( NamespaceDetails::Flag_HaveIdIndex );
 
@@ -1207,6 +1303,40 @@ namespace mongo {
 
     }
 
+    Status IndexCatalog::_unindexRecords( IndexCatalogEntry* index,
+                                          const std::vector<BSONObj>& objs,
+                                          const std::vector<DiskLoc>& locs,
+                                          bool logIfError ) {
+        InsertDeleteOptions options;
+        options.logIfError = logIfError;
+
+        int64_t removed;
+        Status status = index->accessMethod()->removeMany(objs, locs, options, &removed);
+
+        if ( !status.isOK() ) {
+            problem() << "Couldn't unindex batch of " << objs.size() << " records"
+                      << " status: " << status.toString();
+        }
+
+        return Status::OK();
+    }
+
+    void IndexCatalog::unindexRecords( const std::vector<BSONObj>& objs,
+                                       const std::vector<DiskLoc>& locs,
+                                       bool noWarn ) {
+        for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
+              i != _entries.end();
+              ++i ) {
+
+            IndexCatalogEntry* entry = *i;
+
+            // If it's a background index, we DO NOT want to log anything.
+            bool logIfError = entry->isReady() ? !noWarn : false;
+            _unindexRecords( entry, objs, locs, logIfError );
+        }
+
+    }
+
     void IndexCatalog::unindexRecord( const BSONObj& obj, const DiskLoc& loc, bool noWarn ) {
         for ( IndexCatalogEntryContainer::const_iterator i = _entries.begin();
               i != _entries.end();
@@ -158,6 +158,21 @@ namespace mongo {
          */
         vector<BSONObj> getAndClearUnfinishedIndexes();
 
+        /**
+         * specs of incompleted indexes, without touching them on disk.
+         * used to decide which ones can be resumed from a checkpoint before
+         * getAndClearUnfinishedIndexes() wipes the rest.
+         */
+        vector<BSONObj> unfinishedIndexes() const { return _unfinishedIndexes; }
+
+        /**
+         * finish an interrupted background build whose partial btree survived a
+         * restart, scanning from the checkpointed position (see index_create.h).
+         * on failure the partial index is dropped, as for a failed build, and the
+         * caller should rebuild from scratch.
+         */
+        Status resumeUnfinishedIndex( const BSONObj& spec, const DiskLoc& resumeAt );
+
         // ---- modify single index
 
         /* Updates the expireAfterSeconds field of the given index to the value in newExpireSecs.
@@ -225,6 +240,15 @@ namespace mongo {
 
         void unindexRecord( const BSONObj& obj, const DiskLoc& loc, bool noWarn );
 
+        /**
+         * unindexes a batch of records at once.  'objs' and 'locs' are parallel vectors.
+         * each index removes the whole batch's keys in key order, amortizing btree
+         * descents over the batch (see IndexAccessMethod::removeMany).
+         */
+        void unindexRecords( const std::vector<BSONObj>& objs,
+                             const std::vector<DiskLoc>& locs,
+                             bool noWarn );
+
         /**
          * checks all unique indexes and checks for conflicts
          * should not throw
@@ -276,12 +300,23 @@ namespace mongo {
         Status _indexRecord( IndexCatalogEntry* index, const BSONObj& obj, const DiskLoc &loc );
         Status _unindexRecord( IndexCatalogEntry* index, const BSONObj& obj, const DiskLoc &loc,
                                bool logIfError );
+        Status _unindexRecords( IndexCatalogEntry* index,
+                                const std::vector<BSONObj>& objs,
+                                const std::vector<DiskLoc>& locs,
+                                bool logIfError );
 
         /**
          * this does no sanity checks
          */
         Status _dropIndex( IndexCatalogEntry* entry );
 
+        /**
+         * flip the named in-progress index to completed: moves it before the
+         * in-progress ones in the catalog, bumps nIndexes and marks the entry ready.
+         * shared by IndexBuildBlock::success() and resumeUnfinishedIndex().
+         */
+        void _markIndexReady( const string& indexName );
+
         // just does disk hanges
         // doesn't change memory state, etc...
         void _deleteIndexFromDisk( const string& indexName,
@@ -32,6 +32,8 @@
 
 #include "mongo/db/index/index_access_method.h"
 #include "mongo/db/index/index_descriptor.h"
+#include "mongo/db/matcher/expression.h"
+#include "mongo/db/matcher/expression_parser.h"
 
 namespace mongo {
 
@@ -46,11 +48,24 @@ namespace mongo {
           _ordering( Ordering::make( descriptor->keyPattern() ) ),
           _isReady( false ) {
         _descriptor->_cachedEntry = this;
+
+        _usageStats = indexUsageTracker.get( descriptor->indexNamespace() );
+
+        if ( descriptor->isPartial() ) {
+            // the filter was validated when the index was created
+            StatusWithMatchExpression res =
+                MatchExpressionParser::parse( descriptor->getInfoElement( "filter" ).Obj() );
+            fassert( 17461, res.getStatus() );
+            _filterExpression.reset( res.getValue() );
+        }
     }
 
     IndexCatalogEntry::~IndexCatalogEntry() {
         _descriptor->_cachedEntry = NULL; // defensive
 
+        // the filter points into the descriptor's info object, so drop it first
+        _filterExpression.reset();
+
         delete _forcedBtreeIndex;
         delete _accessMethod;
 
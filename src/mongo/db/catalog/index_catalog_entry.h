@@ -32,14 +32,18 @@
 
 #include <string>
 
+#include <boost/scoped_ptr.hpp>
+
 #include "mongo/base/owned_pointer_vector.h"
 #include "mongo/bson/ordering.h"
 #include "mongo/db/diskloc.h"
+#include "mongo/db/stats/index_usage.h"
 
 namespace mongo {
 
     class Collection;
     class IndexDescriptor;
+    class MatchExpression;
     class RecordStore;
     class IndexAccessMethod;
 
@@ -71,6 +75,15 @@ namespace mongo {
 
         const Ordering& ordering() const { return _ordering; }
 
+        /**
+         * For a partial index, the parsed "filter" from the index spec: only documents
+         * matching it have entries in the index.  NULL for a normal index.
+         */
+        const MatchExpression* getFilterExpression() const { return _filterExpression.get(); }
+
+        /** always-on usage counters for this index, shared with the global tracker */
+        IndexUsageTracker::Stats* usageStats() const { return _usageStats.get(); }
+
         /// ---------------------
 
         const DiskLoc& head() const;
@@ -107,6 +120,12 @@ namespace mongo {
         IndexAccessMethod* _accessMethod; // owned here
         IndexAccessMethod* _forcedBtreeIndex; // owned here
 
+        // parsed from the descriptor's "filter" element, NULL if not a partial index
+        boost::scoped_ptr<MatchExpression> _filterExpression;
+
+        // shared with IndexUsageTracker so the counters outlive catalog reopens
+        IndexUsageTracker::StatsPtr _usageStats;
+
         // cached stuff
 
         Ordering _ordering; // TODO: this might be b-tree specific
@@ -35,7 +35,9 @@
 #include "mongo/db/background.h"
 #include "mongo/db/structure/btree/btreebuilder.h"
 #include "mongo/db/clientcursor.h"
+#include "mongo/db/dbhelpers.h"
 #include "mongo/db/extsort.h"
+#include "mongo/db/ops/delete.h"
 #include "mongo/db/storage/index_details.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/namespace_details.h"
@@ -45,6 +47,8 @@
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/repl/rs.h"
+#include "mongo/db/storage/extent.h"
+#include "mongo/db/storage/extent_manager.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/util/processinfo.h"
 
@@ -73,10 +77,91 @@ namespace mongo {
         uassertStatusOK( ret );
     }
 
+    // ----- checkpoints for resumable background builds -----
+
+    static const char* const indexBuildCheckpointNS = "local.system.indexbuilds";
+
+    static string indexBuildCheckpointId( const string& ns, const string& indexName ) {
+        return ns + "." + indexName;
+    }
+
+    static void saveIndexBuildCheckpoint( const string& ns,
+                                          const IndexDescriptor* descriptor,
+                                          const DiskLoc& loc ) {
+        BSONObjBuilder b;
+        b.append( "_id", indexBuildCheckpointId( ns, descriptor->indexName() ) );
+        b.append( "ns", ns );
+        b.append( "name", descriptor->indexName() );
+        b.append( "spec", descriptor->infoObj() );
+        b.append( "file", loc.a() );
+        b.append( "ofs", loc.getOfs() );
+
+        // "local" is nestable, so this is safe while holding the build db's lock
+        Lock::DBWrite lk( indexBuildCheckpointNS );
+        Helpers::upsert( indexBuildCheckpointNS, b.obj() );
+    }
+
+    bool getIndexBuildCheckpoint( const string& ns,
+                                  const string& indexName,
+                                  const BSONObj& spec,
+                                  DiskLoc* resumeAt ) {
+        Client::ReadContext ctx( indexBuildCheckpointNS );
+        BSONObj doc;
+        if ( !Helpers::findOne( indexBuildCheckpointNS,
+                                BSON( "_id" << indexBuildCheckpointId( ns, indexName ) ),
+                                doc ) )
+            return false;
+        if ( doc["spec"].type() != Object || doc["spec"].Obj().woCompare( spec ) != 0 ) {
+            // spec changed since the checkpoint was taken; it is stale
+            return false;
+        }
+        *resumeAt = DiskLoc( doc["file"].numberInt(), doc["ofs"].numberInt() );
+        return !resumeAt->isNull();
+    }
+
+    bool indexBuildCheckpointStillValid( Collection* collection, const DiskLoc& loc ) {
+        if ( loc.isNull() )
+            return false;
+
+        const ExtentManager& em = cc().database()->getExtentManager();
+        NamespaceDetails* d = collection->details();
+
+        // find the extent the loc falls into, then confirm it is one of that
+        // extent's live records -- a DeletedRecord never appears on this chain
+        for ( DiskLoc extLoc = d->firstExtent(); !extLoc.isNull(); ) {
+            Extent* e = em.getExtent( extLoc );
+            if ( extLoc.a() == loc.a() &&
+                 loc.getOfs() > extLoc.getOfs() &&
+                 loc.getOfs() < extLoc.getOfs() + e->length ) {
+                for ( DiskLoc rec = e->firstRecord; !rec.isNull();
+                      rec = em.getNextRecordInExtent( rec ) ) {
+                    if ( rec == loc )
+                        return true;
+                }
+                return false;
+            }
+            extLoc = e->xnext;
+        }
+        return false;
+    }
+
+    void removeIndexBuildCheckpoint( const string& ns, const string& indexName ) {
+        Lock::DBWrite lk( indexBuildCheckpointNS );
+        Client::Context ctx( indexBuildCheckpointNS );
+        if ( !cc().database()->getCollection( indexBuildCheckpointNS ) )
+            return;
+        deleteObjects( indexBuildCheckpointNS,
+                       BSON( "_id" << indexBuildCheckpointId( ns, indexName ) ),
+                       true /* justOne */ );
+    }
+
+    // -----
+
     unsigned long long addExistingToIndex( Collection* collection,
                                            const IndexDescriptor* descriptor,
                                            IndexAccessMethod* accessMethod,
-                                           bool shouldYield ) {
+                                           bool shouldYield,
+                                           const DiskLoc& startAt = DiskLoc() ) {
 
         string ns = collection->ns().ns(); // our copy for sanity
 
@@ -101,7 +186,10 @@ namespace mongo {
         unsigned long long n = 0;
         unsigned long long numDropped = 0;
 
-        auto_ptr<Runner> runner(InternalPlanner::collectionScan(ns));
+        const bool resuming = !startAt.isNull();
+        auto_ptr<Runner> runner(InternalPlanner::collectionScan(ns,
+                                                                InternalPlanner::FORWARD,
+                                                                startAt));
 
         // We're not delegating yielding to the runner because we need to know when a yield
         // happens.
@@ -130,8 +218,13 @@ namespace mongo {
                     killCurrentOp.checkForInterrupt();
                 }
 
+                if ( resuming && e.getCode() == 10287 ) {
+                    // benign when resuming a checkpointed build: this doc's keys were
+                    // already added before the restart (the checkpoint trails actual
+                    // progress slightly)
+                }
                 // TODO: Does exception really imply dropDups exception?
-                if (dropDups) {
+                else if (dropDups) {
                     bool runnerEOF = runner->isEOF();
                     runner->saveState();
                     BSONObj toDelete;
@@ -162,6 +255,12 @@ namespace mongo {
             n++;
             progress.hit();
 
+            if ( shouldYield && ( n % 4096 ) == 0 ) {
+                // checkpoint the scan position in the same commit window as the keys
+                // added so far, so a restart can resume from here
+                saveIndexBuildCheckpoint( ns, descriptor, loc );
+            }
+
             getDur().commitIfNeeded();
             if (shouldYield && yieldPolicy.shouldYield()) {
                 if (!yieldPolicy.yieldAndCheckIfOK(runner.get())) {
@@ -275,5 +374,38 @@ namespace mongo {
         collection->infoCache()->addedIndex();
     }
 
+    void resumeAnIndexBuild( Collection* collection,
+                             IndexCatalogEntry* btreeState,
+                             const DiskLoc& resumeAt ) {
+
+        string ns = collection->ns().ns(); // our copy
+        const IndexDescriptor* idx = btreeState->descriptor();
+
+        MONGO_TLOG(0) << "resume index build on: " << ns
+                      << " properties: " << idx->toString()
+                      << " from: " << resumeAt.toString() << endl;
+
+        Timer t;
+
+        verify( Lock::isWriteLocked( ns ) );
+        verify( !btreeState->head().isNull() ); // the partial tree we are resuming into
+        collection->infoCache()->addedIndex();
+
+        // resumed builds were background builds, so keep yielding like one; note we
+        // do NOT initializeAsEmpty here -- the keys added before the restart stay
+        BackgroundOperation backgroundOperation( ns );
+
+        unsigned long long n = addExistingToIndex( collection,
+                                                   btreeState->descriptor(),
+                                                   btreeState->accessMethod(),
+                                                   true /* shouldYield */,
+                                                   resumeAt );
+
+        MONGO_TLOG(0) << "resumed index build done.  scanned " << n << " records. "
+                      << t.millis() / 1000.0 << " secs" << endl;
+
+        collection->infoCache()->addedIndex();
+    }
+
 }  // namespace mongo
 
@@ -32,6 +32,9 @@
 
 #include <string>
 
+#include "mongo/db/diskloc.h"
+#include "mongo/db/jsobj.h"
+
 namespace mongo {
 
     class IndexCatalogEntry;
@@ -44,4 +47,36 @@ namespace mongo {
                        IndexCatalogEntry* btreeState,
                        bool mayInterrupt );
 
+    /**
+     * Finish an interrupted background build whose partial btree survived a restart,
+     * scanning from the checkpointed position instead of the first extent.
+     * btreeState must already be set up in the catalog and not ready.
+     * Called by IndexCatalog::resumeUnfinishedIndex.
+     */
+    void resumeAnIndexBuild( Collection* collection,
+                             IndexCatalogEntry* btreeState,
+                             const DiskLoc& resumeAt );
+
+    /**
+     * Background builds checkpoint their scan position in local.system.indexbuilds
+     * every few thousand documents so a restart can resume instead of rescanning.
+     * Returns true and sets *resumeAt if a checkpoint matching spec exists for the
+     * named index.
+     */
+    bool getIndexBuildCheckpoint( const std::string& ns,
+                                  const std::string& indexName,
+                                  const BSONObj& spec,
+                                  DiskLoc* resumeAt );
+
+    /** remove any checkpoint for the named index.  cheap no-op when none exists. */
+    void removeIndexBuildCheckpoint( const std::string& ns, const std::string& indexName );
+
+    /**
+     * The checkpoint commit window doesn't pin the record it names, so after a
+     * crash the saved loc may point at a record that was since deleted or moved.
+     * Returns true only if it still names a live record of this collection;
+     * resume from anything else would walk garbage.
+     */
+    bool indexBuildCheckpointStillValid( Collection* collection, const DiskLoc& loc );
+
 } // namespace mongo
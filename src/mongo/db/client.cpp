@@ -48,6 +48,7 @@
 #include "mongo/db/auth/privilege.h"
 #include "mongo/db/db.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/db/curop-inl.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/dbwebserver.h"
@@ -56,6 +57,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pagefault.h"
 #include "mongo/db/repl/rs.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/d_logic.h"
@@ -172,6 +174,15 @@ namespace mongo {
         setThreadName( origThreadName.rawData() );
     }
 
+    Client* Client::releaseCurrent() {
+        return currentClient.release();
+    }
+
+    void Client::setCurrent( Client* client ) {
+        verify( currentClient.get() == 0 );
+        currentClient.reset( client );
+    }
+
 
     Client::Client(const string& desc, AbstractMessagingPort *p) :
         ClientBasic(p),
@@ -179,7 +190,8 @@ namespace mongo {
         _shutdown(false),
         _desc(desc),
         _god(0),
-        _lastOp(0)
+        _lastOp(0),
+        _arenaLastBigUseMillis(0)
     {
         _hasWrittenThisPass = false;
         _pageFaultRetryableSection = 0;
@@ -230,6 +242,60 @@ namespace mongo {
         }
     }
 
+    // A connection whose requests haven't needed more scratch memory than this keeps
+    // its arena released rather than retained between requests.
+    MONGO_EXPORT_SERVER_PARAMETER(connMemoryFloorBytes, int, 64 * 1024);
+
+    // How long a connection may keep a large retained arena after the last request
+    // that actually needed it.  The check runs at request boundaries, so pooled
+    // connections reclaim on their next ping/operation after going quiet.
+    MONGO_EXPORT_SERVER_PARAMETER(connIdleMemoryTimeoutSecs, int, 600);
+
+    void Client::rewindOpArena() {
+        const size_t floor = connMemoryFloorBytes < 0 ? 0 : size_t(connMemoryFloorBytes);
+        const unsigned long long now = curTimeMillis64();
+
+        if ( _opArena.usedBytes() > floor )
+            _arenaLastBigUseMillis = now;
+
+        _opArena.reset();
+
+        if ( _opArena.allocatedBytes() > floor &&
+             now - _arenaLastBigUseMillis >= 1000ULL * connIdleMemoryTimeoutSecs ) {
+            _opArena.shrink( floor );
+        }
+    }
+
+    namespace {
+        /** memory retained by connections between requests, for hunting down fleets of
+            idle-but-pinning connections */
+        class ConnMemoryServerStatus : public ServerStatusSection {
+        public:
+            ConnMemoryServerStatus() : ServerStatusSection( "connMemory" ) {}
+            virtual bool includeByDefault() const { return true; }
+
+            BSONObj generateSection( const BSONElement& configElement ) const {
+                long long arenaBytes = 0;
+                long long over = 0;
+                {
+                    scoped_lock bl( Client::clientsMutex );
+                    for ( set<Client*>::const_iterator i = Client::clients.begin();
+                          i != Client::clients.end(); ++i ) {
+                        // racy read of another thread's arena size; only a stat
+                        const long long b = (*i)->opArena().allocatedBytes();
+                        arenaBytes += b;
+                        if ( b > connMemoryFloorBytes )
+                            over++;
+                    }
+                }
+                BSONObjBuilder bb;
+                bb.appendNumber( "retainedScratchBytes" , arenaBytes );
+                bb.appendNumber( "connectionsOverFloor" , over );
+                return bb.obj();
+            }
+        } connMemoryServerStatus;
+    }
+
     bool Client::shutdown() {
 #if defined(_DEBUG) && !defined(MONGO_OPTIMIZED_BUILD) && !XSAN_ENABLED
         {
@@ -38,6 +38,7 @@
 
 #include "mongo/pch.h"
 
+#include "mongo/bson/util/arena.h"
 #include "mongo/db/client_basic.h"
 #include "mongo/db/d_concurrency.h"
 #include "mongo/db/lasterror.h"
@@ -64,6 +65,40 @@ namespace mongo {
 
     typedef long long ConnectionId;
 
+    /**
+     * Tracks a decaying high-water mark of one connection's reply sizes so reply
+     * builders can start at the right capacity instead of realloc-growing from a small
+     * default on every operation.  Reply buffers are handed off to Message (which frees
+     * them with free()), so we cannot pool the buffers themselves -- but starting each
+     * builder at the decayed high-water mark removes the realloc chain, which is where
+     * the cost is.
+     */
+    class ReplySizeTracker {
+    public:
+        ReplySizeTracker() : _highWater( kMinReplyBufferSize ) {}
+
+        /** suggested initial capacity for the next reply's BufBuilder */
+        int recommendedSize() const { return _highWater; }
+
+        void recordSize( int size ) {
+            if ( size >= _highWater ) {
+                _highWater = std::min( size, static_cast<int>( kMaxReplyBufferSize ) );
+            }
+            else {
+                // decay toward recent traffic so one huge reply doesn't pin the size
+                _highWater = std::max( std::max( size, static_cast<int>( kMinReplyBufferSize ) ),
+                                       _highWater - ( _highWater >> 3 ) );
+            }
+        }
+
+    private:
+        enum {
+            kMinReplyBufferSize = 4096,
+            kMaxReplyBufferSize = 4 * 1024 * 1024
+        };
+        int _highWater;
+    };
+
     /** the database's concept of an outside "client" */
     class Client : public ClientBasic {
     public:
@@ -92,6 +127,13 @@ namespace mongo {
          */
         static void resetThread( const StringData& origThreadName );
 
+        /** Event-driven message server support: detaches the thread's Client without
+         *  destroying it, so the connection it belongs to can migrate to another worker
+         *  thread. Pair with setCurrent() on the next thread.
+         */
+        static Client* releaseCurrent();
+        static void setCurrent( Client* client );
+
         /** this has to be called as the client goes away, but before thread termination
          *  @return true if anything was done
          */
@@ -131,6 +173,19 @@ namespace mongo {
 
         LockState& lockState() { return _ls; }
 
+        /** per-operation scratch arena, rewound at the end of each request by
+            assembleResponse().  Memory from it must not outlive the current operation. */
+        Arena& opArena() { return _opArena; }
+
+        /** Rewinds the scratch arena at the end of a request.  If this connection
+            hasn't actually needed a large arena for connIdleMemoryTimeoutSecs, the
+            backing memory is released down to connMemoryFloorBytes instead of being
+            retained, so bursty-then-idle connections stop pinning it. */
+        void rewindOpArena();
+
+        /** sizing history for this connection's replies; see ReplySizeTracker */
+        ReplySizeTracker& replySizeTracker() { return _replySizeTracker; }
+
     private:
         Client(const std::string& desc, AbstractMessagingPort *p = 0);
         friend class CurOp;
@@ -147,6 +202,9 @@ namespace mongo {
 
         bool _hasWrittenThisPass;
         PageFaultRetryableSection *_pageFaultRetryableSection;
+        Arena _opArena;
+        unsigned long long _arenaLastBigUseMillis; // see rewindOpArena()
+        ReplySizeTracker _replySizeTracker;
 
         LockState _ls;
         
@@ -241,6 +299,17 @@ namespace mongo {
     }; // class Client
 
 
+    /** Rewinds a client's scratch arena when the scope exits, whichever path returns;
+        see Client::rewindOpArena() for the rightsizing policy. */
+    class OpArenaRewind : boost::noncopyable {
+    public:
+        explicit OpArenaRewind( Client& c ) : _c( c ) {}
+        ~OpArenaRewind() { _c.rewindOpArena(); }
+    private:
+        Client& _c;
+    };
+
+
     /** get the Client object for this thread. */
     inline Client& cc() {
         Client * c = currentClient.get();
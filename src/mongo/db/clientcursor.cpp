@@ -49,15 +49,45 @@
 #include "mongo/db/pagefault.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/query/find_constants.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/platform/random.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/timer.h"
+#include "mongo/util/timer_wheel.h"
 
 namespace mongo {
 
-    ClientCursor::CCById ClientCursor::clientCursorsById;
+    // How many reply bytes a getMore aims for when the client doesn't specify a batch size.
+    // Each cursor starts here and tunes itself per batch; see ClientCursor::noteBatchTime().
+    MONGO_EXPORT_SERVER_PARAMETER( getMoreTargetBatchBytes, int, 1024 * 1024 );
+
+    // Server-time budget for filling one getMore batch.  Batches that finish well under it
+    // grow the cursor's byte target; batches that run over shrink it.
+    MONGO_EXPORT_SERVER_PARAMETER( getMoreTargetBatchTimeMS, int, 100 );
+
+    namespace {
+        // Don't let the sizing model shrink batches into chattiness.
+        const int kMinTargetBatchBytes = 64 * 1024;
+
+        // Idle time after which an unpinned cursor is killed.
+        const unsigned long long kCursorTimeoutMillis = 600000;
+
+        // Deadlines for every open cursor, keyed by cursor id.  Entries are lazy: a
+        // cursor used since its deadline was scheduled is simply re-armed when the
+        // entry fires, and ids of dead cursors are ignored.  Function-local static so
+        // cursors created during static initialization are safe.
+        TimerWheel& cursorTimeoutWheel() {
+            static TimerWheel wheel( 1000 /*tickMillis*/, 1024 /*buckets*/ );
+            return wheel;
+        }
+    }
+
+    // Never deleted; same lifetime dodge as ccmutex below.
+    ClientCursor::Partition* ClientCursor::_partitions =
+        new ClientCursor::Partition[ClientCursor::NumPartitions];
     boost::recursive_mutex& ClientCursor::ccmutex( *(new boost::recursive_mutex()) );
-    long long ClientCursor::numberTimedOut = 0;
+    AtomicInt64 ClientCursor::numberTimedOut;
     ClientCursor::RunnerSet ClientCursor::nonCachedRunners;
 
     void aboutToDeleteForSharding(const StringData& ns,
@@ -91,6 +121,8 @@ namespace mongo {
         _leftoverMaxTimeMicros = 0;
         _pinValue = 0;
         _pos = 0;
+        _targetBatchBytes = std::min(getMoreTargetBatchBytes,
+                                     static_cast<int>(MaxBytesToReturnToClientAtOnce));
         
         Lock::assertAtLeastReadLocked(_ns);
 
@@ -100,9 +132,22 @@ namespace mongo {
             ++_pinValue;
         }
 
-        recursive_scoped_lock lock(ccmutex);
-        _cursorid = allocCursorId_inlock();
-        clientCursorsById.insert( make_pair(_cursorid, this) );
+        while ( 1 ) {
+            CursorId id = allocCursorId();
+            Partition& p = _partition( id );
+            recursive_scoped_lock lock( p.mutex );
+            if ( p.byId.count( id ) ) {
+                // id reused within one clock tick; try another
+                continue;
+            }
+            _cursorid = id;
+            p.byId.insert( make_pair( _cursorid, this ) );
+            break;
+        }
+
+        _lastUseMillis = curTimeMillis64();
+        cursorTimeoutWheel().schedule( static_cast<unsigned long long>( _cursorid ),
+                                       _lastUseMillis + kCursorTimeoutMillis + 1 );
     }
 
     ClientCursor::~ClientCursor() {
@@ -113,8 +158,9 @@ namespace mongo {
         }
 
         {
-            recursive_scoped_lock lock(ccmutex);
-            clientCursorsById.erase(_cursorid);
+            Partition& p = _partition( _cursorid );
+            recursive_scoped_lock lock( p.mutex );
+            p.byId.erase( _cursorid );
 
             // defensive:
             _cursorid = INVALID_CURSOR_ID;
@@ -125,13 +171,16 @@ namespace mongo {
 
     // static
     void ClientCursor::assertNoCursors() {
-        recursive_scoped_lock lock(ccmutex);
-        if (clientCursorsById.size() > 0) {
-            log() << "ERROR clientcursors exist but should not at this point" << endl;
-            ClientCursor *cc = clientCursorsById.begin()->second;
-            log() << "first one: " << cc->_cursorid << ' ' << cc->_ns << endl;
-            clientCursorsById.clear();
-            verify(false);
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            Partition& p = _partitions[i];
+            recursive_scoped_lock lock( p.mutex );
+            if (p.byId.size() > 0) {
+                log() << "ERROR clientcursors exist but should not at this point" << endl;
+                ClientCursor *cc = p.byId.begin()->second;
+                log() << "first one: " << cc->_cursorid << ' ' << cc->_ns << endl;
+                p.byId.clear();
+                verify(false);
+            }
         }
     }
 
@@ -148,77 +197,85 @@ namespace mongo {
         verify(db);
         verify(ns.startsWith(db->name()));
 
-        recursive_scoped_lock cclock(ccmutex);
-        // Look at all active non-cached Runners.  These are the runners that are in auto-yield mode
-        // that are not attached to the the client cursor. For example, all internal runners don't
-        // need to be cached -- there will be no getMore.
-        for (RunnerSet::iterator it = nonCachedRunners.begin(); it != nonCachedRunners.end();
-             ++it) {
-
-            Runner* runner = *it;
-            const string& runnerNS = runner->ns();
-            if ( ( isDB && StringData(runnerNS).startsWith(ns) ) || ns == runnerNS ) {
-                runner->kill();
+        {
+            recursive_scoped_lock cclock(ccmutex);
+            // Look at all active non-cached Runners.  These are the runners that are in
+            // auto-yield mode that are not attached to the the client cursor. For example, all
+            // internal runners don't need to be cached -- there will be no getMore.
+            for (RunnerSet::iterator it = nonCachedRunners.begin(); it != nonCachedRunners.end();
+                 ++it) {
+
+                Runner* runner = *it;
+                const string& runnerNS = runner->ns();
+                if ( ( isDB && StringData(runnerNS).startsWith(ns) ) || ns == runnerNS ) {
+                    runner->kill();
+                }
             }
         }
 
         // Look at all cached ClientCursor(s).  The CC may have a Runner, a Cursor, or nothing (see
-        // sharding_block.h).
-        CCById::const_iterator it = clientCursorsById.begin();
-        while (it != clientCursorsById.end()) {
-            ClientCursor* cc = it->second;
+        // sharding_block.h).  We hold the db write lock, so no new cursor on this db can appear
+        // between partitions.
+        for ( int partNo = 0; partNo < NumPartitions; partNo++ ) {
+            Partition& p = _partitions[partNo];
+            recursive_scoped_lock cclock( p.mutex );
+
+            CCById::const_iterator it = p.byId.begin();
+            while (it != p.byId.end()) {
+                ClientCursor* cc = it->second;
 
-            // Aggregation cursors don't have their lifetime bound to the underlying collection.
-            if (cc->isAggCursor) {
-                ++it;
-                continue;
-            }
+                // Aggregation cursors don't have their lifetime bound to the underlying collection.
+                if (cc->isAggCursor) {
+                    ++it;
+                    continue;
+                }
 
-            // We're only interested in cursors over one db.
-            if (cc->_db != db) {
-                ++it;
-                continue;
-            }
+                // We're only interested in cursors over one db.
+                if (cc->_db != db) {
+                    ++it;
+                    continue;
+                }
 
-            // Note that a valid ClientCursor state is "no cursor no runner."  This is because
-            // the set of active cursor IDs in ClientCursor is used as representation of query
-            // state.  See sharding_block.h.  TODO(greg,hk): Move this out.
-            if (NULL == cc->_runner.get()) {
-                ++it;
-                continue;
-            }
+                // Note that a valid ClientCursor state is "no cursor no runner."  This is because
+                // the set of active cursor IDs in ClientCursor is used as representation of query
+                // state.  See sharding_block.h.  TODO(greg,hk): Move this out.
+                if (NULL == cc->_runner.get()) {
+                    ++it;
+                    continue;
+                }
 
-            bool shouldDelete = false;
-
-            // We will only delete CCs with runners that are not actively in use.  The runners that
-            // are actively in use are instead kill()-ed.
-            if (NULL != cc->_runner.get()) {
-                if (isDB || cc->_runner->ns() == ns) {
-                    // If there is a pinValue >= 100, somebody is actively using the CC and we do
-                    // not delete it.  Instead we notify the holder that we killed it.  The holder
-                    // will then delete the CC.
-                    if (cc->_pinValue >= 100) {
-                        cc->_runner->kill();
-                    }
-                    else {
-                        // pinvalue is <100, so there is nobody actively holding the CC.  We can
-                        // safely delete it as nobody is holding the CC.
-                        shouldDelete = true;
+                bool shouldDelete = false;
+
+                // We will only delete CCs with runners that are not actively in use.  The runners
+                // that are actively in use are instead kill()-ed.
+                if (NULL != cc->_runner.get()) {
+                    if (isDB || cc->_runner->ns() == ns) {
+                        // If there is a pinValue >= 100, somebody is actively using the CC and we
+                        // do not delete it.  Instead we notify the holder that we killed it.  The
+                        // holder will then delete the CC.
+                        if (cc->_pinValue >= 100) {
+                            cc->_runner->kill();
+                        }
+                        else {
+                            // pinvalue is <100, so there is nobody actively holding the CC.  We
+                            // can safely delete it as nobody is holding the CC.
+                            shouldDelete = true;
+                        }
                     }
                 }
-            }
 
-            if (shouldDelete) {
-                ClientCursor* toDelete = it->second;
-                CursorId id = toDelete->cursorid();
-                delete toDelete;
-                // We're not following the usual paradigm of saving it, ++it, and deleting the saved
-                // 'it' because deleting 'it' might invalidate the next thing in clientCursorsById.
-                // TODO: Why?
-                it = clientCursorsById.upper_bound(id);
-            }
-            else {
-                ++it;
+                if (shouldDelete) {
+                    ClientCursor* toDelete = it->second;
+                    CursorId id = toDelete->cursorid();
+                    delete toDelete;
+                    // We're not following the usual paradigm of saving it, ++it, and deleting the
+                    // saved 'it' because deleting 'it' might invalidate the next thing in the map.
+                    // TODO: Why?
+                    it = p.byId.upper_bound(id);
+                }
+                else {
+                    ++it;
+                }
             }
         }
     }
@@ -231,20 +288,22 @@ namespace mongo {
         NoPageFaultsAllowed npfa;
         // End cursor-only
 
-        recursive_scoped_lock lock(ccmutex);
-
         Database *db = cc().database();
         verify(db);
 
-        aboutToDeleteForSharding( ns, db, nsd, dl );
+        {
+            recursive_scoped_lock lock(ccmutex);
+
+            aboutToDeleteForSharding( ns, db, nsd, dl );
 
-        // Check our non-cached active runner list.
-        for (RunnerSet::iterator it = nonCachedRunners.begin(); it != nonCachedRunners.end();
-             ++it) {
+            // Check our non-cached active runner list.
+            for (RunnerSet::iterator it = nonCachedRunners.begin(); it != nonCachedRunners.end();
+                 ++it) {
 
-            Runner* runner = *it;
-            if (0 == ns.compare(runner->ns())) {
-                runner->invalidate(dl);
+                Runner* runner = *it;
+                if (0 == ns.compare(runner->ns())) {
+                    runner->invalidate(dl);
+                }
             }
         }
 
@@ -254,15 +313,19 @@ namespace mongo {
         // 2. Map from ns -> (a map of DiskLoc -> runners who care about that DL)
         //
         // We could also queue invalidations somehow and have them processed later in the runner's
-        // read locks.
-        for (CCById::const_iterator it = clientCursorsById.begin(); it != clientCursorsById.end();
-             ++it) {
+        // read locks.  We hold the db write lock, so the set of cursors on this db can't change
+        // between partitions.
+        for ( int partNo = 0; partNo < NumPartitions; partNo++ ) {
+            Partition& p = _partitions[partNo];
+            recursive_scoped_lock lock( p.mutex );
 
-            ClientCursor* cc = it->second;
-            // We're only interested in cursors over one db.
-            if (cc->_db != db) { continue; }
-            if (NULL == cc->_runner.get()) { continue; }
-            cc->_runner->invalidate(dl);
+            for (CCById::const_iterator it = p.byId.begin(); it != p.byId.end(); ++it) {
+                ClientCursor* cc = it->second;
+                // We're only interested in cursors over one db.
+                if (cc->_db != db) { continue; }
+                if (NULL == cc->_runner.get()) { continue; }
+                cc->_runner->invalidate(dl);
+            }
         }
     }
 
@@ -360,58 +423,108 @@ namespace mongo {
 
     bool ClientCursor::shouldTimeout(unsigned millis) {
         _idleAgeMillis += millis;
-        return _idleAgeMillis > 600000 && _pinValue == 0;
+        return _idleAgeMillis > kCursorTimeoutMillis && _pinValue == 0;
     }
 
     void ClientCursor::setIdleTime( unsigned millis ) {
         _idleAgeMillis = millis;
+        // the wheel entry is not touched here; when it fires it re-arms off this stamp
+        _lastUseMillis = curTimeMillis64() - millis;
+    }
+
+    void ClientCursor::noteBatchTime( long long micros ) {
+        const long long budgetMicros =
+            static_cast<long long>( getMoreTargetBatchTimeMS ) * 1000;
+
+        if ( micros > budgetMicros ) {
+            _targetBatchBytes = std::max( kMinTargetBatchBytes, _targetBatchBytes / 2 );
+        }
+        else if ( micros < budgetMicros / 2 ) {
+            _targetBatchBytes = std::min( static_cast<int>( MaxBytesToReturnToClientAtOnce ),
+                                          _targetBatchBytes * 2 );
+        }
     }
 
     void ClientCursor::idleTimeReport(unsigned millis) {
-        bool foundSomeToTimeout = false;
+        const unsigned long long now = curTimeMillis64();
+
+        // the wheel only returns cursors whose deadline has come up, so this pass costs
+        // proportional to expirations rather than to the number of open cursors.
+        vector<unsigned long long> due;
+        cursorTimeoutWheel().collectDue( now, &due );
+
+        // two passes so that we don't need to readlock unless we really do some timeouts.
+        // each candidate only takes its own partition's lock, so getMores on the other
+        // partitions are never blocked.
+        vector<unsigned long long> doomed;
+        for ( size_t i = 0; i < due.size(); i++ ) {
+            const CursorId id = static_cast<CursorId>( due[i] );
+            Partition& p = _partition( id );
+            recursive_scoped_lock lock( p.mutex );
+
+            CCById::iterator it = p.byId.find( id );
+            if ( it == p.byId.end() ) {
+                // cursor already closed; its wheel entry was stale
+                continue;
+            }
 
-        // two passes so that we don't need to readlock unless we really do some timeouts
-        // we assume here that incrementing _idleAgeMillis outside readlock is ok.
-        {
-            recursive_scoped_lock lock(ccmutex);
-            {
-                unsigned sz = clientCursorsById.size();
-                static time_t last;
-                if( sz >= 100000 ) { 
-                    if( time(0) - last > 300 ) {
-                        last = time(0);
-                        log() << "warning number of open cursors is very large: " << sz << endl;
-                    }
-                }
+            ClientCursor* cc = it->second;
+            const unsigned long long idleMs = now - cc->_lastUseMillis;
+            if ( cc->_pinValue > 0 || idleMs <= kCursorTimeoutMillis ) {
+                // pinned, no-timeout, or used since this deadline was scheduled: re-arm
+                const unsigned long long base = cc->_pinValue > 0 ? now : cc->_lastUseMillis;
+                cursorTimeoutWheel().schedule( due[i], base + kCursorTimeoutMillis + 1 );
+                continue;
             }
-            for ( CCById::iterator i = clientCursorsById.begin(); i != clientCursorsById.end();  ) {
-                CCById::iterator j = i;
-                i++;
-                if( j->second->shouldTimeout( millis ) ) {
-                    foundSomeToTimeout = true;
+
+            cc->setIdleTime( static_cast<unsigned>( idleMs ) );
+            doomed.push_back( due[i] );
+        }
+
+        unsigned totalOpen = 0;
+        for ( int partNo = 0; partNo < NumPartitions; partNo++ ) {
+            Partition& p = _partitions[partNo];
+            recursive_scoped_lock lock( p.mutex );
+            totalOpen += p.byId.size();
+        }
+
+        {
+            static time_t last;
+            if( totalOpen >= 100000 ) {
+                if( time(0) - last > 300 ) {
+                    last = time(0);
+                    log() << "warning number of open cursors is very large: " << totalOpen << endl;
                 }
             }
         }
 
-        if( foundSomeToTimeout ) {
+        if( !doomed.empty() ) {
             Lock::GlobalRead lk;
 
-            recursive_scoped_lock cclock(ccmutex);
-            CCById::const_iterator it = clientCursorsById.begin();
-            while (it != clientCursorsById.end()) {
+            for ( size_t i = 0; i < doomed.size(); i++ ) {
+                const CursorId id = static_cast<CursorId>( doomed[i] );
+                Partition& p = _partition( id );
+                recursive_scoped_lock cclock( p.mutex );
+
+                CCById::iterator it = p.byId.find( id );
+                if ( it == p.byId.end() )
+                    continue;
+
                 ClientCursor* cc = it->second;
                 if( cc->shouldTimeout(0) ) {
-                    numberTimedOut++;
+                    numberTimedOut.fetchAndAdd(1);
                     LOG(1) << "killing old cursor " << cc->_cursorid << ' ' << cc->_ns
                            << " idle:" << cc->idleTime() << "ms\n";
-                    ClientCursor* toDelete = it->second;
-                    CursorId id = toDelete->cursorid();
                     // This is what winds up removing it from the map.
-                    delete toDelete;
-                    it = clientCursorsById.upper_bound(id);
+                    delete cc;
                 }
                 else {
-                    ++it;
+                    // used or pinned between the two passes; it has no wheel entry
+                    // anymore, so re-arm it
+                    const unsigned long long base =
+                        cc->_pinValue > 0 ? now : cc->_lastUseMillis;
+                    cursorTimeoutWheel().schedule( doomed[i],
+                                                   base + kCursorTimeoutMillis + 1 );
                 }
             }
         }
@@ -424,38 +537,55 @@ namespace mongo {
     }
 
     void ClientCursor::appendStats( BSONObjBuilder& result ) {
-        recursive_scoped_lock lock(ccmutex);
-        result.appendNumber("totalOpen", clientCursorsById.size() );
-        result.appendNumber("clientCursors_size", (int) numCursors());
-        result.appendNumber("timedOut" , numberTimedOut);
+        unsigned total = 0;
         unsigned pinned = 0;
         unsigned notimeout = 0;
-        for ( CCById::iterator i = clientCursorsById.begin(); i != clientCursorsById.end(); i++ ) {
-            unsigned p = i->second->_pinValue;
-            if( p >= 100 )
-                pinned++;
-            else if( p > 0 )
-                notimeout++;
-        }
-        if( pinned ) 
+        for ( int partNo = 0; partNo < NumPartitions; partNo++ ) {
+            Partition& p = _partitions[partNo];
+            recursive_scoped_lock lock( p.mutex );
+            total += p.byId.size();
+            for ( CCById::iterator i = p.byId.begin(); i != p.byId.end(); i++ ) {
+                unsigned pin = i->second->_pinValue;
+                if( pin >= 100 )
+                    pinned++;
+                else if( pin > 0 )
+                    notimeout++;
+            }
+        }
+        result.appendNumber("totalOpen", (long long) total);
+        result.appendNumber("clientCursors_size", (int) total);
+        result.appendNumber("timedOut" , numberTimedOut.load());
+        if( pinned )
             result.append("pinned", pinned);
         if( notimeout )
             result.append("totalNoTimeout", notimeout);
     }
 
+    unsigned ClientCursor::numCursors() {
+        unsigned total = 0;
+        for ( int partNo = 0; partNo < NumPartitions; partNo++ ) {
+            Partition& p = _partitions[partNo];
+            recursive_scoped_lock lock( p.mutex );
+            total += p.byId.size();
+        }
+        return total;
+    }
+
     //
     // ClientCursor creation/deletion/access.
     //
 
-    // Some statics used by allocCursorId_inlock().
+    // Some statics used by allocCursorId().
     namespace {
-        // so we don't have to do find() which is a little slow very often.
-        long long cursorGenTSLast = 0;
         PseudoRandom* cursorGenRandom = NULL;
     }
 
-    long long ClientCursor::allocCursorId_inlock() {
+    long long ClientCursor::allocCursorId() {
         // It is important that cursor IDs not be reused within a short period of time.
+        // The caller rejects a candidate that is already in its partition and asks for
+        // another; all we guard here is the generator state.
+        recursive_scoped_lock lock(ccmutex);
+
         if (!cursorGenRandom) {
             scoped_ptr<SecureRandom> sr( SecureRandom::create() );
             cursorGenRandom = new PseudoRandom( sr->nextInt64() );
@@ -471,18 +601,17 @@ namespace mongo {
 
             if ( x < 0 ) { x *= -1; }
 
-            if ( ts != cursorGenTSLast || ClientCursor::find_inlock(x, false) == 0 )
-                break;
+            break;
         }
 
-        cursorGenTSLast = ts;
         return x;
     }
 
     // static
     ClientCursor* ClientCursor::find_inlock(CursorId id, bool warn) {
-        CCById::iterator it = clientCursorsById.find(id);
-        if ( it == clientCursorsById.end() ) {
+        CCById& byId = _partition(id).byId;
+        CCById::iterator it = byId.find(id);
+        if ( it == byId.end() ) {
             if ( warn ) {
                 OCCASIONALLY out() << "ClientCursor::find(): cursor not found in map '" << id
                     << "' (ok after a drop)" << endl;
@@ -493,17 +622,20 @@ namespace mongo {
     }
 
     void ClientCursor::find( const string& ns , set<CursorId>& all ) {
-        recursive_scoped_lock lock(ccmutex);
+        for ( int partNo = 0; partNo < NumPartitions; partNo++ ) {
+            Partition& p = _partitions[partNo];
+            recursive_scoped_lock lock( p.mutex );
 
-        for ( CCById::iterator i=clientCursorsById.begin(); i!=clientCursorsById.end(); ++i ) {
-            if ( i->second->_ns == ns )
-                all.insert( i->first );
+            for ( CCById::iterator i=p.byId.begin(); i!=p.byId.end(); ++i ) {
+                if ( i->second->_ns == ns )
+                    all.insert( i->first );
+            }
         }
     }
 
     // static
     ClientCursor* ClientCursor::find(CursorId id, bool warn) {
-        recursive_scoped_lock lock(ccmutex);
+        recursive_scoped_lock lock(_partition(id).mutex);
         ClientCursor *c = find_inlock(id, warn);
         // if this asserts, your code was not thread safe - you either need to set no timeout
         // for the cursor or keep a ClientCursor::Pointer in scope for it.
@@ -521,7 +653,7 @@ namespace mongo {
     }
 
     bool ClientCursor::erase(CursorId id) {
-        recursive_scoped_lock lock(ccmutex);
+        recursive_scoped_lock lock(_partition(id).mutex);
         ClientCursor* cursor = find_inlock(id);
         if (!cursor) { return false; }
         _erase_inlock(cursor);
@@ -543,7 +675,7 @@ namespace mongo {
     bool ClientCursor::eraseIfAuthorized(CursorId id) {
         NamespaceString ns;
         {
-            recursive_scoped_lock lock(ccmutex);
+            recursive_scoped_lock lock(_partition(id).mutex);
             ClientCursor* cursor = find_inlock(id);
             if (!cursor) {
                 audit::logKillCursorsAuthzCheck(
@@ -571,7 +703,7 @@ namespace mongo {
         // It is safe to lookup the cursor again after temporarily releasing the mutex because
         // of 2 invariants: that the cursor ID won't be re-used in a short period of time, and that
         // the namespace associated with a cursor cannot change.
-        recursive_scoped_lock lock(ccmutex);
+        recursive_scoped_lock lock(_partition(id).mutex);
         ClientCursor* cursor = find_inlock(id);
         if (!cursor) {
             // Cursor was deleted in another thread since we found it earlier in this function.
@@ -622,7 +754,7 @@ namespace mongo {
     //
 
     ClientCursorPin::ClientCursorPin(long long cursorid) : _cursorid( INVALID_CURSOR_ID ) {
-        recursive_scoped_lock lock( ClientCursor::ccmutex );
+        recursive_scoped_lock lock( ClientCursor::_partition( cursorid ).mutex );
         ClientCursor *cursor = ClientCursor::find_inlock( cursorid, true );
         if (NULL != cursor) {
             uassert( 12051, "clientcursor already in use? driver problem?",
@@ -38,6 +38,7 @@
 #include "mongo/db/matcher.h"
 #include "mongo/db/projection.h"
 #include "mongo/db/query/runner.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/s/collection_metadata.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/background.h"
@@ -55,6 +56,10 @@ namespace mongo {
     typedef long long CursorId; /* passed to the client so it can send back on getMore */
     static const CursorId INVALID_CURSOR_ID = -1; // But see SERVER-5726.
 
+    // Tunables for adaptive getMore batch sizing; see ClientCursor::targetBatchBytes().
+    extern int getMoreTargetBatchBytes;
+    extern int getMoreTargetBatchTimeMS;
+
     /**
      * ClientCursor is a wrapper that represents a cursorid from our database application's
      * perspective.
@@ -127,13 +132,13 @@ namespace mongo {
         // ClientCursor creation/deletion.
         //
 
-        static unsigned numCursors() { return clientCursorsById.size(); }
+        static unsigned numCursors();
         static void find( const string& ns , set<CursorId>& all );
         static ClientCursor* find(CursorId id, bool warn = true);
 
         // Same as erase but checks to make sure this thread has read permission on the cursor's
         // namespace.  This should be called when receiving killCursors from a client.  This should
-        // not be called when ccmutex is held.
+        // not be called when the cursor's partition lock is held.
         static int eraseIfAuthorized(int n, long long* ids);
         static bool eraseIfAuthorized(CursorId id);
 
@@ -156,13 +161,15 @@ namespace mongo {
 
         /**
          * called every 4 seconds.  millis is amount of idle time passed since the last call --
-         * could be zero
+         * could be zero.  Expiry candidates come from a hashed timer wheel, so each pass
+         * only touches cursors whose deadline has come up, not the whole registry; the
+         * registry partitions are locked one at a time and only for those candidates.
          */
         static void idleTimeReport(unsigned millis);
 
         /**
          * @param millis amount of idle passed time since last call
-         * note called outside of locks (other than ccmutex) so care must be exercised
+         * note called outside of locks (other than a partition lock) so care must be exercised
          */
         bool shouldTimeout( unsigned millis );
         void setIdleTime( unsigned millis );
@@ -173,6 +180,24 @@ namespace mongo {
             _leftoverMaxTimeMicros = leftoverMaxTimeMicros;
         }
 
+        //
+        // Adaptive getMore batch sizing.
+        //
+
+        /**
+         * How many reply bytes should the next getMore on this cursor aim for?  Starts at the
+         * getMoreTargetBatchBytes server parameter and is tuned per batch by noteBatchTime
+         * below.  Only consulted when the client doesn't ask for a specific batch size.
+         */
+        int targetBatchBytes() const { return _targetBatchBytes; }
+
+        /**
+         * Feeds the server time spent filling the last batch back into the sizing model: well
+         * under the getMoreTargetBatchTimeMS budget and the next batch grows (up to the reply
+         * size cap), over budget and it shrinks.
+         */
+        void noteBatchTime( long long micros );
+
         //
         // Sharding-specific data.  TODO: Document.
         //
@@ -256,9 +281,22 @@ namespace mongo {
         friend class CmdCursorInfo;
 
         // A map from the CursorId to the ClientCursor behind it.
-        // TODO: Consider making this per-connection.
         typedef map<CursorId, ClientCursor*> CCById;
-        static CCById clientCursorsById;
+
+        // The cursor registry, partitioned by the low bits of the cursor id (which are
+        // random) so concurrent getMore lookups on different cursors don't serialize on
+        // one global mutex.  Each partition's mutex guards only that partition's map; it
+        // is recursive because deleting a cursor re-enters the partition via
+        // ~ClientCursor.
+        enum { NumPartitions = 16 };
+        struct Partition {
+            boost::recursive_mutex mutex;
+            CCById byId;
+        };
+        static Partition* _partitions;
+        static Partition& _partition( CursorId id ) {
+            return _partitions[ static_cast<unsigned long long>( id ) % NumPartitions ];
+        }
 
         // A list of NON-CACHED runners.  Any runner that yields must be put into this map before
         // yielding in order to be notified of invalidation and namespace deletion.  Before the
@@ -269,9 +307,10 @@ namespace mongo {
         static RunnerSet nonCachedRunners;
 
         // How many cursors have timed out?
-        static long long numberTimedOut;
+        static AtomicInt64 numberTimedOut;
 
-        // This must be held when modifying any static member.
+        // Guards the runner registry and the cursor id generator.  Per-cursor state is
+        // guarded by the partition locks above; lookups by id never take this.
         static boost::recursive_mutex& ccmutex;
 
         /**
@@ -281,14 +320,15 @@ namespace mongo {
         void init();
 
         /**
-         * Allocates a new CursorId.
-         * Called from init(...).  Assumes ccmutex held.
+         * Allocates a new CursorId.  Called from init(...), which checks the candidate
+         * for uniqueness against (and inserts it into) the owning partition under that
+         * partition's lock.
          */
-        static CursorId allocCursorId_inlock();
+        static CursorId allocCursorId();
 
         /**
          * Find the ClientCursor with the provided ID.  Optionally warn if it's not found.
-         * Assumes ccmutex is held.
+         * Assumes the owning partition's mutex is held.
          */
 
         static ClientCursor* find_inlock(CursorId id, bool warn = true);
@@ -332,9 +372,15 @@ namespace mongo {
         // How long has the cursor been idle?
         unsigned _idleAgeMillis;
 
+        // Wall clock (curTimeMillis64) of the last use; drives the timeout wheel.
+        unsigned long long _lastUseMillis;
+
         // TODO: Document.
         uint64_t _leftoverMaxTimeMicros;
 
+        // See targetBatchBytes().
+        int _targetBatchBytes;
+
         // For chunks that are being migrated, there is a period of time when that chunks data is in
         // two shards, the donor and the receiver one. That data is picked up by a cursor on the
         // receiver side, even before the migration was decided.  The CollectionMetadata allow one
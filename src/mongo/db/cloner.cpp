@@ -52,6 +52,7 @@
 #include "mongo/db/pdfile.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/structure/collection.h"
+#include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
 
@@ -116,6 +117,46 @@ namespace mongo {
     struct Cloner::Fun {
         Fun( Client::Context& ctx ) : lastLog(0), context( ctx ) { }
 
+        /**
+         * Inserts the documents gathered from the current batch in one go through the bulk
+         * insert path (per document on capped collections, which the bulk path doesn't
+         * take), then lets the journal commit.  Must be called before any lock release, as
+         * the docs point into the cursor's batch buffer and 'collection' goes stale.
+         */
+        void flushPending( Collection* collection, vector<BSONObj>* docs ) {
+            if ( docs->empty() )
+                return;
+            verify( collection );
+
+            if ( collection->isCapped() ) {
+                for ( size_t k = 0; k < docs->size(); k++ ) {
+                    StatusWith<DiskLoc> loc = collection->insertDocument( (*docs)[k], true );
+                    if ( !loc.isOK() ) {
+                        error() << "error: exception cloning object in " << from_collection
+                                << ' ' << loc.toString() << " obj:" << (*docs)[k];
+                    }
+                    uassertStatusOK( loc.getStatus() );
+                }
+            }
+            else {
+                vector<DiskLoc> locs;
+                Status status = collection->insertDocumentsBulk( *docs, true, &locs );
+                if ( !status.isOK() ) {
+                    error() << "error: exception bulk cloning objects in " << from_collection
+                            << ' ' << status.toString();
+                }
+                uassertStatusOK( status );
+            }
+
+            if ( logForRepl ) {
+                for ( size_t k = 0; k < docs->size(); k++ )
+                    logOp("i", to_collection, (*docs)[k]);
+            }
+
+            getDur().commitIfNeeded();
+            docs->clear();
+        }
+
         void operator()( DBClientCursorBatchIterator &i ) {
             Lock::GlobalWrite lk;
             context.relocked();
@@ -123,11 +164,15 @@ namespace mongo {
             bool createdCollection = false;
             Collection* collection = NULL;
 
+            // data documents gathered from the batch for one bulk insert
+            vector<BSONObj> pending;
+
             while( i.moreInCurrentBatch() ) {
                 if ( n % 128 == 127 /*yield some*/ ) {
+                    flushPending( collection, &pending );
                     collection = NULL;
                     time_t now = time(0);
-                    if( now - lastLog >= 60 ) { 
+                    if( now - lastLog >= 60 ) {
                         // report progress
                         if( lastLog )
                             log() << "clone " << to_collection << ' ' << n << endl;
@@ -173,22 +218,15 @@ namespace mongo {
 
                 verify(nsToCollectionSubstring(from_collection) != "system.indexes");
 
-                StatusWith<DiskLoc> loc = collection->insertDocument( js, true );
-                if ( !loc.isOK() ) {
-                    error() << "error: exception cloning object in " << from_collection
-                            << ' ' << loc.toString() << " obj:" << js;
-                }
-                uassertStatusOK( loc.getStatus() );
-                if ( logForRepl )
-                    logOp("i", to_collection, js);
-
-                getDur().commitIfNeeded();
+                pending.push_back( js );
 
                 RARELY if ( time( 0 ) - saveLast > 60 ) {
                     log() << n << " objects cloned so far from collection " << from_collection << endl;
                     saveLast = time( 0 );
                 }
             }
+
+            flushPending( collection, &pending );
         }
 
         time_t lastLog;
@@ -331,6 +369,82 @@ namespace mongo {
 
     extern bool inDBRepair;
 
+    /** shared state for the parallel collection copy in go() */
+    struct Cloner::ParallelCloneState {
+        ParallelCloneState() : mutex( "Cloner::ParallelCloneState" ), failed( false ) {}
+
+        struct Item {
+            Item() : wantIdIndex( false ) {}
+            string from_name;
+            string to_name;
+            bool wantIdIndex;
+        };
+
+        // set up by the coordinating thread before the workers start
+        string masterHost;
+        const CloneOptions* opts;
+
+        SimpleMutex mutex;
+        std::list<Item> work;  // guarded by mutex
+        bool failed;           // guarded by mutex
+        string errmsg;         // guarded by mutex
+    };
+
+    void Cloner::_copyCollectionsWorker( ParallelCloneState* state ) {
+        if ( !haveClient() )
+            Client::initThread( "initial sync cloner" );
+
+        try {
+            Cloner workerCloner;
+            {
+                string errmsg;
+                ConnectionString cs = ConnectionString::parse( state->masterHost, errmsg );
+                auto_ptr<DBClientBase> con( cs.connect( errmsg ) );
+                uassert( 17471, str::stream() << "clone worker couldn't connect to "
+                         << state->masterHost << ": " << errmsg, con.get() );
+                uassert( 17472, str::stream() << "clone worker couldn't authenticate to "
+                         << state->masterHost, replAuthenticate( con.get() ) );
+                workerCloner._conn = con;
+            }
+
+            while ( true ) {
+                ParallelCloneState::Item item;
+                {
+                    SimpleMutex::scoped_lock lk( state->mutex );
+                    if ( state->failed || state->work.empty() )
+                        break;
+                    item = state->work.front();
+                    state->work.pop_front();
+                }
+
+                LOG(1) << "\t\t cloning " << item.from_name << " -> " << item.to_name << endl;
+                Query q;
+                if ( state->opts->snapshot )
+                    q.snapshot();
+
+                Client::WriteContext ctx( item.to_name );
+                workerCloner.copy( ctx.ctx(), item.from_name.c_str(), item.to_name.c_str(),
+                                   false, state->opts->logForRepl, false,
+                                   state->opts->slaveOk, state->opts->mayYield,
+                                   state->opts->mayBeInterrupted, q );
+
+                if ( item.wantIdIndex ) {
+                    // inDBRepair (-> dropDups) is set for the whole parallel phase
+                    // by go(); see the serial path for why
+                    Collection* c = ctx.ctx().db()->getCollection( item.to_name );
+                    if ( c )
+                        c->getIndexCatalog()->ensureHaveIdIndex();
+                }
+            }
+        }
+        catch ( DBException& e ) {
+            SimpleMutex::scoped_lock lk( state->mutex );
+            state->failed = true;
+            if ( state->errmsg.empty() )
+                state->errmsg = str::stream() << "clone worker failed: " << e.what();
+        }
+    }
+
     bool Cloner::go(Client::Context& context,
                     const string& masterHost, const CloneOptions& opts, set<string>* clonedColls,
                     string& errmsg, int* errCode) {
@@ -440,6 +554,9 @@ namespace mongo {
             }
         }
 
+        // create the collections first; the data copy below may fan out over
+        // worker threads and collection creation wants the caller's context
+        ParallelCloneState state;
         for ( list<BSONObj>::iterator i=toClone.begin(); i != toClone.end(); i++ ) {
             {
                 mayInterrupt( opts.mayBeInterrupted );
@@ -455,35 +572,88 @@ namespace mongo {
             verify(p);
             string to_name = todb + p;
 
-            bool wantIdIndex = false;
+            ParallelCloneState::Item item;
+            item.from_name = from_name;
+            item.to_name = to_name;
             {
                 string err;
                 const char *toname = to_name.c_str();
                 /* we defer building id index for performance - building it in batch is much faster */
-                userCreateNS(toname, options, err, opts.logForRepl, &wantIdIndex);
-            }
-            LOG(1) << "\t\t cloning " << from_name << " -> " << to_name << endl;
-            Query q;
-            if( opts.snapshot )
-                q.snapshot();
-            copy(context,from_name, to_name.c_str(), false, opts.logForRepl, masterSameProcess,
-                 opts.slaveOk, opts.mayYield, opts.mayBeInterrupted, q);
-
-            if( wantIdIndex ) {
-                /* we need dropDups to be true as we didn't do a true snapshot and this is before applying oplog operations
-                   that occur during the initial sync.  inDBRepair makes dropDups be true.
-                   */
-                bool old = inDBRepair;
-                try {
-                    inDBRepair = true;
-                    Collection* c = cc().database()->getCollection( to_name );
-                    if ( c )
-                        c->getIndexCatalog()->ensureHaveIdIndex();
-                    inDBRepair = old;
+                userCreateNS(toname, options, err, opts.logForRepl, &item.wantIdIndex);
+            }
+            state.work.push_back( item );
+        }
+
+        const bool parallel = opts.parallelCollections > 1 && !masterSameProcess &&
+                              opts.mayYield && state.work.size() > 1;
+
+        if ( parallel ) {
+            state.masterHost = masterHost;
+            state.opts = &opts;
+
+            int nWorkers = opts.parallelCollections;
+            if ( static_cast<size_t>( nWorkers ) > state.work.size() )
+                nWorkers = state.work.size();
+
+            LOG(0) << "cloning " << state.work.size() << " collections from " << opts.fromDB
+                   << " on " << nWorkers << " workers" << endl;
+
+            // release our db lock while the workers take their own
+            dbtempreleaseif r( opts.mayYield );
+
+            /* we need dropDups to be true for the deferred id index builds, as we
+               didn't do a true snapshot and this is before applying oplog operations
+               that occur during the initial sync.  inDBRepair makes dropDups be true.
+               the node isn't serving clients during initial sync, so setting it for
+               the whole phase is fine. */
+            bool old = inDBRepair;
+            inDBRepair = true;
+            {
+                ThreadPool workers( nWorkers );
+                for ( int i = 0; i < nWorkers; i++ )
+                    workers.schedule( boost::bind( &Cloner::_copyCollectionsWorker, &state ) );
+                workers.join();
+            }
+            inDBRepair = old;
+
+            if ( state.failed ) {
+                errmsg = state.errmsg;
+                return false;
+            }
+        }
+        else {
+            while ( !state.work.empty() ) {
+                ParallelCloneState::Item item = state.work.front();
+                state.work.pop_front();
+                {
+                    mayInterrupt( opts.mayBeInterrupted );
+                    dbtempreleaseif r( opts.mayYield );
                 }
-                catch(...) {
-                    inDBRepair = old;
-                    throw;
+
+                LOG(1) << "\t\t cloning " << item.from_name << " -> " << item.to_name << endl;
+                Query q;
+                if( opts.snapshot )
+                    q.snapshot();
+                copy(context, item.from_name.c_str(), item.to_name.c_str(), false,
+                     opts.logForRepl, masterSameProcess, opts.slaveOk, opts.mayYield,
+                     opts.mayBeInterrupted, q);
+
+                if( item.wantIdIndex ) {
+                    /* we need dropDups to be true as we didn't do a true snapshot and this is before applying oplog operations
+                       that occur during the initial sync.  inDBRepair makes dropDups be true.
+                       */
+                    bool old = inDBRepair;
+                    try {
+                        inDBRepair = true;
+                        Collection* c = cc().database()->getCollection( item.to_name );
+                        if ( c )
+                            c->getIndexCatalog()->ensureHaveIdIndex();
+                        inDBRepair = old;
+                    }
+                    catch(...) {
+                        inDBRepair = old;
+                        throw;
+                    }
                 }
             }
         }
@@ -93,6 +93,13 @@ namespace mongo {
                   Query q);
 
         struct Fun;
+        struct ParallelCloneState;
+
+        /** worker thread body for the parallel collection copy in go().  each
+            worker opens its own connection to the source and pulls collections
+            off the shared work list until it is empty or a worker fails. */
+        static void _copyCollectionsWorker( ParallelCloneState* state );
+
         auto_ptr<DBClientBase> _conn;
     };
 
@@ -108,6 +115,8 @@ namespace mongo {
 
             syncData = true;
             syncIndexes = true;
+
+            parallelCollections = 0;
         }
 
         string fromDB;
@@ -122,6 +131,12 @@ namespace mongo {
 
         bool syncData;
         bool syncIndexes;
+
+        // copy collection data on this many worker threads, each streaming over
+        // its own connection to the source.  0/1 = one collection at a time over
+        // the existing connection.  only honored for remote sources when
+        // mayYield is set (the workers take their own locks).
+        int parallelCollections;
     };
 
 } // namespace mongo
@@ -38,11 +38,65 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/commands/dbhash.h"
+#include "mongo/db/database.h"
+#include "mongo/db/dur.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/matcher.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/db/structure/collection.h"
 
 namespace mongo {
+
+    namespace {
+
+        /**
+         * An op the bulk insert path can take: a plain 'i' on a non-system collection whose
+         * document carries an _id.  Anything else goes through applyOperation_inlock.
+         */
+        bool isPlainInsert( const BSONObj& op ) {
+            if ( *op["op"].valuestrsafe() != 'i' || op["op"].valuestrsafe()[1] != 0 )
+                return false;
+
+            const char* ns = op["ns"].valuestrsafe();
+            const char* p = strchr( ns, '.' );
+            if ( !p || nsToCollectionSubstring( p ).startsWith( "system." ) )
+                return false;
+
+            BSONElement o = op["o"];
+            if ( !o.isABSONObj() )
+                return false;
+            BSONElement id;
+            return o.Obj().getObjectID( id );
+        }
+
+        /**
+         * Applies a run of consecutive insert ops through Collection::insertDocumentsBulk.
+         * Returns false if the run can't (or didn't) go in that way; any documents a failed
+         * bulk attempt did insert are harmless because the caller falls back to the
+         * per-op path, whose upsert-by-_id semantics make the replay idempotent.
+         */
+        bool tryBulkInsert( const string& ns, const vector<BSONObj>& docs ) {
+            Collection* collection = cc().database()->getCollection( ns );
+            if ( !collection || collection->isCapped() )
+                return false;
+            if ( !collection->getIndexCatalog()->haveIdIndex() )
+                return false;
+
+            vector<DiskLoc> locs;
+            Status status = collection->insertDocumentsBulk( docs, true, &locs );
+            if ( !status.isOK() )
+                return false;
+
+            for ( size_t i = 0; i < docs.size(); i++ ) {
+                globalOpCounters.gotInsert();
+                getGlobalAuthorizationManager()->logOp( "i", ns.c_str(), docs[i], NULL, NULL );
+            }
+            return true;
+        }
+
+    }  // namespace
+
     class ApplyOpsCmd : public Command {
     public:
         virtual bool slaveOk() const { return false; }
@@ -100,27 +154,70 @@ namespace mongo {
             // apply
             int num = 0;
             int errors = 0;
-            
-            BSONObjIterator i( ops );
+
             BSONArrayBuilder ab;
             const bool alwaysUpsert = cmdObj.hasField("alwaysUpsert") ?
                     cmdObj["alwaysUpsert"].trueValue() : true;
-            
-            while ( i.more() ) {
-                BSONElement e = i.next();
-                const BSONObj& temp = e.Obj();
 
-                string ns = temp["ns"].String();
+            vector<BSONObj> opList;
+            {
+                BSONObjIterator i( ops );
+                while ( i.more() )
+                    opList.push_back( i.next().Obj() );
+            }
+
+            // Process the ops in groups of consecutive ops on the same namespace, so each
+            // group resolves its context and collection once instead of per op, and runs of
+            // plain inserts within a group can go through the bulk insert path.
+            size_t idx = 0;
+            while ( idx < opList.size() ) {
+                string ns = opList[idx]["ns"].String();
+
+                size_t groupEnd = idx + 1;
+                while ( groupEnd < opList.size() &&
+                        strcmp( opList[groupEnd]["ns"].valuestrsafe(), ns.c_str() ) == 0 )
+                    groupEnd++;
 
                 Client::Context ctx(ns);
-                bool failed = applyOperation_inlock(temp, false, alwaysUpsert);
-                ab.append(!failed);
-                if ( failed )
-                    errors++;
 
-                num++;
+                bool bulkOK = true;
+                while ( idx < groupEnd ) {
+                    size_t runEnd = idx;
+                    vector<BSONObj> docs;
+                    if ( bulkOK ) {
+                        while ( runEnd < groupEnd && isPlainInsert( opList[runEnd] ) ) {
+                            docs.push_back( opList[runEnd]["o"].Obj() );
+                            runEnd++;
+                        }
+                    }
+
+                    if ( docs.size() >= 2 && tryBulkInsert( ns, docs ) ) {
+                        for ( size_t k = 0; k < docs.size(); k++ )
+                            ab.append( true );
+                        num += docs.size();
+                        idx = runEnd;
+                        continue;
+                    }
+
+                    // no (or too short) an insert run, or the bulk attempt bailed; don't
+                    // keep re-gathering runs that can't go in bulk
+                    if ( !docs.empty() )
+                        bulkOK = false;
+
+                    bool failed = applyOperation_inlock(opList[idx], false, alwaysUpsert);
+                    ab.append(!failed);
+                    if ( failed )
+                        errors++;
+
+                    num++;
+                    idx++;
+                }
 
                 logOpForDbHash( "u", ns.c_str(), BSONObj(), NULL, NULL, false );
+
+                // group boundary: let the journal commit if its buffer warrants it, instead
+                // of accumulating the whole applyOps in one giant commit
+                getDur().commitIfNeeded();
             }
 
             result.append( "applied" , num );
@@ -70,9 +70,13 @@ namespace mongo {
             help << "compact collection\n"
                 "warning: this operation blocks the server and is slow. you can cancel with cancelOp()\n"
                 "{ compact : <collection_name>, [force:<bool>], [validate:<bool>],\n"
-                "  [paddingFactor:<num>], [paddingBytes:<num>] }\n"
+                "  [paddingFactor:<num>], [paddingBytes:<num>], [incremental:<bool>] }\n"
                 "  force - allows to run on a replica set primary\n"
-                "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n";
+                "  validate - check records are noncorrupt before adding to newly compacting extents. slower but safer (defaults to true in this version)\n"
+                "  incremental - compact one extent at a time, releasing the write lock between extents so\n"
+                "    other operations can interleave.  slower overall; note the collection has no indexes\n"
+                "    (and thus no _id uniqueness enforcement) until the compact finishes, so avoid writing\n"
+                "    to the collection while it runs\n";
         }
         CompactCmd() : Command("compact") { }
 
@@ -144,6 +148,8 @@ namespace mongo {
             if ( cmdObj.hasElement("validate") )
                 compactOptions.validateDocuments = cmdObj["validate"].trueValue();
 
+            compactOptions.incremental = cmdObj["incremental"].trueValue();
+
             bool ok = false;
             {
                 Lock::DBWrite lk(ns.ns());
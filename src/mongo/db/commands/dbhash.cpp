@@ -34,13 +34,21 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/database.h"
 #include "mongo/db/query/internal_plans.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/md5.hpp"
 #include "mongo/util/timer.h"
 
 namespace mongo {
 
+    // When set, dbHash reports a maintained order-independent per-collection hash instead
+    // of re-scanning; see CollectionHashes.  The reported value has a different format
+    // than the legacy scan hash, so turn it on (or off) on every member being compared.
+    MONGO_EXPORT_SERVER_PARAMETER( dbHashIncremental, bool, false );
+
     DBHashCmd dbhashCmd;
 
+    CollectionHashes collectionHashes;
+
 
     void logOpForDbHash( const char* opstr,
                          const char* ns,
@@ -49,6 +57,108 @@ namespace mongo {
                          const BSONObj* fullObj,
                          bool forMigrateCleanup ) {
         dbhashCmd.wipeCacheForCollection( ns );
+
+        // commands (drop, rename, emptycapped, ...) can change collections without going
+        // through the document write paths, so toss anything maintained for that database
+        if ( *opstr == 'c' )
+            collectionHashes.forgetDb( nsToDatabaseSubstring( ns ) );
+    }
+
+    // ----
+
+    void CollectionHashes::State::add( const BSONObj& doc ) {
+        md5digest d;
+        md5( doc.objdata(), doc.objsize(), d );
+        unsigned long long a, b;
+        memcpy( &a, d, 8 );
+        memcpy( &b, d + 8, 8 );
+        lo += a;
+        hi += b;
+    }
+
+    void CollectionHashes::State::remove( const BSONObj& doc ) {
+        md5digest d;
+        md5( doc.objdata(), doc.objsize(), d );
+        unsigned long long a, b;
+        memcpy( &a, d, 8 );
+        memcpy( &b, d + 8, 8 );
+        lo -= a;
+        hi -= b;
+    }
+
+    string CollectionHashes::State::hex() const {
+        char buf[33];
+        snprintf( buf, sizeof(buf), "%016llx%016llx", lo, hi );
+        return buf;
+    }
+
+    CollectionHashes::CollectionHashes()
+        : _mutex( "CollectionHashes" ) {
+    }
+
+    bool CollectionHashes::isTracked( const StringData& ns ) {
+        if ( _trackedCount.load() == 0 )
+            return false;
+        scoped_lock lk( _mutex );
+        return _hashes.count( ns.toString() ) > 0;
+    }
+
+    void CollectionHashes::onInsert( const StringData& ns, const BSONObj& doc ) {
+        if ( _trackedCount.load() == 0 )
+            return;
+        scoped_lock lk( _mutex );
+        map<string,State>::iterator i = _hashes.find( ns.toString() );
+        if ( i != _hashes.end() )
+            i->second.add( doc );
+    }
+
+    void CollectionHashes::onDelete( const StringData& ns, const BSONObj& doc ) {
+        if ( _trackedCount.load() == 0 )
+            return;
+        scoped_lock lk( _mutex );
+        map<string,State>::iterator i = _hashes.find( ns.toString() );
+        if ( i != _hashes.end() )
+            i->second.remove( doc );
+    }
+
+    void CollectionHashes::onUpdate( const StringData& ns,
+                                     const BSONObj& oldDoc,
+                                     const BSONObj& newDoc ) {
+        if ( _trackedCount.load() == 0 )
+            return;
+        scoped_lock lk( _mutex );
+        map<string,State>::iterator i = _hashes.find( ns.toString() );
+        if ( i != _hashes.end() ) {
+            i->second.remove( oldDoc );
+            i->second.add( newDoc );
+        }
+    }
+
+    bool CollectionHashes::get( const StringData& ns, string* hex ) {
+        scoped_lock lk( _mutex );
+        map<string,State>::const_iterator i = _hashes.find( ns.toString() );
+        if ( i == _hashes.end() )
+            return false;
+        *hex = i->second.hex();
+        return true;
+    }
+
+    void CollectionHashes::seed( const StringData& ns, const State& state ) {
+        scoped_lock lk( _mutex );
+        _hashes[ ns.toString() ] = state;
+        _trackedCount.store( _hashes.size() );
+    }
+
+    void CollectionHashes::forgetDb( const StringData& db ) {
+        if ( _trackedCount.load() == 0 )
+            return;
+        string prefix = db.toString() + ".";
+        scoped_lock lk( _mutex );
+        map<string,State>::iterator i = _hashes.lower_bound( prefix );
+        while ( i != _hashes.end() && i->first.compare( 0, prefix.size(), prefix ) == 0 ) {
+            _hashes.erase( i++ );
+        }
+        _trackedCount.store( _hashes.size() );
     }
 
     // ----
@@ -84,6 +194,14 @@ namespace mongo {
         if ( !collection )
             return "";
 
+        if ( dbHashIncremental ) {
+            string hex;
+            if ( collectionHashes.get( fullCollectionName, &hex ) ) {
+                *fromCache = true;
+                return hex;
+            }
+        }
+
         IndexDescriptor* desc = collection->getIndexCatalog()->findIdIndex();
 
         auto_ptr<Runner> runner;
@@ -104,6 +222,11 @@ namespace mongo {
             return "no _id _index";
         }
 
+        // our READ lock is database level, so the scan and the seed are atomic with
+        // respect to writers and the accumulator stays exact from here on
+        const bool seedIncremental = dbHashIncremental && !collection->isCapped();
+        CollectionHashes::State incremental;
+
         md5_state_t st;
         md5_init(&st);
 
@@ -113,11 +236,19 @@ namespace mongo {
         verify(NULL != runner.get());
         while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&c, NULL))) {
             md5_append( &st , (const md5_byte_t*)c.objdata() , c.objsize() );
+            if ( seedIncremental )
+                incremental.add( c );
             n++;
         }
         if (Runner::RUNNER_EOF != state) {
             warning() << "error while hashing, db dropped? ns=" << fullCollectionName << endl;
         }
+
+        if ( seedIncremental && state == Runner::RUNNER_EOF ) {
+            collectionHashes.seed( fullCollectionName, incremental );
+            return incremental.hex();
+        }
+
         md5digest d;
         md5_finish(&st, d);
         string hash = digestToString( d );
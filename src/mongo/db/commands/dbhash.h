@@ -31,6 +31,7 @@
 #pragma once
 
 #include "mongo/db/commands.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
@@ -41,6 +42,60 @@ namespace mongo {
                          const BSONObj* fullObj,
                          bool forMigrateCleanup );
 
+    /**
+     * Order-independent running hash of a collection's documents.
+     *
+     * With the dbHashIncremental server parameter set, the first dbHash of a collection
+     * builds an accumulator during its scan; from then on the write paths keep it current
+     * and dbHash answers from it without rescanning.  The accumulator is the pair of
+     * sums mod 2^64 of the two halves of each document's md5, so adding and removing
+     * documents in any order produces the same value on every member.
+     *
+     * Capped collections are never tracked: overflow deletes bypass
+     * Collection::deleteDocument, so their accumulator could not be kept current.
+     */
+    class CollectionHashes {
+    public:
+
+        /** one collection's accumulator; also used to build the seed during a scan */
+        struct State {
+            State() : lo( 0 ), hi( 0 ) {}
+            void add( const BSONObj& doc );
+            void remove( const BSONObj& doc );
+            std::string hex() const;
+            unsigned long long lo;
+            unsigned long long hi;
+        };
+
+        CollectionHashes();
+
+        /** true if ns has a seeded accumulator the write paths have to maintain */
+        bool isTracked( const StringData& ns );
+
+        // write-path hooks, called with the database write lock for ns held
+        void onInsert( const StringData& ns, const BSONObj& doc );
+        void onDelete( const StringData& ns, const BSONObj& doc );
+        void onUpdate( const StringData& ns, const BSONObj& oldDoc, const BSONObj& newDoc );
+
+        /** fills in hex and returns true if ns has a seeded accumulator */
+        bool get( const StringData& ns, std::string* hex );
+
+        /** install an accumulator built by a scan, under the same lock as the scan */
+        void seed( const StringData& ns, const State& state );
+
+        /** discard state for every collection in db (drops, renames, etc) */
+        void forgetDb( const StringData& db );
+
+    private:
+        mutex _mutex;
+        std::map<std::string,State> _hashes;
+
+        // so the write-path hooks can bail without the mutex when nothing is tracked
+        AtomicUInt32 _trackedCount;
+    };
+
+    extern CollectionHashes collectionHashes;
+
     class DBHashCmd : public Command {
     public:
         DBHashCmd();
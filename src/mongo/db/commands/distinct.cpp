@@ -34,8 +34,12 @@
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/privilege.h"
+#include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
+#include "mongo/db/index/btree_index_cursor.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/index/index_descriptor.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/kill_current_op.h"
@@ -99,6 +103,83 @@ namespace mongo {
                 return true;
             }
 
+            // With no query and a btree index leading with the distinct field, skip-scan:
+            // emit a value, then seek directly past its last key instead of walking every
+            // equal key.  Touches O(distinct values x tree height) keys, which for a
+            // low-cardinality field is orders of magnitude fewer than the full index.
+            if ( query.isEmpty() ) {
+                IndexCatalog* catalog = collection->getIndexCatalog();
+                IndexDescriptor* desc = catalog->findIndexByPrefix( keyPattern,
+                                                                    false /*requireSingleKey*/ );
+                // sparse indexes drop null entries, which distinct must report
+                if ( desc && !desc->isSparse() &&
+                     catalog->getAccessMethodName( desc->keyPattern() ).empty() ) {
+
+                    IndexCursor* rawCursor;
+                    uassertStatusOK( catalog->getIndex( desc )->newCursor( &rawCursor ) );
+                    auto_ptr<IndexCursor> cursorHolder( rawCursor );
+                    BtreeIndexCursor* cursor = static_cast<BtreeIndexCursor*>( rawCursor );
+
+                    const int nFields = desc->keyPattern().nFields();
+
+                    BSONObj minObj;
+                    {
+                        BSONObjBuilder mb;
+                        for ( int i = 0; i < nFields; i++ )
+                            mb.appendMinKey( "" );
+                        minObj = mb.obj();
+                    }
+
+                    // fields after the skipped-past first one are unconstrained
+                    vector<BSONElement> minElts;
+                    BSONObjIterator mit( minObj );
+                    while ( mit.more() )
+                        minElts.push_back( mit.next() );
+                    vector<const BSONElement*> keyEnd( nFields );
+                    vector<bool> keyEndInclusive( nFields, true );
+                    for ( int i = 0; i < nFields; i++ )
+                        keyEnd[i] = &minElts[i];
+
+                    cursor->seek( minObj );
+                    while ( !cursor->isEOF() ) {
+                        killCurrentOp.checkForInterrupt();
+                        nscanned++;
+
+                        // owned: we hold it across the seek below
+                        BSONObj indexKey = cursor->getKey().getOwned();
+                        BSONElement elt = indexKey.firstElement();
+
+                        if ( !values.count( elt ) ) {
+                            int currentBufPos = bb.len();
+                            uassert(17495, "distinct too big, 16mb cap",
+                                    (currentBufPos + elt.size() + 1024) < bufSize);
+
+                            arr.append(elt);
+                            BSONElement x(start + currentBufPos);
+                            values.insert(x);
+                        }
+
+                        // seek past every key whose first field equals elt
+                        cursor->skip( indexKey, 1, true, keyEnd, keyEndInclusive );
+                    }
+
+                    verify( start == bb.buf() );
+
+                    result.appendArray( "values" , arr.done() );
+                    {
+                        BSONObjBuilder b;
+                        b.appendNumber( "n" , static_cast<long long>( values.size() ) );
+                        b.appendNumber( "nscanned" , nscanned );
+                        b.appendNumber( "nscannedObjects" , 0 );
+                        b.appendNumber( "timems" , t.millis() );
+                        b.append( "cursor" , "BtreeCursor " + desc->indexName()
+                                             + " (distinct skip scan)" );
+                        result.append( "stats" , b.obj() );
+                    }
+                    return true;
+                }
+            }
+
             CanonicalQuery* cq;
             // XXX: project out just the field we're distinct-ing.  May be covered...
             if (!CanonicalQuery::canonicalize(ns, query, &cq).isOK()) {
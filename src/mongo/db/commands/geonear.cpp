@@ -31,6 +31,7 @@
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/privilege.h"
+#include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/geo/geoconstants.h"
@@ -41,13 +42,112 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/namespace_details.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/query/find_constants.h"
 #include "mongo/db/query/get_runner.h"
+#include "mongo/db/query/runner.h"
 #include "mongo/db/query/type_explain.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/platform/unordered_map.h"
 
 namespace mongo {
 
+    namespace {
+
+        /**
+         * Convert one doc produced by the rewritten $near query (which carries the
+         * '$dis'/'$pt' meta projections) into geoNear result format:
+         * { dis: <scaled distance>, [loc: <point>,] obj: <doc> }.
+         * The scaled distance is also returned through 'distOut' for the stats.
+         */
+        BSONObj buildGeoNearResult(const BSONObj& projected,
+                                   double distanceMultiplier,
+                                   bool includeLocs,
+                                   double* distOut) {
+            double dist = projected["$dis"].number() * distanceMultiplier;
+            *distOut = dist;
+
+            BSONObjBuilder oneResultBuilder;
+            oneResultBuilder.append("dis", dist);
+            if (includeLocs) {
+                oneResultBuilder.appendAs(projected["$pt"], "loc");
+            }
+
+            // strip out '$dis' and '$pt' and the rest gets added as 'obj'.
+            BSONObjIterator resIt(projected);
+            BSONObjBuilder resBob;
+            while (resIt.more()) {
+                BSONElement elt = resIt.next();
+                if (!mongoutils::str::equals("$pt", elt.fieldName())
+                    && !mongoutils::str::equals("$dis", elt.fieldName())) {
+                    resBob.append(elt);
+                }
+            }
+            oneResultBuilder.append("obj", resBob.obj());
+            return oneResultBuilder.obj();
+        }
+
+        /**
+         * A Runner that reshapes the docs coming out of the geoNear query runner into
+         * geoNear result format as they stream by.  Lives inside a ClientCursor so
+         * getMore batches arrive already in result format.
+         */
+        class GeoNearCursorRunner : public Runner {
+        public:
+            // Takes ownership of 'runner'.
+            GeoNearCursorRunner(Runner* runner, bool includeLocs, double distanceMultiplier)
+                : _runner(runner),
+                  _includeLocs(includeLocs),
+                  _distanceMultiplier(distanceMultiplier) { }
+
+            virtual RunnerState getNext(BSONObj* objOut, DiskLoc* dlOut) {
+                if (!_stashed.isEmpty()) {
+                    if (NULL != objOut) {
+                        *objOut = _stashed;
+                    }
+                    _stashed = BSONObj();
+                    return RUNNER_ADVANCED;
+                }
+
+                BSONObj projected;
+                RunnerState state = _runner->getNext(&projected, dlOut);
+                if (RUNNER_ADVANCED != state) {
+                    return state;
+                }
+                if (NULL != objOut) {
+                    double dist;
+                    *objOut = buildGeoNearResult(projected, _distanceMultiplier,
+                                                 _includeLocs, &dist);
+                }
+                return RUNNER_ADVANCED;
+            }
+
+            // Hand back a result already pulled out of getNext; the next getNext
+            // returns it.  Used when a result doesn't fit into the current batch.
+            void pushBack(const BSONObj& obj) { _stashed = obj; }
+
+            virtual bool isEOF() { return _stashed.isEmpty() && _runner->isEOF(); }
+            virtual void saveState() { _runner->saveState(); }
+            virtual bool restoreState() { return _runner->restoreState(); }
+            virtual void invalidate(const DiskLoc& dl) { _runner->invalidate(dl); }
+            virtual void kill() { _runner->kill(); }
+            virtual void setYieldPolicy(YieldPolicy policy) { _runner->setYieldPolicy(policy); }
+            virtual const string& ns() { return _runner->ns(); }
+
+            virtual Status getExplainPlan(TypeExplain** explain) const {
+                return _runner->getExplainPlan(explain);
+            }
+
+        private:
+            auto_ptr<Runner> _runner;
+            bool _includeLocs;
+            double _distanceMultiplier;
+
+            // A result pulled out of the runner but not yet handed to the client.
+            BSONObj _stashed;
+        };
+
+    }  // namespace
+
     class Geo2dFindNearCmd : public Command {
     public:
         Geo2dFindNearCmd() : Command("geoNear") {}
@@ -57,7 +157,10 @@ namespace mongo {
         bool slaveOverrideOk() const { return true; }
 
         void help(stringstream& h) const {
-            h << "http://dochub.mongodb.org/core/geo#GeospatialIndexing-geoNearCommand";
+            h << "http://dochub.mongodb.org/core/geo#GeospatialIndexing-geoNearCommand\n"
+              << "with cursor: {batchSize: <n>} results are returned through a cursor\n"
+              << "(like aggregate) instead of one big reply; the stats subobj is omitted\n"
+              << "in that mode since it would require draining the search up front";
         }
 
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -164,6 +267,26 @@ namespace mongo {
                 uassert(17297, "distanceMultiplier must be non-negative", distanceMultiplier >= 0);
             }
 
+            // An optional cursor object requests streamed results, same shape as aggregate's.
+            bool useCursor = false;
+            long long batchSize = 101; // same as query
+            BSONElement cursorElem = cmdObj["cursor"];
+            if (!cursorElem.eoo()) {
+                uassert(17484, "cursor field must be an object", Object == cursorElem.type());
+                BSONObj cursorObj = cursorElem.embeddedObject();
+                BSONElement batchSizeElem = cursorObj["batchSize"];
+                if (batchSizeElem.eoo()) {
+                    uassert(17485, "cursor object can't contain fields other than batchSize",
+                            cursorObj.isEmpty());
+                }
+                else {
+                    uassert(17486, "cursor.batchSize must be a non-negative number",
+                            batchSizeElem.isNumber() && batchSizeElem.numberLong() >= 0);
+                    batchSize = batchSizeElem.numberLong();
+                }
+                useCursor = true;
+            }
+
             BSONObj projObj = BSON("$pt" << BSON("$meta" << LiteParsedQuery::metaGeoNearPoint) <<
                                    "$dis" << BSON("$meta" << LiteParsedQuery::metaGeoNearDistance));
 
@@ -181,6 +304,11 @@ namespace mongo {
 
             auto_ptr<Runner> runner(rawRunner);
 
+            if (useCursor) {
+                return runWithCursor(ns, runner, includeLocs, distanceMultiplier, batchSize,
+                                     result);
+            }
+
             double totalDistance = 0;
             BSONObjBuilder resultBuilder(result.subarrayStart("results"));
             double farthestDist = 0;
@@ -190,30 +318,13 @@ namespace mongo {
             while ((results < numWanted) && Runner::RUNNER_ADVANCED == runner->getNext(&currObj, NULL)) {
                 // cout << "result is " << currObj.toString() << endl;
 
-                double dist = currObj["$dis"].number() * distanceMultiplier;
-                // cout << std::setprecision(10) << "HK GEON mul'd dist is " << dist << " raw dist is " << currObj["$dis"].number() << endl;
+                double dist;
+                BSONObj resObj = buildGeoNearResult(currObj, distanceMultiplier, includeLocs,
+                                                    &dist);
                 totalDistance += dist;
                 if (dist > farthestDist) { farthestDist = dist; }
 
-                BSONObjBuilder oneResultBuilder(
-                    resultBuilder.subobjStart(BSONObjBuilder::numStr(results)));
-                oneResultBuilder.append("dis", dist);
-                if (includeLocs) {
-                    oneResultBuilder.appendAs(currObj["$pt"], "loc");
-                }
-
-                // strip out '$dis' and '$pt' and the rest gets added as 'obj'.
-                BSONObjIterator resIt(currObj);
-                BSONObjBuilder resBob;
-                while (resIt.more()) {
-                    BSONElement elt = resIt.next();
-                    if (!mongoutils::str::equals("$pt", elt.fieldName())
-                        && !mongoutils::str::equals("$dis", elt.fieldName())) {
-                        resBob.append(elt);
-                    }
-                }
-                oneResultBuilder.append("obj", resBob.obj());
-                oneResultBuilder.done();
+                resultBuilder.append(BSONObjBuilder::numStr(results), resObj);
                 ++results;
             }
 
@@ -240,6 +351,56 @@ namespace mongo {
         }
 
     private:
+        /**
+         * Cursor-mode reply: pull the first batch into cursor.firstBatch and, if the
+         * search isn't exhausted, park the runner in a ClientCursor so getMore streams
+         * the rest with bounded memory.  Takes ownership of 'runner'.
+         */
+        bool runWithCursor(const string& ns, auto_ptr<Runner>& runner, bool includeLocs,
+                           double distanceMultiplier, long long batchSize,
+                           BSONObjBuilder& result) {
+            auto_ptr<GeoNearCursorRunner> cursorRunner(
+                new GeoNearCursorRunner(runner.release(), includeLocs, distanceMultiplier));
+
+            // First batch, bounded by batchSize and the reply size ceiling.  A batchSize
+            // of 0 means return just the cursor, like aggregate.
+            BSONArrayBuilder firstBatch;
+            const int byteLimit = MaxBytesToReturnToClientAtOnce;
+            bool exhausted = false;
+            BSONObj next;
+            for (long long objCount = 0; objCount < batchSize; objCount++) {
+                if (Runner::RUNNER_ADVANCED != cursorRunner->getNext(&next, NULL)) {
+                    exhausted = true;
+                    break;
+                }
+                if (firstBatch.len() + next.objsize() > byteLimit) {
+                    // Too big; 'next' becomes the first doc of the next batch.
+                    cursorRunner->pushBack(next);
+                    break;
+                }
+                firstBatch.append(next);
+            }
+
+            CursorId id = 0;
+            if (!exhausted) {
+                // We won't use the runner until it's getMore'd, and getMore restores
+                // state unconditionally, so it must be saved here.
+                cursorRunner->saveState();
+
+                // The ClientCursor takes ownership of the runner.  The cursor id is what
+                // the client drives with getMore.
+                ClientCursor* clientCursor = new ClientCursor(cursorRunner.release());
+                id = clientCursor->cursorid();
+            }
+
+            BSONObjBuilder cursorObj(result.subobjStart("cursor"));
+            cursorObj.append("id", id);
+            cursorObj.append("ns", ns);
+            cursorObj.append("firstBatch", firstBatch.arr());
+            cursorObj.done();
+            return true;
+        }
+
         bool getFieldName(Collection* collection, IndexCatalog* indexCatalog, string* fieldOut,
                           string* errOut, bool *isFrom2D) {
             vector<IndexDescriptor*> idxs;
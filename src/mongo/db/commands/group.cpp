@@ -30,6 +30,7 @@
 
 #include "mongo/pch.h"
 
+#include <limits>
 #include <vector>
 
 #include "mongo/db/auth/authorization_session.h"
@@ -41,12 +42,156 @@
 #include "mongo/db/commands.h"
 #include "mongo/db/database.h"
 #include "mongo/db/instance.h"
+#include "mongo/db/pipeline/accumulator.h"
 #include "mongo/db/query/get_runner.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/scripting/engine.h"
 
 namespace mongo {
 
+    namespace {
+
+        /**
+         * A reduce function recognized as pure accumulation, so the group can
+         * run as a native hash-group with no JS at all.  Each recognized
+         * statement accumulates into one output field via an aggregation
+         * Accumulator (currently always $sum: counts are sums of 1).
+         */
+        struct NativeGroupSpec {
+            struct Acc {
+                string outField;  // prev.<outField>
+                string inField;   // dotted path under obj; empty for a count
+            };
+            vector<Acc> accs;
+        };
+
+        inline bool isIdentChar( char c ) {
+            return isalnum( static_cast<unsigned char>( c ) ) || c == '_' || c == '$';
+        }
+
+        string trimWs( const string& in ) {
+            size_t a = in.find_first_not_of( " \t\r\n" );
+            if ( a == string::npos )
+                return "";
+            size_t b = in.find_last_not_of( " \t\r\n" );
+            return in.substr( a, b - a + 1 );
+        }
+
+        /** matches "<name>.<path>" and extracts the dotted path, or returns false */
+        bool parseFieldOf( const string& expr, const string& name, string* path ) {
+            if ( expr.compare( 0, name.size(), name ) != 0 ||
+                 expr.size() <= name.size() ||
+                 expr[name.size()] != '.' )
+                return false;
+            const string p = expr.substr( name.size() + 1 );
+            if ( p.empty() )
+                return false;
+            for ( size_t i = 0; i < p.size(); i++ ) {
+                if ( !isIdentChar( p[i] ) && p[i] != '.' )
+                    return false;
+            }
+            *path = p;
+            return true;
+        }
+
+        /**
+         * Tries to recognize the reduce function as accumulation statements:
+         *     prev.f++;   prev.f += 1;   prev.f += obj.x;
+         *     prev.f = prev.f + 1;       prev.f = prev.f + obj.x;
+         * (where "obj"/"prev" are whatever the function's two parameters are
+         * called).  Returns false if anything else appears.
+         */
+        bool parseNativeReduce( const string& code, NativeGroupSpec* spec ) {
+            size_t pos = code.find( "function" );
+            if ( pos == string::npos )
+                return false;
+            size_t open = code.find( '(', pos );
+            size_t close = code.find( ')', open == string::npos ? open : open + 1 );
+            if ( open == string::npos || close == string::npos )
+                return false;
+
+            // the reduce signature is function( doc, aggregate )
+            const string paramStr = code.substr( open + 1, close - open - 1 );
+            size_t comma = paramStr.find( ',' );
+            if ( comma == string::npos )
+                return false;
+            const string obj = trimWs( paramStr.substr( 0, comma ) );
+            const string prev = trimWs( paramStr.substr( comma + 1 ) );
+            if ( obj.empty() || prev.empty() ||
+                 paramStr.find( ',', comma + 1 ) != string::npos )
+                return false;
+
+            size_t bodyOpen = code.find( '{', close );
+            size_t bodyClose = code.rfind( '}' );
+            if ( bodyOpen == string::npos || bodyClose == string::npos || bodyClose <= bodyOpen )
+                return false;
+            const string body = code.substr( bodyOpen + 1, bodyClose - bodyOpen - 1 );
+
+            size_t start = 0;
+            while ( start <= body.size() ) {
+                size_t semi = body.find( ';', start );
+                const string stmt = trimWs( body.substr( start,
+                                                         semi == string::npos ?
+                                                             string::npos : semi - start ) );
+                start = ( semi == string::npos ) ? body.size() + 1 : semi + 1;
+                if ( stmt.empty() )
+                    continue;
+
+                // everything must be "prev.<ident> <op> ..."
+                const string prevDot = prev + ".";
+                if ( stmt.compare( 0, prevDot.size(), prevDot ) != 0 )
+                    return false;
+                size_t f = prevDot.size();
+                size_t fEnd = f;
+                while ( fEnd < stmt.size() && isIdentChar( stmt[fEnd] ) )
+                    fEnd++;
+                if ( fEnd == f )
+                    return false;
+
+                NativeGroupSpec::Acc acc;
+                acc.outField = stmt.substr( f, fEnd - f );
+
+                string rest = trimWs( stmt.substr( fEnd ) );
+                if ( rest.empty() )
+                    return false;
+                string rhs;
+                if ( rest == "++" ) {
+                    // count
+                }
+                else if ( rest.compare( 0, 2, "+=" ) == 0 ) {
+                    rhs = trimWs( rest.substr( 2 ) );
+                }
+                else if ( rest[0] == '=' && ( rest.size() < 2 || rest[1] != '=' ) ) {
+                    // prev.f = prev.f + <rhs>
+                    string sum = trimWs( rest.substr( 1 ) );
+                    const string self = prev + "." + acc.outField;
+                    if ( sum.compare( 0, self.size(), self ) != 0 )
+                        return false;
+                    sum = trimWs( sum.substr( self.size() ) );
+                    if ( sum.empty() || sum[0] != '+' )
+                        return false;
+                    rhs = trimWs( sum.substr( 1 ) );
+                }
+                else {
+                    return false;
+                }
+
+                if ( !rhs.empty() && rhs != "1" && !parseFieldOf( rhs, obj, &acc.inField ) )
+                    return false;
+
+                // one accumulator per output field
+                for ( size_t i = 0; i < spec->accs.size(); i++ ) {
+                    if ( spec->accs[i].outField == acc.outField )
+                        return false;
+                }
+                spec->accs.push_back( acc );
+            }
+
+            return !spec->accs.empty();
+        }
+
+    } // namespace
+
     class GroupCommand : public Command {
     public:
         GroupCommand() : Command("group") {}
@@ -87,6 +232,129 @@ namespace mongo {
             return obj.extractFields( keyPattern , true ).getOwned();
         }
 
+        /**
+         * Native hash-group fast path: runs the recognized accumulations
+         * through AccumulatorSum with no JS scope at all.  Returns true if it
+         * handled the command (result is filled in), false if a document's
+         * data didn't fit the recognized pattern (e.g. a summed field holding
+         * a string, where JS would concatenate) -- the caller then falls back
+         * to the JS path, which builds its own runner.
+         *
+         * Semantics match the JS path: results come back as doubles (numbers
+         * round-trip through the JS engine as doubles there), groups appear in
+         * first-seen order, and summing a missing field yields NaN.
+         */
+        bool tryNativeGroup( const std::string& ns,
+                             const BSONObj& query,
+                             const BSONObj& keyPattern,
+                             const BSONObj& initial,
+                             const NativeGroupSpec& spec,
+                             BSONObjBuilder& result ) {
+
+            struct Group {
+                BSONObj key;
+                vector<intrusive_ptr<Accumulator> > accs;
+                vector<bool> sawMissing; // JS: undefined + n is NaN
+            };
+
+            map<BSONObj, size_t, BSONObjCmp> keyToGroup;
+            vector<boost::shared_ptr<Group> > groups; // first-seen order
+            long long count = 0;
+
+            Collection* collection = cc().database()->getCollection( ns );
+            if ( collection ) {
+                CanonicalQuery* cq;
+                uassert(17492, "Can't canonicalize query " + query.toString(),
+                        CanonicalQuery::canonicalize(ns, query, &cq).isOK());
+
+                Runner* rawRunner;
+                uassert(17493, "Can't get runner for query " + query.toString(),
+                        getRunner(cq, &rawRunner).isOK());
+
+                auto_ptr<Runner> runner(rawRunner);
+                const ScopedRunnerRegistration safety(runner.get());
+                runner->setYieldPolicy(Runner::YIELD_AUTO);
+
+                BSONObj obj;
+                Runner::RunnerState state;
+                while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&obj, NULL))) {
+                    BSONObj key = obj.extractFields( keyPattern , true ).getOwned();
+
+                    Group* group;
+                    map<BSONObj, size_t, BSONObjCmp>::iterator it = keyToGroup.find( key );
+                    if ( it != keyToGroup.end() ) {
+                        group = groups[it->second].get();
+                    }
+                    else {
+                        uassert(17494, "group() can't handle more than 20000 unique keys",
+                                groups.size() < 20000);
+                        boost::shared_ptr<Group> g( new Group() );
+                        g->key = key;
+                        for ( size_t i = 0; i < spec.accs.size(); i++ ) {
+                            intrusive_ptr<Accumulator> acc = AccumulatorSum::create();
+                            // seed with the initial value, like Object.extend(next, $initial)
+                            acc->process( Value( initial[spec.accs[i].outField] ), false );
+                            g->accs.push_back( acc );
+                            g->sawMissing.push_back( false );
+                        }
+                        keyToGroup[key] = groups.size();
+                        groups.push_back( g );
+                        group = g.get();
+                    }
+
+                    for ( size_t i = 0; i < spec.accs.size(); i++ ) {
+                        if ( spec.accs[i].inField.empty() ) {
+                            group->accs[i]->process( Value( 1 ), false ); // count
+                            continue;
+                        }
+                        BSONElement e = obj.getFieldDotted( spec.accs[i].inField );
+                        if ( e.eoo() ) {
+                            group->sawMissing[i] = true;
+                        }
+                        else if ( !e.isNumber() ) {
+                            // JS += would concatenate/stringify; not accumulation
+                            return false;
+                        }
+                        else {
+                            group->accs[i]->process( Value( e ), false );
+                        }
+                    }
+                    count++;
+                }
+            }
+
+            BSONArrayBuilder retval( result.subarrayStart( "retval" ) );
+            for ( size_t g = 0; g < groups.size(); g++ ) {
+                BSONObjBuilder b( retval.subobjStart() );
+                b.appendElements( groups[g]->key );
+                BSONObjIterator init( initial );
+                while ( init.more() ) {
+                    BSONElement ie = init.next();
+                    size_t i = 0;
+                    for ( ; i < spec.accs.size(); i++ ) {
+                        if ( spec.accs[i].outField == ie.fieldName() )
+                            break;
+                    }
+                    if ( i == spec.accs.size() ) {
+                        b.append( ie ); // untouched by the reduce; initial value survives
+                    }
+                    else if ( groups[g]->sawMissing[i] ) {
+                        b.append( ie.fieldName(), std::numeric_limits<double>::quiet_NaN() );
+                    }
+                    else {
+                        b.append( ie.fieldName(),
+                                  groups[g]->accs[i]->getValue( false ).coerceToDouble() );
+                    }
+                }
+                b.done();
+            }
+            retval.done();
+
+            result.append( "count" , (double)count );
+            result.append( "keys" , (int)(groups.size()) );
+            return true;
+        }
+
         bool group( const std::string& realdbname,
                     const std::string& ns,
                     const BSONObj& query,
@@ -203,11 +471,6 @@ namespace mongo {
 
         bool run(const string& dbname, BSONObj& jsobj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl ) {
 
-            if ( !globalScriptEngine ) {
-                errmsg = "server-side JavaScript execution is disabled";
-                return false;
-            }
-            
             /* db.$cmd.findOne( { group : <p> } ) */
             const BSONObj& p = jsobj.firstElement().embeddedObjectUserCheck();
 
@@ -254,6 +517,28 @@ namespace mongo {
             if (p["finalize"].type())
                 finalize = p["finalize"]._asCode();
 
+            // try the native hash-group fast path before touching JS at all
+            if ( keyf.empty() && finalize.empty() && reduce.type() != CodeWScope ) {
+                NativeGroupSpec spec;
+                bool native = parseNativeReduce( reduce._asCode(), &spec );
+                for ( size_t i = 0; native && i < spec.accs.size(); i++ ) {
+                    // each accumulated field must start from a numeric initial
+                    BSONElement ie = initial.embeddedObject()[spec.accs[i].outField];
+                    if ( ie.eoo() || !ie.isNumber() )
+                        native = false;
+                }
+                if ( native && tryNativeGroup( ns , q , key ,
+                                               initial.embeddedObject() , spec , result ) ) {
+                    return true;
+                }
+                // else: fall through to the JS path below
+            }
+
+            if ( !globalScriptEngine ) {
+                errmsg = "server-side JavaScript execution is disabled";
+                return false;
+            }
+
             return group( dbname , ns , q ,
                           key , keyf , reduce._asCode() , reduce.type() != CodeWScope ? 0 : reduce.codeWScopeScopeDataUnsafe() ,
                           initial.embeddedObject() , finalize ,
@@ -32,6 +32,8 @@
 
 #include "mongo/db/commands/mr.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/client/connpool.h"
 #include "mongo/client/parallel.h"
 #include "mongo/db/auth/authorization_session.h"
@@ -54,6 +56,7 @@
 #include "mongo/s/d_logic.h"
 #include "mongo/s/grid.h"
 #include "mongo/s/stale_exception.h"
+#include "mongo/util/queue.h"
 #include "mongo/util/scopeguard.h"
 
 namespace mongo {
@@ -71,7 +74,11 @@ namespace mongo {
         }
 
         void JSFunction::init( State * state ) {
-            _scope = state->scope();
+            init( state->scope() );
+        }
+
+        void JSFunction::init( Scope * scope ) {
+            _scope = scope;
             verify( _scope );
             _scope->init( &_wantedScope );
 
@@ -87,6 +94,11 @@ namespace mongo {
             _params = state->config().mapParams;
         }
 
+        void JSMapper::init( Scope * scope , const BSONObj& params ) {
+            _func.init( scope );
+            _params = params;
+        }
+
         /**
          * Applies the map function to an object, which should internally call emit()
          */
@@ -291,6 +303,17 @@ namespace mongo {
                     mapParams = cmdObj["mapparams"].embeddedObjectUserCheck();
                 }
 
+                mapCode = cmdObj["map"].wrap();
+                reduceCode = cmdObj["reduce"].wrap();
+            }
+
+            mapThreads = 1;
+            if ( cmdObj["mapThreads"].isNumber() ) {
+                mapThreads = cmdObj["mapThreads"].numberInt();
+                if ( mapThreads < 1 )
+                    mapThreads = 1;
+                else if ( mapThreads > 16 )
+                    mapThreads = 16;
             }
 
             {
@@ -1085,6 +1108,15 @@ namespace mongo {
             _add( _temp.get() , a , _size );
         }
 
+        void State::mergeWorkerMap( InMemory& im , long long numEmits ) {
+            for ( InMemory::iterator i = im.begin(); i != im.end(); ++i ) {
+                BSONList& all = i->second;
+                for ( BSONList::iterator j = all.begin(); j != all.end(); ++j )
+                    _add( _temp.get() , *j , _size );
+            }
+            _numEmits += numEmits;
+        }
+
         void State::_add( InMemory* im, const BSONObj& a , long& size ) {
             BSONList& all = (*im)[a];
             all.push_back( a );
@@ -1170,6 +1202,216 @@ namespace mongo {
             return BSONObj();
         }
 
+        BSONObj _workerEmit( const BSONObj& args, void* data );
+
+        /**
+         * One thread of a parallel map phase.  Owns a scope, compiled copies of the
+         * map and reduce functions and an in-memory map; documents are fed to it
+         * through a shared queue by the thread driving the collection scan, since
+         * the query runner and its yield machinery are single threaded.  Workers
+         * never touch the database: when their map grows too large they reduce it
+         * in memory, and any spill to disk happens on the main thread after the
+         * per-worker maps are merged.
+         */
+        class MapWorker : boost::noncopyable {
+        public:
+            MapWorker( const Config& config,
+                       const string& userToken,
+                       BlockingQueue<BSONObj>* queue ) :
+                _config( config ),
+                _userToken( userToken ),
+                _queue( queue ),
+                _mapper( config.mapCode.firstElement() ),
+                _reducer( config.reduceCode.firstElement() ),
+                _size( 0 ),
+                _numEmits( 0 ),
+                _mapTimeMicros( 0 ),
+                _failed( false ) {
+                _temp.reset( new InMemory() );
+            }
+
+            void start() {
+                _thread.reset( new boost::thread( boost::bind( &MapWorker::run, this ) ) );
+            }
+
+            void join() {
+                if ( _thread )
+                    _thread->join();
+            }
+
+            /** called by _workerEmit with a normalized (key, value) tuple */
+            void emit( const BSONObj& a ) {
+                BSONList& all = (*_temp)[a];
+                all.push_back( a );
+                _size += a.objsize() + 16;
+                _numEmits++;
+            }
+
+            // only valid after join()
+            InMemory& results() { return *_temp; }
+            long long numEmits() const { return _numEmits; }
+            long long numReduces() const { return _reducer.numReduces; }
+            long long mapTimeMicros() const { return _mapTimeMicros; }
+            bool failed() const { return _failed; }
+            const string& error() const { return _error; }
+
+        private:
+            void run() {
+                Client::initThread( "mrMapWorker" );
+                try {
+                    auto_ptr<Scope> scope( globalScriptEngine->getPooledScope(
+                                               _config.dbname, "mapreduce" + _userToken ) );
+                    if ( ! _config.scopeSetup.isEmpty() )
+                        scope->init( &_config.scopeSetup );
+                    _mapper.init( scope.get(), _config.mapParams );
+                    _reducer.init( scope.get() );
+                    scope->injectNative( "emit", _workerEmit, this );
+
+                    Timer mt;
+                    while ( true ) {
+                        BSONObj o = _queue->blockingPop();
+                        if ( o.isEmpty() )
+                            break; // shutdown sentinel
+
+                        mt.reset();
+                        _mapper.map( o );
+                        _mapTimeMicros += mt.micros();
+
+                        if ( _size > _config.maxInMemSize )
+                            reduceInMemory();
+                    }
+                }
+                catch ( std::exception& e ) {
+                    _error = e.what();
+                    _failed = true;
+                }
+                catch ( ... ) {
+                    _error = "unknown error in map worker";
+                    _failed = true;
+                }
+
+                if ( _failed ) {
+                    // keep draining to our sentinel so the producer never blocks
+                    // pushing to a dead consumer
+                    try {
+                        while ( ! _queue->blockingPop().isEmpty() ) {}
+                    }
+                    catch ( ... ) {}
+                }
+
+                cc().shutdown();
+            }
+
+            /** same contract as State::reduceInMemory, minus the on-disk spill */
+            void reduceInMemory() {
+                auto_ptr<InMemory> n( new InMemory() );
+                long nSize = 0;
+
+                for ( InMemory::iterator i = _temp->begin(); i != _temp->end(); ++i ) {
+                    BSONList& all = i->second;
+                    if ( all.size() == 1 ) {
+                        _addTo( n.get(), all[0], nSize );
+                    }
+                    else if ( all.size() > 1 ) {
+                        BSONObj res = _reducer.reduce( all );
+                        _addTo( n.get(), res, nSize );
+                    }
+                }
+
+                _temp.reset( n.release() );
+                _size = nSize;
+            }
+
+            static void _addTo( InMemory* im, const BSONObj& a, long& size ) {
+                (*im)[a].push_back( a );
+                size += a.objsize() + 16;
+            }
+
+            const Config& _config;
+            const string _userToken;
+            BlockingQueue<BSONObj>* _queue;
+
+            JSMapper _mapper;
+            JSReducer _reducer;
+
+            scoped_ptr<InMemory> _temp;
+            long _size; // bytes in _temp
+            long long _numEmits;
+            long long _mapTimeMicros;
+
+            bool _failed;
+            string _error;
+
+            scoped_ptr<boost::thread> _thread;
+        };
+
+        /**
+         * emit that will be called by js functions running in a map worker;
+         * same key normalization as fast_emit
+         */
+        BSONObj _workerEmit( const BSONObj& args, void* data ) {
+            uassert( 17478 , "emit takes 2 args" , args.nFields() == 2 );
+            uassert( 17479 , "an emit can't be more than half max bson size" ,
+                     args.objsize() < ( BSONObjMaxUserSize / 2 ) );
+
+            MapWorker* worker = (MapWorker*) data;
+            if ( args.firstElement().type() == Undefined ) {
+                BSONObjBuilder b( args.objsize() );
+                b.appendNull( "" );
+                BSONObjIterator i( args );
+                i.next();
+                b.append( i.next() );
+                worker->emit( b.obj() );
+            }
+            else {
+                worker->emit( args );
+            }
+            return BSONObj();
+        }
+
+        /**
+         * Feeds every map worker a shutdown sentinel and joins them, on scope exit
+         * if the scan unwinds, so worker threads never outlive the queue they read.
+         */
+        class MapWorkerReaper : boost::noncopyable {
+        public:
+            MapWorkerReaper( BlockingQueue<BSONObj>* queue,
+                             vector<boost::shared_ptr<MapWorker> >* workers ) :
+                _queue( queue ), _workers( workers ), _done( false ) {
+            }
+
+            ~MapWorkerReaper() {
+                try {
+                    shutdownAndJoin();
+                }
+                catch ( ... ) {}
+            }
+
+            void shutdownAndJoin() {
+                if ( _done )
+                    return;
+                _done = true;
+                for ( size_t i = 0; i < _workers->size(); i++ )
+                    _queue->push( BSONObj() );
+                for ( size_t i = 0; i < _workers->size(); i++ )
+                    (*_workers)[i]->join();
+            }
+
+        private:
+            BlockingQueue<BSONObj>* _queue;
+            vector<boost::shared_ptr<MapWorker> >* _workers;
+            bool _done;
+        };
+
+        static size_t _mapInputDocSize( const BSONObj& o ) {
+            return o.objsize();
+        }
+
+        // bound on documents buffered between the collection scan and the map
+        // workers; keeps the scan from racing arbitrarily far ahead of the mappers.
+        // must exceed the max document size or a single max-size doc wedges the queue
+        static const size_t kMaxQueuedMapInputBytes = 32 * 1024 * 1024;
+
         /**
          * This class represents a map/reduce command executed on a single server
          */
@@ -1270,6 +1512,27 @@ namespace mongo {
 
                     wassert( config.limit < 0x4000000 ); // see case on next line to 32 bit unsigned
                     long long mapTime = 0;
+
+                    // In js mode everything lives in one scope's JS map, so the map
+                    // phase can only be spread across threads in mixed mode.
+                    const bool parallelMap = config.mapThreads > 1 && !config.jsMode;
+                    scoped_ptr<BlockingQueue<BSONObj> > docQueue;
+                    vector<boost::shared_ptr<MapWorker> > mapWorkers;
+                    if ( parallelMap ) {
+                        const string userToken =
+                            ClientBasic::getCurrent()->getAuthorizationSession()
+                                                     ->getAuthenticatedUserNamesToken();
+                        docQueue.reset( new BlockingQueue<BSONObj>( kMaxQueuedMapInputBytes,
+                                                                    _mapInputDocSize ) );
+                        for ( int i = 0; i < config.mapThreads; i++ ) {
+                            boost::shared_ptr<MapWorker> worker(
+                                new MapWorker( config, userToken, docQueue.get() ) );
+                            worker->start();
+                            mapWorkers.push_back( worker );
+                        }
+                    }
+                    MapWorkerReaper workerReaper( docQueue.get(), &mapWorkers );
+
                     {
                         // We've got a cursor preventing migrations off, now re-establish our useful cursor
 
@@ -1310,13 +1573,28 @@ namespace mongo {
                             }
 
                             // do map
-                            if ( config.verbose ) mt.reset();
-                            config.mapper->map( o );
-                            if ( config.verbose ) mapTime += mt.micros();
+                            if ( parallelMap ) {
+                                // hand the document to a map worker; map time is
+                                // accounted per worker
+                                docQueue->push( o.getOwned() );
+                            }
+                            else {
+                                if ( config.verbose ) mt.reset();
+                                config.mapper->map( o );
+                                if ( config.verbose ) mapTime += mt.micros();
+                            }
 
                             num++;
                             if ( num % 100 == 0 ) {
                                 killCurrentOp.checkForInterrupt();
+                                if ( parallelMap ) {
+                                    for ( size_t i = 0; i < mapWorkers.size(); i++ ) {
+                                        uassert( 17480 ,
+                                                 str::stream() << "map worker failed: "
+                                                               << mapWorkers[i]->error() ,
+                                                 ! mapWorkers[i]->failed() );
+                                    }
+                                }
                             }
                             pm.hit();
 
@@ -1324,6 +1602,19 @@ namespace mongo {
                                 break;
                         }
                     }
+
+                    if ( parallelMap ) {
+                        workerReaper.shutdownAndJoin();
+                        for ( size_t i = 0; i < mapWorkers.size(); i++ ) {
+                            MapWorker& worker = *mapWorkers[i];
+                            uassert( 17481 ,
+                                     str::stream() << "map worker failed: " << worker.error() ,
+                                     ! worker.failed() );
+                            state.mergeWorkerMap( worker.results(), worker.numEmits() );
+                            config.reducer->numReduces += worker.numReduces();
+                            mapTime += worker.mapTimeMicros();
+                        }
+                    }
                     pm.finished();
 
                     killCurrentOp.checkForInterrupt();
@@ -98,6 +98,9 @@ namespace mongo {
 
             virtual void init( State * state );
 
+            /** variant for parallel map workers, which own a scope but no State */
+            void init( Scope * scope );
+
             Scope * scope() const { return _scope; }
             ScriptingFunction func() const { return _func; }
 
@@ -116,6 +119,9 @@ namespace mongo {
             virtual void map( const BSONObj& o );
             virtual void init( State * state );
 
+            /** variant for parallel map workers, which own a scope but no State */
+            void init( Scope * scope , const BSONObj& params );
+
         private:
             JSFunction _func;
             BSONObj _params;
@@ -126,6 +132,9 @@ namespace mongo {
             JSReducer( const BSONElement& code ) : _func( "_reduce" , code ) {}
             virtual void init( State * state );
 
+            /** variant for parallel map workers, which own a scope but no State */
+            void init( Scope * scope ) { _func.init( scope ); }
+
             virtual BSONObj reduce( const BSONList& tuples );
             virtual BSONObj finalReduce( const BSONList& tuples , Finalizer * finalizer );
 
@@ -194,6 +203,15 @@ namespace mongo {
             BSONObj mapParams;
             BSONObj scopeSetup;
 
+            // the raw map/reduce code elements, retained (wrapped) so parallel map
+            // workers can compile their own copies in their own scopes
+            BSONObj mapCode;
+            BSONObj reduceCode;
+
+            // number of threads to run the map functions across; 1 (the default)
+            // runs them in line with the collection scan, as before
+            int mapThreads;
+
             // output tables
             string incLong;
             string tempNamespace;
@@ -251,6 +269,12 @@ namespace mongo {
              */
             void emit( const BSONObj& a );
 
+            /**
+             * folds the in-memory map built by a parallel map worker into this
+             * state's map; numEmits is the worker's emit count
+             */
+            void mergeWorkerMap( InMemory& im , long long numEmits );
+
             /**
              * if size is big, run a reduce
              * if its still big, dump to temp collection
@@ -0,0 +1,195 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include <string>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/client.h"
+#include "mongo/db/clientcursor.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/database.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/runner.h"
+#include "mongo/db/structure/collection.h"
+#include "mongo/db/structure/collection_iterator.h"
+
+namespace mongo {
+
+    namespace {
+
+        /**
+         * A Runner over one of the extent groups handed out by Collection::getManyIterators.
+         * Returns raw documents in extent order; any filtering or ordering is the caller's
+         * problem.  Lives inside a ClientCursor so getMore can drive it.
+         */
+        class MultiIteratorRunner : public Runner {
+        public:
+            MultiIteratorRunner( const string& ns,
+                                 Collection* collection,
+                                 CollectionIterator* iterator )
+                : _ns( ns ),
+                  _collection( collection ),
+                  _iterator( iterator ) {
+            }
+
+            virtual RunnerState getNext( BSONObj* objOut, DiskLoc* dlOut ) {
+                if ( NULL == _collection )
+                    return RUNNER_DEAD;
+                if ( _iterator->isEOF() )
+                    return RUNNER_EOF;
+
+                DiskLoc loc = _iterator->getNext();
+                if ( NULL != objOut )
+                    *objOut = _collection->docFor( loc );
+                if ( NULL != dlOut )
+                    *dlOut = loc;
+                return RUNNER_ADVANCED;
+            }
+
+            virtual bool isEOF() {
+                return NULL == _collection || _iterator->isEOF();
+            }
+
+            virtual void saveState() {
+                _iterator->prepareToYield();
+            }
+
+            virtual bool restoreState() {
+                if ( NULL == _collection )
+                    return false;
+                return _iterator->recoverFromYield();
+            }
+
+            virtual void invalidate( const DiskLoc& dl ) {
+                if ( NULL != _collection )
+                    _iterator->invalidate( dl );
+            }
+
+            virtual void kill() {
+                _collection = NULL;
+            }
+
+            virtual void setYieldPolicy( YieldPolicy policy ) { }
+
+            virtual const string& ns() { return _ns; }
+
+            virtual Status getExplainPlan( TypeExplain** explain ) const {
+                return Status( ErrorCodes::InternalError,
+                               "MultiIteratorRunner doesn't implement getExplainPlan" );
+            }
+
+        private:
+            string _ns;
+
+            // Not owned by us.  Set to NULL if the underlying collection goes away.
+            Collection* _collection;
+
+            scoped_ptr<CollectionIterator> _iterator;
+        };
+
+    }  // namespace
+
+    /**
+     * { parallelCollectionScan: <collection>, numCursors: <n> }
+     *
+     * Partitions the collection's extent chain into up to 'numCursors' disjoint pieces and
+     * returns a cursor over each, so callers (backup, aggregation fan-out) can drive them
+     * from separate connections and use all cores and disk queue depth.  Each document in
+     * the collection is returned by exactly one of the cursors.
+     */
+    class ParallelCollectionScanCmd : public Command {
+    public:
+        ParallelCollectionScanCmd() : Command( "parallelCollectionScan" ) { }
+
+        virtual LockType locktype() const { return READ; }
+        virtual bool slaveOk() const { return true; }
+
+        virtual void help( stringstream& help ) const {
+            help << "{ parallelCollectionScan: <collection>, numCursors: <n> }\n"
+                 << "returns up to numCursors cursors that partition the collection";
+        }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::find);
+            out->push_back(Privilege(parseResourcePattern(dbname, cmdObj), actions));
+        }
+
+        virtual bool run(const string& dbname, BSONObj& cmdObj, int options, string& errmsg,
+                         BSONObjBuilder& result, bool fromRepl) {
+
+            string ns = parseNs( dbname, cmdObj );
+
+            Collection* collection = cc().database()->getCollection( ns );
+            uassert( 17462, "ns does not exist: " + ns, NULL != collection );
+            uassert( 17463,
+                     "parallelCollectionScan not supported on capped collections",
+                     !collection->isCapped() );
+
+            size_t numCursors = static_cast<size_t>( cmdObj["numCursors"].numberInt() );
+            uassert( 17464,
+                     "numCursors has to be between 1 and 10000",
+                     numCursors >= 1 && numCursors <= 10000 );
+
+            std::vector<CollectionIterator*> iterators;
+            // Ownership of the iterators passes to the runners below.
+            collection->getManyIterators( numCursors, &iterators );
+
+            BSONArrayBuilder cursorsBuilder( result.subarrayStart( "cursors" ) );
+            for ( size_t i = 0; i < iterators.size(); i++ ) {
+                MultiIteratorRunner* runner =
+                    new MultiIteratorRunner( ns, collection, iterators[i] );
+
+                // The ClientCursor takes ownership of the runner.  The cursor id is what the
+                // client drives with getMore.
+                ClientCursor* clientCursor = new ClientCursor( runner );
+
+                BSONObjBuilder threadResult;
+                {
+                    BSONObjBuilder cursor( threadResult.subobjStart( "cursor" ) );
+                    cursor.append( "firstBatch", BSONArray() );
+                    cursor.append( "ns", ns );
+                    cursor.append( "id", clientCursor->cursorid() );
+                    cursor.done();
+                }
+                threadResult.append( "ok", 1 );
+
+                cursorsBuilder.append( threadResult.obj() );
+            }
+            cursorsBuilder.done();
+
+            return true;
+        }
+    } parallelCollectionScanCmd;
+
+}  // namespace mongo
@@ -35,6 +35,8 @@
 #include <string>
 #include <vector>
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/auth/action_set.h"
 #include "mongo/db/auth/action_type.h"
@@ -48,6 +50,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/db/structure/collection.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/timer.h"
 #include "mongo/util/touch_pages.h"
 
@@ -58,6 +61,28 @@ namespace mongo {
         size_t length;
     };
 
+    namespace {
+
+        // bound on warm-up parallelism; more than this and the random read streams
+        // start fighting each other on spinning disks
+        const unsigned maxTouchThreads = 8;
+
+        // pulls whole extents off the shared cursor until none remain or the
+        // command thread flags a stop (interrupt)
+        void touchWorker( const std::vector<touch_location>* ranges,
+                          AtomicUInt32* next,
+                          AtomicUInt32* done,
+                          AtomicUInt32* stop ) {
+            while ( !stop->load() ) {
+                const unsigned i = next->fetchAndAdd( 1 );
+                if ( i >= ranges->size() )
+                    break;
+                touch_pages( (*ranges)[i].root, (*ranges)[i].length );
+                done->fetchAndAdd( 1 );
+            }
+        }
+    }
+
     /** @return numRanges touched */
     int touchNs( const std::string& ns ) {
         std::vector< touch_location > ranges;
@@ -87,10 +112,40 @@ namespace mongo {
         ProgressMeterHolder pm(cc().curop()->setMessage(progress_msg.c_str(),
                                                         "Touch Progress",
                                                         ranges.size()));
-        for ( std::vector< touch_location >::iterator it = ranges.begin(); it != ranges.end(); ++it ) {
-            touch_pages( it->root, it->length );
-            pm.hit();
-            killCurrentOp.checkForInterrupt(false);
+
+        // fan the extents out over a bounded set of touch threads; the command
+        // thread keeps holding LockMongoFilesShared (so the mappings stay put),
+        // feeds the progress meter, and watches for interrupt
+        AtomicUInt32 next( 0 );
+        AtomicUInt32 done( 0 );
+        AtomicUInt32 stop( 0 );
+        const unsigned nThreads = std::min( static_cast<size_t>( maxTouchThreads ),
+                                            ranges.size() );
+        {
+            boost::thread_group workers;
+            for ( unsigned i = 0; i < nThreads; i++ ) {
+                workers.create_thread( boost::bind( &touchWorker,
+                                                    &ranges, &next, &done, &stop ) );
+            }
+
+            unsigned reported = 0;
+            try {
+                while ( reported < ranges.size() ) {
+                    sleepmillis( 20 );
+                    const unsigned d = done.load();
+                    while ( reported < d ) {
+                        pm.hit();
+                        reported++;
+                    }
+                    killCurrentOp.checkForInterrupt(false);
+                }
+            }
+            catch ( ... ) {
+                stop.store( 1 );
+                workers.join_all();
+                throw;
+            }
+            workers.join_all();
         }
         pm.finished();
 
@@ -28,6 +28,11 @@
  *    it in the license file.
  */
 
+#include <boost/bind.hpp>
+#include <boost/shared_ptr.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/db/client.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/kill_current_op.h"
 #include "mongo/db/namespace_details.h"
@@ -35,10 +40,108 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/runner.h"
 #include "mongo/db/storage/extent.h"
+#include "mongo/db/storage/extent_manager.h"
 #include "mongo/db/structure/collection.h"
+#include "mongo/db/structure/collection_iterator.h"
+#include "mongo/platform/random.h"
 
 namespace mongo {
 
+    namespace {
+
+        /** totals from scanning one group of extents' records; merged across workers */
+        struct RecordScanResult {
+            RecordScanResult()
+                : n( 0 ), nInvalid( 0 ),
+                  nQuantizedSize( 0 ), nPowerOf2QuantizedSize( 0 ),
+                  len( 0 ), nlen( 0 ), bsonLen( 0 ),
+                  ok( true ) {
+            }
+
+            int n;
+            int nInvalid;
+            long long nQuantizedSize;
+            long long nPowerOf2QuantizedSize;
+            long long len;
+            long long nlen;
+            long long bsonLen;
+            set<DiskLoc> recs;
+            bool ok;
+            string error;
+        };
+
+        /**
+         * Scans the records of one group of extents, filling out.  Must not throw: runs on
+         * worker threads, so problems are reported through out->ok / out->error.
+         */
+        void scanExtentGroup( Collection* collection,
+                              const ExtentManager* em,
+                              const std::vector<DiskLoc>& extents,
+                              const string& ns,
+                              bool full,
+                              RecordScanResult* out ) {
+            try {
+                ExtentGroupIterator iterator( collection, extents );
+                while ( !iterator.isEOF() ) {
+                    DiskLoc cl = iterator.getNext();
+                    out->n++;
+
+                    if ( out->recs.size() < 1000000 )
+                        out->recs.insert( cl );
+
+                    Record* r = em->recordFor( cl );
+                    out->len += r->lengthWithHeaders();
+                    out->nlen += r->netLength();
+
+                    if ( r->lengthWithHeaders() ==
+                            NamespaceDetails::quantizeAllocationSpace
+                                ( r->lengthWithHeaders() ) ) {
+                        ++out->nQuantizedSize;
+                    }
+
+                    if ( r->lengthWithHeaders() ==
+                            NamespaceDetails::quantizePowerOf2AllocationSpace
+                                ( r->lengthWithHeaders() - 1 ) ) {
+                        ++out->nPowerOf2QuantizedSize;
+                    }
+
+                    if ( full ) {
+                        BSONObj obj = BSONObj::make( r );
+                        const Status status = validateBSON( obj.objdata(), obj.objsize() );
+                        if ( !status.isOK() ) {
+                            out->nInvalid++;
+                            log() << "Invalid bson detected in " << ns
+                                  << ": " << status.reason();
+                        }
+                        else {
+                            out->bsonLen += obj.objsize();
+                        }
+                    }
+                }
+            }
+            catch ( const DBException& e ) {
+                out->ok = false;
+                out->error = e.what();
+            }
+            catch ( const std::exception& e ) {
+                out->ok = false;
+                out->error = e.what();
+            }
+        }
+
+        void scanExtentGroupThread( Collection* collection,
+                                    const ExtentManager* em,
+                                    const std::vector<DiskLoc>* extents,
+                                    const string& ns,
+                                    bool full,
+                                    RecordScanResult* out ) {
+            Client::initThread( "validateWorker" );
+            scanExtentGroup( collection, em, *extents, ns, full, out );
+            cc().shutdown();
+        }
+
+    }  // namespace
+
     class ValidateCmd : public Command {
     public:
         ValidateCmd() : Command( "validate" ) {}
@@ -48,7 +151,9 @@ namespace mongo {
         }
 
         virtual void help(stringstream& h) const { h << "Validate contents of a namespace by scanning its data structures for correctness.  Slow.\n"
-                                                        "Add full:true option to do a more thorough check"; }
+                                                        "Add full:true option to do a more thorough check\n"
+                                                        "Add parallel:<n> to scan extents with n worker threads (non-capped only)\n"
+                                                        "Add sample:<pct> to scan only about pct% of extents, for routine spot checks"; }
 
         virtual LockType locktype() const { return READ; }
         virtual void addRequiredPrivileges(const std::string& dbname,
@@ -93,6 +198,23 @@ namespace mongo {
             const bool full = cmdObj["full"].trueValue();
             const bool scanData = full || cmdObj["scandata"].trueValue();
 
+            int numWorkers = 1;
+            if ( !cmdObj["parallel"].eoo() ) {
+                numWorkers = cmdObj["parallel"].numberInt();
+                uassert( 17496, "parallel has to be a number between 1 and 32",
+                         numWorkers >= 1 && numWorkers <= 32 );
+            }
+
+            int samplePercent = 0; // 0 means scan everything
+            if ( !cmdObj["sample"].eoo() ) {
+                samplePercent = cmdObj["sample"].numberInt();
+                uassert( 17497, "sample has to be a percentage between 1 and 99",
+                         samplePercent >= 1 && samplePercent <= 99 );
+            }
+
+            uassert( 17498, "parallel and sample are not supported on capped collections",
+                     ( numWorkers == 1 && samplePercent == 0 ) || !collection->isCapped() );
+
             NamespaceDetails* nsd = collection->details();
 
             bool valid = true;
@@ -217,94 +339,174 @@ namespace mongo {
 
                 set<DiskLoc> recs;
                 if( scanData ) {
-                    int n = 0;
-                    int nInvalid = 0;
-                    long long nQuantizedSize = 0;
-                    long long nPowerOf2QuantizedSize = 0;
-                    long long len = 0;
-                    long long nlen = 0;
-                    long long bsonLen = 0;
-                    int outOfOrder = 0;
-                    DiskLoc cl_last;
-
-                    DiskLoc cl;
-                    Runner::RunnerState state;
-                    auto_ptr<Runner> runner(InternalPlanner::collectionScan(ns));
-                    while (Runner::RUNNER_ADVANCED == (state = runner->getNext(NULL, &cl))) {
-                        n++;
-
-                        if ( n < 1000000 )
-                            recs.insert(cl);
-                        if ( nsd->isCapped() ) {
-                            if ( cl < cl_last )
-                                outOfOrder++;
-                            cl_last = cl;
+                    RecordScanResult scan;
+
+                    if ( numWorkers > 1 || samplePercent > 0 ) {
+                        // Deal the extent chain (or a random sample of it) into groups and
+                        // scan the groups with worker threads.  Our database-level READ
+                        // lock keeps writers out while they run.
+                        std::vector<DiskLoc> extents;
+                        const ExtentManager* em = &cc().database()->getExtentManager();
+                        for ( DiskLoc extLoc = nsd->firstExtent();
+                              !extLoc.isNull();
+                              extLoc = em->getExtent( extLoc )->xnext ) {
+                            extents.push_back( extLoc );
                         }
 
-                        Record *r = cl.rec();
-                        len += r->lengthWithHeaders();
-                        nlen += r->netLength();
-                        
-                        if ( r->lengthWithHeaders() ==
-                                NamespaceDetails::quantizeAllocationSpace
-                                    ( r->lengthWithHeaders() ) ) {
-                            // Count the number of records having a size consistent with
-                            // the quantizeAllocationSpace quantization implementation.
-                            ++nQuantizedSize;
-                        }
+                        const int totalExtents = extents.size();
+                        if ( samplePercent > 0 && !extents.empty() ) {
+                            PseudoRandom prng( static_cast<int64_t>( curTimeMicros64() ) );
+                            std::vector<DiskLoc> sampled;
+                            for ( size_t i = 0; i < extents.size(); i++ ) {
+                                if ( prng.nextInt32( 100 ) < samplePercent )
+                                    sampled.push_back( extents[i] );
+                            }
+                            // a sample that looks at nothing is useless
+                            if ( sampled.empty() )
+                                sampled.push_back( extents[prng.nextInt32( extents.size() )] );
+                            extents.swap( sampled );
 
-                        if ( r->lengthWithHeaders() ==
-                                NamespaceDetails::quantizePowerOf2AllocationSpace
-                                    ( r->lengthWithHeaders() - 1 ) ) {
-                            // Count the number of records having a size consistent with the
-                            // quantizePowerOf2AllocationSpace quantization implementation.
-                            // Because of SERVER-8311, power of 2 quantization is not idempotent and
-                            // r->lengthWithHeaders() - 1 must be checked instead of the record
-                            // length itself.
-                            ++nPowerOf2QuantizedSize;
+                            result.append( "sampledExtents", static_cast<int>( extents.size() ) );
+                            result.append( "totalExtents", totalExtents );
                         }
 
-                        if (full){
-                            BSONObj obj = BSONObj::make(r);
-                            const Status status = validateBSON(obj.objdata(), obj.objsize());
-                            if (!status.isOK()) {
+                        if ( numWorkers > static_cast<int>( extents.size() ) &&
+                             !extents.empty() )
+                            numWorkers = extents.size();
+                        if ( numWorkers < 1 )
+                            numWorkers = 1;
+
+                        std::vector< std::vector<DiskLoc> > groups( numWorkers );
+                        for ( size_t i = 0; i < extents.size(); i++ )
+                            groups[i % numWorkers].push_back( extents[i] );
+
+                        std::vector<RecordScanResult> partials( numWorkers );
+                        std::vector< boost::shared_ptr<boost::thread> > workers;
+                        for ( int i = 1; i < numWorkers; i++ ) {
+                            workers.push_back( boost::shared_ptr<boost::thread>(
+                                new boost::thread( boost::bind( scanExtentGroupThread,
+                                                                collection,
+                                                                em,
+                                                                &groups[i],
+                                                                ns,
+                                                                full,
+                                                                &partials[i] ) ) ) );
+                        }
+                        // this thread takes a share too
+                        scanExtentGroup( collection, em, groups[0], ns, full, &partials[0] );
+                        for ( size_t i = 0; i < workers.size(); i++ )
+                            workers[i]->join();
+
+                        for ( int i = 0; i < numWorkers; i++ ) {
+                            const RecordScanResult& p = partials[i];
+                            if ( !p.ok ) {
+                                errors << ( "exception scanning records: " + p.error );
                                 valid = false;
-                                if (nInvalid == 0) // only log once;
-                                    errors << "invalid bson object detected (see logs for more info)";
-
-                                nInvalid++;
-                                log() << "Invalid bson detected in " << ns
-                                      << ": " << status.reason();
                             }
-                            else {
-                                bsonLen += obj.objsize();
+                            scan.n += p.n;
+                            scan.nInvalid += p.nInvalid;
+                            scan.nQuantizedSize += p.nQuantizedSize;
+                            scan.nPowerOf2QuantizedSize += p.nPowerOf2QuantizedSize;
+                            scan.len += p.len;
+                            scan.nlen += p.nlen;
+                            scan.bsonLen += p.bsonLen;
+                            for ( set<DiskLoc>::const_iterator j = p.recs.begin();
+                                  j != p.recs.end() && scan.recs.size() < 1000000;
+                                  ++j ) {
+                                scan.recs.insert( *j );
                             }
                         }
+
+                        if ( numWorkers > 1 )
+                            result.append( "parallelWorkers", numWorkers );
                     }
-                    if (Runner::RUNNER_EOF != state) {
-                        // TODO: more descriptive logging.
-                        warning() << "Internal error while reading collection " << ns << endl;
-                    }
-                    if ( nsd->isCapped() && !nsd->capLooped() ) {
-                        result.append("cappedOutOfOrder", outOfOrder);
-                        if ( outOfOrder > 1 ) {
-                            valid = false;
-                            errors << "too many out of order records";
+                    else {
+                        int outOfOrder = 0;
+                        DiskLoc cl_last;
+
+                        DiskLoc cl;
+                        Runner::RunnerState state;
+                        auto_ptr<Runner> runner(InternalPlanner::collectionScan(ns));
+                        while (Runner::RUNNER_ADVANCED == (state = runner->getNext(NULL, &cl))) {
+                            scan.n++;
+
+                            if ( scan.n < 1000000 )
+                                scan.recs.insert(cl);
+                            if ( nsd->isCapped() ) {
+                                if ( cl < cl_last )
+                                    outOfOrder++;
+                                cl_last = cl;
+                            }
+
+                            Record *r = cl.rec();
+                            scan.len += r->lengthWithHeaders();
+                            scan.nlen += r->netLength();
+
+                            if ( r->lengthWithHeaders() ==
+                                    NamespaceDetails::quantizeAllocationSpace
+                                        ( r->lengthWithHeaders() ) ) {
+                                // Count the number of records having a size consistent with
+                                // the quantizeAllocationSpace quantization implementation.
+                                ++scan.nQuantizedSize;
+                            }
+
+                            if ( r->lengthWithHeaders() ==
+                                    NamespaceDetails::quantizePowerOf2AllocationSpace
+                                        ( r->lengthWithHeaders() - 1 ) ) {
+                                // Count the number of records having a size consistent with the
+                                // quantizePowerOf2AllocationSpace quantization implementation.
+                                // Because of SERVER-8311, power of 2 quantization is not idempotent and
+                                // r->lengthWithHeaders() - 1 must be checked instead of the record
+                                // length itself.
+                                ++scan.nPowerOf2QuantizedSize;
+                            }
+
+                            if (full){
+                                BSONObj obj = BSONObj::make(r);
+                                const Status status = validateBSON(obj.objdata(), obj.objsize());
+                                if (!status.isOK()) {
+                                    scan.nInvalid++;
+                                    log() << "Invalid bson detected in " << ns
+                                          << ": " << status.reason();
+                                }
+                                else {
+                                    scan.bsonLen += obj.objsize();
+                                }
+                            }
                         }
+                        if (Runner::RUNNER_EOF != state) {
+                            // TODO: more descriptive logging.
+                            warning() << "Internal error while reading collection " << ns << endl;
+                        }
+                        if ( nsd->isCapped() && !nsd->capLooped() ) {
+                            result.append("cappedOutOfOrder", outOfOrder);
+                            if ( outOfOrder > 1 ) {
+                                valid = false;
+                                errors << "too many out of order records";
+                            }
+                        }
+                    }
+
+                    recs.swap( scan.recs );
+
+                    if ( scan.nInvalid > 0 ) {
+                        valid = false;
+                        errors << "invalid bson object detected (see logs for more info)";
                     }
-                    result.append("objectsFound", n);
+
+                    result.append("objectsFound", scan.n);
 
                     if (full) {
-                        result.append("invalidObjects", nInvalid);
+                        result.append("invalidObjects", scan.nInvalid);
                     }
 
-                    result.appendNumber("nQuantizedSize", nQuantizedSize);
-                    result.appendNumber("nPowerOf2QuantizedSize", nPowerOf2QuantizedSize);
-                    result.appendNumber("bytesWithHeaders", len);
-                    result.appendNumber("bytesWithoutHeaders", nlen);
+                    result.appendNumber("nQuantizedSize", scan.nQuantizedSize);
+                    result.appendNumber("nPowerOf2QuantizedSize", scan.nPowerOf2QuantizedSize);
+                    result.appendNumber("bytesWithHeaders", scan.len);
+                    result.appendNumber("bytesWithoutHeaders", scan.nlen);
 
                     if (full) {
-                        result.appendNumber("bytesBson", bsonLen);
+                        result.appendNumber("bytesBson", scan.bsonLen);
                     }
                 }
 
@@ -405,6 +405,15 @@ namespace mongo {
         // TODO: Move error reporting out of write op internals?
     }
 
+    void WriteBatchExecutor::incInsertStatsForGroup( int numDocs, CurOp* currentOp ) {
+        // We increment batch inserts like individual inserts
+        for ( int i = 0; i < numDocs; i++ )
+            _opCounters->gotInsert();
+        _stats->numInserted += numDocs;
+        _le->nObjects = numDocs;
+        currentOp->debug().ninserted += numDocs;
+    }
+
     static void finishCurrentOp( Client* client, CurOp* currentOp, WriteErrorDetail* opError ) {
 
         currentOp->done();
@@ -489,6 +498,11 @@ namespace mongo {
                               Collection* collection,
                               WriteOpResult* result );
 
+    static bool groupInsert( const string& insertNS,
+                             const std::vector<BSONObj>& docs,
+                             Collection* collection,
+                             WriteOpResult* result );
+
     static void singleCreateIndex( const BatchItemRef& insertItem,
                                    const BSONObj& normalInsert,
                                    Collection* collection,
@@ -620,9 +634,14 @@ namespace mongo {
 
         WriteErrorDetail* lastOpError = NULL;
 
+        // Cap on how many documents one bulk group may cover; a full group also breaks out
+        // of the write lock afterwards so long batches have periodic yield points.
+        const int maxGroupedInserts = 500;
+
         while ( currInsertItem->getItemIndex() < static_cast<int>( request.sizeWriteOps() ) ) {
 
             WriteOpResult currResult;
+            bool yieldRequested = false;
 
             {
                 PageFaultRetryableSection pFaultSection;
@@ -672,10 +691,65 @@ namespace mongo {
                     // Perform writes inside write lock
                     //
 
+                    // Runs of consecutive valid documents go through the bulk path in
+                    // groups; disabled for the rest of this lock section if a group fails
+                    // so the failing group is retried per document below
+                    bool tryGroups = !request.isInsertIndexRequest() &&
+                                     collection && !collection->isCapped();
+
                     while ( collection
                             && currInsertItem->getItemIndex()
                                < static_cast<int>( request.sizeWriteOps() ) ) {
 
+                        if ( tryGroups ) {
+                            const int startIndex = currInsertItem->getItemIndex();
+                            vector<BSONObj> groupDocs;
+                            while ( startIndex + static_cast<int>( groupDocs.size() )
+                                        < static_cast<int>( request.sizeWriteOps() ) &&
+                                    static_cast<int>( groupDocs.size() ) < maxGroupedInserts ) {
+                                const int idx = startIndex + groupDocs.size();
+                                const StatusWith<BSONObj>& normalInsert = normalInserts[idx];
+                                if ( !normalInsert.isOK() )
+                                    break;
+                                groupDocs.push_back(
+                                    normalInsert.getValue().isEmpty() ?
+                                        BatchItemRef( &request, idx ).getDocument() :
+                                        normalInsert.getValue() );
+                            }
+
+                            if ( groupDocs.size() >= 2 ) {
+                                WriteOpResult groupResult;
+                                if ( groupInsert( request.getNS(), groupDocs, collection,
+                                                  &groupResult ) ) {
+                                    incInsertStatsForGroup( groupDocs.size(),
+                                                            currentOp.get() );
+                                    currInsertItem.reset(
+                                        new BatchItemRef( &request,
+                                                          startIndex + groupDocs.size() ) );
+
+                                    if ( static_cast<int>( groupDocs.size() )
+                                             == maxGroupedInserts &&
+                                         currInsertItem->getItemIndex()
+                                             < static_cast<int>( request.sizeWriteOps() ) ) {
+                                        // give the lock up between full groups
+                                        yieldRequested = true;
+                                        break;
+                                    }
+                                    continue;
+                                }
+
+                                if ( groupResult.fault ) {
+                                    // retry the whole group after touching out of lock;
+                                    // groupInsert already undid its partial work
+                                    currResult.fault = groupResult.fault;
+                                    groupResult.fault = NULL;
+                                    break;
+                                }
+
+                                tryGroups = false;
+                            }
+                        }
+
                         // Get the actual document we want to write, assuming it's valid
                         const StatusWith<BSONObj>& normalInsert = //
                             normalInserts[currInsertItem->getItemIndex()];
@@ -752,8 +826,9 @@ namespace mongo {
                 // Check page fault out of lock
                 currResult.fault->touch();
             }
-            else {
-                // Increment if not a fault
+            else if ( !yieldRequested ) {
+                // Increment if not a fault and we aren't just reopening the lock to
+                // continue where a full bulk group left off
                 currInsertItem.reset( new BatchItemRef( &request,
                                                         currInsertItem->getItemIndex() + 1 ) );
             }
@@ -921,6 +996,47 @@ namespace mongo {
 
     }
 
+    /**
+     * Insert a group of documents through Collection::insertDocumentsBulk.  All-or-nothing
+     * from the caller's point of view: if the bulk path fails partway, the documents it did
+     * insert are removed again and the caller retries the group through singleInsert so the
+     * error is attributed to the right batch index.  Returns true on success; on false the
+     * result may carry a fault but never an error.
+     */
+    static bool groupInsert( const string& insertNS,
+                             const std::vector<BSONObj>& docs,
+                             Collection* collection,
+                             WriteOpResult* result ) {
+
+        Lock::assertWriteLocked( insertNS );
+
+        vector<DiskLoc> locs;
+        try {
+            Status status = collection->insertDocumentsBulk( docs, true, &locs );
+            if ( status.isOK() ) {
+                for ( size_t i = 0; i < docs.size(); i++ )
+                    logOp( "i", insertNS.c_str(), docs[i] );
+                getDur().commitIfNeeded();
+                result->stats.n = docs.size();
+                return true;
+            }
+        }
+        catch ( const PageFaultException& ex ) {
+            for ( size_t i = 0; i < locs.size(); i++ )
+                collection->deleteDocument( locs[i], false, true );
+            // TODO: An actual data structure that's not an exception for this
+            result->fault = new PageFaultException( ex );
+            return false;
+        }
+        catch ( const DBException& ) {
+            // fall through to the rollback below; the per-document retry reports it
+        }
+
+        for ( size_t i = 0; i < locs.size(); i++ )
+            collection->deleteDocument( locs[i], false, true );
+        return false;
+    }
+
     /**
      * Perform a single index insert into a collection.  Requires the index descriptor be
      * preprocessed and the collection already has been created.
@@ -125,6 +125,14 @@ namespace mongo {
                             const WriteErrorDetail* error,
                             CurOp* currentOp );
 
+        /**
+         * Helper for incrementing stats once for a whole group of inserts written through
+         * the bulk path, instead of per document.
+         *
+         * No lock requirements.
+         */
+        void incInsertStatsForGroup( int numDocs, CurOp* currentOp );
+
         // Default write concern, if one isn't provide in the batches.
         const BSONObj _defaultWriteConcern;
 
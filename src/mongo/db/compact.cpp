@@ -35,6 +35,8 @@
 #include <string>
 #include <vector>
 
+#include "mongo/db/background.h"
+#include "mongo/db/clientcursor.h"
 #include "mongo/db/d_concurrency.h"
 #include "mongo/db/curop-inl.h"
 #include "mongo/db/index_builder.h"
@@ -265,10 +267,44 @@ namespace mongo {
         // as we're about to tally them up again for each new extent
         d->setStats( 0, 0 );
 
+        const string ns = collection->ns().ns();
+
+        // in incremental mode we let normal traffic in between extents; register as a
+        // background operation so concurrent index builds and drops of this namespace
+        // uassert instead of racing us (we have no indexes until the rebuild below)
+        scoped_ptr<BackgroundOperation> incrementalGuard;
+        if ( compactOptions->incremental )
+            incrementalGuard.reset( new BackgroundOperation( ns ) );
+
         for( list<DiskLoc>::iterator i = extents.begin(); i != extents.end(); i++ ) {
             skipped += compactExtent(collection, *i, n++, compactOptions );
             pm.hit();
+
+            list<DiskLoc>::iterator next = i;
+            next++;
+            if ( compactOptions->incremental && next != extents.end() ) {
+                // release the DB write lock so queued operations can interleave,
+                // then pick the collection back up before the next extent
+                getDur().commitIfNeeded();
+                Client::Context* ctx = cc().getContext();
+                ctx->unlocked();
+                {
+                    Lock::TempRelease t;
+                }
+                ctx->relocked();
+                uassert( 17454, "database dropped during incremental compact",
+                         cc().database() );
+                collection = cc().database()->getCollection( ns );
+                uassert( 17455, "collection dropped during incremental compact",
+                         collection );
+                d = collection->details();
+                // cursors opened while we were unlocked may hold DiskLocs into the
+                // extent we free next; they see no indexes anyway, so just kill them
+                ClientCursor::invalidate( ns );
+                killCurrentOp.checkForInterrupt(false);
+            }
         }
+        incrementalGuard.reset();
 
         if( skipped ) {
             result.append("invalidObjects", skipped);
@@ -206,7 +206,9 @@ namespace mongo {
         if ( _client ) {
             const LockState& ls = _client->lockState();
             verify( ls.threadState() );
-            Top::global.record( _ns , _op , ls.hasAnyWriteLock() ? 1 : -1 , micros , _command );
+            if ( _nsInterned.ns() != _ns )
+                _nsInterned = InternedNamespace::intern( _ns );
+            Top::global.record( _nsInterned , _op , ls.hasAnyWriteLock() ? 1 : -1 , micros , _command );
         }
     }
 
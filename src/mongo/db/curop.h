@@ -36,6 +36,7 @@
 #include "mongo/bson/util/atomic_int.h"
 #include "mongo/db/client.h"
 #include "mongo/db/catalog/ondisk/namespace.h"
+#include "mongo/db/interned_namespace.h"
 #include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/progress_meter.h"
@@ -193,6 +194,7 @@ namespace mongo {
         void reset();
         void reset( const HostAndPort& remote, int op );
         void markCommand() { _command = true; }
+        bool isCommand() const { return _command; }
         OpDebug& debug()           { return _debug; }
         int profileLevel() const   { return _dbprofile; }
         const char * getNS() const { return _ns; }
@@ -332,6 +334,9 @@ namespace mongo {
         int _dbprofile;                  // 0=off, 1=slow, 2=all
         AtomicUInt _opNum;               // todo: simple being "unsigned" may make more sense here
         char _ns[Namespace::MaxNsLen+2];
+        // last interned _ns; lets recordGlobalTime() skip the intern table
+        // when consecutive ops hit the same collection
+        mutable InternedNamespace _nsInterned;
         HostAndPort _remote;             // CAREFUL here with thread safety
         CachedBSONObj _query;            // CachedBSONObj is thread safe
         OpDebug _debug;
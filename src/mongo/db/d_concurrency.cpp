@@ -39,6 +39,7 @@
 #include "mongo/db/dur.h"
 #include "mongo/db/lockstat.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/server.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/concurrency/mapsf.h"
@@ -281,7 +282,36 @@ namespace mongo {
         lockState()._batchWriter = true;
     }
 
-    Lock::ParallelBatchWriterSupport::ParallelBatchWriterSupport() {
+    // dbs written by the in-flight apply batch (see setBatchWrites).
+    // 0 = no batch, 1 = batchWriteDbs lists the dbs, 2 = batch may write anywhere
+    static SimpleMutex batchWriteDbsMutex("batchWriteDbs");
+    static set<string> batchWriteDbs;
+    static AtomicUInt32 batchWriteState;
+
+    void Lock::ParallelBatchWriterMode::setBatchWrites( const set<string>& dbs, bool touchesAll ) {
+        SimpleMutex::scoped_lock lk(batchWriteDbsMutex);
+        batchWriteDbs = dbs;
+        batchWriteState.store( touchesAll ? 2 : 1 );
+    }
+
+    void Lock::ParallelBatchWriterMode::clearBatchWrites() {
+        SimpleMutex::scoped_lock lk(batchWriteDbsMutex);
+        batchWriteDbs.clear();
+        batchWriteState.store( 0 );
+    }
+
+    bool Lock::ParallelBatchWriterMode::batchTouchesDb( const StringData& db ) {
+        unsigned state = batchWriteState.load();
+        if ( state == 0 )
+            return false;
+        if ( state == 2 )
+            return true;
+        SimpleMutex::scoped_lock lk(batchWriteDbsMutex);
+        return batchWriteDbs.count( db.toString() ) > 0;
+    }
+
+    Lock::ParallelBatchWriterSupport::ParallelBatchWriterSupport( char type, const StringData& ns )
+        : _type( type ), _ns( ns.toString() ) {
         relock();
     }
 
@@ -291,15 +321,34 @@ namespace mongo {
 
     void Lock::ParallelBatchWriterSupport::relock() {
         LockState& ls = lockState();
-        if ( ! ls._batchWriter ) {
-            AcquiringParallelWriter a(ls);
-            _lk.reset( new RWLockRecursive::Shared(ParallelBatchWriterMode::_batchLock) );
+        if ( ls._batchWriter )
+            return;
+        if ( _type == 'r' && !_ns.empty() &&
+             !ParallelBatchWriterMode::batchTouchesDb( nsToDatabaseSubstring( _ns ) ) ) {
+            // a reader of a db the in-flight batch does not write sees exactly the
+            // pre-batch view of that db, so it need not wait out the batch.  if it
+            // yields, this check reruns on relock and it waits if a batch has since
+            // taken up its db.  when publication races with the check, the per-db
+            // lock still keeps batch writers out while the reader holds it.
+            return;
         }
+        AcquiringParallelWriter a(ls);
+        _lk.reset( new RWLockRecursive::Shared(ParallelBatchWriterMode::_batchLock) );
+    }
+
+    bool Lock::ParallelBatchWriterSupport::skippedBatchForDb() const {
+        return _lk == NULL && _type == 'r' && !_ns.empty() && !lockState()._batchWriter;
+    }
+
+    void Lock::ParallelBatchWriterSupport::waitOutBatch() {
+        LockState& ls = lockState();
+        AcquiringParallelWriter a(ls);
+        _lk.reset( new RWLockRecursive::Shared(ParallelBatchWriterMode::_batchLock) );
     }
 
 
-    Lock::ScopedLock::ScopedLock( char type ) 
-        : _type(type), _stat(0) {
+    Lock::ScopedLock::ScopedLock( char type, const StringData& ns )
+        : _pbws_lk(type, ns), _type(type), _stat(0) {
         LockState& ls = lockState();
         ls.enterScopedLock( this );
     }
@@ -345,6 +394,14 @@ namespace mongo {
         resetTime();
     }
 
+    bool Lock::ScopedLock::pbwsRecheckNeeded( const StringData& db ) const {
+        return _pbws_lk.skippedBatchForDb() && ParallelBatchWriterMode::batchTouchesDb( db );
+    }
+
+    void Lock::ScopedLock::pbwsWaitOutBatch() {
+        _pbws_lk.waitOutBatch();
+    }
+
 
 
     Lock::TempRelease::TempRelease() : cant( Lock::nested() )
@@ -413,8 +470,8 @@ namespace mongo {
     void Lock::DBRead::_tempRelease() {
         unlockDB();
     }
-    void Lock::DBRead::_relock() { 
-        lockDB(_what);
+    void Lock::DBRead::_relock() {
+        lockDBRechecked();
     }
 
     Lock::GlobalWrite::GlobalWrite(bool sg, int timeoutms)
@@ -624,13 +681,31 @@ namespace mongo {
     }
 
     Lock::DBWrite::DBWrite( const StringData& ns )
-        : ScopedLock( 'w' ), _what(ns.toString()), _nested(false) {
+        : ScopedLock( 'w', ns ), _what(ns.toString()), _nested(false) {
         lockDB( _what );
     }
 
     Lock::DBRead::DBRead( const StringData& ns )
-        : ScopedLock( 'r' ), _what(ns.toString()), _nested(false) {
+        : ScopedLock( 'r', ns ), _what(ns.toString()), _nested(false) {
+        lockDBRechecked();
+    }
+
+    void Lock::DBRead::lockDBRechecked() {
         lockDB( _what );
+        // An apply batch may have been published between the batch check in
+        // ParallelBatchWriterSupport and the db lock grant just above, in which
+        // case we'd read half-applied intra-batch state.  Re-check now that the
+        // lock is held and back out to wait the batch out if our db was taken up.
+        // Backing out is only deadlock free at the top of the lock stack; a
+        // nested read of an already-held db stays consistent because the batch
+        // writer can't get that db lock while our outer lock holds it.
+        LockState& ls = lockState();
+        while ( ls.recursiveCount() == 1 && !ls.isRW() &&
+                pbwsRecheckNeeded( nsToDatabaseSubstring( _what ) ) ) {
+            unlockDB();
+            pbwsWaitOutBatch();
+            lockDB( _what );
+        }
     }
 
     Lock::DBWrite::~DBWrite() {
@@ -640,6 +715,23 @@ namespace mongo {
         unlockDB();
     }
 
+    Lock::CollectionWrite::CollectionWrite( const StringData& ns )
+        : DBWrite( ns ) {
+        lockState().lockedCollection( ns );
+    }
+    Lock::CollectionWrite::~CollectionWrite() {
+        // runs before ~DBWrite, i.e. while the db lock is still held
+        lockState().unlockedCollection();
+    }
+
+    Lock::CollectionRead::CollectionRead( const StringData& ns )
+        : DBRead( ns ) {
+        lockState().lockedCollection( ns );
+    }
+    Lock::CollectionRead::~CollectionRead() {
+        lockState().unlockedCollection();
+    }
+
     void Lock::DBWrite::unlockDB() {
         if( _weLocked ) {
             recordTime();  // for lock stats
@@ -86,17 +86,35 @@ namespace mongo {
             ParallelBatchWriterMode() : _lk(_batchLock) {}
             static void iAmABatchParticipant();
             static RWLockRecursive &_batchLock;
+
+            /** Publish the set of dbs the in-flight apply batch writes, before taking the
+                batch lock.  Readers of other dbs are then allowed past the batch lock: the
+                batch touches none of their data, so the view they see is exactly the
+                pre-batch view (the per-db lock keeps batch writers out while they read).
+                Readers of listed dbs, global readers and all writers wait as before.
+                touchesAll blocks every reader; used for batches containing commands, whose
+                writes can't be attributed to one db from the op's ns. */
+            static void setBatchWrites( const std::set<std::string>& dbs, bool touchesAll = false );
+            static void clearBatchWrites();
+            static bool batchTouchesDb( const StringData& db );
         };
 
     private:
         class ParallelBatchWriterSupport : boost::noncopyable {
         public:
-            ParallelBatchWriterSupport();
+            ParallelBatchWriterSupport( char type, const StringData& ns );
 
         private:
             void tempRelease();
             void relock();
 
+            /** true if relock() let a reader proceed without the batch lock */
+            bool skippedBatchForDb() const;
+            /** blocks until the in-flight batch finishes, then holds the batch lock shared */
+            void waitOutBatch();
+
+            const char _type;       // 'r','w','R','W' -- the owning ScopedLock's type
+            const std::string _ns;  // empty for global locks
             scoped_ptr<RWLockRecursive::Shared> _lk;
             friend class ScopedLock;
         };
@@ -115,7 +133,7 @@ namespace mongo {
             void resetTime();
 
         protected:
-            explicit ScopedLock( char type ); 
+            explicit ScopedLock( char type, const StringData& ns = StringData() );
 
         private:
             friend struct TempRelease;
@@ -126,6 +144,11 @@ namespace mongo {
             virtual void _tempRelease() = 0;
             virtual void _relock() = 0;
 
+            /** true if the batch lock was skipped for this reader but an apply batch has
+                since taken up 'db'; see DBRead::lockDBRechecked() */
+            bool pbwsRecheckNeeded( const StringData& db ) const;
+            void pbwsWaitOutBatch();
+
         private:
             ParallelBatchWriterSupport _pbws_lk;
 
@@ -211,6 +234,7 @@ namespace mongo {
             void lockNestable(Nestable db);
             void lockOther(const StringData& db);
             void lockDB(const string& ns);
+            void lockDBRechecked();
             void unlockDB();
 
         protected:
@@ -226,7 +250,28 @@ namespace mongo {
             WrapperForRWLock *_weLocked;
             string _what;
             bool _nested;
-            
+
+        };
+
+        /**
+         * Locks the database containing ns for writing and records the specific
+         * collection in LockState.  The lock actually held is still the database
+         * lock -- the lock manager has no collection granularity yet -- but write
+         * paths that are semantically per-collection should take this instead of
+         * DBWrite so they pick up finer granularity as the lock manager learns it,
+         * without another call-site migration.
+         */
+        class CollectionWrite : public DBWrite {
+        public:
+            explicit CollectionWrite(const StringData& ns);
+            virtual ~CollectionWrite();
+        };
+
+        /** read-side companion to CollectionWrite */
+        class CollectionRead : public DBRead {
+        public:
+            explicit CollectionRead(const StringData& ns);
+            virtual ~CollectionRead();
         };
 
     };
@@ -78,6 +78,7 @@ namespace mongo {
             verify( m[dbname] == 0 );
             m[dbname] = db;
             _size++;
+            _republish();
         }
 
         return db;
@@ -30,8 +30,11 @@
 
 #pragma once
 
+#include <boost/shared_ptr.hpp>
+
 #include "mongo/db/database.h"
 #include "mongo/db/namespace_string.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo { 
 
@@ -41,12 +44,16 @@ namespace mongo {
     class DatabaseHolder {
         typedef map<string,Database*> DBs;
         typedef map<string,DBs> Paths;
-        // todo: we want something faster than this if called a lot:
+        typedef unordered_map<string,Database*> DbIndex;
         mutable SimpleMutex _m;
         Paths _paths;
+        // immutable flat snapshot of _paths, republished by _republish() on the rare
+        // open/close events.  the per-operation get() reads it with an atomic load and
+        // never takes _m.
+        boost::shared_ptr<const DbIndex> _snapshot;
         int _size;
     public:
-        DatabaseHolder() : _m("dbholder"),_size(0) { }
+        DatabaseHolder() : _m("dbholder"), _snapshot(new DbIndex()), _size(0) { }
 
         bool __isLoaded( const string& ns , const string& path ) const {
             SimpleMutex::scoped_lock lk(_m);
@@ -68,17 +75,12 @@ namespace mongo {
         }
 
         Database * get( const string& ns , const string& path ) const {
-            SimpleMutex::scoped_lock lk(_m);
             Lock::assertAtLeastReadLocked(ns);
-            Paths::const_iterator x = _paths.find( path );
-            if ( x == _paths.end() )
-                return 0;
-            const DBs& m = x->second;
-            string db = _todb( ns );
-            DBs::const_iterator it = m.find(db);
-            if ( it != m.end() )
-                return it->second;
-            return 0;
+            // hot path -- called for every operation's context setup; reads the
+            // current snapshot without ever taking _m
+            boost::shared_ptr<const DbIndex> snap = boost::atomic_load( &_snapshot );
+            DbIndex::const_iterator it = snap->find( _indexKey( path, _todb( ns ) ) );
+            return it == snap->end() ? NULL : it->second;
         }
 
         Database* getOrCreate( const string& ns , const string& path , bool& justCreated );
@@ -87,7 +89,9 @@ namespace mongo {
             SimpleMutex::scoped_lock lk(_m);
             verify( Lock::isW() );
             DBs& m = _paths[path];
-            _size -= (int)m.erase( _todb( ns ) );
+            string db = _todb( ns );
+            _size -= (int)m.erase( db );
+            _republish();
         }
 
         /** @param force - force close even if something underway - use at shutdown */
@@ -111,6 +115,23 @@ namespace mongo {
         }
 
     private:
+        /** rebuild the flat snapshot from _paths and atomically publish it.
+            caller must hold _m. */
+        void _republish() {
+            boost::shared_ptr<DbIndex> next( new DbIndex() );
+            for ( Paths::const_iterator i=_paths.begin(); i!=_paths.end(); i++ ) {
+                const DBs& m = i->second;
+                for( DBs::const_iterator j=m.begin(); j!=m.end(); j++ ) {
+                    (*next)[ _indexKey( i->first, j->first ) ] = j->second;
+                }
+            }
+            boost::atomic_store( &_snapshot, boost::shared_ptr<const DbIndex>( next ) );
+        }
+
+        static string _indexKey( const string& path , const string& db ) {
+            return path + '\0' + db; // '\0' can appear in neither part
+        }
+
         static string _todb( const string& ns ) {
             string d = __todb( ns );
             uassert( 13280 , (string)"invalid db name: " + ns , NamespaceString::validDBName( d ) );
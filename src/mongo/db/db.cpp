@@ -37,6 +37,7 @@
 #include "mongo/base/init.h"
 #include "mongo/base/initializer.h"
 #include "mongo/base/status.h"
+#include "mongo/db/admission_control.h"
 #include "mongo/db/auth/authz_manager_external_state_d.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_manager_global.h"
@@ -65,10 +66,13 @@
 #include "mongo/db/repl/replication_server_status.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/restapi.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/startup_warnings.h"
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/stats/snapshots.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/db/storage/extent_preallocator.h"
+#include "mongo/db/storage/residency.h"
 #include "mongo/db/ttl.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/d_writeback.h"
@@ -83,6 +87,7 @@
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/ntservice.h"
 #include "mongo/util/options_parser/startup_options.h"
+#include "mongo/util/processinfo.h"
 #include "mongo/util/ramlog.h"
 #include "mongo/util/scopeguard.h"
 #include "mongo/util/signal_win32.h"
@@ -241,6 +246,20 @@ namespace mongo {
             if( c ) c->shutdown();
         }
 
+        // Event-mode support: park the connection's Client between requests so any
+        // worker thread can service the next one.
+        virtual void* releaseThreadLocalState() {
+            return Client::releaseCurrent();
+        }
+
+        virtual void attachThreadLocalState( void* state ) {
+            if ( state )
+                Client::setCurrent( static_cast<Client*>( state ) );
+        }
+
+        virtual void destroyThreadLocalState( void* state ) {
+            delete static_cast<Client*>( state );
+        }
     };
 
     void logStartup() {
@@ -475,6 +494,15 @@ namespace mongo {
         return 0;
     }
 
+    // explicit cpu list ("0,2,4-7") for the data file flusher thread; empty
+    // leaves it unpinned
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(flushThreadCpuAffinity, std::string, "");
+
+    // linux best-effort io priority level for background flushes, 0..7;
+    // -1 (the default) leaves the kernel default, so foreground io is
+    // unaffected unless explicitly requested
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(flushThreadIoPriority, int, -1);
+
     /**
      * does background async flushes of mmapped files
      */
@@ -491,6 +519,21 @@ namespace mongo {
 
         string name() const { return "DataFileSync"; }
 
+        virtual ThreadAttributes threadAttributes() const {
+            ThreadAttributes attrs;
+            if (!flushThreadCpuAffinity.empty()) {
+                std::vector<int> cpus;
+                Status s = ThreadAttributes::parseCpuList(flushThreadCpuAffinity, &cpus);
+                if (s.isOK())
+                    attrs.cpuAffinity(cpus);
+                else
+                    warning() << "flushThreadCpuAffinity: " << s.reason() << endl;
+            }
+            if (flushThreadIoPriority >= 0 && flushThreadIoPriority <= 7)
+                attrs.ioClass(ThreadAttributes::IOClassBestEffort, flushThreadIoPriority);
+            return attrs;
+        }
+
         void run() {
             Client::initThread( name().c_str() );
             if (storageGlobalParams.syncdelay == 0) {
@@ -734,6 +777,10 @@ namespace mongo {
         else {
             startTTLBackgroundJob();
         }
+        startExtentPreallocationJob();
+        startAdmissionControl();
+        if (ProcessInfo::blockCheckSupported())
+            residencyTracker.startSampler();
 
 #ifndef _WIN32
         mongo::signalForkSuccess();
@@ -745,7 +792,7 @@ namespace mongo {
             Client::WriteContext c("admin", storageGlobalParams.dbpath);
         }
 
-        getDeleter()->startWorkers();
+        getDeleter()->startWorkers(rangeDeleterWorkers);
 
         // Starts a background thread that rebuilds all incomplete indices. 
         indexRebuilder.go(); 
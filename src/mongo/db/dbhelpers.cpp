@@ -50,7 +50,9 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/query_planner.h"
 #include "mongo/db/repl/oplog.h"
+#include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/write_concern.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/s/d_logic.h"
@@ -300,6 +302,15 @@ namespace mongo {
         return findShardKeyIndexPattern_inlock( ns, shardKeyPattern, indexPattern );
     }
 
+    // Number of documents deleted per lock acquisition in removeRange. Batching amortizes
+    // the write lock and per-pass replication wait over many documents instead of one.
+    MONGO_EXPORT_SERVER_PARAMETER( rangeDeleterBatchSize, int, 100 );
+
+    // When secondaryThrottle is on, removeRange additionally backs off between batches
+    // while the furthest-behind up secondary is lagging more than this many seconds.
+    // 0 disables the lag check.
+    MONGO_EXPORT_SERVER_PARAMETER( rangeDeleterMaxSecondaryLagSecs, int, 30 );
+
     long long Helpers::removeRange( const KeyRange& range,
                                     bool maxInclusive,
                                     bool secondaryThrottle,
@@ -344,8 +355,14 @@ namespace mongo {
         
         long long millisWaitingForReplication = 0;
 
-        while ( 1 ) {
-            // Scoping for write lock.
+        const int maxDocsPerBatch = rangeDeleterBatchSize > 0 ? rangeDeleterBatchSize : 1;
+
+        bool done = false;
+        while ( !done ) {
+            int numDeletedInBatch = 0;
+
+            // Scoping for write lock. Up to maxDocsPerBatch documents are deleted per
+            // acquisition so the lock and replication waits are amortized over the batch.
             {
                 Client::WriteContext ctx(ns);
                 Collection* collection = ctx.ctx().db()->getCollection( ns );
@@ -354,69 +371,103 @@ namespace mongo {
                 IndexDescriptor* desc =
                     collection->getIndexCatalog()->findIndexByKeyPattern( indexKeyPattern.toBSON() );
 
+                // Collected during the scan, deleted in one batch afterwards so each
+                // index removes the batch's keys in key order (Collection::deleteDocuments).
+                vector<DiskLoc> batchLocs;
+
                 auto_ptr<Runner> runner(InternalPlanner::indexScan(collection, desc, min, max,
                                                                    maxInclusive,
                                                                    InternalPlanner::FORWARD,
                                                                    InternalPlanner::IXSCAN_FETCH));
 
-                runner->setYieldPolicy(Runner::YIELD_AUTO);
-
-                DiskLoc rloc;
-                BSONObj obj;
-                Runner::RunnerState state;
-                // This may yield so we cannot touch nsd after this.
-                state = runner->getNext(&obj, &rloc);
-                runner.reset();
-                if (Runner::RUNNER_EOF == state) { break; }
-
-                if ( onlyRemoveOrphanedDocs ) {
-                    // Do a final check in the write lock to make absolutely sure that our
-                    // collection hasn't been modified in a way that invalidates our migration
-                    // cleanup.
-
-                    // We should never be able to turn off the sharding state once enabled, but
-                    // in the future we might want to.
-                    verify(shardingState.enabled());
-
-                    // In write lock, so will be the most up-to-date version
-                    CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
-
-                    bool docIsOrphan;
-                    if ( metadataNow ) {
-                        KeyPattern kp( metadataNow->getKeyPattern() );
-                        BSONObj key = kp.extractSingleKey( obj );
-                        docIsOrphan = !metadataNow->keyBelongsToMe( key )
-                            && !metadataNow->keyIsPending( key );
-                    }
-                    else {
-                        docIsOrphan = false;
+                // The runner must not yield within the batch - the lock is released (and
+                // the runner discarded) between batches instead, so the collection stays
+                // valid while we delete under it.
+                runner->setYieldPolicy(Runner::YIELD_MANUAL);
+
+                while ( numDeletedInBatch < maxDocsPerBatch ) {
+                    DiskLoc rloc;
+                    BSONObj obj;
+                    Runner::RunnerState state = runner->getNext(&obj, &rloc);
+                    if (Runner::RUNNER_ADVANCED != state) { done = true; break; }
+
+                    if ( onlyRemoveOrphanedDocs ) {
+                        // Do a final check in the write lock to make absolutely sure that our
+                        // collection hasn't been modified in a way that invalidates our migration
+                        // cleanup.
+
+                        // We should never be able to turn off the sharding state once enabled, but
+                        // in the future we might want to.
+                        verify(shardingState.enabled());
+
+                        // In write lock, so will be the most up-to-date version
+                        CollectionMetadataPtr metadataNow = shardingState.getCollectionMetadata( ns );
+
+                        bool docIsOrphan;
+                        if ( metadataNow ) {
+                            KeyPattern kp( metadataNow->getKeyPattern() );
+                            BSONObj key = kp.extractSingleKey( obj );
+                            docIsOrphan = !metadataNow->keyBelongsToMe( key )
+                                && !metadataNow->keyIsPending( key );
+                        }
+                        else {
+                            docIsOrphan = false;
+                        }
+
+                        if ( !docIsOrphan ) {
+                            warning() << "aborting migration cleanup for chunk " << min << " to " << max
+                                      << ( metadataNow ? (string) " at document " + obj.toString() : "" )
+                                      << ", collection " << ns << " has changed " << endl;
+                            done = true;
+                            break;
+                        }
                     }
 
-                    if ( !docIsOrphan ) {
-                        warning() << "aborting migration cleanup for chunk " << min << " to " << max
-                                  << ( metadataNow ? (string) " at document " + obj.toString() : "" )
-                                  << ", collection " << ns << " has changed " << endl;
-                        break;
-                    }
-                }
+                    if ( callback )
+                        callback->goingToDelete( obj );
 
-                if ( callback )
-                    callback->goingToDelete( obj );
+                    logOp("d", ns.c_str(), obj["_id"].wrap(), 0, 0, fromMigrate);
 
-                logOp("d", ns.c_str(), obj["_id"].wrap(), 0, 0, fromMigrate);
-                c.database()->getCollection( ns )->deleteDocument( rloc );
-                numDeleted++;
+                    batchLocs.push_back( rloc );
+
+                    numDeleted++;
+                    numDeletedInBatch++;
+                }
+
+                // The scan is complete, so nothing reads the doomed records while the
+                // batch is unindexed and removed.
+                if ( !batchLocs.empty() ) {
+                    collection->deleteDocuments( batchLocs );
+                }
             }
 
             Timer secondaryThrottleTime;
 
-            if ( secondaryThrottle && numDeleted > 0 ) {
+            if ( secondaryThrottle && numDeletedInBatch > 0 ) {
                 if ( ! waitForReplication( c.getLastOp(), 2, 60 /* seconds to wait */ ) ) {
                     warning() << "replication to secondaries for removeRange at least 60 seconds behind" << endl;
                 }
+
+                // Back off while the slowest up secondary is lagging too far, so a big
+                // cleanup can't push secondaries past the lag threshold.
+                if ( replSet && theReplSet && rangeDeleterMaxSecondaryLagSecs > 0 ) {
+                    while ( !inShutdown() ) {
+                        OpTime laggard = theReplSet->earliestOtherOpTime();
+                        if ( laggard.isNull() ) break; // no up secondaries to protect
+
+                        int lagSecs = theReplSet->lastOpTimeWritten.getSecs() - laggard.getSecs();
+                        if ( lagSecs <= rangeDeleterMaxSecondaryLagSecs ) break;
+
+                        LOG(1) << "removeRange waiting for secondary lag of " << lagSecs
+                               << "s to drop to " << rangeDeleterMaxSecondaryLagSecs
+                               << "s" << endl;
+                        sleepsecs( 1 );
+                    }
+                }
+
                 millisWaitingForReplication += secondaryThrottleTime.millis();
             }
-            
+
             if ( ! Lock::isLocked() ) {
                 int micros = ( 2 * Client::recommendedYieldMicros() ) - secondaryThrottleTime.micros();
                 if ( micros > 0 ) {
@@ -75,6 +75,33 @@ namespace mongo {
         p->reply(requestMsg, resp, requestMsg.header()->id);
     }
 
+    void replyToQuery(int queryResultFlags,
+                      AbstractMessagingPort* p, Message& requestMsg,
+                      BufBuilder& dataBuffer,
+                      int nReturned, int startingFrom,
+                      long long cursorId
+                      ) {
+        QueryResult* qr = (QueryResult*) malloc(sizeof(QueryResult));
+        qr->_resultFlags() = queryResultFlags;
+        qr->len = 0; // set by appendData() below
+        qr->setOperation(opReply);
+        qr->cursorId = cursorId;
+        qr->startingFrom = startingFrom;
+        qr->nReturned = nReturned;
+
+        // The header and the documents go out as separate fragments; Socket::send uses
+        // scatter-gather for the actual transmission, so the documents are sent straight
+        // from the builder's buffer without being copied into a contiguous reply.
+        Message resp;
+        resp.appendData((char*) qr, sizeof(QueryResult));
+        if (dataBuffer.len()) {
+            resp.appendData(dataBuffer.buf(), dataBuffer.len());
+            dataBuffer.decouple(); // the message now owns the buffer
+        }
+
+        p->reply(requestMsg, resp, requestMsg.header()->id);
+    }
+
     void replyToQuery(int queryResultFlags,
                       AbstractMessagingPort* p, Message& requestMsg,
                       const BSONObj& responseObj) {
@@ -226,6 +226,37 @@ namespace mongo {
             return js;
         }
 
+        /**
+         * Fused variant of nextJsObj() for the insert path: one scan both
+         * establishes the document boundary and validates structure
+         * (unconditionally -- these bytes are headed for storage), filling
+         * *info with the facts the insert path would otherwise recompute
+         * with a second walk (_id offset, $-fields, zero timestamps).
+         */
+        BSONObj nextJsObjScanned( ValidatedDocInfo* info ) {
+            if ( nextjsobj == data ) {
+                nextjsobj += strlen(data) + 1; // skip namespace
+                massert( 13066 ,  "Message contains no documents", theEnd > nextjsobj );
+            }
+            massert( 10304,
+                     "Client Error: Remaining data too small for BSON object",
+                     theEnd - nextjsobj >= 5 );
+
+            Status status = validateBSON( nextjsobj, theEnd - nextjsobj, info );
+            massert( 10307,
+                     str::stream() << "Client Error: bad object in message: " << status.reason(),
+                     status.isOK() );
+
+            BSONObj js(nextjsobj);
+            verify( js.objsize() >= 5 );
+            verify( js.objsize() < ( theEnd - data ) );
+
+            nextjsobj += js.objsize();
+            if ( nextjsobj >= theEnd )
+                nextjsobj = 0;
+            return js;
+        }
+
         const Message& msg() const { return m; }
 
         const char * markGet() {
@@ -297,6 +328,19 @@ namespace mongo {
                       long long cursorId = 0
                       );
 
+    /**
+     * Zero-copy variant: takes ownership of dataBuffer (it is decoupled) and sends the
+     * reply header and the result documents as separate fragments, letting the socket
+     * layer scatter-gather them instead of copying the documents into a contiguous
+     * reply buffer.
+     */
+    void replyToQuery(int queryResultFlags,
+                      AbstractMessagingPort* p, Message& requestMsg,
+                      BufBuilder& dataBuffer,
+                      int nReturned, int startingFrom = 0,
+                      long long cursorId = 0
+                      );
+
 
     /* object reply helper. */
     void replyToQuery(int queryResultFlags,
@@ -81,10 +81,13 @@
 #include "mongo/db/dur_journal.h"
 #include "mongo/db/dur_recover.h"
 #include "mongo/db/dur_stats.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/server.h"
 #include "mongo/util/concurrency/race.h"
 #include "mongo/util/mongoutils/hash.h"
+#include "mongo/util/background.h"
+#include "mongo/util/numa.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/stacktrace.h"
 #include "mongo/util/timer.h"
@@ -539,7 +542,8 @@ namespace mongo {
                     DurableMappedFile *mmf = (DurableMappedFile*) *i;
                     verify(mmf);
                     if( mmf->willNeedRemap() ) {
-                        mmf->willNeedRemap() = false;
+                        // only the regions dirtied since the last remap get remapped;
+                        // remapThePrivateView resets the dirty set
                         mmf->remapThePrivateView();
                     }
                     i++;
@@ -558,10 +562,25 @@ namespace mongo {
             stats.curr->_remapPrivateViewMicros += t.micros();
         }
 
-        // this is a pseudo-local variable in the groupcommit functions 
-        // below.  however we don't truly do that so that we don't have to 
+        // this is a pseudo-local variable in the groupcommit functions
+        // below.  however we don't truly do that so that we don't have to
         // reallocate, and more importantly regrow it, on every single commit.
-        static AlignedBuilder __theBuilder(4 * 1024 * 1024);
+        static AlignedBuilder __theBuilder(4 * 1024 * 1024, &journalBufferPool());
+
+        // high-water mark of recent commit sizes, for pre-sizing the next cycle's
+        // buffer.  growing mid-commit copies the bytes already built, so we would
+        // rather start each cycle with a buffer recent traffic fit in.  decays so a
+        // one-off burst doesn't pin a large buffer forever.  callers hold
+        // commitJob.groupCommitMutex so plain statics are fine.
+        static unsigned __commitHighWaterBytes = 0;
+
+        static void noteCommitSizeAndReset(AlignedBuilder& ab) {
+            if( ab.len() > __commitHighWaterBytes )
+                __commitHighWaterBytes = ab.len();
+            else
+                RARELY __commitHighWaterBytes -= __commitHighWaterBytes / 4;
+            ab.reset(__commitHighWaterBytes);
+        }
 
         static bool _groupCommitWithLimitedLocks() {
             unspoolWriteIntents(); // in case we were doing some writing ourself (likely impossible with limitedlocks version)
@@ -616,7 +635,7 @@ namespace mongo {
             // mutating.
             WRITETODATAFILES(h, ab);
             verify( abLen == ab.len() ); // check again wasn't modded
-            ab.reset();
+            noteCommitSizeAndReset(ab);
 
             // can't : d.dbMutex._remapPrivateViewRequested = true;
             // (writes have happened we released)
@@ -687,7 +706,7 @@ namespace mongo {
                     debugValidateAllMapsMatch();
 
                     commitJob.committingReset();
-                    ab.reset();
+                    noteCommitSizeAndReset(ab);
                 }
             }
 
@@ -801,9 +820,42 @@ namespace mongo {
         extern int groupCommitIntervalMs;
         boost::filesystem::path getJournalDir();
 
+        // pin the journal thread to one NUMA node so its private buffers
+        // (first-touched here) stay local to it; -1 leaves placement alone
+        MONGO_EXPORT_SERVER_PARAMETER(numaJournalNode, int, -1);
+
+        // explicit cpu list ("0,2,4-7") for the journal thread; empty leaves it
+        // unpinned (or NUMA-node-pinned, see above).  commit latency jitters when
+        // the journal thread migrates sockets, so pinning it is often a win
+        MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalThreadCpuAffinity, std::string, "");
+
+        // linux best-effort io priority level for journal writes, 0 (served
+        // first) .. 7; -1 leaves the kernel default.  commits sit in front of
+        // flusher and reader io by default
+        MONGO_EXPORT_STARTUP_SERVER_PARAMETER(journalThreadIoPriority, int, 0);
+
         void durThread() {
             Client::initThread("journal");
 
+            if ( numaJournalNode >= 0 ) {
+                numaBindThreadToNode( numaJournalNode );
+            }
+
+            {
+                ThreadAttributes attrs;
+                if ( !journalThreadCpuAffinity.empty() ) {
+                    std::vector<int> cpus;
+                    Status s = ThreadAttributes::parseCpuList( journalThreadCpuAffinity, &cpus );
+                    if ( s.isOK() )
+                        attrs.cpuAffinity( cpus ); // overrides the NUMA node pin above
+                    else
+                        warning() << "journalThreadCpuAffinity: " << s.reason() << endl;
+                }
+                if ( journalThreadIoPriority >= 0 && journalThreadIoPriority <= 7 )
+                    attrs.ioClass( ThreadAttributes::IOClassBestEffort, journalThreadIoPriority );
+                attrs.applyToCurrentThread( "journal" );
+            }
+
             bool samePartition = true;
             try {
                 const std::string dbpathDir =
@@ -822,21 +874,32 @@ namespace mongo {
                     ms = samePartition ? 100 : 30;
                 }
 
-                unsigned oneThird = (ms / 3) + 1; // +1 so never zero
+                unsigned slice = (ms / 10) + 1; // +1 so never zero
 
                 try {
                     stats.rotate();
 
-                    // commit sooner if one or more getLastError j:true is pending
-                    sleepmillis(oneThird);
-                    for( unsigned i = 1; i <= 2; i++ ) {
+                    // adaptive scheduling: the configured interval is a ceiling for
+                    // pending writes, not a fixed period.  we poll in short slices and
+                    // commit early when a getLastError j:true writer is waiting or when
+                    // pending bytes pile up; when a full interval passes with nothing
+                    // written we stretch the sleep so an idle server does fewer, larger
+                    // journal writes.  stretching is safe as there is nothing to lose.
+                    unsigned slept = 0;
+                    const unsigned maxStretch = ms * 4;
+                    while( true ) {
+                        sleepmillis(slice);
+                        slept += slice;
                         if( commitJob._notify.nWaiting() )
-                            break;
-                        if( commitJob.bytes() > UncommittedBytesLimit / 2  )
-                            break;
-                        sleepmillis(oneThird);
+                            break; // j:true writer blocked on this commit
+                        if( commitJob.bytes() > UncommittedBytesLimit / 2 )
+                            break; // enough pending that waiting longer costs more than committing
+                        if( slept >= ms && commitJob.hasWritten() )
+                            break; // normal interval elapsed with work pending
+                        if( slept >= maxStretch )
+                            break; // idle; still commit occasionally for stats/rotation
                     }
-                                        
+
                     //DEV log() << "privateMapBytes=" << privateMapBytes << endl;
 
                     durThreadGroupCommit();
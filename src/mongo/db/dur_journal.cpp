@@ -48,6 +48,8 @@
 #include "mongo/util/checksum.h"
 #include "mongo/util/compress.h"
 #include "mongo/util/concurrency/race.h"
+#include "mongo/util/concurrency/thread_pool.h"
+#include "mongo/util/crc32c.h"
 #include "mongo/util/file.h"
 #include "mongo/util/logfile.h"
 #include "mongo/util/mmap.h"
@@ -87,6 +89,13 @@ namespace mongo {
             return Status::OK();
         }
 
+        // function-local static so the pool exists before the first builder that uses
+        // it is constructed, regardless of static initialization order across files
+        AlignedBufferPool& journalBufferPool() {
+            static AlignedBufferPool pool;
+            return pool;
+        }
+
         BOOST_STATIC_ASSERT( sizeof(Checksum) == 16 );
         BOOST_STATIC_ASSERT( sizeof(JHeader) == 8192 );
         BOOST_STATIC_ASSERT( sizeof(JSectHeader) == 20 );
@@ -130,20 +139,37 @@ namespace mongo {
             reserved = 0;
             magic[0] = magic[1] = magic[2] = magic[3] = '\n';
 
+#if defined(_NOCOMPRESS)
+            // version 0x4148 keeps the legacy checksum
             Checksum c;
             c.gen(begin, (unsigned) len);
             memcpy(hash, c.bytes, sizeof(hash));
+#else
+            memset(hash, 0, sizeof(hash));
+            uint32_t crc = crc32c(begin, (size_t) len);
+            memcpy(hash, &crc, sizeof(crc));
+#endif
         }
 
-        bool JSectFooter::checkHash(const void* begin, int len) const {
-            if( !magicOk() ) { 
+        bool JSectFooter::checkHash(const void* begin, int len, bool crc) const {
+            if( !magicOk() ) {
                 log() << "journal footer not valid" << endl;
                 return false;
             }
+            if( crc ) {
+                uint32_t expected;
+                memcpy(&expected, hash, sizeof(expected));
+                uint32_t got = crc32c(begin, (size_t) len);
+                DEV log() << "checkHash len:" << len << " crc:" << toHex(hash, 4) << " current:" << toHex(&got, 4) << endl;
+                if( got == expected )
+                    return true;
+                log() << "journal checkHash mismatch, got: " << toHex(&got, 4) << " expected: " << toHex(hash, 4) << endl;
+                return false;
+            }
             Checksum c;
             c.gen(begin, len);
             DEV log() << "checkHash len:" << len << " hash:" << toHex(hash, 16) << " current:" << toHex(c.bytes, 16) << endl;
-            if( memcmp(hash, c.bytes, sizeof(hash)) == 0 ) 
+            if( memcmp(hash, c.bytes, sizeof(hash)) == 0 )
                 return true;
             log() << "journal checkHash mismatch, got: " << toHex(c.bytes, 16) << " expected: " << toHex(hash,16) << endl;
             return false;
@@ -727,16 +753,32 @@ namespace mongo {
             j.journal(h, uncompressed);
             stats.curr->_writeToJournalMicros += t.micros();
         }
+        // sections are compressed in independent chunks of this many uncompressed bytes
+        // so the chunks can be compressed in parallel (snappy is single-threaded per call)
+        static const unsigned CompressionChunkBytes = 1024 * 1024;
+
+        static void compressChunk(const char* src, unsigned srcLen, char* dst, size_t* dstLen) {
+            rawCompress(src, srcLen, dst, dstLen);
+        }
+
         void Journal::journal(const JSectHeader& h, const AlignedBuilder& uncompressed) {
             RACECHECK
-            static AlignedBuilder b(32*1024*1024);
+            static AlignedBuilder b(32*1024*1024, &journalBufferPool());
+            // pool for parallel chunk compression.  sized modestly: the journal thread
+            // compresses one chunk itself, so with the pool we use up to 4 cores.
+            static ThreadPool compressPool(3);
             /* buffer to journal will be
                JSectHeader
-               compressed operations
+               chunk count, chunk compressed-length table
+               compressed chunks, back to back
                JSectFooter
             */
+            const unsigned nChunks = ( uncompressed.len() + CompressionChunkBytes - 1 ) /
+                                     CompressionChunkBytes;
+            const unsigned maxPerChunk = maxCompressedLength( CompressionChunkBytes );
+            const unsigned tableSize = sizeof(unsigned) * ( 1 + nChunks );
             const unsigned headTailSize = sizeof(JSectHeader) + sizeof(JSectFooter);
-            const unsigned max = maxCompressedLength(uncompressed.len()) + headTailSize;
+            const unsigned max = tableSize + nChunks * maxPerChunk + headTailSize;
             b.reset(max);
 
             {
@@ -744,10 +786,44 @@ namespace mongo {
                 b.appendStruct(h);
             }
 
-            size_t compressedLength = 0;
-            rawCompress(uncompressed.buf(), uncompressed.len(), b.cur(), &compressedLength);
-            verify( compressedLength < 0xffffffff );
-            verify( compressedLength < max );
+            const unsigned tableOfs = b.len();
+            b.skip(tableSize);
+            char* const chunkArea = b.cur();
+
+            // compress each chunk into its own slot; slots are compacted below.
+            // chunks after the first go to the pool, the first we do ourselves.
+            static vector<size_t> chunkLens;
+            chunkLens.resize(nChunks);
+            for( unsigned i = 1; i < nChunks; i++ ) {
+                compressPool.schedule(&compressChunk,
+                                      uncompressed.buf() + i * CompressionChunkBytes,
+                                      std::min(CompressionChunkBytes,
+                                               uncompressed.len() - i * CompressionChunkBytes),
+                                      chunkArea + i * maxPerChunk,
+                                      &chunkLens[i]);
+            }
+            if( nChunks ) {
+                compressChunk(uncompressed.buf(),
+                              std::min(CompressionChunkBytes, uncompressed.len()),
+                              chunkArea, &chunkLens[0]);
+            }
+            if( nChunks > 1 ) {
+                compressPool.join();
+            }
+
+            // compact the chunks so they are back to back, and fill in the length table
+            unsigned* table = (unsigned*) b.atOfs(tableOfs);
+            table[0] = nChunks;
+            char* w = chunkArea;
+            for( unsigned i = 0; i < nChunks; i++ ) {
+                verify( chunkLens[i] <= maxPerChunk );
+                table[i+1] = (unsigned) chunkLens[i];
+                if( w != chunkArea + i * maxPerChunk )
+                    memmove(w, chunkArea + i * maxPerChunk, chunkLens[i]);
+                w += chunkLens[i];
+            }
+            const unsigned compressedLength = w - chunkArea;
+            verify( tableSize + compressedLength < max );
             b.skip(compressedLength);
 
             // footer
@@ -32,9 +32,14 @@
 
 namespace mongo {
     class AlignedBuilder;
+    class AlignedBufferPool;
 
     namespace dur {
 
+        /** pool backing the builders used by the group commit cycle, so buffer
+            resizes swap pre-sized allocations instead of mallocing and freeing */
+        AlignedBufferPool& journalBufferPool();
+
         /** true if ok to cleanup journal files at termination. otherwise, files journal will be retained.
         */
         extern bool okToCleanUp;
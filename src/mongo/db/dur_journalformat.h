@@ -51,7 +51,13 @@ namespace mongo {
 #if defined(_NOCOMPRESS)
             enum { CurrentVersion = 0x4148 };
 #else
-            enum { CurrentVersion = 0x4149 };
+            // 0x4149 wrote each section body as a single snappy stream.  0x414a writes
+            // it as independently compressed chunks (chunk count + length table + data)
+            // so chunks can be compressed in parallel; see Journal::journal().  0x414b
+            // replaces the legacy section checksum with CRC32C (hardware assisted
+            // where the processor supports it); older files are still read and
+            // checked with the legacy checksum.
+            enum { OldestSupportedVersion = 0x4149, CurrentVersion = 0x414b };
 #endif
             unsigned short _version;
 
@@ -67,7 +73,20 @@ namespace mongo {
             char reserved3[8026]; // 8KB total for the file header
             char txt2[2];         // "\n\n" at the end
 
+#if defined(_NOCOMPRESS)
             bool versionOk() const { return _version == CurrentVersion; }
+#else
+            // we still recover files left behind by prior versions
+            bool versionOk() const {
+                return _version >= OldestSupportedVersion && _version <= CurrentVersion;
+            }
+#endif
+            /** @return true if this file's sections use the chunked compression layout */
+            bool chunkedSections() const { return _version >= 0x414a; }
+
+            /** @return true if this file's section footers carry a CRC32C rather than
+                the legacy checksum */
+            bool crcChecksums() const { return _version >= 0x414b; }
             bool valid() const { return magic[0] == 'j' && txt2[1] == '\n' && fileId; }
         };
 
@@ -141,7 +160,9 @@ namespace mongo {
             }
         };
 
-        /** group commit section footer. md5 is a key field. */
+        /** group commit section footer. hash is a key field.  current version files
+            store a CRC32C in the first four hash bytes (rest zeroed); older files
+            store the legacy 16 byte checksum. */
         struct JSectFooter {
             JSectFooter();
             JSectFooter(const void* begin, int len); // needs buffer to compute hash
@@ -153,9 +174,11 @@ namespace mongo {
             /** used by recovery to see if buffer is valid
                 @param begin the buffer
                 @param len buffer len
+                @param crc true if the file's footers carry CRC32C checksums
+                           (JHeader::crcChecksums())
                 @return true if buffer looks valid
             */
-            bool checkHash(const void* begin, int len) const;
+            bool checkHash(const void* begin, int len, bool crc) const;
 
             bool magicOk() const { return *((unsigned*)magic) == 0x0a0a0a0a; }
         };
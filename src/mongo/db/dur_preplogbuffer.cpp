@@ -76,12 +76,9 @@ namespace mongo {
             size_t ofs = 1;
             DurableMappedFile *mmf = findMMF_inlock(i->start(), /*out*/ofs);
 
-            if( unlikely(!mmf->willNeedRemap()) ) {
-                // tag this mmf as needed a remap of its private view later.
-                // usually it will already be dirty/already set, so we do the if above first
-                // to avoid possibility of cpu cache line contention
-                mmf->willNeedRemap() = true;
-            }
+            // tag the regions of this mmf's private view the write touches so only
+            // those get remapped later
+            mmf->noteWriteRegion( ofs, i->length() );
 
             // since we have already looked up the mmf, we go ahead and remember the write view location
             // so we don't have to find the DurableMappedFile again later in WRITETODATAFILES()
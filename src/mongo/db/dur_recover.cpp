@@ -115,20 +115,47 @@ namespace mongo {
             const bool _doDurOps;
             string _uncompressed;
         public:
-            JournalSectionIterator(const JSectHeader& h, const void *compressed, unsigned compressedLen, bool doDurOpsRecovering) :
+            JournalSectionIterator(const JSectHeader& h, const void *compressed, unsigned compressedLen,
+                                   bool doDurOpsRecovering, bool chunked) :
                 _h(h),
                 _lastDbName(0)
                 , _doDurOps(doDurOpsRecovering)
             {
                 verify( doDurOpsRecovering );
-                bool ok = uncompress((const char *)compressed, compressedLen, &_uncompressed);
-                if( !ok ) { 
-                    // it should always be ok (i think?) as there is a previous check to see that the JSectFooter is ok
-                    log() << "couldn't uncompress journal section" << endl;
-                    msgasserted(15874, "couldn't uncompress journal section");
+                verify( compressedLen == _h.sectionLen() - sizeof(JSectFooter) - sizeof(JSectHeader) );
+                if( chunked ) {
+                    // chunk count + per-chunk compressed-length table + chunk data
+                    BufReader br(compressed, compressedLen);
+                    unsigned nChunks;
+                    br.read(nChunks);
+                    uassert(17453, "journal section chunk count invalid",
+                            (unsigned long long)(1 + nChunks) * sizeof(unsigned) <= compressedLen);
+                    vector<unsigned> chunkLens(nChunks);
+                    for( unsigned i = 0; i < nChunks; i++ ) {
+                        br.read(chunkLens[i]);
+                    }
+                    for( unsigned i = 0; i < nChunks; i++ ) {
+                        uassert(17451, "journal section chunk length invalid",
+                                chunkLens[i] <= br.remaining());
+                        const char* chunkData = (const char *) br.pos();
+                        br.skip(chunkLens[i]);
+                        string chunk;
+                        if( !uncompress(chunkData, chunkLens[i], &chunk) ) {
+                            log() << "couldn't uncompress journal section chunk" << endl;
+                            msgasserted(17452, "couldn't uncompress journal section chunk");
+                        }
+                        _uncompressed += chunk;
+                    }
+                }
+                else {
+                    bool ok = uncompress((const char *)compressed, compressedLen, &_uncompressed);
+                    if( !ok ) {
+                        // it should always be ok (i think?) as there is a previous check to see that the JSectFooter is ok
+                        log() << "couldn't uncompress journal section" << endl;
+                        msgasserted(15874, "couldn't uncompress journal section");
+                    }
                 }
                 const char *p = _uncompressed.c_str();
-                verify( compressedLen == _h.sectionLen() - sizeof(JSectFooter) - sizeof(JSectHeader) );
                 _entries = auto_ptr<BufReader>( new BufReader(p, _uncompressed.size()) );
             }
 
@@ -390,7 +417,8 @@ namespace mongo {
 
             auto_ptr<JournalSectionIterator> i;
             if( _recovering ) {
-                i = auto_ptr<JournalSectionIterator>(new JournalSectionIterator(*h, p, len, _recovering));
+                i = auto_ptr<JournalSectionIterator>(new JournalSectionIterator(*h, p, len, _recovering,
+                                                                                _chunkedSections));
             }
             else { 
                 i = auto_ptr<JournalSectionIterator>(new JournalSectionIterator(*h, /*after header*/p, /*w/out header*/len));
@@ -419,7 +447,7 @@ namespace mongo {
             // after the entries check the footer checksum
             if( _recovering ) {
                 verify( ((const char *)h) + sizeof(JSectHeader) == p );
-                if( !f->checkHash(h, len + sizeof(JSectHeader)) ) { 
+                if( !f->checkHash(h, len + sizeof(JSectHeader), _crcChecksums) ) {
                     msgasserted(13594, "journal checksum doesn't match");
                 }
             }
@@ -459,6 +487,8 @@ namespace mongo {
                         uasserted(13536, str::stream() << "journal version number mismatch " << h._version);
                     }
                     fileId = h.fileId;
+                    _chunkedSections = h.chunkedSections();
+                    _crcChecksums = h.crcChecksums();
                     if (storageGlobalParams.durOptions &
                         StorageGlobalParams::DurDumpJournal) {
                         log() << "JHeader::fileId=" << fileId << endl;
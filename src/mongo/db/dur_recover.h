@@ -56,8 +56,9 @@ namespace mongo {
                 int fileNo;
             } last;        
         public:
-            RecoveryJob() : _lastDataSyncedFromLastRun(0), 
-                _mx("recovery"), _recovering(false) { _lastSeqMentionedInConsoleLog = 1; }
+            RecoveryJob() : _lastDataSyncedFromLastRun(0),
+                _mx("recovery"), _recovering(false),
+                _chunkedSections(true), _crcChecksums(true) { _lastSeqMentionedInConsoleLog = 1; }
             void go(vector<boost::filesystem::path>& files);
             ~RecoveryJob();
 
@@ -84,6 +85,8 @@ namespace mongo {
             mongo::mutex _mx; // protects _mmfs
         private:
             bool _recovering; // are we in recovery or WRITETODATAFILES
+            bool _chunkedSections; // sections of the file being recovered use the chunked layout
+            bool _crcChecksums;    // section footers of the file being recovered carry CRC32C
 
             static RecoveryJob &_instance;
         };
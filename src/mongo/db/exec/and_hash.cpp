@@ -103,6 +103,13 @@ namespace mongo {
         WorkingSetMember* member = _ws->get(*out);
         verify(member->hasLoc());
 
+        // Cheap pre-pass: if the bloom filter has never seen this loc, neither has the map.
+        if (!_baseBloom.mayContain(member->loc)) {
+            _ws->free(*out);
+            ++_commonStats.needTime;
+            return PlanStage::NEED_TIME;
+        }
+
         DataMap::iterator it = _dataMap.find(member->loc);
         if (_dataMap.end() == it) {
             // Child's output wasn't in every previous child.  Throw it out.
@@ -148,6 +155,7 @@ namespace mongo {
             verify(_dataMap.end() == _dataMap.find(member->loc));
 
             _dataMap[member->loc] = id;
+            _baseBloom.insert(member->loc);
             ++_commonStats.needTime;
             return PlanStage::NEED_TIME;
         }
@@ -188,7 +196,8 @@ namespace mongo {
         if (PlanStage::ADVANCED == childStatus) {
             WorkingSetMember* member = _ws->get(id);
             verify(member->hasLoc());
-            if (_dataMap.end() == _dataMap.find(member->loc)) {
+            if (!_baseBloom.mayContain(member->loc)
+                || _dataMap.end() == _dataMap.find(member->loc)) {
                 // Ignore.  It's not in any previous child.
             }
             else {
@@ -67,6 +67,52 @@ namespace mongo {
         virtual PlanStageStats* getStats();
 
     private:
+        /**
+         * Compact bloom filter over the DiskLocs the first child produced.  Consulted before
+         * every probe of _dataMap; a "no" answer skips the hash lookup entirely.  "Maybe"
+         * answers fall through to the authoritative map lookup, so removals from the map
+         * (children that miss, invalidations) never need to touch the filter.
+         */
+        class LocBloomFilter {
+        public:
+            LocBloomFilter() : _bits(kNumWords, 0) { }
+
+            void insert(const DiskLoc& loc) {
+                unsigned long long h = hash(loc);
+                setBit(h & (kNumBits - 1));
+                setBit((h >> 32) & (kNumBits - 1));
+            }
+
+            bool mayContain(const DiskLoc& loc) const {
+                unsigned long long h = hash(loc);
+                return testBit(h & (kNumBits - 1)) && testBit((h >> 32) & (kNumBits - 1));
+            }
+
+        private:
+            // 2^20 bits is 128KB, small next to the WSMs _dataMap holds and enough to keep
+            // the false positive rate low for a build side of a few hundred thousand locs.
+            static const size_t kNumBits = 1 << 20;
+            static const size_t kNumWords = kNumBits / 64;
+
+            static unsigned long long hash(const DiskLoc& loc) {
+                // 64-bit mix of the (file, offset) pair; the top and bottom halves of the
+                // result give us two independent bit positions.
+                unsigned long long h = (static_cast<unsigned long long>(loc.a()) << 32)
+                    | static_cast<unsigned int>(loc.getOfs());
+                h ^= h >> 33;
+                h *= 0xff51afd7ed558ccdULL;
+                h ^= h >> 33;
+                h *= 0xc4ceb9fe1a85ec53ULL;
+                h ^= h >> 33;
+                return h;
+            }
+
+            void setBit(size_t i) { _bits[i / 64] |= (1ULL << (i % 64)); }
+            bool testBit(size_t i) const { return 0 != (_bits[i / 64] & (1ULL << (i % 64))); }
+
+            std::vector<unsigned long long> _bits;
+        };
+
         StageState readFirstChild(WorkingSetID* out);
         StageState hashOtherChildren(WorkingSetID* out);
 
@@ -89,6 +135,10 @@ namespace mongo {
         typedef unordered_set<DiskLoc, DiskLoc::Hasher> SeenMap;
         SeenMap _seenMap;
 
+        // Set for every loc the first child put in _dataMap.  The map only ever shrinks after
+        // that, so this stays a superset of its keys and a "no" here is authoritative.
+        LocBloomFilter _baseBloom;
+
         // True if we're still intersecting _children[0..._children.size()-1].
         bool _hashingChildren;
 
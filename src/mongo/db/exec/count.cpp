@@ -0,0 +1,178 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/exec/count.h"
+
+#include "mongo/db/catalog/index_catalog.h"
+#include "mongo/db/index/index_cursor.h"
+#include "mongo/db/index/index_descriptor.h"
+
+namespace mongo {
+
+    Count::Count(const CountParams& params, WorkingSet* workingSet)
+        : _workingSet(workingSet),
+          _descriptor(params.descriptor),
+          _iam(params.descriptor->getIndexCatalog()->getBtreeIndex(params.descriptor)),
+          _hitEnd(false),
+          _count(0),
+          _params(params) { }
+
+    void Count::seekCursor(BtreeIndexCursor* cursor, const BSONObj& key,
+                           bool inclusive) const {
+        vector<BSONElement> keyElts;
+        BSONObjIterator it(key);
+        while (it.more()) {
+            keyElts.push_back(it.next());
+        }
+
+        // An exclusive seek means "advance past entries equal on every field", which the
+        // btree-specific seek expresses as the last field being exclusive.
+        vector<const BSONElement*> keyEltPtrs(keyElts.size());
+        vector<bool> keyEltsInclusive(keyElts.size(), true);
+        for (size_t i = 0; i < keyElts.size(); ++i) {
+            keyEltPtrs[i] = &keyElts[i];
+        }
+        if (!inclusive && !keyElts.empty()) {
+            keyEltsInclusive[keyElts.size() - 1] = false;
+        }
+
+        cursor->seek(keyEltPtrs, keyEltsInclusive);
+    }
+
+    void Count::initIndexCursor() {
+        CursorOptions cursorOptions;
+        cursorOptions.direction = CursorOptions::INCREASING;
+
+        IndexCursor* cursor;
+        Status s = _iam->newCursor(&cursor);
+        verify(s.isOK());
+        _btreeCursor.reset(static_cast<BtreeIndexCursor*>(cursor));
+        _btreeCursor->setOptions(cursorOptions);
+        seekCursor(_btreeCursor.get(), _params.startKey, _params.startKeyInclusive);
+
+        // The end cursor marks the first entry *past* the interval: the first entry after
+        // endKey if the bound is inclusive, the first entry at or after it otherwise.
+        s = _iam->newCursor(&cursor);
+        verify(s.isOK());
+        _endCursor.reset(static_cast<BtreeIndexCursor*>(cursor));
+        _endCursor->setOptions(cursorOptions);
+        seekCursor(_endCursor.get(), _params.endKey, !_params.endKeyInclusive);
+    }
+
+    bool Count::atEndPosition() const {
+        if (_btreeCursor->isEOF()) { return true; }
+        // If the end cursor ran off the index the interval extends to the last entry and
+        // only cursor EOF stops us.
+        if (_endCursor->isEOF()) { return false; }
+        return _btreeCursor->getBucket() == _endCursor->getBucket()
+            && _btreeCursor->getKeyOfs() == _endCursor->getKeyOfs();
+    }
+
+    PlanStage::StageState Count::work(WorkingSetID* out) {
+        ++_commonStats.works;
+
+        if (NULL == _btreeCursor.get()) {
+            // First call to work().  Perform cursor init.
+            initIndexCursor();
+            if (atEndPosition()) { _hitEnd = true; }
+        }
+
+        if (isEOF()) { return PlanStage::IS_EOF; }
+
+        // If the end position is in another bucket, the rest of this bucket lies entirely
+        // inside the interval; for leaves we can count its keys in place.
+        if (_endCursor->isEOF() || _endCursor->getBucket() != _btreeCursor->getBucket()) {
+            long long inBucket = _btreeCursor->countAndSkipToNextBucket();
+            if (inBucket >= 0) {
+                _count += inBucket;
+                if (atEndPosition()) { _hitEnd = true; }
+                ++_commonStats.needTime;
+                return PlanStage::NEED_TIME;
+            }
+            // Interior bucket; fall through and step one key at a time.
+        }
+
+        ++_count;
+        _btreeCursor->next();
+        if (atEndPosition()) { _hitEnd = true; }
+
+        ++_commonStats.needTime;
+        return PlanStage::NEED_TIME;
+    }
+
+    bool Count::isEOF() {
+        if (NULL == _btreeCursor.get()) {
+            // Have to call work() at least once.
+            return false;
+        }
+
+        return _hitEnd || _btreeCursor->isEOF();
+    }
+
+    void Count::prepareToYield() {
+        ++_commonStats.yields;
+
+        if (isEOF() || (NULL == _btreeCursor.get())) { return; }
+        _btreeCursor->savePosition();
+    }
+
+    void Count::recoverFromYield() {
+        ++_commonStats.unyields;
+
+        if (isEOF() || (NULL == _btreeCursor.get())) { return; }
+
+        if (!_btreeCursor->restorePosition().isOK() || _btreeCursor->isEOF()) {
+            _hitEnd = true;
+            return;
+        }
+
+        // The entry marking the end of the interval may have moved or vanished while we
+        // were away; re-find it.
+        seekCursor(_endCursor.get(), _params.endKey, !_params.endKeyInclusive);
+
+        // If our entry was deleted, restorePosition() may have put us past the interval;
+        // check against the actual key rather than the end position.
+        const int cmp = _params.endKey.woCompare(_btreeCursor->getKey(),
+                                                 _descriptor->keyPattern());
+        if (cmp < 0 || (0 == cmp && !_params.endKeyInclusive)) {
+            _hitEnd = true;
+        }
+    }
+
+    void Count::invalidate(const DiskLoc& dl) {
+        // We don't hold on to DiskLocs; the cursors re-validate on unyield.
+        ++_commonStats.invalidates;
+    }
+
+    PlanStageStats* Count::getStats() {
+        _commonStats.isEOF = isEOF();
+        auto_ptr<PlanStageStats> ret(new PlanStageStats(_commonStats, STAGE_COUNT));
+        return ret.release();
+    }
+
+}  // namespace mongo
@@ -0,0 +1,117 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include "mongo/db/diskloc.h"
+#include "mongo/db/exec/plan_stage.h"
+#include "mongo/db/index/btree_index_cursor.h"
+#include "mongo/db/index/index_access_method.h"
+#include "mongo/db/jsobj.h"
+
+namespace mongo {
+
+    class IndexDescriptor;
+    class WorkingSet;
+
+    struct CountParams {
+        CountParams() : descriptor(NULL), startKeyInclusive(true), endKeyInclusive(true) { }
+
+        // What index are we counting over?
+        const IndexDescriptor* descriptor;
+
+        BSONObj startKey;
+        bool startKeyInclusive;
+
+        BSONObj endKey;
+        bool endKeyInclusive;
+    };
+
+    /**
+     * Used by the count command.  Walks a btree index from startKey to endKey counting
+     * entries without fetching documents or matching keys: the caller guarantees that
+     * [startKey, endKey] answers the predicate exactly, and that the index is not
+     * multikey, so every counted key is a matching document.  Leaf buckets entirely
+     * inside the interval are counted in place instead of being iterated key by key.
+     *
+     * Never returns ADVANCED.  Drive it to IS_EOF and read the tally with getCount().
+     *
+     * Sub-stage preconditions: None.  Is a leaf and consumes no stage data.
+     */
+    class Count : public PlanStage {
+    public:
+        Count(const CountParams& params, WorkingSet* workingSet);
+        virtual ~Count() { }
+
+        virtual StageState work(WorkingSetID* out);
+        virtual bool isEOF();
+        virtual void prepareToYield();
+        virtual void recoverFromYield();
+        virtual void invalidate(const DiskLoc& dl);
+
+        virtual PlanStageStats* getStats();
+
+        long long getCount() const { return _count; }
+
+    private:
+        /**
+         * Set up our btree cursor at the start of the interval and a second cursor at the
+         * first entry past the interval.
+         */
+        void initIndexCursor();
+
+        /**
+         * Position 'cursor' at the first entry >= key, or > key when 'inclusive' is false.
+         */
+        void seekCursor(BtreeIndexCursor* cursor, const BSONObj& key, bool inclusive) const;
+
+        /** Is our cursor at the position the end cursor marks (or out of entries)? */
+        bool atEndPosition() const;
+
+        // The WorkingSet we annotate with results.  Not owned by us.
+        WorkingSet* _workingSet;
+
+        // Index access.  Both owned by Collection -> IndexCatalog.
+        const IndexDescriptor* _descriptor;
+        const IndexAccessMethod* _iam;
+
+        // Our cursor and the cursor marking the first entry past the counted interval.
+        scoped_ptr<BtreeIndexCursor> _btreeCursor;
+        scoped_ptr<BtreeIndexCursor> _endCursor;
+
+        // Have we counted everything in the interval?
+        bool _hitEnd;
+
+        long long _count;
+
+        CountParams _params;
+
+        CommonStats _commonStats;
+    };
+
+}  // namespace mongo
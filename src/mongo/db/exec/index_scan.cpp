@@ -43,15 +43,19 @@ namespace {
         return i > 0 ? 1 : -1;
     }
 
+    // How many keys we pull out of the btree cursor per batch.  Amortizes the per-key
+    // virtual dispatch and bucket lookups over a bucket's worth of entries.
+    const size_t kKeysPerBatch = 64;
+
 }  // namespace
 
 namespace mongo {
 
     IndexScan::IndexScan(const IndexScanParams& params, WorkingSet* workingSet,
                          const MatchExpression* filter)
-        : _workingSet(workingSet), _descriptor(params.descriptor), _hitEnd(false), _filter(filter), 
+        : _workingSet(workingSet), _descriptor(params.descriptor), _hitEnd(false), _filter(filter),
           _shouldDedup(params.descriptor->isMultikey()), _yieldMovedCursor(false), _params(params),
-          _btreeCursor(NULL) {
+          _btreeCursor(NULL), _batchNextToReturn(0) {
 
         string amName;
 
@@ -82,6 +86,19 @@ namespace mongo {
         _specificStats.direction = _params.direction;
         _specificStats.isMultiKey = _descriptor->isMultikey();
         _specificStats.keyPattern = _descriptor->keyPattern();
+
+        _usageStats = indexUsageTracker.get(_descriptor->indexNamespace());
+    }
+
+    IndexScan::~IndexScan() {
+        // Flush this scan's totals into the always-on usage counters: one bulk update
+        // per scan rather than an increment per key.  Scans that never touched the
+        // index (e.g. rejected candidate plans) are not counted as accesses.
+        if (_usageStats && (_specificStats.keysExamined > 0 || _commonStats.advanced > 0)) {
+            _usageStats->accesses.increment(1);
+            _usageStats->keysExamined.increment(_specificStats.keysExamined);
+            _usageStats->docsFetched.increment(_commonStats.advanced);
+        }
     }
 
     void IndexScan::initIndexCursor() {
@@ -148,18 +165,36 @@ namespace mongo {
             // from yielding.
         }
 
-        if (isEOF()) { return PlanStage::IS_EOF; }
+        if (_batchNextToReturn >= _batchKeys.size()) {
+            // Nothing batched up; go back to the index.
+            if (isEOF()) { return PlanStage::IS_EOF; }
 
-        // Grab the next (key, value) from the index.
-        BSONObj ownedKeyObj = _indexCursor->getKey().getOwned();
-        DiskLoc loc = _indexCursor->getValue();
+            _batchKeys.clear();
+            _batchLocs.clear();
+            _batchNextToReturn = 0;
 
-        // Move to the next result.
-        // The underlying IndexCursor points at the *next* thing we want to return.  We do this so
-        // that if we're scanning an index looking for docs to delete we don't continually clobber
-        // the thing we're pointing at.
-        _indexCursor->next();
-        checkEnd();
+            if (NULL != _btreeCursor) {
+                // "Fast" navigation: pull a bucket's worth of keys out of the cursor in one
+                // go; subsequent work() calls drain them without touching the index.
+                fillBatch();
+            }
+            else {
+                // Grab the next (key, value) from the index.
+                _batchKeys.push_back(_indexCursor->getKey().getOwned());
+                _batchLocs.push_back(_indexCursor->getValue());
+
+                // Move to the next result.
+                // The underlying IndexCursor points at the *next* thing we want to return.  We
+                // do this so that if we're scanning an index looking for docs to delete we
+                // don't continually clobber the thing we're pointing at.
+                _indexCursor->next();
+                checkEnd();
+            }
+        }
+
+        BSONObj ownedKeyObj = _batchKeys[_batchNextToReturn];
+        DiskLoc loc = _batchLocs[_batchNextToReturn];
+        ++_batchNextToReturn;
 
         if (_shouldDedup) {
             ++_specificStats.dupsTested;
@@ -198,12 +233,58 @@ namespace mongo {
         return PlanStage::NEED_TIME;
     }
 
+    void IndexScan::fillBatch() {
+        verify(NULL != _btreeCursor);
+        verify(NULL != _checker.get());
+
+        size_t maxToGet = kKeysPerBatch;
+        if (0 != _params.maxScan) {
+            // Keys batched beyond the first are counted against maxScan as they're validated
+            // below, so don't pull more than the budget allows.
+            size_t budget = 1 + _params.maxScan - _specificStats.keysExamined;
+            if (budget < maxToGet) {
+                maxToGet = budget;
+            }
+        }
+
+        int count = _btreeCursor->getBatch(static_cast<int>(maxToGet), &_batchKeys, &_batchLocs);
+        verify(count > 0);
+
+        // The first key was already validated (and counted) by the checkEnd() that left the
+        // cursor on it.  Validate the rest; on the first key that isn't VALID, put the cursor
+        // back on it and let checkEnd() run the usual skip/done logic from there.
+        for (int i = 1; i < count; ++i) {
+            IndexBoundsChecker::KeyState keyState;
+            keyState = _checker->checkKey(_batchKeys[i],
+                                          &_keyEltsToUse,
+                                          &_movePastKeyElts,
+                                          &_keyElts,
+                                          &_keyEltsInc);
+
+            if (IndexBoundsChecker::VALID == keyState) {
+                ++_specificStats.keysExamined;
+                continue;
+            }
+
+            _btreeCursor->restorePositionTo(_batchKeys[i], _batchLocs[i]);
+            _batchKeys.resize(i);
+            _batchLocs.resize(i);
+            checkEnd();
+            break;
+        }
+    }
+
     bool IndexScan::isEOF() {
         if (NULL == _indexCursor.get()) {
             // Have to call work() at least once.
             return false;
         }
 
+        // Anything batched up still has to be returned.
+        if (_batchNextToReturn < _batchKeys.size()) {
+            return false;
+        }
+
         // If there's a limit on how many keys we can scan, we may be EOF when we hit that.
         if (0 != _params.maxScan) {
             if (_specificStats.keysExamined >= _params.maxScan) {
@@ -218,6 +299,20 @@ namespace mongo {
         ++_commonStats.yields;
 
         if (isEOF() || (NULL == _indexCursor.get())) { return; }
+
+        if (_batchNextToReturn < _batchKeys.size()) {
+            // We're mid-batch and the cursor is already past the batched keys.  Put it back
+            // on the first key we haven't returned so the usual save/restore machinery
+            // resumes from there; the batched DiskLocs could be invalidated during the
+            // yield, so we can't keep serving them afterwards.
+            verify(NULL != _btreeCursor);
+            _btreeCursor->restorePositionTo(_batchKeys[_batchNextToReturn],
+                                            _batchLocs[_batchNextToReturn]);
+            _batchKeys.clear();
+            _batchLocs.clear();
+            _batchNextToReturn = 0;
+        }
+
         _savedKey = _indexCursor->getKey().getOwned();
         _savedLoc = _indexCursor->getValue();
         _indexCursor->savePosition();
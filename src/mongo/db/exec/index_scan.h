@@ -35,6 +35,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/index_bounds.h"
+#include "mongo/db/stats/index_usage.h"
 #include "mongo/platform/unordered_set.h"
 
 namespace mongo {
@@ -85,7 +86,7 @@ namespace mongo {
         IndexScan(const IndexScanParams& params, WorkingSet* workingSet,
                   const MatchExpression* filter);
 
-        virtual ~IndexScan() { }
+        virtual ~IndexScan();
 
         virtual StageState work(WorkingSetID* out);
         virtual bool isEOF();
@@ -104,6 +105,14 @@ namespace mongo {
         /** See if the cursor is pointing at or past _endKey, if _endKey is non-empty. */
         void checkEnd();
 
+        /**
+         * Pull a batch of keys out of the btree cursor's current leaf bucket in one go and
+         * validate them against the bounds, leaving the cursor on the first key that needs
+         * the usual skip/done handling.  Assumes we're using the "fast" btree navigation
+         * and the cursor points at a key already validated by checkEnd().
+         */
+        void fillBatch();
+
         // The WorkingSet we annotate with results.  Not owned by us.
         WorkingSet* _workingSet;
 
@@ -141,9 +150,20 @@ namespace mongo {
         vector<const BSONElement*> _keyElts;
         vector<bool> _keyEltsInc;
 
+        // Keys batched up from the index, served one per work() call; entries at index
+        // _batchNextToReturn and beyond haven't been returned yet.  Flushed before any
+        // yield so the DiskLocs can't go stale under us.
+        vector<BSONObj> _batchKeys;
+        vector<DiskLoc> _batchLocs;
+        size_t _batchNextToReturn;
+
         // Stats
         CommonStats _commonStats;
         IndexScanStats _specificStats;
+
+        // Always-on usage counters for the index; the scan's totals are flushed here
+        // once, at destruction, so the per-key path stays untouched.
+        IndexUsageTracker::StatsPtr _usageStats;
     };
 
 }  // namespace mongo
@@ -28,6 +28,7 @@
 
 #include "mongo/db/exec/projection_exec.h"
 
+#include "mongo/bson/bson_field_index.h"
 #include "mongo/db/exec/working_set_computed_data.h"
 #include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/matcher/expression.h"
@@ -46,7 +47,8 @@ namespace mongo {
           _hasNonSimple(false),
           _hasDottedField(false),
           _queryExpression(NULL),
-          _hasReturnKey(false) { }
+          _hasReturnKey(false),
+          _rangeCopyAllowed(false) { }
 
 
     ProjectionExec::ProjectionExec(const BSONObj& spec, const MatchExpression* queryExpression)
@@ -60,7 +62,8 @@ namespace mongo {
           _hasNonSimple(false),
           _hasDottedField(false),
           _queryExpression(queryExpression),
-          _hasReturnKey(false) {
+          _hasReturnKey(false),
+          _rangeCopyAllowed(false) {
 
         // Are we including or excluding fields?
         // -1 when we haven't initialized it.
@@ -172,6 +175,15 @@ namespace mongo {
                 _arrayOpType = ARRAY_OP_POSITIONAL;
             }
         }
+
+        // If every spec entry keeps or drops a whole top-level field ($slice, $elemMatch, $meta
+        // and dotted paths all set one of the flags below), transform can copy runs of retained
+        // fields out of the source buffer wholesale instead of appending element by element.
+        _rangeCopyAllowed = !_special
+                            && !_hasNonSimple
+                            && !_hasDottedField
+                            && _matchers.empty()
+                            && ARRAY_OP_NORMAL == _arrayOpType;
     }
 
     ProjectionExec::~ProjectionExec() {
@@ -359,9 +371,49 @@ namespace mongo {
         return Status::OK();
     }
 
+    void ProjectionExec::transformRangeCopy(const BSONObj& in, BSONObjBuilder* bob) const {
+        dassert(_rangeCopyAllowed);
+
+        // Start of the current run of consecutive kept elements, NULL if not in a run.
+        const char* runStart = NULL;
+
+        BSONObjIterator it(in);
+        while (it.more()) {
+            BSONElement elt = it.next();
+
+            bool keep;
+            if (mongoutils::str::equals("_id", elt.fieldName())) {
+                keep = _includeID;
+            }
+            else {
+                FieldMap::const_iterator field = _fields.find(elt.fieldName());
+                keep = (_fields.end() == field) ? _include : field->second->_include;
+            }
+
+            if (keep) {
+                if (NULL == runStart) {
+                    runStart = elt.rawdata();
+                }
+            }
+            else if (NULL != runStart) {
+                bob->bb().appendBuf(runStart, elt.rawdata() - runStart);
+                runStart = NULL;
+            }
+        }
+
+        if (NULL != runStart) {
+            // The last element ends just before the object's trailing EOO byte.
+            bob->bb().appendBuf(runStart, in.objdata() + in.objsize() - 1 - runStart);
+        }
+    }
+
     Status ProjectionExec::transform(const BSONObj& in,
                                      BSONObjBuilder* bob,
                                      const MatchDetails* details) const {
+        if (_rangeCopyAllowed) {
+            transformRangeCopy(in, bob);
+            return Status::OK();
+        }
 
         const ArrayOpType& arrayOpType = _arrayOpType;
 
@@ -406,18 +458,22 @@ namespace mongo {
                 BSONArrayBuilder arrBuilder;
                 BSONObjBuilder subBob;
 
-                if (in.getField(elt.fieldName()).eoo()) {
+                // index the outer doc so the repeated lookups below don't rescan it
+                BSONFieldIndex inIndex(in);
+                BSONElement matched = inIndex.getField(elt.fieldName());
+                if (matched.eoo()) {
                     return Status(ErrorCodes::InternalError,
                                   "$elemMatch called on document element with eoo");
                 }
 
-                if (in.getField(elt.fieldName()).Obj().getField(arrayDetails.elemMatchKey()).eoo()) {
+                BSONElement matchedArrayElt =
+                    matched.Obj().getField(arrayDetails.elemMatchKey());
+                if (matchedArrayElt.eoo()) {
                     return Status(ErrorCodes::InternalError,
                                   "$elemMatch called on array element with eoo");
                 }
 
-                arrBuilder.append(
-                    in.getField(elt.fieldName()).Obj().getField(arrayDetails.elemMatchKey()));
+                arrBuilder.append(matchedArrayElt);
                 subBob.appendArray(matcher->first, arrBuilder.arr());
                 Status status = append(bob, subBob.done().firstElement(), details, arrayOpType);
                 if (!status.isOK()) {
@@ -117,6 +117,14 @@ namespace mongo {
                          BSONObjBuilder* bob,
                          const MatchDetails* details = NULL) const;
 
+        /**
+         * Fast path for transform(...) above when the projection is a simple top-level
+         * inclusion/exclusion: one pass over 'in', copying each maximal run of consecutive
+         * kept elements with a single buffer copy instead of re-appending element by element.
+         * Only called when '_rangeCopyAllowed'.
+         */
+        void transformRangeCopy(const BSONObj& in, BSONObjBuilder* bob) const;
+
         /**
          * See transform(...) above.
          */
@@ -187,6 +195,10 @@ namespace mongo {
         // Do we have a returnKey projection?  If so we *only* output the index key metadata.  If
         // it's not found we output nothing.
         bool _hasReturnKey;
+
+        // True if the projection only keeps or drops whole top-level fields, so transform can
+        // use transformRangeCopy above.  Computed once at the end of parsing.
+        bool _rangeCopyAllowed;
     };
 
 }  // namespace mongo
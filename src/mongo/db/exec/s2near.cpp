@@ -30,7 +30,7 @@
 
 #include "mongo/db/client.h"
 #include "mongo/db/database.h"
-#include "mongo/db/exec/fetch.h"
+#include "mongo/db/exec/filter.h"
 #include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/working_set_common.h"
 #include "mongo/db/exec/working_set_computed_data.h"
@@ -40,6 +40,12 @@
 
 namespace mongo {
 
+    namespace {
+        // Sentinel stored in the seen-distance map for documents that were rejected
+        // (filtered out or without geometry) and must never be returned.
+        const double kRejectedDistance = -1.0;
+    }
+
     S2NearStage::S2NearStage(const S2NearParams& params, WorkingSet* ws) {
         _initted = false;
         _params = params;
@@ -208,10 +214,10 @@ namespace mongo {
 
         params.bounds = _params.baseBounds;
         params.direction = 1;
-        IndexScan* scan = new IndexScan(params, _ws, NULL);
 
-        // Owns 'scan'.
-        _child.reset(new FetchStage(_ws, scan, _params.filter));
+        // We drive the ixscan directly (no fetch child) so documents already
+        // evaluated in an earlier annulus can be skipped before they are fetched.
+        _child.reset(new IndexScan(params, _ws, NULL));
     }
 
     PlanStage::StageState S2NearStage::addResultToQueue(WorkingSetID* out) {
@@ -237,22 +243,48 @@ namespace mongo {
         // Nothing to do unless we advance.
         if (PlanStage::ADVANCED != state) { return state; }
 
-        // TODO Speed improvements:
-        //
-        // 0. Modify fetch to preserve key data and test for intersection w/annulus.
-        //
-        // 1. keep track of what we've seen in this scan and possibly ignore it.
-        //
-        // 2. keep track of results we've returned before and ignore them.
-
         WorkingSetMember* member = _ws->get(*out);
-        // Must have an object in order to get geometry out of it.
-        verify(member->hasObj());
+        verify(member->hasLoc());
+        const DiskLoc loc = member->loc;
+
+        // Annulus coverings overlap, so we may have evaluated this document already.
+        SeenDistanceMap::const_iterator seenIt = _seenDistance.find(loc);
+        const bool seenBefore = (seenIt != _seenDistance.end());
+        if (seenBefore) {
+            double cachedDistance = seenIt->second;
+
+            // Previously rejected, or its annulus hasn't come up yet (or already
+            // went by, meaning we returned it).  Skip it without fetching.
+            if (cachedDistance < 0 || !distanceInCurrentAnnulus(cachedDistance)) {
+                _ws->free(*out);
+                return PlanStage::NEED_TIME;
+            }
+        }
+
+        // The child is a bare ixscan, so we fetch the document ourselves.
+        if (!member->hasObj()) {
+            member->obj = member->loc.obj();
+            member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+        }
+
+        // Apply the filter on first evaluation only; a cached non-negative distance
+        // means the document already passed it.
+        if (!seenBefore && NULL != _params.filter) {
+            if (!Filter::passes(member, _params.filter)) {
+                _seenDistance[loc] = kRejectedDistance;
+                _ws->free(*out);
+                return PlanStage::NEED_TIME;
+            }
+        }
 
         // Get all the fields with that name from the document.
         BSONElementSet geom;
         member->obj.getFieldsDotted(_params.nearQuery.field, geom, false);
-        if (geom.empty()) {return PlanStage::NEED_TIME; }
+        if (geom.empty()) {
+            _seenDistance[loc] = kRejectedDistance;
+            _ws->free(*out);
+            return PlanStage::NEED_TIME;
+        }
 
         // Some value that any distance we can calculate will be less than.
         double minDistance = numeric_limits<double>::max();
@@ -273,10 +305,13 @@ namespace mongo {
             }
         }
 
+        if (!seenBefore) {
+            _seenDistance[loc] = minDistance;
+        }
+
         // If the distance to the doc satisfies our distance criteria, add it to our buffered
         // results.
-        if (minDistance >= _innerRadius &&
-            (_outerRadiusInclusive ? minDistance <= _outerRadius : minDistance < _outerRadius)) {
+        if (distanceInCurrentAnnulus(minDistance)) {
             _results.push(Result(*out, minDistance));
             if (_params.addDistMeta) {
                 member->addComputed(new GeoDistanceComputedData(minDistance));
@@ -288,6 +323,11 @@ namespace mongo {
                 _invalidationMap[member->loc] = *out;
             }
         }
+        else {
+            // Not in this annulus; the cached distance lets the annulus it does
+            // belong to skip straight to the fetch.
+            _ws->free(*out);
+        }
 
         return PlanStage::NEED_TIME;
     }
@@ -320,6 +360,10 @@ namespace mongo {
             verify(!member->hasLoc());
             _invalidationMap.erase(it);
         }
+
+        // A DiskLoc can be reused after an invalidation, so any cached distance for
+        // it is no longer meaningful.
+        _seenDistance.erase(dl);
     }
 
     bool S2NearStage::isEOF() {
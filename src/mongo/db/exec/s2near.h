@@ -37,6 +37,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/matcher/expression.h"
 #include "mongo/db/query/index_bounds.h"
+#include "mongo/platform/unordered_map.h"
 #include "mongo/platform/unordered_set.h"
 #include "third_party/s2/s2cap.h"
 #include "third_party/s2/s2regionintersection.h"
@@ -80,6 +81,12 @@ namespace mongo {
         StageState addResultToQueue(WorkingSetID* out);
         void nextAnnulus();
 
+        // Is a computed distance inside the annulus we're currently searching?
+        bool distanceInCurrentAnnulus(double dist) const {
+            return dist >= _innerRadius &&
+                   (_outerRadiusInclusive ? dist <= _outerRadius : dist < _outerRadius);
+        }
+
         bool _worked;
 
         S2NearParams _params;
@@ -119,6 +126,15 @@ namespace mongo {
         // For fast invalidation.  Perhaps not worth it.
         unordered_map<DiskLoc, WorkingSetID, DiskLoc::Hasher> _invalidationMap;
 
+        // Annulus coverings overlap, so successive ixscans hand us documents we have
+        // already evaluated.  Remember each doc's computed min distance (or a negative
+        // value for docs rejected by the filter / without geometry) so re-encounters
+        // skip the fetch, filter, and distance computation until the doc's own
+        // annulus comes up.  Entries are erased on invalidation since a DiskLoc can
+        // be reused.
+        typedef unordered_map<DiskLoc, double, DiskLoc::Hasher> SeenDistanceMap;
+        SeenDistanceMap _seenDistance;
+
         // Geo-related variables.
         // At what min distance (arc length) do we start looking for results?
         double _minDistance;
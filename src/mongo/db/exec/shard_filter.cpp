@@ -35,7 +35,11 @@ namespace mongo {
     ShardFilterStage::ShardFilterStage(const CollectionMetadataPtr& metadata,
                                        WorkingSet* ws,
                                        PlanStage* child)
-        : _ws(ws), _child(child), _metadata(metadata) { }
+        : _ws(ws), _child(child), _metadata(metadata) {
+        if (_metadata) {
+            _keyPattern.reset(new KeyPattern(_metadata->getKeyPattern()));
+        }
+    }
 
     ShardFilterStage::~ShardFilterStage() { }
 
@@ -53,12 +57,10 @@ namespace mongo {
             // If we're sharded make sure that we don't return any data that hasn't been migrated
             // off of our shared yet.
             if (_metadata) {
-                KeyPattern kp(_metadata->getKeyPattern());
-
                 WorkingSetMember* member = _ws->get(*out);
 
                 // This performs excessive BSONObj creation but that's OK for now.
-                if (!_metadata->keyBelongsToMe(kp.extractSingleKey(member->obj))) {
+                if (!_metadata->keyBelongsToMe(_keyPattern->extractSingleKey(member->obj))) {
                     _ws->free(*out);
                     ++_specificStats.chunkSkips;
                     return PlanStage::NEED_TIME;
@@ -35,6 +35,7 @@
 #include "mongo/db/index/btree_key_generator.h"
 #include "mongo/db/query/lite_parsed_query.h"
 #include "mongo/db/query/query_planner.h"
+#include "mongo/db/storage_options.h"
 
 namespace {
 
@@ -60,6 +61,33 @@ namespace mongo {
 
     const size_t kMaxBytes = 32 * 1024 * 1024;
 
+    namespace {
+
+        /**
+         * Orders (sort key, spilled doc) pairs the same way WorkingSetComparator orders the
+         * in-memory buffer: by sort key according to the pattern, with DiskLoc breaking ties.
+         */
+        class SpilledDocComparator {
+        public:
+            typedef std::pair<BSONObj, SortStageSpilledDoc> Data;
+
+            SpilledDocComparator(const BSONObj& pattern) : _pattern(pattern) { }
+
+            int operator()(const Data& lhs, const Data& rhs) const {
+                // False means ignore field names.
+                int result = lhs.first.woCompare(rhs.first, _pattern, false);
+                if (0 != result) {
+                    return result;
+                }
+                return lhs.second.loc.compare(rhs.second.loc);
+            }
+
+        private:
+            BSONObj _pattern;
+        };
+
+    }  // namespace
+
     SortStageKeyGenerator::SortStageKeyGenerator(const BSONObj& sortSpec, const BSONObj& queryObj) {
         _hasBounds = false;
         _sortHasMeta = false;
@@ -258,11 +286,18 @@ namespace mongo {
         }
     }
 
-    SortStage::WorkingSetComparator::WorkingSetComparator(BSONObj p) : pattern(p) { }
+    SortStage::WorkingSetComparator::WorkingSetComparator(BSONObj p)
+        : pattern(p), ordering(Ordering::make(p)) { }
 
     bool SortStage::WorkingSetComparator::operator()(const SortableDataItem& lhs, const SortableDataItem& rhs) const {
-        // False means ignore field names.
-        int result = lhs.sortKey.woCompare(rhs.sortKey, pattern, false);
+        int result;
+        if (lhs.packedKey.isValid() && rhs.packedKey.isValid()) {
+            result = lhs.packedKey.compare(rhs.packedKey, ordering);
+        }
+        else {
+            // False means ignore field names.
+            result = lhs.sortKey.woCompare(rhs.sortKey, pattern, false);
+        }
         if (0 != result) {
             return result < 0;
         }
@@ -287,7 +322,13 @@ namespace mongo {
     bool SortStage::isEOF() {
         // We're done when our child has no more results, we've sorted the child's results, and
         // we've returned all sorted results.
-        return _child->isEOF() && _sorted && (_data.end() == _resultIterator);
+        if (!_child->isEOF() || !_sorted) {
+            return false;
+        }
+        if (NULL != _extIterator) {
+            return !_extIterator->more();
+        }
+        return _data.end() == _resultIterator;
     }
 
     PlanStage::StageState SortStage::work(WorkingSetID* out) {
@@ -306,8 +347,15 @@ namespace mongo {
             return PlanStage::NEED_TIME;
         }
 
-        if (_memUsage > kMaxBytes) {
-            return PlanStage::FAILURE;
+        if (_memUsage > kMaxBytes && NULL == _extSorter) {
+            // An unlimited sort can finish on disk.  A limited sort's buffer is already
+            // bounded by the limit so overflowing it means the limit itself is huge; and a
+            // $meta sort's text scores live in WorkingSet computed data, which a spilled
+            // document loses.  Those still fail as before.
+            if (0 != _limit || _sortKeyGen->sortHasMeta()) {
+                return PlanStage::FAILURE;
+            }
+            spillToDisk();
         }
 
         if (isEOF()) { return PlanStage::IS_EOF; }
@@ -318,39 +366,57 @@ namespace mongo {
             StageState code = _child->work(&id);
 
             if (PlanStage::ADVANCED == code) {
-                // Add it into the map for quick invalidation if it has a valid DiskLoc.
-                // A DiskLoc may be invalidated at any time (during a yield).  We need to get into
-                // the WorkingSet as quickly as possible to handle it.
                 WorkingSetMember* member = _ws->get(id);
 
                 // Planner must put a fetch before we get here.
                 verify(member->hasObj());
 
-                // TODO: This should always be true...?
-                if (member->hasLoc()) {
-                    _wsidByDiskLoc[member->loc] = id;
-                }
-
-
                 // The data remains in the WorkingSet and we wrap the WSID with the sort key.
                 SortableDataItem item;
                 item.sortKey = _sortKeyGen->getSortKey(*member);
+                item.packedKey = PackedSortKey(item.sortKey);
                 item.wsid = id;
                 if (member->hasLoc()) {
                     // The DiskLoc breaks ties when sorting two WSMs with the same sort key.
                     item.loc = member->loc;
                 }
 
-                addToBuffer(item);
+                if (NULL != _extSorter) {
+                    // Once we've spilled, everything goes into the Sorter as an owned copy
+                    // and the WSM is given back right away, so there's nothing for
+                    // invalidate() to fix up.
+                    _extSorter->add(item.sortKey.getOwned(),
+                                    SortStageSpilledDoc(member->obj.getOwned(), item.loc));
+                    _ws->free(id);
+                }
+                else {
+                    // Add it into the map for quick invalidation if it has a valid DiskLoc.
+                    // A DiskLoc may be invalidated at any time (during a yield).  We need to
+                    // get into the WorkingSet as quickly as possible to handle it.
+                    // TODO: This should always be true...?
+                    if (member->hasLoc()) {
+                        _wsidByDiskLoc[member->loc] = id;
+                    }
+
+                    addToBuffer(item);
+                }
 
                 ++_commonStats.needTime;
                 return PlanStage::NEED_TIME;
             }
             else if (PlanStage::IS_EOF == code) {
-                // TODO: We don't need the lock for this.  We could ask for a yield and do this work
-                // unlocked.  Also, this is performing a lot of work for one call to work(...)
-                sortBuffer();
-                _resultIterator = _data.begin();
+                if (NULL != _extSorter) {
+                    // Merge the spilled runs.  The iterator owns the spill files from here.
+                    _extIterator.reset(_extSorter->done());
+                    _extSorter.reset();
+                }
+                else {
+                    // TODO: We don't need the lock for this.  We could ask for a yield and do
+                    // this work unlocked.  Also, this is performing a lot of work for one call
+                    // to work(...)
+                    sortBuffer();
+                    _resultIterator = _data.begin();
+                }
                 _sorted = true;
                 ++_commonStats.needTime;
                 return PlanStage::NEED_TIME;
@@ -368,8 +434,25 @@ namespace mongo {
         }
 
         // Returning results.
-        verify(_resultIterator != _data.end());
         verify(_sorted);
+
+        if (NULL != _extIterator) {
+            // Results stream back from the merged spill files as owned objects.  The data the
+            // iterator hands out is only valid until the next call to next(), so copy out.
+            verify(_extIterator->more());
+            DocSorterIterator::Data data = _extIterator->next();
+
+            WorkingSetID id = _ws->allocate();
+            WorkingSetMember* member = _ws->get(id);
+            member->obj = data.second.doc.getOwned();
+            member->state = WorkingSetMember::OWNED_OBJ;
+            *out = id;
+
+            ++_commonStats.advanced;
+            return PlanStage::ADVANCED;
+        }
+
+        verify(_resultIterator != _data.end());
         *out = _resultIterator->wsid;
         _resultIterator++;
 
@@ -517,6 +600,31 @@ namespace mongo {
         }
     }
 
+    void SortStage::spillToDisk() {
+        verify(NULL == _extSorter);
+        verify(0 == _limit);
+
+        _extSorter.reset(DocSorter::make(
+                SortOptions().ExtSortAllowed()
+                             .TempDir(storageGlobalParams.dbpath + "/_tmp")
+                             .MaxMemoryUsageBytes(kMaxBytes),
+                SpilledDocComparator(_sortKeyGen->getSortComparator())));
+
+        // Hand everything buffered so far to the Sorter as owned copies and give the
+        // WorkingSetMembers back.  The Sorter may buffer adds until it has a run's worth, and
+        // unowned objects can't be trusted across the yields in between.
+        for (vector<SortableDataItem>::iterator it = _data.begin(); it != _data.end(); ++it) {
+            WorkingSetMember* member = _ws->get(it->wsid);
+            _extSorter->add(it->sortKey.getOwned(),
+                            SortStageSpilledDoc(member->obj.getOwned(), it->loc));
+            _ws->free(it->wsid);
+        }
+
+        _data.clear();
+        _wsidByDiskLoc.clear();
+        _memUsage = 0;
+    }
+
     void SortStage::sortBuffer() {
         if (_limit == 0) {
             const WorkingSetComparator& cmp = *_sortKeyComparator;
@@ -537,3 +645,6 @@ namespace mongo {
     }
 
 }  // namespace mongo
+
+#include "mongo/db/sorter/sorter.cpp"
+MONGO_CREATE_SORTER(mongo::BSONObj, mongo::SortStageSpilledDoc, mongo::SpilledDocComparator);
@@ -38,6 +38,8 @@
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/query/index_bounds.h"
+#include "mongo/db/sort_key.h"
+#include "mongo/db/sorter/sorter.h"
 #include "mongo/platform/unordered_map.h"
 
 namespace mongo {
@@ -85,6 +87,11 @@ namespace mongo {
          */
         const BSONObj& getSortComparator() const { return _comparatorObj; }
 
+        /**
+         * Returns true if the sort spec. has any $meta expressions in it.
+         */
+        bool sortHasMeta() const { return _sortHasMeta; }
+
     private:
         BSONObj getBtreeKey(const BSONObj& memberObj) const;
 
@@ -124,6 +131,36 @@ namespace mongo {
         boost::scoped_ptr<IndexBoundsChecker> _boundsChecker;
     };
 
+    /**
+     * An owned copy of a document that SortStage has handed to the external Sorter, along
+     * with the DiskLoc it came from (null if it had none) so that sort key ties are broken
+     * the same way they are for the in-memory buffer.  Has the members the Sorter requires
+     * of its Value type; see sorter.h.
+     */
+    struct SortStageSpilledDoc {
+        SortStageSpilledDoc() { }
+        SortStageSpilledDoc(const BSONObj& d, DiskLoc l) : doc(d), loc(l) { }
+
+        BSONObj doc;
+        DiskLoc loc;
+
+        /// members for Sorter
+        struct SorterDeserializeSettings {}; // unused
+        void serializeForSorter(BufBuilder& buf) const {
+            doc.serializeForSorter(buf);
+            loc.serializeForSorter(buf);
+        }
+        static SortStageSpilledDoc deserializeForSorter(BufReader& buf,
+                                                        const SorterDeserializeSettings&) {
+            SortStageSpilledDoc out;
+            out.doc = BSONObj::deserializeForSorter(buf, BSONObj::SorterDeserializeSettings());
+            out.loc = DiskLoc::deserializeForSorter(buf, DiskLoc::SorterDeserializeSettings());
+            return out;
+        }
+        int memUsageForSorter() const { return sizeof(SortStageSpilledDoc) + doc.objsize(); }
+        SortStageSpilledDoc getOwned() const { return SortStageSpilledDoc(doc.getOwned(), loc); }
+    };
+
     /**
      * Sorts the input received from the child according to the sort pattern provided.
      *
@@ -184,6 +221,9 @@ namespace mongo {
         struct SortableDataItem {
             WorkingSetID wsid;
             BSONObj sortKey;
+            // The sort key packed into KeyV1 format so comparisons are byte-wise rather
+            // than element-by-element woCompare.  See PackedSortKey.
+            PackedSortKey packedKey;
             // Since we must replicate the behavior of a covered sort as much as possible we use the
             // DiskLoc to break sortKey ties.
             // See sorta.js.
@@ -193,13 +233,14 @@ namespace mongo {
         // Comparison object for data buffers (vector and set).
         // Items are compared on (sortKey, loc). This is also how the items are
         // ordered in the indices.
-        // Keys are compared using BSONObj::woCompare() with DiskLoc as a tie-breaker.
+        // Keys are compared on their packed KeyV1 form with DiskLoc as a tie-breaker.
         struct WorkingSetComparator {
             explicit WorkingSetComparator(BSONObj p);
 
             bool operator()(const SortableDataItem& lhs, const SortableDataItem& rhs) const;
 
             BSONObj pattern;
+            Ordering ordering;
         };
 
         /**
@@ -238,6 +279,28 @@ namespace mongo {
         typedef unordered_map<DiskLoc, WorkingSetID, DiskLoc::Hasher> DataMap;
         DataMap _wsidByDiskLoc;
 
+        //
+        // External sorting
+        //
+
+        /**
+         * Move everything buffered in '_data' into the external Sorter and route all further
+         * input there too.  Called when an unlimited sort blows through kMaxBytes; the Sorter
+         * spills sorted runs to disk under dbpath/_tmp and merges them when we're done.
+         */
+        void spillToDisk();
+
+        typedef Sorter<BSONObj, SortStageSpilledDoc> DocSorter;
+        typedef SortIteratorInterface<BSONObj, SortStageSpilledDoc> DocSorterIterator;
+
+        // Non-NULL iff we've spilled.  The Sorter holds owned copies of the documents, so the
+        // DiskLoc invalidation machinery above doesn't apply to anything we've handed to it.
+        boost::scoped_ptr<DocSorter> _extSorter;
+
+        // Iterates over the merged spill files once all input is consumed.  Results come back
+        // as OWNED_OBJ members.
+        boost::scoped_ptr<DocSorterIterator> _extIterator;
+
         //
         // Stats
         //
@@ -42,66 +42,60 @@ namespace mongo {
           _ftsMatcher(params.query, params.spec),
           _ws(ws),
           _filter(filter),
-          _filledOutResults(false),
-          _curResult(0) { }
+          _internalState(INIT_SCANS),
+          _currentIndexScanner(0) { }
 
     TextStage::~TextStage() { }
 
     bool TextStage::isEOF() {
-        // If we haven't filled out our results yet we can't be EOF.
-        if (!_filledOutResults) { return false; }
-
-        // We're EOF when we've returned all our results.
-        return _curResult >= _results.size();
+        return _internalState == DONE;
     }
 
     PlanStage::StageState TextStage::work(WorkingSetID* out) {
         ++_commonStats.works;
         if (isEOF()) { return PlanStage::IS_EOF; }
 
-        // Fill out our result queue.
-        if (!_filledOutResults) {
-            PlanStage::StageState ss = fillOutResults();
-            if (ss == PlanStage::IS_EOF || ss == PlanStage::FAILURE) {
-                return ss;
-            }
-            verify(ss == PlanStage::NEED_TIME);
+        switch (_internalState) {
+        case INIT_SCANS:
+            return initScans(out);
+        case READING_TERMS:
+            return readFromSubScanners(out);
+        case RETURNING_RESULTS:
+            return returnResults(out);
+        case DONE:
+            break;
         }
-
-        // Having cached all our results, return them one at a time.
-
-        // Fill out a WSM.
-        WorkingSetID id = _ws->allocate();
-        WorkingSetMember* member = _ws->get(id);
-        member->loc = _results[_curResult].loc;
-        member->obj = member->loc.obj();
-        member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
-        member->addComputed(new TextScoreComputedData(_results[_curResult].score));
-
-        // Advance to next result.
-        ++_curResult;
-        *out = id;
-        return PlanStage::ADVANCED;
+        return PlanStage::IS_EOF;
     }
 
     void TextStage::prepareToYield() {
         ++_commonStats.yields;
-        // TODO: When we incrementally read results, tell our sub-runners to yield.
+        for (size_t i = 0; i < _scanners.size(); ++i) {
+            _scanners.vector()[i]->prepareToYield();
+        }
     }
 
     void TextStage::recoverFromYield() {
         ++_commonStats.unyields;
-        // TODO: When we incrementally read results, tell our sub-runners to unyield.
+        for (size_t i = 0; i < _scanners.size(); ++i) {
+            _scanners.vector()[i]->recoverFromYield();
+        }
     }
 
     void TextStage::invalidate(const DiskLoc& dl) {
         ++_commonStats.invalidates;
-        // TODO: This is much slower than it should be.
-        for (size_t i = 0; i < _results.size(); ++i) {
-            if (dl == _results[i].loc) {
-                _results.erase(_results.begin() + i);
-                return;
+        for (size_t i = 0; i < _scanners.size(); ++i) {
+            _scanners.vector()[i]->invalidate(dl);
+        }
+
+        // Remove the doc from our scores; if we are mid-emission, step the cursor
+        // past it first.
+        ScoreMap::iterator scoreIt = _scores.find(dl);
+        if (scoreIt != _scores.end()) {
+            if (_internalState == RETURNING_RESULTS && scoreIt == _scoreIterator) {
+                ++_scoreIterator;
             }
+            _scores.erase(scoreIt);
         }
     }
 
@@ -112,22 +106,23 @@ namespace mongo {
         return ret.release();
     }
 
-    PlanStage::StageState TextStage::fillOutResults() {
+    PlanStage::StageState TextStage::initScans(WorkingSetID* out) {
         Database* db = cc().database();
         Collection* collection = db->getCollection( _params.ns );
         if (NULL == collection) {
             warning() << "TextStage params namespace error";
+            _internalState = DONE;
             return PlanStage::FAILURE;
         }
         vector<IndexDescriptor*> idxMatches;
         collection->getIndexCatalog()->findIndexByType("text", idxMatches);
         if (1 != idxMatches.size()) {
             warning() << "Expected exactly one text index";
+            _internalState = DONE;
             return PlanStage::FAILURE;
         }
 
         // Get all the index scans for each term in our query.
-        vector<IndexScan*> scanners;
         for (size_t i = 0; i < _params.query.getTerms().size(); i++) {
             const string& term = _params.query.getTerms()[i];
             IndexScanParams params;
@@ -139,72 +134,86 @@ namespace mongo {
             params.descriptor = idxMatches[0];
             params.forceBtreeAccessMethod = true;
             params.direction = -1;
-            IndexScan* ixscan = new IndexScan(params, _ws, NULL);
-            scanners.push_back(ixscan);
+            _scanners.mutableVector().push_back(new IndexScan(params, _ws, NULL));
         }
 
-        // For each index scan, read all results and store scores.
-        size_t currentIndexScanner = 0;
-        while (currentIndexScanner < scanners.size()) {
-            BSONObj keyObj;
-            DiskLoc loc;
+        _internalState = READING_TERMS;
+        return PlanStage::NEED_TIME;
+    }
 
-            WorkingSetID id;
-            PlanStage::StageState state = scanners[currentIndexScanner]->work(&id);
+    PlanStage::StageState TextStage::readFromSubScanners(WorkingSetID* out) {
+        // All scans drained?  Then every document's aggregate score is final and we
+        // can start emitting.
+        if (_currentIndexScanner >= _scanners.size()) {
+            _scoreIterator = _scores.begin();
+            _internalState = RETURNING_RESULTS;
+            return PlanStage::NEED_TIME;
+        }
 
-            if (PlanStage::ADVANCED == state) {
-                WorkingSetMember* wsm = _ws->get(id);
-                IndexKeyDatum& keyDatum = wsm->keyData.back();
-                filterAndScore(keyDatum.keyData, wsm->loc);
-                _ws->free(id);
-            }
-            else if (PlanStage::IS_EOF == state) {
-                // Done with this scan.
-                ++currentIndexScanner;
-            }
-            else if (PlanStage::NEED_FETCH == state) {
-                // We're calling work() on ixscans and they have no way to return a fetch.
-                verify(false);
-            }
-            else if (PlanStage::NEED_TIME == state) {
-                // We are a blocking stage, so ignore scanner's request for more time.
-            }
-            else {
-                verify(PlanStage::FAILURE == state);
-                warning() << "error from index scan during text stage: invalid FAILURE state";
-                for (size_t i=0; i<scanners.size(); ++i) { delete scanners[i]; }
-                return PlanStage::FAILURE;
-            }
+        WorkingSetID id;
+        PlanStage::StageState state = _scanners.vector()[_currentIndexScanner]->work(&id);
+
+        if (PlanStage::ADVANCED == state) {
+            WorkingSetMember* wsm = _ws->get(id);
+            IndexKeyDatum& keyDatum = wsm->keyData.back();
+            filterAndScore(keyDatum.keyData, wsm->loc);
+            _ws->free(id);
+            return PlanStage::NEED_TIME;
+        }
+        else if (PlanStage::IS_EOF == state) {
+            // Done with this scan; move to the next one.
+            ++_currentIndexScanner;
+            return PlanStage::NEED_TIME;
+        }
+        else if (PlanStage::NEED_TIME == state) {
+            return PlanStage::NEED_TIME;
+        }
+        else if (PlanStage::NEED_FETCH == state) {
+            // We're calling work() on ixscans and they have no way to return a fetch.
+            verify(false);
+            return PlanStage::NEED_TIME;
+        }
+        else {
+            verify(PlanStage::FAILURE == state);
+            warning() << "error from index scan during text stage: invalid FAILURE state";
+            _internalState = DONE;
+            return PlanStage::FAILURE;
         }
+    }
 
-        for (size_t i=0; i<scanners.size(); ++i) { delete scanners[i]; }
+    PlanStage::StageState TextStage::returnResults(WorkingSetID* out) {
+        if (_scoreIterator == _scores.end()) {
+            _internalState = DONE;
+            return PlanStage::IS_EOF;
+        }
 
-        // Filter for phrases and negative terms, score and truncate.
-        for (ScoreMap::iterator i = _scores.begin(); i != _scores.end(); ++i) {
-            DiskLoc loc = i->first;
-            double score = i->second;
+        DiskLoc loc = _scoreIterator->first;
+        double score = _scoreIterator->second;
+        ++_scoreIterator;
 
-            // Ignore non-matched documents.
-            if (score < 0) {
-                continue;
-            }
+        // Ignore documents a term scan rejected via the filter.
+        if (score < 0) {
+            return PlanStage::NEED_TIME;
+        }
 
-            // Filter for phrases and negated terms
-            if (_params.query.hasNonTermPieces()) {
-                if (!_ftsMatcher.matchesNonTerm(loc.obj())) {
-                    continue;
-                }
+        // Filter for phrases and negated terms only as results are requested, so a
+        // consumer that stops early never pays for the fetches these matches need.
+        if (_params.query.hasNonTermPieces()) {
+            if (!_ftsMatcher.matchesNonTerm(loc.obj())) {
+                return PlanStage::NEED_TIME;
             }
-
-            _results.push_back(ScoredLocation(loc, score));
         }
 
-        _filledOutResults = true;
+        // Fill out a WSM.
+        WorkingSetID id = _ws->allocate();
+        WorkingSetMember* member = _ws->get(id);
+        member->loc = loc;
+        member->obj = member->loc.obj();
+        member->state = WorkingSetMember::LOC_AND_UNOWNED_OBJ;
+        member->addComputed(new TextScoreComputedData(score));
 
-        if (_results.size() == 0) {
-            return PlanStage::IS_EOF;
-        }
-        return PlanStage::NEED_TIME;
+        *out = id;
+        return PlanStage::ADVANCED;
     }
 
     class TextMatchableDocument : public MatchableDocument {
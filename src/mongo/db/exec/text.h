@@ -28,7 +28,9 @@
 
 #pragma once
 
+#include "mongo/base/owned_pointer_vector.h"
 #include "mongo/db/diskloc.h"
+#include "mongo/db/exec/index_scan.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/fts/fts_index_format.h"
 #include "mongo/db/fts/fts_matcher.h"
@@ -72,7 +74,15 @@ namespace mongo {
     };
 
     /**
-     * Implements a blocking stage that returns text search results.
+     * Implements a stage that returns text search results.
+     *
+     * Note that the index scans must still be drained before the first result is
+     * returned (the keys are ordered by term and score, not by document, so a
+     * document's aggregate score is only known once every term scan has passed it),
+     * but the draining is done incrementally across work() calls and the per-result
+     * work - phrase/negation matching, fetching, emission - is done lazily as
+     * results are requested, so a consumer that stops early (e.g. a limit) never
+     * pays for candidates it does not read.
      *
      * Prerequisites: None; is a leaf node.
      * Output type: LOC_AND_OBJ_UNOWNED.
@@ -93,27 +103,27 @@ namespace mongo {
         PlanStageStats* getStats();
 
     private:
-        // A helper class used for sorting results by score.
-        struct ScoredLocation {
-            DiskLoc loc;
-            double score;
-
-            ScoredLocation() : loc(DiskLoc()), score(1.0) {}
-            ScoredLocation(const DiskLoc& d, double s) : loc(d), score(s) {}
-            ~ScoredLocation() {}
-
-            // Use descending order (highest-scored documents should appear first).
-            bool operator<(const ScoredLocation& rhs) const {
-                if (score != rhs.score) {
-                    return score > rhs.score;
-                }
-                return loc < rhs.loc;
-            }
+        // Current state of the stage's work() state machine.
+        enum State {
+            // 1. Open an index scan per query term.
+            INIT_SCANS,
+
+            // 2. Drain the term scans one key per work() call, aggregating scores
+            //    per document in _scores.
+            READING_TERMS,
+
+            // 3. Emit results from _scores one per work() call, applying the
+            //    phrase/negation matcher (and its fetch) lazily.
+            RETURNING_RESULTS,
+
+            // 4. Done.
+            DONE,
         };
 
-        // Helper for buffering results array.  Returns NEED_TIME (if any results were produced),
-        // IS_EOF, or FAILURE.
-        StageState fillOutResults();
+        // work() helpers, one per state.
+        StageState initScans(WorkingSetID* out);
+        StageState readFromSubScanners(WorkingSetID* out);
+        StageState returnResults(WorkingSetID* out);
 
         // Helper to update _scores with a new-found (term, score) pair for this document.  Also
         // rejects documents that don't match this stage's filter.
@@ -135,18 +145,21 @@ namespace mongo {
         CommonStats _commonStats;
         TextStats _specificStats;
 
-        // State bit for work().  True if results have been buffered.
-        bool _filledOutResults;
+        // What state is the state machine in?
+        State _internalState;
+
+        // One index scan per query term; owned here.
+        OwnedPointerVector<IndexScan> _scanners;
+
+        // The index scan currently being drained in READING_TERMS.
+        size_t _currentIndexScanner;
 
         // Map: diskloc -> aggregate score for doc.
         typedef unordered_map<DiskLoc, double, DiskLoc::Hasher> ScoreMap;
         ScoreMap _scores;
 
-        // Score-ordered result set of documents (as DiskLoc's).
-        std::vector<ScoredLocation> _results;
-
-        // The next result to return from work().
-        size_t _curResult;
+        // Position in _scores while in RETURNING_RESULTS.
+        ScoreMap::iterator _scoreIterator;
     };
 
 } // namespace mongo
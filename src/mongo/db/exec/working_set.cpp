@@ -35,23 +35,32 @@ namespace mongo {
     WorkingSet::MemberHolder::MemberHolder() : flagged(false), member(NULL) { }
     WorkingSet::MemberHolder::~MemberHolder() {}
 
-    WorkingSet::WorkingSet() : _freeList(INVALID_ID) { }
+    WorkingSet::WorkingSet() : _freeList(INVALID_ID), _slabUsed(0) { }
 
     WorkingSet::~WorkingSet() {
-        for (size_t i = 0; i < _data.size(); i++) {
-            delete _data[i].member;
+        // Members live in the slabs, not in _data.
+        for (size_t i = 0; i < _slabs.size(); i++) {
+            delete[] _slabs[i];
+        }
+    }
+
+    WorkingSetMember* WorkingSet::_allocateMember() {
+        if (_slabs.empty() || kMembersPerSlab == _slabUsed) {
+            _slabs.push_back(new WorkingSetMember[kMembersPerSlab]);
+            _slabUsed = 0;
         }
+        return &_slabs.back()[_slabUsed++];
     }
 
     WorkingSetID WorkingSet::allocate() {
         if (_freeList == INVALID_ID) {
-            // The free list is empty so we need to make a single new WSM to return. This relies on
+            // The free list is empty so we need to hand out a new WSM. This relies on
             // vector::resize being amortized O(1) for efficient allocation. Note that the free list
             // remains empty until something is returned by a call to free().
             WorkingSetID id = _data.size();
             _data.resize(_data.size() + 1);
             _data.back().nextFreeOrSelf = id;
-            _data.back().member = new WorkingSetMember();
+            _data.back().member = _allocateMember();
             return id;
         }
 
@@ -111,10 +111,15 @@ namespace mongo {
             // Free list link if freed. Points to self if in use.
             WorkingSetID nextFreeOrSelf;
             bool flagged;
-            // Owning pointer
+            // Points into a slab in _slabs; not owned here.
             WorkingSetMember* member;
         };
 
+        /**
+         * Carve the next member out of the current slab, starting a new slab if it's full.
+         */
+        WorkingSetMember* _allocateMember();
+
         // All WorkingSetIDs are indexes into this, except for INVALID_ID.
         // Elements are added to _freeList rather than removed when freed.
         vector<MemberHolder> _data;
@@ -123,6 +128,18 @@ namespace mongo {
         // link. INVALID_ID is the list terminator since 0 is a valid index.
         // If _freeList == INVALID_ID, the free list is empty and all elements in _data are in use.
         WorkingSetID _freeList;
+
+        // WorkingSetMembers are carved out of slabs of this many so that growing the working
+        // set doesn't pay a heap allocation per member.  Slabs are never moved or released
+        // until destruction, so member pointers handed out by get() stay stable; freed members
+        // are recycled through _freeList, not returned to their slab.
+        static const size_t kMembersPerSlab = 128;
+
+        // Slab storage, owned here.
+        std::vector<WorkingSetMember*> _slabs;
+
+        // How many members have been handed out from _slabs.back().
+        size_t _slabUsed;
     };
 
     /**
@@ -32,6 +32,7 @@
 
 #include "mongo/base/init.h"
 #include "mongo/db/fts/fts_index_format.h"
+#include "mongo/util/md5.hpp"
 #include "mongo/util/mongoutils/str.h"
 
 namespace mongo {
@@ -41,6 +42,13 @@ namespace mongo {
         namespace {
             BSONObj nullObj;
             BSONElement nullElt;
+
+            // terms longer than this are not stored verbatim in the btree key; they
+            // are replaced by a 32 character prefix plus the 32 character hex md5 of
+            // the whole term, so no key carries more than 64 bytes of term data
+            const size_t termKeyPrefixLength = 32U;
+            const size_t termKeySuffixLength = 32U;
+            const size_t termKeyLength = termKeyPrefixLength + termKeySuffixLength;
         }
 
         MONGO_INITIALIZER( FTSIndexFormat )( InitializerContext* context ) {
@@ -104,7 +112,8 @@ namespace mongo {
                     5 /* bson overhead */ +
                     10 /* weight */ +
                     8 /* term overhead */ +
-                    term.size() +
+                    /* term size (max 64 characters for long terms) */
+                    ( term.size() > termKeyLength ? termKeyLength : term.size() ) +
                     extraSize;
 
                 BSONObjBuilder b(guess); // builds a BSON object with guess length.
@@ -145,7 +154,18 @@ namespace mongo {
 
         void FTSIndexFormat::_appendIndexKey( BSONObjBuilder& b, double weight, const string& term ) {
             verify( weight >= 0 && weight <= MAX_WEIGHT ); // FTSmaxweight =  defined in fts_header
-            b.append( "", term );
+            if ( term.size() <= termKeyLength ) {
+                b.append( "", term );
+            }
+            else {
+                // bounded, deterministic surrogate for a long term: the prefix keeps
+                // ordering locality, the md5 suffix keeps distinct terms distinct;
+                // the query side builds keys through this same path, so index and
+                // seek keys always agree
+                string keySuffix = md5simpledigest( term );
+                verify( keySuffix.size() == termKeySuffixLength );
+                b.append( "", term.substr( 0, termKeyPrefixLength ) + keySuffix );
+            }
             b.append( "", weight );
         }
     }
@@ -115,6 +115,43 @@ namespace mongo {
             ASSERT_EQUALS( 1U, keys2.size() );
         }
 
+        TEST( FTSIndexFormat, LongWords1 ) {
+            FTSSpec spec( FTSSpec::fixSpec( BSON( "key" << BSON( "data" << "text" ) ) ) );
+
+            // two long terms sharing a prefix longer than the stored term prefix
+            string longPrefix( 100, '1' );
+            string term1 = longPrefix + "a";
+            string term2 = longPrefix + "b";
+
+            BSONObjSet keys;
+            FTSIndexFormat::getKeys( spec, BSON( "data" << term1 + " " + term2 ), &keys );
+            ASSERT_EQUALS( 2U, keys.size() );
+
+            // long terms are stored bounded (32 character prefix + 32 character hash)
+            // but remain distinct
+            BSONObjSet::const_iterator i = keys.begin();
+            string indexedTerm1 = i->firstElement().String();
+            ++i;
+            string indexedTerm2 = i->firstElement().String();
+            ASSERT_EQUALS( 64U, indexedTerm1.size() );
+            ASSERT_EQUALS( 64U, indexedTerm2.size() );
+            ASSERT_NOT_EQUALS( indexedTerm1, indexedTerm2 );
+
+            // the query side builds the same bounded surrogates (set ordering of the
+            // two keys depends on the hash suffix, so check membership of both)
+            string queryTerm1 =
+                FTSIndexFormat::getIndexKey( 1.0, term1, BSONObj() ).firstElement().String();
+            string queryTerm2 =
+                FTSIndexFormat::getIndexKey( 1.0, term2, BSONObj() ).firstElement().String();
+            ASSERT( queryTerm1 == indexedTerm1 || queryTerm1 == indexedTerm2 );
+            ASSERT( queryTerm2 == indexedTerm1 || queryTerm2 == indexedTerm2 );
+            ASSERT_NOT_EQUALS( queryTerm1, queryTerm2 );
+
+            // short terms are unaffected
+            BSONObj shortKey = FTSIndexFormat::getIndexKey( 1.0, "cat", BSONObj() );
+            ASSERT_EQUALS( string( "cat" ), shortKey.firstElement().String() );
+        }
+
 
     }
 }
@@ -60,7 +60,8 @@ namespace mongo {
             }
         }
 
-        FTSSpec::FTSSpec( const BSONObj& indexInfo ) {
+        FTSSpec::FTSSpec( const BSONObj& indexInfo )
+            : _stemmerCaches( new StemmerCacheMap() ) {
             massert( 16739, "found invalid spec for text index",
                      indexInfo["weights"].isABSONObj() );
 
@@ -146,14 +147,20 @@ namespace mongo {
             }
         }
 
+        const StemmerCache* FTSSpec::_stemmerFor( const FTSLanguage language ) const {
+            boost::shared_ptr<StemmerCache>& cache = (*_stemmerCaches)[language.str()];
+            if ( !cache )
+                cache.reset( new StemmerCache( language ) );
+            return cache.get();
+        }
+
         void FTSSpec::scoreDocument( const BSONObj& obj,
                                      const FTSLanguage parentLanguage,
                                      const string& parentPath,
                                      bool isArray,
                                      TermFrequencyMap* term_freqs ) const {
             const FTSLanguage language = getLanguageToUse( obj, parentLanguage );
-            Stemmer stemmer( language );
-            Tools tools( language, &stemmer, StopWords::getStopWords( language ) );
+            Tools tools( language, _stemmerFor( language ), StopWords::getStopWords( language ) );
 
             // Perform a depth-first traversal of obj, skipping fields not touched by this spec.
             BSONObjIterator j( obj );
@@ -252,17 +259,20 @@ namespace mongo {
 
             unsigned numTokens = 0;
 
+            // reused across tokens so lowercasing doesn't allocate per term
+            string termBuf;
+
             Tokenizer i( tools.language, raw );
             while ( i.more() ) {
                 Token t = i.next();
                 if ( t.type != Token::TEXT )
                     continue;
 
-                string term = t.data.toString();
-                makeLower( &term );
-                if ( tools.stopwords->isStopWord( term ) )
+                termBuf.assign( t.data.rawData(), t.data.size() );
+                makeLower( &termBuf );
+                if ( tools.stopwords->isStopWord( termBuf ) )
                     continue;
-                term = tools.stemmer->stem( term );
+                const string& term = tools.stemmer->stem( termBuf );
 
                 ScoreHelperStruct& data = terms[term];
 
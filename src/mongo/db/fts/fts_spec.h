@@ -34,6 +34,8 @@
 #include <vector>
 #include <string>
 
+#include <boost/shared_ptr.hpp>
+
 #include "mongo/db/fts/fts_language.h"
 #include "mongo/db/fts/fts_util.h"
 #include "mongo/db/fts/stemmer.h"
@@ -56,14 +58,14 @@ namespace mongo {
 
             struct Tools {
                 Tools( const FTSLanguage _language,
-                       const Stemmer* _stemmer,
+                       const StemmerCache* _stemmer,
                        const StopWords* _stopwords )
                     : language( _language )
                     , stemmer( _stemmer )
                     , stopwords( _stopwords ) {}
 
                 const FTSLanguage language;
-                const Stemmer* stemmer;
+                const StemmerCache* stemmer;
                 const StopWords* stopwords;
             };
 
@@ -115,6 +117,14 @@ namespace mongo {
                                TermFrequencyMap* term_freqs,
                                double weight ) const;
 
+            /**
+             * Returns this spec's caching stemmer for the given language, creating it
+             * on first use.  Keeping the stemmers (and their term -> stem caches) on
+             * the spec means the index's vocabulary is stemmed once, not once per
+             * document.  Not thread safe; see StemmerCache.
+             */
+            const StemmerCache* _stemmerFor( const FTSLanguage language ) const;
+
             FTSLanguage _defaultLanguage;
             string _languageOverrideField;
             bool _wildcard;
@@ -126,6 +136,11 @@ namespace mongo {
             // other fields to index
             std::vector<string> _extraBefore;
             std::vector<string> _extraAfter;
+
+            // caching stemmers, keyed by language; shared between copies of this spec
+            // so the cache follows the index wherever the spec travels
+            typedef std::map< std::string, boost::shared_ptr<StemmerCache> > StemmerCacheMap;
+            mutable boost::shared_ptr<StemmerCacheMap> _stemmerCaches;
         };
 
     }
@@ -66,6 +66,26 @@ namespace mongo {
             return string( (const char*)(sb_sym), sb_stemmer_length( _stemmer ) );
         }
 
+        namespace {
+            // when the cache reaches this many distinct terms it is flushed; real
+            // vocabularies are highly skewed, so hit rates recover almost immediately
+            // and the map cannot grow without bound on adversarial input
+            const size_t MAX_CACHED_TERMS = 10000;
+        }
+
+        const string& StemmerCache::stem( const std::string& word ) const {
+            unordered_map<string,string>::const_iterator it = _cache.find( word );
+            if ( it != _cache.end() )
+                return it->second;
+
+            if ( _cache.size() >= MAX_CACHED_TERMS )
+                _cache.clear();
+
+            string& cached = _cache[word];
+            cached = _stemmer.stem( word );
+            return cached;
+        }
+
     }
 
 }
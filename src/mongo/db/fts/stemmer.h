@@ -33,8 +33,11 @@
 
 #include <string>
 
+#include <boost/noncopyable.hpp>
+
 #include "mongo/base/string_data.h"
 #include "mongo/db/fts/fts_language.h"
+#include "mongo/platform/unordered_map.h"
 #include "third_party/libstemmer_c/include/libstemmer.h"
 
 namespace mongo {
@@ -55,6 +58,28 @@ namespace mongo {
         private:
             struct sb_stemmer* _stemmer;
         };
+
+        /**
+         * a Stemmer fronted by a bounded term -> stem cache
+         * snowball stemming dominates text index maintenance and real corpora reuse
+         * a small vocabulary, so repeated terms are answered out of the cache
+         * not thread safe: callers (index maintenance) are serialized by the
+         * database write lock
+         */
+        class StemmerCache : boost::noncopyable {
+        public:
+            StemmerCache( const FTSLanguage language ) : _stemmer( language ) {}
+
+            /**
+             * returned reference is valid until the next call
+             */
+            const std::string& stem( const std::string& word ) const;
+
+            size_t numCachedTerms() const { return _cache.size(); }
+        private:
+            Stemmer _stemmer;
+            mutable unordered_map<std::string,std::string> _cache;
+        };
     }
 }
 
@@ -42,5 +42,16 @@ namespace mongo {
             ASSERT_EQUALS( "Run", s.stem( "Running" ) );
         }
 
+        TEST( English, StemmerCache1 ) {
+            StemmerCache c( FTSLanguage::makeFTSLanguage( "english" ).getValue() );
+            ASSERT_EQUALS( "run", c.stem( "running" ) );
+            ASSERT_EQUALS( 1U, c.numCachedTerms() );
+            // repeated terms are answered out of the cache, not re-stemmed
+            ASSERT_EQUALS( "run", c.stem( "running" ) );
+            ASSERT_EQUALS( 1U, c.numCachedTerms() );
+            ASSERT_EQUALS( "walk", c.stem( "walking" ) );
+            ASSERT_EQUALS( 2U, c.numCachedTerms() );
+        }
+
     }
 }
@@ -33,6 +33,10 @@
 #include "mongo/db/geo/shapes.h"
 #include "mongo/util/mongoutils/str.h"
 
+#ifdef __BMI2__
+#include <immintrin.h>
+#endif
+
 // So we can get at the str namespace.
 using namespace mongoutils;
 
@@ -43,23 +47,13 @@ namespace mongo {
         return s;
     }
 
-    /* 
+    /*
      * GeoBitSets fills out various bit patterns that are used by GeoHash.
      * What patterns?  Look at the comments next to the fields.
-     * TODO(hk): hashedToNormal is still a bit of a mystery.
      */
     class GeoBitSets {
     public:
         GeoBitSets() {
-            for (unsigned i = 0; i < 16; i++) {
-                unsigned fixed = 0;
-                for (int j = 0; j < 4; j++) {
-                    if (i & (1 << j))
-                        fixed |= (1 << (j * 2));
-                }
-                hashedToNormal[fixed] = i;
-            }
-
             long long currAllX = 0, currAllY = 0;
             for (int i = 0; i < 64; i++){
                 long long thisBit = 1LL << (63 - i);
@@ -86,8 +80,6 @@ namespace mongo {
         // allY[2] = 5000000000000000
         // allY[3] = 5400000000000000
         long long allY[32];
-
-        unsigned hashedToNormal[256];
     };
 
     // Oh global variables.
@@ -106,6 +98,48 @@ namespace mongo {
         return 1LL << (63 - i);
     }
 
+    // Binary data is stored in some particular byte order, which is different from the
+    // hash's bit order, which is different still from the original coordinate bit
+    // order.  These spread/squash helpers only care about the hash's own convention:
+    // the i-th most significant bit of x lives at the (2i)-th most significant bit of
+    // the hash and the i-th most significant bit of y right below it at (2i)+1.  In
+    // terms of least significant positions that means bit j of x maps to hash bit
+    // (2j)+1 and bit j of y to hash bit 2j.
+
+    // Spread a 32-bit value so its bits occupy every other bit of a 64-bit value,
+    // starting at the least significant bit.  Five shift/mask rounds, each doubling
+    // the gap between occupied bit groups; this replaces a 32-iteration loop over
+    // individual bits.  With BMI2 a single PDEP does the whole spread.
+    inline static unsigned long long spreadBits32(unsigned val) {
+#ifdef __BMI2__
+        return _pdep_u64(val, 0x5555555555555555ULL);
+#else
+        unsigned long long v = val;
+        v = (v | (v << 16)) & 0x0000FFFF0000FFFFULL;
+        v = (v | (v << 8)) & 0x00FF00FF00FF00FFULL;
+        v = (v | (v << 4)) & 0x0F0F0F0F0F0F0F0FULL;
+        v = (v | (v << 2)) & 0x3333333333333333ULL;
+        v = (v | (v << 1)) & 0x5555555555555555ULL;
+        return v;
+#endif
+    }
+
+    // Inverse of spreadBits32: gather the even-position bits of a 64-bit value back
+    // into a 32-bit value.  With BMI2 this is a single PEXT.
+    inline static unsigned squashBits64(unsigned long long v) {
+#ifdef __BMI2__
+        return static_cast<unsigned>(_pext_u64(v, 0x5555555555555555ULL));
+#else
+        v &= 0x5555555555555555ULL;
+        v = (v | (v >> 1)) & 0x3333333333333333ULL;
+        v = (v | (v >> 2)) & 0x0F0F0F0F0F0F0F0FULL;
+        v = (v | (v >> 4)) & 0x00FF00FF00FF00FFULL;
+        v = (v | (v >> 8)) & 0x0000FFFF0000FFFFULL;
+        v = (v | (v >> 16)) & 0x00000000FFFFFFFFULL;
+        return static_cast<unsigned>(v);
+#endif
+    }
+
     /* This class maps an x,y coordinate pair to a hash value.
      * This should probably be renamed/generalized so that it's more of a planar hash,
      * and we also have a spherical hash, etc.
@@ -151,9 +185,9 @@ namespace mongo {
         verify(bits <= 32);
         _hash = 0;
         _bits = bits;
-        for (unsigned i = 0; i < bits; i++) {
-            if (isBitSet(x, i)) _hash |= mask64For(i * 2);
-            if (isBitSet(y, i)) _hash |= mask64For((i * 2) + 1);
+        if (bits > 0) {
+            _hash = static_cast<long long>((spreadBits32(x) << 1) | spreadBits32(y));
+            clearUnusedBits();
         }
     }
 
@@ -166,18 +200,10 @@ namespace mongo {
         clearUnusedBits();
     }
 
-    // TODO(hk): This is nasty and has no examples.
     void GeoHash::unhash_fast(unsigned *x, unsigned *y) const {
-        *x = 0;
-        *y = 0;
-        const char *c = reinterpret_cast<const char*>(&_hash);
-        for (int i = 0; i < 8; i++) {
-            unsigned t = (unsigned)(c[i]) & 0x55;
-            *y |= (geoBitSets.hashedToNormal[t] << (4 * i));
-
-            t = ((unsigned)(c[i]) >> 1) & 0x55;
-            *x |= (geoBitSets.hashedToNormal[t] << (4 * i));
-        }
+        unsigned long long hash = static_cast<unsigned long long>(_hash);
+        *x = squashBits64(hash >> 1);
+        *y = squashBits64(hash);
     }
 
     void GeoHash::unhash_slow(unsigned *x, unsigned *y) const {
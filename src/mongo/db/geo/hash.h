@@ -124,8 +124,10 @@ namespace mongo {
         void clearUnusedBits();
         // XXX: what does this do
         void _move(unsigned offset, int d);
-        // XXX: this is nasty and has no example
+        // De-interleave the hash with bit-parallel magic (or PEXT where available).
         void unhash_fast(unsigned *x, unsigned *y) const;
+        // De-interleave the hash one bit at a time.  Kept as the correctness
+        // reference for unhash_fast.
         void unhash_slow(unsigned *x, unsigned *y) const;
 
         long long _hash;
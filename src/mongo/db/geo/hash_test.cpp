@@ -83,4 +83,50 @@ namespace {
         string a = makeRandomBitString(13);
         ASSERT_THROWS(makeHash(a), mongo::UserException);
     }
+
+    TEST(GeoHash, HashAndUnhash) {
+        mongo::PseudoRandom random(12345);
+        for (int i = 0; i < 1000; ++i) {
+            unsigned x = random.nextInt32();
+            unsigned y = random.nextInt32();
+            GeoHash hash(x, y);
+            unsigned unhashedX, unhashedY;
+            hash.unhash(&unhashedX, &unhashedY);
+            ASSERT_EQUALS(x, unhashedX);
+            ASSERT_EQUALS(y, unhashedY);
+        }
+    }
+
+    TEST(GeoHash, HashBitOrder) {
+        // The i-th most significant bit of x must land at the (2i)-th most
+        // significant bit of the hash, and y's right below it.
+        unsigned x = 0x80000001;  // Most and least significant bits set.
+        unsigned y = 0;
+        GeoHash hash(x, y);
+        ASSERT_TRUE(hash.getBit(0));
+        ASSERT_FALSE(hash.getBit(1));
+        ASSERT_TRUE(hash.getBit(62));
+        ASSERT_FALSE(hash.getBit(63));
+        ASSERT_TRUE(hash.getBitX(0));
+        ASSERT_FALSE(hash.getBitY(0));
+        ASSERT_TRUE(hash.getBitX(31));
+
+        GeoHash swapped(y, x);
+        ASSERT_FALSE(swapped.getBit(0));
+        ASSERT_TRUE(swapped.getBit(1));
+        ASSERT_TRUE(swapped.getBitY(0));
+        ASSERT_FALSE(swapped.getBitX(0));
+        ASSERT_TRUE(swapped.getBitY(31));
+    }
+
+    TEST(GeoHash, UnhashRespectsPrecision) {
+        // Bits past the hash's precision must not leak into the unhashed values.
+        unsigned x = 0xFFFFFFFF;
+        unsigned y = 0xFFFFFFFF;
+        GeoHash hash(x, y, 8);
+        unsigned unhashedX, unhashedY;
+        hash.unhash(&unhashedX, &unhashedY);
+        ASSERT_EQUALS(0xFF000000U, unhashedX);
+        ASSERT_EQUALS(0xFF000000U, unhashedY);
+    }
 }
@@ -33,26 +33,48 @@
 */
 
 #include "mongo/db/hasher.h"
+
+#include <third_party/murmurhash3/MurmurHash3.h>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/util/startup_test.h"
 
 namespace mongo {
 
-    Hasher::Hasher( HashSeed seed ) : _seed( seed ) {
+    MD5Hasher::MD5Hasher( HashSeed seed ) : _seed( seed ) {
         md5_init( &_md5State );
         md5_append( &_md5State , reinterpret_cast< const md5_byte_t * >( & _seed ) , sizeof( _seed ) );
     }
 
-    void Hasher::addData( const void * keyData , size_t numBytes ) {
+    void MD5Hasher::addData( const void * keyData , size_t numBytes ) {
         md5_append( &_md5State , static_cast< const md5_byte_t * >( keyData ), numBytes );
     }
 
-    void Hasher::finish( HashDigest out ) {
+    void MD5Hasher::finish( HashDigest out ) {
         md5_finish( &_md5State , out );
     }
 
+    Murmur3Hasher::Murmur3Hasher( HashSeed seed ) : _seed( seed ) {
+    }
+
+    void Murmur3Hasher::addData( const void * keyData , size_t numBytes ) {
+        _buf.appendBuf( keyData , numBytes );
+    }
+
+    void Murmur3Hasher::finish( HashDigest out ) {
+        // The seed goes through murmur's own seed parameter rather than being
+        // prepended to the input as the md5 hasher does.
+        MurmurHash3_x64_128( _buf.buf() , _buf.len() ,
+                             static_cast<unsigned>( _seed ) , out );
+    }
+
     long long int BSONElementHasher::hash64( const BSONElement& e , HashSeed seed ){
-        scoped_ptr<Hasher> h( HasherFactory::createHasher( seed ) );
+        return hash64( e , seed , 0 );
+    }
+
+    long long int BSONElementHasher::hash64( const BSONElement& e , HashSeed seed ,
+                                             int hashVersion ){
+        scoped_ptr<Hasher> h( HasherFactory::createHasher( seed , hashVersion ) );
         recursiveHash( h.get() , e , false );
         HashDigest d;
         h->finish(d);
@@ -106,9 +128,10 @@ namespace mongo {
 
     struct HasherUnitTest : public StartupTest {
         void run() {
-            // Hard-coded check to ensure the hash function is consistent across platforms
+            // Hard-coded checks to ensure the hash functions are consistent across platforms
             BSONObj o = BSON( "check" << 42 );
             verify( BSONElementHasher::hash64( o.firstElement(), 0 ) == -944302157085130861LL );
+            verify( BSONElementHasher::hash64( o.firstElement(), 0, 1 ) == 8715208212397937794LL );
         }
     } hasherUnitTest;
 }
@@ -36,6 +36,7 @@
 
 #include "mongo/pch.h"
 #include "mongo/bson/bsonelement.h"
+#include "mongo/bson/util/builder.h"
 #include "mongo/util/md5.hpp"
 
 namespace mongo {
@@ -46,28 +47,61 @@ namespace mongo {
     class Hasher : private boost::noncopyable {
     public:
 
-        explicit Hasher( HashSeed seed );
-        ~Hasher() { };
+        virtual ~Hasher() { };
 
         //pointer to next part of input key, length in bytes to read
-        void addData( const void * keyData , size_t numBytes );
+        virtual void addData( const void * keyData , size_t numBytes ) = 0;
 
         //finish computing the hash, put the result in the digest
         //only call this once per Hasher
-        void finish( HashDigest out );
+        virtual void finish( HashDigest out ) = 0;
+    };
+
+    /* Hash function for HashVersion 0: md5, seeded by prepending the seed bytes.
+     * The only hash that existed before hashVersion was honored, so the default.
+     */
+    class MD5Hasher : public Hasher {
+    public:
+
+        explicit MD5Hasher( HashSeed seed );
+        virtual ~MD5Hasher() { };
+
+        virtual void addData( const void * keyData , size_t numBytes );
+        virtual void finish( HashDigest out );
 
     private:
         md5_state_t _md5State;
         HashSeed _seed;
     };
 
+    /* Hash function for HashVersion 1: murmur3 (x64, 128 bit), much cheaper per byte
+     * than md5.  Input is buffered until finish() since murmur3 is not a streaming
+     * hash; the buffered input is a single BSON element, so it stays small.
+     */
+    class Murmur3Hasher : public Hasher {
+    public:
+
+        explicit Murmur3Hasher( HashSeed seed );
+        virtual ~Murmur3Hasher() { };
+
+        virtual void addData( const void * keyData , size_t numBytes );
+        virtual void finish( HashDigest out );
+
+    private:
+        BufBuilder _buf;
+        HashSeed _seed;
+    };
+
     class HasherFactory : private boost::noncopyable  {
     public:
-        /* Eventually this may be a more sophisticated factory
-         * for creating other hashers, but for now use MD5.
+        /* Create a hasher for the given per-index HashVersion.
+         * Version 0 is md5, version 1 is murmur3.
          */
-        static Hasher* createHasher( HashSeed seed ) {
-            return new Hasher( seed );
+        static Hasher* createHasher( HashSeed seed , int hashVersion = 0 ) {
+            if ( 1 == hashVersion ) {
+                return new Murmur3Hasher( seed );
+            }
+            return new MD5Hasher( seed );
         }
 
     private:
@@ -100,6 +134,13 @@ namespace mongo {
          */
         static long long int hash64( const BSONElement& e , HashSeed seed );
 
+        /* As above, but selects the hash function by per-index "hashVersion":
+         * version 0 is the md5 hash computed by the two-argument overload, version 1
+         * is a much faster murmur3-based hash.  The version is persisted in the index
+         * spec, so existing indexes keep the hash they were built with.
+         */
+        static long long int hash64( const BSONElement& e , HashSeed seed , int hashVersion );
+
         /* This incrementally computes the hash of BSONElement "e"
          * using hash function "h".  If "includeFieldName" is true,
          * then the name of the field is hashed in between the type of
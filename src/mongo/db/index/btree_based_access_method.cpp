@@ -28,20 +28,24 @@
 
 #include "mongo/db/index/btree_access_method.h"
 
+#include <algorithm>
 #include <vector>
 
 #include "mongo/base/status.h"
+#include "mongo/db/catalog/index_catalog_entry.h"
 #include "mongo/db/extsort.h"
 #include "mongo/db/index/btree_index_cursor.h"
 #include "mongo/db/index/btree_interface.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/keypattern.h"
 #include "mongo/db/kill_current_op.h"
+#include "mongo/db/matcher/expression.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/db/pdfile_private.h"
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/sort_phase_one.h"
 #include "mongo/db/structure/btree/btreebuilder.h"
+#include "mongo/util/concurrency/thread_pool.h"
 
 namespace mongo {
 
@@ -52,6 +56,15 @@ namespace mongo {
         _interface = BtreeInterface::interfaces[_descriptor->version()];
     }
 
+    void BtreeBasedAccessMethod::computeKeys(const BSONObj& obj, BSONObjSet* keys) {
+        const MatchExpression* filter = _btreeState->getFilterExpression();
+        if ( filter && !filter->matchesBSON( obj ) ) {
+            // Documents outside a partial index's filter have no entries in it.
+            return;
+        }
+        getKeys(obj, keys);
+    }
+
     // Find the keys for obj, put them in the tree pointing to loc
     Status BtreeBasedAccessMethod::insert(const BSONObj& obj, const DiskLoc& loc,
             const InsertDeleteOptions& options, int64_t* numInserted) {
@@ -60,7 +73,7 @@ namespace mongo {
 
         BSONObjSet keys;
         // Delegate to the subclass.
-        getKeys(obj, &keys);
+        computeKeys(obj, &keys);
 
         Status ret = Status::OK();
 
@@ -127,7 +140,7 @@ namespace mongo {
         const InsertDeleteOptions &options, int64_t* numDeleted) {
 
         BSONObjSet keys;
-        getKeys(obj, &keys);
+        computeKeys(obj, &keys);
         *numDeleted = 0;
 
         for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
@@ -144,6 +157,70 @@ namespace mongo {
         return Status::OK();
     }
 
+    namespace {
+
+        // One doomed index entry; removeMany sorts these so the btree descents walk the
+        // tree in key order instead of hopping between unrelated buckets.
+        struct DoomedEntry {
+            BSONObj key;
+            DiskLoc loc;
+        };
+
+        class DoomedEntryComparator {
+        public:
+            DoomedEntryComparator(const BSONObj& keyPattern) : _keyPattern(keyPattern) {}
+            bool operator()(const DoomedEntry& l, const DoomedEntry& r) const {
+                int cmp = l.key.woCompare(r.key, _keyPattern, false);
+                if (cmp)
+                    return cmp < 0;
+                return l.loc < r.loc;
+            }
+        private:
+            BSONObj _keyPattern;
+        };
+
+    }
+
+    // Remove a batch of docs from the index, in key order.
+    Status BtreeBasedAccessMethod::removeMany(const std::vector<BSONObj>& objs,
+                                              const std::vector<DiskLoc>& locs,
+                                              const InsertDeleteOptions& options,
+                                              int64_t* numDeleted) {
+
+        verify(objs.size() == locs.size());
+        *numDeleted = 0;
+
+        std::vector<DoomedEntry> entries;
+        entries.reserve(objs.size());
+        for (size_t i = 0; i < objs.size(); i++) {
+            BSONObjSet keys;
+            computeKeys(objs[i], &keys);
+            for (BSONObjSet::const_iterator j = keys.begin(); j != keys.end(); ++j) {
+                DoomedEntry entry;
+                entry.key = *j;
+                entry.loc = locs[i];
+                entries.push_back(entry);
+            }
+        }
+
+        std::sort(entries.begin(), entries.end(),
+                  DoomedEntryComparator(_descriptor->keyPattern()));
+
+        for (std::vector<DoomedEntry>::const_iterator i = entries.begin();
+             i != entries.end(); ++i) {
+            bool thisKeyOK = removeOneKey(i->key, i->loc);
+
+            if (thisKeyOK) {
+                ++*numDeleted;
+            } else if (options.logIfError) {
+                log() << "unindex failed (key too big?) " << _descriptor->indexNamespace()
+                      << " key: " << i->key << " " << i->loc.obj()["_id"] << endl;
+            }
+        }
+
+        return Status::OK();
+    }
+
     // Return keys in l that are not in r.
     // Lifted basically verbatim from elsewhere.
     static void setDifference(const BSONObjSet &l, const BSONObjSet &r, vector<BSONObj*> *diff) {
@@ -185,7 +262,7 @@ namespace mongo {
 
     Status BtreeBasedAccessMethod::touch(const BSONObj& obj) {
         BSONObjSet keys;
-        getKeys(obj, &keys);
+        computeKeys(obj, &keys);
 
         for (BSONObjSet::const_iterator i = keys.begin(); i != keys.end(); ++i) {
             int unusedPos;
@@ -220,6 +297,14 @@ namespace mongo {
         verify( 0 );
     }
 
+    BSONObj BtreeBasedAccessMethod::approxKeyAtFraction( double fraction ) const {
+        return _interface->approxKeyAtFraction( _btreeState, _btreeState->head(), fraction );
+    }
+
+    double BtreeBasedAccessMethod::approxFractionOfKey( const BSONObj& key ) const {
+        return _interface->approxFractionOfKey( _btreeState, _btreeState->head(), key );
+    }
+
 
     Status BtreeBasedAccessMethod::validate(int64_t* numKeys) {
         *numKeys = _interface->fullValidate(_btreeState,
@@ -235,8 +320,8 @@ namespace mongo {
         BtreeBasedPrivateUpdateData *data = new BtreeBasedPrivateUpdateData();
         status->_indexSpecificUpdateData.reset(data);
 
-        getKeys(from, &data->oldKeys);
-        getKeys(to, &data->newKeys);
+        computeKeys(from, &data->oldKeys);
+        computeKeys(to, &data->newKeys);
         data->loc = record;
         data->dupsAllowed = options.dupsAllowed;
 
@@ -303,7 +388,15 @@ namespace mongo {
 
     class BtreeBulk : public IndexAccessMethod {
     public:
-        BtreeBulk( BtreeBasedAccessMethod* real ) {
+        // key generation is CPU bound on large compound indexes, so batch the scanned
+        // docs and extract keys on several threads.  the sorter is still fed in scan
+        // order on the build thread, so BtreeBuilder::addKey sees fully ordered input.
+        enum { BatchDocs = 4096, KeyGenSlices = 4 };
+
+        BtreeBulk( BtreeBasedAccessMethod* real )
+            : _keyGenPool( KeyGenSlices - 1 ),
+              _batchErrMutex( "BtreeBulk" ),
+              _batchErrCode( 0 ) {
             _real = real;
         }
 
@@ -313,14 +406,58 @@ namespace mongo {
                               const DiskLoc& loc,
                               const InsertDeleteOptions& options,
                               int64_t* numInserted) {
-            BSONObjSet keys;
-            _real->getKeys(obj, &keys);
-            _phase1.addKeys(keys, loc, false);
-            if ( numInserted )
-                *numInserted += keys.size();
+            if ( _real->_btreeState->descriptor()->dropDups() || inDBRepair ) {
+                // with dropDups the caller deletes the offending doc when key
+                // generation asserts, so errors must surface per document: stay
+                // synchronous
+                BSONObjSet keys;
+                _real->computeKeys(obj, &keys);
+                _phase1.addKeys(keys, loc, false);
+                if ( numInserted )
+                    *numInserted += keys.size();
+                return Status::OK();
+            }
+
+            _batchObjs.push_back(obj);
+            _batchLocs.push_back(loc);
+            if ( _batchObjs.size() >= BatchDocs )
+                flushBatch();
             return Status::OK();
         }
 
+        /** generate keys for any batched docs and feed them to the sorter.
+            called between batches and once more before the sorter is sorted. */
+        void flushBatch() {
+            const size_t n = _batchObjs.size();
+            if ( n == 0 )
+                return;
+
+            _batchKeys.clear();
+            _batchKeys.resize( n );
+            _batchErrCode = 0;
+
+            const size_t per = ( n + KeyGenSlices - 1 ) / KeyGenSlices;
+            for ( size_t s = 1; s < KeyGenSlices && s * per < n; s++ ) {
+                _keyGenPool.schedule( boost::bind( &BtreeBulk::_generateKeysForSlice,
+                                                   this,
+                                                   s * per,
+                                                   std::min( ( s + 1 ) * per, n ) ) );
+            }
+            _generateKeysForSlice( 0, std::min( per, n ) );
+            _keyGenPool.join();
+
+            // scan order in, so the external sort (and thus addKey) stays deterministic
+            for ( size_t i = 0; i < n; i++ )
+                _phase1.addKeys( _batchKeys[i], _batchLocs[i], false );
+
+            _batchObjs.clear();
+            _batchLocs.clear();
+            _batchKeys.clear();
+
+            if ( _batchErrCode )
+                uasserted( _batchErrCode, _batchErrMsg );
+        }
+
         virtual Status remove(const BSONObj& obj,
                               const DiskLoc& loc,
                               const InsertDeleteOptions& options,
@@ -447,8 +584,31 @@ namespace mongo {
             return Status( ErrorCodes::InternalError, "cannot use bulk for this yet" );
         }
 
+        void _generateKeysForSlice( size_t begin, size_t end ) {
+            try {
+                for ( size_t i = begin; i < end; i++ )
+                    _real->computeKeys( _batchObjs[i], &_batchKeys[i] );
+            }
+            catch ( const DBException& e ) {
+                // remember the first failure; rethrown on the build thread after join
+                SimpleMutex::scoped_lock lk( _batchErrMutex );
+                if ( _batchErrCode == 0 ) {
+                    _batchErrCode = e.getCode();
+                    _batchErrMsg = e.what();
+                }
+            }
+        }
+
         BtreeBasedAccessMethod* _real; // now owned here
         SortPhaseOne _phase1;
+
+        threadpool::ThreadPool _keyGenPool;
+        std::vector<BSONObj> _batchObjs;
+        std::vector<DiskLoc> _batchLocs;
+        std::vector<BSONObjSet> _batchKeys;
+        SimpleMutex _batchErrMutex;
+        int _batchErrCode;
+        std::string _batchErrMsg;
     };
 
     int oldCompare(const BSONObj& l,const BSONObj& r, const Ordering &o); // key.cpp
@@ -534,6 +694,7 @@ namespace mongo {
         string ns = _btreeState->collection()->ns().ns();
 
         BtreeBulk* bulk = static_cast<BtreeBulk*>( bulkRaw );
+        bulk->flushBatch();
         if ( bulk->_phase1.multi )
             _btreeState->setMultikey();
 
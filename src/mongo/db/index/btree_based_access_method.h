@@ -68,6 +68,11 @@ namespace mongo {
                               const InsertDeleteOptions& options,
                               int64_t* numDeleted);
 
+        virtual Status removeMany(const std::vector<BSONObj>& objs,
+                                  const std::vector<DiskLoc>& locs,
+                                  const InsertDeleteOptions& options,
+                                  int64_t* numDeleted);
+
         virtual Status validateUpdate(const BSONObj& from,
                                       const BSONObj& to,
                                       const DiskLoc& loc,
@@ -93,6 +98,14 @@ namespace mongo {
         // XXX: consider migrating callers to use IndexCursor instead
         virtual DiskLoc findSingle( const BSONObj& key );
 
+        /**
+         * Approximate quantile probes over the whole index, for sampled split
+         * point estimation; see BtreeInterface::approxKeyAtFraction and
+         * approxFractionOfKey.  'key' is in index key format (no field names).
+         */
+        BSONObj approxKeyAtFraction( double fraction ) const;
+        double approxFractionOfKey( const BSONObj& key ) const;
+
         // exposed for testing, used for bulk commit
         static ExternalSortComparison* getComparison(int version,
                                                      const BSONObj& keyPattern);
@@ -106,6 +119,13 @@ namespace mongo {
 
         virtual void getKeys(const BSONObj &obj, BSONObjSet *keys) = 0;
 
+        /**
+         * All insert/remove/update paths generate keys through this: for a partial index
+         * it produces no keys for documents that don't match the index filter, otherwise
+         * it just delegates to getKeys.
+         */
+        void computeKeys(const BSONObj& obj, BSONObjSet* keys);
+
         IndexCatalogEntry* _btreeState; // owned by IndexCatalogEntry
         const IndexDescriptor* _descriptor;
 
@@ -156,6 +156,54 @@ namespace mongo {
 
     void BtreeIndexCursor::next() { advance("BtreeIndexCursor::next"); skipUnusedKeys(); }
 
+    int BtreeIndexCursor::getBatch(int maxToGet, std::vector<BSONObj>* keysOut,
+                                   std::vector<DiskLoc>* locsOut) {
+        if (isEOF()) { return 0; }
+
+        int count = _interface->getBatch(_btreeState, _bucket, &_keyOffset, _direction,
+                                         maxToGet, keysOut, locsOut);
+        if (0 == count) {
+            // Interior bucket; its keys interleave with child subtrees, so just take the
+            // current entry.
+            keysOut->push_back(getKey().getOwned());
+            locsOut->push_back(getValue());
+            count = 1;
+        }
+
+        // Step off the last key we pulled; advance() walks into the next bucket if needed.
+        advance("BtreeIndexCursor::getBatch");
+        skipUnusedKeys();
+        return count;
+    }
+
+    void BtreeIndexCursor::restorePositionTo(const BSONObj& key, const DiskLoc& loc) {
+        bool found;
+
+        // As in restorePosition, we want locate's recordLoc tiebreak, so we don't use seek.
+        _bucket = _interface->locate(_btreeState,
+                                     _btreeState->head(),
+                                     key,
+                                     _keyOffset,
+                                     found,
+                                     loc,
+                                     _direction);
+
+        skipUnusedKeys();
+    }
+
+    long long BtreeIndexCursor::countAndSkipToNextBucket() {
+        if (isEOF()) { return -1; }
+
+        long long count = _interface->countRemainingLeafKeys(_btreeState, _bucket, _keyOffset);
+        if (count < 0) { return -1; }
+
+        // Step off the bucket's last key; advance() walks up to the successor bucket.
+        _keyOffset = _interface->nKeys(_btreeState, _bucket) - 1;
+        advance("BtreeIndexCursor::countAndSkipToNextBucket");
+        skipUnusedKeys();
+        return count;
+    }
+
     Status BtreeIndexCursor::savePosition() {
         if (!isEOF()) {
             _savedKey = getKey().getOwned();
@@ -249,7 +297,13 @@ namespace mongo {
 
     // Move to the next/prev. key.  Used by normal getNext and also skipping unused keys.
     void BtreeIndexCursor::advance(const char* caller) {
+        const DiskLoc oldBucket = _bucket;
         _bucket = _interface->advance(_btreeState, _bucket, _keyOffset, _direction, caller);
+        if (!_bucket.isNull() && _bucket != oldBucket) {
+            // We just crossed into a new bucket.  Hint the buckets the scan will reach
+            // next so their disk reads overlap with key processing in this one.
+            _interface->prefetchNextBuckets(_btreeState, _bucket, _keyOffset, _direction);
+        }
     }
 
 }  // namespace mongo
@@ -70,6 +70,31 @@ namespace mongo {
         virtual DiskLoc getValue() const;
         virtual void next();
 
+        /**
+         * Pulls up to 'maxToGet' used keys out of the current leaf bucket in one pass,
+         * then steps past the last one pulled (possibly into the next bucket).  Falls
+         * back to fetching just the current entry when the bucket is interior.  See
+         * IndexCursor::getBatch for the contract; this never returns 0 when !isEOF().
+         */
+        virtual int getBatch(int maxToGet, std::vector<BSONObj>* keysOut,
+                             std::vector<DiskLoc>* locsOut);
+
+        /**
+         * Point the cursor at the entry (key, loc), or its successor in our direction if
+         * that exact entry is gone.  Used by callers that batched entries ahead of the
+         * position they've consumed up to and need to rewind (e.g. before a yield).
+         */
+        void restorePositionTo(const BSONObj& key, const DiskLoc& loc);
+
+        /**
+         * Count the used keys from the current position through the end of the current
+         * bucket and advance into the following bucket, without materializing any keys.
+         * Returns the count, or -1 without moving when the current bucket is interior
+         * (or the cursor is EOF); the caller should then step with next() instead.
+         * Used by the Count stage when an entire leaf falls inside the counted interval.
+         */
+        long long countAndSkipToNextBucket();
+
         virtual Status savePosition();
 
         virtual Status restorePosition();
@@ -31,6 +31,7 @@
 #include "mongo/db/pdfile.h"
 #include "mongo/db/structure/btree/btree.h"
 #include "mongo/db/structure/record_store.h"
+#include "mongo/util/touch_pages.h"
 
 namespace mongo {
 
@@ -151,6 +152,49 @@ namespace mongo {
         }
 
 
+        virtual long long countRemainingLeafKeys(const IndexCatalogEntry* btreeState,
+                                                 DiskLoc bucket, int keyOffset) const {
+            const BtreeBucket<Version>* b = getBucket( btreeState, bucket );
+            if ( !b->getNextChild().isNull() )
+                return -1;
+            const int n = b->nKeys();
+            long long count = 0;
+            for ( int i = keyOffset; i < n; i++ ) {
+                if ( !b->keyNode( i ).prevChildBucket.isNull() )
+                    return -1;
+                if ( b->k( i ).isUsed() )
+                    count++;
+            }
+            return count;
+        }
+
+        virtual int getBatch(const IndexCatalogEntry* btreeState,
+                             DiskLoc bucket,
+                             int* keyOffset,
+                             int direction,
+                             int maxToGet,
+                             vector<BSONObj>* keysOut,
+                             vector<DiskLoc>* locsOut) const {
+            const BtreeBucket<Version>* b = getBucket( btreeState, bucket );
+            if ( !b->getNextChild().isNull() )
+                return 0;
+            const int n = b->nKeys();
+            int count = 0;
+            int ofs = *keyOffset;
+            while ( count < maxToGet && ofs >= 0 && ofs < n ) {
+                if ( !b->keyNode( ofs ).prevChildBucket.isNull() )
+                    break;
+                if ( b->k( ofs ).isUsed() ) {
+                    keysOut->push_back( b->keyNode( ofs ).key.toBson().getOwned() );
+                    locsOut->push_back( b->keyNode( ofs ).recordLoc );
+                    count++;
+                    *keyOffset = ofs;
+                }
+                ofs += direction;
+            }
+            return count;
+        }
+
         virtual bool keyIsUsed(const IndexCatalogEntry* btreeState,
                                DiskLoc bucket, int keyOffset) const {
             return getBucket(btreeState,bucket)->k(keyOffset).isUsed();
@@ -212,11 +256,129 @@ namespace mongo {
             return getBucket( btreeState, thisLoc )->advance(thisLoc, keyOfs, direction, caller);
         }
 
+        virtual void prefetchNextBuckets(const IndexCatalogEntry* btreeState,
+                                         DiskLoc bucket,
+                                         int keyOffset,
+                                         int direction) const {
+            const BtreeBucket<Version>* b = getBucket( btreeState, bucket );
+            const int n = b->nKeys();
+
+            // hint the child buckets reachable from the next few key positions.  leaf
+            // buckets have all-null children so this is a no-op for them; the interior
+            // buckets a descent passes through are the expensive cold faults
+            const int lookahead = 4;
+            for ( int i = 0; i <= lookahead; i++ ) {
+                const int pos = keyOffset + direction * i;
+                if ( pos < 0 || pos > n )
+                    break;
+                const DiskLoc child = ( pos == n ) ?
+                    b->getNextChild() :
+                    DiskLoc( b->keyNode( pos ).prevChildBucket );
+                if ( child.isNull() )
+                    continue;
+                prefetch_pages( reinterpret_cast<const char*>( getBucket( btreeState, child ) ),
+                                Version::BucketSize );
+            }
+        }
+
         virtual long long fullValidate(const IndexCatalogEntry* btreeState,
                                        const DiskLoc& thisLoc,
                                        const BSONObj& keyPattern) {
             return getBucket( btreeState, thisLoc )->fullValidate(thisLoc, keyPattern);
         }
+
+        virtual BSONObj approxKeyAtFraction(const IndexCatalogEntry* btreeState,
+                                            const DiskLoc& thisLoc,
+                                            double fraction) const {
+            double f = fraction;
+            if ( f < 0 )
+                f = 0;
+            if ( f >= 1 )
+                f = 0.999999;
+
+            DiskLoc loc = thisLoc;
+            while ( !loc.isNull() ) {
+                const BtreeBucket<Version>* b = getBucket( btreeState, loc );
+                const int n = b->nKeys();
+                if ( n == 0 )
+                    return BSONObj();
+
+                const bool leaf = b->getNextChild().isNull() &&
+                                  b->keyNode( 0 ).prevChildBucket.isNull();
+                if ( leaf ) {
+                    int pos = static_cast<int>( f * n );
+                    if ( pos >= n )
+                        pos = n - 1;
+                    // the chosen slot may be unused; settle for a neighbor
+                    for ( int i = pos; i < n; i++ )
+                        if ( b->k( i ).isUsed() )
+                            return b->keyNode( i ).key.toBson().getOwned();
+                    for ( int i = pos - 1; i >= 0; i-- )
+                        if ( b->k( i ).isUsed() )
+                            return b->keyNode( i ).key.toBson().getOwned();
+                    return BSONObj();
+                }
+
+                // interior: n keys interleave n+1 child subtrees.  weight the
+                // children equally -- subtree populations dwarf the single
+                // separator keys, so those are ignored
+                int c = static_cast<int>( f * ( n + 1 ) );
+                if ( c > n )
+                    c = n;
+                const DiskLoc child = ( c == n ) ?
+                    b->getNextChild() :
+                    DiskLoc( b->keyNode( c ).prevChildBucket );
+                if ( child.isNull() ) {
+                    // lopsided spot in the tree: answer with the separator key
+                    const int pos = c < n ? c : n - 1;
+                    if ( b->k( pos ).isUsed() )
+                        return b->keyNode( pos ).key.toBson().getOwned();
+                    return BSONObj();
+                }
+                f = f * ( n + 1 ) - c;
+                loc = child;
+            }
+            return BSONObj();
+        }
+
+        virtual double approxFractionOfKey(const IndexCatalogEntry* btreeState,
+                                           const DiskLoc& thisLoc,
+                                           const BSONObj& key) const {
+            typename Version::KeyOwned target(key);
+            const Ordering& ordering = btreeState->ordering();
+
+            double f = 0;
+            double scale = 1;
+            DiskLoc loc = thisLoc;
+            while ( !loc.isNull() ) {
+                const BtreeBucket<Version>* b = getBucket( btreeState, loc );
+                const int n = b->nKeys();
+                if ( n == 0 )
+                    break;
+
+                // first key >= target; buckets are small so linear is fine
+                int pos = 0;
+                while ( pos < n && b->keyNode( pos ).key.woCompare( target, ordering ) < 0 )
+                    pos++;
+
+                const bool leaf = b->getNextChild().isNull() &&
+                                  b->keyNode( 0 ).prevChildBucket.isNull();
+                if ( leaf ) {
+                    f += scale * pos / n;
+                    break;
+                }
+
+                f += scale * pos / ( n + 1 );
+                scale /= ( n + 1 );
+                const DiskLoc child = ( pos == n ) ?
+                    b->getNextChild() :
+                    DiskLoc( b->keyNode( pos ).prevChildBucket );
+                if ( child.isNull() )
+                    break;
+                loc = child;
+            }
+            return f < 1 ? f : 1;
+        }
     };
 
     BtreeInterfaceImpl<V0> interface_v0;
@@ -106,10 +106,40 @@ namespace mongo {
                                 int direction,
                                 const char* caller) const = 0;
 
+        /**
+         * Issue non-blocking prefetch hints for the child buckets a scan positioned at
+         * (bucket, keyOffset) will descend into over the next few keys, overlapping
+         * their disk reads with key processing.  Advisory only; never faults pages in.
+         */
+        virtual void prefetchNextBuckets(const IndexCatalogEntry* btreeState,
+                                         DiskLoc bucket,
+                                         int keyOffset,
+                                         int direction) const = 0;
+
         virtual long long fullValidate(const IndexCatalogEntry* btreeState,
                                        const DiskLoc& thisLoc,
                                        const BSONObj& keyPattern) = 0;
 
+        /**
+         * Descend from 'thisLoc' (normally the index head) to the key at
+         * approximately 'fraction' (in [0, 1)) of the subtree's scan order,
+         * assuming sibling subtrees hold similar numbers of keys.  Touches one
+         * bucket per level, so this is O(tree height) rather than a scan.
+         * Returns an owned copy, or an empty BSONObj if the subtree is empty.
+         */
+        virtual BSONObj approxKeyAtFraction(const IndexCatalogEntry* btreeState,
+                                            const DiskLoc& thisLoc,
+                                            double fraction) const = 0;
+
+        /**
+         * The inverse estimate: the position of 'key' within the subtree at
+         * 'thisLoc' as a fraction in [0, 1] of scan order, under the same
+         * balance assumption as approxKeyAtFraction.  Also O(tree height).
+         */
+        virtual double approxFractionOfKey(const IndexCatalogEntry* btreeState,
+                                           const DiskLoc& thisLoc,
+                                           const BSONObj& key) const = 0;
+
         /**
          * These methods are here so that the BtreeCursor doesn't need to do any templating for the
          * two on-disk formats.
@@ -122,6 +152,30 @@ namespace mongo {
         virtual int nKeys(const IndexCatalogEntry* btreeState,
                           DiskLoc bucket ) = 0;
 
+        /**
+         * If bucket is a leaf, returns the number of used keys from keyOffset through the
+         * end of the bucket.  Returns -1 for interior buckets, whose keys interleave with
+         * child subtrees and so are not consecutive in scan order.
+         */
+        virtual long long countRemainingLeafKeys(const IndexCatalogEntry* btreeState,
+                                                 DiskLoc bucket, int keyOffset) const = 0;
+
+        /**
+         * Append up to 'maxToGet' used (key, record) pairs to keysOut/locsOut, starting at
+         * (bucket, keyOffset) and walking in 'direction' without leaving the bucket.
+         * keyOffset is advanced to the offset of the last key appended; the keys appended
+         * are owned copies.  Returns the number appended, or 0 without side effects when
+         * 'bucket' is interior (its keys interleave with child subtrees and so are not
+         * consecutive in scan order).
+         */
+        virtual int getBatch(const IndexCatalogEntry* btreeState,
+                             DiskLoc bucket,
+                             int* keyOffset,
+                             int direction,
+                             int maxToGet,
+                             vector<BSONObj>* keysOut,
+                             vector<DiskLoc>* locsOut) const = 0;
+
         /**
          * Is the key at (bucket, keyOffset) being used or not?
          * Some keys are marked as not used and skipped.
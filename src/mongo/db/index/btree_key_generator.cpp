@@ -48,9 +48,106 @@ namespace mongo {
         nullEltBuilder.appendNull("");
         _nullObj = nullEltBuilder.obj();
         _nullElt = _nullObj.firstElement();
+
+        _compileExtractionPlan(fieldNames, fixed);
+    }
+
+    void BtreeKeyGenerator::_compileExtractionPlan(const vector<const char*>& fieldNames,
+                                                   const vector<BSONElement>& fixed) {
+        _fastPathOk = fieldNames.size() <= MaxCompiledFields;
+        for (size_t i = 0; _fastPathOk && i < fieldNames.size(); ++i) {
+            // an empty field name or a preset fixed element means we were constructed
+            // for a recursive/array context -- leave everything to getKeysImpl
+            if (*fieldNames[i] == '\0' || !fixed[i].eoo()) {
+                _fastPathOk = false;
+                break;
+            }
+            const char* dot = strchr(fieldNames[i], '.');
+            string first = dot ? string(fieldNames[i], dot - fieldNames[i])
+                               : string(fieldNames[i]);
+            // fields of a compound index often share a first component ({"a.b":1,"a.c":1});
+            // probe each distinct component once
+            unsigned slot = 0;
+            while (slot < _firstNames.size() && _firstNames[slot] != first) {
+                slot++;
+            }
+            if (slot == _firstNames.size()) {
+                _firstNames.push_back(first);
+            }
+            _firstNameIdx.push_back(slot);
+            _tails.push_back(dot ? dot + 1 : NULL);
+        }
+    }
+
+    bool BtreeKeyGenerator::_getKeysFastPath(const BSONObj &obj, BSONObjSet *keys) const {
+        if ( !_fastPathOk )
+            return false;
+
+        const unsigned nProbes = _firstNames.size();
+        BSONElement probed[ MaxCompiledFields ];
+
+        // one scan of the document picks up every first-level component.
+        // first occurrence wins, matching getField().
+        unsigned numProbesFound = 0;
+        BSONObjIterator it( obj );
+        while ( it.more() && numProbesFound < nProbes ) {
+            BSONElement e = it.next();
+            const char *p = e.fieldName();
+            for ( unsigned i = 0; i < nProbes; i++ ) {
+                if ( probed[ i ].eoo() && _firstNames[ i ] == p ) {
+                    probed[ i ] = e;
+                    numProbesFound++;
+                    break;
+                }
+            }
+        }
+
+        const unsigned nFields = _firstNameIdx.size();
+        BSONElement extracted[ MaxCompiledFields ];
+        unsigned numNotFound = 0;
+        for ( unsigned i = 0; i < nFields; i++ ) {
+            BSONElement e = probed[ _firstNameIdx[ i ] ];
+            if ( !e.eoo() && e.type() != Array && _tails[ i ] ) {
+                if ( e.type() == Object ) {
+                    const char *rest = _tails[ i ];
+                    e = e.embeddedObject().getFieldDottedOrArray( rest );
+                }
+                else {
+                    // path dead-ends at a scalar, same as getFieldDottedOrArray()
+                    e = BSONElement();
+                }
+            }
+            if ( e.type() == Array ) {
+                // array expansion is version specific -- take the general path
+                return false;
+            }
+            if ( e.eoo() ) {
+                e = _nullElt;
+                numNotFound++;
+            }
+            extracted[ i ] = e;
+        }
+
+        if ( _isSparse && numNotFound == nFields ) {
+            // we didn't find any fields, so we're not going to index this document
+            return true;
+        }
+
+        BSONObjBuilder b(_sizeTracker);
+        for ( unsigned i = 0; i < nFields; i++ ) {
+            b.appendAs( extracted[ i ], "" );
+        }
+        keys->insert( b.obj() );
+        return true;
     }
 
     void BtreeKeyGenerator::getKeys(const BSONObj &obj, BSONObjSet *keys) const {
+        // Common case: nothing along an indexed path is an array, so the compiled
+        // plan produces the single key without the expansion machinery below.
+        if (_getKeysFastPath(obj, keys)) {
+            return;
+        }
+
         // These are mutated as part of the getKeys call.  :|
         vector<const char*> fieldNames(_fieldNames);
         vector<BSONElement> fixed(_fixed);
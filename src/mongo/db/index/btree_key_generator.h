@@ -59,7 +59,30 @@ namespace mongo {
         // We have V0 and V1.  Sigh.
         virtual void getKeysImpl(vector<const char*> fieldNames, vector<BSONElement> fixed,
                                  const BSONObj &obj, BSONObjSet *keys) const = 0;
+
+        /**
+         * Extract a single key using the plan compiled by _compileExtractionPlan().
+         * Handles the common case where no indexed path meets an array: one scan of
+         * the document picks up every first-level component and pre-split tails are
+         * walked without re-parsing dotted names.  Returns false if an array (or an
+         * ineligible pattern) requires the general version-specific expansion; in
+         * that case nothing has been added to keys.
+         */
+        bool _getKeysFastPath(const BSONObj &obj, BSONObjSet *keys) const;
+
+        void _compileExtractionPlan(const vector<const char*>& fieldNames,
+                                    const vector<BSONElement>& fixed);
+
         vector<BSONElement> _fixed;
+
+        // The key pattern compiled once at construction so per-document extraction
+        // does not re-split paths.  Array expansion is version specific, so anything
+        // fancier than "no arrays anywhere" falls through to getKeysImpl.
+        enum { MaxCompiledFields = 64 };
+        bool _fastPathOk;
+        vector<string> _firstNames;     // unique first path components
+        vector<unsigned> _firstNameIdx; // per key field, index into _firstNames
+        vector<const char*> _tails;     // per key field, path after the first dot, or NULL
     };
 
     class BtreeKeyGeneratorV0 : public BtreeKeyGenerator {
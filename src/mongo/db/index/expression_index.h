@@ -41,9 +41,10 @@ namespace mongo {
      */
     class ExpressionMapping {
     public:
-        static BSONObj hash(const BSONElement& value) {
+        static BSONObj hash(const BSONElement& value, int hashVersion = 0) {
             BSONObjBuilder bob;
-            bob.append("", BSONElementHasher::hash64(value, BSONElementHasher::DEFAULT_HASH_SEED));
+            bob.append("", BSONElementHasher::hash64(value, BSONElementHasher::DEFAULT_HASH_SEED,
+                                                     hashVersion));
             return bob.obj();
         }
 
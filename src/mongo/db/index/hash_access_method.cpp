@@ -33,8 +33,8 @@
 namespace mongo {
 
     long long int HashAccessMethod::makeSingleKey(const BSONElement& e, HashSeed seed, int v) {
-        massert(16767, "Only HashVersion 0 has been defined" , v == 0 );
-        return BSONElementHasher::hash64(e, seed);
+        massert(16767, "Only HashVersions 0 and 1 have been defined" , v == 0 || v == 1 );
+        return BSONElementHasher::hash64(e, seed, v);
     }
 
     HashAccessMethod::HashAccessMethod(IndexCatalogEntry* btreeState)
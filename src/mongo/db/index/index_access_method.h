@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/db/diskloc.h"
 #include "mongo/db/index/index_cursor.h"
 #include "mongo/db/index/index_descriptor.h"
@@ -78,6 +80,28 @@ namespace mongo {
                               const InsertDeleteOptions& options,
                               int64_t* numDeleted) = 0;
 
+        /**
+         * Removes the index entries for a batch of documents in one call.  'objs' and 'locs'
+         * are parallel vectors.  The default implementation just loops over remove();
+         * btree-based access methods override this to remove the whole batch's keys in key
+         * order, amortizing bucket descents and journal intents across the documents.
+         */
+        virtual Status removeMany(const std::vector<BSONObj>& objs,
+                                  const std::vector<DiskLoc>& locs,
+                                  const InsertDeleteOptions& options,
+                                  int64_t* numDeleted) {
+            verify(objs.size() == locs.size());
+            *numDeleted = 0;
+            for (size_t i = 0; i < objs.size(); i++) {
+                int64_t removed;
+                Status status = remove(objs[i], locs[i], options, &removed);
+                if (!status.isOK())
+                    return status;
+                *numDeleted += removed;
+            }
+            return Status::OK();
+        }
+
         /**
          * Checks whether the index entries for the document 'from', which is placed at location
          * 'loc' on disk, can be changed to the index entries for the doc 'to'. Provides a ticket
@@ -86,7 +86,19 @@ namespace mongo {
 
         // Move to the next key/value pair.  Assumes !isEOF().
         virtual void next() = 0;
-        
+
+        /**
+         * Bulk iteration: append up to 'maxToGet' (key, DiskLoc) pairs to the out vectors,
+         * starting with the current entry, and advance past all of them.  Returns the number
+         * appended; the keys appended are owned copies.  A return of 0 means the cursor has no
+         * batch support and the caller should step with getKey()/getValue()/next() instead.
+         * Assumes !isEOF().
+         */
+        virtual int getBatch(int maxToGet, std::vector<BSONObj>* keysOut,
+                             std::vector<DiskLoc>* locsOut) {
+            return 0;
+        }
+
         //
         // Accessors
         //
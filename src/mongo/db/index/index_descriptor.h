@@ -66,6 +66,7 @@ namespace mongo {
               _parentNS(infoObj.getStringField("ns")),
               _isIdIndex(IndexDetails::isIdIndexPattern( _keyPattern )),
               _sparse(infoObj["sparse"].trueValue()),
+              _partial(!infoObj["filter"].eoo()),
               _dropDups(infoObj["dropDups"].trueValue()),
               _unique( _isIdIndex || infoObj["unique"].trueValue() ),
               _cachedEntry( NULL )
@@ -126,6 +127,10 @@ namespace mongo {
         // Is this index sparse?
         bool isSparse() const { return _sparse; }
 
+        // Is this a partial index?  The filter itself lives in the info object ("filter")
+        // and is parsed by the IndexCatalogEntry.
+        bool isPartial() const { return _partial; }
+
         // Is this index multikey?
         bool isMultikey() const { _checkOk(); return _collection->getIndexCatalog()->isMultikey( this ); }
 
@@ -178,6 +183,7 @@ namespace mongo {
         string _indexNamespace;
         bool _isIdIndex;
         bool _sparse;
+        bool _partial;
         bool _dropDups;
         bool _unique;
         int _version;
@@ -30,6 +30,7 @@
 
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_name.h"
+#include "mongo/db/catalog/index_create.h"
 #include "mongo/db/client.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/pdfile.h"
@@ -100,7 +101,43 @@ namespace mongo {
                 continue;
             }
 
+            // builds that checkpointed their scan position and whose partial btree
+            // survived the restart can be resumed in place instead of redone
+            vector<BSONObj> failedResumes;
+            if (serverGlobalParams.indexBuildRetry) {
+                vector<BSONObj> unfinished = indexCatalog->unfinishedIndexes();
+                for (size_t i = 0; i < unfinished.size(); i++) {
+                    BSONObj spec = unfinished[i];
+                    DiskLoc resumeAt;
+                    if (!getIndexBuildCheckpoint(ns, spec["name"].String(), spec, &resumeAt))
+                        continue;
+
+                    // the checkpoint names a record but doesn't pin it; if that record
+                    // was deleted or moved before the crash, leave the index on the
+                    // unfinished list so it's rebuilt from scratch below
+                    if (!indexBuildCheckpointStillValid(collection, resumeAt)) {
+                        log() << "index build checkpoint no longer points at a live record,"
+                              << " rebuilding from scratch: " << spec;
+                        removeIndexBuildCheckpoint(ns, spec["name"].String());
+                        continue;
+                    }
+
+                    log() << "resuming interrupted index build from checkpoint: " << spec;
+
+                    Status status = indexCatalog->resumeUnfinishedIndex(spec, resumeAt);
+                    if (!status.isOK()) {
+                        // the partial index has been dropped; rebuild from scratch below
+                        log() << "resuming index build failed: " << status.toString()
+                              << " index: " << spec;
+                        failedResumes.push_back(spec);
+                    }
+                }
+            }
+
             vector<BSONObj> indexesToBuild = indexCatalog->getAndClearUnfinishedIndexes();
+            indexesToBuild.insert(indexesToBuild.end(),
+                                  failedResumes.begin(),
+                                  failedResumes.end());
 
             // The indexes have now been removed from system.indexes, so the only record is
             // in-memory. If there is a journal commit between now and when insert() rewrites
@@ -45,6 +45,7 @@
 #include "mongo/db/auth/authorization_manager_global.h"
 #include "mongo/db/auth/security_key.h"
 #include "mongo/logger/logger.h"
+#include "mongo/logger/async_appender.h"
 #include "mongo/logger/console_appender.h"
 #include "mongo/logger/message_event.h"
 #include "mongo/logger/message_event_utf8_encoder.h"
@@ -191,6 +192,7 @@ namespace mongo {
                               ("default"))(
             InitializerContext*) {
 
+        using logger::AsyncMessageAppender;
         using logger::LogManager;
         using logger::MessageEventEphemeral;
         using logger::MessageEventDetailsEncoder;
@@ -215,8 +217,9 @@ namespace mongo {
             manager->getGlobalDomain()->clearAppenders();
             manager->getGlobalDomain()->attachAppender(
                     MessageLogDomain::AppenderAutoPtr(
-                            new SyslogAppender<MessageEventEphemeral>(
-                                    new logger::MessageEventWithContextEncoder)));
+                            new AsyncMessageAppender(
+                                    new SyslogAppender<MessageEventEphemeral>(
+                                            new logger::MessageEventWithContextEncoder))));
             manager->getNamedDomain("javascriptOutput")->attachAppender(
                     MessageLogDomain::AppenderAutoPtr(
                             new SyslogAppender<MessageEventEphemeral>(
@@ -273,8 +276,10 @@ namespace mongo {
             manager->getGlobalDomain()->clearAppenders();
             manager->getGlobalDomain()->attachAppender(
                     MessageLogDomain::AppenderAutoPtr(
-                            new RotatableFileAppender<MessageEventEphemeral>(
-                                    new MessageEventDetailsEncoder, writer.getValue())));
+                            new AsyncMessageAppender(
+                                    new RotatableFileAppender<MessageEventEphemeral>(
+                                            new MessageEventDetailsEncoder,
+                                            writer.getValue()))));
             manager->getNamedDomain("javascriptOutput")->attachAppender(
                     MessageLogDomain::AppenderAutoPtr(
                             new RotatableFileAppender<MessageEventEphemeral>(
@@ -41,6 +41,7 @@
 
 #include "mongo/base/status.h"
 #include "mongo/bson/util/atomic_int.h"
+#include "mongo/db/admission_control.h"
 #include "mongo/db/audit.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
@@ -73,6 +74,8 @@
 #include "mongo/db/repl/is_master.h"
 #include "mongo/db/repl/oplog.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/db/stats/op_latency.h"
+#include "mongo/db/stats/op_sampler.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/platform/process_id.h"
 #include "mongo/s/d_logic.h"
@@ -346,6 +349,10 @@ namespace mongo {
         Client& c = cc();
         c.getAuthorizationSession()->startRequest();
 
+        // Rewind the per-operation scratch arena when this request completes, whichever
+        // path returns.  Arena-backed buffers must be copied out before then.
+        OpArenaRewind arenaRewind( c );
+
         if ( op == dbQuery ) {
             if( strstr(ns, ".$cmd") ) {
                 isCommand = true;
@@ -376,6 +383,10 @@ namespace mongo {
             opwrite(m);
         }
 
+        // Gate operation start before any locking; no-op unless admission
+        // control is enabled.  Held for the life of the operation.
+        AdmissionTicket admission( op, isCommand );
+
         // Increment op counters.
         switch (op) {
         case dbQuery:
@@ -494,6 +505,10 @@ namespace mongo {
         currentOp.done();
         debug.executionTime = currentOp.totalTimeMillis();
 
+        OpSampler::global.recordOp( currentOp, debug );
+        OpLatencyStats::global.record( op, currentOp.isCommand(),
+                                       static_cast<long long>( currentOp.totalTimeMicros() ) );
+
         logThreshold += currentOp.getExpectedLatencyMs();
 
         if ( shouldLog || debug.executionTime > logThreshold ) {
@@ -624,7 +639,7 @@ namespace mongo {
             uasserted( 17009, status.reason() );
         }
 
-        Lock::DBWrite lk(ns.ns());
+        Lock::CollectionWrite lk(ns.ns());
 
         // void ReplSetImpl::relinquish() uses big write lock so this is thus
         // synchronized given our lock above.
@@ -675,8 +690,8 @@ namespace mongo {
         PageFaultRetryableSection s;
         while ( 1 ) {
             try {
-                Lock::DBWrite lk(ns.ns());
-                
+                Lock::CollectionWrite lk(ns.ns());
+
                 // writelock is used to synchronize stepdowns w/ writes
                 uassert( 10056 ,  "not master", isMasterNs( ns.ns().c_str() ) );
                 
@@ -824,7 +839,8 @@ namespace mongo {
         return ok;
     }
 
-    void checkAndInsert(Client::Context& ctx, const char *ns, /*modifies*/BSONObj& js) {
+    void checkAndInsert(Client::Context& ctx, const char *ns, /*modifies*/BSONObj& js,
+                        const ValidatedDocInfo* info = NULL) {
         if ( nsToCollectionSubstring( ns ) == "system.indexes" ) {
             string targetNS = js["ns"].String();
             uassertStatusOK( userAllowedWriteNS( targetNS ) );
@@ -852,7 +868,8 @@ namespace mongo {
             return;
         }
 
-        StatusWith<BSONObj> fixed = fixDocumentForInsert( js );
+        StatusWith<BSONObj> fixed = info ? fixDocumentForInsert( js, *info )
+                                         : fixDocumentForInsert( js );
         uassertStatusOK( fixed.getStatus() );
         if ( !fixed.getValue().isEmpty() )
             js = fixed.getValue();
@@ -868,11 +885,60 @@ namespace mongo {
         logOp("i", ns, js);
     }
 
-    NOINLINE_DECL void insertMulti(Client::Context& ctx, bool keepGoing, const char *ns, vector<BSONObj>& objs, CurOp& op) {
+    /**
+     * tries the bulk path for a multi-document insert: fix the docs up front, then hand
+     * the whole batch to Collection::insertDocumentsBulk which carves contiguous record
+     * runs.  returns false (having inserted nothing) when the batch doesn't qualify and
+     * the caller should fall back to the per-document loop.
+     */
+    static bool insertMultiBulk(Client::Context& ctx, const char *ns, vector<BSONObj>& objs,
+                                const vector<ValidatedDocInfo>& infos, CurOp& op) {
+        if ( nsToCollectionSubstring( ns ) == "system.indexes" )
+            return false; // index builds go through createIndex
+
+        for (size_t i = 0; i < objs.size(); i++) {
+            StatusWith<BSONObj> fixed = fixDocumentForInsert( objs[i], infos[i] );
+            uassertStatusOK( fixed.getStatus() );
+            if ( !fixed.getValue().isEmpty() )
+                objs[i] = fixed.getValue();
+        }
+
+        Collection* collection = ctx.db()->getCollection( ns );
+        if ( !collection ) {
+            collection = ctx.db()->createCollection( ns );
+            verify( collection );
+        }
+
+        if ( collection->isCapped() )
+            return false;
+
+        vector<DiskLoc> locs;
+        Status status = collection->insertDocumentsBulk( objs, true, &locs );
+
+        // docs already inserted stay inserted -- log and count them before reporting
+        if ( locs.size() == objs.size() ) {
+            logOps("i", ns, objs);
+        }
+        else {
+            vector<BSONObj> inserted( objs.begin(), objs.begin() + locs.size() );
+            logOps("i", ns, inserted);
+        }
+        getDur().commitIfNeeded();
+        globalOpCounters.incInsertInWriteLock(locs.size());
+        op.debug().ninserted = locs.size();
+
+        uassertStatusOK( status );
+        return true;
+    }
+
+    NOINLINE_DECL void insertMulti(Client::Context& ctx, bool keepGoing, const char *ns, vector<BSONObj>& objs, const vector<ValidatedDocInfo>& infos, CurOp& op) {
+        if ( !keepGoing && objs.size() > 1 && insertMultiBulk(ctx, ns, objs, infos, op) )
+            return;
+
         size_t i;
         for (i=0; i<objs.size(); i++){
             try {
-                checkAndInsert(ctx, ns, objs[i]);
+                checkAndInsert(ctx, ns, objs[i], &infos[i]);
                 getDur().commitIfNeeded();
             } catch (const UserException&) {
                 if (!keepGoing || i == objs.size()-1){
@@ -900,8 +966,11 @@ namespace mongo {
         }
 
         vector<BSONObj> multi;
+        vector<ValidatedDocInfo> infos;
         while (d.moreJSObjs()){
-            BSONObj obj = d.nextJsObj();
+            // fused scan: boundary, structural validation and per-doc facts in one pass
+            infos.push_back( ValidatedDocInfo() );
+            BSONObj obj = d.nextJsObjScanned( &infos.back() );
             multi.push_back(obj);
 
             // Check auth for insert (also handles checking if this is an index build and checks
@@ -915,8 +984,8 @@ namespace mongo {
         PageFaultRetryableSection s;
         while ( true ) {
             try {
-                Lock::DBWrite lk(ns);
-                
+                Lock::CollectionWrite lk(ns);
+
                 // CONCURRENCY TODO: is being read locked in big log sufficient here?
                 // writelock is used to synchronize stepdowns w/ writes
                 uassert( 10058 , "not master", isMasterNs(ns) );
@@ -928,9 +997,9 @@ namespace mongo {
                 
                 if (multi.size() > 1) {
                     const bool keepGoing = d.reservedField() & InsertOption_ContinueOnError;
-                    insertMulti(ctx, keepGoing, ns, multi, op);
+                    insertMulti(ctx, keepGoing, ns, multi, infos, op);
                 } else {
-                    checkAndInsert(ctx, ns, multi[0]);
+                    checkAndInsert(ctx, ns, multi[0], &infos[0]);
                     globalOpCounters.incInsertInWriteLock(1);
                     op.debug().ninserted = 1;
                 }
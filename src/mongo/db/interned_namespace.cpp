@@ -0,0 +1,117 @@
+// @file interned_namespace.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/db/interned_namespace.h"
+
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/string_map.h"
+
+namespace mongo {
+
+    namespace {
+
+        // table entries are pointers so rehashes never move an Entry a handle
+        // points at.  intentionally leaked: handles in thread-local storage can
+        // outlive static destruction.
+        SimpleMutex& internTableLock() {
+            static SimpleMutex* m = new SimpleMutex( "InternedNamespace" );
+            return *m;
+        }
+
+        typedef StringMap<InternedNamespace::Entry*> InternTable;
+
+        InternTable& internTable() {
+            static InternTable* t = new InternTable();
+            return *t;
+        }
+
+        const std::string emptyNamespace;
+    }
+
+    InternedNamespace InternedNamespace::intern( const StringData& ns ) {
+        if ( ns.size() == 0 )
+            return InternedNamespace();
+
+        SimpleMutex::scoped_lock lk( internTableLock() );
+        Entry*& slot = internTable()[ns];
+        if ( slot ) {
+            slot->refs.fetchAndAdd( 1 );
+            return InternedNamespace( slot );
+        }
+
+        Entry* entry = new Entry();
+        entry->ns = ns.toString();
+        entry->dotIndex = entry->ns.find( '.' );
+        entry->hash = StringMapDefaultHash()( entry->ns );
+        entry->refs.store( 1 );
+        slot = entry;
+        return InternedNamespace( entry );
+    }
+
+    void InternedNamespace::_release( Entry* entry ) {
+        // fast path: drop one of several references without the table lock.
+        // the count never goes through zero here, so the entry stays alive.
+        unsigned refs = entry->refs.load();
+        while ( refs > 1 ) {
+            if ( entry->refs.compareAndSwap( refs, refs - 1 ) == refs )
+                return;
+            refs = entry->refs.load();
+        }
+
+        // possibly the last reference: decrement under the lock so a zero can
+        // only ever be observed (and acted on) by one thread, and intern()
+        // can't hand out the entry after we've decided to free it
+        SimpleMutex::scoped_lock lk( internTableLock() );
+        if ( entry->refs.subtractAndFetch( 1 ) > 0 )
+            return; // resurrected while we waited for the lock
+        internTable().erase( entry->ns );
+        delete entry;
+    }
+
+    const std::string& InternedNamespace::ns() const {
+        return _entry ? _entry->ns : emptyNamespace;
+    }
+
+    StringData InternedNamespace::db() const {
+        if ( !_entry )
+            return StringData();
+        if ( _entry->dotIndex == std::string::npos )
+            return StringData( _entry->ns );
+        return StringData( _entry->ns.c_str() , _entry->dotIndex );
+    }
+
+    StringData InternedNamespace::coll() const {
+        if ( !_entry || _entry->dotIndex == std::string::npos )
+            return StringData();
+        return StringData( _entry->ns.c_str() + _entry->dotIndex + 1 ,
+                           _entry->ns.size() - _entry->dotIndex - 1 );
+    }
+
+}
@@ -0,0 +1,119 @@
+// @file interned_namespace.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <string>
+
+#include <boost/noncopyable.hpp>
+
+#include "mongo/base/string_data.h"
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /**
+     * refcounted handle to an entry in the process-wide namespace intern table.
+     *
+     * the same namespace string interns to the same entry, so a handle carries
+     * a precomputed hash and pre-split db/coll views, equality is a pointer
+     * compare, and maps keyed by handles (see Hasher/Equals) never rehash or
+     * re-compare the string.  intern() takes a mutex; callers on hot paths
+     * should hold on to the handle and re-intern only when the namespace
+     * actually changes.
+     */
+    class InternedNamespace {
+    public:
+        InternedNamespace() : _entry( NULL ) {}
+
+        InternedNamespace( const InternedNamespace& other ) : _entry( other._entry ) {
+            if ( _entry )
+                _entry->refs.fetchAndAdd( 1 );
+        }
+
+        InternedNamespace& operator=( const InternedNamespace& other ) {
+            if ( other._entry )
+                other._entry->refs.fetchAndAdd( 1 );
+            if ( _entry )
+                _release( _entry );
+            _entry = other._entry;
+            return *this;
+        }
+
+        ~InternedNamespace() {
+            if ( _entry )
+                _release( _entry );
+        }
+
+        static InternedNamespace intern( const StringData& ns );
+
+        bool isEmpty() const { return _entry == NULL; }
+
+        const std::string& ns() const;
+
+        /** "foo.bar.baz" -> "foo"; entire string if there is no '.' */
+        StringData db() const;
+
+        /** "foo.bar.baz" -> "bar.baz"; empty if there is no '.' */
+        StringData coll() const;
+
+        size_t hash() const { return _entry ? _entry->hash : 0; }
+
+        bool operator==( const InternedNamespace& other ) const { return _entry == other._entry; }
+        bool operator!=( const InternedNamespace& other ) const { return _entry != other._entry; }
+
+        struct Hasher {
+            size_t operator()( const InternedNamespace& n ) const { return n.hash(); }
+        };
+
+        struct Equals {
+            bool operator()( const InternedNamespace& a , const InternedNamespace& b ) const {
+                return a == b;
+            }
+        };
+
+        /** implementation detail of the intern table; not for use by callers */
+        struct Entry : boost::noncopyable {
+            std::string ns;
+            size_t dotIndex; // position of the first '.', or npos
+            size_t hash;     // StringMapDefaultHash of ns
+            AtomicUInt32 refs;
+        };
+
+    private:
+        explicit InternedNamespace( Entry* entry ) : _entry( entry ) {}
+
+        /** drop one reference; erases the table entry when the last goes away */
+        static void _release( Entry* entry );
+
+        Entry* _entry;
+    };
+
+}
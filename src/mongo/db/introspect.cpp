@@ -41,7 +41,9 @@
 #include "mongo/db/pdfile.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/db/structure/collection.h"
+#include "mongo/util/background.h"
 #include "mongo/util/goodies.h"
+#include "mongo/util/queue.h"
 
 namespace {
     const size_t MAX_PROFILE_DOC_SIZE_BYTES = 100*1024;
@@ -79,11 +81,9 @@ namespace {
     }
 } // namespace
 
-    static void _profile(const Client& c, CurOp& currentOp, BufBuilder& profileBufBuilder) {
-        Database *db = c.database();
-        DEV verify( db );
-
-        // build object
+    /** builds the profile document; needs no lock, runs on the operation's thread */
+    static BSONObj _buildProfileDocument(const Client& c, CurOp& currentOp,
+                                         BufBuilder& profileBufBuilder) {
         BSONObjBuilder b(profileBufBuilder);
 
         const bool isQueryObjTooBig = !currentOp.debug().append(currentOp, b,
@@ -118,37 +118,122 @@ namespace {
             p = b.done();
         }
 
-        // write: not replicated
-        // get or create the profiling collection
-        Collection* profileCollection = getOrCreateProfileCollection(db);
-        if ( profileCollection ) {
-            profileCollection->insertDocument( p, false );
-        }
+        return p.getOwned();
     }
 
-    void profile(const Client& c, int op, CurOp& currentOp) {
-        // initialize with 1kb to start, to avoid realloc later
-        // doing this outside the dblock to improve performance
-        BufBuilder profileBufBuilder(1024);
+    namespace {
+
+        struct ProfileRecord {
+            string ns;    // the operation's ns; the write goes to its db's system.profile
+            BSONObj doc;
+        };
 
-        try {
-            Lock::DBWrite lk( currentOp.getNS() );
-            if (dbHolder()._isLoaded(nsToDatabase(currentOp.getNS()), storageGlobalParams.dbpath)) {
-                Client::Context cx(currentOp.getNS(), storageGlobalParams.dbpath);
-                _profile(c, currentOp, profileBufBuilder);
+        size_t _profileRecordSize( const ProfileRecord& r ) {
+            return static_cast<size_t>( r.doc.objsize() );
+        }
+
+        // bounded by bytes so a burst of 100KB documents can't pile up
+        // unboundedly; when full, records are dropped rather than making the
+        // operation path wait
+        BlockingQueue<ProfileRecord> profileQueue( 64 * 1024 * 1024, _profileRecordSize );
+
+        // nonzero while the writer is inserting a batch it already popped;
+        // profileFlush() needs it to know the queue being empty means done
+        AtomicUInt32 profileWriterBusy;
+
+        /** drains profileQueue in batches, taking the db write locks that used
+            to be taken inside the operation's execution path */
+        class ProfileWriter : public BackgroundJob {
+        public:
+            virtual string name() const { return "ProfileWriter"; }
+
+            virtual void run() {
+                Client::initThread( name().c_str() );
+                while ( !inShutdown() ) {
+                    ProfileRecord r;
+                    // peek first: the record stays visible in the queue until
+                    // the busy flag is up, so profileFlush() can't miss it
+                    if ( !profileQueue.blockingPeek( r, 1 ) )
+                        continue;
+                    profileWriterBusy.store( 1 );
+
+                    // group everything already queued by ns so each ns takes
+                    // its write lock once per batch
+                    map< string, vector<BSONObj> > batch;
+                    int ndocs = 0;
+                    while ( ndocs < 100 && profileQueue.tryPop( r ) ) {
+                        batch[r.ns].push_back( r.doc );
+                        ndocs++;
+                    }
+
+                    for ( map< string, vector<BSONObj> >::const_iterator i = batch.begin();
+                          i != batch.end(); ++i ) {
+                        _writeBatch( i->first, i->second );
+                    }
+                    profileWriterBusy.store( 0 );
+                }
+                cc().shutdown();
             }
-            else {
-                mongo::log() << "note: not profiling because db went away - probably a close on: "
-                             << currentOp.getNS() << endl;
+
+        private:
+            void _writeBatch( const string& ns, const vector<BSONObj>& docs ) {
+                try {
+                    Lock::DBWrite lk( ns );
+                    if ( !dbHolder()._isLoaded( nsToDatabase( ns ), storageGlobalParams.dbpath ) ) {
+                        mongo::log() << "note: not profiling because db went away - "
+                                     << "probably a close on: " << ns << endl;
+                        return;
+                    }
+                    Client::Context cx( ns, storageGlobalParams.dbpath );
+                    Collection* profileCollection = getOrCreateProfileCollection( cx.db() );
+                    if ( !profileCollection )
+                        return;
+                    for ( size_t i = 0; i < docs.size(); i++ ) {
+                        // write: not replicated
+                        profileCollection->insertDocument( docs[i], false );
+                    }
+                }
+                catch (const AssertionException& assertionEx) {
+                    warning() << "Caught Assertion while trying to profile against " << ns
+                              << ": " << assertionEx.toString() << endl;
+                }
+            }
+        } profileWriter;
+
+        SimpleMutex profileWriterStartLock("ProfileWriterStart");
+        bool profileWriterStarted = false;
+
+        void _ensureProfileWriterStarted() {
+            SimpleMutex::scoped_lock lk( profileWriterStartLock );
+            if ( !profileWriterStarted ) {
+                profileWriter.go();
+                profileWriterStarted = true;
             }
         }
-        catch (const AssertionException& assertionEx) {
-            warning() << "Caught Assertion while trying to profile " << opToString(op)
-                      << " against " << currentOp.getNS()
-                      << ": " << assertionEx.toString() << endl;
+
+    } // namespace
+
+    void profile(const Client& c, int op, CurOp& currentOp) {
+        // initialize with 1kb to start, to avoid realloc later
+        BufBuilder profileBufBuilder(1024);
+
+        ProfileRecord r;
+        r.ns = currentOp.getNS();
+        r.doc = _buildProfileDocument(c, currentOp, profileBufBuilder);
+
+        _ensureProfileWriterStarted();
+
+        if ( !profileQueue.tryPush( r ) ) {
+            // never make the operation wait on profiling
+            RARELY warning() << "profile record dropped: writer queue is full" << endl;
         }
     }
 
+    void profileFlush() {
+        while ( !profileQueue.empty() || profileWriterBusy.load() )
+            sleepmillis( 1 );
+    }
+
     Collection* getOrCreateProfileCollection(Database *db, bool force, string* errmsg ) {
         fassert(16372, db);
         const char* profileName = db->getProfilingNS();
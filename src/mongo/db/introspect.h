@@ -47,6 +47,13 @@ namespace mongo {
 
     void profile(const Client& c, int op, CurOp& currentOp);
 
+    /**
+     * Profile records are written by a background thread; wait here until
+     * everything enqueued so far is in system.profile.  For tests and
+     * diagnostics - operations never need to wait on profiling.
+     */
+    void profileFlush();
+
     /**
      * Get (or create) the profile collection
      *
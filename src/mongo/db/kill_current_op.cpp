@@ -28,6 +28,7 @@
 
 #include "mongo/db/kill_current_op.h"
 
+#include <algorithm>
 #include <set>
 
 #include "mongo/bson/util/atomic_int.h"
@@ -35,7 +36,9 @@
 #include "mongo/db/curop.h"
 #include "mongo/platform/random.h"
 #include "mongo/scripting/engine.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/fail_point_service.h"
+#include "mongo/util/time_support.h"
 
 namespace mongo {
 
@@ -217,4 +220,49 @@ namespace {
     void KillCurrentOp::reset() {
         _globalKill = false;
     }
+
+    namespace {
+
+        // per-thread state for checkForInterruptPeriodic()
+        struct InterruptCountdown {
+            InterruptCountdown() : remaining( 1 ), interval( 16 ), lastCheckMicros( 0 ) {}
+            int remaining;
+            int interval;
+            unsigned long long lastCheckMicros;
+        };
+
+        enum {
+            TargetMicros = 1000,     // aim for one clock consult per ~1ms of work
+            MinInterval  = 8,        // never check more often than every 8 rows
+            MaxInterval  = 64 * 1024 // bounds worst-case kill latency on cheap rows
+        };
+    }
+
+    TSP_DECLARE(InterruptCountdown, interruptCountdown)
+    TSP_DEFINE(InterruptCountdown, interruptCountdown)
+
+    void KillCurrentOp::checkForInterruptPeriodic( bool heedMutex ) {
+        InterruptCountdown* c = interruptCountdown.get();
+        if ( !c ) {
+            c = new InterruptCountdown();
+            interruptCountdown.reset( c );
+        }
+
+        if ( --c->remaining > 0 )
+            return;
+
+        const unsigned long long now = curTimeMicros64();
+        if ( c->lastCheckMicros ) {
+            // retune from the cost observed over the last interval
+            const unsigned long long elapsed = now - c->lastCheckMicros;
+            if ( elapsed > 4 * TargetMicros )
+                c->interval = std::max( c->interval / 2, static_cast<int>( MinInterval ) );
+            else if ( elapsed < TargetMicros / 4 )
+                c->interval = std::min( c->interval * 2, static_cast<int>( MaxInterval ) );
+        }
+        c->lastCheckMicros = now;
+        c->remaining = c->interval;
+
+        checkForInterrupt( heedMutex );
+    }
 }
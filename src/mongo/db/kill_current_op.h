@@ -69,6 +69,17 @@ namespace mongo {
          */
         void checkForInterrupt( bool heedMutex = true );
 
+        /**
+         * Cheap interrupt point for per-row loops (PlanStage::work drivers and
+         * similar): decrements a thread-local countdown and runs the real,
+         * clock-consulting checkForInterrupt() only when it reaches zero.  The
+         * countdown interval auto-tunes from the observed time between checks,
+         * targeting roughly one clock consult per millisecond of work whatever
+         * the per-row cost, so kill/maxTime response stays within a few
+         * milliseconds at near-zero steady-state overhead.
+         */
+        void checkForInterruptPeriodic( bool heedMutex = true );
+
         /** @return "" if not interrupted.  otherwise, you should stop. */
         const char *checkForInterruptNoAssert();
 
@@ -34,27 +34,67 @@
 #include "mongo/db/lockstat.h"
 
 #include "mongo/db/jsobj.h"
+#include "mongo/db/stats/lock_profiler.h"
+#include "mongo/util/concurrency/threadlocal.h"
 
-namespace mongo { 
+namespace mongo {
 
-    BSONObj LockStat::report() const { 
+    namespace {
+        // process-wide thread -> stripe assignment, shared by all LockStat
+        // instances so each thread touches one stripe of each
+        AtomicUInt32 nextLockStatStripe;
+        ThreadLocalValue<unsigned> lockStatStripe;  // 1-based; 0 = unassigned
+    }
+
+    unsigned LockStat::_myStripe() {
+        unsigned ix = lockStatStripe.get();
+        if ( ix == 0 ) {
+            ix = nextLockStatStripe.fetchAndAdd(1) % Stripes + 1;
+            lockStatStripe.set( ix );
+        }
+        return ix - 1;
+    }
+
+    long long LockStat::_sumAcquiring( unsigned no ) const {
+        long long total = 0;
+        for ( int i = 0; i < Stripes; i++ )
+            total += _stripes[i].timeAcquiring[no].load();
+        return total;
+    }
+
+    long long LockStat::_sumLocked( unsigned no ) const {
+        long long total = 0;
+        for ( int i = 0; i < Stripes; i++ )
+            total += _stripes[i].timeLocked[no].load();
+        return total;
+    }
+
+    BSONObj LockStat::report() const {
         BSONObjBuilder b;
 
+        long long locked[N];
+        long long acquiring[N];
+        for ( int i = 0; i < N; i++ ) {
+            locked[i] = _sumLocked( i );
+            acquiring[i] = _sumAcquiring( i );
+        }
+
         BSONObjBuilder t( b.subobjStart( "timeLockedMicros" ) );
-        _append( b , timeLocked );
+        _append( b , locked );
         t.done();
-        
+
         BSONObjBuilder a( b.subobjStart( "timeAcquiringMicros" ) );
-        _append( a , timeAcquiring );
+        _append( a , acquiring );
         a.done();
-        
+
         return b.obj();
     }
 
     void LockStat::report( StringBuilder& builder ) const {
         bool prefixPrinted = false;
         for ( int i=0; i < N; i++ ) {
-            if ( timeLocked[i].load() == 0 )
+            long long locked = _sumLocked( i );
+            if ( locked == 0 )
                 continue;
 
             if ( ! prefixPrinted ) {
@@ -62,20 +102,20 @@ namespace mongo {
                 prefixPrinted = true;
             }
 
-            builder << ' ' << nameFor( i ) << ':' << timeLocked[i].load();
+            builder << ' ' << nameFor( i ) << ':' << locked;
         }
-        
+
     }
 
-    void LockStat::_append( BSONObjBuilder& builder, const AtomicInt64* data ) {
-        if ( data[0].load() || data[1].load() ) {
-            builder.append( "R" , data[0].load() );
-            builder.append( "W" , data[1].load() );
+    void LockStat::_append( BSONObjBuilder& builder, const long long* data ) {
+        if ( data[0] || data[1] ) {
+            builder.append( "R" , data[0] );
+            builder.append( "W" , data[1] );
         }
-        
-        if ( data[2].load() || data[3].load() ) {
-            builder.append( "r" , data[2].load() );
-            builder.append( "w" , data[3].load() );
+
+        if ( data[2] || data[3] ) {
+            builder.append( "r" , data[2] );
+            builder.append( "w" , data[3] );
         }
     }
 
@@ -103,16 +143,19 @@ namespace mongo {
 
 
     void LockStat::recordAcquireTimeMicros( char type , long long micros ) {
-        timeAcquiring[mapNo(type)].fetchAndAdd( micros );
+        _stripes[_myStripe()].timeAcquiring[mapNo(type)].fetchAndAdd( micros );
+        lockprofiler::recordWait( type, micros );
     }
     void LockStat::recordLockTimeMicros( char type , long long micros ) {
-        timeLocked[mapNo(type)].fetchAndAdd( micros );
+        _stripes[_myStripe()].timeLocked[mapNo(type)].fetchAndAdd( micros );
     }
 
     void LockStat::reset() {
-        for ( int i = 0; i < N; i++ ) {
-            timeAcquiring[i].store(0);
-            timeLocked[i].store(0);
+        for ( int s = 0; s < Stripes; s++ ) {
+            for ( int i = 0; i < N; i++ ) {
+                _stripes[s].timeAcquiring[i].store(0);
+                _stripes[s].timeLocked[i].store(0);
+            }
         }
     }
 }
@@ -49,14 +49,25 @@ namespace mongo {
         BSONObj report() const;
         void report( StringBuilder& builder ) const;
 
-        long long getTimeLocked( char type ) const { return timeLocked[mapNo(type)].load(); }
+        long long getTimeLocked( char type ) const { return _sumLocked( mapNo(type) ); }
+        long long getTimeAcquiring( char type ) const { return _sumAcquiring( mapNo(type) ); }
     private:
-        static void _append( BSONObjBuilder& builder, const AtomicInt64* data );
-        
-        // RWrw
-        // in micros
-        AtomicInt64 timeAcquiring[N];
-        AtomicInt64 timeLocked[N];
+        static void _append( BSONObjBuilder& builder, const long long* data );
+
+        // striped per core so concurrent records from different threads don't
+        // bounce one cacheline; readers sum the stripes.  one stripe is exactly
+        // a cacheline (2 * 4 * 8 bytes).
+        enum { Stripes = 8 };
+        struct Stripe {
+            // RWrw, in micros
+            AtomicInt64 timeAcquiring[N];
+            AtomicInt64 timeLocked[N];
+        };
+        Stripe _stripes[Stripes];
+
+        long long _sumAcquiring( unsigned no ) const;
+        long long _sumLocked( unsigned no ) const;
+        static unsigned _myStripe();
 
         static unsigned mapNo(char type);
         static char nameFor(unsigned offset);
@@ -224,6 +224,16 @@ namespace mongo {
         _otherLock = lock;
     }
 
+    void LockState::lockedCollection( const StringData& ns ) {
+        // on recursive collection locking the innermost collection wins; this is
+        // informational only until the lock manager gains collection granularity
+        _collection = ns.toString();
+    }
+
+    void LockState::unlockedCollection() {
+        _collection.clear();
+    }
+
     void LockState::unlockedOther() {
         // we leave _otherName and _otherLock set as
         // _otherLock exists to cache a pointer
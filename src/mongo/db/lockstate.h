@@ -86,6 +86,13 @@ namespace mongo {
         void enterScopedLock( Lock::ScopedLock* lock );
         Lock::ScopedLock* leaveScopedLock();
 
+        /** collection-granularity bookkeeping (see Lock::CollectionWrite).  the lock
+            actually held is still the db lock; on recursive locking the innermost
+            collection wins. */
+        void lockedCollection( const StringData& ns );
+        void unlockedCollection();
+        const string& lockedCollectionName() const { return _collection; }
+
         void lockedNestable( Lock::Nestable what , int type );
         void unlockedNestable();
         void lockedOther( const StringData& db , int type , WrapperForRWLock* lock );
@@ -108,9 +115,11 @@ namespace mongo {
         int _nestableCount;            // recursive lock count on local or admin db XXX - change name
         
         int _otherCount;               //   >0 means write lock, <0 read lock - XXX change name
-        string _otherName;             // which database are we locking and working with (besides local/admin) 
+        string _otherName;             // which database are we locking and working with (besides local/admin)
         WrapperForRWLock* _otherLock;  // so we don't have to check the map too often (the map has a mutex)
 
+        string _collection;            // which collection, when taken via Lock::Collection{Read,Write}
+
         // for temprelease
         // for the nonrecursive case. otherwise there would be many
         // the first lock goes here, which is ok since we can't yield recursive locks
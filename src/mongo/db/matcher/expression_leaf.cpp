@@ -30,6 +30,8 @@
 
 #include "mongo/db/matcher/expression_leaf.h"
 
+#include <limits>
+
 #include "mongo/bson/bsonobjiterator.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonmisc.h"
@@ -410,9 +412,72 @@ namespace mongo {
             _hasEmptyArray = true;
 
         _equalities.insert( e );
+        if ( isHashableType( e.type() ) )
+            _equalityHash.insert( e );
         return Status::OK();
     }
 
+    bool ArrayFilterEntries::isHashableType( BSONType t ) {
+        switch ( t ) {
+        case NumberDouble:
+        case NumberInt:
+        case NumberLong:
+        case String:
+        case Symbol:
+        case Code:
+        case jstOID:
+        case Bool:
+        case Date:
+        case Timestamp:
+        case BinData:
+        case jstNULL:
+        case Undefined:
+        case MinKey:
+        case MaxKey:
+            return true;
+        default:
+            // Object/Array/DBRef/CodeWScope compare deeply (and numeric-aware), so a
+            // byte-wise hash would split equal values into different buckets.
+            return false;
+        }
+    }
+
+    size_t ArrayFilterEntries::ElementHash::operator()( const BSONElement& e ) const {
+        size_t hash = static_cast<size_t>( canonicalizeBSONType( e.type() ) ) * 2654435761U;
+        switch ( e.type() ) {
+        case NumberDouble:
+        case NumberInt:
+        case NumberLong: {
+            // hash through double so 1, 1LL and 1.0 land in the same bucket, matching
+            // woCompare's numeric equality
+            double d = e.numberDouble();
+            // canonicalize bit patterns woCompare treats as equal: -0.0 equals 0.0,
+            // and all NaN payloads compare alike
+            if ( d == 0 )
+                d = 0.0;
+            else if ( d != d )
+                d = std::numeric_limits<double>::quiet_NaN();
+            size_t valueHash = 0;
+            memcpy( &valueHash, &d, sizeof( double ) < sizeof( size_t ) ?
+                                    sizeof( double ) : sizeof( size_t ) );
+            hash ^= valueHash;
+            break;
+        }
+        case String:
+        case Symbol:
+        case Code:
+            // text only: Symbol and String compare equal on equal text
+            for ( const char* p = e.valuestr(); *p; p++ )
+                hash = hash * 131 + static_cast<unsigned char>( *p );
+            break;
+        default:
+            for ( int i = 0; i < e.valuesize(); i++ )
+                hash = hash * 131 + static_cast<unsigned char>( e.value()[i] );
+            break;
+        }
+        return hash;
+    }
+
     Status ArrayFilterEntries::addRegex( RegexMatchExpression* expr ) {
         _regexes.push_back( expr );
         return Status::OK();
@@ -435,6 +500,7 @@ namespace mongo {
         toFillIn._hasNull = _hasNull;
         toFillIn._hasEmptyArray = _hasEmptyArray;
         toFillIn._equalities = _equalities;
+        toFillIn._equalityHash = _equalityHash;
         for ( unsigned i = 0; i < _regexes.size(); i++ )
             toFillIn._regexes.push_back( static_cast<RegexMatchExpression*>(_regexes[i]->shallowClone()) );
     }
@@ -37,6 +37,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/db/matcher/expression.h"
+#include "mongo/platform/unordered_set.h"
 
 namespace mongo {
 
@@ -282,7 +283,11 @@ namespace mongo {
         Status addRegex( RegexMatchExpression* expr );
 
         const BSONElementSet& equalities() const { return _equalities; }
-        bool contains( const BSONElement& elem ) const { return _equalities.count(elem) > 0; }
+        bool contains( const BSONElement& elem ) const {
+            if ( isHashableType( elem.type() ) )
+                return _equalityHash.count( elem ) > 0;
+            return _equalities.count( elem ) > 0;
+        }
 
         size_t numRegexes() const { return _regexes.size(); }
         RegexMatchExpression* regex( int idx ) const { return _regexes[idx]; }
@@ -297,9 +302,34 @@ namespace mongo {
         void copyTo( ArrayFilterEntries& toFillIn ) const;
 
     private:
+        /**
+         * Value hash consistent with the woCompare-without-fieldname equality used by
+         * _equalities: elements that compare equal hash equal.  Numbers hash through
+         * their double value (so NumberInt 1 == NumberDouble 1.0), Strings and Symbols
+         * through their text.  See isHashableType() for what is admitted.
+         */
+        struct ElementHash {
+            size_t operator()( const BSONElement& e ) const;
+        };
+
+        struct ElementEq {
+            bool operator()( const BSONElement& a, const BSONElement& b ) const {
+                return a.woCompare( b, false ) == 0;
+            }
+        };
+
+        /**
+         * True for types whose woCompare equality we can mirror with a hash: notably NOT
+         * Object/Array (deep numeric-aware comparison) which stay on the tree set.
+         */
+        static bool isHashableType( BSONType t );
+
         bool _hasNull; // if _equalities has a jstNULL element in it
         bool _hasEmptyArray;
         BSONElementSet _equalities;
+        // Hash index over the hashable subset of _equalities; makes $in probes on big
+        // lists O(1) instead of O(log n) woCompares.
+        unordered_set<BSONElement, ElementHash, ElementEq> _equalityHash;
         std::vector<RegexMatchExpression*> _regexes;
     };
 
@@ -1416,6 +1416,61 @@ namespace mongo {
     }
 
 
+    TEST( InMatchExpression, MatchesCrossTypeNumbersHashed ) {
+        // numbers probe the hash index; equality must hold across numeric types
+        BSONObj operand = BSON_ARRAY( 1 << 2.5 << 3LL );
+        InMatchExpression in;
+        in.getArrayFilterEntries()->addEquality( operand[0] );
+        in.getArrayFilterEntries()->addEquality( operand[1] );
+        in.getArrayFilterEntries()->addEquality( operand[2] );
+
+        ASSERT( in.matchesSingleElement( BSON( "" << 1.0 ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "" << 1LL ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "" << 2.5 ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "" << 3 ).firstElement() ) );
+        ASSERT( !in.matchesSingleElement( BSON( "" << 4 ).firstElement() ) );
+    }
+
+    TEST( InMatchExpression, MatchesNegativeZeroHashed ) {
+        // -0.0 and 0.0 have different bit patterns but compare equal; both must
+        // land in the same hash bucket
+        BSONObj operand = BSON_ARRAY( -0.0 );
+        InMatchExpression in;
+        in.getArrayFilterEntries()->addEquality( operand[0] );
+
+        ASSERT( in.matchesSingleElement( BSON( "" << 0.0 ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "" << 0 ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "" << -0.0 ).firstElement() ) );
+        ASSERT( !in.matchesSingleElement( BSON( "" << 1 ).firstElement() ) );
+    }
+
+    TEST( InMatchExpression, MatchesLargeListHashed ) {
+        InMatchExpression in;
+        BSONArrayBuilder bab;
+        for ( int i = 0; i < 1000; i += 2 )
+            bab.append( i );
+        BSONArray operand = bab.arr();
+        BSONObjIterator it( operand );
+        while ( it.more() )
+            in.getArrayFilterEntries()->addEquality( it.next() );
+
+        ASSERT( in.matchesSingleElement( BSON( "" << 0 ).firstElement() ) );
+        ASSERT( in.matchesSingleElement( BSON( "" << 998.0 ).firstElement() ) );
+        ASSERT( !in.matchesSingleElement( BSON( "" << 999 ).firstElement() ) );
+        ASSERT( !in.matchesSingleElement( BSON( "" << "0" ).firstElement() ) );
+    }
+
+    TEST( InMatchExpression, MatchesObjectOnTreePath ) {
+        // Objects compare deeply, so they bypass the hash index; make sure the numeric-
+        // aware equality still holds for embedded values.
+        BSONObj operand = BSON_ARRAY( BSON( "x" << 1 ) );
+        InMatchExpression in;
+        in.getArrayFilterEntries()->addEquality( operand.firstElement() );
+
+        ASSERT( in.matchesSingleElement( BSON( "" << BSON( "x" << 1.0 ) ).firstElement() ) );
+        ASSERT( !in.matchesSingleElement( BSON( "" << BSON( "x" << 2 ) ).firstElement() ) );
+    }
+
     TEST( InMatchExpression, MatchesScalar ) {
         BSONObj operand = BSON_ARRAY( 5 );
         InMatchExpression in;
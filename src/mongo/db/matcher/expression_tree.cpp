@@ -30,10 +30,13 @@
 
 #include "mongo/db/matcher/expression_tree.h"
 
+#include <algorithm>
+
 #include "mongo/bson/bsonobjiterator.h"
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonmisc.h"
 #include "mongo/util/log.h"
+#include "mongo/util/timer.h"
 
 namespace mongo {
 
@@ -71,16 +74,89 @@ namespace mongo {
         return true;
     }
 
+    void ListOfMatchExpression::_prepareEvalOrder() const {
+        if ( _evalOrder.size() == _expressions.size() )
+            return;
+        _evalOrder.resize( _expressions.size() );
+        for ( size_t i = 0; i < _evalOrder.size(); i++ )
+            _evalOrder[i] = i;
+        _childStats.assign( _expressions.size(), ChildStats() );
+        _docsSinceReorder = 0;
+    }
+
+    namespace {
+        // sorts eval-order entries by precomputed score, highest first; stable
+        // so ties keep their current (initially parse) order
+        struct ScoreOrder {
+            ScoreOrder( const std::vector<double>& scores ) : _scores( scores ) {}
+            bool operator()( size_t a, size_t b ) const { return _scores[a] > _scores[b]; }
+            const std::vector<double>& _scores;
+        };
+    }
+
+    void ListOfMatchExpression::_reorderChildren() const {
+        std::vector<double> scores( _childStats.size() );
+        for ( size_t i = 0; i < _childStats.size(); i++ ) {
+            const ChildStats& s = _childStats[i];
+            double rate = s.evals ? static_cast<double>( s.shortCircuits ) / s.evals : 0;
+            double costMicros = s.sampledEvals ?
+                static_cast<double>( s.sampledMicros ) / s.sampledEvals : 0;
+            scores[i] = rate / ( 1 + costMicros );
+        }
+        std::stable_sort( _evalOrder.begin(), _evalOrder.end(), ScoreOrder( scores ) );
+
+        // decay the history so the order can track shifting data, without
+        // forgetting everything learned so far
+        for ( size_t i = 0; i < _childStats.size(); i++ ) {
+            ChildStats& s = _childStats[i];
+            s.evals /= 2;
+            s.shortCircuits /= 2;
+            s.sampledEvals /= 2;
+            s.sampledMicros /= 2;
+        }
+        _docsSinceReorder = 0;
+    }
+
     // -----
 
     bool AndMatchExpression::matches( const MatchableDocument* doc, MatchDetails* details ) const {
-        for ( size_t i = 0; i < numChildren(); i++ ) {
-            if ( !getChild(i)->matches( doc, details ) ) {
-                if ( details )
+        if ( details ) {
+            // details (elemMatchKey) depend on parse-order evaluation; keep
+            // the historical behavior on this rare path
+            for ( size_t i = 0; i < numChildren(); i++ ) {
+                if ( !getChild(i)->matches( doc, details ) ) {
                     details->resetOutput();
+                    return false;
+                }
+            }
+            return true;
+        }
+
+        _prepareEvalOrder();
+        const bool sampleCost = ( _docsSinceReorder % CostSampleEvery ) == 0;
+        for ( size_t k = 0; k < numChildren(); k++ ) {
+            const size_t i = _evalOrder[k];
+            ChildStats& s = _childStats[i];
+            s.evals++;
+            bool m;
+            if ( sampleCost ) {
+                Timer t;
+                m = getChild(i)->matches( doc, NULL );
+                s.sampledMicros += t.micros();
+                s.sampledEvals++;
+            }
+            else {
+                m = getChild(i)->matches( doc, NULL );
+            }
+            if ( !m ) {
+                s.shortCircuits++;
+                if ( ++_docsSinceReorder >= ReorderInterval )
+                    _reorderChildren();
                 return false;
             }
         }
+        if ( ++_docsSinceReorder >= ReorderInterval )
+            _reorderChildren();
         return true;
     }
 
@@ -130,11 +206,32 @@ namespace mongo {
     // ----
 
     bool NorMatchExpression::matches( const MatchableDocument* doc, MatchDetails* details ) const {
-        for ( size_t i = 0; i < numChildren(); i++ ) {
-            if ( getChild(i)->matches( doc, NULL ) ) {
+        _prepareEvalOrder();
+        const bool sampleCost = ( _docsSinceReorder % CostSampleEvery ) == 0;
+        for ( size_t k = 0; k < numChildren(); k++ ) {
+            const size_t i = _evalOrder[k];
+            ChildStats& s = _childStats[i];
+            s.evals++;
+            bool m;
+            if ( sampleCost ) {
+                Timer t;
+                m = getChild(i)->matches( doc, NULL );
+                s.sampledMicros += t.micros();
+                s.sampledEvals++;
+            }
+            else {
+                m = getChild(i)->matches( doc, NULL );
+            }
+            if ( m ) {
+                // for $nor a matching child is the short-circuit
+                s.shortCircuits++;
+                if ( ++_docsSinceReorder >= ReorderInterval )
+                    _reorderChildren();
                 return false;
             }
         }
+        if ( ++_docsSinceReorder >= ReorderInterval )
+            _reorderChildren();
         return true;
     }
 
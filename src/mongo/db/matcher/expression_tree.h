@@ -42,7 +42,7 @@ namespace mongo {
 
     class ListOfMatchExpression : public MatchExpression {
     public:
-        ListOfMatchExpression( MatchType type ) : MatchExpression( type ){}
+        ListOfMatchExpression( MatchType type ) : MatchExpression( type ), _docsSinceReorder( 0 ){}
         virtual ~ListOfMatchExpression();
 
         /**
@@ -67,6 +67,40 @@ namespace mongo {
     protected:
         void _debugList( StringBuilder& debug, int level ) const;
 
+        /**
+         * Adaptive evaluation order for the short-circuiting lists ($and and
+         * $nor).  Children keep their parse order in _expressions -- the
+         * planner, debug output and equivalent() depend on it -- but matches()
+         * walks _evalOrder instead, which is periodically resorted so the
+         * child that short-circuits the most documents per unit cost runs
+         * first.  A short-circuit is a rejection for $and and a match for
+         * $nor.  Cost is sampled with a timer on 1 in CostSampleEvery
+         * documents; children too cheap to register (sub-microsecond) are
+         * treated as equal cost, so they order purely by short-circuit rate.
+         *
+         * A MatchExpression is only evaluated by one thread at a time, so the
+         * mutable counters need no synchronization.
+         */
+        enum { ReorderInterval = 4096, CostSampleEvery = 64 };
+
+        struct ChildStats {
+            ChildStats() : evals( 0 ), shortCircuits( 0 ), sampledEvals( 0 ), sampledMicros( 0 ) {}
+            long long evals;
+            long long shortCircuits;
+            long long sampledEvals;
+            long long sampledMicros;
+        };
+
+        /** (re)build the identity order when the child list changed size */
+        void _prepareEvalOrder() const;
+
+        /** resort _evalOrder by short-circuits per eval per sampled cost */
+        void _reorderChildren() const;
+
+        mutable std::vector<size_t> _evalOrder;
+        mutable std::vector<ChildStats> _childStats;
+        mutable long long _docsSinceReorder;
+
     private:
         std::vector< MatchExpression* > _expressions;
     };
@@ -179,6 +179,30 @@ namespace mongo {
         ASSERT( !andOp.matchesBSON( BSON( "a" << 10 << "b" << 6 ), NULL ) );
     }
 
+    TEST( AndOp, AdaptiveReorderKeepsSemantics ) {
+        // drive enough documents through an $and to trigger the periodic
+        // evaluation-order resort (the rejecting clause is listed last, so the
+        // resort will promote it) and check results are unchanged throughout
+        BSONObj baseOperand1 = BSON( "$gt" << 1 );
+        BSONObj baseOperand2 = BSON( "$lt" << 10 );
+
+        auto_ptr<ComparisonMatchExpression> sub1( new GTMatchExpression() );
+        ASSERT( sub1->init( "a", baseOperand1[ "$gt" ] ).isOK() );
+
+        auto_ptr<ComparisonMatchExpression> sub2( new LTMatchExpression() );
+        ASSERT( sub2->init( "a", baseOperand2[ "$lt" ] ).isOK() );
+
+        AndMatchExpression andOp;
+        andOp.add( sub1.release() );
+        andOp.add( sub2.release() );
+
+        for ( int i = 0; i < 20000; i++ ) {
+            ASSERT( !andOp.matchesBSON( BSON( "a" << 50 ), NULL ) ); // second clause rejects
+            ASSERT( andOp.matchesBSON( BSON( "a" << 5 ), NULL ) );
+            ASSERT( !andOp.matchesBSON( BSON( "a" << 0 ), NULL ) ); // first clause rejects
+        }
+    }
+
     TEST( AndOp, ElemMatchKey ) {
         BSONObj baseOperand1 = BSON( "a" << 1 );
         BSONObj baseOperand2 = BSON( "b" << 2 );
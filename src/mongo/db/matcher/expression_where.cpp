@@ -101,6 +101,9 @@ namespace mongo {
         if ( !_func )
             return Status( ErrorCodes::BadValue, "$where compile error" );
 
+        // constant across documents, so set once here rather than per match
+        _scope->setBoolean( "fullObject" , true ); // this is a hack b/c fullObject used to be relevant
+
         return Status::OK();
     }
 
@@ -111,10 +114,10 @@ namespace mongo {
         if ( ! _userScope.isEmpty() ) {
             _scope->init( &_userScope );
         }
-        _scope->setObject( "obj", const_cast< BSONObj & >( obj ) );
-        _scope->setBoolean( "fullObject" , true ); // this is a hack b/c fullObject used to be relevant
 
-        int err = _scope->invoke( _func, 0, &obj, 1000 * 60, false );
+        // hands the document over once, as a lazy wrapper shared between the global
+        // "obj" and 'this'; only fields the function touches are materialized
+        int err = _scope->invokeWithDocument( _func, obj, 1000 * 60 );
         if ( err == -3 ) { // INVOKE_ERROR
             stringstream ss;
             ss << "error on invocation of $where function:\n"
@@ -37,6 +37,7 @@ namespace mongo {
     BSONMatchableDocument::BSONMatchableDocument( const BSONObj& obj )
         : _obj( obj ) {
         _iteratorUsed = false;
+        _fieldCache.reset( _obj );
     }
 
     BSONMatchableDocument::~BSONMatchableDocument() {
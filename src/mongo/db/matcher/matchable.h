@@ -82,9 +82,9 @@ namespace mongo {
 
         virtual ElementIterator* allocateIterator( const ElementPath* path ) const {
             if ( _iteratorUsed )
-                return new BSONElementIterator( path, _obj );
+                return new BSONElementIterator( path, _obj, &_fieldCache );
             _iteratorUsed = true;
-            _iterator.reset( path, _obj );
+            _iterator.reset( path, _obj, &_fieldCache );
             return &_iterator;
         }
 
@@ -101,5 +101,7 @@ namespace mongo {
         BSONObj _obj;
         mutable BSONElementIterator _iterator;
         mutable bool _iteratorUsed;
+        // top-level elements resolved once per document, probed by every predicate
+        mutable TopLevelFieldCache _fieldCache;
     };
 }
@@ -43,6 +43,36 @@ namespace mongo {
 
     // -----
 
+    void TopLevelFieldCache::reset( const BSONObj& doc ) {
+        _doc = doc;
+        _built = false;
+        _probes = 0;
+        _fields.clear();
+    }
+
+    BSONElement TopLevelFieldCache::find( const StringData& firstPart ) {
+        if ( !_built ) {
+            if ( _probes++ < ProbesBeforeBuild ) {
+                return _doc.getField( firstPart );
+            }
+            BSONObjIterator i( _doc );
+            while ( i.more() ) {
+                BSONElement e = i.next();
+                // insert, not assignment: with duplicate field names getField
+                // returns the first, so keep the first
+                _fields.insert( std::make_pair( StringData( e.fieldName() ), e ) );
+            }
+            _built = true;
+        }
+        unordered_map<StringData, BSONElement, StringData::Hasher>::const_iterator it =
+            _fields.find( firstPart );
+        if ( it == _fields.end() )
+            return BSONElement();
+        return it->second;
+    }
+
+    // -----
+
     ElementIterator::~ElementIterator(){
     }
 
@@ -87,10 +117,12 @@ namespace mongo {
     // ------
     BSONElementIterator::BSONElementIterator() {
         _path = NULL;
+        _cache = NULL;
     }
 
-    BSONElementIterator::BSONElementIterator( const ElementPath* path, const BSONObj& context )
-        : _path( path ), _context( context ) {
+    BSONElementIterator::BSONElementIterator( const ElementPath* path, const BSONObj& context,
+                                              TopLevelFieldCache* cache )
+        : _path( path ), _context( context ), _cache( cache ) {
         _state = BEGIN;
         //log() << "path: " << path.fieldRef().dottedField() << " context: " << context << endl;
     }
@@ -98,9 +130,11 @@ namespace mongo {
     BSONElementIterator::~BSONElementIterator() {
     }
 
-    void BSONElementIterator::reset( const ElementPath* path, const BSONObj& context ) {
+    void BSONElementIterator::reset( const ElementPath* path, const BSONObj& context,
+                                     TopLevelFieldCache* cache ) {
         _path = path;
         _context = context;
+        _cache = cache;
         _state = BEGIN;
         _next.reset();
 
@@ -177,7 +211,7 @@ namespace mongo {
 
         if ( _state == BEGIN ) {
             size_t idxPath = 0;
-            BSONElement e = getFieldDottedOrArray( _context, _path->fieldRef(), &idxPath );
+            BSONElement e = getFieldDottedOrArray( _context, _path->fieldRef(), &idxPath, _cache );
 
             if ( e.type() != Array ) {
                 _next.reset( e, BSONElement(), false );
@@ -37,6 +37,7 @@
 #include "mongo/bson/bsonobj.h"
 #include "mongo/bson/bsonobjiterator.h"
 #include "mongo/db/field_ref.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
 
@@ -54,6 +55,36 @@ namespace mongo {
         bool _shouldTraverseLeafArray;
     };
 
+    /**
+     * Per-document scratch table of top-level elements, shared across all the
+     * predicates of an expression tree.  Every leaf's path walk starts by scanning
+     * the top level of the document for its first path component, so a 12 predicate
+     * filter walks the same fields 12 times per document.  A MatchableDocument owns
+     * one of these and hands it to the iterators it allocates; the first few probes
+     * fall back to a plain scan (so a 1 or 2 predicate filter pays nothing), after
+     * which the table is built in one walk and probed by the remaining predicates.
+     */
+    class TopLevelFieldCache {
+    public:
+        TopLevelFieldCache() : _built( false ), _probes( 0 ) {}
+
+        /** (re)attach to a document; drops anything cached */
+        void reset( const BSONObj& doc );
+
+        /** @return the first top-level element named firstPart, eoo() if absent */
+        BSONElement find( const StringData& firstPart );
+
+    private:
+        // build the table below this many probes isn't worth a document walk
+        static const int ProbesBeforeBuild = 4;
+
+        BSONObj _doc;
+        bool _built;
+        int _probes;
+        // field name -> element; the StringData keys point into _doc's buffer
+        unordered_map<StringData, BSONElement, StringData::Hasher> _fields;
+    };
+
     class ElementIterator {
     public:
         class Context {
@@ -116,11 +147,18 @@ namespace mongo {
     class BSONElementIterator : public ElementIterator {
     public:
         BSONElementIterator();
-        BSONElementIterator( const ElementPath* path, const BSONObj& context );
+
+        /**
+         * @param cache optional shared table of context's top-level elements,
+         *              owned by the MatchableDocument; see TopLevelFieldCache
+         */
+        BSONElementIterator( const ElementPath* path, const BSONObj& context,
+                             TopLevelFieldCache* cache = NULL );
 
         virtual ~BSONElementIterator();
 
-        void reset( const ElementPath* path, const BSONObj& context );
+        void reset( const ElementPath* path, const BSONObj& context,
+                    TopLevelFieldCache* cache = NULL );
 
         bool more();
         Context next();
@@ -128,6 +166,7 @@ namespace mongo {
     private:
         const ElementPath* _path;
         BSONObj _context;
+        TopLevelFieldCache* _cache; // not owned here; may be NULL
 
         enum State { BEGIN, IN_ARRAY, DONE } _state;
         Context _next;
@@ -30,6 +30,8 @@
 
 #include "mongo/db/matcher/path_internal.h"
 
+#include "mongo/db/matcher/path.h"
+
 namespace mongo {
 
     bool isAllDigits( const StringData& str ) {
@@ -42,7 +44,8 @@ namespace mongo {
 
     BSONElement getFieldDottedOrArray( const BSONObj& doc,
                                        const FieldRef& path,
-                                       size_t* idxPath ) {
+                                       size_t* idxPath,
+                                       TopLevelFieldCache* cache ) {
         if ( path.numParts() == 0 )
             return doc.getField( "" );
 
@@ -53,7 +56,10 @@ namespace mongo {
         size_t partNum = 0;
         while ( partNum < path.numParts() && !stop ) {
 
-            res = curr.getField( path.getPart( partNum ) );
+            if ( partNum == 0 && cache )
+                res = cache->find( path.getPart( 0 ) );
+            else
+                res = curr.getField( path.getPart( partNum ) );
 
             switch ( res.type() ) {
 
@@ -37,12 +37,17 @@
 
 namespace mongo {
 
+    class TopLevelFieldCache;
+
     bool isAllDigits( const StringData& str );
 
     // XXX document me
     // Replaces getFieldDottedOrArray without recursion nor string manipulation
+    // @param cache if set, the first path part is looked up through the shared
+    //              per-document table instead of scanning doc (see path.h)
     BSONElement getFieldDottedOrArray( const BSONObj& doc,
                                        const FieldRef& path,
-                                       size_t* idxPath );
+                                       size_t* idxPath,
+                                       TopLevelFieldCache* cache = NULL );
 
 }  // namespace mongo
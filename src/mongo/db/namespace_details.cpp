@@ -252,6 +252,33 @@ namespace mongo {
        returned item is out of the deleted list upon return
     */
     DiskLoc NamespaceDetails::__stdAlloc(int len, bool peekOnly) {
+
+        // Fast path for powerOf2Sizes collections: allocation sizes are exact bucket
+        // sizes, so the head of bucket(len) either fits or nothing there will, and
+        // every record in a higher bucket is guaranteed to fit.  Pop a head in O(1)
+        // instead of best-fit scanning the chains -- on high-churn collections the
+        // scan is the longest component of the write-lock critical section.
+        if ( isUserFlagSet( Flag_UsePowerOf2Sizes ) ) {
+            for ( int b = bucket(len); b <= MaxBucket; b++ ) {
+                DiskLoc head = _deletedList[b];
+                if ( head.isNull() )
+                    continue;
+                DeletedRecord *r = head.drec();
+                if ( r->lengthWithHeaders() < len ) {
+                    // undersized head (legacy record or split remnant) in the home
+                    // bucket; a deeper entry may still fit, so use the full scan
+                    break;
+                }
+                if ( !peekOnly ) {
+                    *getDur().writing( &_deletedList[b] ) = r->nextDeleted();
+                    r->nextDeleted().writing().setInvalid(); // defensive.
+                    verify( r->extentOfs() < head.getOfs() );
+                }
+                return head;
+            }
+            // fall through: home bucket head too small, or all buckets empty
+        }
+
         DiskLoc *prev;
         DiskLoc *bestprev = 0;
         DiskLoc bestmatch;
@@ -33,8 +33,14 @@
 #include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/database.h"
+#include "mongo/db/exec/count.h"
+#include "mongo/db/exec/working_set.h"
 #include "mongo/db/structure/collection.h"
 #include "mongo/db/query/get_runner.h"
+#include "mongo/db/query/index_bounds_builder.h"
+#include "mongo/db/query/internal_runner.h"
+#include "mongo/db/query/query_planner.h"
+#include "mongo/db/query/query_solution.h"
 
 namespace mongo {
 
@@ -64,6 +70,103 @@ namespace mongo {
         return num;
     }
 
+    /**
+     * Count by walking index entries only: if some plan answers the query with a single
+     * exact interval over one non-multikey index, tally its entries with a Count stage
+     * instead of fetching documents.  Returns false when no such plan exists and the
+     * caller must fall back on a regular runner.
+     */
+    static bool runIndexOnlyCount(Collection* collection,
+                                  const CanonicalQuery& cq,
+                                  long long* result) {
+        QueryPlannerParams plannerParams;
+
+        IndexCatalog::IndexIterator ii = collection->getIndexCatalog()->getIndexIterator(false);
+        while (ii.more()) {
+            const IndexDescriptor* desc = ii.next();
+            plannerParams.indices.push_back(IndexEntry(desc->keyPattern(),
+                                                       desc->isMultikey(),
+                                                       desc->isSparse(),
+                                                       desc->indexName(),
+                                                       desc->infoObj()));
+        }
+
+        if (plannerParams.indices.empty()) {
+            return false;
+        }
+
+        // Note: no INCLUDE_COLLSCAN; only indexed solutions can count without fetching.
+        vector<QuerySolution*> solutions;
+        if (!QueryPlanner::plan(cq, plannerParams, &solutions).isOK()) {
+            return false;
+        }
+
+        CountParams params;
+        bool eligible = false;
+        for (size_t i = 0; i < solutions.size(); ++i) {
+            QuerySolutionNode* root = solutions[i]->root.get();
+
+            // The predicate must be answered entirely by the scan's interval: an index
+            // scan with no residual filter, possibly under a fetch that exists only to
+            // produce the document.
+            const IndexScanNode* isn = NULL;
+            if (STAGE_FETCH == root->getType() && NULL == root->filter.get()
+                && STAGE_IXSCAN == root->children[0]->getType()) {
+                isn = static_cast<const IndexScanNode*>(root->children[0]);
+            }
+            else if (STAGE_IXSCAN == root->getType()) {
+                isn = static_cast<const IndexScanNode*>(root);
+            }
+
+            // A multikey index has several entries per document, so entry counts would
+            // overcount documents.
+            if (NULL == isn || NULL != isn->filter.get() || isn->indexIsMultiKey
+                || 1 != isn->direction) {
+                continue;
+            }
+
+            if (!IndexBoundsBuilder::isSingleInterval(isn->bounds,
+                                                      &params.startKey,
+                                                      &params.startKeyInclusive,
+                                                      &params.endKey,
+                                                      &params.endKeyInclusive)) {
+                continue;
+            }
+
+            params.descriptor =
+                collection->getIndexCatalog()->findIndexByKeyPattern(isn->indexKeyPattern);
+            if (NULL == params.descriptor) {
+                continue;
+            }
+
+            eligible = true;
+            break;
+        }
+
+        for (size_t i = 0; i < solutions.size(); ++i) {
+            delete solutions[i];
+        }
+
+        if (!eligible) {
+            return false;
+        }
+
+        WorkingSet* ws = new WorkingSet();
+        Count* count = new Count(params, ws);
+        auto_ptr<Runner> runner(new InternalRunner(collection->ns().ns(), count, ws));
+
+        const ScopedRunnerRegistration safety(runner.get());
+        runner->setYieldPolicy(Runner::YIELD_AUTO);
+
+        // Count never returns results; drive it to EOF and read the tally off the stage.
+        // As with the regular path, a killed runner (collection dropped during yield)
+        // yields the entries counted so far.
+        while (Runner::RUNNER_ADVANCED == runner->getNext(NULL, NULL)) { }
+
+        *result = count->getCount();
+        return true;
+    }
+
     long long runCount( const string& ns, const BSONObj &cmd, string &err, int &errCode ) {
         // Lock 'ns'.
         Client::Context cx(ns);
@@ -95,6 +198,24 @@ namespace mongo {
             return -2;
         }
 
+        // When there's no skip/limit to apply, see if the predicate is answerable from an
+        // index alone so we can count entries without dragging documents into memory.
+        if (0 == skip && 0 == limit) {
+            auto_ptr<CanonicalQuery> cqHolder(cq);
+            try {
+                long long fastCount = 0;
+                if (runIndexOnlyCount(collection, *cq, &fastCount)) {
+                    return fastCount;
+                }
+            }
+            catch (const DBException& e) {
+                err = e.toString();
+                errCode = e.getCode();
+                return -2;
+            }
+            cq = cqHolder.release();
+        }
+
         Runner* rawRunner;
         if (!getRunner(cq, &rawRunner).isOK()) {
             uasserted(17221, "could not get runner " + query.toString());
@@ -45,7 +45,8 @@ namespace mongo {
        justOne: stop after 1 match
        god:     allow access to system namespaces, and don't yield
     */
-    long long deleteObjects(const StringData& ns, BSONObj pattern, bool justOne, bool logop, bool god) {
+    long long deleteObjects(const StringData& ns, BSONObj pattern, bool justOne, bool logop,
+                            bool god, long long limit) {
         if (!god) {
             if (ns.find( ".system.") != string::npos) {
                 // note a delete from system.indexes would corrupt the db if done here, as there are
@@ -96,6 +97,68 @@ namespace mongo {
 
         DiskLoc rloc;
         Runner::RunnerState state;
+
+        if (!canYield && !justOne) {
+            // Batched path.  The runner cannot yield, so buffered DiskLocs cannot be
+            // invalidated by concurrent writers before we flush them; deleting a batch at
+            // a time lets each index remove the batch's keys in key order instead of one
+            // btree descent per document (see Collection::deleteDocuments).
+            const long long maxBatchDocs = 256;
+
+            vector<DiskLoc> batch;
+            vector<BSONObj> deletedIds;
+            bool more = true;
+            while (more) {
+                batch.clear();
+                deletedIds.clear();
+
+                while (more && static_cast<long long>(batch.size()) < maxBatchDocs) {
+                    if (Runner::RUNNER_ADVANCED != runner->getNext(NULL, &rloc)) {
+                        more = false;
+                        break;
+                    }
+                    batch.push_back(rloc);
+                    if (limit > 0 && nDeleted + static_cast<long long>(batch.size()) >= limit) {
+                        more = false;
+                    }
+                }
+
+                if (batch.empty()) {
+                    break;
+                }
+
+                runner->saveState();
+                collection->deleteDocuments(batch, false, logop ? &deletedIds : NULL);
+                runner->restoreState();
+
+                nDeleted += batch.size();
+
+                if (logop) {
+                    for (size_t i = 0; i < deletedIds.size(); i++) {
+                        if (deletedIds[i].isEmpty()) {
+                            problem() << "deleted object without id, not logging" << endl;
+                        }
+                        else {
+                            bool replJustOne = true;
+                            logOp("d", nsForLogOp.c_str(), deletedIds[i], 0, &replJustOne);
+                        }
+                    }
+                }
+
+                if (!god) {
+                    getDur().commitIfNeeded();
+                }
+
+                if (debug && god &&
+                    nDeleted >= 100 && nDeleted - static_cast<long long>(batch.size()) < 100) {
+                    log() << "warning high number of deletes with god=true "
+                          << " which could use significant memory b/c we don't commit journal";
+                }
+            }
+
+            return nDeleted;
+        }
+
         while (Runner::RUNNER_ADVANCED == (state = runner->getNext(NULL, &rloc))) {
 
             BSONObj toDelete;
@@ -122,6 +185,10 @@ namespace mongo {
                 break;
             }
 
+            if (limit > 0 && nDeleted >= limit) {
+                break;
+            }
+
             if (!god) {
                 getDur().commitIfNeeded();
             }
@@ -35,10 +35,13 @@
 namespace mongo {
 
     // If justOne is true, deletedId is set to the id of the deleted object.
+    // If limit is greater than zero, stop after deleting that many documents;
+    // callers (e.g. the TTL monitor) use this to bound the work done per call.
     long long deleteObjects(const StringData& ns,
                             BSONObj pattern,
                             bool justOne,
                             bool logop = false,
-                            bool god = false);
+                            bool god = false,
+                            long long limit = 0);
 
 }
@@ -124,6 +124,55 @@ namespace mongo {
         return StatusWith<BSONObj>( b.obj() );
     }
 
+    StatusWith<BSONObj> fixDocumentForInsert( const BSONObj& doc, const ValidatedDocInfo& info ) {
+        if ( doc.objsize() > BSONObjMaxUserSize )
+            return StatusWith<BSONObj>( ErrorCodes::BadValue,
+                                        str::stream()
+                                        << "object to insert too large"
+                                        << doc.objsize() );
+
+        // rare shapes fall back to the walking version above, which produces
+        // the detailed errors and timestamp rewrites
+        if ( info.hasDollarField || info.hasZeroTimestamp || info.hasDuplicateId )
+            return fixDocumentForInsert( doc );
+
+        if ( info.idOffset ) {
+            BSONElement e( doc.objdata() + info.idOffset );
+            if ( e.type() == RegEx ) {
+                return StatusWith<BSONObj>( ErrorCodes::BadValue,
+                                            "can't use a regex for _id" );
+            }
+            if ( e.type() == Undefined ) {
+                return StatusWith<BSONObj>( ErrorCodes::BadValue,
+                                            "can't use a undefined for _id" );
+            }
+            if ( e.type() == Array ) {
+                return StatusWith<BSONObj>( ErrorCodes::BadValue,
+                                            "can't use an array for _id" );
+            }
+            if ( info.idOffset == 4 ) {
+                // _id is the first element: insert the document as-is
+                return StatusWith<BSONObj>( BSONObj() );
+            }
+        }
+
+        // _id missing or not first: rebuild with _id leading
+        BSONObjBuilder b( doc.objsize() + 16 );
+        if ( info.idOffset )
+            b.append( BSONElement( doc.objdata() + info.idOffset ) );
+        else
+            b.appendOID( "_id", NULL, true );
+
+        BSONObjIterator i( doc );
+        while ( i.more() ) {
+            BSONElement e = i.next();
+            if ( info.idOffset && e.fieldNameStringData() == "_id" )
+                continue;
+            b.append( e );
+        }
+        return StatusWith<BSONObj>( b.obj() );
+    }
+
     Status userAllowedWriteNS( const StringData& ns ) {
         return userAllowedWriteNS( nsToDatabaseSubstring( ns ), nsToCollectionSubstring( ns ) );
     }
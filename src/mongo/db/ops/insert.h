@@ -29,6 +29,7 @@
  */
 
 #include "mongo/db/jsobj.h"
+#include "mongo/bson/bson_validate.h"
 #include "mongo/db/namespace_string.h"
 
 namespace mongo {
@@ -39,6 +40,13 @@ namespace mongo {
      */
     StatusWith<BSONObj> fixDocumentForInsert( const BSONObj& doc );
 
+    /**
+     * As above, but trusts the facts a validating scan already collected
+     * (see DbMessage::nextJsObjScanned), so the common case -- _id leading,
+     * no $-fields, no zero timestamps -- does no walk at all.
+     */
+    StatusWith<BSONObj> fixDocumentForInsert( const BSONObj& doc, const ValidatedDocInfo& info );
+
 
     /**
      * check if this is a collection _any_ user can write to
@@ -69,6 +69,9 @@ namespace mongo {
         virtual Status init(const BSONElement& modExpr, const Options& opts,
                             bool* positional = NULL);
 
+        /** init() fully overwrites _fieldRef, _posDollar, and _val, so re-binding is safe. */
+        virtual bool canRebind() const { return true; }
+
         /** Evaluates the validity of applying $inc to the identified node, and computes
          *  effects, handling upcasting and overflow as necessary.
          */
@@ -93,6 +93,16 @@ namespace mongo {
         virtual Status init(const BSONElement& modExpr, const Options& opts,
                             bool* positional = NULL) = 0;
 
+        /**
+         * Returns true if this mod may be bound to a new modExpr of the same shape
+         * (same operator, same field path) by simply calling init() again, with no
+         * state left over from the previous binding.  Mods whose init() appends to
+         * internal collections or whose argument carries structural meaning (e.g.
+         * $rename's target path) must leave this false.  Used by the update driver
+         * cache to rebind compiled drivers with fresh values.
+         */
+        virtual bool canRebind() const { return false; }
+
         /**
          * Returns OK if it would be correct to apply this mod over the document 'root' (e.g, if
          * we're $inc-ing a field, is that field numeric in the current doc?).
@@ -64,6 +64,9 @@ namespace mongo {
         virtual Status init(const BSONElement& modExpr, const Options& opts,
                             bool* positional = NULL);
 
+        /** init() fully overwrites _fieldRef, _posDollar, and _val, so re-binding is safe. */
+        virtual bool canRebind() const { return true; }
+
         /**
          * Looks up the field name in the sub-tree rooted at 'root', and binds, if necessary,
          * the '$' field part using the 'matchedfield' number. prepare() returns OK and
@@ -63,6 +63,9 @@ namespace mongo {
         virtual Status init(const BSONElement& modExpr, const Options& opts,
                             bool* positional = NULL);
 
+        /** init() fully overwrites _fieldRef and _posDollar, so re-binding is safe. */
+        virtual bool canRebind() const { return true; }
+
         /**
          * Locates the field to be removed under the 'root' element, if it exist, and fills in
          * 'execInfo' accordingly. Return OK if successful or a status describing the error.
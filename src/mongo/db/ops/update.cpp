@@ -42,6 +42,7 @@
 #include "mongo/db/index_set.h"
 #include "mongo/db/namespace_details.h"
 #include "mongo/db/ops/update_driver.h"
+#include "mongo/db/ops/update_driver_cache.h"
 #include "mongo/db/ops/update_lifecycle.h"
 #include "mongo/db/pagefault.h"
 #include "mongo/db/pdfile.h"
@@ -435,14 +436,31 @@ namespace mongo {
         opts.upsert = request.isUpsert();
         opts.logOp = request.shouldCallLogOp();
         opts.modOptions = ModifierInterface::Options(request.isFromReplication(), shouldValidate);
-        UpdateDriver driver(opts);
 
-        Status status = driver.parse(request.getUpdates());
-        if (!status.isOK()) {
-            uasserted(16840, status.reason());
+        // Mods keep references into the expression they were parsed from, so bind the
+        // driver to an owned copy that stays alive (with the driver) across cache trips.
+        BSONObj boundExpr = request.getUpdates().getOwned();
+
+        // Repetitive workloads issue same-shaped update expressions over and over; re-use
+        // a cached driver when one is available rather than re-parsing and rebuilding the
+        // modifier objects each time.
+        auto_ptr<UpdateDriver> driver(
+            updateDriverCache().checkOut(boundExpr, opts, &boundExpr));
+
+        if (!driver.get()) {
+            driver.reset(new UpdateDriver(opts));
+            Status status = driver->parse(boundExpr);
+            if (!status.isOK()) {
+                uasserted(16840, status.reason());
+            }
         }
 
-        return update(request, opDebug, &driver);
+        UpdateResult result = update(request, opDebug, driver.get());
+
+        // Only reached on success; a throwing update just drops the driver.
+        updateDriverCache().checkIn(boundExpr, driver.release());
+
+        return result;
     }
 
     UpdateResult update(const UpdateRequest& request, OpDebug* opDebug, UpdateDriver* driver) {
@@ -668,18 +686,13 @@ namespace mongo {
                 // no work to do, in which case we want to consider the object unchanged.
                 if (!damages.empty() ) {
 
-                    collection->details()->paddingFits();
-
-                    // All updates were in place. Apply them via durability and writing pointer.
-                    mutablebson::DamageVector::const_iterator where = damages.begin();
-                    const mutablebson::DamageVector::const_iterator end = damages.end();
-                    for( ; where != end; ++where ) {
-                        const char* sourcePtr = source + where->sourceOffset;
-                        void* targetPtr = getDur().writingPtr(
-                            const_cast<char*>(oldObj.objdata()) + where->targetOffset,
-                            where->size);
-                        std::memcpy(targetPtr, sourcePtr, where->size);
-                    }
+                    // All updates were in place: size and layout are unchanged, no
+                    // index key was touched.  Commit the damaged byte ranges directly
+                    // into the mmapped record; only those ranges are journaled.
+                    uassertStatusOK(collection->updateDocumentWithDamages(loc,
+                                                                          source,
+                                                                          damages));
+
                     docWasModified = true;
                     opDebug->fastmod = true;
                 }
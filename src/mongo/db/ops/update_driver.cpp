@@ -138,6 +138,64 @@ namespace mongo {
         return Status::OK();
     }
 
+    bool UpdateDriver::rebind(const BSONObj& updateExpr) {
+        if (_replacementMode) {
+            return false;
+        }
+
+        // Walk the expression exactly as parse() does, but re-init() the existing mods in
+        // order instead of constructing new ones. Any divergence from the parsed shape --
+        // a structural error, a mod count mismatch, or an init() failure -- makes the
+        // driver unusable and the caller falls back to a fresh parse().
+        _positional = false;
+
+        size_t modIdx = 0;
+        BSONObjIterator outerIter(updateExpr);
+        while (outerIter.more()) {
+            BSONElement outerModElem = outerIter.next();
+
+            if (outerModElem.type() != Object || outerModElem.embeddedObject().isEmpty()) {
+                return false;
+            }
+
+            BSONObjIterator innerIter(outerModElem.embeddedObject());
+            while (innerIter.more()) {
+                BSONElement innerModElem = innerIter.next();
+
+                if (modIdx == _mods.size() || innerModElem.eoo()) {
+                    return false;
+                }
+
+                bool positional = false;
+                Status status = _mods[modIdx]->init(innerModElem, _modOptions, &positional);
+                if (!status.isOK()) {
+                    return false;
+                }
+
+                _positional = _positional || positional;
+                modIdx++;
+            }
+        }
+
+        return modIdx == _mods.size();
+    }
+
+    bool UpdateDriver::cacheable() const {
+        if (_replacementMode) {
+            return false;
+        }
+
+        for (vector<ModifierInterface*>::const_iterator it = _mods.begin();
+             it != _mods.end();
+             ++it) {
+            if (!(*it)->canRebind()) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
     inline Status UpdateDriver::addAndParse(const modifiertable::ModifierType type,
                                             const BSONElement& elem) {
         if (elem.eoo()) {
@@ -57,6 +57,24 @@ namespace mongo {
          */
         Status parse(const BSONObj& updateExpr);
 
+        /**
+         * Re-binds an already parsed driver to 'updateExpr', which must have the same shape
+         * (same operators over the same field paths) as the expression originally parsed.
+         * The existing mod instances are re-init()ed in order with the new values; nothing
+         * is allocated. 'updateExpr' must outlive the driver's use, as with parse().
+         *
+         * Returns false if this driver cannot be re-bound -- replacement mode, a mod that
+         * does not support re-binding, a shape mismatch, or an init() failure -- in which
+         * case the driver is in an undefined state and must be discarded.
+         */
+        bool rebind(const BSONObj& updateExpr);
+
+        /**
+         * Returns true if this driver may be kept in the update driver cache and later
+         * re-bound via rebind(). Only meaningful after a successful parse().
+         */
+        bool cacheable() const;
+
         /**
          * Fills in document with any fields in the query which are valid.
          *
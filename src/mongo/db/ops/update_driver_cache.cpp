@@ -0,0 +1,156 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#include "mongo/db/ops/update_driver_cache.h"
+
+#include "mongo/bson/util/builder.h"
+
+namespace mongo {
+
+    UpdateDriverCache::UpdateDriverCache()
+        : _mutex("UpdateDriverCache") {
+    }
+
+    UpdateDriverCache::~UpdateDriverCache() {
+        for (std::list<Entry>::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+            delete it->driver;
+        }
+    }
+
+    std::string UpdateDriverCache::shapeOf(const BSONObj& updateExpr) {
+        // Replacement-mode documents carry values in arbitrary structure; only $mod style
+        // expressions have a value-independent shape.
+        if (*updateExpr.firstElementFieldName() != '$') {
+            return std::string();
+        }
+
+        StringBuilder shape;
+        BSONObjIterator outerIter(updateExpr);
+        while (outerIter.more()) {
+            BSONElement outerModElem = outerIter.next();
+
+            if (outerModElem.type() != Object) {
+                return std::string();
+            }
+
+            shape << outerModElem.fieldName() << "(";
+            BSONObjIterator innerIter(outerModElem.embeddedObject());
+            while (innerIter.more()) {
+                shape << innerIter.next().fieldName() << ";";
+            }
+            shape << ")";
+        }
+
+        return shape.str();
+    }
+
+    UpdateDriver* UpdateDriverCache::checkOut(const BSONObj& updateExpr,
+                                              const UpdateDriver::Options& opts,
+                                              BSONObj* boundExpr) {
+        const std::string shape = shapeOf(updateExpr);
+        if (shape.empty()) {
+            return NULL;
+        }
+
+        UpdateDriver* driver = NULL;
+        {
+            SimpleMutex::scoped_lock lk(_mutex);
+            for (std::list<Entry>::iterator it = _entries.begin(); it != _entries.end(); ++it) {
+                if (it->shape == shape) {
+                    driver = it->driver;
+                    _entries.erase(it);
+                    break;
+                }
+            }
+        }
+
+        if (!driver) {
+            return NULL;
+        }
+
+        // The mods keep references into the expression they are bound to (see
+        // ModifierInterface::init), so bind against an owned copy handed back to the
+        // caller, not the caller's possibly transient buffer.
+        *boundExpr = updateExpr.getOwned();
+
+        // Options first: rebind() initializes the mods with the driver's current
+        // ModifierInterface::Options.
+        driver->setMulti(opts.multi);
+        driver->setUpsert(opts.upsert);
+        driver->setLogOp(opts.logOp);
+        driver->setModOptions(opts.modOptions);
+
+        if (!driver->rebind(*boundExpr)) {
+            // Shouldn't happen for a same-shape expression; fall back to a fresh parse,
+            // which will surface any genuine error through the normal path.
+            delete driver;
+            return NULL;
+        }
+
+        return driver;
+    }
+
+    void UpdateDriverCache::checkIn(const BSONObj& boundExpr, UpdateDriver* driver) {
+        // The indexed-fields pointer belongs to a collection's info cache and may not
+        // outlive this operation; never keep it across a check-in.
+        driver->refreshIndexKeys(NULL);
+
+        if (!driver->cacheable()) {
+            delete driver;
+            return;
+        }
+
+        Entry entry;
+        entry.shape = shapeOf(boundExpr);
+        entry.boundExpr = boundExpr;
+        entry.driver = driver;
+
+        if (entry.shape.empty()) {
+            delete driver;
+            return;
+        }
+
+        UpdateDriver* evicted = NULL;
+        {
+            SimpleMutex::scoped_lock lk(_mutex);
+            _entries.push_front(entry);
+            if (_entries.size() > MaxEntries) {
+                evicted = _entries.back().driver;
+                _entries.pop_back();
+            }
+        }
+        delete evicted;
+    }
+
+    UpdateDriverCache& updateDriverCache() {
+        // Function-local so the cache is usable regardless of static initialization order.
+        static UpdateDriverCache cache;
+        return cache;
+    }
+
+} // namespace mongo
@@ -0,0 +1,101 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <list>
+#include <string>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/ops/update_driver.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * A cache of parsed UpdateDrivers keyed by the update document's shape -- its operators
+     * and field paths, ignoring values. Repetitive workloads (e.g. ORM-generated updates)
+     * issue the same { $set: { a: <v> } } expression with only the values changing; the
+     * shape key lets us skip re-parsing and modifier construction and just re-bind the new
+     * values onto the cached mods (see UpdateDriver::rebind).
+     *
+     * Drivers are checked out for exclusive use by one operation and checked back in when
+     * it completes; concurrent same-shape updates simply get separate drivers. Analogous
+     * in spirit to the query PlanCache, but process-global since parsed mods are
+     * independent of any particular collection.
+     */
+    class UpdateDriverCache : boost::noncopyable {
+    public:
+        UpdateDriverCache();
+        ~UpdateDriverCache();
+
+        /**
+         * Looks for a cached driver whose shape matches 'updateExpr' and, if found,
+         * re-binds it to an owned copy of 'updateExpr', applies 'opts', and returns it.
+         * The returned driver is owned by the caller until checked back in; '*boundExpr'
+         * receives the owned expression the driver is bound to, which must stay alive
+         * while the driver is in use. Returns NULL on a cache miss (or if 'updateExpr'
+         * is not cacheable); the caller should parse a fresh driver.
+         */
+        UpdateDriver* checkOut(const BSONObj& updateExpr,
+                               const UpdateDriver::Options& opts,
+                               BSONObj* boundExpr);
+
+        /**
+         * Returns a driver to the cache after use. 'boundExpr' must be the owned
+         * expression the driver is currently bound to. Takes ownership of 'driver'
+         * always; drivers that cannot be re-bound are simply deleted.
+         */
+        void checkIn(const BSONObj& boundExpr, UpdateDriver* driver);
+
+        /**
+         * Computes the shape key for 'updateExpr', e.g. "$inc(a;)$set(b.c;)". Returns the
+         * empty string for expressions that cannot be cached (replacement-mode documents).
+         */
+        static std::string shapeOf(const BSONObj& updateExpr);
+
+    private:
+        struct Entry {
+            std::string shape;
+            BSONObj boundExpr;      // owned buffer the driver's mods point into
+            UpdateDriver* driver;   // owned here while cached
+        };
+
+        // Bound the worst case for pathological workloads with many distinct shapes.
+        enum { MaxEntries = 64 };
+
+        SimpleMutex _mutex;
+        std::list<Entry> _entries;  // most recently used at the front
+    };
+
+    /**
+     * The process-global driver cache.
+     */
+    UpdateDriverCache& updateDriverCache();
+
+} // namespace mongo
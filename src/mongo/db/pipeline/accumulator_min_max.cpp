@@ -35,13 +35,44 @@ namespace mongo {
 
     void AccumulatorMinMax::processInternal(const Value& input, bool merging) {
         // nullish values should have no impact on result
-        if (!input.nullish()) {
-            /* compare with the current value; swap if appropriate */
-            int cmp = Value::compare(_val, input) * _sense;
-            if (cmp > 0 || _val.missing()) { // missing is lower than all other values
-                _val = input;
-                _memUsageBytes = sizeof(*this) + input.getApproximateSize() - sizeof(Value);
+        if (input.nullish())
+            return;
+
+        /* compare with the current value; swap if appropriate */
+        int cmp;
+        const BSONType type = input.getType();
+        if (type == _val.getType() && (type == NumberDouble ||
+                                       type == NumberLong ||
+                                       type == NumberInt)) {
+            // Same-typed numeric runs dominate metric rollups; compare directly instead of
+            // going through Value::compare's type dispatch.  Semantics (including NaN
+            // ordering) match the cmp() helpers Value::compare uses.
+            if (type == NumberDouble) {
+                const double l = _val.getDouble();
+                const double r = input.getDouble();
+                if (l < r)
+                    cmp = -1;
+                else if (l == r)
+                    cmp = 0;
+                else if (l != l) // NaN sorts below everything but NaN
+                    cmp = (r != r) ? 0 : -1;
+                else
+                    cmp = 1;
+            }
+            else {
+                const long long l = _val.getLong();
+                const long long r = input.getLong();
+                cmp = (l < r) ? -1 : ((l == r) ? 0 : 1);
             }
+            cmp *= _sense;
+        }
+        else {
+            cmp = Value::compare(_val, input) * _sense;
+        }
+
+        if (cmp > 0 || _val.missing()) { // missing is lower than all other values
+            _val = input;
+            _memUsageBytes = sizeof(*this) + input.getApproximateSize() - sizeof(Value);
         }
     }
 
@@ -38,8 +38,30 @@ namespace mongo {
         if (!input.numeric())
             return;
 
+        // Fast paths for inputs matching the accumulated type.  Metric rollups feed long
+        // runs of identically-typed values, so most calls skip the widening logic below.
+        const BSONType inputType = input.getType();
+        if (inputType == totalType) {
+            if (totalType == NumberDouble) {
+                doubleTotal += input.getDouble();
+                return;
+            }
+            if (totalType == NumberLong) {
+                const long long v = input.getLong();
+                longTotal += v;
+                doubleTotal += v;
+                return;
+            }
+            if (totalType == NumberInt) {
+                const long long v = input.getInt();
+                longTotal += v;
+                doubleTotal += v;
+                return;
+            }
+        }
+
         // upgrade to the widest type required to hold the result
-        totalType = Value::getWidestNumeric(totalType, input.getType());
+        totalType = Value::getWidestNumeric(totalType, inputType);
 
         if (totalType == NumberInt || totalType == NumberLong) {
             long long v = input.coerceToLong();
@@ -142,13 +142,16 @@ namespace mongo {
         uassert(16490, "Tried to make oversized document",
                 capacity <= size_t(BufferMaxSize));
 
-        boost::scoped_array<char> oldBuf(_buffer);
+        char* const oldBufPtr = _buffer;
+        // the old buffer may live inside our own allocation block (createInline); those bytes
+        // are freed with the storage object, not here
+        boost::scoped_array<char> oldBuf(bufferIsInline() ? NULL : _buffer);
         _buffer = new char[capacity];
         _bufferEnd = _buffer + capacity - hashTabBytes();
 
         if (!firstAlloc) {
             // This just copies the elements
-            memcpy(_buffer, oldBuf.get(), _usedBytes);
+            memcpy(_buffer, oldBufPtr, _usedBytes);
 
             if (_numFields >= HASH_TAB_MIN) {
                 // if we were hashing, deal with the hash table
@@ -157,7 +160,7 @@ namespace mongo {
                 }
                 else {
                     // no rehash needed so just slide table down to new position
-                    memcpy(_hashTab, oldBuf.get() + oldCapacity, hashTabBytes());
+                    memcpy(_hashTab, oldBufPtr + oldCapacity, hashTabBytes());
                 }
             }
         }
@@ -181,13 +184,42 @@ namespace mongo {
         _bufferEnd = _buffer + newSize;
     }
 
-    intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
-        intrusive_ptr<DocumentStorage> out (new DocumentStorage());
+    DocumentStorage* DocumentStorage::createInline(size_t expectedFields) {
+        unsigned buckets = HASH_TAB_INIT_SIZE;
+        while (buckets < expectedFields)
+            buckets *= 2;
+
+        // Using expectedFields+1 to allow space for long field names
+        const size_t bufSize = (expectedFields+1) * ValueElement::align(sizeof(ValueElement));
+        const size_t bufferBytes = bufSize + buckets * sizeof(Position);
+
+        uassert(17465, "Tried to make oversized document",
+                bufferBytes <= size_t(BufferMaxSize));
 
-        // Make a copy of the buffer.
+#pragma warning(push)
+#pragma warning(disable : 4291)
+        DocumentStorage* out = // uses custom operator new
+            new (sizeof(DocumentStorage) + bufferBytes) DocumentStorage();
+#pragma warning(pop)
+
+        out->_hashTabMask = buckets - 1;
+        out->_buffer = out->inlineBufferStart();
+        out->_bufferEnd = out->_buffer + bufSize;
+        return out;
+    }
+
+    intrusive_ptr<DocumentStorage> DocumentStorage::clone() const {
+        // Make a copy of the buffer inside the new storage's own allocation block.
         // It is very important that the positions of each field are the same after cloning.
         const size_t bufferBytes = (_bufferEnd + hashTabBytes()) - _buffer;
-        out->_buffer = new char[bufferBytes];
+
+#pragma warning(push)
+#pragma warning(disable : 4291)
+        intrusive_ptr<DocumentStorage> out ( // uses custom operator new
+            new (sizeof(DocumentStorage) + bufferBytes) DocumentStorage());
+#pragma warning(pop)
+
+        out->_buffer = out->inlineBufferStart();
         out->_bufferEnd = out->_buffer + (_bufferEnd - _buffer);
         memcpy(out->_buffer, _buffer, bufferBytes);
 
@@ -207,7 +239,9 @@ namespace mongo {
     }
 
     DocumentStorage::~DocumentStorage() {
-        boost::scoped_array<char> deleteBufferAtScopeEnd (_buffer);
+        // a createInline()'d storage holds its buffer inside this allocation block; those
+        // bytes are freed with the object itself
+        boost::scoped_array<char> deleteBufferAtScopeEnd (bufferIsInline() ? NULL : _buffer);
 
         for (DocumentStorageIterator it = iteratorAll(); !it.atEnd(); it.advance()) {
             it->val.~Value(); // explicit destructor call
@@ -280,7 +314,7 @@ namespace mongo {
         , _storage(_storageHolder)
     {
         if (expectedFields) {
-            storage().reserveFields(expectedFields);
+            reset(DocumentStorage::createInline(expectedFields));
         }
     }
 
@@ -235,6 +235,16 @@ namespace mongo {
         /// Shallow copy of this. Caller owns memory.
         intrusive_ptr<DocumentStorage> clone() const;
 
+        /** Allocate a storage whose initial field buffer lives in the same allocation as the
+         *  storage header, like RCString.  This halves the allocations for documents that
+         *  never outgrow 'expectedFields'; if one does, the buffer moves to its own heap
+         *  block and the inline space rides along unused until the storage dies.
+         */
+        static DocumentStorage* createInline(size_t expectedFields);
+
+        void* operator new (size_t objSize) { return malloc(objSize); }
+        void operator delete (void* ptr) { free(ptr); }
+
         size_t allocatedBytes() const {
             return !_buffer ? 0 : (_bufferEnd - _buffer + hashTabBytes());
         }
@@ -258,6 +268,17 @@ namespace mongo {
 
     private:
 
+        // only used by createInline() and clone()
+        void* operator new (size_t objSize, size_t realSize) { return malloc(realSize); }
+
+        /// Start of the buffer space createInline() places after the header.
+        char* inlineBufferStart() {
+            return reinterpret_cast<char*>(this) + sizeof(DocumentStorage);
+        }
+        bool bufferIsInline() const {
+            return _buffer == reinterpret_cast<const char*>(this) + sizeof(DocumentStorage);
+        }
+
         /// Same as lastElement->next() or firstElement() if empty.
         const ValueElement* end() const { return _firstElement->plusBytes(_usedBytes); }
 
@@ -329,4 +350,6 @@ namespace mongo {
         double _textScore;
         // When adding a field, make sure to update clone() method
     };
+    // The buffer createInline() places after the header must stay 8-byte aligned.
+    BOOST_STATIC_ASSERT(sizeof(DocumentStorage) % 8 == 0);
 }
@@ -39,6 +39,15 @@ namespace mongo {
         , pExpCtx(pCtx)
     {}
 
+    void DocumentSource::getNextBatch(std::deque<Document>* batch, size_t maxDocs) {
+        for (size_t i = 0; i < maxDocs; i++) {
+            boost::optional<Document> next = getNext();
+            if (!next)
+                return;
+            batch->push_back(*next);
+        }
+    }
+
     const char *DocumentSource::getSourceName() const {
         static const char unknown[] = "[UNKNOWN]";
         return unknown;
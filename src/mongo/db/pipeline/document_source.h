@@ -65,6 +65,15 @@ namespace mongo {
          */
         virtual boost::optional<Document> getNext() = 0;
 
+        /** Append up to 'maxDocs' documents to 'batch'.  Appending nothing means this source
+         *  is exhausted; appending fewer than 'maxDocs' does not.
+         *
+         *  The default implementation just loops over getNext().  Sources whose per-document
+         *  work is cheap override it so a whole batch moves per virtual call instead of one
+         *  document.
+         */
+        virtual void getNextBatch(std::deque<Document>* batch, size_t maxDocs);
+
         /**
          * Inform the source that it is no longer needed and may release its resources.  After
          * dispose() is called the source must still be able to handle iteration requests, but may
@@ -351,6 +360,7 @@ namespace mongo {
         // virtuals from DocumentSource
         virtual ~DocumentSourceCursor();
         virtual boost::optional<Document> getNext();
+        virtual void getNextBatch(std::deque<Document>* batch, size_t maxDocs);
         virtual const char *getSourceName() const;
         virtual Value serialize(bool explain = false) const;
         virtual void setSource(DocumentSource *pSource);
@@ -426,7 +436,13 @@ namespace mongo {
 
         void loadBatch();
 
-        std::deque<Document> _currentBatch;
+        /// Convert a batched BSONObj into the Document the rest of the pipeline consumes.
+        Document convert(const BSONObj& obj) const;
+
+        // Owned copies of matched documents.  Conversion to Document (and any dependency
+        // projection) happens lazily in getNext(), outside the read lock loadBatch() holds,
+        // so writers can interleave with the pipeline's per-document work.
+        std::deque<BSONObj> _currentBatch;
 
         // BSONObj members must outlive _projection and cursor.
         BSONObj _query;
@@ -578,6 +594,7 @@ namespace mongo {
     public:
         // virtuals from DocumentSource
         virtual boost::optional<Document> getNext();
+        virtual void getNextBatch(std::deque<Document>* batch, size_t maxDocs);
         virtual const char *getSourceName() const;
         virtual bool coalesce(const intrusive_ptr<DocumentSource>& nextSource);
         virtual Value serialize(bool explain = false) const;
@@ -717,7 +734,9 @@ namespace mongo {
         // Sets _tempsNs and prepares it to receive data.
         void prepTempCollection();
 
-        void spill(DBClientBase* conn, const vector<BSONObj>& toInsert);
+        // Copies the indexes of _outputNs to _tempNs. Called only after all data is
+        // loaded so the inserts don't pay for incremental index maintenance.
+        void copyIndexes(DBClientBase* conn);
 
         bool _done;
 
@@ -731,6 +750,7 @@ namespace mongo {
     public:
         // virtuals from DocumentSource
         virtual boost::optional<Document> getNext();
+        virtual void getNextBatch(std::deque<Document>* batch, size_t maxDocs);
         virtual const char *getSourceName() const;
         virtual void optimize();
         virtual Value serialize(bool explain = false) const;
@@ -760,6 +780,9 @@ namespace mongo {
         DocumentSourceProject(const intrusive_ptr<ExpressionContext>& pExpCtx,
                               const intrusive_ptr<ExpressionObject>& exprObj);
 
+        /// Apply the projection to a single input document.
+        Document projectDocument(const Document& input);
+
         // configuration state
         boost::scoped_ptr<Variables> _variables;
         intrusive_ptr<ExpressionObject> pEO;
@@ -59,11 +59,30 @@ namespace mongo {
                 return boost::none;
         }
 
-        Document out = _currentBatch.front();
+        Document out = convert(_currentBatch.front());
         _currentBatch.pop_front();
         return out;
     }
 
+    void DocumentSourceCursor::getNextBatch(std::deque<Document>* batch, size_t maxDocs) {
+        pExpCtx->checkForInterrupt();
+
+        if (_currentBatch.empty())
+            loadBatch();
+
+        for (size_t i = 0; i < maxDocs && !_currentBatch.empty(); i++) {
+            batch->push_back(convert(_currentBatch.front()));
+            _currentBatch.pop_front();
+        }
+    }
+
+    Document DocumentSourceCursor::convert(const BSONObj& obj) const {
+        if (_haveDeps && !_projectionInQuery) {
+            return documentFromBsonWithDeps(obj, _dependencies);
+        }
+        return Document::fromBsonWithMetaData(obj);
+    }
+
     void DocumentSourceCursor::dispose() {
         if (_cursorId) {
             ClientCursor::erase(_cursorId);
@@ -97,12 +116,9 @@ namespace mongo {
         BSONObj obj;
         Runner::RunnerState state;
         while ((state = runner->getNext(&obj, NULL)) == Runner::RUNNER_ADVANCED) {
-            if (_haveDeps && !_projectionInQuery) {
-                _currentBatch.push_back(documentFromBsonWithDeps(obj, _dependencies));
-            }
-            else {
-                _currentBatch.push_back(Document::fromBsonWithMetaData(obj));
-            }
+            // Just copy the raw BSON while we hold the lock; getNext() converts it outside
+            // the lock (see convert()).
+            _currentBatch.push_back(obj.getOwned());
 
             if (_limit) {
                 if (++_docsAddedToBatches == _limit->getLimit()) {
@@ -111,7 +127,7 @@ namespace mongo {
                 verify(_docsAddedToBatches < _limit->getLimit());
             }
 
-            memUsageBytes += _currentBatch.back().getApproximateSize();
+            memUsageBytes += _currentBatch.back().objsize();
 
             if (memUsageBytes > MaxBytesToReturnToClientAtOnce) {
                 // End this batch and prepare cursor for yielding.
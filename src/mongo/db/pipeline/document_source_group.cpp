@@ -36,8 +36,14 @@
 #include "mongo/db/pipeline/expression.h"
 #include "mongo/db/pipeline/expression_context.h"
 #include "mongo/db/pipeline/value.h"
+#include "mongo/db/server_parameters.h"
 
 namespace mongo {
+    // Memory $group accumulates before it spills partial aggregates to disk (or uasserts if
+    // external sort isn't allowed).  Tunable so rollup jobs over high-cardinality keys can
+    // trade memory for spill passes.
+    MONGO_EXPORT_SERVER_PARAMETER(documentSourceGroupMaxMemoryBytes, int, 100 * 1024 * 1024);
+
     const char DocumentSourceGroup::groupName[] = "$group";
 
     const char *DocumentSourceGroup::getSourceName() const {
@@ -179,7 +185,7 @@ namespace mongo {
         , _doingMerge(false)
         , _spilled(false)
         , _extSortAllowed(pExpCtx->extSortAllowed && !pExpCtx->inRouter)
-        , _maxMemoryUsageBytes(100*1024*1024)
+        , _maxMemoryUsageBytes(documentSourceGroupMaxMemoryBytes)
     {}
 
     void DocumentSourceGroup::addAccumulator(
@@ -66,6 +66,30 @@ namespace mongo {
         return boost::none;
     }
 
+    void DocumentSourceMatch::getNextBatch(std::deque<Document>* batch, size_t maxDocs) {
+        pExpCtx->checkForInterrupt();
+
+        // The user facing error should have been generated earlier.
+        massert(17466, "Should never call getNextBatch on a $match stage with $text clause",
+                !_isTextQuery);
+
+        const size_t wanted = batch->size() + maxDocs;
+        std::deque<Document> input;
+        while (batch->size() < wanted) {
+            // Never ask for more than we can emit, so every match fits in the output batch.
+            input.clear();
+            pSource->getNextBatch(&input, wanted - batch->size());
+            if (input.empty())
+                return; // upstream exhausted
+
+            for (std::deque<Document>::const_iterator it = input.begin();
+                    it != input.end(); ++it) {
+                if (matcher->matches(it->toBson()))
+                    batch->push_back(*it);
+            }
+        }
+    }
+
     bool DocumentSourceMatch::coalesce(const intrusive_ptr<DocumentSource>& nextSource) {
         DocumentSourceMatch* otherMatch = dynamic_cast<DocumentSourceMatch*>(nextSource.get());
         if (!otherMatch)
@@ -136,11 +136,35 @@ namespace mongo {
         if (_unstarted)
             start();
 
-        // purge eof cursors and release their connections
-        while (!_cursors.empty() && !(*_currentCursor)->cursor.more()) {
-            (*_currentCursor)->connection.done();
-            _cursors.erase(_currentCursor);
-            _currentCursor = _cursors.begin();
+        // Serve buffered results first. Whenever a cursor's batch is drained we request
+        // its next batch without waiting for the reply, then keep consuming the other
+        // shards' buffers; we only block for a reply once no cursor has local data. This
+        // keeps all shard connections pipelined instead of running at the speed of each
+        // round trip in turn.
+        while (!_cursors.empty() && !(*_currentCursor)->cursor.moreInCurrentBatch()) {
+            DBClientCursor& cursor = (*_currentCursor)->cursor;
+            if (!cursor.isDead() && !cursor.moreRequested())
+                cursor.requestMoreLazy();
+
+            // Look for another cursor with buffered data before blocking on this one.
+            Cursors::iterator buffered = _cursors.end();
+            for (Cursors::iterator it = _cursors.begin(); it != _cursors.end(); ++it) {
+                if ((*it)->cursor.moreInCurrentBatch()) {
+                    buffered = it;
+                    break;
+                }
+            }
+
+            if (buffered != _cursors.end()) {
+                _currentCursor = buffered;
+            }
+            else if (!(*_currentCursor)->cursor.more()) {
+                // Blocks to receive the batch requested above (if any). False means this
+                // cursor is exhausted, so release its connection.
+                (*_currentCursor)->connection.done();
+                _cursors.erase(_currentCursor);
+                _currentCursor = _cursors.begin();
+            }
         }
 
         if (_cursors.empty())
@@ -30,9 +30,123 @@
 
 #include "mongo/db/pipeline/document_source.h"
 
+#include "mongo/db/client.h"
+#include "mongo/db/instance.h"
+#include "mongo/util/background.h"
+
 namespace mongo {
     const char DocumentSourceOut::outName[] = "$out";
 
+namespace {
+    /**
+     * Inserts batches of documents into the $out temp collection on a dedicated thread so
+     * the pipeline can keep producing documents while an insert is in flight. Double
+     * buffered: push() hands off a full batch and only blocks if the writer is still busy
+     * with the previous one.
+     */
+    class OutWriter : public BackgroundJob {
+    public:
+        explicit OutWriter(const string& ns)
+            : BackgroundJob(false /*don't selfDelete*/)
+            , _ns(ns)
+            , _done(false)
+        {}
+
+        ~OutWriter() {
+            // Normally finish() has already joined the thread. This path handles the
+            // producer unwinding due to an exception or interrupt.
+            {
+                boost::mutex::scoped_lock lk(_mutex);
+                _done = true;
+                _hasWork.notify_one();
+            }
+            wait();
+        }
+
+        /** Hands off a full batch to the writer thread. Clears *batch. */
+        void push(vector<BSONObj>* batch) {
+            boost::mutex::scoped_lock lk(_mutex);
+            while (!_pending.empty() && _error.empty())
+                _slotFree.wait(lk);
+            uassertNoErrorInlock();
+            _pending.swap(*batch);
+            batch->clear();
+            _hasWork.notify_one();
+        }
+
+        /** Waits until everything pushed so far is written, then joins the thread. */
+        void finish() {
+            {
+                boost::mutex::scoped_lock lk(_mutex);
+                _done = true;
+                _hasWork.notify_one();
+            }
+            wait();
+
+            boost::mutex::scoped_lock lk(_mutex);
+            uassertNoErrorInlock();
+        }
+
+        virtual string name() const { return "aggout writer"; }
+
+        virtual void run() {
+            Client::initThread(name().c_str());
+            DBDirectClient conn;
+
+            for (;;) {
+                vector<BSONObj> batch;
+                {
+                    boost::mutex::scoped_lock lk(_mutex);
+                    while (_pending.empty() && !_done)
+                        _hasWork.wait(lk);
+
+                    if (_pending.empty()) // _done and nothing left to write
+                        break;
+
+                    batch.swap(_pending);
+                    _slotFree.notify_one();
+                }
+
+                string error;
+                try {
+                    conn.insert(_ns, batch);
+                    BSONObj err = conn.getLastErrorDetailed();
+                    error = DBClientWithCommands::getLastErrorString(err);
+                }
+                catch (const DBException& e) {
+                    error = e.toString();
+                }
+
+                if (!error.empty()) {
+                    // Remember the error for the producer and stop writing. push() and
+                    // finish() rethrow it on the pipeline's thread.
+                    boost::mutex::scoped_lock lk(_mutex);
+                    _error = error;
+                    _slotFree.notify_one();
+                    break;
+                }
+            }
+
+            cc().shutdown();
+        }
+
+    private:
+        void uassertNoErrorInlock() {
+            uassert(17467, str::stream() << "insert for $out failed: " << _error,
+                    _error.empty());
+        }
+
+        const string _ns;
+
+        boost::mutex _mutex; // protects everything below
+        boost::condition _hasWork;
+        boost::condition _slotFree;
+        vector<BSONObj> _pending; // the batch waiting for (or being written by) the writer
+        string _error; // set by the writer thread on failure
+        bool _done;
+    };
+} // namespace
+
     DocumentSourceOut::~DocumentSourceOut() {
         DESTRUCTOR_GUARD(
             // Make sure we drop the temp collection if anything goes wrong. Errors are ignored
@@ -78,7 +192,9 @@ namespace mongo {
                                          << _tempNs.ns() << "': " << info.toString(),
                     ok);
         }
+    }
 
+    void DocumentSourceOut::copyIndexes(DBClientBase* conn) {
         // copy indexes on _outputNs to _tempNs
         scoped_ptr<DBClientCursor> indexes(conn->getIndexes(_outputNs));
         while (indexes->more()) {
@@ -96,13 +212,6 @@ namespace mongo {
         }
     }
 
-    void DocumentSourceOut::spill(DBClientBase* conn, const vector<BSONObj>& toInsert) {
-        conn->insert(_tempNs.ns(), toInsert);
-        BSONObj err = conn->getLastErrorDetailed();
-        uassert(16996, str::stream() << "insert for $out failed: " << err,
-                DBClientWithCommands::getLastErrorString(err).empty());
-    }
-
     boost::optional<Document> DocumentSourceOut::getNext() {
         pExpCtx->checkForInterrupt();
 
@@ -117,21 +226,29 @@ namespace mongo {
         prepTempCollection();
         verify(_tempNs.size() != 0);
 
+        OutWriter writer(_tempNs.ns());
+        writer.go();
+
         vector<BSONObj> bufferedObjects;
         int bufferedBytes = 0;
         while (boost::optional<Document> next = pSource->getNext()) {
             BSONObj toInsert = next->toBson();
             bufferedBytes += toInsert.objsize();
             if (!bufferedObjects.empty() && bufferedBytes > BSONObjMaxUserSize) {
-                spill(conn, bufferedObjects);
-                bufferedObjects.clear();
+                writer.push(&bufferedObjects); // clears bufferedObjects
                 bufferedBytes = toInsert.objsize();
             }
             bufferedObjects.push_back(toInsert);
         }
 
         if (!bufferedObjects.empty())
-            spill(conn, bufferedObjects);
+            writer.push(&bufferedObjects);
+
+        writer.finish();
+
+        // Build the indexes only now that the data is loaded, so the inserts above don't
+        // pay for incremental index maintenance.
+        copyIndexes(conn);
 
         // Checking again to make sure we didn't become sharded while running.
         uassert(17018, str::stream() << "namespace '" << _outputNs.ns()
@@ -55,10 +55,27 @@ namespace mongo {
         if (!input)
             return boost::none;
 
+        return projectDocument(*input);
+    }
+
+    void DocumentSourceProject::getNextBatch(std::deque<Document>* batch, size_t maxDocs) {
+        pExpCtx->checkForInterrupt();
+
+        // We emit exactly one document per input, so one upstream batch suffices and an
+        // empty result correctly signals upstream exhaustion.
+        std::deque<Document> input;
+        pSource->getNextBatch(&input, maxDocs);
+
+        for (std::deque<Document>::const_iterator it = input.begin(); it != input.end(); ++it) {
+            batch->push_back(projectDocument(*it));
+        }
+    }
+
+    Document DocumentSourceProject::projectDocument(const Document& input) {
         /* create the result document */
         const size_t sizeHint = pEO->getSizeHint();
         MutableDocument out (sizeHint);
-        out.copyMetaDataFrom(*input);
+        out.copyMetaDataFrom(input);
 
         /*
           Use the ExpressionObject to create the base result.
@@ -66,15 +83,15 @@ namespace mongo {
           If we're excluding fields at the top level, leave out the _id if
           it is found, because we took care of it above.
         */
-        _variables->setRoot(*input);
-        pEO->addToDocument(out, *input, _variables.get());
+        _variables->setRoot(input);
+        pEO->addToDocument(out, input, _variables.get());
         _variables->clearRoot();
 
 #if defined(_DEBUG)
         if (!_simpleProjection.getSpec().isEmpty()) {
             // Make sure we return the same results as Projection class
 
-            BSONObj inputBson = input->toBson();
+            BSONObj inputBson = input.toBson();
             BSONObj outputBson = out.peek().toBson();
 
             BSONObj projected = _simpleProjection.transform(inputBson);
@@ -247,6 +247,15 @@ namespace mongo {
         bool more() { return _cursor->more(); }
         Data next() {
             const Document doc = Document::fromBsonWithMetaData(_cursor->next());
+
+            // When this shard's batch runs out, ask for the next one right away so the
+            // getMore overlaps with merging the other shards' buffered results. more()
+            // picks up the reply when the merge comes back to this cursor.
+            if (!_cursor->moreInCurrentBatch() && !_cursor->isDead() &&
+                    !_cursor->moreRequested()) {
+                _cursor->requestMoreLazy();
+            }
+
             return make_pair(_sorter->extractKey(doc), doc);
         }
     private:
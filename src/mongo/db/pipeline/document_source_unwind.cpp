@@ -132,6 +132,13 @@ namespace mongo {
 
             // Try to extract an output document from the new input document.
             _unwinder->resetDocument(*input);
+
+            // Release our reference before unwinding.  The unwinder then holds the only
+            // reference to the storage, so the first element overlays the parent document
+            // in place instead of forcing a copy-on-write clone; single-element arrays —
+            // the common case — unwind without any storage copy at all.
+            input = boost::none;
+
             out = _unwinder->getNext();
         }
 
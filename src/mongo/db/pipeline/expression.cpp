@@ -575,6 +575,13 @@ namespace {
         /* optimize the operand */
         pExpression = pExpression->optimize();
 
+        /* if the operand is a constant, we can coerce it now */
+        const ExpressionConstant* pConst =
+            dynamic_cast<const ExpressionConstant*>(pExpression.get());
+        if (pConst) {
+            return ExpressionConstant::create(Value(pConst->getValue().coerceToBool()));
+        }
+
         /* if the operand already produces a boolean, then we don't need this */
         /* LATER - Expression to support a "typeof" query? */
         Expression *pE = pExpression.get();
@@ -713,6 +720,26 @@ namespace {
 
     /* ----------------------- ExpressionCond ------------------------------ */
 
+    intrusive_ptr<Expression> ExpressionCond::optimize() {
+        /* optimize the operands; this folds an all-constant $cond */
+        intrusive_ptr<Expression> pE(Base::optimize());
+
+        ExpressionCond* pCond = dynamic_cast<ExpressionCond*>(pE.get());
+        if (!pCond)
+            return pE;
+
+        /*
+          If the condition is constant but the branches aren't, we can still
+          select the branch now and drop the other one along with the test.
+        */
+        const ExpressionConstant* pConst =
+            dynamic_cast<const ExpressionConstant*>(pCond->vpOperand[0].get());
+        if (!pConst)
+            return pE;
+
+        return pCond->vpOperand[pConst->getValue().coerceToBool() ? 1 : 2];
+    }
+
     Value ExpressionCond::evaluateInternal(Variables* vars) const {
         Value pCond(vpOperand[0]->evaluateInternal(vars));
         int idx = pCond.coerceToBool() ? 1 : 2;
@@ -1699,6 +1726,26 @@ namespace {
         return pRight;
     }
 
+    intrusive_ptr<Expression> ExpressionIfNull::optimize() {
+        /* optimize the operands; this folds an all-constant $ifNull */
+        intrusive_ptr<Expression> pE(ExpressionNary::optimize());
+
+        ExpressionIfNull* pIfNull = dynamic_cast<ExpressionIfNull*>(pE.get());
+        if (!pIfNull)
+            return pE;
+
+        /*
+          If the left operand is constant, the choice can be made now: a
+          non-nullish constant always wins, and a nullish one never does.
+        */
+        const ExpressionConstant* pConst =
+            dynamic_cast<const ExpressionConstant*>(pIfNull->vpOperand[0].get());
+        if (!pConst)
+            return pE;
+
+        return pIfNull->vpOperand[pConst->getValue().nullish() ? 1 : 0];
+    }
+
     REGISTER_EXPRESSION("$ifNull", ExpressionIfNull::parse);
     const char *ExpressionIfNull::getOpName() const {
         return "$ifNull";
@@ -461,16 +461,26 @@ namespace mongo {
         // cant use subArrayStart() due to error handling
         BSONArrayBuilder resultArray;
         DocumentSource* finalSource = sources.back().get();
-        while (boost::optional<Document> next = finalSource->getNext()) {
-            // add the document to the result set
-            BSONObjBuilder documentBuilder (resultArray.subobjStart());
-            next->toBson(&documentBuilder);
-            documentBuilder.doneFast();
-            // object will be too large, assert. the extra 1KB is for headers
-            uassert(16389,
-                    str::stream() << "aggregation result exceeds maximum document size ("
-                                  << BSONObjMaxUserSize / (1024 * 1024) << "MB)",
-                    resultArray.len() < BSONObjMaxUserSize - 1024);
+        const size_t kBatchDocs = 128; // documents pulled per virtual call into the chain
+        std::deque<Document> batch;
+        for (;;) {
+            batch.clear();
+            finalSource->getNextBatch(&batch, kBatchDocs);
+            if (batch.empty())
+                break;
+
+            for (std::deque<Document>::const_iterator it = batch.begin();
+                    it != batch.end(); ++it) {
+                // add the document to the result set
+                BSONObjBuilder documentBuilder (resultArray.subobjStart());
+                it->toBson(&documentBuilder);
+                documentBuilder.doneFast();
+                // object will be too large, assert. the extra 1KB is for headers
+                uassert(16389,
+                        str::stream() << "aggregation result exceeds maximum document size ("
+                                      << BSONObjMaxUserSize / (1024 * 1024) << "MB)",
+                        resultArray.len() < BSONObjMaxUserSize - 1024);
+            }
         }
 
         resultArray.done();
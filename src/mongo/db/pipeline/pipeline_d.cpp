@@ -222,6 +222,34 @@ namespace {
             }
         }
 
+        if (!runner.get() && sortStage && sortStage->getLimitSrc()) {
+            // No index provides the sort, but a coalesced $limit bounds it.  Retry with
+            // blocking sort allowed and the limit in the query: the SortStage then runs as a
+            // bounded top-k and only limit documents ever reach the pipeline, instead of
+            // every match streaming through DocumentSourceSort.
+            CanonicalQuery* cq;
+            uassertStatusOK(
+                CanonicalQuery::canonicalize(pExpCtx->ns,
+                                             queryObj,
+                                             sortObj,
+                                             needQueryProjection ? projection : BSONObj(),
+                                             0, // skip
+                                             sortStage->getLimitSrc()->getLimit(),
+                                             &cq));
+            Runner* rawRunner;
+            const size_t topKOptions = runnerOptions & ~QueryPlannerParams::NO_BLOCKING_SORT;
+            if (getRunner(cq, &rawRunner, topKOptions).isOK()) {
+                runner.reset(rawRunner);
+                sortInRunner = true;
+
+                sources.pop_front();
+                // The $limit stays in the pipeline; the runner already returns at most that
+                // many documents so it just passes them through (and keeps the pipeline
+                // shape expected when merging shard results).
+                sources.push_front(sortStage->getLimitSrc());
+            }
+        }
+
         if (!runner.get()) {
             const BSONObj noSort;
             CanonicalQuery* cq;
@@ -40,6 +40,7 @@
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/stats/timer_stats.h"
 #include "mongo/db/commands/server_status.h"
+#include "mongo/util/mmap.h"
 
 namespace mongo {
 
@@ -188,14 +189,10 @@ namespace mongo {
                 // have locked higher up the call stack already
                 Client::ReadContext ctx( ns );
                 if( Helpers::findById(cc(), ns, builder.done(), result) ) {
-                    // do we want to use Record::touch() here?  it's pretty similar.
-                    volatile char _dummy_char = '\0';
-                    // Touch the first word on every page in order to fault it into memory
-                    for (int i = 0; i < result.objsize(); i += g_minOSPageSizeBytes) {                        
-                        _dummy_char += *(result.objdata() + i); 
-                    }
-                    // hit the last page, in case we missed it above
-                    _dummy_char += *(result.objdata() + result.objsize() - 1);
+                    // hand the whole record's page range to the kernel as asynchronous
+                    // readahead rather than faulting pages in one at a time here --
+                    // the prefetch thread moves on to the next op while the disk works
+                    adviseWillNeed( const_cast<char*>( result.objdata() ), result.objsize() );
                 }
             }
             catch(const DBException& e) {
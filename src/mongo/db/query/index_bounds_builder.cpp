@@ -223,6 +223,9 @@ namespace mongo {
             isHashed = true;
         }
 
+        // Bounds must be built with the same hash function the index was built with.
+        const int hashVersion = isHashed ? index.infoObj["hashVersion"].numberInt() : 0;
+
         if (isHashed) {
             verify(MatchExpression::EQ == expr->matchType()
                    || MatchExpression::MATCH_IN == expr->matchType());
@@ -255,7 +258,7 @@ namespace mongo {
         }
         else if (MatchExpression::EQ == expr->matchType()) {
             const EqualityMatchExpression* node = static_cast<const EqualityMatchExpression*>(expr);
-            translateEquality(node->getData(), isHashed, oilOut, tightnessOut);
+            translateEquality(node->getData(), isHashed, hashVersion, oilOut, tightnessOut);
         }
         else if (MatchExpression::LTE == expr->matchType()) {
             const LTEMatchExpression* node = static_cast<const LTEMatchExpression*>(expr);
@@ -408,7 +411,7 @@ namespace mongo {
             IndexBoundsBuilder::BoundsTightness tightness;
             for (BSONElementSet::iterator it = afr.equalities().begin();
                  it != afr.equalities().end(); ++it) {
-                translateEquality(*it, isHashed, oilOut, &tightness);
+                translateEquality(*it, isHashed, hashVersion, oilOut, &tightness);
                 if (tightness != IndexBoundsBuilder::EXACT) {
                     *tightnessOut = tightness;
                 }
@@ -652,13 +655,14 @@ namespace mongo {
 
     // static
     void IndexBoundsBuilder::translateEquality(const BSONElement& data, bool isHashed,
-                                               OrderedIntervalList* oil, BoundsTightness* tightnessOut) {
+                                               int hashVersion, OrderedIntervalList* oil,
+                                               BoundsTightness* tightnessOut) {
         // We have to copy the data out of the parse tree and stuff it into the index
         // bounds.  BSONValue will be useful here.
         if (Array != data.type()) {
             BSONObj dataObj;
             if (isHashed) {
-                dataObj = ExpressionMapping::hash(data);
+                dataObj = ExpressionMapping::hash(data, hashVersion);
             }
             else {
                 dataObj = objFromElement(data);
@@ -703,4 +707,50 @@ namespace mongo {
         }
     }
 
+    // static
+    bool IndexBoundsBuilder::isSingleInterval(const IndexBounds& bounds,
+                                              BSONObj* startKey,
+                                              bool* startKeyInclusive,
+                                              BSONObj* endKey,
+                                              bool* endKeyInclusive) {
+        // Simple-range bounds come from callers that built start/end keys themselves,
+        // not from the planner; we only deal with per-field interval lists here.
+        if (bounds.isSimpleRange) {
+            return false;
+        }
+
+        // Point intervals on a prefix of the fields, then at most one range on the last
+        // field.  A range followed by further fields would need MinKey/MaxKey padding to
+        // express as two keys, which no caller needs yet, so we conservatively say no.
+        BSONObjBuilder startBob;
+        BSONObjBuilder endBob;
+        *startKeyInclusive = true;
+        *endKeyInclusive = true;
+
+        for (size_t i = 0; i < bounds.fields.size(); ++i) {
+            const OrderedIntervalList& oil = bounds.fields[i];
+            if (1 != oil.intervals.size()) {
+                return false;
+            }
+            const Interval& interval = oil.intervals[0];
+            if (interval.isPoint()) {
+                startBob.append(interval.start);
+                endBob.append(interval.end);
+            }
+            else if (i == bounds.fields.size() - 1) {
+                startBob.append(interval.start);
+                endBob.append(interval.end);
+                *startKeyInclusive = interval.startInclusive;
+                *endKeyInclusive = interval.endInclusive;
+            }
+            else {
+                return false;
+            }
+        }
+
+        *startKey = startBob.obj();
+        *endKey = endBob.obj();
+        return true;
+    }
+
 }  // namespace mongo
@@ -151,12 +151,25 @@ namespace mongo {
 
         static void translateEquality(const BSONElement& data,
                                       bool isHashed,
+                                      int hashVersion,
                                       OrderedIntervalList* oil,
                                       BoundsTightness* tightnessOut);
 
         static void unionize(OrderedIntervalList* oilOut);
         static void intersectize(const OrderedIntervalList& arg,
                                  OrderedIntervalList* oilOut);
+
+        /**
+         * Returns true iff 'bounds' can be represented as one interval from 'startKey' to
+         * 'endKey', with inclusivity reported through the two inclusive out-parameters.
+         * Requires point intervals on every field except the last, which may be a range.
+         * Used by the count fast path to walk index entries without per-key matching.
+         */
+        static bool isSingleInterval(const IndexBounds& bounds,
+                                     BSONObj* startKey,
+                                     bool* startKeyInclusive,
+                                     BSONObj* endKey,
+                                     bool* endKeyInclusive);
     };
 
 }  // namespace mongo
@@ -34,6 +34,7 @@
 #include "mongo/db/jsobj.h"
 #include "mongo/db/exec/plan_stage.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/kill_current_op.h"
 #include "mongo/db/pdfile.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/explain_plan.h"
@@ -46,11 +47,22 @@
 
 namespace mongo {
 
+    namespace {
+
+        // How many times each candidate plan is worked during a plan competition.
+        const size_t kTimesEachPlanIsWorked = 100;
+
+    }  // namespace
+
     MultiPlanRunner::MultiPlanRunner(CanonicalQuery* query)
         : _killed(false),
           _failure(false),
           _failureCount(0),
           _policy(Runner::YIELD_MANUAL),
+          _trialStarted(false),
+          _trialWorksLeft(0),
+          _servingChild(0),
+          _servingResultsStreamed(false),
           _query(query),
           _backupSolution(NULL),
           _backupPlan(NULL) { }
@@ -214,50 +226,45 @@ namespace mongo {
         if (_killed) { return Runner::RUNNER_DEAD; }
         if (_failure) { return Runner::RUNNER_ERROR; }
 
-        // If we haven't picked the best plan yet...
+        // If we haven't picked the best plan yet, run the competition incrementally:
+        // stream results to the user from a heuristically chosen candidate right away and
+        // spread the trial rounds over getNext() calls, so a cache miss doesn't pay for
+        // every loser plan's work before its first result.
         if (NULL == _bestPlan) {
-            if (!pickBestPlan(NULL)) {
-                verify(_failure || _killed);
-                if (_killed) { return Runner::RUNNER_DEAD; }
-                if (_failure) { return Runner::RUNNER_ERROR; }
+            if (!_trialStarted) {
+                startTrial();
             }
-        }
 
-        if (!_alreadyProduced.empty()) {
-            WorkingSetID id = _alreadyProduced.front();
-            _alreadyProduced.pop_front();
+            while (NULL == _bestPlan && _candidates[_servingChild].results.empty()) {
+                bool moreToDo = workAllPlans();
+                if (_killed) { return Runner::RUNNER_DEAD; }
+                if (_failure) { return Runner::RUNNER_ERROR; }
 
-            WorkingSetMember* member = _bestPlan->getWorkingSet()->get(id);
-            // Note that this copies code from PlanExecutor.
-            if (NULL != objOut) {
-                if (WorkingSetMember::LOC_AND_IDX == member->state) {
-                    if (1 != member->keyData.size()) {
-                        _bestPlan->getWorkingSet()->free(id);
+                // Settle the competition once a plan hits EOF, the serving candidate can't
+                // produce anything more for the user, or the trial budget is spent.
+                if (!moreToDo || _candidates[_servingChild].failed
+                    || 0 == --_trialWorksLeft) {
+                    if (!finalizeTrial(static_cast<long long>(_servingChild), NULL)) {
+                        verify(_failure || _killed);
+                        if (_killed) { return Runner::RUNNER_DEAD; }
                         return Runner::RUNNER_ERROR;
                     }
-                    *objOut = member->keyData[0].keyData;
-                }
-                else if (member->hasObj()) {
-                    *objOut = member->obj;
-                }
-                else {
-                    // TODO: Checking the WSM for covered fields goes here.
-                    _bestPlan->getWorkingSet()->free(id);
-                    return Runner::RUNNER_ERROR;
                 }
             }
 
-            if (NULL != dlOut) {
-                if (member->hasLoc()) {
-                    *dlOut = member->loc;
-                }
-                else {
-                    _bestPlan->getWorkingSet()->free(id);
-                    return Runner::RUNNER_ERROR;
-                }
+            if (NULL == _bestPlan) {
+                // Still mid-trial; hand the user the serving candidate's buffered result.
+                WorkingSetID id = _candidates[_servingChild].results.front();
+                _candidates[_servingChild].results.pop_front();
+                _servingResultsStreamed = true;
+                return makeResult(_candidates[_servingChild].ws, id, objOut, dlOut);
             }
-            _bestPlan->getWorkingSet()->free(id);
-            return Runner::RUNNER_ADVANCED;
+        }
+
+        if (!_alreadyProduced.empty()) {
+            WorkingSetID id = _alreadyProduced.front();
+            _alreadyProduced.pop_front();
+            return makeResult(_bestPlan->getWorkingSet(), id, objOut, dlOut);
         }
 
         RunnerState state = _bestPlan->getNext(objOut, dlOut);
@@ -299,19 +306,94 @@ namespace mongo {
         return state;
     }
 
-    bool MultiPlanRunner::pickBestPlan(size_t* out) {
-        static const int timesEachPlanIsWorked = 100;
+    void MultiPlanRunner::startTrial() {
+        verify(!_candidates.empty());
+        _trialStarted = true;
+        _trialWorksLeft = kTimesEachPlanIsWorked;
 
+        // Favor a candidate that can stream results without a blocking sort -- the same
+        // heuristic the backup-plan logic uses -- since its results reach the user while
+        // the trial is still running.
+        _servingChild = 0;
+        for (size_t i = 0; i < _candidates.size(); ++i) {
+            if (!_candidates[i].solution->hasSortStage) {
+                _servingChild = i;
+                break;
+            }
+        }
+    }
+
+    Runner::RunnerState MultiPlanRunner::makeResult(WorkingSet* ws,
+                                                    WorkingSetID id,
+                                                    BSONObj* objOut,
+                                                    DiskLoc* dlOut) {
+        WorkingSetMember* member = ws->get(id);
+        // Note that this copies code from PlanExecutor.
+        if (NULL != objOut) {
+            if (WorkingSetMember::LOC_AND_IDX == member->state) {
+                if (1 != member->keyData.size()) {
+                    ws->free(id);
+                    return Runner::RUNNER_ERROR;
+                }
+                *objOut = member->keyData[0].keyData;
+            }
+            else if (member->hasObj()) {
+                *objOut = member->obj;
+            }
+            else {
+                // TODO: Checking the WSM for covered fields goes here.
+                ws->free(id);
+                return Runner::RUNNER_ERROR;
+            }
+        }
+
+        if (NULL != dlOut) {
+            if (member->hasLoc()) {
+                *dlOut = member->loc;
+            }
+            else {
+                ws->free(id);
+                return Runner::RUNNER_ERROR;
+            }
+        }
+        ws->free(id);
+        return Runner::RUNNER_ADVANCED;
+    }
+
+    bool MultiPlanRunner::pickBestPlan(size_t* out) {
         // Run each plan some number of times.
-        for (int i = 0; i < timesEachPlanIsWorked; ++i) {
+        for (size_t i = 0; i < kTimesEachPlanIsWorked; ++i) {
             bool moreToDo = workAllPlans();
             if (!moreToDo) { break; }
         }
 
         if (_failure || _killed) { return false; }
 
+        // If getNext() already streamed results from a trial candidate, stay on it.
+        return finalizeTrial(_trialStarted ? static_cast<long long>(_servingChild) : -1, out);
+    }
+
+    bool MultiPlanRunner::finalizeTrial(long long forcedChild, size_t* out) {
+        if (forcedChild >= 0 && _candidates[forcedChild].failed && _servingResultsStreamed) {
+            // The plan whose results the user has been seeing died mid-query.  Promoting
+            // another candidate here would replay its buffered results -- documents the
+            // user already has -- so the query must fail instead.
+            warning() << "Serving candidate plan failed after streaming results, "
+                      << "failing query: " << _query->toString() << endl;
+            _failure = true;
+            return false;
+        }
+
         auto_ptr<PlanRankingDecision> ranking(new PlanRankingDecision());
-        size_t bestChild = PlanRanker::pickBestPlan(_candidates, ranking.get());
+        size_t rankedBest = PlanRanker::pickBestPlan(_candidates, ranking.get());
+
+        size_t bestChild = rankedBest;
+        if (forcedChild >= 0 && !_candidates[forcedChild].failed) {
+            // We can't switch plans mid-query without disturbing the result stream the
+            // user already saw; the ranked winner still leads the cache entry below so
+            // future queries run it.
+            bestChild = static_cast<size_t>(forcedChild);
+        }
 
         // Run the best plan.  Store it.
         _bestPlan.reset(new PlanExecutor(_candidates[bestChild].ws,
@@ -346,12 +428,15 @@ namespace mongo {
             verify(NULL != collection);
             PlanCache* cache = collection->infoCache()->getPlanCache();
             // Create list of candidate solutions for the cache with
-            // the best solution at the front.
+            // the ranked winner at the front (which may not be the plan we're executing,
+            // if the trial already streamed another candidate's results to the user).
             std::vector<QuerySolution*> solutions;
-            solutions.push_back(_bestSolution.get());
+            solutions.push_back(rankedBest == bestChild ? _bestSolution.get()
+                                                        : _candidates[rankedBest].solution);
             for (size_t i = 0; i < _candidates.size(); ++i) {
-                if (i == bestChild) { continue; }
-                solutions.push_back(_candidates[i].solution);
+                if (i == rankedBest) { continue; }
+                solutions.push_back(i == bestChild ? _bestSolution.get()
+                                                   : _candidates[i].solution);
             }
 
             // Check solution cache data. Do not add to cache if
@@ -400,6 +485,9 @@ namespace mongo {
     bool MultiPlanRunner::workAllPlans() {
         bool planHitEOF = false;
 
+        // Batched interrupt point, as in PlanExecutor::getNext().
+        killCurrentOp.checkForInterruptPeriodic();
+
         for (size_t i = 0; i < _candidates.size(); ++i) {
             CandidatePlan& candidate = _candidates[i];
             if (candidate.failed) { continue; }
@@ -66,8 +66,11 @@ namespace mongo {
         void addPlan(QuerySolution* solution, PlanStage* root, WorkingSet* ws);
 
         /**
-         * Get the next result.  Yielding is handled internally.  If a best plan is not picked when
-         * this is called, we call pickBestPlan() internally.
+         * Get the next result.  Yielding is handled internally.  If a best plan is not picked
+         * when this is called, the plan competition is run incrementally: results stream to
+         * the caller from a heuristically chosen candidate right away while the trial rounds
+         * are spread over subsequent getNext() calls, and the ranking is finalized (and
+         * cached) once the trial budget is spent.
          */
         Runner::RunnerState getNext(BSONObj* objOut, DiskLoc* dlOut);
 
@@ -110,6 +113,32 @@ namespace mongo {
         void allPlansSaveState();
         void allPlansRestoreState();
 
+        /**
+         * Begin the incremental plan competition: set the trial budget and pick the
+         * candidate whose results we stream to the user while the trial runs.
+         */
+        void startTrial();
+
+        /**
+         * Rank the candidates, install the executing plan, store the ranked winner in the
+         * plan cache, and delete the losers.  If 'forcedChild' is non-negative and that
+         * candidate hasn't failed, it becomes the executing plan regardless of its rank
+         * (we may have already streamed its results to the user); the ranked winner still
+         * leads the cache entry.  Passing -1 executes the ranked winner.
+         *
+         * Returns true if a plan was installed, false if there was an error.
+         * If out is not-NULL, set *out to the index of the executing plan.
+         */
+        bool finalizeTrial(long long forcedChild, size_t* out);
+
+        /**
+         * Copy the result in 'id' out of 'ws' into the caller's objOut/dlOut and free it.
+         */
+        Runner::RunnerState makeResult(WorkingSet* ws,
+                                       WorkingSetID id,
+                                       BSONObj* objOut,
+                                       DiskLoc* dlOut);
+
         // Were we killed by an invalidate?
         bool _killed;
 
@@ -141,6 +170,20 @@ namespace mongo {
         // Candidate plans.
         std::vector<CandidatePlan> _candidates;
 
+        // Has getNext() started the incremental plan competition?
+        bool _trialStarted;
+
+        // Trial rounds left before we must settle on a plan.
+        size_t _trialWorksLeft;
+
+        // The candidate whose results stream to the user during the trial.
+        size_t _servingChild;
+
+        // Has the serving candidate's output actually reached the user?  Once it has, we
+        // can't recover from that candidate failing by switching plans -- another
+        // candidate's buffered results would repeat documents already returned.
+        bool _servingResultsStreamed;
+
         // Candidate plans' stats. Owned here.
         std::vector<PlanStageStats*> _candidateStats;
 
@@ -28,6 +28,7 @@
 
 #include "mongo/db/query/new_find.h"
 
+#include "mongo/client/bson_delta_batch.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
@@ -40,6 +41,7 @@
 #include "mongo/db/query/internal_plans.h"
 #include "mongo/db/query/qlog.h"
 #include "mongo/db/query/query_planner_params.h"
+#include "mongo/db/query/query_shape_stats.h"
 #include "mongo/db/query/single_solution_runner.h"
 #include "mongo/db/query/type_explain.h"
 #include "mongo/db/repl/repl_reads_ok.h"
@@ -119,7 +121,12 @@ namespace mongo {
     QueryResult* newGetMore(const char* ns, int ntoreturn, long long cursorid, CurOp& curop,
                             int pass, bool& exhaust, bool* isCursorAuthorized) {
         exhaust = false;
-        int bufSize = 512 + sizeof(QueryResult) + MaxBytesToReturnToClientAtOnce;
+
+        // Reserve the globally configured batch byte target rather than the full reply cap;
+        // the builder grows on demand if this cursor has tuned itself up past it.
+        int bufSize = 512 + sizeof(QueryResult)
+            + std::min(static_cast<int>(MaxBytesToReturnToClientAtOnce),
+                       getMoreTargetBatchBytes);
 
         BufBuilder bb(bufSize);
         bb.skip(sizeof(QueryResult));
@@ -191,9 +198,20 @@ namespace mongo {
             Runner* runner = cc->getRunner();
             const int queryOptions = cc->queryOptions();
 
+            // Delta-encode the batch if the cursor opted in.  Tailable cursors only
+            // exist on capped collections, so the tailable bit doubles as our capped
+            // check; agg cursors manage their own batching.
+            const bool deltaBatch = (queryOptions & QueryOption_DeltaBatch)
+                                    && (queryOptions & QueryOption_CursorTailable)
+                                    && !cc->isAggCursor;
+            vector<BSONObj> deltaDocs;
+
             // Get results out of the runner.
             runner->restoreState();
 
+            // Timing the batch feeds the cursor's adaptive sizing below.
+            Timer batchTimer;
+
             BSONObj obj;
             Runner::RunnerState state;
             while (Runner::RUNNER_ADVANCED == (state = runner->getNext(&obj, NULL))) {
@@ -203,6 +221,10 @@ namespace mongo {
                 // Count the result.
                 ++numResults;
 
+                if (deltaBatch) {
+                    deltaDocs.push_back(obj.getOwned());
+                }
+
                 // Possibly note slave's position in the oplog.
                 if (queryOptions & QueryOption_OplogReplay) {
                     BSONElement e = obj["ts"];
@@ -212,7 +234,8 @@ namespace mongo {
                 }
 
                 if ((ntoreturn && numResults >= ntoreturn)
-                    || bb.len() > MaxBytesToReturnToClientAtOnce) {
+                    || bb.len() > MaxBytesToReturnToClientAtOnce
+                    || (0 == ntoreturn && bb.len() > cc->targetBatchBytes())) {
                     break;
                 }
             }
@@ -261,6 +284,13 @@ namespace mongo {
             else {
                 // Continue caching the ClientCursor.
                 cc->incPos(numResults);
+
+                // If we sized this batch ourselves, let the cursor learn from how long it
+                // took; a client-specified ntoreturn says nothing about our byte target.
+                if (0 == ntoreturn) {
+                    cc->noteBatchTime(batchTimer.micros());
+                }
+
                 runner->saveState();
                 QLOG() << "getMore saving client cursor ended w/state "
                        << Runner::statestr(state)
@@ -277,6 +307,18 @@ namespace mongo {
                 // cursor (for use by future getmore ops).
                 cc->setLeftoverMaxTimeMicros( curop.getRemainingMaxTimeMicros() );
             }
+
+            // Replace the batch with a single delta-encoded envelope document when the
+            // encoding actually wins.  Cursor position bookkeeping above already used
+            // the real document count; only the reply changes shape.
+            if (deltaBatch && numResults > 1) {
+                BSONObj envelope = BSONDeltaBatch::encode(deltaDocs);
+                if (!envelope.isEmpty()) {
+                    bb.setlen(sizeof(QueryResult));
+                    bb.appendBuf(envelope.objdata(), envelope.objsize());
+                    numResults = 1;
+                }
+            }
         }
 
         QueryResult* qr = reinterpret_cast<QueryResult*>(bb.buf());
@@ -461,7 +503,9 @@ namespace mongo {
         // bb is used to hold query results
         // this buffer should contain either requested documents per query or
         // explain information, but not both
-        BufBuilder bb(32768);
+        // Start at this connection's decayed reply high-water mark so steady-state
+        // traffic doesn't realloc-grow the buffer every query.
+        BufBuilder bb(cc().replySizeTracker().recommendedSize());
         bb.skip(sizeof(QueryResult));
 
         // How many results have we obtained from the runner?
@@ -569,7 +613,8 @@ namespace mongo {
         // Get explain information if it is needed by either the profiler
         // or by an explain() query.
         boost::scoped_ptr<TypeExplain> explain(NULL);
-        if (isExplain || ctx.ctx().db()->getProfilingLevel() > 0) {
+        if (isExplain || ctx.ctx().db()->getProfilingLevel() > 0
+                      || internalQueryShapeStatsEnabled) {
             // Ask the runner to produce explain information.
             TypeExplain* bareExplain;
             Status res = runner->getExplainPlan(&bareExplain);
@@ -650,6 +695,7 @@ namespace mongo {
         }
 
         // Add the results from the query into the output buffer.
+        cc().replySizeTracker().recordSize(bb.len());
         result.appendData(bb.buf(), bb.len());
         bb.decouple();
 
@@ -682,6 +728,18 @@ namespace mongo {
             }
         }
 
+        // Fold this query into the per-shape stats registry.
+        if (internalQueryShapeStatsEnabled && !isExplain && NULL != explain.get()) {
+            queryShapeStats.recordQuery(PlanCache::getPlanCacheKey(*cq),
+                                        pq.ns(),
+                                        explain->isCursorSet() ? explain->getCursor() : "",
+                                        curop.elapsedMillis(),
+                                        explain->isNScannedSet() ? explain->getNScanned() : 0,
+                                        explain->isNScannedObjectsSet() ?
+                                            explain->getNScannedObjects() : 0,
+                                        numResults);
+        }
+
         // curop.debug().exhaust is set above.
         return curop.debug().exhaust ? pq.ns() : "";
     }
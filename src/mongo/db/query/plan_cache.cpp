@@ -31,7 +31,6 @@
 #include <algorithm>
 #include <memory>
 #include <sstream>
-#include "boost/thread/locks.hpp"
 #include "mongo/db/query/plan_ranker.h"
 #include "mongo/db/query/query_solution.h"
 #include "mongo/db/query/qlog.h"
@@ -442,16 +441,17 @@ namespace mongo {
         entry->sort = pq.getSort().copy();
         entry->projection = pq.getProj().copy();
 
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        Partition& partition = _partition(key);
+        SimpleRWLock::Exclusive cacheLock(partition.lock);
         // XXX: Replacing existing entry - revisit when we have real cached solutions.
         // Delete previous entry
         typedef unordered_map<PlanCacheKey, PlanCacheEntry*>::const_iterator ConstIterator;
-        ConstIterator i = _cache.find(key);
-        if (i != _cache.end()) {
+        ConstIterator i = partition.map.find(key);
+        if (i != partition.map.end()) {
             PlanCacheEntry* previousEntry = i->second;
             delete previousEntry;
         }
-        _cache[key] = entry;
+        partition.map[key] = entry;
 
         return Status::OK();
     }
@@ -464,10 +464,13 @@ namespace mongo {
     Status PlanCache::get(const PlanCacheKey& key, CachedSolution** crOut) const {
         verify(crOut);
 
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        // Lookups only read the entry, so concurrent get()s for the same shape can share
+        // the partition lock.
+        Partition& partition = _partition(key);
+        SimpleRWLock::Shared cacheLock(partition.lock);
         typedef unordered_map<PlanCacheKey, PlanCacheEntry*>::const_iterator ConstIterator;
-        ConstIterator i = _cache.find(key);
-        if (i == _cache.end()) {
+        ConstIterator i = partition.map.find(key);
+        if (i == partition.map.end()) {
             return Status(ErrorCodes::BadValue, "no such key in cache");
         }
         PlanCacheEntry* entry = i->second;
@@ -479,39 +482,45 @@ namespace mongo {
     }
 
     Status PlanCache::feedback(const PlanCacheKey& ck, PlanCacheEntryFeedback* feedback) {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        Partition& partition = _partition(ck);
+        SimpleRWLock::Exclusive cacheLock(partition.lock);
         return Status(ErrorCodes::BadValue, "not implemented yet");
     }
 
     Status PlanCache::remove(const PlanCacheKey& ck) {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        Partition& partition = _partition(ck);
+        SimpleRWLock::Exclusive cacheLock(partition.lock);
         typedef unordered_map<PlanCacheKey, PlanCacheEntry*>::const_iterator ConstIterator;
-        ConstIterator i = _cache.find(ck);
-        if (i == _cache.end()) {
+        ConstIterator i = partition.map.find(ck);
+        if (i == partition.map.end()) {
             return Status(ErrorCodes::BadValue, "no such key in cache");
         }
         PlanCacheEntry* entry = i->second;
         verify(entry);
-        _cache.erase(i);
+        partition.map.erase(i);
         delete entry;
         return Status::OK();
     }
 
     void PlanCache::clear() {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
-        _clear();
+        for (size_t i = 0; i < kNumPartitions; ++i) {
+            SimpleRWLock::Exclusive cacheLock(_partitions[i].lock);
+            _clearPartition(&_partitions[i]);
+        }
         _writeOperations.store(0);
     }
 
     void PlanCache::getKeys(std::vector<PlanCacheKey>* keysOut) const {
         verify(keysOut);
 
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
         std::vector<PlanCacheKey> keys;
         typedef unordered_map<PlanCacheKey, PlanCacheEntry*>::const_iterator ConstIterator;
-        for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
-            const PlanCacheKey& key = i->first;
-            keys.push_back(key);
+        for (size_t p = 0; p < kNumPartitions; ++p) {
+            SimpleRWLock::Shared cacheLock(_partitions[p].lock);
+            for (ConstIterator i = _partitions[p].map.begin(); i != _partitions[p].map.end(); i++) {
+                const PlanCacheKey& key = i->first;
+                keys.push_back(key);
+            }
         }
 
         // Replace contents of output vector provided in keysOut.
@@ -519,10 +528,11 @@ namespace mongo {
     }
 
     Status PlanCache::pin(const PlanCacheKey& key, const PlanID& plan) {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        Partition& partition = _partition(key);
+        SimpleRWLock::Exclusive cacheLock(partition.lock);
         typedef unordered_map<PlanCacheKey, PlanCacheEntry*>::const_iterator ConstIterator;
-        ConstIterator i = _cache.find(key);
-        if (i == _cache.end()) {
+        ConstIterator i = partition.map.find(key);
+        if (i == partition.map.end()) {
             return Status(ErrorCodes::BadValue, "no such key in cache");
         }
         PlanCacheEntry* entry = i->second;
@@ -545,10 +555,11 @@ namespace mongo {
     }
 
     Status PlanCache::unpin(const PlanCacheKey& key) {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        Partition& partition = _partition(key);
+        SimpleRWLock::Exclusive cacheLock(partition.lock);
         typedef unordered_map<PlanCacheKey, PlanCacheEntry*>::const_iterator ConstIterator;
-        ConstIterator i = _cache.find(key);
-        if (i == _cache.end()) {
+        ConstIterator i = partition.map.find(key);
+        if (i == partition.map.end()) {
             return Status(ErrorCodes::BadValue, "no such key in cache");
         }
         PlanCacheEntry* entry = i->second;
@@ -560,10 +571,11 @@ namespace mongo {
     }
 
     Status PlanCache::addPlan(const PlanCacheKey& key, const BSONObj& details, PlanID* planOut) {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        Partition& partition = _partition(key);
+        SimpleRWLock::Exclusive cacheLock(partition.lock);
         typedef unordered_map<PlanCacheKey, PlanCacheEntry*>::const_iterator ConstIterator;
-        ConstIterator i = _cache.find(key);
-        if (i == _cache.end()) {
+        ConstIterator i = partition.map.find(key);
+        if (i == partition.map.end()) {
             return Status(ErrorCodes::BadValue, "no such key in cache");
         }
         PlanCacheEntry* entry = i->second;
@@ -594,19 +606,16 @@ namespace mongo {
     }
 
     Status PlanCache::shunPlan(const PlanCacheKey& key, const PlanID& plan) {
-        boost::lock_guard<boost::mutex> cacheLock(_cacheMutex);
+        Partition& partition = _partition(key);
+        SimpleRWLock::Exclusive cacheLock(partition.lock);
         typedef unordered_map<PlanCacheKey, PlanCacheEntry*>::const_iterator ConstIterator;
-        ConstIterator i = _cache.find(key);
-        if (i == _cache.end()) {
+        ConstIterator i = partition.map.find(key);
+        if (i == partition.map.end()) {
             return Status(ErrorCodes::BadValue, "no such key in cache");
         }
         PlanCacheEntry* entry = i->second;
         verify(entry);
 
-        if (i == _cache.end()) {
-            return Status(ErrorCodes::BadValue, "no such key in cache");
-        }
-
         // search for plan
         for (size_t i = 0; i < entry->plannerData.size(); i++) {
             stringstream ss;
@@ -640,13 +649,27 @@ namespace mongo {
         clear();
     }
 
-    void PlanCache::_clear() {
+    PlanCache::Partition& PlanCache::_partition(const PlanCacheKey& key) const {
+        // Use the same hash function the partition maps use; hashing the key is cheap
+        // relative to the entry clone done on a hit.
+        unordered_map<PlanCacheKey, PlanCacheEntry*>::hasher hash;
+        return _partitions[hash(key) % kNumPartitions];
+    }
+
+    // static
+    void PlanCache::_clearPartition(Partition* partition) {
         typedef unordered_map<PlanCacheKey, PlanCacheEntry*>::const_iterator ConstIterator;
-        for (ConstIterator i = _cache.begin(); i != _cache.end(); i++) {
+        for (ConstIterator i = partition->map.begin(); i != partition->map.end(); i++) {
             PlanCacheEntry* entry = i->second;
             delete entry;
         }
-        _cache.clear();
+        partition->map.clear();
+    }
+
+    void PlanCache::_clear() {
+        for (size_t i = 0; i < kNumPartitions; ++i) {
+            _clearPartition(&_partitions[i]);
+        }
     }
 
 }  // namespace mongo
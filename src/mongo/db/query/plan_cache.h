@@ -29,12 +29,13 @@
 #pragma once
 
 #include <set>
-#include <boost/thread/mutex.hpp>
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/query/canonical_query.h"
 #include "mongo/db/query/index_tag.h"
 #include "mongo/db/query/query_planner_params.h"
 #include "mongo/platform/atomic_word.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/util/concurrency/rwlock.h"
 
 namespace mongo {
 
@@ -414,18 +415,39 @@ namespace mongo {
     private:
 
         /**
-         * Releases resources associated with each cache entry
-         * and clears map.
-         * Invoked by clear() and during destruction.
+         * The cache is partitioned by a hash of the plan cache key so that queries of
+         * different shapes don't contend on a single lock.  Each partition is guarded by
+         * its own reader-writer lock, taken shared by get(), so concurrent lookups of the
+         * same shape proceed in parallel too: a lookup only reads the entry while
+         * deep-copying it into its own CachedSolution and holds no references afterwards.
          */
-        void _clear();
+        static const size_t kNumPartitions = 16;
 
-        unordered_map<PlanCacheKey, PlanCacheEntry*> _cache;
+        struct Partition {
+            Partition() : lock( "PlanCache" ) { }
+            mutable SimpleRWLock lock;
+            unordered_map<PlanCacheKey, PlanCacheEntry*> map;
+        };
 
         /**
-         * Protects _cache.
+         * Returns the partition 'key' lives in.
          */
-        mutable boost::mutex _cacheMutex;
+        Partition& _partition(const PlanCacheKey& key) const;
+
+        /**
+         * Releases resources associated with each cache entry and clears 'partition'.
+         * Caller must hold the partition's lock exclusively (or otherwise have exclusive
+         * access, as in the destructor).
+         */
+        static void _clearPartition(Partition* partition);
+
+        /**
+         * Clears all partitions without locking.
+         * Invoked during destruction.
+         */
+        void _clear();
+
+        mutable Partition _partitions[kNumPartitions];
 
         /**
          * Counter for write notifications since initialization or last clear() invocation.
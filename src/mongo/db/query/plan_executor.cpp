@@ -32,6 +32,7 @@
 #include "mongo/db/exec/plan_stats.h"
 #include "mongo/db/exec/working_set.h"
 #include "mongo/db/exec/working_set_common.h"
+#include "mongo/db/kill_current_op.h"
 #include "mongo/db/pdfile.h"
 
 namespace mongo {
@@ -79,6 +80,11 @@ namespace mongo {
         if (_killed) { return Runner::RUNNER_DEAD; }
 
         for (;;) {
+            // Batched interrupt point: a thread-local countdown per work()
+            // call, consulting the clock (and the kill flags) only every few
+            // hundred rows.
+            killCurrentOp.checkForInterruptPeriodic();
+
             // Yield, if we can yield ourselves.
             if (NULL != _yieldPolicy.get() && _yieldPolicy->shouldYield()) {
                 saveState();
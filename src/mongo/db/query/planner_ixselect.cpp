@@ -34,6 +34,7 @@
 #include "mongo/db/geo/hash.h"
 #include "mongo/db/matcher/expression_array.h"
 #include "mongo/db/matcher/expression_geo.h"
+#include "mongo/db/matcher/expression_parser.h"
 #include "mongo/db/matcher/expression_text.h"
 #include "mongo/db/query/indexability.h"
 #include "mongo/db/query/index_tag.h"
@@ -122,6 +123,63 @@ namespace mongo {
         }
     }
 
+    /**
+     * Is 'expr' equivalent to one of the conjuncts of 'query' (or to 'query' itself if it
+     * isn't an AND)?  If so, every document matching the query also matches 'expr'.
+     */
+    static bool impliedByQuery(const MatchExpression* expr, const MatchExpression* query) {
+        if (MatchExpression::AND == query->matchType()) {
+            for (size_t i = 0; i < query->numChildren(); ++i) {
+                if (query->getChild(i)->equivalent(expr)) {
+                    return true;
+                }
+            }
+            return false;
+        }
+        return query->equivalent(expr);
+    }
+
+    // static
+    void QueryPlannerIXSelect::stripUnsatisfiedPartialIndices(const MatchExpression* query,
+                                                              vector<IndexEntry>* out) {
+        vector<IndexEntry>::iterator it = out->begin();
+        while (it != out->end()) {
+            BSONElement filterElement = it->infoObj["filter"];
+            if (Object != filterElement.type()) {
+                // Not a partial index.
+                ++it;
+                continue;
+            }
+
+            bool satisfied = false;
+            StatusWithMatchExpression res = MatchExpressionParser::parse(filterElement.Obj());
+            if (res.isOK()) {
+                auto_ptr<MatchExpression> filter(res.getValue());
+                if (MatchExpression::AND == filter->matchType()) {
+                    satisfied = true;
+                    for (size_t i = 0; i < filter->numChildren(); ++i) {
+                        if (!impliedByQuery(filter->getChild(i), query)) {
+                            satisfied = false;
+                            break;
+                        }
+                    }
+                }
+                else {
+                    satisfied = impliedByQuery(filter.get(), query);
+                }
+            }
+
+            if (satisfied) {
+                ++it;
+            }
+            else {
+                QLOG() << "query does not imply filter of partial index " << it->toString()
+                       << ", ignoring it" << endl;
+                it = out->erase(it);
+            }
+        }
+    }
+
     // static
     bool QueryPlannerIXSelect::compatible(const BSONElement& elt,
                                           const IndexEntry& index,
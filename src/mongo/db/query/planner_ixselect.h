@@ -56,6 +56,15 @@ namespace mongo {
                                         const vector<IndexEntry>& indices,
                                         vector<IndexEntry>* out);
 
+        /**
+         * Remove from 'out' any partial index whose filter is not satisfied by every document
+         * matching 'query'.  We only detect the simple case where each conjunct of the index
+         * filter appears verbatim as a conjunct of the query; an index filtered on anything
+         * subtler stays out of consideration (it could be missing entries the query needs).
+         */
+        static void stripUnsatisfiedPartialIndices(const MatchExpression* query,
+                                                   vector<IndexEntry>* out);
+
         /**
          * Return true if the index key pattern field 'elt' (which belongs to 'index') can be used
          * to answer the predicate 'node'.
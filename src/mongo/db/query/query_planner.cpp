@@ -436,6 +436,11 @@ namespace mongo {
 
         if (hintIndex.isEmpty()) {
             QueryPlannerIXSelect::findRelevantIndices(fields, params.indices, &relevantIndices);
+
+            // A partial index is only usable if the query can't match documents the index
+            // is missing.  Hints skip this check: hinting a partial index is "I know what
+            // I'm doing", as with sparse.
+            QueryPlannerIXSelect::stripUnsatisfiedPartialIndices(query.root(), &relevantIndices);
         }
         else {
             // Sigh.  If the hint is specified it might be using the index name.
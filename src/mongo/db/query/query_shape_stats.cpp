@@ -0,0 +1,271 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/db/query/query_shape_stats.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/server_parameters.h"
+
+namespace mongo {
+
+    MONGO_EXPORT_SERVER_PARAMETER(internalQueryShapeStatsEnabled, bool, true);
+
+    namespace {
+
+        // a ratio this small is noise no matter how it compares to the old
+        // plan's; don't flag e.g. 0.2 -> 1.1 as a 5x regression
+        const double minRatioWorthFlagging = 10.0;
+
+        Histogram::Options latencyHistoOptions() {
+            Histogram::Options opts;
+            opts.numBuckets = 11; // 1ms, 2ms, 4ms, ... 1024ms, inf
+            opts.bucketSize = 1;
+            opts.exponential = true;
+            return opts;
+        }
+
+        double examinedPerReturned( long long examined, long long returned ) {
+            return static_cast<double>( examined ) /
+                   static_cast<double>( returned > 0 ? returned : 1 );
+        }
+    }
+
+    QueryShapeStats::ShapeStats::ShapeStats( const std::string& ns )
+        : ns( ns ),
+          numQueries( 0 ),
+          totalMillis( 0 ),
+          totalKeysExamined( 0 ),
+          totalDocsExamined( 0 ),
+          totalReturned( 0 ),
+          latencyHisto( latencyHistoOptions() ),
+          curPlanQueries( 0 ),
+          curPlanExamined( 0 ),
+          curPlanReturned( 0 ),
+          prevPlanRatio( -1 ),
+          regressionFlagged( false ) {
+    }
+
+    QueryShapeStats::QueryShapeStats() : _mutex( "QueryShapeStats" ) {
+    }
+
+    void QueryShapeStats::recordQuery( const PlanCacheKey& key,
+                                       const std::string& ns,
+                                       const std::string& plan,
+                                       int millis,
+                                       long long keysExamined,
+                                       long long docsExamined,
+                                       long long nreturned ) {
+        scoped_lock lk( _mutex );
+
+        boost::shared_ptr<ShapeStats>& stats = _shapes[ key ];
+        if ( !stats ) {
+            if ( _shapes.size() > MaxTrackedShapes ) {
+                // at capacity; _shapes[key] above created an empty slot
+                _shapes.erase( key );
+                return;
+            }
+            stats.reset( new ShapeStats( ns ) );
+        }
+
+        stats->numQueries++;
+        stats->totalMillis += millis;
+        stats->totalKeysExamined += keysExamined;
+        stats->totalDocsExamined += docsExamined;
+        stats->totalReturned += nreturned;
+        stats->latencyHisto.insert( millis > 0 ? millis : 0 );
+
+        if ( plan != stats->curPlan ) {
+            // the plan serving this shape changed; if the outgoing plan has
+            // enough samples behind it, freeze its ratio as the baseline the
+            // new plan is judged against
+            if ( stats->curPlanQueries >= MinSamplesPerPlan ) {
+                stats->prevPlan = stats->curPlan;
+                stats->prevPlanRatio = examinedPerReturned( stats->curPlanExamined,
+                                                            stats->curPlanReturned );
+            }
+            stats->curPlan = plan;
+            stats->curPlanQueries = 0;
+            stats->curPlanExamined = 0;
+            stats->curPlanReturned = 0;
+            stats->regressionFlagged = false;
+        }
+
+        stats->curPlanQueries++;
+        stats->curPlanExamined += keysExamined + docsExamined;
+        stats->curPlanReturned += nreturned;
+
+        if ( !stats->regressionFlagged &&
+             stats->prevPlanRatio >= 0 &&
+             stats->curPlanQueries == MinSamplesPerPlan ) {
+            double curRatio = examinedPerReturned( stats->curPlanExamined,
+                                                   stats->curPlanReturned );
+            if ( curRatio > stats->prevPlanRatio * RegressionFactor &&
+                 curRatio > minRatioWorthFlagging ) {
+                stats->regressionFlagged = true;
+                warning() << "possible plan regression for query shape " << key
+                          << " on " << stats->ns
+                          << ": plan changed from " << stats->prevPlan
+                          << " to " << stats->curPlan
+                          << ", examined/returned went from " << stats->prevPlanRatio
+                          << " to " << curRatio
+                          << " over the last " << stats->curPlanQueries << " queries"
+                          << endl;
+            }
+        }
+    }
+
+    void QueryShapeStats::_appendShape( const PlanCacheKey& key,
+                                        const ShapeStats& stats,
+                                        BSONArrayBuilder* out ) {
+        BSONObjBuilder b( out->subobjStart() );
+        b.append( "shape", key );
+        b.append( "ns", stats.ns );
+        b.appendNumber( "count", stats.numQueries );
+        b.appendNumber( "totalMillis", stats.totalMillis );
+        b.appendNumber( "keysExamined", stats.totalKeysExamined );
+        b.appendNumber( "docsExamined", stats.totalDocsExamined );
+        b.appendNumber( "nreturned", stats.totalReturned );
+        b.append( "examinedPerReturned",
+                  examinedPerReturned( stats.totalKeysExamined + stats.totalDocsExamined,
+                                       stats.totalReturned ) );
+        b.append( "plan", stats.curPlan );
+        if ( !stats.prevPlan.empty() || stats.prevPlanRatio >= 0 ) {
+            b.append( "prevPlan", stats.prevPlan );
+            b.append( "prevExaminedPerReturned", stats.prevPlanRatio );
+        }
+        b.appendBool( "regressionFlagged", stats.regressionFlagged );
+
+        BSONObjBuilder latency( b.subobjStart( "latencyMillis" ) );
+        uint32_t numBuckets = stats.latencyHisto.getBucketsNum();
+        for ( uint32_t i = 0; i < numBuckets; i++ ) {
+            StringBuilder label;
+            if ( i + 1 == numBuckets )
+                label << "rest";
+            else
+                label << "upTo" << stats.latencyHisto.getBoundary( i );
+            latency.appendNumber( label.str(),
+                                  static_cast<long long>( stats.latencyHisto.getCount( i ) ) );
+        }
+        latency.done();
+
+        b.done();
+    }
+
+    void QueryShapeStats::appendTopShapes( int limit, BSONArrayBuilder* out ) const {
+        scoped_lock lk( _mutex );
+
+        // order shape pointers by total execution time, most expensive first
+        std::vector< std::pair<const PlanCacheKey*, const ShapeStats*> > byCost;
+        byCost.reserve( _shapes.size() );
+        for ( ShapeMap::const_iterator i = _shapes.begin(); i != _shapes.end(); ++i )
+            byCost.push_back( std::make_pair( &i->first, i->second.get() ) );
+
+        struct CostOrder {
+            bool operator()( const std::pair<const PlanCacheKey*, const ShapeStats*>& a,
+                             const std::pair<const PlanCacheKey*, const ShapeStats*>& b ) const {
+                return a.second->totalMillis > b.second->totalMillis;
+            }
+        };
+        std::sort( byCost.begin(), byCost.end(), CostOrder() );
+
+        for ( size_t i = 0; i < byCost.size() && static_cast<int>( i ) < limit; i++ )
+            _appendShape( *byCost[i].first, *byCost[i].second, out );
+    }
+
+    size_t QueryShapeStats::numShapes() const {
+        scoped_lock lk( _mutex );
+        return _shapes.size();
+    }
+
+    void QueryShapeStats::clear() {
+        scoped_lock lk( _mutex );
+        _shapes.clear();
+    }
+
+    QueryShapeStats queryShapeStats;
+
+    /**
+     * Dumps the most expensive query shapes: {queryShapeStats: 1, limit: N}.
+     * {queryShapeStats: 1, clear: true} resets the registry instead.
+     */
+    class QueryShapeStatsCmd : public Command {
+    public:
+        QueryShapeStatsCmd() : Command( "queryShapeStats" ) {}
+
+        virtual bool slaveOk() const { return true; }
+        virtual bool adminOnly() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+
+        virtual void help( stringstream& h ) const {
+            h << "Dumps per-query-shape execution statistics, most expensive shapes"
+              << " by total time first.  Options: {limit: N} (default 20),"
+              << " {clear: true} to reset.";
+        }
+
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::queryShapeStats);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+
+        bool run(const string& dbname, BSONObj& cmdObj, int, string& errmsg,
+                 BSONObjBuilder& result, bool fromRepl) {
+
+            if ( cmdObj["clear"].trueValue() ) {
+                queryShapeStats.clear();
+                result.appendBool( "cleared", true );
+                return true;
+            }
+
+            int limit = 20;
+            if ( cmdObj["limit"].isNumber() )
+                limit = cmdObj["limit"].numberInt();
+            if ( limit < 1 )
+                limit = 1;
+            else if ( limit > QueryShapeStats::MaxTrackedShapes )
+                limit = QueryShapeStats::MaxTrackedShapes;
+
+            BSONArrayBuilder shapes( result.subarrayStart( "shapes" ) );
+            queryShapeStats.appendTopShapes( limit, &shapes );
+            shapes.done();
+
+            result.appendNumber( "numShapesTracked",
+                                 static_cast<long long>( queryShapeStats.numShapes() ) );
+            return true;
+        }
+    } queryShapeStatsCmd;
+
+}  // namespace mongo
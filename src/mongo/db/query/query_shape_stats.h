@@ -0,0 +1,139 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <string>
+
+#include <boost/shared_ptr.hpp>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/db/query/plan_cache.h"
+#include "mongo/platform/unordered_map.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/histogram.h"
+
+namespace mongo {
+
+    // feed the registry from the query path? runtime-settable; see newRunQuery
+    extern bool internalQueryShapeStatsEnabled;
+
+    /**
+     * Accumulates execution statistics per query shape, keyed by the shape's
+     * plan cache key: how often it ran, a latency histogram, keys/docs
+     * examined, and which plan served it.  When the plan serving a shape
+     * changes and the examined/returned ratio then degrades, the shape is
+     * flagged in the log and in the queryShapeStats command output, so plan
+     * regressions show up as signals instead of customer complaints.
+     *
+     * Thread safe; one global instance (queryShapeStats below).
+     */
+    class QueryShapeStats : boost::noncopyable {
+    public:
+        enum Constants {
+            // new shapes are not admitted past this, so a workload that
+            // generates unbounded shapes can't grow the registry forever
+            MaxTrackedShapes = 1000,
+
+            // queries a plan must serve before its examined/returned ratio is
+            // trusted, either as a baseline or as evidence of a regression
+            MinSamplesPerPlan = 32,
+
+            // flagged when the ratio under the new plan exceeds the old
+            // plan's by this factor (and isn't trivially small, see .cpp)
+            RegressionFactor = 4
+        };
+
+        QueryShapeStats();
+
+        /**
+         * Fold one completed query into the shape's stats.  'plan' identifies
+         * what ran (the explain cursor string, e.g. "BtreeCursor a_1"); a
+         * change in it marks a plan change for regression tracking.
+         */
+        void recordQuery( const PlanCacheKey& key,
+                          const std::string& ns,
+                          const std::string& plan,
+                          int millis,
+                          long long keysExamined,
+                          long long docsExamined,
+                          long long nreturned );
+
+        /**
+         * Append the 'limit' tracked shapes with the highest total execution
+         * time to 'out', most expensive first, one document per shape.
+         */
+        void appendTopShapes( int limit, BSONArrayBuilder* out ) const;
+
+        /** number of shapes currently tracked */
+        size_t numShapes() const;
+
+        /** forget everything (used by the command's {clear: true} form) */
+        void clear();
+
+    private:
+        struct ShapeStats {
+            ShapeStats( const std::string& ns );
+
+            std::string ns;
+
+            long long numQueries;
+            long long totalMillis;
+            long long totalKeysExamined;
+            long long totalDocsExamined;
+            long long totalReturned;
+            Histogram latencyHisto; // exponential millis buckets
+
+            // what's been examined/returned under the plan currently serving
+            // the shape, reset at each plan change
+            std::string curPlan;
+            long long curPlanQueries;
+            long long curPlanExamined;
+            long long curPlanReturned;
+
+            // finalized ratio under the previous plan; < 0 until a plan
+            // change retires a plan with enough samples behind it
+            std::string prevPlan;
+            double prevPlanRatio;
+
+            bool regressionFlagged;
+        };
+
+        typedef unordered_map<PlanCacheKey, boost::shared_ptr<ShapeStats> > ShapeMap;
+
+        static void _appendShape( const PlanCacheKey& key,
+                                  const ShapeStats& stats,
+                                  BSONArrayBuilder* out );
+
+        mutable mongo::mutex _mutex; // protects _shapes and all ShapeStats
+        ShapeMap _shapes;
+    };
+
+    extern QueryShapeStats queryShapeStats;
+
+}  // namespace mongo
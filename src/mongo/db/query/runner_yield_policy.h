@@ -29,13 +29,26 @@
 #pragma once
 
 #include "mongo/db/clientcursor.h"
-#include "mongo/util/elapsed_tracker.h"
+#include "mongo/util/net/listen.h"
 
 namespace mongo {
 
+    // How many milliseconds a runner gets to work before shouldYield() tells it to give the
+    // lock up.  Exported as a server parameter from runner_yield_policy.cpp.
+    extern int runnerTimeSliceMS;
+
+    /**
+     * Decides when a runner should offer to yield its lock.  Each runner gets a time slice of
+     * runnerTimeSliceMS; shouldYield() is a single read of the listener's cached clock and a
+     * compare, so it's cheap enough to call once per document.  A runner that exhausts its
+     * slice yields and starts a fresh slice; how long it stays yielded is scaled by how many
+     * ops are queued on the lock (see ClientCursor::suggestYieldMicros).
+     */
     class RunnerYieldPolicy {
     public:
-        RunnerYieldPolicy() : _elapsedTracker(128, 10), _runnerYielding(NULL) { }
+        RunnerYieldPolicy() : _pings(0), _runnerYielding(NULL) {
+            startNewSlice();
+        }
 
         ~RunnerYieldPolicy() {
             if (NULL != _runnerYielding) {
@@ -46,7 +59,22 @@ namespace mongo {
         }
 
         bool shouldYield() {
-            return _elapsedTracker.intervalHasElapsed();
+            long long now = Listener::getElapsedTimeMillis();
+
+            if ( 0 == now ) {
+                // No listener time tracker (repair, tools).  Fall back to yielding every few
+                // hundred calls rather than never yielding at all.
+                if ( ++_pings < 256 ) { return false; }
+                _pings = 0;
+                return true;
+            }
+
+            if ( now < _sliceEndMillis ) { return false; }
+
+            // Re-arm here so a caller that decides not to yield after all isn't told to yield
+            // again on every subsequent document.
+            startNewSlice();
+            return true;
         }
 
         /**
@@ -70,7 +98,7 @@ namespace mongo {
             staticYield(micros, record);
             ClientCursor::deregisterRunner(_runnerYielding);
             _runnerYielding = NULL;
-            _elapsedTracker.resetLastTime();
+            startNewSlice();
             return runner->restoreState();
         }
 
@@ -87,14 +115,8 @@ namespace mongo {
             // we want to page in the record in the lock even if nobody is waiting for the lock?
             if (micros > 0 || (NULL != rec)) {
                 staticYield(micros, rec);
-                // XXX: when do we really want to reset this?
-                //
-                // Currently we reset it when we actually yield.  As such we'll keep on trying
-                // to yield once the tracker has elapsed.
-                //
-                // If we reset it even if we don't yield, we'll wait until the time interval
-                // elapses again to try yielding.
-                _elapsedTracker.resetLastTime();
+                // The time spent yielded shouldn't count against the next slice.
+                startNewSlice();
             }
         }
 
@@ -103,7 +125,17 @@ namespace mongo {
         }
 
     private:
-        ElapsedTracker _elapsedTracker;
+        void startNewSlice() {
+            _sliceEndMillis = Listener::getElapsedTimeMillis() + runnerTimeSliceMS;
+            _pings = 0;
+        }
+
+        // When the current slice expires, against the listener's clock.
+        long long _sliceEndMillis;
+
+        // Only used as a backstop when there is no listener time tracker.
+        int _pings;
+
         Runner* _runnerYielding;
     };
 
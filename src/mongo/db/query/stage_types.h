@@ -37,6 +37,7 @@ namespace mongo {
         STAGE_AND_HASH,
         STAGE_AND_SORTED,
         STAGE_COLLSCAN,
+        STAGE_COUNT,
         STAGE_FETCH,
 
         // TODO: This is probably an expression index, but would take even more time than
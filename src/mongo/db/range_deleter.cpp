@@ -28,6 +28,7 @@
 
 #include "mongo/db/range_deleter.h"
 
+#include <algorithm>
 #include <boost/date_time/posix_time/posix_time_duration.hpp>
 #include <memory>
 
@@ -36,6 +37,7 @@
 #include "mongo/util/concurrency/synchronization.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/time_support.h"
+#include "mongo/util/timer.h"
 
 using std::auto_ptr;
 using std::set;
@@ -171,9 +173,11 @@ namespace mongo {
         }
     }
 
-    void RangeDeleter::startWorkers() {
-        if (!_worker) {
-            _worker.reset(new boost::thread(boost::bind(&RangeDeleter::doWork, this)));
+    void RangeDeleter::startWorkers(int numWorkers) {
+        if (_workers.empty()) {
+            for (int i = 0; i < numWorkers; i++) {
+                _workers.push_back(new boost::thread(boost::bind(&RangeDeleter::doWork, this)));
+            }
         }
     }
 
@@ -183,9 +187,13 @@ namespace mongo {
             _stopRequested = true;
         }
 
-        if (_worker) {
-            _worker->join();
+        for (std::vector<boost::thread*>::iterator it = _workers.begin();
+            it != _workers.end();
+            ++it) {
+            (*it)->join();
+            delete (*it);
         }
+        _workers.clear();
 
         scoped_lock sl(_queueMutex);
         while (_stats->hasInProgress_inlock()) {
@@ -315,8 +323,11 @@ namespace mongo {
             sleepmillis(checkIntervalMillis);
         }
 
+        long long numDocsDeleted = 0;
+        Timer deleteTimer;
+
         bool result = _env->deleteRange(ns, min, max, shardKeyPattern,
-                                        secondaryThrottle, errMsg);
+                                        secondaryThrottle, &numDocsDeleted, errMsg);
 
         {
             scoped_lock sl(_queueMutex);
@@ -324,6 +335,8 @@ namespace mongo {
 
             _stats->decInProgressDeletes_inlock();
             _stats->decTotalDeletes_inlock();
+            _stats->addDeletedDocs_inlock(numDocsDeleted);
+            _stats->addDeleteElapsedMillis_inlock(deleteTimer.millis());
 
             if (!_stats->hasInProgress_inlock()) {
                 _nothingInProgressCV.notify_one();
@@ -396,6 +409,31 @@ namespace mongo {
         return builder.obj();
     }
 
+    RangeDeleter::RangeDeleteEntry* RangeDeleter::dequeueRunnableTask_inlock() {
+        for (TaskList::iterator iter = _taskQueue.begin(); iter != _taskQueue.end(); ++iter) {
+            RangeDeleteEntry* entry = *iter;
+
+            bool overlapsInProgress = false;
+            for (TaskList::const_iterator busyIter = _inProgressQueue.begin();
+                    busyIter != _inProgressQueue.end(); ++busyIter) {
+                const RangeDeleteEntry* busyEntry = *busyIter;
+                if (entry->ns == busyEntry->ns &&
+                        rangeOverlaps(entry->min, entry->max,
+                                      busyEntry->min, busyEntry->max)) {
+                    overlapsInProgress = true;
+                    break;
+                }
+            }
+
+            if (!overlapsInProgress) {
+                _taskQueue.erase(iter);
+                return entry;
+            }
+        }
+
+        return NULL;
+    }
+
     void RangeDeleter::doWork() {
         while (!inShutdown() && !stopRequested()) {
             string errMsg;
@@ -404,7 +442,13 @@ namespace mongo {
 
             {
                 scoped_lock sl(_queueMutex);
-                while (_taskQueue.empty()) {
+
+                if (stopRequested()) {
+                    log() << "stopping range deleter worker" << endl;
+                    return;
+                }
+
+                while ((nextTask = dequeueRunnableTask_inlock()) == NULL) {
                     _taskQueueNotEmptyCV.timed_wait(
                         sl.boost(), duration::milliseconds(NotEmptyTimeoutMillis));
 
@@ -446,23 +490,20 @@ namespace mongo {
                     }
                 }
 
-                if (stopRequested()) {
-                    log() << "stopping range deleter worker" << endl;
-                    return;
-                }
-
-                nextTask = _taskQueue.front();
-                _taskQueue.pop_front();
-
+                _inProgressQueue.push_back(nextTask);
                 _stats->decPendingDeletes_inlock();
                 _stats->incInProgressDeletes_inlock();
             }
 
+            long long numDocsDeleted = 0;
+            Timer deleteTimer;
+
             if (!_env->deleteRange(nextTask->ns,
                                    nextTask->min,
                                    nextTask->max,
                                    nextTask->shardKeyPattern,
                                    nextTask->secondaryThrottle,
+                                   &numDocsDeleted,
                                    &errMsg)) {
                 warning() << "Error encountered while trying to delete range: "
                           << errMsg << endl;
@@ -471,10 +512,21 @@ namespace mongo {
             {
                 scoped_lock sl(_queueMutex);
 
+                TaskList::iterator inProgressIter =
+                        std::find(_inProgressQueue.begin(), _inProgressQueue.end(), nextTask);
+                verify(inProgressIter != _inProgressQueue.end());
+                _inProgressQueue.erase(inProgressIter);
+
                 NSMinMax setEntry(nextTask->ns, nextTask->min, nextTask->max);
                 deletePtrElement(&_deleteSet, &setEntry);
                 _stats->decInProgressDeletes_inlock();
                 _stats->decTotalDeletes_inlock();
+                _stats->addDeletedDocs_inlock(numDocsDeleted);
+                _stats->addDeleteElapsedMillis_inlock(deleteTimer.millis());
+
+                // A queued task held back because it overlapped this range may be
+                // runnable now.
+                _taskQueueNotEmptyCV.notify_one();
 
                 if (nextTask->notifyDone) {
                     nextTask->notifyDone->notifyOne();
@@ -32,6 +32,7 @@
 #include <deque>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "mongo/base/disallow_copying.h"
 #include "mongo/base/string_data.h"
@@ -53,9 +54,11 @@ namespace mongo {
      *
      * Threading assumptions:
      *
-     *   This class has (currently) one worker thread attacking the queue, one
-     *   job at a time. If we want an immediate deletion, that job is going to
-     *   be performed on the thread that is requesting it.
+     *   This class has one or more worker threads attacking the queue, one
+     *   job per thread at a time. Jobs whose ranges overlap a delete already
+     *   in progress are held back until that delete finishes. If we want an
+     *   immediate deletion, that job is going to be performed on the thread
+     *   that is requesting it.
      *
      *   All calls regarding deletion are synchronized.
      *
@@ -89,15 +92,17 @@ namespace mongo {
         //
 
         /**
-         * Starts the background thread to work on this queue. Does nothing if the worker
-         * thread is already active.
+         * Starts the background threads to work on this queue. Does nothing if the worker
+         * threads are already active. Worker threads only pick up tasks whose range does
+         * not overlap a delete already in progress, so deletes of non-overlapping ranges
+         * proceed in parallel.
          *
          * This call is _not_ thread safe and must be issued before any other call.
          */
-        void startWorkers();
+        void startWorkers(int numWorkers = 1);
 
         /**
-         * Stops the background thread working on this queue. This will block if there are
+         * Stops the background threads working on this queue. This will block if there are
          * tasks that are being deleted, but will leave the pending tasks in the queue.
          *
          * Steps:
@@ -200,9 +205,15 @@ namespace mongo {
 
         typedef std::set<NSMinMax*, NSMinMaxCmp> NSMinMaxSet; // owned here
 
-        /** Body of the worker thread */
+        /** Body of the worker threads */
         void doWork();
 
+        /**
+         * Returns the first queued task whose range does not overlap any delete currently
+         * in progress, or NULL if there is none. Assumes _queueMutex is held.
+         */
+        RangeDeleteEntry* dequeueRunnableTask_inlock();
+
         /** Returns true if range is blacklisted. Assumes _queueMutex is held */
         bool isBlacklisted_inlock(const StringData& ns,
                                   const BSONObj& min,
@@ -221,7 +232,8 @@ namespace mongo {
         scoped_ptr<RangeDeleterEnv> _env;
 
         // Initially not active. Must be started explicitly.
-        scoped_ptr<boost::thread> _worker;
+        // Note: pointers are owned here.
+        std::vector<boost::thread*> _workers;
 
         // Protects _stopRequested.
         mutable mutex _stopMutex;
@@ -250,6 +262,12 @@ namespace mongo {
         // Note: pointer life cycle is not handled here.
         TaskList _taskQueue;
 
+        // Tasks currently being worked on by the worker threads. Used to keep
+        // overlapping queued ranges from being deleted concurrently.
+        //
+        // Note: pointer life cycle is not handled here.
+        TaskList _inProgressQueue;
+
         // Set of all deletes - deletes waiting for cursors, waiting to be acted upon
         // and in progress. Includes both queued and immediate deletes.
         //
@@ -279,6 +297,9 @@ namespace mongo {
          * responsible for making sure that the proper contexts are setup
          * to be able to perform deletions.
          *
+         * The number of documents actually removed is reported through
+         * numDocsDeleted (can be NULL), even when the call fails part way.
+         *
          * Must be a synchronous call. Docs should be deleted after call ends.
          * Must not throw Exceptions.
          */
@@ -287,6 +308,7 @@ namespace mongo {
                                  const BSONObj& exclusiveUpper,
                                  const BSONObj& shardKeyPattern,
                                  bool secondaryThrottle,
+                                 long long* numDocsDeleted,
                                  std::string* errMsg) = 0;
 
         /**
@@ -53,7 +53,12 @@ namespace mongo {
                                         const BSONObj& exclusiveUpper,
                                         const BSONObj& keyPattern,
                                         bool secondaryThrottle,
+                                        long long* numDocsDeleted,
                                         std::string* errMsg) {
+        if (numDocsDeleted != NULL) {
+            *numDocsDeleted = 0;
+        }
+
         const bool initiallyHaveClient = haveClient();
 
         if (!initiallyHaveClient) {
@@ -95,6 +100,10 @@ namespace mongo {
                     return false;
                 }
 
+                if (numDocsDeleted != NULL) {
+                    *numDocsDeleted = numDeleted;
+                }
+
                 log() << "rangeDeleter deleted " << numDeleted
                       << " documents for " << ns
                       << " from " << inclusiveLower
@@ -46,6 +46,9 @@ namespace mongo {
          * Note that secondaryThrottle will be ignored if current process is not part
          * of a replica set.
          *
+         * The number of documents removed is reported through numDocsDeleted
+         * (can be NULL).
+         *
          * Does not throw Exceptions.
          */
         virtual bool deleteRange(const StringData& ns,
@@ -53,6 +56,7 @@ namespace mongo {
                                  const BSONObj& exclusiveUpper,
                                  const BSONObj& keyPattern,
                                  bool secondaryThrottle,
+                                 long long* numDocsDeleted,
                                  std::string* errMsg);
 
         /**
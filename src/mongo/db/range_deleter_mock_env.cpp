@@ -105,8 +105,13 @@ namespace mongo {
                                           const BSONObj& max,
                                           const BSONObj& shardKeyPattern,
                                           bool secondaryThrottle,
+                                          long long* numDocsDeleted,
                                           string* errMsg) {
 
+        if (numDocsDeleted != NULL) {
+            *numDocsDeleted = 0;
+        }
+
         {
             scoped_lock sl(_pauseDeleteMutex);
             bool wasInitiallyPaused = _pauseDelete;
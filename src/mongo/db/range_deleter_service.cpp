@@ -30,6 +30,7 @@
 
 #include "mongo/base/init.h"
 #include "mongo/db/range_deleter_db_env.h"
+#include "mongo/db/server_parameters.h"
 
 namespace {
 
@@ -38,6 +39,10 @@ namespace {
 
 namespace mongo {
 
+    // Number of background worker threads deleting migrated ranges. Non-overlapping
+    // ranges are deleted in parallel, one per worker.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER( rangeDeleterWorkers, int, 2 );
+
     MONGO_INITIALIZER(RangeDeleterInit)(InitializerContext* context) {
         _deleter = new RangeDeleter(new RangeDeleterDBEnv);
         return Status::OK();
@@ -33,6 +33,9 @@
 
 namespace mongo {
 
+    // Startup server parameter controlling the number of deleter worker threads.
+    extern int rangeDeleterWorkers;
+
     /**
      * Gets the global instance of the deleter and starts it.
      */
@@ -32,6 +32,9 @@ namespace mongo {
     const BSONField<int> RangeDeleterStats::TotalDeletesField("totalDeletes");
     const BSONField<int> RangeDeleterStats::PendingDeletesField("pendingDeletes");
     const BSONField<int> RangeDeleterStats::InProgressDeletesField("inProgressDeletes");
+    const BSONField<long long> RangeDeleterStats::DeletedDocsField("deletedDocs");
+    const BSONField<double>
+            RangeDeleterStats::AvgDocsDeletedPerSecField("avgDocsDeletedPerSec");
 
     BSONObj RangeDeleterStats::toBSON() const {
         scoped_lock sl(*_lockPtr);
@@ -40,6 +43,11 @@ namespace mongo {
         builder << TotalDeletesField(_totalDeletes);
         builder << PendingDeletesField(_pendingDeletes);
         builder << InProgressDeletesField(_inProgressDeletes);
+        builder << DeletedDocsField(_deletedDocs);
+
+        const double elapsedSecs = _deleteElapsedMillis / 1000.0;
+        builder << AvgDocsDeletedPerSecField(elapsedSecs > 0 ?
+                                             _deletedDocs / elapsedSecs : 0.0);
 
         return builder.obj();
     }
@@ -52,6 +52,12 @@ namespace mongo {
         // Total number of deletes that are currently in progress.
         static const BSONField<int> InProgressDeletesField;
 
+        // Total number of documents removed by deletes so far.
+        static const BSONField<long long> DeletedDocsField;
+
+        // Average number of documents removed per second while a delete was running.
+        static const BSONField<double> AvgDocsDeletedPerSecField;
+
         /**
          * Creates a stat object given the mutex from the RangeDeleter object
          * that this instance is keeping track of.
@@ -60,7 +66,9 @@ namespace mongo {
             _lockPtr(lockPtr),
             _totalDeletes(0),
             _pendingDeletes(0),
-            _inProgressDeletes(0) {
+            _inProgressDeletes(0),
+            _deletedDocs(0),
+            _deleteElapsedMillis(0) {
         }
 
         /**
@@ -100,6 +108,14 @@ namespace mongo {
             _inProgressDeletes--;
         }
 
+        void addDeletedDocs_inlock(long long numDocs) {
+            _deletedDocs += numDocs;
+        }
+
+        void addDeleteElapsedMillis_inlock(long long millis) {
+            _deleteElapsedMillis += millis;
+        }
+
         bool hasInProgress_inlock() {
             return _inProgressDeletes > 0;
         }
@@ -111,5 +127,11 @@ namespace mongo {
         int _totalDeletes;
         int _pendingDeletes;
         int _inProgressDeletes;
+
+        long long _deletedDocs;
+
+        // Total amount of time spent inside deleteRange calls. Used together with
+        // _deletedDocs to report the delete rate.
+        long long _deleteElapsedMillis;
     };
 }
@@ -37,6 +37,7 @@
 #include "mongo/db/repl/rs.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/base/counter.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/timer_stats.h"
 
 namespace mongo {
@@ -45,6 +46,12 @@ namespace replset {
     int SleepToAllowBatchingMillis = 2;
     const int BatchIsSmallish = 40000; // bytes
 
+    // stream the oplog fetch in exhaust mode: the sync target issues the
+    // getmores itself and sends batches continuously, so a lagging member's
+    // fetch pipe stays full instead of idling one round trip per batch.
+    // matters most on high-latency (cross-dc) links.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(replExhaustOplogFetch, bool, true);
+
     MONGO_FP_DECLARE(rsBgSyncProduce);
 
     BackgroundSync* BackgroundSync::s_instance = 0;
@@ -361,6 +368,31 @@ namespace replset {
             return;
         }
 
+        if (replExhaustOplogFetch) {
+            // Re-issue the tailing query in exhaust mode for the long-lived
+            // fetch.  From here until this pass ends the cursor is the only
+            // user of the connection, which is what makes exhaust safe: the
+            // target streams batches at us unsolicited, so nothing else may
+            // talk on the socket, and the reader (connection included) is
+            // discarded when we return, mid-stream or not.  Flow control is
+            // the bounded buffer below plus tcp backpressure -- when we stop
+            // draining the socket the target blocks in send.
+            r.resetCursor();
+            r.setTailingQueryOptions(r.getTailingQueryOptions() | QueryOption_Exhaust);
+            r.tailingQueryGTE(rsoplog, lastOpTimeFetched);
+            if (!r.haveCursor() || !r.more()) {
+                return;
+            }
+
+            // isRollbackRequired() already vetted the anchor op; the new cursor
+            // starts at it again, so consume it rather than re-buffering it.
+            BSONObj first = r.nextSafe();
+            if (first["ts"]._opTime() != lastOpTimeFetched) {
+                // source moved under us; come back around and redo the checks
+                return;
+            }
+        }
+
         while (!inShutdown()) {
             if (!r.moreInCurrentBatch()) {
                 // Check some things periodically
@@ -78,8 +78,9 @@ namespace replset {
         // _mutex protects all of the class variables
         boost::mutex _mutex;
 
-        // Production thread
-        BlockingQueue<BSONObj> _buffer;
+        // Production thread.  the produce thread is the only pusher and the
+        // applier is the only popper, so the SPSC ring applies.
+        SPSCQueue<BSONObj> _buffer;
 
         OpTime _lastOpTimeFetched;
         long long _lastH;
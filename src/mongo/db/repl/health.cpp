@@ -398,6 +398,22 @@ namespace mongo {
         return closest;
     }
 
+    const OpTime ReplSetImpl::earliestOtherOpTime() const {
+        OpTime earliest(0,0);
+
+        for( Member *m = _members.head(); m; m=m->next() ) {
+            if (!m->hbinfo().up() || m->config().arbiterOnly) {
+                continue;
+            }
+
+            if (earliest.isNull() || m->hbinfo().opTime < earliest) {
+                earliest = m->hbinfo().opTime;
+            }
+        }
+
+        return earliest;
+    }
+
     const OpTime ReplSetImpl::lastOtherElectableOpTime() const {
         OpTime closest(0,0);
 
@@ -278,6 +278,97 @@ namespace mongo {
 
     }
 
+    /* batched variant of _logOpRS for several ops of the same type against one ns.
+       one "local" lock and one OpTime::m critical section cover the whole batch:
+       the optimes and the chained hashes are reserved up front, every frame is
+       then built outside OpTime::m into the shared buffer, and finally the
+       entries are appended back to back in a single pass over the collection.
+       per-record capped allocation is kept -- the capped allocator reclaims
+       space record by record, so the contiguous carve insertRecords() does for
+       normal collections does not apply here.
+    */
+    static void _logOpsRS(const char *opstr, const char *ns, const std::vector<BSONObj>& objs, bool fromMigrate ) {
+        verify( !objs.empty() );
+
+        Lock::DBWrite lk1("local");
+
+        if ( strncmp(ns, "local.", 6) == 0 ) {
+            if ( strncmp(ns, "local.slaves", 12) == 0 )
+                resetSlaveCache();
+            return;
+        }
+
+        /* reserve the slot range: n consecutive optimes and the hash chain hanging
+           off lastH.  nothing can interleave with us -- _logOpRS writes under the
+           "local" lock too -- so the range we reserve is the range we write.
+        */
+        std::vector<OpTime> times;
+        std::vector<long long> hashes;
+        times.reserve( objs.size() );
+        hashes.reserve( objs.size() );
+        {
+            mutex::scoped_lock lk2(OpTime::m);
+            massert(17473, "replSet error : logOps() but not primary?",
+                    theReplSet && theReplSet->box.getState().primary());
+            long long h = theReplSet->lastH;
+            for ( size_t i = 0; i < objs.size(); i++ ) {
+                const OpTime ts = OpTime::now(lk2);
+                h = (h * 131 + ts.asLL()) * 17 + theReplSet->selfId();
+                times.push_back( ts );
+                hashes.push_back( h );
+            }
+        }
+
+        /* build every frame into the shared buffer before touching the collection.
+           keep offsets, not BSONObjs -- the buffer may grow and relocate.
+        */
+        logopbufbuilder.reset();
+        std::vector<int> offsets;
+        offsets.reserve( objs.size() );
+        for ( size_t i = 0; i < objs.size(); i++ ) {
+            offsets.push_back( logopbufbuilder.len() );
+            BSONObjBuilder b(logopbufbuilder);
+            b.appendTimestamp("ts", times[i].asDate());
+            b.append("h", hashes[i]);
+            b.append("v", OPLOG_VERSION);
+            b.append("op", opstr);
+            b.append("ns", ns);
+            if (fromMigrate)
+                b.appendBool("fromMigrate", true);
+            b.done();
+        }
+
+        if ( localOplogRSCollection == 0 ) {
+            Client::Context ctx(rsoplog, storageGlobalParams.dbpath);
+            localDB = ctx.db();
+            verify( localDB );
+            localOplogRSCollection = localDB->getCollection( rsoplog );
+            massert(13347, "local.oplog.rs missing. did you drop it? if so restart server", localOplogRSCollection);
+        }
+
+        Client::Context ctx(rsoplog, localDB);
+        for ( size_t i = 0; i < objs.size(); i++ ) {
+            BSONObj partial( logopbufbuilder.buf() + offsets[i] );
+            OplogDocWriter writer( partial, objs[i] );
+            checkOplogInsert( localOplogRSCollection->insertDocument( &writer, false ) );
+        }
+
+        if( !(theReplSet->lastOpTimeWritten < times.front()) ) {
+            log() << "replication oplog stream went back in time. previous timestamp: "
+                  << theReplSet->lastOpTimeWritten << " newest timestamp: " << times.front()
+                  << ". attempting to sync directly from primary." << endl;
+            std::string errmsg;
+            BSONObjBuilder result;
+            if (!theReplSet->forceSyncFrom(theReplSet->box.getPrimary()->fullName(),
+                                           errmsg, result)) {
+                log() << "Can't sync from primary: " << errmsg << endl;
+            }
+        }
+        theReplSet->lastOpTimeWritten = times.back();
+        theReplSet->lastH = hashes.back();
+        ctx.getClient()->setLastOp( times.back() );
+    }
+
     static void _logOpOld(const char *opstr, const char *ns, const char *logNS, const BSONObj& obj, BSONObj *o2, bool *bb, bool fromMigrate ) {
         Lock::DBWrite lk("local");
         static BufBuilder bufbuilder(8*1024); // todo there is likely a mutex on this constructor
@@ -379,6 +470,32 @@ namespace mongo {
 
     }
 
+    void logOps(const char* opstr,
+                const char* ns,
+                const std::vector<BSONObj>& objs,
+                bool fromMigrate) {
+        if ( replSettings.master ) {
+            if ( _logOp == _logOpRS && objs.size() > 1 ) {
+                _logOpsRS(opstr, ns, objs, fromMigrate);
+            }
+            else {
+                // master/slave (or a batch of one): no batched path, keep per-op behavior
+                for ( size_t i = 0; i < objs.size(); i++ )
+                    _logOp(opstr, ns, 0, objs[i], 0, 0, fromMigrate);
+            }
+        }
+
+        for ( size_t i = 0; i < objs.size(); i++ ) {
+            logOpForSharding(opstr, ns, objs[i], 0, 0, fromMigrate);
+            logOpForDbHash(opstr, ns, objs[i], 0, 0, fromMigrate);
+            getGlobalAuthorizationManager()->logOp(opstr, ns, objs[i], 0, 0);
+        }
+
+        if ( strstr( ns, ".system.js" ) ) {
+            Scope::storedFuncMod(); // this is terrible
+        }
+    }
+
     void createOplog() {
         Lock::GlobalWrite lk;
 
@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 namespace mongo {
 
     class BSONObj;
@@ -70,6 +72,21 @@ namespace mongo {
                 BSONObj *patt = NULL, bool *b = NULL, bool fromMigrate = false,
                 const BSONObj* fullObj = NULL );
 
+    /** Log several operations of the same type against the same ns in one pass.
+
+        On a replica-set primary this takes the local db lock and the OpTime
+        mutex once for the whole batch instead of once per op: the batch
+        reserves a contiguous run of optimes (and the chained hashes that go
+        with them) in a single critical section, builds every entry outside it
+        into one buffer, then appends them to the oplog back to back.  Callers
+        that already write documents in bulk (see insertMultiBulk) should log
+        them in bulk too.
+
+        Falls back to per-op logOp behavior for master/slave.
+     */
+    void logOps( const char *opstr, const char *ns, const std::vector<BSONObj>& objs,
+                 bool fromMigrate = false );
+
     // Log an empty no-op operation to the local oplog
     void logKeepalive();
 
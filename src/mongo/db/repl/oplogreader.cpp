@@ -41,6 +41,7 @@
 #include "mongo/db/dbhelpers.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/repl/rs.h"  // theReplSet
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/assert_util.h"
 #include "mongo/util/log.h"
 
@@ -53,6 +54,10 @@ namespace mongo {
                                                     "repl.network.readersCreated",
                                                     &readersCreatedStats );
 
+    // snappy-compress oplog traffic to/from the sync source; worthwhile when
+    // replicating over WAN links where bytes cost more than cpu
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(replWireCompression, bool, false);
+
 
     static const BSONObj userReplQuery = fromjson("{\"user\":\"repl\"}");
 
@@ -106,6 +111,9 @@ namespace mongo {
                 log() << "repl: " << errmsg << endl;
                 return false;
             }
+            if ( replWireCompression && !_conn->negotiateWireCompression() ) {
+                LOG(1) << "repl: " << hostName << " does not support wire compression" << endl;
+            }
         }
         return true;
     }
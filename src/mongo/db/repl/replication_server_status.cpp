@@ -33,6 +33,7 @@
 #include <boost/scoped_ptr.hpp>
 
 #include "mongo/client/connpool.h"
+#include "mongo/db/client.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/query/internal_plans.h"
@@ -183,6 +184,20 @@ namespace mongo {
             result.appendDate("localTime", jsTime());
             result.append("maxWireVersion", maxWireVersion);
             result.append("minWireVersion", minWireVersion);
+
+            // a client that advertises a compressor we support can decode dbCompressed
+            // messages, so start compressing what we send it and echo the compressor
+            // back so it does the same
+            if ( cmdObj["compression"].type() == Array ) {
+                BSONForEach( e , cmdObj["compression"].Obj() ) {
+                    if ( e.type() == String && e.str() == "snappy" ) {
+                        if ( cc().port() )
+                            cc().port()->setWireCompression( true );
+                        result.append( "compression" , BSON_ARRAY( "snappy" ) );
+                        break;
+                    }
+                }
+            }
             return true;
         }
     } cmdismaster;
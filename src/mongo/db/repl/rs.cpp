@@ -54,9 +54,11 @@ namespace mongo {
 
 #ifdef MONGO_PLATFORM_64
     const int ReplSetImpl::replWriterThreadCount = 16;
+    const int ReplSetImpl::replWriterPartitionCount = 64;
     const int ReplSetImpl::replPrefetcherThreadCount = 16;
 #else
     const int ReplSetImpl::replWriterThreadCount = 2;
+    const int ReplSetImpl::replWriterPartitionCount = 8;
     const int ReplSetImpl::replPrefetcherThreadCount = 2;
 #endif
 
@@ -582,6 +582,11 @@ namespace mongo {
         }
             
         static const int replWriterThreadCount;
+        // ops are partitioned by namespace hash into this many apply tasks per
+        // batch.  more partitions than writers, so when one namespace dominates a
+        // batch the idle writers can steal the other partitions instead of
+        // waiting on the hot one.
+        static const int replWriterPartitionCount;
         static const int replPrefetcherThreadCount;
         threadpool::ThreadPool& getPrefetchPool() { return _prefetcherPool; }
         threadpool::ThreadPool& getWriterPool() { return _writerPool; }
@@ -597,6 +602,12 @@ namespace mongo {
          * The most up to date electable replica
          */
         const OpTime lastOtherElectableOpTime() const;
+        /**
+         * The least up to date replica that is up and not an arbiter, i.e. the
+         * member whose replication lag bounds how far behind the set can get.
+         * Returns a null OpTime if no such member is up.
+         */
+        const OpTime earliestOtherOpTime() const;
 
         /**
          * When a member reaches its minValid optime it is in a consistent state.  Thus, minValid is
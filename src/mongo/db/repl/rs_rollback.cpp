@@ -109,6 +109,10 @@ namespace mongo {
            need to refetch it once. */
         set<DocID> toRefetch;
 
+        /* docs whose oldest op in the rollback range is their own insert: they did not exist
+           at the common point, so the undo is a local delete and no refetch is needed. */
+        set<DocID> toDelete;
+
         /* collections to drop */
         set<string> toDrop;
 
@@ -219,7 +223,18 @@ namespace mongo {
             return;
         }
 
-        h.toRefetch.insert(d);
+        if( *op == 'i' ) {
+            /* we scan the oplog newest to oldest, so a doc's final classification reflects
+               the oldest op in the rollback range that touched it.  if that op is the doc's
+               insert, the doc did not exist at the common point -- invert it locally with a
+               delete instead of refetching it from the source. */
+            h.toDelete.insert(d);
+            h.toRefetch.erase(d);
+        }
+        else {
+            h.toRefetch.insert(d);
+            h.toDelete.erase(d);
+        }
     }
 
     int getRBID(DBClientConnection*);
@@ -346,26 +361,78 @@ namespace mongo {
 
         bo newMinValid;
 
-        /* fetch all the goodVersions of each document from current primary */
+        /* fetch all the goodVersions of each document from current primary.  the refetches
+           are batched into $in queries per collection -- toRefetch is sorted by ns, so each
+           run of ids replaces that many findOne round trips with one query. */
+        const unsigned maxIdsPerBatch = 500;
+
         DocID d;
         unsigned long long n = 0;
         try {
-            for( set<DocID>::iterator i = h.toRefetch.begin(); i != h.toRefetch.end(); i++ ) {
+            set<DocID>::iterator i = h.toRefetch.begin();
+            while( i != h.toRefetch.end() ) {
                 d = *i;
-
                 verify( !d._id.eoo() );
 
-                {
-                    /* TODO : slow.  lots of round trips. */
+                if( d._id.type() == RegEx ) {
+                    // a regex element inside $in matches as a pattern, not by value;
+                    // fetch these the old way
                     n++;
-                    bo good= them->findOne(d.ns, d._id.wrap(), NULL, QueryOption_SlaveOk).getOwned();
+                    bo good = them->findOne(d.ns, d._id.wrap(), NULL, QueryOption_SlaveOk).getOwned();
                     totSize += good.objsize();
                     uassert( 13410, "replSet too much data to roll back", totSize < 300 * 1024 * 1024 );
-
-                    // note good might be eoo, indicating we should delete it
                     goodVersions.push_back(pair<DocID,bo>(d,good));
+                    i++;
+                    continue;
+                }
+
+                // gather a chunk of ids for this collection
+                set<DocID> pending;
+                BSONArrayBuilder ids;
+                while( i != h.toRefetch.end() && strcmp(i->ns, d.ns) == 0 &&
+                       pending.size() < maxIdsPerBatch ) {
+                    if( i->_id.type() == RegEx )
+                        break;
+                    ids.append(i->_id);
+                    pending.insert(*i);
+                    i++;
+                }
+
+                auto_ptr<DBClientCursor> cur = them->query(d.ns,
+                                                           QUERY("_id" << BSON("$in" << ids.arr())),
+                                                           0, 0, NULL, QueryOption_SlaveOk);
+                uassert( 17474, str::stream() << "rollback error querying " << d.ns, cur.get() );
+                while( cur->more() ) {
+                    bo good = cur->nextSafe().getOwned();
+                    n++;
+                    totSize += good.objsize();
+                    uassert( 13410, "replSet too much data to roll back", totSize < 300 * 1024 * 1024 );
+
+                    DocID found;
+                    found.ns = d.ns;
+                    found._id = good["_id"];
+                    set<DocID>::iterator p = pending.find(found);
+                    if( p == pending.end() ) {
+                        log() << "replSet warning rollback got unrequested doc from " << d.ns << rsLog;
+                        continue;
+                    }
+                    goodVersions.push_back(pair<DocID,bo>(*p, good));
+                    pending.erase(p);
+                }
+
+                // not returned by the source: these docs should be deleted
+                for( set<DocID>::iterator p = pending.begin(); p != pending.end(); p++ ) {
+                    n++;
+                    goodVersions.push_back(pair<DocID,bo>(*p, bo()));
                 }
             }
+
+            /* docs that did not exist at the common point (their oldest op in the rollback
+               range was their insert) take the delete path below with no refetch at all. */
+            for( set<DocID>::iterator p = h.toDelete.begin(); p != h.toDelete.end(); p++ ) {
+                goodVersions.push_back(pair<DocID,bo>(*p, bo()));
+            }
+
             newMinValid = r.getLastOp(rsoplog);
             if( newMinValid.isEmpty() ) {
                 sethbmsg("rollback error newMinValid empty?");
@@ -45,6 +45,7 @@
 #include "mongo/db/repl/rs.h"
 #include "mongo/db/repl/rs_sync.h"
 #include "mongo/db/storage_options.h"
+#include "mongo/platform/unordered_set.h"
 #include "mongo/util/fail_point_service.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/stats/timer_stats.h"
@@ -225,12 +226,43 @@ namespace replset {
         }
     }
 
+    // returns a key identifying the pages an op's prefetch would touch, or "" if
+    // the op has no dedup key.  high-churn workloads hit the same documents many
+    // times per batch; prefetching a (ns, _id) pair once per batch is enough.
+    static std::string prefetchDedupKey(const BSONObj& op) {
+        const char* opType = op.getStringField("op");
+        const char* opField;
+        switch (*opType) {
+        case 'i':
+        case 'd':
+            opField = "o";
+            break;
+        case 'u':
+            opField = "o2";
+            break;
+        default:
+            return "";
+        }
+        BSONElement id = op.getObjectField(opField)["_id"];
+        if (id.eoo())
+            return "";
+        StringBuilder sb;
+        sb << op.getStringField("ns") << ';' << id.toString(false);
+        return sb.str();
+    }
+
     // Doles out all the work to the reader pool threads and waits for them to complete
     void SyncTail::prefetchOps(const std::deque<BSONObj>& ops) {
         threadpool::ThreadPool& prefetcherPool = theReplSet->getPrefetchPool();
+        unordered_set<string> scheduled;
         for (std::deque<BSONObj>::const_iterator it = ops.begin();
              it != ops.end();
              ++it) {
+            const std::string key = prefetchDedupKey(*it);
+            if (!key.empty() && !scheduled.insert(key).second) {
+                // another op in this batch already prefetches these pages
+                continue;
+            }
             prefetcherPool.schedule(&prefetchOp, *it);
         }
         prefetcherPool.join();
@@ -241,11 +273,16 @@ namespace replset {
                                      MultiSyncApplyFunc applyFunc) {
         ThreadPool& writerPool = theReplSet->getWriterPool();
         TimerHolder timer(&applyBatchStats);
+        unsigned partition = 0;
         for (std::vector< std::vector<BSONObj> >::const_iterator it = writerVectors.begin();
              it != writerVectors.end();
-             ++it) {
+             ++it, ++partition) {
             if (!it->empty()) {
-                writerPool.schedule(applyFunc, boost::cref(*it), this);
+                // affinity by partition keeps a namespace on the same writer from
+                // batch to batch (warm pages, warm db lock), while stealing still
+                // rebalances skewed batches
+                writerPool.scheduleWithAffinity(
+                        boost::bind(applyFunc, boost::cref(*it), this), partition);
             }
         }
         writerPool.join();
@@ -257,7 +294,7 @@ namespace replset {
         // Use a ThreadPool to prefetch all the operations in a batch.
         prefetchOps(ops);
         
-        std::vector< std::vector<BSONObj> > writerVectors(theReplSet->replWriterThreadCount);
+        std::vector< std::vector<BSONObj> > writerVectors(theReplSet->replWriterPartitionCount);
         fillWriterVectors(ops, &writerVectors);
         LOG(2) << "replication batch size is " << ops.size() << endl;
         // We must grab this because we're going to grab write locks later.
@@ -265,14 +302,36 @@ namespace replset {
         // because all readers are blocked anyway.
         SimpleMutex::scoped_lock fsynclk(filesLockedFsync);
 
-        // stop all readers until we're done
-        Lock::ParallelBatchWriterMode pbwm;
+        // publish the dbs this batch writes before stopping readers: readers of
+        // other dbs are then let past the batch lock, since for them the current
+        // view is the pre-batch view.  a batch containing a command blocks every
+        // reader -- a command's writes can't be attributed to one db from its ns.
+        std::set<std::string> dbs;
+        bool touchesAll = false;
+        for (std::deque<BSONObj>::const_iterator it = ops.begin(); it != ops.end(); ++it) {
+            const char* ns = it->getStringField("ns");
+            if (*it->getStringField("op") == 'c' || !*ns) {
+                touchesAll = true;
+                break;
+            }
+            dbs.insert(nsToDatabase(ns));
+        }
+        Lock::ParallelBatchWriterMode::setBatchWrites(dbs, touchesAll);
 
-        applyOps(writerVectors, applyFunc);
+        {
+            // stop writers and same-db readers until we're done
+            Lock::ParallelBatchWriterMode pbwm;
+            applyOps(writerVectors, applyFunc);
+        }
+        Lock::ParallelBatchWriterMode::clearBatchWrites();
     }
 
 
-    void SyncTail::fillWriterVectors(const std::deque<BSONObj>& ops, 
+    // Partitions ops by namespace hash.  Ordering is only preserved within a
+    // partition, which is safe because ops on one namespace always hash to the
+    // same partition; commands and index builds never get here -- they end the
+    // batch and are applied alone (see tryPopAndWaitForMore).
+    void SyncTail::fillWriterVectors(const std::deque<BSONObj>& ops,
                                               std::vector< std::vector<BSONObj> >* writerVectors) {
         for (std::deque<BSONObj>::const_iterator it = ops.begin();
              it != ops.end();
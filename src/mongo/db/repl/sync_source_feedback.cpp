@@ -35,11 +35,14 @@
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/security_key.h"
 #include "mongo/db/dbhelpers.h"
+#include "mongo/db/dbmessage.h"
 #include "mongo/db/repl/bgsync.h"
 #include "mongo/db/repl/rs.h"  // theReplSet
 
 namespace mongo {
 
+    void assembleRequest( const string &ns, BSONObj query, int nToReturn, int nToSkip, const BSONObj *fieldsToReturn, int queryOptions, Message &toSend );
+
     // used in replAuthenticate
     static const BSONObj userReplQuery = fromjson("{\"user\":\"repl\"}");
 
@@ -83,6 +86,12 @@ namespace mongo {
     }
 
     bool SyncSourceFeedback::replHandshake() {
+        // a pipelined position update may still be awaiting its reply; the handshake
+        // commands below run synchronously on the same connection
+        if (!_finishPipelinedUpdate()) {
+            return false;
+        }
+
         // handshake for us
         BSONObjBuilder cmd;
         cmd.append("replSetUpdatePosition", 1);
@@ -244,18 +253,51 @@ namespace mongo {
             }
         }
         array.done();
-        BSONObj res;
 
-        bool ok;
+        // pipeline the command: collect the reply to the previous update if one is
+        // still outstanding, then put this one on the wire without waiting for its
+        // round trip.  our new position reaches the sync source one send latency
+        // after it changed instead of queueing behind the previous reply.
+        if (!_finishPipelinedUpdate()) {
+            return false;
+        }
         try {
-            ok = _connection->runCommand("admin", cmd.obj(), res);
+            Message request;
+            assembleRequest("admin.$cmd", cmd.obj(), 1, 0, NULL, 0, request);
+            _connection->say(request);
+            _updateInFlight = true;
         }
         catch (const DBException& e) {
             log() << "SyncSourceFeedback error sending update: " << e.what() << endl;
             resetConnection();
             return false;
         }
-        if (!ok) {
+        return true;
+    }
+
+    bool SyncSourceFeedback::_finishPipelinedUpdate() {
+        if (!_updateInFlight) {
+            return true;
+        }
+        _updateInFlight = false;
+
+        Message reply;
+        try {
+            if (!_connection->recv(reply)) {
+                log() << "SyncSourceFeedback error receiving update reply" << endl;
+                resetConnection();
+                return false;
+            }
+        }
+        catch (const DBException& e) {
+            log() << "SyncSourceFeedback error receiving update reply: " << e.what() << endl;
+            resetConnection();
+            return false;
+        }
+
+        QueryResult* qr = (QueryResult*) reply.singleData();
+        BSONObj res(qr->data());
+        if (!res["ok"].trueValue()) {
             log() << "SyncSourceFeedback error sending update, response: " << res.toString() <<endl;
             resetConnection();
             return false;
@@ -43,6 +43,7 @@ namespace mongo {
                               _syncTarget(NULL),
                               _oplogReader(new OplogReader()),
                               _supportsUpdater(false),
+                              _updateInFlight(false),
                               _positionChanged(false),
                               _handshakeNeeded(false) {}
 
@@ -69,6 +70,7 @@ namespace mongo {
         void resetConnection() {
             LOG(1) << "resetting connection in sync source feedback";
             _connection.reset();
+            _updateInFlight = false;
         }
 
         void resetOplogReaderConnection() {
@@ -146,10 +148,18 @@ namespace mongo {
         bool replHandshake();
 
         /* Inform the sync target of our current position in the oplog, as well as the positions
-         * of all secondaries chained through us.
+         * of all secondaries chained through us.  The command is pipelined: it goes on the wire
+         * without waiting for its reply, which is collected before the next exchange on the
+         * connection.  That keeps a position change from queueing one round trip behind the
+         * previous update's reply, which matters for w:majority latency on slow links.
          */
         bool updateUpstream();
 
+        /* Collects the reply to a pipelined update, if one is outstanding.  Returns false
+         * (resetting the connection) if the update failed.
+         */
+        bool _finishPipelinedUpdate();
+
         bool hasConnection() {
             return _connection.get();
         }
@@ -167,6 +177,8 @@ namespace mongo {
         boost::scoped_ptr<DBClientConnection> _connection;
         // tracks whether we are in fallback mode or not
         bool _supportsUpdater;
+        // a pipelined update's reply has not been collected yet (see updateUpstream())
+        bool _updateInFlight;
         // protects connection
         boost::mutex _connmtx;
         // protects cond and maps and the indicator bools
@@ -0,0 +1,71 @@
+/**
+ *    Copyright (C) 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ *    As a special exception, the copyright holders give permission to link the
+ *    code of portions of this program with the OpenSSL library under certain
+ *    conditions as described in each individual source file and distribute
+ *    linked combinations including the program with the OpenSSL library. You
+ *    must comply with the GNU Affero General Public License in all respects for
+ *    all of the code used other than as permitted herein. If you modify file(s)
+ *    with this exception, you may extend this exception to your version of the
+ *    file(s), but you are not obligated to do so. If you do not wish to do so,
+ *    delete this exception statement from your version. If you delete this
+ *    exception statement from all source files in the program, then also delete
+ *    it in the license file.
+ */
+
+#pragma once
+
+#include <boost/shared_ptr.hpp>
+
+#include "mongo/bson/ordering.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/structure/btree/key.h"
+
+namespace mongo {
+
+    /**
+     * A sort key packed into the btree's KeyV1 format, promoted out of the btree so that
+     * in-memory sorts can compare keys with the compact byte-wise comparator instead of
+     * element-by-element BSONObj::woCompare.
+     *
+     * Keys that KeyV1 cannot represent compactly (rare types, very large values) are kept
+     * as plain BSON inside the KeyV1Owned and still compare correctly, just without the
+     * fast path.  The copyable wrapper shares the underlying buffer, so keys can sit in
+     * vectors and sets without reallocating.
+     */
+    class PackedSortKey {
+    public:
+        PackedSortKey() { }
+
+        /** 'key' is a btree-style key (field names ignored by comparison). */
+        explicit PackedSortKey( const BSONObj& key )
+            : _key( new KeyV1Owned( key ) ) {
+        }
+
+        bool isValid() const { return _key.get() != NULL; }
+
+        /** as woCompare: <0, 0, >0.  'ordering' comes from Ordering::make(sortPattern). */
+        int compare( const PackedSortKey& other, const Ordering& ordering ) const {
+            return _key->woCompare( *other._key, ordering );
+        }
+
+        BSONObj toBson() const { return _key->toBson(); }
+
+    private:
+        boost::shared_ptr<const KeyV1Owned> _key;
+    };
+
+} // namespace mongo
@@ -47,7 +47,11 @@
 
 #include "mongo/db/sorter/sorter.h"
 
+#include <boost/bind.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/thread/condition_variable.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
 #include <snappy.h>
 
 #include "mongo/base/string_data.h"
@@ -107,6 +111,18 @@ namespace mongo {
 #endif
         }
 
+        /** checksum over a spill file block's on-disk bytes (FNV-1a).  fast and
+         *  order-sensitive; just to catch corruption between here and the disk --
+         *  spill files can traverse network-attached storage. */
+        inline uint32_t blockChecksum(const char* data, size_t len) {
+            uint32_t h = 2166136261u;
+            for (size_t i = 0; i < len; i++) {
+                h ^= static_cast<unsigned char>(data[i]);
+                h *= 16777619u;
+            }
+            return h;
+        }
+
         /** Ensures a named file is deleted when this object goes out of scope */
         class FileDeleter {
         public:
@@ -147,7 +163,13 @@ namespace mongo {
             std::deque<Data> _data;
         };
 
-        /** Returns results in order from a single file */
+        /** Returns results in order from a single file.
+         *
+         *  Reads are double-buffered: once iteration starts, a background
+         *  thread reads the next raw block from disk while the consumer
+         *  deserializes the current one, so a k-way merge keeps the disk busy
+         *  instead of stalling on every block boundary.
+         */
         template <typename Key, typename Value>
         class FileIterator : public SortIteratorInterface<Key, Value> {
         public:
@@ -164,6 +186,10 @@ namespace mongo {
                 , _fileName(fileName)
                 , _fileDeleter(fileDeleter)
                 , _file(_fileName.c_str(), std::ios::in | std::ios::binary)
+                , _slotFull(false)
+                , _slotEof(false)
+                , _slotErrorId(0)
+                , _shutdown(false)
             {
                 massert(16814, str::stream() << "error opening file \"" << _fileName << "\": "
                                              << myErrnoWithDescription(),
@@ -173,6 +199,17 @@ namespace mongo {
                         boost::filesystem::file_size(_fileName) != 0);
             }
 
+            ~FileIterator() {
+                if (_prefetcher) {
+                    {
+                        boost::unique_lock<boost::mutex> lk(_mutex);
+                        _shutdown = true;
+                        _slotFreed.notify_one();
+                    }
+                    _prefetcher->join();
+                }
+            }
+
             bool more() {
                 if (!_done)
                     fillIfNeeded(); // may change _done
@@ -199,63 +236,162 @@ namespace mongo {
             }
 
             void fill() {
+                if (!_prefetcher) {
+                    // started lazily so files produced while still sorting
+                    // don't tie up a thread (or issue reads) until iterated
+                    _prefetcher.reset(
+                        new boost::thread(boost::bind(&FileIterator::_prefetchLoop, this)));
+                }
+
                 int32_t rawSize;
-                read(&rawSize, sizeof(rawSize));
-                if (_done) return;
+                uint32_t checksum;
+                std::vector<char> block;
+                {
+                    boost::unique_lock<boost::mutex> lk(_mutex);
+                    while (!_slotFull)
+                        _slotFilled.wait(lk);
+
+                    if (_slotErrorId) {
+                        msgasserted(_slotErrorId, _slotError);
+                    }
+
+                    if (_slotEof) {
+                        _done = true;
+                        return;
+                    }
+
+                    rawSize = _slotRawSize;
+                    checksum = _slotChecksum;
+                    block.swap(_slotBlock);
+                    _slotFull = false;
+                    _slotFreed.notify_one(); // lets the prefetcher read the next block
+                }
 
                 // negative size means compressed
                 const bool compressed = rawSize < 0;
                 const int32_t blockSize = std::abs(rawSize);
 
-                _buffer.reset(new char[blockSize]);
-                read(_buffer.get(), blockSize);
-                massert(16816, "file too short?", !_done);
+                massert(17491, str::stream() << "checksum mismatch reading block of \""
+                                             << _fileName << "\" -- spill file corrupted?",
+                        blockChecksum(&block[0], blockSize) == checksum);
 
                 if (!compressed) {
-                    _reader.reset(new BufReader(_buffer.get(), blockSize));
+                    _buffer.swap(block);
+                    _reader.reset(new BufReader(&_buffer[0], blockSize));
                     return;
                 }
 
-                dassert(snappy::IsValidCompressedBuffer(_buffer.get(), blockSize));
+                dassert(snappy::IsValidCompressedBuffer(&block[0], blockSize));
 
                 size_t uncompressedSize;
                 massert(17061, "couldn't get uncompressed length",
-                        snappy::GetUncompressedLength(_buffer.get(), blockSize, &uncompressedSize));
+                        snappy::GetUncompressedLength(&block[0], blockSize, &uncompressedSize));
 
-                boost::scoped_array<char> decompressionBuffer(new char[uncompressedSize]);
+                std::vector<char> decompressionBuffer(uncompressedSize);
                 massert(17062, "decompression failed",
-                        snappy::RawUncompress(_buffer.get(),
+                        snappy::RawUncompress(&block[0],
                                               blockSize,
-                                              decompressionBuffer.get()));
+                                              &decompressionBuffer[0]));
 
                 // hold on to decompressed data and throw out compressed data at block exit
                 _buffer.swap(decompressionBuffer);
-                _reader.reset(new BufReader(_buffer.get(), uncompressedSize));
+                _reader.reset(new BufReader(&_buffer[0], uncompressedSize));
+            }
+
+            /** runs on the prefetch thread, which is the only toucher of _file
+             *  once started.  reads one raw block ahead of the consumer into the
+             *  single-slot mailbox; errors are parked in the slot and rethrown
+             *  on the consumer's thread. */
+            void _prefetchLoop() {
+                while (true) {
+                    int32_t rawSize = 0;
+                    uint32_t checksum = 0;
+                    std::vector<char> block;
+                    bool eof = false;
+                    int errorId = 0;
+                    std::string error;
+
+                    if (!_read(&rawSize, sizeof(rawSize), &errorId, &error)) {
+                        if (!errorId)
+                            eof = true;
+                    }
+                    else if (!_read(&checksum, sizeof(checksum), &errorId, &error)
+                             && !errorId) {
+                        errorId = 16816;
+                        error = "file too short?";
+                    }
+                    else if (!errorId) {
+                        block.resize(std::abs(rawSize));
+                        if (!_read(&block[0], block.size(), &errorId, &error)) {
+                            if (!errorId) {
+                                errorId = 16816;
+                                error = "file too short?";
+                            }
+                        }
+                    }
+
+                    boost::unique_lock<boost::mutex> lk(_mutex);
+                    while (_slotFull && !_shutdown)
+                        _slotFreed.wait(lk);
+                    if (_shutdown)
+                        return;
+
+                    _slotRawSize = rawSize;
+                    _slotChecksum = checksum;
+                    _slotBlock.swap(block);
+                    _slotEof = eof;
+                    _slotErrorId = errorId;
+                    _slotError = error;
+                    _slotFull = true;
+                    _slotFilled.notify_one();
+
+                    if (eof || errorId)
+                        return;
+                }
             }
 
-            // sets _done to true on EOF - asserts on any other error
-            void read(void* out, size_t size) {
+            // returns false on EOF (*errorId stays 0) or error (*errorId set);
+            // must not throw - it runs on the prefetch thread
+            bool _read(void* out, size_t size, int* errorId, std::string* error) {
                 _file.read(reinterpret_cast<char*>(out), size);
                 if (!_file.good()) {
-                    if (_file.eof()) {
-                        _done = true;
-                        return;
-                    }
+                    if (_file.eof())
+                        return false;
 
-                    msgasserted(16817, str::stream() << "error reading file \""
-                                                     << _fileName << "\": "
-                                                     << myErrnoWithDescription());
+                    *errorId = 16817;
+                    *error = str::stream() << "error reading file \"" << _fileName << "\": "
+                                           << myErrnoWithDescription();
+                    return false;
+                }
+                if (_file.gcount() != static_cast<std::streamsize>(size)) {
+                    *errorId = 16817;
+                    *error = str::stream() << "short read from file \"" << _fileName << "\"";
+                    return false;
                 }
-                verify(_file.gcount() == static_cast<std::streamsize>(size));
+                return true;
             }
 
             const Settings _settings;
             bool _done;
-            boost::scoped_array<char> _buffer;
+            std::vector<char> _buffer; // block the current _reader points into
             boost::scoped_ptr<BufReader> _reader;
             string _fileName;
             boost::shared_ptr<FileDeleter> _fileDeleter; // Must outlive _file
             std::ifstream _file;
+
+            // single-slot mailbox between the prefetch thread and the consumer
+            boost::mutex _mutex;
+            boost::condition_variable _slotFilled;
+            boost::condition_variable _slotFreed;
+            bool _slotFull;
+            bool _slotEof;
+            int _slotErrorId;       // nonzero: consumer rethrows _slotError
+            std::string _slotError;
+            int32_t _slotRawSize;
+            uint32_t _slotChecksum;
+            std::vector<char> _slotBlock;
+            bool _shutdown;
+            boost::scoped_ptr<boost::thread> _prefetcher; // last: joins in dtor
         };
 
         /** Merge-sorts results from 0 or more FileIterators */
@@ -381,6 +517,99 @@ namespace mongo {
             STLComparator _greater; // named so calls make sense
         };
 
+        /** Writes sorted runs to disk on a background thread so the producer
+         *  can keep sorting the next run while the previous one is written.
+         *
+         *  At most one run is in flight: spill() first waits out any previous
+         *  write, so peak memory is one run being written plus one being
+         *  filled (i.e. up to 2x SortOptions::maxMemoryUsageBytes).
+         *
+         *  Owned and driven by a single thread; only the write itself happens
+         *  in the background.  Errors from the writer thread are rethrown on
+         *  the owner's thread at the next spill()/finishInFlight().
+         */
+        template <typename Key, typename Value, typename Container>
+        class BackgroundSpiller {
+        public:
+            typedef SortIteratorInterface<Key, Value> Iterator;
+            typedef std::pair<typename Key::SorterDeserializeSettings
+                             ,typename Value::SorterDeserializeSettings
+                             > Settings;
+
+            BackgroundSpiller(const SortOptions& opts,
+                              const Settings& settings,
+                              std::vector<boost::shared_ptr<Iterator> >* iters)
+                : _opts(opts)
+                , _settings(settings)
+                , _iters(iters)
+                , _result(NULL)
+                , _failed(false)
+            {}
+
+            ~BackgroundSpiller() {
+                // only reached without finishInFlight() on error/early-destroy paths
+                if (_thread) {
+                    _thread->join();
+                    delete _result;
+                }
+            }
+
+            /** takes (swaps out) the contents of *data and writes them on the
+             *  background thread; data must already be sorted. */
+            void spill(Container* data) {
+                finishInFlight();
+                _data.swap(*data);
+                _thread.reset(new boost::thread(boost::bind(&BackgroundSpiller::_writeRun,
+                                                            this)));
+            }
+
+            /** waits for any in-flight write and collects its iterator into *_iters */
+            void finishInFlight() {
+                if (!_thread)
+                    return;
+
+                _thread->join();
+                _thread.reset();
+
+                if (_failed) {
+                    _failed = false;
+                    msgasserted(17490, _error);
+                }
+
+                verify(_result);
+                _iters->push_back(boost::shared_ptr<Iterator>(_result));
+                _result = NULL;
+            }
+
+            bool everSpilled() const { return _thread || !_iters->empty(); }
+
+        private:
+            void _writeRun() {
+                try {
+                    SortedFileWriter<Key, Value> writer(_opts, _settings);
+                    for (typename Container::const_iterator it = _data.begin();
+                         it != _data.end(); ++it) {
+                        writer.addAlreadySorted(it->first, it->second);
+                    }
+                    _result = writer.done();
+                    Container().swap(_data); // release the run's memory now
+                }
+                catch (const std::exception& e) {
+                    _error = e.what();
+                    _failed = true;
+                }
+            }
+
+            const SortOptions _opts;
+            const Settings _settings;
+            std::vector<boost::shared_ptr<Iterator> >* const _iters; // owner-thread only
+            Container _data; // the run being written; writer thread's while in flight
+            Iterator* _result;
+            bool _failed;
+            std::string _error;
+            boost::scoped_ptr<boost::thread> _thread;
+        };
+
         template <typename Key, typename Value, typename Comparator>
         class NoLimitSorter : public Sorter<Key, Value> {
         public:
@@ -397,6 +626,7 @@ namespace mongo {
                 , _settings(settings)
                 , _opts(opts)
                 , _memUsed(0)
+                , _spiller(opts, settings, &_iters)
             { verify(_opts.limit == 0); }
 
             void add(const Key& key, const Value& val) {
@@ -410,12 +640,13 @@ namespace mongo {
             }
 
             Iterator* done() {
-                if (_iters.empty()) {
+                if (!_spiller.everSpilled()) {
                     sort();
                     return new InMemIterator<Key, Value>(_data);
                 }
 
                 spill();
+                _spiller.finishInFlight();
                 return Iterator::merge(_iters, _opts, _comp);
             }
 
@@ -456,12 +687,8 @@ namespace mongo {
 
                 sort();
 
-                SortedFileWriter<Key, Value> writer(_opts, _settings);
-                for ( ; !_data.empty(); _data.pop_front()) {
-                    writer.addAlreadySorted(_data.front().first, _data.front().second);
-                }
-
-                _iters.push_back(boost::shared_ptr<Iterator>(writer.done()));
+                // written in the background; add() keeps filling the next run
+                _spiller.spill(&_data);
 
                 _memUsed = 0;
             }
@@ -472,6 +699,7 @@ namespace mongo {
             size_t _memUsed;
             std::deque<Data> _data; // the "current" data
             std::vector<boost::shared_ptr<Iterator> > _iters; // data that has already been spilled
+            BackgroundSpiller<Key, Value, std::deque<Data> > _spiller; // after _iters
         };
 
         template <typename Key, typename Value, typename Comparator>
@@ -536,6 +764,7 @@ namespace mongo {
                 , _settings(settings)
                 , _opts(opts)
                 , _memUsed(0)
+                , _spiller(opts, settings, &_iters)
                 , _haveCutoff(false)
                 , _worstCount(0)
                 , _medianCount(0)
@@ -595,12 +824,13 @@ namespace mongo {
             }
 
             Iterator* done() {
-                if (_iters.empty()) {
+                if (!_spiller.everSpilled()) {
                     sort();
                     return new InMemIterator<Key, Value>(_data);
                 }
 
                 spill();
+                _spiller.finishInFlight();
                 return Iterator::merge(_iters, _opts, _comp);
             }
 
@@ -722,15 +952,9 @@ namespace mongo {
                 sort();
                 updateCutoff();
 
-                SortedFileWriter<Key, Value> writer(_opts, _settings);
-                for (size_t i=0; i<_data.size(); i++) {
-                    writer.addAlreadySorted(_data[i].first, _data[i].second);
-                }
-
-                // clear _data and release backing array's memory
-                std::vector<Data>().swap(_data);
-
-                _iters.push_back(boost::shared_ptr<Iterator>(writer.done()));
+                // written in the background; add() keeps filling the next run.
+                // takes _data's contents, leaving it empty with no backing array.
+                _spiller.spill(&_data);
 
                 _memUsed = 0;
             }
@@ -741,6 +965,7 @@ namespace mongo {
             size_t _memUsed;
             std::vector<Data> _data; // the "current" data. Organized as max-heap if size == limit.
             std::vector<boost::shared_ptr<Iterator> > _iters; // data that has already been spilled
+            BackgroundSpiller<Key, Value, std::vector<Data> > _spiller; // after _iters
 
             // See updateCutoff() for a full description of how these members are used.
             bool _haveCutoff;
@@ -816,16 +1041,27 @@ namespace mongo {
         snappy::Compress(_buffer.buf(), _buffer.len(), &compressed);
         verify(compressed.size() <= size_t(std::numeric_limits<int32_t>::max()));
 
+        // frame layout: int32 size (negative means compressed), uint32 checksum
+        // of the payload's on-disk bytes, then the payload
+        const char* payload;
+        size_t payloadLen;
+        int32_t size;
+        if (compressed.size() < size_t(_buffer.len()/10*9)) {
+            payload = compressed.data();
+            payloadLen = compressed.size();
+            size = -int32_t(payloadLen); // negative means compressed
+        } else {
+            payload = _buffer.buf();
+            payloadLen = _buffer.len();
+            size = payloadLen;
+        }
+
+        const uint32_t checksum = sorter::blockChecksum(payload, payloadLen);
+
         try {
-            if (compressed.size() < size_t(_buffer.len()/10*9)) {
-                const int32_t size = -int32_t(compressed.size()); // negative means compressed
-                _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-                _file.write(compressed.data(), compressed.size());
-            } else {
-                const int32_t size = _buffer.len();
-                _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
-                _file.write(_buffer.buf(), _buffer.len());
-            }
+            _file.write(reinterpret_cast<const char*>(&size), sizeof(size));
+            _file.write(reinterpret_cast<const char*>(&checksum), sizeof(checksum));
+            _file.write(payload, payloadLen);
         } catch (const std::exception&) {
             msgasserted(16821, str::stream() << "error writing to file \"" << _fileName << "\": "
                                              << sorter::myErrnoWithDescription());
@@ -0,0 +1,94 @@
+// index_usage.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/stats/index_usage.h"
+
+#include "mongo/db/commands/server_status.h"
+
+namespace mongo {
+
+    IndexUsageTracker::IndexUsageTracker()
+        : _mutex( "IndexUsageTracker" ) {
+    }
+
+    IndexUsageTracker::StatsPtr IndexUsageTracker::get( const std::string& indexNamespace ) {
+        scoped_lock lk( _mutex );
+        StatsPtr& stats = _stats[indexNamespace];
+        if ( !stats )
+            stats.reset( new Stats() );
+        return stats;
+    }
+
+    void IndexUsageTracker::erase( const std::string& indexNamespace ) {
+        scoped_lock lk( _mutex );
+        _stats.erase( indexNamespace );
+    }
+
+    void IndexUsageTracker::append( BSONObjBuilder& b ) const {
+        // copy the map so the counters are read outside the mutex
+        StatsMap stats;
+        {
+            scoped_lock lk( _mutex );
+            stats = _stats;
+        }
+
+        for ( StatsMap::const_iterator i = stats.begin(); i != stats.end(); ++i ) {
+            long long accesses = i->second->accesses.get();
+            if ( accesses == 0 )
+                continue;
+            BSONObjBuilder sub( b.subobjStart( i->first ) );
+            sub.appendNumber( "accesses", accesses );
+            sub.appendNumber( "keysExamined", i->second->keysExamined.get() );
+            sub.appendNumber( "docsFetched", i->second->docsFetched.get() );
+            sub.done();
+        }
+    }
+
+    namespace {
+
+        class IndexUsageServerStatusSection : public ServerStatusSection {
+        public:
+            IndexUsageServerStatusSection() : ServerStatusSection( "indexUsage" ) {}
+            virtual bool includeByDefault() const { return false; }
+
+            virtual BSONObj generateSection( const BSONElement& configElement ) const {
+                BSONObjBuilder b;
+                indexUsageTracker.append( b );
+                return b.obj();
+            }
+        } indexUsageServerStatusSection;
+
+    }
+
+    IndexUsageTracker indexUsageTracker;
+
+}
@@ -0,0 +1,84 @@
+// index_usage.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#pragma once
+
+#include <map>
+#include <string>
+
+#include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
+
+#include "mongo/db/jsobj.h"
+#include "mongo/util/concurrency/mutex.h"
+#include "mongo/util/concurrency/striped_counter.h"
+
+namespace mongo {
+
+    /**
+     * Always-on usage counters for every open index, keyed by the index namespace
+     * (e.g. "test.foo.$a_1").  Scans tally locally and flush their totals here when
+     * they finish, so there is no per-key cost on the read path; the counters
+     * themselves are striped, so the flushes don't contend either.  Readers see the
+     * numbers in the 'indexUsage' serverStatus section (off by default) and can use
+     * an index with zero accesses over a long uptime as evidence that it is dead.
+     */
+    class IndexUsageTracker : boost::noncopyable {
+    public:
+        struct Stats : boost::noncopyable {
+            StripedCounter accesses;      // scans run against the index
+            StripedCounter keysExamined;  // keys those scans inspected
+            StripedCounter docsFetched;   // documents those scans handed up
+        };
+
+        typedef boost::shared_ptr<Stats> StatsPtr;
+
+        IndexUsageTracker();
+
+        /** returns the stats for 'indexNamespace', creating them on first use */
+        StatsPtr get( const std::string& indexNamespace );
+
+        /** forgets the stats for a dropped index, so a recreated index starts at zero */
+        void erase( const std::string& indexNamespace );
+
+        /** one subobject per index that has been accessed at least once */
+        void append( BSONObjBuilder& b ) const;
+
+    private:
+        typedef std::map<std::string, StatsPtr> StatsMap;
+
+        // guards the map only; the counters are updated without it
+        mutable mongo::mutex _mutex;
+        StatsMap _stats;
+    };
+
+    extern IndexUsageTracker indexUsageTracker;
+
+}
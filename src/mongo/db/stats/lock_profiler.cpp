@@ -0,0 +1,210 @@
+// lock_profiler.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/stats/lock_profiler.h"
+
+#include <sstream>
+
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/threadlocal.h"
+#include "mongo/util/stacktrace.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    // capture a stack sample (into the serverStatus lockProfile section) for
+    // lock waits longer than lockProfilingSlowWaitMicros
+    MONGO_EXPORT_SERVER_PARAMETER(lockProfilingSampleStacks, bool, false);
+    MONGO_EXPORT_SERVER_PARAMETER(lockProfilingSlowWaitMicros, int, 10000);
+
+    namespace lockprofiler {
+
+        namespace {
+
+            const int NumTypes = 4;    // R W r w -- same mapping LockStat uses
+            const int NumBuckets = 20; // log2 buckets, <=1us .. >=256ms
+            const int NumStripes = 8;
+
+            int typeNo( char type ) {
+                switch( type ) {
+                case 'R': return 0;
+                case 'W': return 1;
+                case 'r': return 2;
+                case 'w': return 3;
+                }
+                return -1;
+            }
+
+            const char* typeLabel( int no ) {
+                static const char* labels[] = { "R", "W", "r", "w" };
+                return labels[no];
+            }
+
+            int bucketNo( long long micros ) {
+                int b = 0;
+                while ( micros > 1 && b < NumBuckets - 1 ) {
+                    micros >>= 1;
+                    b++;
+                }
+                return b;
+            }
+
+            // the same exponential layout a util/histogram.h Histogram would hold,
+            // but as per-core striped atomic counters: Histogram::insert is not
+            // thread safe and this runs on every lock acquisition
+            AtomicInt64 buckets[NumStripes][NumTypes][NumBuckets];
+            AtomicInt64 waits[NumStripes][NumTypes];
+            AtomicInt64 waitMicros[NumStripes][NumTypes];
+
+            AtomicUInt32 nextStripe;
+            ThreadLocalValue<unsigned> myStripe;  // 1-based; 0 = unassigned
+
+            unsigned stripeNo() {
+                unsigned ix = myStripe.get();
+                if ( ix == 0 ) {
+                    ix = nextStripe.fetchAndAdd(1) % NumStripes + 1;
+                    myStripe.set( ix );
+                }
+                return ix - 1;
+            }
+
+            // ring of recent slow-wait stack samples
+            const int NumSamples = 8;
+            struct Sample {
+                Sample() : type(0), micros(0), when(0) { }
+                char type;
+                long long micros;
+                unsigned long long when;  // curTimeMillis64 at capture
+                string ns;
+                string stack;
+            };
+            SimpleMutex sampleMutex("lockProfilerSamples");
+            Sample samples[NumSamples];
+            int nextSample = 0;
+            long long samplesTaken = 0;
+
+            void sampleStack( char type, long long micros ) {
+                std::ostringstream ss;
+                printStackTrace( ss );
+
+                Sample s;
+                s.type = type;
+                s.micros = micros;
+                s.when = curTimeMillis64();
+                if ( haveClient() && cc().getContext() )
+                    s.ns = cc().getContext()->ns();
+                s.stack = ss.str();
+
+                SimpleMutex::scoped_lock lk( sampleMutex );
+                samples[nextSample] = s;
+                nextSample = ( nextSample + 1 ) % NumSamples;
+                samplesTaken++;
+            }
+
+            class LockProfileServerStatus : public ServerStatusSection {
+            public:
+                LockProfileServerStatus() : ServerStatusSection( "lockProfile" ) {}
+                virtual bool includeByDefault() const { return false; }
+
+                virtual BSONObj generateSection( const BSONElement& configElement ) const {
+                    BSONObjBuilder b;
+                    for ( int t = 0; t < NumTypes; t++ ) {
+                        long long n = 0;
+                        long long micros = 0;
+                        for ( int s = 0; s < NumStripes; s++ ) {
+                            n += waits[s][t].load();
+                            micros += waitMicros[s][t].load();
+                        }
+                        if ( n == 0 )
+                            continue;
+                        BSONObjBuilder tb( b.subobjStart( typeLabel( t ) ) );
+                        tb.appendNumber( "acquires", n );
+                        tb.appendNumber( "totalWaitMicros", micros );
+                        BSONObjBuilder hb( tb.subobjStart( "waitMicrosHistogram" ) );
+                        long long boundary = 1;
+                        for ( int i = 0; i < NumBuckets; i++, boundary <<= 1 ) {
+                            long long c = 0;
+                            for ( int s = 0; s < NumStripes; s++ )
+                                c += buckets[s][t][i].load();
+                            if ( c )
+                                hb.appendNumber( mongoutils::str::stream() << boundary, c );
+                        }
+                        hb.done();
+                        tb.done();
+                    }
+
+                    if ( lockProfilingSampleStacks ) {
+                        SimpleMutex::scoped_lock lk( sampleMutex );
+                        b.appendNumber( "slowWaitSamples", samplesTaken );
+                        BSONArrayBuilder ab( b.subarrayStart( "samples" ) );
+                        for ( int i = 0; i < NumSamples; i++ ) {
+                            // oldest first
+                            const Sample& s = samples[( nextSample + i ) % NumSamples];
+                            if ( s.when == 0 )
+                                continue;
+                            BSONObjBuilder sb( ab.subobjStart() );
+                            sb.append( "type", string( 1, s.type ) );
+                            sb.appendNumber( "waitMicros", s.micros );
+                            sb.appendDate( "ts", Date_t( s.when ) );
+                            if ( !s.ns.empty() )
+                                sb.append( "ns", s.ns );
+                            sb.append( "stack", s.stack );
+                            sb.done();
+                        }
+                        ab.done();
+                    }
+                    return b.obj();
+                }
+            } lockProfileServerStatus;
+
+        }  // namespace
+
+        void recordWait( char type, long long micros ) {
+            const int t = typeNo( type );
+            if ( t < 0 )
+                return;
+            const unsigned s = stripeNo();
+            buckets[s][t][bucketNo( micros )].fetchAndAdd( 1 );
+            waits[s][t].fetchAndAdd( 1 );
+            waitMicros[s][t].fetchAndAdd( micros );
+
+            if ( lockProfilingSampleStacks && micros >= lockProfilingSlowWaitMicros )
+                sampleStack( type, micros );
+        }
+
+    }  // namespace lockprofiler
+
+}  // namespace mongo
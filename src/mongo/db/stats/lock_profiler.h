@@ -0,0 +1,53 @@
+// lock_profiler.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+namespace mongo {
+
+    /**
+     * Low-overhead lock contention profiler, fed by LockStat on every lock
+     * acquisition.  Keeps per-core striped log2 wait-time histograms per lock
+     * type ('R'/'W'/'r'/'w'), and -- behind lockProfilingSampleStacks -- a small
+     * ring of stack samples with the active namespace for waits longer than
+     * lockProfilingSlowWaitMicros.  Everything is surfaced in the 'lockProfile'
+     * serverStatus section, so when the global lock saturates the histogram says
+     * how bad the waits are and the samples say who is doing the waiting.
+     */
+    namespace lockprofiler {
+
+        /** record one lock acquisition wait.  an atomic add into the calling
+            core's histogram stripe; stack capture only on slow waits when the
+            sampling flag is on. */
+        void recordWait( char type, long long micros );
+
+    }  // namespace lockprofiler
+
+}  // namespace mongo
@@ -0,0 +1,147 @@
+// metrics_ring.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/stats/metrics_ring.h"
+
+#include <cstring>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/authorization_manager.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/d_concurrency.h"
+#include "mongo/db/dur_stats.h"
+#include "mongo/db/lockstat.h"
+#include "mongo/db/stats/counters.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    MetricsRing::MetricsRing() : _seq( 0 ) {
+        memset( _slots, 0, sizeof( _slots ) ); // Sample is POD
+    }
+
+    void MetricsRing::sample() {
+        const long long s = _seq.load() + 1;
+        Sample& slot = _slots[s % NumSlots];
+
+        slot.timeMicros = curTimeMicros64();
+
+        slot.insert  = globalOpCounters.getInsert();
+        slot.query   = globalOpCounters.getQuery();
+        slot.update  = globalOpCounters.getUpdate();
+        slot.del     = globalOpCounters.getDelete();
+        slot.getmore = globalOpCounters.getGetMore();
+        slot.command = globalOpCounters.getCommand();
+
+        slot.netBytesIn  = networkCounter.getBytesIn();
+        slot.netBytesOut = networkCounter.getBytesOut();
+        slot.netRequests = networkCounter.getRequests();
+
+        LockStat* ls = Lock::globalLockStat();
+        slot.lockTimeReadMicros  = ls->getTimeLocked( 'R' );
+        slot.lockTimeWriteMicros = ls->getTimeLocked( 'W' );
+
+        slot.journalCommits = dur::stats.curr->_commits;
+        slot.journaledBytes = dur::stats.curr->_journaledBytes;
+
+        // publish only once the slot is fully written; readers never look at
+        // the slot a not-yet-published sequence number maps to
+        _seq.store( s );
+    }
+
+    void MetricsRing::append( BSONObjBuilder& result, unsigned long long afterMicros ) const {
+        const long long last = _seq.load();
+
+        // sample last+1 will overwrite slot (last+1) % NumSlots, possibly
+        // while we read - so the oldest retained sample is off limits
+        long long first = last - ( NumSlots - 2 );
+        if ( first < 1 )
+            first = 1;
+
+        BSONArrayBuilder arr( result.subarrayStart( "samples" ) );
+        for ( long long s = first; s <= last; s++ ) {
+            const Sample& slot = _slots[s % NumSlots];
+            if ( slot.timeMicros <= afterMicros )
+                continue;
+
+            BSONObjBuilder b( arr.subobjStart() );
+            b.append( "ts", static_cast<long long>( slot.timeMicros ) );
+            b.append( "insert", slot.insert );
+            b.append( "query", slot.query );
+            b.append( "update", slot.update );
+            b.append( "delete", slot.del );
+            b.append( "getmore", slot.getmore );
+            b.append( "command", slot.command );
+            b.append( "netIn", slot.netBytesIn );
+            b.append( "netOut", slot.netBytesOut );
+            b.append( "netRequests", slot.netRequests );
+            b.append( "timeLockedR", slot.lockTimeReadMicros );
+            b.append( "timeLockedW", slot.lockTimeWriteMicros );
+            b.append( "journalCommits", static_cast<long long>( slot.journalCommits ) );
+            b.append( "journaledBytes", static_cast<long long>( slot.journaledBytes ) );
+            b.done();
+        }
+        arr.done();
+    }
+
+    class GetMetricsCmd : public Command {
+    public:
+        GetMetricsCmd() : Command( "getMetrics" ) {}
+
+        virtual bool slaveOk() const { return true; }
+        virtual bool adminOnly() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+        virtual void help( stringstream& help ) const {
+            help << "{ getMetrics : 1, after : <micros> } per-second metric samples for scrapers; "
+                 << "counters are cumulative, journal fields are current-interval gauges";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::serverStatus);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        virtual bool run(const string& , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl) {
+            unsigned long long after = 0;
+            if ( cmdObj["after"].isNumber() )
+                after = static_cast<unsigned long long>( cmdObj["after"].numberLong() );
+            metricsRing.append( result, after );
+            return true;
+        }
+
+    } getMetricsCmd;
+
+    MetricsRing metricsRing;
+}
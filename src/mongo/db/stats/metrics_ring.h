@@ -0,0 +1,87 @@
+// metrics_ring.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <boost/noncopyable.hpp>
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * lock-free ring of per-second metric samples for external scraping.
+     *
+     * a single writer (the snapshot thread) appends one sample per second and
+     * publishes it by bumping a sequence number; readers (the getMetrics
+     * command) walk the published range without any lock, staying clear of
+     * the one slot the writer may be filling.  samples hold cumulative
+     * counters, so a scraper diffs adjacent samples and sees every
+     * sub-interval spike even when it polls slowly -- and reading the ring
+     * takes no locks at all, unlike assembling a serverStatus.
+     */
+    class MetricsRing : boost::noncopyable {
+    public:
+        struct Sample {
+            unsigned long long timeMicros;
+
+            // cumulative since process start
+            long long insert, query, update, del, getmore, command; // opcounters
+            long long netBytesIn, netBytesOut, netRequests;
+            long long lockTimeReadMicros, lockTimeWriteMicros;      // global lock
+
+            // journal activity in the current dur-stats interval (dur::stats
+            // rotates every few seconds, so these are gauges, not cumulative)
+            unsigned journalCommits;
+            unsigned long long journaledBytes;
+        };
+
+        MetricsRing();
+
+        /** take one sample; the snapshot thread is the only caller */
+        void sample();
+
+        /**
+         * appends every retained sample with timeMicros > afterMicros as an
+         * array under "samples", oldest first
+         */
+        void append( BSONObjBuilder& result, unsigned long long afterMicros ) const;
+
+        enum { NumSlots = 256 }; // a bit over 4 minutes of seconds
+
+    private:
+        Sample _slots[NumSlots];
+        AtomicInt64 _seq; // samples ever written; sample s lives in slot s % NumSlots
+    };
+
+    extern MetricsRing metricsRing;
+}
@@ -0,0 +1,76 @@
+// numa_server_status.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/numa.h"
+
+namespace mongo {
+namespace {
+
+    // opt-in: data file mappings get MPOL_INTERLEAVE across all nodes when
+    // this is set at startup; see util/numa.cpp
+    ExportedServerParameter<bool> NumaInterleaveMappingsSetting( ServerParameterSet::getGlobal(),
+                                                                 "numaInterleaveMappings",
+                                                                 &numaInterleaveMappings,
+                                                                 true, false );
+
+    class NumaServerStatusSection : public ServerStatusSection {
+    public:
+        NumaServerStatusSection() : ServerStatusSection( "numa" ) {}
+        virtual bool includeByDefault() const { return false; }
+
+        virtual BSONObj generateSection( const BSONElement& configElement ) const {
+            BSONObjBuilder b;
+            b.append( "numNodes", numaNodeCount() );
+            b.appendBool( "interleaveMappings", numaInterleaveMappings );
+            b.appendNumber( "regionsInterleaved", numaRegionsInterleaved() );
+            b.appendNumber( "bytesInterleaved",
+                            static_cast<long long>( numaBytesInterleaved() ) );
+
+            // residency per node shows placement skew; walks /proc/self/numa_maps
+            // which is why this section is not on by default
+            std::map<int, long long> pages;
+            numaPerNodePages( &pages );
+            BSONObjBuilder perNode( b.subobjStart( "pagesPerNode" ) );
+            for ( std::map<int, long long>::const_iterator i = pages.begin();
+                  i != pages.end(); ++i ) {
+                string field = str::stream() << "node" << i->first;
+                perNode.appendNumber( field, i->second );
+            }
+            perNode.done();
+
+            return b.obj();
+        }
+    } numaServerStatusSection;
+}
+}
@@ -0,0 +1,144 @@
+// op_latency.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/stats/op_latency.h"
+
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/jsobj.h"
+#include "mongo/util/concurrency/threadlocal.h"
+#include "mongo/util/net/message.h"
+
+namespace mongo {
+
+    namespace {
+        // process-wide thread -> stripe assignment; one stripe of the
+        // histograms per thread, same scheme as LockStat
+        AtomicUInt32 nextOpLatencyStripe;
+        ThreadLocalValue<unsigned> opLatencyStripe;  // 1-based; 0 = unassigned
+
+        const char* opTypeNames[] = {
+            "insert" , "query" , "update" , "delete" , "getmore" , "command" , "other"
+        };
+    }
+
+    unsigned OpLatencyStats::_myStripe() {
+        unsigned ix = opLatencyStripe.get();
+        if ( ix == 0 ) {
+            ix = nextOpLatencyStripe.fetchAndAdd(1) % Stripes + 1;
+            opLatencyStripe.set( ix );
+        }
+        return ix - 1;
+    }
+
+    int OpLatencyStats::_opTypeFor( int op , bool command ) {
+        switch ( op ) {
+        case dbInsert:  return Insert;
+        case dbQuery:   return command ? Command : Query;
+        case dbUpdate:  return Update;
+        case dbDelete:  return Delete;
+        case dbGetMore: return GetMore;
+        default:        return Other;
+        }
+    }
+
+    int OpLatencyStats::_bucketFor( long long micros ) {
+        // bucket i holds values <= 1<<i micros, so b = ceil(log2(micros))
+        int b = 0;
+        long long v = micros - 1;
+        while ( v > 0 && b < NumBuckets - 1 ) {
+            v >>= 1;
+            b++;
+        }
+        return b;
+    }
+
+    void OpLatencyStats::record( int op , bool command , long long micros ) {
+        const int type = _opTypeFor( op , command );
+        Stripe& s = _stripes[_myStripe()];
+        s.counts[type][_bucketFor( micros )].fetchAndAdd( 1 );
+        s.totalMicros[type].fetchAndAdd( micros );
+    }
+
+    void OpLatencyStats::append( BSONObjBuilder& b ) const {
+        for ( int type = 0; type < NumOpTypes; type++ ) {
+            BSONObjBuilder sub( b.subobjStart( opTypeNames[type] ) );
+
+            long long count = 0;
+            long long buckets[NumBuckets];
+            for ( int i = 0; i < NumBuckets; i++ ) {
+                buckets[i] = 0;
+                for ( int s = 0; s < Stripes; s++ )
+                    buckets[i] += _stripes[s].counts[type][i].load();
+                count += buckets[i];
+            }
+
+            long long totalMicros = 0;
+            for ( int s = 0; s < Stripes; s++ )
+                totalMicros += _stripes[s].totalMicros[type].load();
+
+            BSONArrayBuilder arr( sub.subarrayStart( "histogram" ) );
+            for ( int i = 0; i < NumBuckets; i++ ) {
+                if ( buckets[i] == 0 )
+                    continue;
+                BSONObjBuilder bucket;
+                bucket.appendNumber( "micros" , 1LL << i ); // inclusive upper bound
+                bucket.appendNumber( "count" , buckets[i] );
+                arr.append( bucket.obj() );
+            }
+            arr.done();
+
+            sub.appendNumber( "count" , count );
+            sub.appendNumber( "totalMicros" , totalMicros );
+            sub.done();
+        }
+    }
+
+    namespace {
+
+        class OpLatenciesServerStatusSection : public ServerStatusSection {
+        public:
+            OpLatenciesServerStatusSection() : ServerStatusSection( "opLatencies" ) {}
+            virtual bool includeByDefault() const { return false; }
+
+            virtual BSONObj generateSection( const BSONElement& configElement ) const {
+                BSONObjBuilder b;
+                b.append( "note" , "all times in microseconds" );
+                OpLatencyStats::global.append( b );
+                return b.obj();
+            }
+        } opLatenciesServerStatusSection;
+
+    }
+
+    OpLatencyStats OpLatencyStats::global;
+
+}
@@ -0,0 +1,84 @@
+// op_latency.h : per-opcode latency histograms
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#pragma once
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * log2-bucketed latency histograms, one per operation type, recorded for
+     * every completed operation.  recording is one atomic add into a
+     * per-thread stripe (same scheme LockStat uses), so it is lock-free and
+     * cheap enough to be always on; stripes are summed when the opLatencies
+     * serverStatus section is generated.  answers "did update p99 regress"
+     * without external proxies.
+     */
+    class OpLatencyStats {
+    public:
+        enum OpType {
+            Insert = 0,
+            Query,
+            Update,
+            Delete,
+            GetMore,
+            Command,
+            Other,
+            NumOpTypes
+        };
+
+        // log2 buckets: <=1us, <=2us, ... , >=256ms
+        enum { NumBuckets = 20 };
+
+        /** record a completed operation; opcode as in dbInsert et al */
+        void record( int op , bool command , long long micros );
+
+        /** one subobject per op type, nonzero buckets only */
+        void append( BSONObjBuilder& b ) const;
+
+        static OpLatencyStats global;
+
+    private:
+        enum { Stripes = 8 };
+        struct Stripe {
+            AtomicInt64 counts[NumOpTypes][NumBuckets];
+            AtomicInt64 totalMicros[NumOpTypes];
+        };
+        Stripe _stripes[Stripes];
+
+        static unsigned _myStripe();
+        static int _opTypeFor( int op , bool command );
+        static int _bucketFor( long long micros );
+    };
+
+}
@@ -0,0 +1,146 @@
+// op_sampler.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/stats/op_sampler.h"
+
+#include <cstring>
+
+#include "mongo/db/auth/action_set.h"
+#include "mongo/db/auth/action_type.h"
+#include "mongo/db/auth/privilege.h"
+#include "mongo/db/commands.h"
+#include "mongo/db/curop.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/net/message.h"
+#include "mongo/util/time_support.h"
+
+namespace mongo {
+
+    // sample every Nth completed operation; 0 turns sampling off
+    MONGO_EXPORT_SERVER_PARAMETER(opSampleRate, int, 100);
+
+    void OpSampler::recordOp( CurOp& curop , const OpDebug& debug ) {
+        const int rate = opSampleRate;
+        if ( rate <= 0 )
+            return;
+        if ( _ticket.fetchAndAdd( 1 ) % static_cast<unsigned>( rate ) != 0 )
+            return;
+
+        Slot& s = _slots[ _next.fetchAndAdd( 1 ) % NumSlots ];
+        s.seq.fetchAndAdd( 1 ); // odd: readers stand back
+
+        s.ts = static_cast<long long>( curTimeMicros64() );
+        s.micros = static_cast<long long>( curop.totalTimeMicros() );
+        const LockStat& ls = curop.lockStat();
+        s.lockWaitMicros =
+            ls.getTimeAcquiring( 'R' ) + ls.getTimeAcquiring( 'W' ) +
+            ls.getTimeAcquiring( 'r' ) + ls.getTimeAcquiring( 'w' );
+        s.op = curop.getOp();
+        s.responseLength = debug.responseLength;
+        strncpy( s.ns , curop.getNS() , MaxNs - 1 );
+        s.ns[ MaxNs - 1 ] = 0;
+
+        s.seq.fetchAndAdd( 1 ); // even: slot is stable again
+    }
+
+    void OpSampler::append( BSONObjBuilder& b , int max ) {
+        if ( max <= 0 || max > NumSlots )
+            max = NumSlots;
+
+        // _next is one past the most recently claimed slot, so walking
+        // forward from it visits slots oldest first
+        const unsigned start = _next.load();
+
+        vector<BSONObj> docs;
+        for ( int i = 0; i < NumSlots; i++ ) {
+            Slot& s = _slots[ ( start + i ) % NumSlots ];
+
+            const unsigned seqBefore = s.seq.load();
+            if ( seqBefore & 1 )
+                continue; // being written
+            if ( s.ts == 0 )
+                continue; // never used
+
+            BSONObjBuilder doc;
+            doc.appendDate( "ts" , Date_t( s.ts / 1000 ) );
+            doc.append( "ns" , s.ns );
+            doc.append( "op" , opToString( s.op ) );
+            doc.appendNumber( "micros" , s.micros );
+            doc.appendNumber( "lockWaitMicros" , s.lockWaitMicros );
+            doc.append( "responseLength" , s.responseLength );
+
+            if ( s.seq.load() != seqBefore )
+                continue; // a writer got in; discard the torn copy
+
+            docs.push_back( doc.obj() );
+        }
+
+        BSONArrayBuilder arr( b.subarrayStart( "samples" ) );
+        size_t first = docs.size() > static_cast<size_t>( max ) ? docs.size() - max : 0;
+        for ( size_t i = first; i < docs.size(); i++ )
+            arr.append( docs[i] );
+        arr.done();
+    }
+
+    class OpSamplesCmd : public Command {
+    public:
+        OpSamplesCmd() : Command( "opSamples", true ) {}
+
+        virtual bool slaveOk() const { return true; }
+        virtual bool adminOnly() const { return true; }
+        virtual LockType locktype() const { return NONE; }
+        virtual void help( stringstream& help ) const {
+            help << "returns recent sampled operations from the in-memory ring buffer. "
+                 << "options: { count: <max samples to return> }. "
+                 << "sampling interval is the opSampleRate server parameter.";
+        }
+        virtual void addRequiredPrivileges(const std::string& dbname,
+                                           const BSONObj& cmdObj,
+                                           std::vector<Privilege>* out) {
+            ActionSet actions;
+            actions.addAction(ActionType::serverStatus);
+            out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+        }
+        virtual bool run(const string& , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool fromRepl) {
+            int count = 0;
+            if ( cmdObj["count"].isNumber() )
+                count = cmdObj["count"].numberInt();
+            result.append( "note" , "all times in microseconds" );
+            OpSampler::global.append( result , count );
+            return true;
+        }
+
+    } opSamplesCmd;
+
+    OpSampler OpSampler::global;
+
+}
@@ -0,0 +1,83 @@
+// op_sampler.h : sampling profiler over completed operations
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#pragma once
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+    class CurOp;
+    class OpDebug;
+
+    /**
+     * always-on sampling profiler: every Nth completed operation is copied,
+     * as a compact fixed-size record, into a lock-free ring buffer.  cheap
+     * enough to leave on in production (one atomic add per op when not
+     * sampling); the buffer is read via the opSamples command.
+     *
+     * the sampling interval is the opSampleRate server parameter
+     * (default 100; 0 disables sampling entirely).
+     */
+    class OpSampler {
+    public:
+        enum { NumSlots = 4096, MaxNs = 100 };
+
+        /** called once per completed operation; non-sampled ops pay one
+            atomic add.  lock-free. */
+        void recordOp( CurOp& curop , const OpDebug& debug );
+
+        /** append the most recent samples (up to max) to b, oldest first */
+        void append( BSONObjBuilder& b , int max );
+
+        static OpSampler global;
+
+    private:
+        /** each slot is a seqlock: seq is odd while a writer is filling it,
+            and readers discard a slot whose seq moved under them.  two
+            writers land on the same slot only a full buffer wrap apart, so a
+            rare mangled sample is possible and acceptable for a sampler. */
+        struct Slot {
+            AtomicUInt32 seq;
+            long long ts;             // completion time, micros since epoch
+            long long micros;         // total execution time
+            long long lockWaitMicros; // time spent acquiring locks
+            int op;                   // opcode (dbQuery, dbUpdate, ...)
+            int responseLength;
+            char ns[MaxNs];
+        };
+
+        AtomicUInt32 _ticket; // sampling: every Nth op wins
+        AtomicUInt32 _next;   // next slot to claim
+        Slot _slots[NumSlots];
+    };
+
+}
@@ -34,6 +34,7 @@
 
 #include "mongo/db/client.h"
 #include "mongo/db/clientcursor.h"
+#include "mongo/db/stats/metrics_ring.h"
 
 /**
    handles snapshotting performance metrics and other such things
@@ -125,22 +126,27 @@ namespace mongo {
 
         while ( ! inShutdown() ) {
             try {
-                const SnapshotData* s = statsSnapshots.takeSnapshot();
+                metricsRing.sample();
 
-                if (prev && serverGlobalParams.cpu) {
-                    unsigned long long elapsed = s->_created - prev->_created;
-                    SnapshotDelta d( *prev , *s );
-                    log() << "cpu: elapsed:" << (elapsed/1000) <<"  writelock: " << (int)(100*d.percentWriteLocked()) << "%" << endl;
-                }
+                // the heavier Top snapshot keeps its historical 4 second cadence
+                if ( numLoops % 4 == 0 ) {
+                    const SnapshotData* s = statsSnapshots.takeSnapshot();
+
+                    if (prev && serverGlobalParams.cpu) {
+                        unsigned long long elapsed = s->_created - prev->_created;
+                        SnapshotDelta d( *prev , *s );
+                        log() << "cpu: elapsed:" << (elapsed/1000) <<"  writelock: " << (int)(100*d.percentWriteLocked()) << "%" << endl;
+                    }
 
-                prev = s;
+                    prev = s;
+                }
             }
             catch ( std::exception& e ) {
                 log() << "ERROR in SnapshotThread: " << e.what() << endl;
             }
 
             numLoops++;
-            sleepsecs(4);
+            sleepsecs(1);
         }
 
         client.shutdown();
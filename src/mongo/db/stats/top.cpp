@@ -32,15 +32,97 @@
 
 #include "mongo/db/stats/top.h"
 
+#include <boost/shared_ptr.hpp>
+
 #include "mongo/db/auth/action_set.h"
+#include "mongo/platform/unordered_map.h"
 #include "mongo/db/auth/action_type.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/privilege.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/threadlocal.h"
 #include "mongo/util/net/message.h"
 #include "mongo/db/commands.h"
 
 namespace mongo {
 
+    /**
+     * per-thread buffer of usage deltas.
+     *
+     * the owning thread is the only one that modifies the map, so its hits
+     * need no lock: a find() plus atomic adds on the entry.  the buffer's
+     * lock is taken by the owner only when inserting a new namespace, and by
+     * flush() while it walks the entries - that keeps iteration and rehashing
+     * apart.  entries for dropped collections linger with zero counts (we
+     * can't erase them out from under the owner); drainInto() skips them.
+     */
+    class Top::UsageBuffer : boost::noncopyable {
+    public:
+        UsageBuffer() : _lock("Top::UsageBuffer") {
+            Top::global._registerBuffer( this );
+        }
+
+        ~UsageBuffer() {
+            Top::global._retireBuffer( this );
+        }
+
+        void record( const InternedNamespace& ns , int op , int lockType , long long micros , bool command ) {
+            if ( ( command || op == dbQuery ) && ns.ns() == _lastDropped ) {
+                _lastDropped.clear();
+                return;
+            }
+
+            CollectionDelta* coll;
+            DeltaMap::const_iterator it = _deltas.find( ns );
+            if ( it != _deltas.end() ) {
+                coll = it->second.get();
+            }
+            else {
+                SimpleMutex::scoped_lock lk( _lock );
+                boost::shared_ptr<CollectionDelta>& slot = _deltas[ns];
+                slot.reset( new CollectionDelta() );
+                coll = slot.get();
+            }
+
+            coll->inc( op , lockType , micros , command );
+            _global.inc( op , lockType , micros , command );
+        }
+
+        /** called by the drop path on the dropping thread: the drop command's
+            own completion will record against the dead ns right after us */
+        void noteDropped( const StringData& ns ) {
+            _lastDropped = ns.toString();
+        }
+
+        /** move all buffered counts into the global map; caller holds Top::_lock */
+        void drainInto( UsageMap& usage , CollectionData& global ) {
+            SimpleMutex::scoped_lock lk( _lock );
+            for ( DeltaMap::const_iterator i = _deltas.begin(); i != _deltas.end(); ++i ) {
+                CollectionDelta* d = i->second.get();
+                if ( d->total.count.load() == 0 )
+                    continue;
+                d->drainInto( usage[i->first.ns()] );
+            }
+            _global.drainInto( global );
+        }
+
+    private:
+        // keyed by interned id: the find() in record() uses the precomputed
+        // hash and a pointer compare, never the namespace string
+        typedef unordered_map< InternedNamespace,
+                               boost::shared_ptr<CollectionDelta>,
+                               InternedNamespace::Hasher,
+                               InternedNamespace::Equals > DeltaMap;
+
+        SimpleMutex _lock;
+        DeltaMap _deltas;
+        CollectionDelta _global;
+        string _lastDropped;
+    };
+
+    TSP_DECLARE(Top::UsageBuffer, topUsageBuffer)
+    TSP_DEFINE(Top::UsageBuffer, topUsageBuffer)
+
     Top::UsageData::UsageData( const UsageData& older , const UsageData& newer ) {
         // this won't be 100% accurate on rollovers and drop(), but at least it won't be negative
         time  = (newer.time  >= older.time)  ? (newer.time  - older.time)  : newer.time;
@@ -60,52 +142,44 @@ namespace mongo {
 
     }
 
-    void Top::record( const StringData& ns , int op , int lockType , long long micros , bool command ) {
-        if ( ns[0] == '?' )
+    void Top::record( const InternedNamespace& ns , int op , int lockType , long long micros , bool command ) {
+        const string& s = ns.ns();
+        if ( s.empty() || s[0] == '?' )
             return;
 
-        //cout << "record: " << ns << "\t" << op << "\t" << command << endl;
-        SimpleMutex::scoped_lock lk(_lock);
-
-        if ( ( command || op == dbQuery ) && ns == _lastDropped ) {
-            _lastDropped = "";
-            return;
-        }
-
-        CollectionData& coll = _usage[ns];
-        _record( coll , op , lockType , micros , command );
-        _record( _global , op , lockType , micros , command );
+        //cout << "record: " << s << "\t" << op << "\t" << command << endl;
+        _myBuffer()->record( ns , op , lockType , micros , command );
     }
 
-    void Top::_record( CollectionData& c , int op , int lockType , long long micros , bool command ) {
-        c.total.inc( micros );
+    void Top::CollectionDelta::inc( int op , int lockType , long long micros , bool command ) {
+        total.inc( micros );
 
         if ( lockType > 0 )
-            c.writeLock.inc( micros );
+            writeLock.inc( micros );
         else if ( lockType < 0 )
-            c.readLock.inc( micros );
+            readLock.inc( micros );
 
         switch ( op ) {
         case 0:
             // use 0 for unknown, non-specific
             break;
         case dbUpdate:
-            c.update.inc( micros );
+            update.inc( micros );
             break;
         case dbInsert:
-            c.insert.inc( micros );
+            insert.inc( micros );
             break;
         case dbQuery:
             if ( command )
-                c.commands.inc( micros );
+                commands.inc( micros );
             else
-                c.queries.inc( micros );
+                queries.inc( micros );
             break;
         case dbGetMore:
-            c.getmore.inc( micros );
+            getmore.inc( micros );
             break;
         case dbDelete:
-            c.remove.inc( micros );
+            remove.inc( micros );
             break;
         case dbKillCursors:
             break;
@@ -119,18 +193,72 @@ namespace mongo {
 
     }
 
+    void Top::CollectionDelta::drainInto( CollectionData& c ) {
+        total.drainInto( c.total );
+        readLock.drainInto( c.readLock );
+        writeLock.drainInto( c.writeLock );
+        queries.drainInto( c.queries );
+        getmore.drainInto( c.getmore );
+        insert.drainInto( c.insert );
+        update.drainInto( c.update );
+        remove.drainInto( c.remove );
+        commands.drainInto( c.commands );
+    }
+
+    Top::UsageBuffer* Top::_myBuffer() {
+        UsageBuffer* b = topUsageBuffer.get();
+        if ( !b ) {
+            // registers itself; freed (and retired) when the thread exits
+            b = new UsageBuffer();
+            topUsageBuffer.reset( b );
+        }
+        return b;
+    }
+
+    void Top::_registerBuffer( UsageBuffer* b ) {
+        SimpleMutex::scoped_lock lk( _buffersLock );
+        _buffers.insert( b );
+    }
+
+    void Top::_retireBuffer( UsageBuffer* b ) {
+        SimpleMutex::scoped_lock lkBuffers( _buffersLock );
+        _buffers.erase( b );
+        SimpleMutex::scoped_lock lk( _lock );
+        b->drainInto( _usage , _global );
+    }
+
+    void Top::flush() const {
+        SimpleMutex::scoped_lock lkBuffers( _buffersLock );
+        SimpleMutex::scoped_lock lk( _lock );
+        for ( std::set<UsageBuffer*>::const_iterator i = _buffers.begin(); i != _buffers.end(); ++i ) {
+            (*i)->drainInto( _usage , _global );
+        }
+    }
+
     void Top::collectionDropped( const StringData& ns ) {
-        SimpleMutex::scoped_lock lk(_lock);
-        _usage.erase(ns);
-        _lastDropped = ns.toString();
+        // pull buffered deltas in first so stragglers can't resurrect the entry
+        flush();
+        {
+            SimpleMutex::scoped_lock lk(_lock);
+            _usage.erase(ns);
+        }
+        _myBuffer()->noteDropped( ns );
     }
 
     void Top::cloneMap(Top::UsageMap& out) const {
+        flush();
         SimpleMutex::scoped_lock lk(_lock);
         out = _usage;
     }
 
+    Top::CollectionData Top::getGlobalData() const {
+        flush();
+        SimpleMutex::scoped_lock lk(_lock);
+        return _global;
+    }
+
     void Top::append( BSONObjBuilder& b ) {
+        flush();
         SimpleMutex::scoped_lock lk( _lock );
         _appendToUsageMap( b , _usage );
     }
@@ -200,6 +328,13 @@ namespace mongo {
 
     } topCmd;
 
+    /** bounds buffer staleness even when nothing is reading */
+    class TopFlushTask : public PeriodicTask {
+    public:
+        virtual string taskName() const { return "topFlush"; }
+        virtual void taskDoWork() { Top::global.flush(); }
+    } topFlushTask;
+
     Top Top::global;
 
 }
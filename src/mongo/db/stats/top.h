@@ -17,8 +17,12 @@
 
 #pragma once
 
+#include <set>
+
 #include <boost/date_time/posix_time/posix_time.hpp>
 
+#include "mongo/db/interned_namespace.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/string_map.h"
 
@@ -26,11 +30,16 @@ namespace mongo {
 
     /**
      * tracks usage by collection
+     *
+     * record() lands in a per-thread buffer; buffers are merged into the
+     * global map by flush(), which readers (the top command, snapshots) and a
+     * periodic background task invoke.  the hot record() path takes no lock
+     * and does no allocation once a thread has seen a namespace.
      */
     class Top {
 
     public:
-        Top() : _lock("Top") { }
+        Top() : _lock("Top") , _buffersLock("Top::buffers") { }
 
         struct UsageData {
             UsageData() : time(0) , count(0) {}
@@ -66,25 +75,75 @@ namespace mongo {
 
         typedef StringMap<CollectionData> UsageMap;
 
+        /** implementation detail of record(); defined in top.cpp */
+        class UsageBuffer;
+
     public:
-        void record( const StringData& ns , int op , int lockType , long long micros , bool command );
+        void record( const InternedNamespace& ns , int op , int lockType , long long micros , bool command );
         void append( BSONObjBuilder& b );
         void cloneMap(UsageMap& out) const;
-        CollectionData getGlobalData() const { return _global; }
+        CollectionData getGlobalData() const;
         void collectionDropped( const StringData& ns );
 
+        /** merge every thread's buffered deltas into the global map.
+            readers call this for an up-to-date view; a periodic task calls it
+            so buffers never go stale for long. */
+        void flush() const;
+
     public: // static stuff
         static Top global;
 
     private:
+        struct UsageDelta {
+            AtomicInt64 time;
+            AtomicInt64 count;
+
+            void inc( long long micros ) {
+                count.addAndFetch( 1 );
+                time.addAndFetch( micros );
+            }
+
+            /** move this delta's counts into d, zeroing the delta */
+            void drainInto( UsageData& d ) {
+                d.count += count.swap( 0 );
+                d.time += time.swap( 0 );
+            }
+        };
+
+        struct CollectionDelta {
+            void inc( int op , int lockType , long long micros , bool command );
+            void drainInto( CollectionData& c );
+
+            UsageDelta total;
+
+            UsageDelta readLock;
+            UsageDelta writeLock;
+
+            UsageDelta queries;
+            UsageDelta getmore;
+            UsageDelta insert;
+            UsageDelta update;
+            UsageDelta remove;
+            UsageDelta commands;
+        };
+
         void _appendToUsageMap( BSONObjBuilder& b , const UsageMap& map ) const;
         void _appendStatsEntry( BSONObjBuilder& b , const char * statsName , const UsageData& map ) const;
-        void _record( CollectionData& c , int op , int lockType , long long micros , bool command );
 
+        UsageBuffer* _myBuffer();
+        void _registerBuffer( UsageBuffer* b );
+        /** drain b a final time and forget it; called as its owning thread exits */
+        void _retireBuffer( UsageBuffer* b );
+
+        // guards _global and _usage
         mutable SimpleMutex _lock;
-        CollectionData _global;
-        UsageMap _usage;
-        string _lastDropped;
+        mutable CollectionData _global;
+        mutable UsageMap _usage;
+
+        // guards _buffers.  lock ordering: _buffersLock, then _lock, then a
+        // buffer's own lock - flush() walks all three levels.
+        mutable SimpleMutex _buffersLock;
+        std::set<UsageBuffer*> _buffers;
     };
 
 } // namespace mongo
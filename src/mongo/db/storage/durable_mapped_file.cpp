@@ -50,13 +50,36 @@ namespace mongo {
     void DurableMappedFile::remapThePrivateView() {
         verify(storageGlobalParams.dur);
 
+        const unsigned long long dirty = _dirtyRegions;
+        _dirtyRegions = 0;
+
+#if defined(_WIN32) || defined(__sunos__)
+        // these platforms cannot replace part of a view, so remap the whole thing.
         // todo 1.9 : it turns out we require that we always remap to the same address.
         // so the remove / add isn't necessary and can be removed?
         void *old = _view_private;
-        //privateViews.remove(_view_private);        
+        //privateViews.remove(_view_private);
         _view_private = remapPrivateView(_view_private);
         //privateViews.add(_view_private, this);
         fassert( 16112, _view_private == old );
+#else
+        // remap just the regions dirtied since the last remap, bounding the
+        // stop-the-world work to the recent write set instead of the whole file
+        for( unsigned r = 0; r < NRemapRegions; r++ ) {
+            if( !( dirty & ( 1ULL << r ) ) )
+                continue;
+            const unsigned long long ofs = r * RemapGranularityBytes;
+            if( ofs >= length() )
+                break;
+            unsigned long long regionLen = RemapGranularityBytes;
+            if( r == NRemapRegions - 1 || ofs + regionLen > length() ) {
+                // last trackable region covers the remainder of the file
+                regionLen = length() - ofs;
+            }
+            void *p = remapPrivateView( _view_private, (size_t) ofs, (size_t) regionLen );
+            fassert( 17458, p == ((char*)_view_private) + ofs );
+        }
+#endif
     }
 
     /** register view. threadsafe */
@@ -170,7 +193,7 @@ namespace mongo {
         return false;
     }
 
-    DurableMappedFile::DurableMappedFile() : _willNeedRemap(false) {
+    DurableMappedFile::DurableMappedFile() : _dirtyRegions(0) {
         _view_write = _view_private = 0;
     }
 
@@ -89,21 +89,50 @@ namespace mongo {
         int fileSuffixNo() const { return _fileSuffixNo; }
         HANDLE getFd() { return MemoryMappedFile::getFd(); }
 
+        /** granularity at which dirtied parts of the private view are tracked and
+            remapped.  regions past the last trackable one are folded into the final
+            bit, so very large files still remap correctly, just less incrementally.
+        */
+        static const unsigned long long RemapGranularityBytes = 64 * 1024 * 1024;
+        static const unsigned NRemapRegions = 64; // bits in _dirtyRegions
+
         /** true if we have written.
             set in PREPLOGBUFFER, it is NOT set immediately on write intent declaration.
-            reset to false in REMAPPRIVATEVIEW
+            reset in REMAPPRIVATEVIEW
         */
-        bool& willNeedRemap() { return _willNeedRemap; }
+        bool willNeedRemap() const { return _dirtyRegions != 0; }
 
+        /** mark the regions covering [ofs, ofs+len) of the view as dirtied by a write.
+            called in PREPLOGBUFFER; only the marked regions are remapped later.
+        */
+        void noteWriteRegion( size_t ofs, unsigned len ) {
+            unsigned r = regionFor( ofs );
+            const unsigned rEnd = regionFor( ofs + ( len ? len - 1 : 0 ) );
+            for( ; r <= rEnd; r++ ) {
+                const unsigned long long bit = 1ULL << r;
+                // usually already set, so check first to avoid cache line contention
+                if( !( _dirtyRegions & bit ) )
+                    _dirtyRegions |= bit;
+            }
+        }
+
+        /** remaps the dirtied regions of the private view (the whole view on platforms
+            that cannot replace part of a view), bounding the work done under the write
+            lock to the write set since the last remap.
+        */
         void remapThePrivateView();
 
         virtual bool isDurableMappedFile() { return true; }
 
     private:
+        static unsigned regionFor( size_t ofs ) {
+            size_t r = ofs / RemapGranularityBytes;
+            return r < NRemapRegions ? (unsigned) r : NRemapRegions - 1;
+        }
 
         void *_view_write;
         void *_view_private;
-        bool _willNeedRemap;
+        unsigned long long _dirtyRegions; // bitmask, one bit per RemapGranularityBytes of view
         RelativePath _p;   // e.g. "somepath/dbname"
         int _fileSuffixNo;  // e.g. 3.  -1="ns"
 
@@ -39,6 +39,7 @@
 #include "mongo/db/storage/data_file.h"
 #include "mongo/db/storage/extent.h"
 #include "mongo/db/storage/extent_manager.h"
+#include "mongo/db/storage/extent_preallocator.h"
 
 #include "mongo/db/pdfile.h"
 
@@ -51,7 +52,8 @@ namespace mongo {
         : _dbname( dbname.toString() ),
           _path( path.toString() ),
           _freeListDetails( freeListDetails ),
-          _directoryPerDB( directoryPerDB ) {
+          _directoryPerDB( directoryPerDB ),
+          _lastAddAFileMicros( 0 ) {
     }
 
     ExtentManager::~ExtentManager() {
@@ -149,7 +151,7 @@ namespace mongo {
             string fullNameString = fullName.string();
             p = new DataFile(n);
             int minSize = 0;
-            if ( n != 0 && _files[ n - 1 ] )
+            if ( n != 0 && n - 1 < static_cast<int>( _files.size() ) && _files[ n - 1 ] )
                 minSize = _files[ n - 1 ]->getHeader()->fileLength;
             if ( sizeNeeded + DataFileHeader::HeaderSize > minSize )
                 minSize = sizeNeeded + DataFileHeader::HeaderSize;
@@ -172,8 +174,19 @@ namespace mongo {
         DEV Lock::assertWriteLocked( _dbname );
         int n = (int) _files.size();
         DataFile *ret = getFile( n, sizeNeeded );
-        if ( preallocateNextFile )
+        if ( preallocateNextFile ) {
             preallocateAFile();
+
+            // if the database burned through its previous file in under a minute, one
+            // file of runway isn't enough for the background allocator to stay ahead of
+            // the writers, so keep a second one ready too
+            unsigned long long now = curTimeMicros64();
+            if ( _lastAddAFileMicros != 0 &&
+                 now - _lastAddAFileMicros < 60 * 1000 * 1000ULL ) {
+                getFile( numFiles() + 1, 0, true );
+            }
+            _lastAddAFileMicros = now;
+        }
         return ret;
     }
 
@@ -494,6 +507,11 @@ namespace mongo {
         if ( eloc.isNull() ) {
             fromFreeList = false;
             eloc = createExtent( size, quotaMax );
+            // we had to build this extent while the caller waited in the write lock;
+            // hint the background preallocator so the next one is already on the free list
+            if ( !details->isCapped() ) {
+                noteSynchronousExtentAllocation( _dbname, size, quotaMax );
+            }
         }
 
         verify( !eloc.isNull() );
@@ -180,6 +180,10 @@ namespace mongo {
         NamespaceDetails* _freeListDetails;
         bool _directoryPerDB;
 
+        // when addAFile last grew the database; lets it notice fast fill and keep a
+        // deeper preallocation runway
+        unsigned long long _lastAddAFileMicros;
+
         // must be in the dbLock when touching this (and write locked when writing to of course)
         // however during Database object construction we aren't, which is ok as it isn't yet visible
         //   to others and we are in the dbholder lock then.
@@ -0,0 +1,134 @@
+// extent_preallocator.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/storage/extent_preallocator.h"
+
+#include <map>
+
+#include "mongo/db/client.h"
+#include "mongo/db/commands/fsync.h"
+#include "mongo/db/database.h"
+#include "mongo/db/instance.h"
+#include "mongo/db/storage/extent.h"
+#include "mongo/db/storage/extent_manager.h"
+#include "mongo/util/background.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    namespace {
+
+        struct PreallocHint {
+            PreallocHint() : size( 0 ), quotaMax( 0 ) {}
+            int size;
+            int quotaMax;
+        };
+
+        // dbname -> largest extent size we had to build synchronously since the last pass
+        typedef std::map<std::string, PreallocHint> HintMap;
+
+        SimpleMutex hintsMutex( "extentPreallocHints" );
+        HintMap hints;
+    }
+
+    void noteSynchronousExtentAllocation( const std::string& dbname, int size, int quotaMax ) {
+        SimpleMutex::scoped_lock lk( hintsMutex );
+        PreallocHint& hint = hints[dbname];
+        if ( size > hint.size ) {
+            hint.size = size;
+            hint.quotaMax = quotaMax;
+        }
+    }
+
+    class ExtentPreallocator : public BackgroundJob {
+    public:
+        virtual string name() const { return "ExtentPreallocator"; }
+
+        virtual void run() {
+            Client::initThread( name().c_str() );
+
+            while ( !inShutdown() ) {
+                sleepsecs( 2 );
+
+                if ( lockedForWriting() ) {
+                    // fsync+lock in progress; hints keep until the next pass
+                    continue;
+                }
+
+                HintMap todo;
+                {
+                    SimpleMutex::scoped_lock lk( hintsMutex );
+                    todo.swap( hints );
+                }
+
+                for ( HintMap::const_iterator i = todo.begin(); i != todo.end(); ++i ) {
+                    try {
+                        _preallocateForDB( i->first, i->second );
+                    }
+                    catch ( DBException& e ) {
+                        error() << "error preallocating extent for db: " << i->first
+                                << " " << e << endl;
+                    }
+                }
+            }
+
+            cc().shutdown();
+        }
+
+    private:
+        void _preallocateForDB( const string& dbname, const PreallocHint& hint ) {
+            Client::WriteContext ctx( dbname );
+            Database* db = cc().database();
+            if ( !db )
+                return;
+
+            ExtentManager& em = db->getExtentManager();
+            if ( !em.hasFreeList() ) {
+                // nowhere to park the extent for this database
+                return;
+            }
+
+            // build the extent now, while nobody is waiting on it, and put it on the
+            // free list so the next increaseStorageSize finds it via allocFromFreeList
+            DiskLoc eloc = em.createExtent( hint.size, hint.quotaMax );
+            em.freeExtents( eloc, eloc );
+
+            LOG(1) << "ExtentPreallocator: preallocated extent for " << dbname
+                   << " size:" << hint.size << endl;
+        }
+    };
+
+    void startExtentPreallocationJob() {
+        ExtentPreallocator* job = new ExtentPreallocator();
+        job->go();
+    }
+}
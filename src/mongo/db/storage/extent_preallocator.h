@@ -0,0 +1,50 @@
+// extent_preallocator.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects for
+*    all of the code used other than as permitted herein. If you modify file(s)
+*    with this exception, you may extend this exception to your version of the
+*    file(s), but you are not obligated to do so. If you do not wish to do so,
+*    delete this exception statement from your version. If you delete this
+*    exception statement from all source files in the program, then also delete
+*    it in the license file.
+*/
+
+#pragma once
+
+#include <string>
+
+namespace mongo {
+
+    /**
+     * Called by ExtentManager when increaseStorageSize missed the free list and had to
+     * build an extent synchronously inside the write lock.  A background job later
+     * creates a similarly sized extent for the same database and parks it on the
+     * database's free list, so the next time the collection grows the extent is found
+     * by allocFromFreeList instead of being carved out under the lock.
+     *
+     * Cheap and lock-light; safe to call from inside the write lock.
+     */
+    void noteSynchronousExtentAllocation( const std::string& dbname, int size, int quotaMax );
+
+    /** starts the background extent preallocation job; call once at startup */
+    void startExtentPreallocationJob();
+}
@@ -80,6 +80,13 @@ namespace mongo {
             return false;
         }
 
+        const BSONElement existingFilter = info.obj().getField("filter");
+        const BSONElement newFilter = newSpec["filter"];
+
+        if ( existingFilter.woCompare( newFilter, false ) != 0 ) {
+            return false;
+        }
+
         const BSONElement existingExpireSecs =
                 info.obj().getField("expireAfterSeconds");
         const BSONElement newExpireSecs = newSpec["expireAfterSeconds"];
@@ -38,6 +38,7 @@
 #include "mongo/db/database_holder.h"
 #include "mongo/db/pagefault.h"
 #include "mongo/db/pdfile.h"
+#include "mongo/db/storage/residency.h"
 #include "mongo/platform/bits.h"
 #include "mongo/platform/unordered_set.h"
 #include "mongo/util/net/listen.h"
@@ -501,12 +502,26 @@ namespace mongo {
         }
 
         if ( ! blockSupported ) {
-            // this means we don't fallback to system call 
+            // this means we don't fallback to system call
             // and assume things aren't in memory
             // possible we yield too much - but better than not yielding through a fault
             return false;
         }
 
+        // consult the sampled residency bitmaps before paying for a system call
+        bool known = false;
+        const bool resident = residencyTracker.probablyInPhysicalMemory( data , known );
+        if ( known ) {
+            // occasionally double check the prediction so serverStatus can report
+            // how accurate the (slightly stale) bitmaps are
+            if ( rand() % ResidencyTracker::VerifyEveryN == 0 ) {
+                const bool actual = ProcessInfo::blockInMemory( const_cast<char*>(data) );
+                residencyTracker.recordVerification( resident == actual );
+                return actual;
+            }
+            return resident;
+        }
+
         return ProcessInfo::blockInMemory( const_cast<char*>(data) );
     }
 
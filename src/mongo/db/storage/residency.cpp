@@ -0,0 +1,216 @@
+// residency.cpp
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/db/storage/residency.h"
+
+#include "mongo/db/client.h"
+#include "mongo/db/commands/server_status.h"
+#include "mongo/db/storage/durable_mapped_file.h"
+#include "mongo/util/background.h"
+#include "mongo/util/processinfo.h"
+#include "mongo/util/timer.h"
+
+namespace mongo {
+
+    ResidencyTracker::ResidencyTracker()
+        : _mutex( "ResidencyTracker" ) {
+    }
+
+    bool ResidencyTracker::probablyInPhysicalMemory( const void* addr , bool& known ) {
+        known = false;
+        const char* p = static_cast<const char*>( addr );
+
+        boost::shared_ptr<const View> view;
+        {
+            scoped_lock lk( _mutex );
+            ViewMap::const_iterator i = _views.upper_bound( p );
+            if ( i != _views.begin() ) {
+                --i;
+                view = i->second;
+            }
+        }
+
+        if ( view ) {
+            size_t pageIndex = ( p - view->start ) / ProcessInfo::getPageSize();
+            if ( pageIndex < view->numPages ) {
+                known = true;
+                _consultsKnown.fetchAndAdd( 1 );
+                return view->resident( pageIndex );
+            }
+        }
+
+        _consultsUnknown.fetchAndAdd( 1 );
+        return false;
+    }
+
+    void ResidencyTracker::recordVerification( bool agreed ) {
+        if ( agreed )
+            _verifyAgreed.fetchAndAdd( 1 );
+        else
+            _verifyDisagreed.fetchAndAdd( 1 );
+    }
+
+    void ResidencyTracker::sample() {
+        Timer t;
+        ViewMap fresh;
+        long long pagesSampled = 0;
+        long long pagesResident = 0;
+
+        {
+            LockMongoFilesShared lk;
+            const std::set<MongoFile*>& files = MongoFile::getAllFiles();
+            const size_t pageSize = ProcessInfo::getPageSize();
+            vector<char> out;
+
+            for ( std::set<MongoFile*>::const_iterator i = files.begin();
+                  i != files.end();
+                  ++i ) {
+
+                if ( ! (*i)->isDurableMappedFile() )
+                    continue;
+                DurableMappedFile* mmf = (DurableMappedFile*) *i;
+
+                const char* start = static_cast<const char*>( mmf->getView() );
+                if ( ! start || mmf->length() == 0 )
+                    continue; // not fully opened yet
+
+                boost::shared_ptr<View> view( new View() );
+                view->start = start;
+                view->numPages = ( mmf->length() + pageSize - 1 ) / pageSize;
+                view->bits.resize( ( view->numPages + 63 ) / 64 , 0 );
+
+                bool ok = true;
+                for ( size_t page = 0; ok && page < view->numPages; page += SampleBatchPages ) {
+                    size_t n = view->numPages - page;
+                    if ( n > SampleBatchPages )
+                        n = SampleBatchPages;
+
+                    out.clear();
+                    if ( ! ProcessInfo::pagesInMemory( start + page * pageSize , n , &out ) ) {
+                        // leave this view out entirely; lookups fall back to the
+                        // per-page system call rather than trusting zeroed bits
+                        ok = false;
+                        break;
+                    }
+
+                    for ( size_t j = 0; j < n; j++ ) {
+                        if ( out[j] & 0x1 ) {
+                            size_t pageIndex = page + j;
+                            view->bits[ pageIndex >> 6 ] |= 1ULL << ( pageIndex & 0x3f );
+                            pagesResident++;
+                        }
+                    }
+                    pagesSampled += n;
+                }
+
+                if ( ok )
+                    fresh[start] = view;
+            }
+        }
+
+        {
+            scoped_lock lk( _mutex );
+            _views.swap( fresh );
+        }
+
+        _samplePasses.fetchAndAdd( 1 );
+        _pagesSampled.store( pagesSampled );
+        _pagesResident.store( pagesResident );
+        _lastPassMicros.store( t.micros() );
+    }
+
+    void ResidencyTracker::appendStats( BSONObjBuilder& b ) const {
+        b.appendNumber( "samplePasses" , _samplePasses.load() );
+        b.appendNumber( "pagesSampled" , _pagesSampled.load() );
+        b.appendNumber( "pagesResident" , _pagesResident.load() );
+        b.appendNumber( "lastPassMicros" , _lastPassMicros.load() );
+
+        {
+            BSONObjBuilder consults( b.subobjStart( "consults" ) );
+            consults.appendNumber( "known" , _consultsKnown.load() );
+            consults.appendNumber( "unknown" , _consultsUnknown.load() );
+            consults.done();
+        }
+
+        {
+            BSONObjBuilder verification( b.subobjStart( "verification" ) );
+            verification.appendNumber( "agreed" , _verifyAgreed.load() );
+            verification.appendNumber( "disagreed" , _verifyDisagreed.load() );
+            verification.done();
+        }
+    }
+
+    namespace {
+
+        class ResidencySampler : public BackgroundJob {
+        public:
+            virtual string name() const { return "ResidencySampler"; }
+
+            virtual void run() {
+                Client::initThread( "residencysampler" );
+
+                while ( ! inShutdown() ) {
+                    sleepsecs( ResidencyTracker::ResampleSecs );
+                    try {
+                        residencyTracker.sample();
+                    }
+                    catch ( std::exception& e ) {
+                        error() << "residency sampler error: " << e.what() << endl;
+                    }
+                }
+
+                cc().shutdown();
+            }
+        };
+
+        class ResidencyServerStatusSection : public ServerStatusSection {
+        public:
+            ResidencyServerStatusSection() : ServerStatusSection( "residency" ) {}
+            virtual bool includeByDefault() const { return false; }
+
+            virtual BSONObj generateSection( const BSONElement& configElement ) const {
+                BSONObjBuilder b;
+                residencyTracker.appendStats( b );
+                return b.obj();
+            }
+        } residencyServerStatusSection;
+
+    }
+
+    void ResidencyTracker::startSampler() {
+        ResidencySampler* sampler = new ResidencySampler();
+        sampler->go();
+    }
+
+    ResidencyTracker residencyTracker;
+
+}
@@ -0,0 +1,118 @@
+// residency.h
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#pragma once
+
+#include <map>
+#include <vector>
+
+#include <boost/shared_ptr.hpp>
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    class BSONObjBuilder;
+
+    /**
+     * Tracks which pages of the mapped data files are resident in physical
+     * memory.
+     *
+     * A background job rescans the mapped views every few seconds, asking the
+     * OS for per-page residency in large batches (mincore on posix) and
+     * storing the answers in one bitmap per view.  Record::likelyInPhysicalMemory
+     * consults the bitmaps when its recently-touched heuristic comes up empty,
+     * replacing a per-miss syscall with a map lookup; the decision to yield and
+     * touch versus proceed under the lock then reflects actual residency rather
+     * than a guess.  A small fraction of consults is double checked against the
+     * OS so the accuracy of the (slightly stale) bitmaps shows up in serverStatus.
+     */
+    class ResidencyTracker : boost::noncopyable {
+    public:
+
+        enum Constants {
+            ResampleSecs = 10 ,        // how often the sampler rescans the views
+            SampleBatchPages = 16384 , // pages per residency query (64MB batches)
+            VerifyEveryN = 256         // 1/N of consults double checked against the OS
+        };
+
+        ResidencyTracker();
+
+        /**
+         * look up addr in the sampled bitmaps
+         * @param known set to false if no fresh sample covers addr
+         * @return true if the last sample saw the page resident; meaningless when !known
+         */
+        bool probablyInPhysicalMemory( const void* addr , bool& known );
+
+        /** record whether a double checked prediction matched the OS' answer */
+        void recordVerification( bool agreed );
+
+        /** start the background sampling job; call once at startup, after
+            verifying ProcessInfo::blockCheckSupported() */
+        void startSampler();
+
+        /** one sampling pass over all mapped data files; normally only called
+            by the background job */
+        void sample();
+
+        void appendStats( BSONObjBuilder& b ) const;
+
+    private:
+
+        struct View {
+            const char* start;
+            size_t numPages;
+            std::vector<unsigned long long> bits; // 1 bit per page
+
+            bool resident( size_t pageIndex ) const {
+                return ( bits[ pageIndex >> 6 ] >> ( pageIndex & 0x3f ) ) & 1;
+            }
+        };
+
+        typedef std::map< const char* , boost::shared_ptr<const View> > ViewMap;
+
+        mutable mongo::mutex _mutex; // protects _views
+        ViewMap _views;              // keyed by view start address
+
+        AtomicInt64 _samplePasses;
+        AtomicInt64 _pagesSampled;   // from the most recent pass
+        AtomicInt64 _pagesResident;  // from the most recent pass
+        AtomicInt64 _lastPassMicros;
+        AtomicInt64 _consultsKnown;
+        AtomicInt64 _consultsUnknown;
+        AtomicInt64 _verifyAgreed;
+        AtomicInt64 _verifyDisagreed;
+    };
+
+    extern ResidencyTracker residencyTracker;
+
+}
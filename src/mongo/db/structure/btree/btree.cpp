@@ -776,9 +776,23 @@ namespace mongo {
         if( guessIncreasing ) {
             m = h;
         }
+        // How many leading elements of the search key are known equal to the keys
+        // just outside the low and high fences.  Every key between the fences shares
+        // at least min(lPrefix, hPrefix) leading elements with the search key (the
+        // bucket is sorted), so each probe can skip comparing them.  This matters for
+        // compound indexes whose adjacent keys share long prefixes.
+        unsigned lPrefix = 0;
+        unsigned hPrefix = 0;
         while ( l <= h ) {
+            // the next midpoint is one of these two, whichever way the compare
+            // goes; start pulling their cache lines in now so the dependent
+            // miss chain is one level shallower
+            this->prefetchKey( ( l + m - 1 ) / 2 );
+            this->prefetchKey( ( m + 1 + h ) / 2 );
             KeyNode M = this->keyNode(m);
-            int x = key.woCompare(M.key, btreeState->ordering());
+            unsigned commonPrefix;
+            int x = key.woCompareSkipPrefix(M.key, btreeState->ordering(),
+                                            std::min(lPrefix, hPrefix), &commonPrefix);
             if ( x == 0 ) {
                 if( assertIfDup ) {
                     if( k(m).isUnused() ) {
@@ -808,10 +822,14 @@ namespace mongo {
                 unusedRL.GETOFS() &= ~1; // so we can test equality without the used bit messing us up
                 x = recordLoc.compare(unusedRL);
             }
-            if ( x < 0 ) // key < M.key
+            if ( x < 0 ) { // key < M.key
                 h = m-1;
-            else if ( x > 0 )
+                hPrefix = commonPrefix;
+            }
+            else if ( x > 0 ) {
                 l = m+1;
+                lPrefix = commonPrefix;
+            }
             else {
                 // found it.
                 pos = m;
@@ -577,7 +577,23 @@ namespace mongo {
     public:
         const _KeyNode& k(int i) const { return ((const _KeyNode*)this->data)[i]; }
         _KeyNode& _k(int i) { return ((_KeyNode*)this->data)[i]; }
-    protected:        
+
+        /**
+         * Hint that the i-indexed slot and the key bytes it points at will be
+         * read soon, so a binary search can overlap the next probe's dependent
+         * cache misses with the current comparison.  Out-of-range i is ignored;
+         * advisory only.
+         */
+        void prefetchKey(int i) const {
+#if defined(__GNUC__)
+            if ( i < 0 || i >= this->n )
+                return;
+            const _KeyNode& kn = k(i);
+            __builtin_prefetch( &kn );
+            __builtin_prefetch( this->data + kn.keyDataOfs() );
+#endif
+        }
+    protected:
         _KeyNode& k(int i) { return ((_KeyNode*)this->data)[i]; }
 
         /**
@@ -187,8 +187,16 @@ namespace mongo {
        - dates are unsigned 
        - strings no nulls
     */
-    int KeyBson::woCompare(const KeyBson& r, const Ordering &o) const { 
-        return oldCompare(_o, r._o, o); 
+    int KeyBson::woCompare(const KeyBson& r, const Ordering &o) const {
+        return oldCompare(_o, r._o, o);
+    }
+
+    // V0 keys are plain bson; stepping elements isn't any cheaper than comparing
+    // them, so there is no prefix-skipping fast path here.
+    int KeyBson::woCompareSkipPrefix(const KeyBson& r, const Ordering &o,
+                                     unsigned skip, unsigned *commonPrefix) const {
+        *commonPrefix = 0;
+        return woCompare(r, o);
     }
 
     // woEqual could be made faster than woCompare but this is for backward compatibility so not worth a big effort
@@ -616,6 +624,51 @@ namespace mongo {
         return p - _keyData;
     }
 
+    int KeyV1::woCompareSkipPrefix(const KeyV1& right, const Ordering &order,
+                                   unsigned skip, unsigned *commonPrefix) const {
+        const unsigned char *l = _keyData;
+        const unsigned char *r = right._keyData;
+
+        *commonPrefix = 0;
+        if( (*l|*r) == IsBSON ) // only can do this if cNOTUSED maintained
+            return compareHybrid(right, order);
+
+        // the caller guarantees the first 'skip' elements of both keys are equal, so
+        // step over them looking only at the size bytes
+        for( unsigned i = 0; i < skip; i++ ) {
+            l += sizeOfElement(l);
+            r += sizeOfElement(r);
+        }
+        *commonPrefix = skip;
+
+        unsigned mask = skip < 32 ? 1u << skip : 0;
+        while( 1 ) {
+            char lval = *l;
+            char rval = *r;
+            {
+                int x = compare(l, r); // updates l and r pointers
+                if( x ) {
+                    if( order.descending(mask) )
+                        x = -x;
+                    return x;
+                }
+            }
+
+            {
+                int x = ((int)(lval & cHASMORE)) - ((int)(rval & cHASMORE));
+                if( x )
+                    return x;
+                if( (lval & cHASMORE) == 0 )
+                    break;
+            }
+
+            ++*commonPrefix;
+            mask <<= 1;
+        }
+
+        return 0;
+    }
+
     bool KeyV1::woEqual(const KeyV1& right) const {
         const unsigned char *l = _keyData;
         const unsigned char *r = right._keyData;
@@ -46,6 +46,8 @@ namespace mongo {
         explicit KeyBson(const char *keyData) : _o(keyData) { }
         explicit KeyBson(const BSONObj& obj) : _o(obj) { }
         int woCompare(const KeyBson& r, const Ordering &o) const;
+        int woCompareSkipPrefix(const KeyBson& r, const Ordering &o,
+                                unsigned skip, unsigned *commonPrefix) const;
         BSONObj toBson() const { return _o; }
         string toString() const { return _o.toString(); }
         int dataSize() const { return _o.objsize(); }
@@ -84,6 +86,16 @@ namespace mongo {
         explicit KeyV1(const char *keyData) : _keyData((unsigned char *) keyData) { }
 
         int woCompare(const KeyV1& r, const Ordering &o) const;
+
+        /** As woCompare, but skips the first 'skip' elements of both keys, which the
+            caller guarantees are equal, and reports in *commonPrefix how many leading
+            elements (>= skip) compared equal.  Skipped elements are stepped over with
+            size arithmetic only, so a binary search over keys with long shared
+            prefixes avoids re-comparing them.  Falls back to a full compare (and
+            *commonPrefix == 0) if either key is in traditional bson format. */
+        int woCompareSkipPrefix(const KeyV1& r, const Ordering &o,
+                                unsigned skip, unsigned *commonPrefix) const;
+
         bool woEqual(const KeyV1& r) const;
         BSONObj toBson() const;
         string toString() const { return toBson().toString(); }
@@ -33,6 +33,7 @@
 #include "mongo/base/counter.h"
 #include "mongo/base/owned_pointer_map.h"
 #include "mongo/db/clientcursor.h"
+#include "mongo/db/commands/dbhash.h"
 #include "mongo/db/commands/server_status.h"
 #include "mongo/db/curop.h"
 #include "mongo/db/database.h"
@@ -64,6 +65,9 @@ namespace mongo {
 
         ss << " validateDocuments: " << validateDocuments;
 
+        if ( incremental )
+            ss << " incremental: " << incremental;
+
         return ss.str();
     }
 
@@ -126,6 +130,31 @@ namespace mongo {
         return new FlatIterator( this, start, dir );
     }
 
+    void Collection::getManyIterators( size_t numDesired,
+                                       std::vector<CollectionIterator*>* out ) const {
+        verify( ok() );
+        verify( !_details->isCapped() );
+        verify( numDesired > 0 );
+
+        // Walk the extent chain once, dealing extents round-robin into numDesired buckets.
+        std::vector< std::vector<DiskLoc> > buckets( numDesired );
+        size_t which = 0;
+        const ExtentManager* em = getExtentManager();
+        for ( DiskLoc extLoc = _details->firstExtent();
+              !extLoc.isNull();
+              extLoc = em->getExtent( extLoc )->xnext ) {
+            buckets[which++ % numDesired].push_back( extLoc );
+        }
+
+        for ( size_t i = 0; i < buckets.size(); i++ ) {
+            if ( buckets[i].empty() ) {
+                // Fewer extents than iterators asked for; the rest would all be empty.
+                break;
+            }
+            out->push_back( new ExtentGroupIterator( this, buckets[i] ) );
+        }
+    }
+
     int64_t Collection::countTableScan( const MatchExpression* expression ) {
         scoped_ptr<CollectionIterator> iterator( getIterator( DiskLoc(),
                                                               false,
@@ -175,11 +204,75 @@ namespace mongo {
         StatusWith<DiskLoc> status = _insertDocument( docToInsert, enforceQuota );
         if ( status.isOK() ) {
             _details->paddingFits();
+            collectionHashes.onInsert( _ns.ns(), docToInsert );
         }
 
         return status;
     }
 
+    Status Collection::insertDocumentsBulk( const std::vector<BSONObj>& docs, bool enforceQuota,
+                                            std::vector<DiskLoc>* locs ) {
+        verify( locs );
+
+        if ( _details->isCapped() )
+            return Status( ErrorCodes::IllegalOperation,
+                           "bulk insert not supported on capped collections" );
+
+        if ( _indexCatalog.findIdIndex() ) {
+            for ( size_t i = 0; i < docs.size(); i++ ) {
+                if ( docs[i]["_id"].eoo() ) {
+                    return Status( ErrorCodes::InternalError,
+                                   "Collection::insertDocumentsBulk got document without _id" );
+                }
+            }
+        }
+
+        // keep each contiguous run (and thus each journal intent) modest
+        const long long maxRunBytes = 4 * 1024 * 1024;
+
+        size_t start = 0;
+        while ( start < docs.size() ) {
+            long long runBytes = 0;
+            size_t end = start;
+            while ( end < docs.size() &&
+                    ( end == start || runBytes + docs[end].objsize() <= maxRunBytes ) ) {
+                runBytes += docs[end].objsize();
+                end++;
+            }
+
+            std::vector<BSONObj> run( docs.begin() + start, docs.begin() + end );
+            std::vector<DiskLoc> runLocs;
+            Status status = _recordStore.insertRecords( run,
+                                                        enforceQuota ? largestFileNumberInQuota() : 0,
+                                                        &runLocs );
+            if ( !status.isOK() )
+                return status;
+
+            _infoCache.notifyOfWriteOp();
+
+            for ( size_t i = 0; i < run.size(); i++ ) {
+                try {
+                    _indexCatalog.indexRecord( run[i], runLocs[i] );
+                }
+                catch ( AssertionException& e ) {
+                    // indexRecord rolled its own keys back; remove this doc's record and
+                    // the still-unindexed remainder of the run, then report the error
+                    for ( size_t j = i; j < run.size(); j++ ) {
+                        _recordStore.deleteRecord( runLocs[j] );
+                    }
+                    return e.toStatus( "insertDocumentsBulk" );
+                }
+                locs->push_back( runLocs[i] );
+                _details->paddingFits();
+                collectionHashes.onInsert( _ns.ns(), run[i] );
+            }
+
+            start = end;
+        }
+
+        return Status::OK();
+    }
+
     StatusWith<DiskLoc> Collection::_insertDocument( const BSONObj& docToInsert, bool enforceQuota ) {
 
         // TODO: for now, capped logic lives inside NamespaceDetails, which is hidden
@@ -236,11 +329,55 @@ namespace mongo {
 
         _indexCatalog.unindexRecord( doc, loc, noWarn);
 
+        // before deleteRecord: doc still points into the record's memory
+        collectionHashes.onDelete( _ns.ns(), doc );
+
         _recordStore.deleteRecord( loc );
 
         _infoCache.notifyOfWriteOp();
     }
 
+    void Collection::deleteDocuments( const std::vector<DiskLoc>& locs,
+                                      bool noWarn,
+                                      vector<BSONObj>* deletedIds ) {
+        if ( _details->isCapped() ) {
+            log() << "failing batched remove on a capped ns " << _ns << endl;
+            uasserted( 17499, "cannot remove from a capped collection" );
+            return;
+        }
+
+        if ( locs.empty() )
+            return;
+
+        // the docs point into the records themselves; the records stay valid until
+        // deleteRecord below, after all index entries are gone
+        vector<BSONObj> docs;
+        docs.reserve( locs.size() );
+        for ( size_t i = 0; i < locs.size(); i++ ) {
+            BSONObj doc = docFor( locs[i] );
+            docs.push_back( doc );
+
+            if ( deletedIds ) {
+                BSONElement e = doc["_id"];
+                deletedIds->push_back( e.type() ? e.wrap() : BSONObj() );
+            }
+
+            /* check if any cursors point to us.  if so, advance them. */
+            ClientCursor::aboutToDelete( _ns.ns(), _details, locs[i] );
+        }
+
+        _indexCatalog.unindexRecords( docs, locs, noWarn );
+
+        for ( size_t i = 0; i < locs.size(); i++ ) {
+            // before deleteRecord: doc still points into the record's memory
+            collectionHashes.onDelete( _ns.ns(), docs[i] );
+
+            _recordStore.deleteRecord( locs[i] );
+        }
+
+        _infoCache.notifyOfWriteOp();
+    }
+
     Counter64 moveCounter;
     ServerStatusMetricField<Counter64> moveCounterDisplay( "record.moves", &moveCounter );
 
@@ -261,6 +398,9 @@ namespace mongo {
                                             13596 );
         }
 
+        // growth telemetry drives the padding of future allocations (adaptivePadding)
+        _recordStore.noteUpdateGrowth( objOld.objsize(), objNew.objsize() );
+
         if ( ns().coll() == "system.users" ) {
             // XXX - andy and spencer think this should go away now
             V2UserDocumentParser parser;
@@ -319,6 +459,7 @@ namespace mongo {
             if ( loc.isOK() ) {
                 // insert successful, now lets deallocate the old location
                 // remember its already unindexed
+                collectionHashes.onUpdate( _ns.ns(), objOld, objNew );
                 _recordStore.deleteRecord( oldLocation );
             }
             else {
@@ -349,11 +490,47 @@ namespace mongo {
         }
 
         //  update in place
+        // before the memcpy: objOld still points at the record's old bytes
+        collectionHashes.onUpdate( _ns.ns(), objOld, objNew );
         int sz = objNew.objsize();
         memcpy(getDur().writingPtr(oldRecord->data(), sz), objNew.objdata(), sz);
         return StatusWith<DiskLoc>( oldLocation );
     }
 
+    Status Collection::updateDocumentWithDamages( const DiskLoc& loc,
+                                                  const char* damageSource,
+                                                  const mutablebson::DamageVector& damages ) {
+        Record* rec = getExtentManager()->recordFor( loc );
+
+        // the hash accumulator needs the pre-image; only copy it when tracked, as the
+        // bytes about to be damaged are part of the record itself
+        BSONObj hashPreImage;
+        if ( collectionHashes.isTracked( _ns.ns() ) )
+            hashPreImage = BSONObj::make( rec ).copy();
+
+        _infoCache.notifyOfWriteOp();
+        _details->paddingFits();
+
+        // in-place damages never change the document size: a zero-growth sample
+        _recordStore.noteUpdateGrowth( rec->netLength(), rec->netLength() );
+
+        // the damage vector arrives coalesced (see mutablebson::coalesceDamages), so
+        // each entry becomes exactly one write intent in the journal
+        char* root = rec->data();
+        mutablebson::DamageVector::const_iterator where = damages.begin();
+        const mutablebson::DamageVector::const_iterator end = damages.end();
+        for( ; where != end; ++where ) {
+            const char* sourcePtr = damageSource + where->sourceOffset;
+            void* targetPtr = getDur().writingPtr( root + where->targetOffset, where->size );
+            memcpy( targetPtr, sourcePtr, where->size );
+        }
+
+        if ( !hashPreImage.isEmpty() )
+            collectionHashes.onUpdate( _ns.ns(), hashPreImage, BSONObj::make( rec ) );
+
+        return Status::OK();
+    }
+
     int64_t Collection::storageSize( int* numExtents, BSONArrayBuilder* extentInfo ) const {
         if ( _details->firstExtent().isNull() ) {
             if ( numExtents )
@@ -31,8 +31,10 @@
 #pragma once
 
 #include <string>
+#include <vector>
 
 #include "mongo/base/string_data.h"
+#include "mongo/bson/mutable/damage_vector.h"
 #include "mongo/db/catalog/index_catalog.h"
 #include "mongo/db/diskloc.h"
 #include "mongo/db/exec/collection_scan_common.h"
@@ -68,6 +70,7 @@ namespace mongo {
             validateDocuments = true;
             paddingFactor = 1;
             paddingBytes = 0;
+            incremental = false;
         }
 
         // padding
@@ -87,6 +90,11 @@ namespace mongo {
         // other
         bool validateDocuments;
 
+        // release and reacquire the DB write lock between extents so normal
+        // traffic can interleave.  note the collection has no indexes for the
+        // duration of the compact either way.
+        bool incremental;
+
         std::string toString() const;
     };
 
@@ -127,6 +135,14 @@ namespace mongo {
         CollectionIterator* getIterator( const DiskLoc& start, bool tailable,
                                          const CollectionScanParams::Direction& dir) const;
 
+        /**
+         * Returns up to 'numDesired' iterators that partition the extent chain round-robin;
+         * together they visit every record exactly once.  Fewer come back if the collection
+         * has fewer extents.  Caller owns the iterators.  Not supported on capped
+         * collections.
+         */
+        void getManyIterators( size_t numDesired,
+                               std::vector<CollectionIterator*>* out ) const;
 
         /**
          * does a table scan to do a count
@@ -140,6 +156,17 @@ namespace mongo {
                              bool noWarn = false,
                              BSONObj* deletedId = 0 );
 
+        /**
+         * deletes a batch of documents at once.  index entries for the whole batch are
+         * removed per index in key order (amortizing btree descents), which is
+         * substantially cheaper than deleting the documents one by one.  if 'deletedIds'
+         * is non-NULL the _id (wrapped) of each deleted doc is appended to it, in order.
+         * not for capped collections.
+         */
+        void deleteDocuments( const std::vector<DiskLoc>& locs,
+                              bool noWarn = false,
+                              std::vector<BSONObj>* deletedIds = 0 );
+
         /**
          * this does NOT modify the doc before inserting
          * i.e. will not add an _id field for documents that are missing it
@@ -148,6 +175,18 @@ namespace mongo {
 
         StatusWith<DiskLoc> insertDocument( const DocWriter* doc, bool enforceQuota );
 
+        /**
+         * bulk insert of pre-validated docs: records are carved out of contiguous runs
+         * (see RecordStore::insertRecords) and index keys registered in the same pass,
+         * cutting per-document allocator and DeletedRecord bookkeeping overhead.
+         * appends the location of each inserted doc to *locs.  on error, docs already
+         * inserted stay inserted (check locs->size()), matching the partial-insert
+         * semantics of a failed multi-document insert message.  not for capped
+         * collections.  like insertDocument this does NOT modify the docs.
+         */
+        Status insertDocumentsBulk( const std::vector<BSONObj>& docs, bool enforceQuota,
+                                    std::vector<DiskLoc>* locs );
+
         /**
          * updates the document @ oldLocation with newDoc
          * if the document fits in the old space, it is put there
@@ -159,6 +198,16 @@ namespace mongo {
                                             bool enforceQuota,
                                             OpDebug* debug );
 
+        /**
+         * applies a set of in-place damages (mutablebson::Document::getInPlaceUpdates)
+         * directly onto the record at loc.  the damages must not change the document's
+         * size or field layout -- no index key may change and the record cannot move --
+         * so only the damaged byte ranges are journaled, one write intent per extent.
+         */
+        Status updateDocumentWithDamages( const DiskLoc& loc,
+                                          const char* damageSource,
+                                          const mutablebson::DamageVector& damages );
+
         int64_t storageSize( int* numExtents = NULL, BSONArrayBuilder* extentInfo = NULL ) const;
 
         // -----------
@@ -212,6 +261,7 @@ namespace mongo {
         friend class Database;
         friend class FlatIterator;
         friend class CappedIterator;
+        friend class ExtentGroupIterator;
         friend class IndexCatalog;
     };
 
@@ -126,6 +126,71 @@ namespace mongo {
         return true;
     }
 
+    //
+    // Extent-group traversal
+    //
+
+    ExtentGroupIterator::ExtentGroupIterator(const Collection* collection,
+                                             const std::vector<DiskLoc>& extents)
+        : _collection(collection), _extents(extents), _currentExtent(0) {
+
+        verify( _collection->ok() );
+
+        advanceToNonEmptyExtent();
+    }
+
+    void ExtentGroupIterator::advanceToNonEmptyExtent() {
+        const ExtentManager* em = _collection->getExtentManager();
+
+        _curr = DiskLoc();
+        while (_currentExtent < _extents.size()) {
+            Extent* e = em->getExtent( _extents[_currentExtent] );
+            if (!e->firstRecord.isNull()) {
+                _curr = e->firstRecord;
+                return;
+            }
+            ++_currentExtent;
+        }
+    }
+
+    bool ExtentGroupIterator::isEOF() {
+        return _curr.isNull();
+    }
+
+    DiskLoc ExtentGroupIterator::getNext() {
+        DiskLoc ret = _curr;
+
+        // Move to the next thing, staying inside our extents.
+        if (!isEOF()) {
+            _curr = _collection->getExtentManager()->getNextRecordInExtent( _curr );
+            if (_curr.isNull()) {
+                // Done with this extent; move to the next non-empty one we were given.
+                ++_currentExtent;
+                advanceToNonEmptyExtent();
+            }
+        }
+
+        return ret;
+    }
+
+    void ExtentGroupIterator::invalidate(const DiskLoc& dl) {
+        verify( _collection->ok() );
+
+        // Just move past the thing being deleted.
+        if (dl == _curr) {
+            getNext();
+        }
+    }
+
+    void ExtentGroupIterator::prepareToYield() {
+    }
+
+    bool ExtentGroupIterator::recoverFromYield() {
+        verify( _collection->ok() );
+
+        return true;
+    }
+
     //
     // Capped collection traversal
     //
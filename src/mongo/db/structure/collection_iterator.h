@@ -28,6 +28,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/db/exec/collection_scan_common.h"
 
 namespace mongo {
@@ -90,6 +92,41 @@ namespace mongo {
         CollectionScanParams::Direction _direction;
     };
 
+    /**
+     * Iterates over the records in a fixed set of extents, in the order the extents were
+     * provided, and never crosses into an extent it wasn't given.  This is how
+     * Collection::getManyIterators hands out disjoint pieces of a collection so several
+     * cursors can scan it in parallel.  Forward only, non-capped collections only.
+     */
+    class ExtentGroupIterator : public CollectionIterator {
+    public:
+        ExtentGroupIterator(const Collection* collection, const std::vector<DiskLoc>& extents);
+        virtual ~ExtentGroupIterator() { }
+
+        virtual bool isEOF();
+        virtual DiskLoc getNext();
+
+        virtual void invalidate(const DiskLoc& dl);
+        virtual void prepareToYield();
+        virtual bool recoverFromYield();
+
+    private:
+        /**
+         * Sets _curr to the first record in the first non-empty extent at or after
+         * _currentExtent, or to DiskLoc() if there isn't one.
+         */
+        void advanceToNonEmptyExtent();
+
+        const Collection* _collection;
+
+        // The extents we walk, in order.  These are the DiskLocs of Extents, not Records.
+        std::vector<DiskLoc> _extents;
+        size_t _currentExtent;
+
+        // The result returned on the next call to getNext().
+        DiskLoc _curr;
+    };
+
     /**
      * This class iterates over a capped collection identified by 'ns'.
      * The collection must exist when the constructor is called.
@@ -30,6 +30,10 @@
 
 #include "mongo/db/structure/record_store.h"
 
+#include <algorithm>
+#include <limits>
+
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/storage/extent.h"
 #include "mongo/db/structure/collection.h"
 
@@ -38,6 +42,74 @@
 
 namespace mongo {
 
+    // Padding chosen from the per-collection update-growth histogram instead of the
+    // scalar paddingFactor nudges.  Applies to non-capped collections without the
+    // usePowerOf2Sizes flag, once enough updates have been observed.
+    MONGO_EXPORT_SERVER_PARAMETER( adaptivePadding, bool, true );
+
+    // Fraction of updates we are willing to let outgrow their padding and move the
+    // document (with full reindexing).
+    MONGO_EXPORT_SERVER_PARAMETER( adaptivePaddingTargetMoveRate, double, 0.01 );
+
+    const double UpdateGrowthHistogram::GrowthBounds[UpdateGrowthHistogram::NumBuckets] =
+        { 0.0, 0.02, 0.05, 0.10, 0.20, 0.50, 1.0, std::numeric_limits<double>::max() };
+
+    UpdateGrowthHistogram::UpdateGrowthHistogram() {
+        for ( int i = 0; i < NumBuckets; i++ )
+            _counts[i].store( 0 );
+    }
+
+    void UpdateGrowthHistogram::record( int oldSize, int newSize ) {
+        if ( oldSize <= 0 )
+            return;
+
+        double growth = static_cast<double>( newSize - oldSize ) / oldSize;
+        int bucket = 0;
+        while ( bucket < NumBuckets - 1 && growth > GrowthBounds[bucket] )
+            bucket++;
+        _counts[bucket].fetchAndAdd( 1 );
+
+        // age the histogram so a workload shift doesn't stay drowned out by history.
+        // the halving races with concurrent increments, but the counts are heuristic.
+        RARELY {
+            unsigned long long total = 0;
+            for ( int i = 0; i < NumBuckets; i++ )
+                total += _counts[i].load();
+            if ( total >= MaxSamples ) {
+                for ( int i = 0; i < NumBuckets; i++ )
+                    _counts[i].store( _counts[i].load() / 2 );
+            }
+        }
+    }
+
+    double UpdateGrowthHistogram::paddingFactor( double targetMoveRate ) const {
+        unsigned counts[NumBuckets];
+        unsigned long long total = 0;
+        for ( int i = 0; i < NumBuckets; i++ ) {
+            counts[i] = _counts[i].load();
+            total += counts[i];
+        }
+
+        if ( total < MinSamples )
+            return 0;
+
+        // padding to GrowthBounds[k] makes every update in buckets 0..k fit; pick the
+        // smallest k whose expected moves (the buckets above k) meet the target
+        const unsigned long long maxMoves =
+            static_cast<unsigned long long>( total * targetMoveRate );
+
+        int chosen = NumBuckets - 1;
+        unsigned long long moves = 0;
+        for ( int k = NumBuckets - 2; k >= 0; k-- ) {
+            moves += counts[k + 1];
+            if ( moves > maxMoves )
+                break;
+            chosen = k;
+        }
+
+        return 1.0 + std::min( GrowthBounds[chosen], 1.0 );
+    }
+
     RecordStore::RecordStore( const StringData& ns )
         : _ns( ns.toString() ) {
         _extentManager = NULL;
@@ -56,8 +128,19 @@ namespace mongo {
         return _extentManager->recordFor( loc );
     }
 
+    int RecordStore::_allocationSize( int minRecordSize ) const {
+        if ( adaptivePadding &&
+             !_details->isCapped() &&
+             !_details->isUserFlagSet( NamespaceDetails::Flag_UsePowerOf2Sizes ) ) {
+            double factor = _growthHistogram.paddingFactor( adaptivePaddingTargetMoveRate );
+            if ( factor > 0 )
+                return static_cast<int>( minRecordSize * factor );
+        }
+        return _details->getRecordAllocationSize( minRecordSize );
+    }
+
     StatusWith<DiskLoc> RecordStore::insertRecord( const DocWriter* doc, int quotaMax ) {
-        int lenWHdr = _details->getRecordAllocationSize( doc->documentSize() + Record::HeaderSize );
+        int lenWHdr = _allocationSize( doc->documentSize() + Record::HeaderSize );
 
         StatusWith<DiskLoc> loc = allocRecord( lenWHdr, quotaMax );
         if ( !loc.isOK() )
@@ -78,7 +161,7 @@ namespace mongo {
 
 
     StatusWith<DiskLoc> RecordStore::insertRecord( const char* data, int len, int quotaMax ) {
-        int lenWHdr = _details->getRecordAllocationSize( len + Record::HeaderSize );
+        int lenWHdr = _allocationSize( len + Record::HeaderSize );
         fassert( 17208, lenWHdr >= ( len + Record::HeaderSize ) );
 
         StatusWith<DiskLoc> loc = allocRecord( lenWHdr, quotaMax );
@@ -100,6 +183,61 @@ namespace mongo {
     }
 
 
+    Status RecordStore::insertRecords( const std::vector<BSONObj>& docs, int quotaMax,
+                                       std::vector<DiskLoc>* locs ) {
+        verify( !_details->isCapped() );
+        verify( !docs.empty() );
+
+        // per-record allocation sizes and the length of the whole run
+        std::vector<int> lenWHdrs( docs.size() );
+        long long total = 0;
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            int lenWHdr = _allocationSize( docs[i].objsize() + Record::HeaderSize );
+            fassert( 17456, lenWHdr >= ( docs[i].objsize() + Record::HeaderSize ) );
+            lenWHdrs[i] = lenWHdr;
+            total += lenWHdr;
+        }
+
+        if ( total > Extent::maxSize() / 2 ) {
+            // a run must fit inside one extent; callers chunk their batches
+            return Status( ErrorCodes::InvalidLength, "bulk insert batch too large for one run" );
+        }
+
+        StatusWith<DiskLoc> runLoc = allocRecord( static_cast<int>( total ), quotaMax );
+        if ( !runLoc.isOK() )
+            return runLoc.getStatus();
+
+        Record* run = recordFor( runLoc.getValue() );
+        const int runLen = run->lengthWithHeaders();
+        fassert( 17457, runLen >= total );
+        const int extentOfs = run->extentOfs();
+
+        // any slop alloc() handed us beyond our request is folded into the last
+        // record's padding -- same "you get the whole thing" policy alloc itself uses
+        char* p = reinterpret_cast<char*>( getDur().writingPtr( run, runLen ) );
+
+        long long totalNetLength = 0;
+        int ofs = 0;
+        for ( size_t i = 0; i < docs.size(); i++ ) {
+            Record* r = reinterpret_cast<Record*>( p + ofs );
+            const int len = ( i == docs.size() - 1 ) ? ( runLen - ofs ) : lenWHdrs[i];
+            r->lengthWithHeaders() = len;
+            r->extentOfs() = extentOfs;
+            memcpy( r->data(), docs[i].objdata(), docs[i].objsize() );
+
+            DiskLoc loc( runLoc.getValue().a(), runLoc.getValue().getOfs() + ofs );
+            addRecordToRecListInExtent( r, loc );
+            locs->push_back( loc );
+
+            totalNetLength += r->netLength();
+            ofs += lenWHdrs[i];
+        }
+
+        _details->incrementStats( totalNetLength, docs.size() );
+
+        return Status::OK();
+    }
+
     StatusWith<DiskLoc> RecordStore::allocRecord( int lengthWithHeaders, int quotaMax ) {
         DiskLoc loc = _details->alloc( _ns, lengthWithHeaders );
         if ( !loc.isNull() )
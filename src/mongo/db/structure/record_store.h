@@ -30,16 +30,53 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/db/diskloc.h"
+#include "mongo/platform/atomic_word.h"
 
 namespace mongo {
 
+    class BSONObj;
     class Collection;
     class DocWriter;
     class ExtentManager;
     class NamespaceDetails;
     class Record;
 
+    /**
+     * cheap in-memory histogram of the relative growth observed on this collection's
+     * updates.  maintained at update time (a bucketed atomic increment) and consulted at
+     * allocation time to pick how much padding a new record gets, targeting a configured
+     * document-move probability instead of the blind scalar paddingFactor nudges.
+     * forgets nothing across restarts -- until enough updates have been seen the caller
+     * falls back to the legacy paddingFactor.
+     */
+    class UpdateGrowthHistogram {
+    public:
+        enum { NumBuckets = 8 };
+
+        UpdateGrowthHistogram();
+
+        /** classify one observed update by relative growth and bump its bucket */
+        void record( int oldSize, int newSize );
+
+        /**
+         * @return the smallest padding factor (>= 1, capped at 2) whose expected
+         *         fraction of growing-past-the-padding updates is <= targetMoveRate,
+         *         or 0 if too few updates have been observed to trust the histogram
+         */
+        double paddingFactor( double targetMoveRate ) const;
+
+    private:
+        enum { MinSamples = 256, MaxSamples = 1 << 16 };
+
+        // upper bound of relative growth per bucket; last bucket is unbounded
+        static const double GrowthBounds[NumBuckets];
+
+        AtomicUInt32 _counts[NumBuckets];
+    };
+
     class RecordStore {
     public:
         RecordStore( const StringData& ns );
@@ -56,14 +93,36 @@ namespace mongo {
 
         StatusWith<DiskLoc> insertRecord( const DocWriter* doc, int quotaMax );
 
+        /**
+         * bulk insert: carves ONE contiguous run out of an extent for all the docs,
+         * writes them back to back under a single journal intent, and links them into
+         * the extent record list in one pass.  appends each doc's DiskLoc to *locs.
+         * all or nothing at this layer.  not for capped collections.  callers should
+         * keep the total batch modest (a few MB) so the journal intent stays small.
+         */
+        Status insertRecords( const std::vector<BSONObj>& docs, int quotaMax,
+                              std::vector<DiskLoc>* locs );
+
+        /** feed one observed update's size change into the growth histogram */
+        void noteUpdateGrowth( int oldSize, int newSize ) {
+            _growthHistogram.record( oldSize, newSize );
+        }
+
     protected:
         StatusWith<DiskLoc> allocRecord( int lengthWithHeaders, int quotaMax );
 
     private:
+        /**
+         * allocation size for a new record: learned padding from the growth histogram
+         * when we have one, otherwise NamespaceDetails::getRecordAllocationSize.
+         */
+        int _allocationSize( int minRecordSize ) const;
+
         std::string _ns;
         NamespaceDetails* _details;
         ExtentManager* _extentManager;
         bool _isSystemIndexes;
+        UpdateGrowthHistogram _growthHistogram;
     };
 
 }
@@ -35,6 +35,7 @@
 #include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_session.h"
 #include "mongo/db/auth/user_name.h"
+#include "mongo/db/background_scheduler.h"
 #include "mongo/db/client.h"
 #include "mongo/db/commands/fsync.h"
 #include "mongo/db/commands/server_status.h"
@@ -54,19 +55,22 @@ namespace mongo {
     ServerStatusMetricField<Counter64> ttlDeletedDocumentsDisplay("ttl.deletedDocuments", &ttlDeletedDocuments);
 
     MONGO_EXPORT_SERVER_PARAMETER( ttlMonitorEnabled, bool, true );
-    
+
+    // documents deleted per lock acquisition; between batches the lock is released
+    MONGO_EXPORT_SERVER_PARAMETER( ttlDeleteBatchSize, int, 1000 );
+
     class TTLMonitor : public BackgroundJob {
     public:
-        TTLMonitor(){}
+        TTLMonitor() {}
         virtual ~TTLMonitor(){}
 
         virtual string name() const { return "TTLMonitor"; }
-        
+
         static string secondsExpireField;
-        
+
         void doTTLForDB( const string& dbName ) {
 
-            bool isMaster = isMasterNs( dbName.c_str() );
+            DBDirectClient db;
             vector<BSONObj> indexes;
             {
                 auto_ptr<DBClientCursor> cursor =
@@ -82,10 +86,10 @@ namespace mongo {
                     }
                 }
             }
-            
+
             for ( unsigned i=0; i<indexes.size(); i++ ) {
                 BSONObj idx = indexes[i];
-                
+
 
                 BSONObj key = idx["key"].Obj();
                 if ( key.nFields() != 1 ) {
@@ -105,34 +109,57 @@ namespace mongo {
                     b.appendDate( "$lt" , curTimeMillis64() - ( 1000 * idx[secondsExpireField].numberLong() ) );
                     query = BSON( key.firstElement().fieldName() << b.obj() );
                 }
-                
+
                 LOG(1) << "TTL: " << key << " \t " << query << endl;
-                
-                long long n = 0;
+
+                doTTLForIndex( dbName, idx["ns"].String(), query );
+            }
+
+
+        }
+
+        /** delete everything matching 'query', a batch per lock acquisition, until
+            the collection has no more expired docs (or we stop being master). */
+        void doTTLForIndex( const string& dbName, const string& ns, const BSONObj& query ) {
+            int batchSize = ttlDeleteBatchSize;
+            if ( batchSize < 1 )
+                batchSize = 1;
+
+            long long n = 0;
+            while ( !inShutdown() ) {
+                long long deleted = 0;
                 {
-                    string ns = idx["ns"].String();
                     Client::WriteContext ctx( ns );
                     NamespaceDetails* nsd = nsdetails( ns );
                     if ( ! nsd ) {
                         // collection was dropped
-                        continue;
+                        break;
                     }
                     if ( nsd->setUserFlag( NamespaceDetails::Flag_UsePowerOf2Sizes ) ) {
                         nsd->syncUserFlags( ns );
                     }
-                    // only do deletes if on master
-                    if ( ! isMaster ) {
-                        continue;
+                    // only do deletes if on master.  rechecked per batch in case we
+                    // stepped down mid-pass.
+                    if ( ! isMasterNs( dbName.c_str() ) ) {
+                        break;
                     }
 
-                    n = deleteObjects( ns , query , false , true );
-                    ttlDeletedDocuments.increment( n );
+                    deleted = deleteObjects( ns , query , false , true , false , batchSize );
+                    ttlDeletedDocuments.increment( deleted );
                 }
 
-                LOG(1) << "\tTTL deleted: " << n << endl;
+                n += deleted;
+                if ( deleted < batchSize ) {
+                    // no more expired docs for now
+                    break;
+                }
+
+                // lock is released here; charge the maintenance budget before
+                // taking it again (see backgroundMaintenanceUnitsPerSecond)
+                backgroundScheduler().throttle( BackgroundScheduler::Maintenance, deleted );
             }
-            
-            
+
+            LOG(1) << "\tTTL deleted: " << n << endl;
         }
 
         virtual void run() {
@@ -168,20 +195,35 @@ namespace mongo {
                 
                 ttlPasses.increment();
 
+                // databases fan out over the shared background pool; the locks are
+                // per-database, so this is also the granularity at which deletes
+                // can overlap
+                BackgroundScheduler::Batch batch;
                 for ( set<string>::const_iterator i=dbs.begin(); i!=dbs.end(); ++i ) {
-                    string db = *i;
-                    try {
-                        doTTLForDB( db );
-                    }
-                    catch ( DBException& e ) {
-                        error() << "error processing ttl for db: " << db << " " << e << endl;
-                    }
+                    batch.schedule( BackgroundScheduler::Maintenance,
+                                    boost::bind( &TTLMonitor::_doTTLForDBTask, this, *i ) );
                 }
+                batch.join();
 
             }
         }
 
-        DBDirectClient db;
+    private:
+
+        void _doTTLForDBTask( const string& db ) {
+            // pool threads are reused across passes, so only set up once per thread
+            if ( !haveClient() ) {
+                Client::initThread( "TTLWorker" );
+                cc().getAuthorizationSession()->grantInternalAuthorization();
+            }
+
+            try {
+                doTTLForDB( db );
+            }
+            catch ( DBException& e ) {
+                error() << "error processing ttl for db: " << db << " " << e << endl;
+            }
+        }
     };
 
     void startTTLBackgroundJob() {
@@ -40,6 +40,9 @@ namespace mongo {
     public:
         void setShardKey( const BSONObj &keyPattern ) {
             const_cast<ShardKeyPattern&>(_key) = ShardKeyPattern( keyPattern );
+            // chunks read the key through the shared collection info
+            const_cast<ShardedCollectionInfoPtr&>(_info).reset(
+                    new ShardedCollectionInfo( _ns, _key, _unique ) );
         }
         void setSingleChunkForShards( const vector<BSONObj> &splitPoints ) {
             ChunkMap &chunkMap = const_cast<ChunkMap&>( _chunkMap );
@@ -55,7 +58,7 @@ namespace mongo {
                 Shard shard( name, name );
                 shards.insert( shard );
                 
-                ChunkPtr chunk( new Chunk( this, mySplitPoints[ i-1 ], mySplitPoints[ i ],
+                ChunkPtr chunk( new Chunk( getCollInfo(), mySplitPoints[ i-1 ], mySplitPoints[ i ],
                                           shard ) );
                 chunkMap[ mySplitPoints[ i ] ] = chunk;
             }
@@ -31,6 +31,7 @@
  */
 
 #include "mongo/db/instance.h"
+#include "mongo/db/introspect.h"
 #include "mongo/unittest/unittest.h"
 
 using mongo::BSONObj;
@@ -73,6 +74,9 @@ namespace mongo_test {
         const BSONObj doc(BSON("field" << bigStr));
         db.update(PROFILER_TEST_NS, doc, doc);
 
+        // profile records are written by a background thread
+        mongo::profileFlush();
+
         std::auto_ptr<mongo::DBClientCursor> cursor = db.query(PROFILE_NS, BSONObj());
         ASSERT(cursor->more());
 
@@ -106,6 +110,9 @@ namespace mongo_test {
         const BSONObj doc(builder.done());
         db.update(PROFILER_TEST_NS, doc, doc);
 
+        // profile records are written by a background thread
+        mongo::profileFlush();
+
         std::auto_ptr<mongo::DBClientCursor> cursor = db.query(PROFILE_NS, BSONObj());
         ASSERT(cursor->more());
 
@@ -0,0 +1,118 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/logger/async_appender.h"
+
+#include <boost/bind.hpp>
+#include <sstream>
+
+namespace mongo {
+namespace logger {
+
+    AsyncMessageAppender::AsyncMessageAppender(MessageLogDomain::EventAppender* wrapped,
+                                               size_t maxQueueBytes)
+        : _wrapped(wrapped),
+          _maxQueueBytes(maxQueueBytes),
+          _queueBytes(0),
+          _dropped(0),
+          _writing(false),
+          _shutdown(false),
+          _writer(boost::bind(&AsyncMessageAppender::_writerLoop, this)) {
+    }
+
+    AsyncMessageAppender::~AsyncMessageAppender() {
+        {
+            boost::unique_lock<boost::mutex> lk(_mutex);
+            _shutdown = true;
+            _newEvent.notify_one();
+        }
+        _writer.join();
+    }
+
+    Status AsyncMessageAppender::append(const MessageEventEphemeral& event) {
+        bool urgent = event.getSeverity() >= LogSeverity::Error();
+        {
+            boost::unique_lock<boost::mutex> lk(_mutex);
+            size_t bytes = event.getContextName().size() + event.getMessage().size();
+            if (!urgent && _queueBytes + bytes > _maxQueueBytes) {
+                _dropped++;
+                return Status::OK();
+            }
+            _queue.push_back(QueuedEvent());
+            QueuedEvent& q = _queue.back();
+            q.date = event.getDate();
+            q.severity = event.getSeverity();
+            q.contextName = event.getContextName().toString();
+            q.message = event.getMessage().toString();
+            _queueBytes += bytes;
+            _newEvent.notify_one();
+        }
+        if (urgent) {
+            // keep order but wait it out, so fatal output hits the log
+            // before the process can die
+            flush();
+        }
+        return Status::OK();
+    }
+
+    void AsyncMessageAppender::flush() {
+        boost::unique_lock<boost::mutex> lk(_mutex);
+        while (!_queue.empty() || _writing)
+            _drained.wait(lk);
+    }
+
+    void AsyncMessageAppender::_writerLoop() {
+        while (true) {
+            std::deque<QueuedEvent> batch;
+            long long dropped;
+            {
+                boost::unique_lock<boost::mutex> lk(_mutex);
+                while (_queue.empty() && !_shutdown)
+                    _newEvent.wait(lk);
+                if (_queue.empty() && _shutdown)
+                    return;
+                batch.swap(_queue);
+                _queueBytes = 0;
+                dropped = _dropped;
+                _dropped = 0;
+                _writing = true;
+            }
+
+            for (std::deque<QueuedEvent>::const_iterator i = batch.begin();
+                 i != batch.end(); ++i) {
+                _wrapped->append(MessageEventEphemeral(
+                        i->date, i->severity, i->contextName, i->message));
+            }
+
+            if (dropped > 0) {
+                std::ostringstream os;
+                os << "log queue was full: " << dropped << " message(s) dropped\n";
+                std::string msg = os.str();
+                // batch can't be empty here: dropping implies the queue was full
+                _wrapped->append(MessageEventEphemeral(
+                        batch.back().date, LogSeverity::Warning(), "AsyncLog", msg));
+            }
+
+            {
+                boost::unique_lock<boost::mutex> lk(_mutex);
+                _writing = false;
+                if (_queue.empty())
+                    _drained.notify_all();
+            }
+        }
+    }
+
+}  // namespace logger
+}  // namespace mongo
@@ -0,0 +1,96 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <deque>
+#include <string>
+
+#include <boost/scoped_ptr.hpp>
+#include <boost/thread/condition.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/thread.hpp>
+
+#include "mongo/base/disallow_copying.h"
+#include "mongo/base/status.h"
+#include "mongo/logger/message_log_domain.h"
+
+namespace mongo {
+namespace logger {
+
+    /**
+     * Appender decorator that decouples callers from the write: append()
+     * copies the event into a bounded in-memory queue and returns, and a
+     * dedicated writer thread replays the events against the wrapped
+     * appender.  A stalled disk therefore no longer stalls the threads doing
+     * the logging - the failure mode becomes dropped log lines (counted, and
+     * reported in-stream once the writer catches up) rather than a
+     * server-wide pileup on the log mutex.
+     *
+     * Events at Error severity and above are flushed synchronously: they are
+     * queued (preserving order) and then append() waits for the queue to
+     * drain, so fatal output still reaches the log before the process dies.
+     */
+    class AsyncMessageAppender : public MessageLogDomain::EventAppender {
+        MONGO_DISALLOW_COPYING(AsyncMessageAppender);
+
+    public:
+        /**
+         * Takes ownership of "wrapped".  "maxQueueBytes" bounds the memory
+         * held by queued events; once exceeded, further events are dropped.
+         */
+        explicit AsyncMessageAppender(MessageLogDomain::EventAppender* wrapped,
+                                      size_t maxQueueBytes = 16 * 1024 * 1024);
+        virtual ~AsyncMessageAppender();
+
+        virtual Status append(const MessageEventEphemeral& event);
+
+        /**
+         * Blocks until every event queued before the call has been handed to
+         * the wrapped appender.
+         */
+        void flush();
+
+    private:
+        // a durable copy of a MessageEventEphemeral, which itself only
+        // references the caller's transient buffers
+        struct QueuedEvent {
+            Date_t date;
+            LogSeverity severity;
+            std::string contextName;
+            std::string message;
+
+            QueuedEvent() : severity(LogSeverity::Log()) {}
+        };
+
+        void _writerLoop();
+
+        boost::scoped_ptr<MessageLogDomain::EventAppender> _wrapped;
+        const size_t _maxQueueBytes;
+
+        boost::mutex _mutex;                 // guards everything below
+        boost::condition_variable _newEvent;
+        boost::condition_variable _drained;
+        std::deque<QueuedEvent> _queue;
+        size_t _queueBytes;
+        long long _dropped;                  // since last in-stream report
+        bool _writing;                       // writer holds events it popped
+        bool _shutdown;
+
+        boost::thread _writer;
+    };
+
+}  // namespace logger
+}  // namespace mongo
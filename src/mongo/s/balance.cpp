@@ -30,6 +30,8 @@
 
 #include "mongo/s/balance.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/client/dbclientcursor.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/write_concern.h"
@@ -52,7 +54,10 @@ namespace mongo {
 
     Balancer balancer;
 
-    Balancer::Balancer() : _balancedLastTime(0), _policy( new BalancerPolicy() ) {}
+    Balancer::Balancer()
+        : _balancedLastTime(0),
+          _policy( new BalancerPolicy() ),
+          _loadHistoryMutex( "Balancer::_loadHistoryMutex" ) {}
 
     Balancer::~Balancer() {
     }
@@ -61,80 +66,148 @@ namespace mongo {
                               bool secondaryThrottle,
                               bool waitForDelete)
     {
+        const size_t n = candidateChunks->size();
+        vector<bool> started( n, false );
+        vector<int> moved( n, 0 );
+        size_t remaining = n;
+
+        while ( remaining > 0 ) {
+            // Collect a wave of migrations between pairwise disjoint shard pairs.  A
+            // shard takes part in at most one migration at a time (mongod allows a
+            // single active migration per shard), and two moves within one collection
+            // never run together: the donor side collection lock and the config
+            // commit's version precondition would abort the second one anyway.
+            vector<size_t> wave;
+            set<string> busyShards;
+            set<string> busyNamespaces;
+            for ( size_t i = 0; i < n; i++ ) {
+                if ( started[i] )
+                    continue;
+
+                const CandidateChunk& chunkInfo = *(*candidateChunks)[i];
+                if ( busyShards.count( chunkInfo.from ) ||
+                     busyShards.count( chunkInfo.to ) ||
+                     busyNamespaces.count( chunkInfo.ns ) ) {
+                    continue;
+                }
+
+                busyShards.insert( chunkInfo.from );
+                busyShards.insert( chunkInfo.to );
+                busyNamespaces.insert( chunkInfo.ns );
+                started[i] = true;
+                wave.push_back( i );
+            }
+            verify( ! wave.empty() );
+            remaining -= wave.size();
+
+            if ( wave.size() == 1 ) {
+                _moveChunk( (*candidateChunks)[wave[0]],
+                            secondaryThrottle, waitForDelete, &moved[wave[0]] );
+            }
+            else {
+                LOG(1) << "balancer: issuing " << wave.size() << " migrations in parallel" << endl;
+                vector< shared_ptr<boost::thread> > threads;
+                for ( size_t j = 0; j < wave.size(); j++ ) {
+                    threads.push_back( shared_ptr<boost::thread>(
+                            new boost::thread( boost::bind( &Balancer::_moveChunk,
+                                                            (*candidateChunks)[wave[j]],
+                                                            secondaryThrottle,
+                                                            waitForDelete,
+                                                            &moved[wave[j]] ) ) ) );
+                }
+                for ( size_t j = 0; j < threads.size(); j++ ) {
+                    threads[j]->join();
+                }
+            }
+        }
+
         int movedCount = 0;
+        for ( size_t i = 0; i < n; i++ ) {
+            movedCount += moved[i];
+        }
+        return movedCount;
+    }
+
+    void Balancer::_moveChunk(CandidateChunkPtr candidate,
+                              bool secondaryThrottle,
+                              bool waitForDelete,
+                              int* moved)
+    {
+        const CandidateChunk& chunkInfo = *candidate;
+        *moved = 0;
 
-        for ( vector<CandidateChunkPtr>::const_iterator it = candidateChunks->begin(); it != candidateChunks->end(); ++it ) {
-            const CandidateChunk& chunkInfo = *it->get();
+        // Changes to metadata, borked metadata, and connectivity problems should cause us to
+        // abort this chunk move, but shouldn't cause us to abort the entire round of chunks.
+        // TODO: Handle all these things more cleanly, since they're expected problems
+        try {
 
-            // Changes to metadata, borked metadata, and connectivity problems should cause us to
-            // abort this chunk move, but shouldn't cause us to abort the entire round of chunks.
-            // TODO: Handle all these things more cleanly, since they're expected problems
-            try {
+            DBConfigPtr cfg = grid.getDBConfig( chunkInfo.ns );
+            verify( cfg );
 
-                DBConfigPtr cfg = grid.getDBConfig( chunkInfo.ns );
-                verify( cfg );
+            // NOTE: We purposely do not reload metadata here, since _doBalanceRound already
+            // tried to do so once.
+            ChunkManagerPtr cm = cfg->getChunkManager( chunkInfo.ns );
+            verify( cm );
 
-                // NOTE: We purposely do not reload metadata here, since _doBalanceRound already
-                // tried to do so once.
-                ChunkManagerPtr cm = cfg->getChunkManager( chunkInfo.ns );
+            ChunkPtr c = cm->findIntersectingChunk( chunkInfo.chunk.min );
+            if ( c->getMin().woCompare( chunkInfo.chunk.min ) || c->getMax().woCompare( chunkInfo.chunk.max ) ) {
+                // likely a split happened somewhere
+                cm = cfg->getChunkManager( chunkInfo.ns , true /* reload */);
                 verify( cm );
 
-                ChunkPtr c = cm->findIntersectingChunk( chunkInfo.chunk.min );
+                c = cm->findIntersectingChunk( chunkInfo.chunk.min );
                 if ( c->getMin().woCompare( chunkInfo.chunk.min ) || c->getMax().woCompare( chunkInfo.chunk.max ) ) {
-                    // likely a split happened somewhere
-                    cm = cfg->getChunkManager( chunkInfo.ns , true /* reload */);
-                    verify( cm );
-
-                    c = cm->findIntersectingChunk( chunkInfo.chunk.min );
-                    if ( c->getMin().woCompare( chunkInfo.chunk.min ) || c->getMax().woCompare( chunkInfo.chunk.max ) ) {
-                        log() << "chunk mismatch after reload, ignoring will retry issue " << chunkInfo.chunk.toString() << endl;
-                        continue;
-                    }
-                }
-
-                BSONObj res;
-                if (c->moveAndCommit(Shard::make(chunkInfo.to),
-                                     Chunk::MaxChunkSize,
-                                     secondaryThrottle,
-                                     waitForDelete,
-                                     0, /* maxTimeMS */
-                                     res)) {
-                    movedCount++;
-                    continue;
+                    log() << "chunk mismatch after reload, ignoring will retry issue " << chunkInfo.chunk.toString() << endl;
+                    return;
                 }
+            }
 
-                // the move requires acquiring the collection metadata's lock, which can fail
-                log() << "balancer move failed: " << res << " from: " << chunkInfo.from << " to: " << chunkInfo.to
-                      << " chunk: " << chunkInfo.chunk << endl;
+            BSONObj res;
+            if (c->moveAndCommit(Shard::make(chunkInfo.to),
+                                 Chunk::MaxChunkSize,
+                                 secondaryThrottle,
+                                 waitForDelete,
+                                 0, /* maxTimeMS */
+                                 res)) {
+                *moved = 1;
+                return;
+            }
 
-                if ( res["chunkTooBig"].trueValue() ) {
-                    // reload just to be safe
-                    cm = cfg->getChunkManager( chunkInfo.ns );
-                    verify( cm );
-                    c = cm->findIntersectingChunk( chunkInfo.chunk.min );
+            // the move requires acquiring the collection metadata's lock, which can fail
+            log() << "balancer move failed: " << res << " from: " << chunkInfo.from << " to: " << chunkInfo.to
+                  << " chunk: " << chunkInfo.chunk << endl;
 
-                    log() << "forcing a split because migrate failed for size reasons" << endl;
+            if ( res["chunkTooBig"].trueValue() ) {
+                // reload just to be safe
+                cm = cfg->getChunkManager( chunkInfo.ns );
+                verify( cm );
+                c = cm->findIntersectingChunk( chunkInfo.chunk.min );
 
-                    res = BSONObj();
-                    c->singleSplit( true , res );
-                    log() << "forced split results: " << res << endl;
+                log() << "forcing a split because migrate failed for size reasons" << endl;
 
-                    if ( ! res["ok"].trueValue() ) {
-                        log() << "marking chunk as jumbo: " << c->toString() << endl;
-                        c->markAsJumbo();
-                        // we increment moveCount so we do another round right away
-                        movedCount++;
-                    }
+                res = BSONObj();
+                c->singleSplit( true , res );
+                log() << "forced split results: " << res << endl;
 
+                if ( ! res["ok"].trueValue() ) {
+                    log() << "marking chunk as jumbo: " << c->toString() << endl;
+                    c->markAsJumbo();
+                    // we set moved so we do another round right away
+                    *moved = 1;
                 }
-            }
-            catch( const DBException& ex ) {
-                warning() << "could not move chunk " << chunkInfo.chunk.toString()
-                          << ", continuing balancing round" << causedBy( ex ) << endl;
+
             }
         }
-
-        return movedCount;
+        catch( const DBException& ex ) {
+            warning() << "could not move chunk " << chunkInfo.chunk.toString()
+                      << ", continuing balancing round" << causedBy( ex ) << endl;
+        }
+        catch( const std::exception& ex ) {
+            // we may be called on a thread of our own; letting an exception escape
+            // would terminate the process, not just the balancing round
+            warning() << "could not move chunk " << chunkInfo.chunk.toString()
+                      << ", continuing balancing round" << causedBy( ex ) << endl;
+        }
     }
 
     void Balancer::_ping( bool waiting ) {
@@ -201,7 +274,9 @@ namespace mongo {
         }        
     }
 
-    void Balancer::_doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks ) {
+    void Balancer::_doBalanceRound( DBClientBase& conn,
+                                    vector<CandidateChunkPtr>* candidateChunks,
+                                    BSONArrayBuilder* dryRunReport ) {
         verify( candidateChunks );
 
         //
@@ -256,7 +331,9 @@ namespace mongo {
                                                   s.isDraining(),
                                                   status.hasOpsQueued(),
                                                   s.tags(),
-                                                  status.mongoVersion()
+                                                  status.mongoVersion(),
+                                                  _updateLoadHistory( s.getName(),
+                                                                      status.opsTotal() )
                                                   );
         }
 
@@ -375,11 +452,80 @@ namespace mongo {
                 continue;
             }
 
-            CandidateChunk* p = _policy->balance( ns, status, _balancedLastTime );
-            if ( p ) candidateChunks->push_back( CandidateChunkPtr( p ) );
+            // ask for up to one migration per disjoint (from, to) shard pair, so
+            // _moveChunks can run them in parallel
+            vector<CandidateChunk*> moves;
+            _policy->balanceParallel( ns, status, _balancedLastTime,
+                                      shardInfo.size() / 2, &moves );
+            for ( unsigned i = 0; i < moves.size(); i++ ) {
+                if ( dryRunReport ) {
+                    const CandidateChunk& m = *moves[i];
+                    BSONObjBuilder b( dryRunReport->subobjStart() );
+                    b.append( "ns", m.ns );
+                    b.append( "from", m.from );
+                    b.append( "to", m.to );
+                    b.append( "min", m.chunk.min );
+                    b.append( "max", m.chunk.max );
+                    b.append( "fromChunks", (int)status.numberOfChunksInShard( m.from ) );
+                    b.append( "toChunks", (int)status.numberOfChunksInShard( m.to ) );
+                    if ( status.isLoadAware() ) {
+                        // predicted shift assumes the donor's load spreads evenly
+                        // over its chunks; we have no per-chunk breakdown
+                        unsigned fromChunks = status.numberOfChunksInShard( m.from );
+                        long long fromLoad = status.shardInfo( m.from ).getLoad();
+                        b.append( "fromLoadOpsPerSec", fromLoad );
+                        b.append( "toLoadOpsPerSec", status.shardInfo( m.to ).getLoad() );
+                        b.append( "predictedLoadShiftOpsPerSec",
+                                  fromLoad / (long long)( fromChunks ? fromChunks : 1 ) );
+                    }
+                    b.done();
+                }
+                candidateChunks->push_back( CandidateChunkPtr( moves[i] ) );
+            }
         }
     }
 
+    long long Balancer::_updateLoadHistory( const string& shard, long long opsTotal ) {
+        const time_t now = time( 0 );
+
+        scoped_lock lk( _loadHistoryMutex );
+
+        LoadHistory& hist = _loadHistory[ shard ];
+        const long long prevTotal = hist.opsTotal;
+        const time_t prevTime = hist.sampledAt;
+
+        hist.opsTotal = opsTotal;
+        hist.sampledAt = now;
+
+        if ( prevTime == 0 || now <= prevTime ) {
+            // first sighting of this shard, or samples too close together
+            return -1;
+        }
+
+        if ( opsTotal < prevTotal ) {
+            // counters went backwards: the shard restarted
+            return -1;
+        }
+
+        return ( opsTotal - prevTotal ) / ( now - prevTime );
+    }
+
+    void Balancer::dryRun( BSONObjBuilder& result ) {
+        // same fresh shard state a real round would use
+        Shard::reloadShardInfo();
+
+        ScopedDbConnection conn( configServer.getConnectionString().toString(), 30 );
+
+        vector<CandidateChunkPtr> candidateChunks;
+        BSONArrayBuilder report( result.subarrayStart( "candidateMoves" ) );
+        _doBalanceRound( conn.conn(), &candidateChunks, &report );
+        report.done();
+
+        result.append( "candidateCount", (int)candidateChunks.size() );
+
+        conn.done();
+    }
+
     bool Balancer::_init() {
         try {
 
@@ -44,8 +44,8 @@ namespace mongo {
      * uses a 'DistributedLock' for that coordination.
      *
      * The balancer does act continuously but in "rounds". At a given round, it would decide if there is an imbalance by
-     * checking the difference in chunks between the most and least loaded shards. It would issue a request for a chunk
-     * migration per round, if it found so.
+     * checking the difference in chunks between the most and least loaded shards. It issues migration requests for the
+     * round's candidate chunks, running migrations between disjoint shard pairs in parallel.
      */
     class Balancer : public BackgroundJob {
     public:
@@ -58,6 +58,15 @@ namespace mongo {
 
         virtual string name() const { return "Balancer"; }
 
+        /**
+         * Runs the information-gathering and policy half of a balancing round
+         * without migrating anything, and reports the migrations the policy
+         * would request right now together with the chunk counts and load
+         * metrics behind each pick.  Backs the "balancerDryRun" command; safe
+         * to call from a command thread while the balancer itself is running.
+         */
+        void dryRun( BSONObjBuilder& result );
+
     private:
         typedef MigrateInfo CandidateChunk;
         typedef shared_ptr<CandidateChunk> CandidateChunkPtr;
@@ -73,7 +82,30 @@ namespace mongo {
 
         // decide which chunks to move; owned here.
         scoped_ptr<BalancerPolicy> _policy;
-        
+
+        // last seen opcounter totals per shard, diffed between rounds to turn
+        // serverStatus counters into an ops/sec load figure for the policy;
+        // guarded by a mutex because the balancerDryRun command samples from
+        // its own thread
+        struct LoadHistory {
+            LoadHistory() : opsTotal( 0 ), sampledAt( 0 ) {}
+            long long opsTotal;
+            time_t sampledAt;
+        };
+        mongo::mutex _loadHistoryMutex;
+        map<string,LoadHistory> _loadHistory;
+
+        /**
+         * Records 'opsTotal' for 'shard' and diffs it against the previous
+         * sample.
+         *
+         * @return ops/sec on the shard since the last sample, or -1 if unknown
+         *         (first sighting, or the counters went backwards because the
+         *         shard restarted)
+         */
+        long long _updateLoadHistory( const string& shard, long long opsTotal );
+
+
         /**
          * Checks that the balancer can connect to all servers it needs to do its job.
          *
@@ -88,12 +120,20 @@ namespace mongo {
          * be moved.
          *
          * @param conn is the connection with the config server(s)
-         * @param candidateChunks (IN/OUT) filled with candidate chunks, one per collection, that could possibly be moved
+         * @param candidateChunks (IN/OUT) filled with candidate chunks, up to one per disjoint
+         *        (from, to) shard pair per collection, that could possibly be moved
+         * @param dryRunReport if non-NULL, a document describing each candidate move and its
+         *        predicted impact is appended to it (for the balancerDryRun command)
          */
-        void _doBalanceRound( DBClientBase& conn, vector<CandidateChunkPtr>* candidateChunks );
+        void _doBalanceRound( DBClientBase& conn,
+                              vector<CandidateChunkPtr>* candidateChunks,
+                              BSONArrayBuilder* dryRunReport = NULL );
 
         /**
-         * Issues chunk migration request, one at a time.
+         * Issues the chunk migration requests, running migrations between pairwise
+         * disjoint shard pairs in parallel.  A shard participates in at most one
+         * migration at a time, and two migrations within the same collection never
+         * run concurrently (the migration protocol serializes them per collection).
          *
          * @param candidateChunks possible chunks to move
          * @param secondaryThrottle wait for secondaries to catch up before pushing more deletes
@@ -104,6 +144,17 @@ namespace mongo {
                         bool secondaryThrottle,
                         bool waitForDelete);
 
+        /**
+         * Runs a single migration recommended by the policy; thread entry point for
+         * the parallel waves of _moveChunks.  *moved is set to 1 if the migration
+         * counted as a move (it succeeded, or it forced a jumbo split and wants
+         * another round right away), else to 0.
+         */
+        static void _moveChunk(CandidateChunkPtr chunkInfo,
+                               bool secondaryThrottle,
+                               bool waitForDelete,
+                               int* moved);
+
         /**
          * Marks this balancer as being live on the config server(s).
          */
@@ -47,8 +47,11 @@ namespace mongo {
                                             const ShardToChunksMap& shardToChunksMap )
         : _shardInfo( shardInfo ), _shardChunks( shardToChunksMap ) {
 
+        _loadAware = ! _shardInfo.empty();
         for ( ShardInfoMap::const_iterator i = _shardInfo.begin(); i != _shardInfo.end(); ++i ) {
             _shards.insert( i->first );
+            if ( ! i->second.hasLoadMetric() )
+                _loadAware = false;
         }
     }
 
@@ -86,10 +89,21 @@ namespace mongo {
     }
 
     string DistributionStatus::getBestReceieverShard( const string& tag ) const {
+        return getBestReceieverShard( tag, set<string>() );
+    }
+
+    string DistributionStatus::getBestReceieverShard( const string& tag,
+                                                      const set<string>& excluded ) const {
         string best;
         unsigned minChunks = numeric_limits<unsigned>::max();
+        long long minLoad = numeric_limits<long long>::max();
 
         for ( ShardInfoMap::const_iterator i = _shardInfo.begin(); i != _shardInfo.end(); ++i ) {
+            if ( excluded.count( i->first ) ) {
+                LOG(1) << i->first << " is excluded from this pick." << endl;
+                continue;
+            }
+
             if ( i->second.isSizeMaxed() ) {
                 LOG(1) << i->first << " has already reached the maximum total chunk size." << endl;
                 continue;
@@ -111,7 +125,17 @@ namespace mongo {
             }
 
             unsigned myChunks = numberOfChunksInShard( i->first );
-            if ( myChunks >= minChunks ) {
+            if ( _loadAware ) {
+                // load is the primary key, chunk count breaks ties
+                long long myLoad = i->second.getLoad();
+                if ( myLoad > minLoad || ( myLoad == minLoad && myChunks >= minChunks ) ) {
+                    LOG(1) << i->first << " is more loaded me:" << myLoad << "/" << myChunks
+                           << " best: " << best << ":" << minLoad << "/" << minChunks << endl;
+                    continue;
+                }
+                minLoad = myLoad;
+            }
+            else if ( myChunks >= minChunks ) {
                 LOG(1) << i->first << " has more chunks me:" << myChunks << " best: " << best << ":" << minChunks << endl;
                 continue;
             }
@@ -124,18 +148,39 @@ namespace mongo {
     }
 
     string DistributionStatus::getMostOverloadedShard( const string& tag ) const {
+        return getMostOverloadedShard( tag, set<string>() );
+    }
+
+    string DistributionStatus::getMostOverloadedShard( const string& tag,
+                                                       const set<string>& excluded ) const {
         string worst;
         unsigned maxChunks = 0;
+        long long maxLoad = -1;
 
         for ( ShardInfoMap::const_iterator i = _shardInfo.begin(); i != _shardInfo.end(); ++i ) {
 
+            if ( excluded.count( i->first ) ) {
+                continue;
+            }
+
             if ( i->second.hasOpsQueued() ) {
                 // we can't move stuff off anyway
                 continue;
             }
 
             unsigned myChunks = numberOfChunksInShardWithTag( i->first, tag );
-            if ( myChunks <= maxChunks )
+            if ( _loadAware ) {
+                // load is the primary key, chunk count breaks ties; a shard
+                // with nothing to donate for this tag is never a donor, no
+                // matter how hot it is
+                if ( myChunks == 0 )
+                    continue;
+                long long myLoad = i->second.getLoad();
+                if ( myLoad < maxLoad || ( myLoad == maxLoad && myChunks <= maxChunks ) )
+                    continue;
+                maxLoad = myLoad;
+            }
+            else if ( myChunks <= maxChunks )
                 continue;
 
             worst = i->first;
@@ -234,6 +279,29 @@ namespace mongo {
     MigrateInfo* BalancerPolicy::balance( const string& ns,
                                           const DistributionStatus& distribution,
                                           int balancedLastTime ) {
+        return _balanceOne( ns, distribution, balancedLastTime, set<string>() );
+    }
+
+    void BalancerPolicy::balanceParallel( const string& ns,
+                                          const DistributionStatus& distribution,
+                                          int balancedLastTime,
+                                          unsigned maxMoves,
+                                          vector<MigrateInfo*>* moves ) {
+        set<string> usedShards;
+        for ( unsigned i = 0; i < maxMoves; i++ ) {
+            MigrateInfo* m = _balanceOne( ns, distribution, balancedLastTime, usedShards );
+            if ( ! m )
+                break;
+            moves->push_back( m );
+            usedShards.insert( m->from );
+            usedShards.insert( m->to );
+        }
+    }
+
+    MigrateInfo* BalancerPolicy::_balanceOne( const string& ns,
+                                              const DistributionStatus& distribution,
+                                              int balancedLastTime,
+                                              const set<string>& usedShards ) {
 
 
         // 1) check for shards that policy require to us to move off of:
@@ -248,6 +316,9 @@ namespace mongo {
             const set<string>& shards = distribution.shards();
             for ( set<string>::const_iterator z = shards.begin(); z != shards.end(); ++z ) {
                 string shard = *z;
+                if ( usedShards.count( shard ) )
+                    continue;
+
                 const ShardInfo& info = distribution.shardInfo( shard );
 
                 if ( ! info.isDraining() )
@@ -276,7 +347,7 @@ namespace mongo {
                     }
 
                     string tag = distribution.getTagForChunk( chunkToMove );
-                    string to = distribution.getBestReceieverShard( tag );
+                    string to = distribution.getBestReceieverShard( tag, usedShards );
 
                     if ( to.size() == 0 ) {
                         warning() << "want to move chunk: " << chunkToMove << "(" << tag << ") "
@@ -302,6 +373,9 @@ namespace mongo {
 
             for ( set<string>::const_iterator i = shards.begin(); i != shards.end(); ++i ) {
                 string shard = *i;
+                if ( usedShards.count( shard ) )
+                    continue;
+
                 const ShardInfo& info = distribution.shardInfo( shard );
 
                 const vector<BSONObj>& chunks = distribution.getChunks( shard );
@@ -321,7 +395,7 @@ namespace mongo {
                         continue;
                     }
 
-                    string to = distribution.getBestReceieverShard( tag );
+                    string to = distribution.getBestReceieverShard( tag, usedShards );
                     if ( to.size() == 0 ) {
                         log() << "no where to put it :(" << endl;
                         continue;
@@ -356,7 +430,7 @@ namespace mongo {
         for ( unsigned i=0; i<tags.size(); i++ ) {
             string tag = tags[i];
 
-            string from = distribution.getMostOverloadedShard( tag );
+            string from = distribution.getMostOverloadedShard( tag, usedShards );
             if ( from.size() == 0 )
                 continue;
 
@@ -364,7 +438,7 @@ namespace mongo {
             if ( max == 0 )
                 continue;
 
-            string to = distribution.getBestReceieverShard( tag );
+            string to = distribution.getBestReceieverShard( tag, usedShards );
             if ( to.size() == 0 ) {
                 log() << "no available shards to take chunks for tag [" << tag << "]" << endl;
                 return NULL;
@@ -379,7 +453,34 @@ namespace mongo {
             LOG(1) << "receiver   : " << to << " chunks on " << min << endl;
             LOG(1) << "threshold  : " << threshold << endl;
 
-            if ( imbalance < threshold )
+            bool shouldMove = imbalance >= threshold;
+
+            if ( ! shouldMove && distribution.isLoadAware() ) {
+                // chunk counts look even, but a big enough load gap still
+                // justifies a move.  We only know per-shard load, so credit the
+                // chunk with the donor's average per-chunk share, and move only
+                // when that strictly narrows the gap -- afterwards the gap is
+                // (gap - 2 * perChunk), so requiring gap > perChunk leaves it
+                // smaller in absolute value and the next round can't just move
+                // the load straight back.
+                const long long fromLoad = distribution.shardInfo( from ).getLoad();
+                const long long toLoad = distribution.shardInfo( to ).getLoad();
+                const unsigned fromChunks = distribution.numberOfChunksInShard( from );
+                const long long perChunk = fromLoad / ( fromChunks ? fromChunks : 1 );
+
+                LOG(1) << "donor load    : " << fromLoad << " ops/sec" << endl;
+                LOG(1) << "receiver load : " << toLoad << " ops/sec" << endl;
+
+                if ( fromLoad - toLoad > perChunk ) {
+                    log() << "ns: " << ns << " load gap " << fromLoad - toLoad
+                          << " ops/sec between " << from << " and " << to
+                          << " (~" << perChunk << " ops/sec per chunk) justifies a move"
+                          << " despite even chunk counts" << endl;
+                    shouldMove = true;
+                }
+            }
+
+            if ( ! shouldMove )
                 continue;
 
             const vector<BSONObj>& chunks = distribution.getChunks( from );
@@ -417,21 +518,24 @@ namespace mongo {
 
     ShardInfo::ShardInfo( long long maxSize, long long currSize,
                           bool draining, bool opsQueued,
-                          const set<string>& tags, 
-                          const string& mongoVersion )
+                          const set<string>& tags,
+                          const string& mongoVersion,
+                          long long loadOpsPerSec )
         : _maxSize( maxSize ),
           _currSize( currSize ),
           _draining( draining ),
           _hasOpsQueued( opsQueued ),
           _tags( tags ),
-          _mongoVersion( mongoVersion ) {
+          _mongoVersion( mongoVersion ),
+          _loadOpsPerSec( loadOpsPerSec ) {
     }
 
     ShardInfo::ShardInfo()
         : _maxSize( 0 ),
           _currSize( 0 ),
           _draining( false ),
-          _hasOpsQueued( false ) {
+          _hasOpsQueued( false ),
+          _loadOpsPerSec( -1 ) {
     }
 
     void ShardInfo::addTag( const string& tag ) {
@@ -458,6 +562,8 @@ namespace mongo {
         ss << " currSize: " << _currSize;
         ss << " draining: " << _draining;
         ss << " hasOpsQueued: " << _hasOpsQueued;
+        if ( hasLoadMetric() )
+            ss << " loadOpsPerSec: " << _loadOpsPerSec;
         if ( _tags.size() > 0 ) {
             ss << "tags : ";
             for ( set<string>::const_iterator i = _tags.begin(); i != _tags.end(); ++i )
@@ -67,10 +67,11 @@ namespace mongo {
     class ShardInfo {
     public:
         ShardInfo();
-        ShardInfo( long long maxSize, long long currSize, 
-                   bool draining, bool opsQueued, 
+        ShardInfo( long long maxSize, long long currSize,
+                   bool draining, bool opsQueued,
                    const set<string>& tags = set<string>(),
-                   const string& _mongoVersion = string("") );
+                   const string& _mongoVersion = string(""),
+                   long long loadOpsPerSec = -1 );
 
         void addTag( const string& tag );
 
@@ -99,6 +100,16 @@ namespace mongo {
 
         long long getCurrSize() const { return _currSize; }
 
+        /**
+         * @return true if we have a recent load measurement (ops/sec from the
+         *         shard's opcounters) for this shard; the metric is absent on
+         *         the balancer's first round and for unresponsive shards
+         */
+        bool hasLoadMetric() const { return _loadOpsPerSec >= 0; }
+
+        /** ops/sec on this shard since the last balancing round; -1 if unknown */
+        long long getLoad() const { return _loadOpsPerSec; }
+
         string getMongoVersion() const { return _mongoVersion; }
 
         string toString() const;
@@ -110,6 +121,7 @@ namespace mongo {
         bool _hasOpsQueued;
         set<string> _tags;
         string _mongoVersion;
+        long long _loadOpsPerSec;
     };
     
     struct MigrateInfo {
@@ -147,12 +159,21 @@ namespace mongo {
          */
         string getBestReceieverShard( const string& forTag ) const;
 
+        /**
+         * @param excluded shards that must not be picked, e.g. because they already
+         *        participate in another move being scheduled
+         */
+        string getBestReceieverShard( const string& forTag, const set<string>& excluded ) const;
+
         /**
          * @return the shard with the most chunks
          *         based on # of chunks with the given tag
          */
         string getMostOverloadedShard( const string& forTag ) const;
 
+        /** as above, but never picks a shard in excluded */
+        string getMostOverloadedShard( const string& forTag, const set<string>& excluded ) const;
+
 
         // ---- basic accessors, counters, etc...
 
@@ -179,6 +200,14 @@ namespace mongo {
 
         /** @return the ShardInfo for the shard */
         const ShardInfo& shardInfo( const string& shard ) const;
+
+        /**
+         * @return true if every shard reports a load metric, in which case the
+         *         picks above order primarily by load with chunk count as the
+         *         tiebreaker; with any metric missing (mixed versions, first
+         *         round) we fall back to chunk counts alone
+         */
+        bool isLoadAware() const { return _loadAware; }
         
         /** writes all state to log() */
         void dump() const;
@@ -189,6 +218,7 @@ namespace mongo {
         map<BSONObj,TagRange> _tagRanges;
         set<string> _allTags;
         set<string> _shards;
+        bool _loadAware;
     };
 
     class BalancerPolicy {
@@ -209,7 +239,26 @@ namespace mongo {
                                      const DistributionStatus& distribution,
                                      int balancedLastTime );
 
+        /**
+         * As balance(), but appends to *moves up to maxMoves suggested migrations whose
+         * source and destination shards are pairwise disjoint, so the caller may run
+         * them concurrently.  Chunk counts are not adjusted between picks; because the
+         * pairs are disjoint, each suggestion is justified by the distribution on its
+         * own two shards alone.  Caller owns the appended MigrateInfo instances.
+         */
+        static void balanceParallel( const string& ns,
+                                     const DistributionStatus& distribution,
+                                     int balancedLastTime,
+                                     unsigned maxMoves,
+                                     vector<MigrateInfo*>* moves );
+
     private:
+        /** single balance() pick, never involving a shard in usedShards */
+        static MigrateInfo* _balanceOne( const string& ns,
+                                         const DistributionStatus& distribution,
+                                         int balancedLastTime,
+                                         const set<string>& usedShards );
+
         static bool _isJumbo( const BSONObj& chunk );
     };
 
@@ -52,6 +52,118 @@ namespace mongo {
             ASSERT( c );
         }
 
+        TEST( BalancerPolicyTests , BalanceParallelDisjointPairsTest ) {
+            // two overloaded and two empty shards; expect a move per disjoint shard pair
+            ShardToChunksMap chunkMap;
+            vector<BSONObj> chunks;
+            for ( int i = 0; i < 4; i++ ) {
+                chunks.push_back(BSON(ChunkType::min(BSON("x" << i * 10)) <<
+                                      ChunkType::max(BSON("x" << i * 10 + 10))));
+            }
+            chunkMap["shard0"] = chunks;
+            chunkMap["shard2"] = chunks;
+            chunks.clear();
+            chunkMap["shard1"] = chunks;
+            chunkMap["shard3"] = chunks;
+
+            // no limits
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo( 0, 4, false, false );
+            info["shard1"] = ShardInfo( 0, 0, false, false );
+            info["shard2"] = ShardInfo( 0, 4, false, false );
+            info["shard3"] = ShardInfo( 0, 0, false, false );
+
+            DistributionStatus status( info, chunkMap );
+            vector<MigrateInfo*> moves;
+            BalancerPolicy::balanceParallel( "ns", status, 1, 2, &moves );
+            ASSERT_EQUALS( 2U, moves.size() );
+
+            // no shard appears in more than one suggested migration
+            set<string> used;
+            for ( unsigned i = 0; i < moves.size(); i++ ) {
+                ASSERT( used.insert( moves[i]->from ).second );
+                ASSERT( used.insert( moves[i]->to ).second );
+            }
+        }
+
+
+        TEST( BalancerPolicyTests , BalanceLoadAwareEvenChunksTest ) {
+            // chunk counts are even but shard0 is far hotter; expect a load-driven move
+            ShardToChunksMap chunkMap;
+            vector<BSONObj> chunks;
+            chunks.push_back(BSON(ChunkType::min(BSON("x" << 0)) <<
+                                  ChunkType::max(BSON("x" << 10))));
+            chunks.push_back(BSON(ChunkType::min(BSON("x" << 10)) <<
+                                  ChunkType::max(BSON("x" << 20))));
+            chunkMap["shard0"] = chunks;
+            chunks.clear();
+            chunks.push_back(BSON(ChunkType::min(BSON("x" << 20)) <<
+                                  ChunkType::max(BSON("x" << 30))));
+            chunks.push_back(BSON(ChunkType::min(BSON("x" << 30)) <<
+                                  ChunkType::max(BSON("x" << 40))));
+            chunkMap["shard1"] = chunks;
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo( 0, 2, false, false, set<string>(), "", 1000 );
+            info["shard1"] = ShardInfo( 0, 2, false, false, set<string>(), "", 10 );
+
+            DistributionStatus status( info, chunkMap );
+            ASSERT( status.isLoadAware() );
+
+            MigrateInfo* c = BalancerPolicy::balance( "ns", status, 1 );
+            ASSERT( c );
+            ASSERT_EQUALS( "shard0", c->from );
+            ASSERT_EQUALS( "shard1", c->to );
+        }
+
+        TEST( BalancerPolicyTests , BalanceLoadAwareSmallGapTest ) {
+            // a load gap smaller than one chunk's average share must not cause a move,
+            // otherwise consecutive rounds would just bounce the chunk back and forth
+            ShardToChunksMap chunkMap;
+            vector<BSONObj> chunks;
+            chunks.push_back(BSON(ChunkType::min(BSON("x" << 0)) <<
+                                  ChunkType::max(BSON("x" << 10))));
+            chunks.push_back(BSON(ChunkType::min(BSON("x" << 10)) <<
+                                  ChunkType::max(BSON("x" << 20))));
+            chunkMap["shard0"] = chunks;
+            chunks.clear();
+            chunks.push_back(BSON(ChunkType::min(BSON("x" << 20)) <<
+                                  ChunkType::max(BSON("x" << 30))));
+            chunks.push_back(BSON(ChunkType::min(BSON("x" << 30)) <<
+                                  ChunkType::max(BSON("x" << 40))));
+            chunkMap["shard1"] = chunks;
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo( 0, 2, false, false, set<string>(), "", 100 );
+            info["shard1"] = ShardInfo( 0, 2, false, false, set<string>(), "", 80 );
+
+            DistributionStatus status( info, chunkMap );
+            MigrateInfo* c = BalancerPolicy::balance( "ns", status, 1 );
+            ASSERT( ! c );
+        }
+
+        TEST( BalancerPolicyTests , BalanceLoadUnknownFallsBackTest ) {
+            // with any shard missing a load metric the policy must ignore load entirely
+            ShardToChunksMap chunkMap;
+            vector<BSONObj> chunks;
+            chunks.push_back(BSON(ChunkType::min(BSON("x" << 0)) <<
+                                  ChunkType::max(BSON("x" << 10))));
+            chunkMap["shard0"] = chunks;
+            chunks.clear();
+            chunks.push_back(BSON(ChunkType::min(BSON("x" << 10)) <<
+                                  ChunkType::max(BSON("x" << 20))));
+            chunkMap["shard1"] = chunks;
+
+            ShardInfoMap info;
+            info["shard0"] = ShardInfo( 0, 1, false, false, set<string>(), "", 1000 );
+            info["shard1"] = ShardInfo( 0, 1, false, false );
+
+            DistributionStatus status( info, chunkMap );
+            ASSERT( ! status.isLoadAware() );
+
+            MigrateInfo* c = BalancerPolicy::balance( "ns", status, 1 );
+            ASSERT( ! c );
+        }
 
         TEST( BalancerPolicyTests , BalanceJumbo  ) {
             // 2 chunks and 0 chunk shards
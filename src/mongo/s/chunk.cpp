@@ -72,8 +72,8 @@ namespace mongo {
     // Can be overridden from command line
     bool Chunk::ShouldAutoSplit = true;
 
-    Chunk::Chunk(const ChunkManager * manager, BSONObj from)
-        : _manager(manager), _lastmod(0, OID()), _dataWritten(mkDataWritten())
+    Chunk::Chunk(const ShardedCollectionInfoPtr& info, BSONObj from)
+        : _info(info), _lastmod(0, OID()), _dataWritten(mkDataWritten())
     {
         string ns = from.getStringField(ChunkType::ns().c_str());
         _shard.reset(from.getStringField(ChunkType::shard().c_str()));
@@ -87,7 +87,7 @@ namespace mongo {
         _jumbo = from[ChunkType::jumbo()].trueValue();
 
         uassert( 10170 ,  "Chunk needs a ns" , ! ns.empty() );
-        uassert( 13327 ,  "Chunk ns must match server ns" , ns == _manager->getns() );
+        uassert( 13327 ,  "Chunk ns must match server ns" , ns == _info->getns() );
 
         uassert( 10171 ,  "Chunk needs a server" , _shard.ok() );
 
@@ -95,18 +95,18 @@ namespace mongo {
         uassert( 10173 ,  "Chunk needs a max" , ! _max.isEmpty() );
     }
 
-    Chunk::Chunk(const ChunkManager * info , const BSONObj& min, const BSONObj& max, const Shard& shard, ChunkVersion lastmod)
-        : _manager(info), _min(min), _max(max), _shard(shard), _lastmod(lastmod), _jumbo(false), _dataWritten(mkDataWritten())
+    Chunk::Chunk(const ShardedCollectionInfoPtr& info , const BSONObj& min, const BSONObj& max, const Shard& shard, ChunkVersion lastmod)
+        : _info(info), _min(min), _max(max), _shard(shard), _lastmod(lastmod), _jumbo(false), _dataWritten(mkDataWritten())
     {}
 
     int Chunk::mkDataWritten() {
         PseudoRandom r(static_cast<int64_t>(time(0)));
-        return r.nextInt32( MaxChunkSize / ChunkManager::SplitHeuristics::splitTestFactor );
+        return r.nextInt32( MaxChunkSize / ShardedCollectionInfo::SplitHeuristics::splitTestFactor );
     }
 
     string Chunk::getns() const {
-        verify( _manager );
-        return _manager->getns();
+        verify( _info );
+        return _info->getns();
     }
 
     bool Chunk::containsPoint( const BSONObj& point ) const {
@@ -119,23 +119,23 @@ namespace mongo {
     }
 
     bool Chunk::minIsInf() const {
-        return _manager->getShardKey().globalMin().woCompare( getMin() ) == 0;
+        return _info->getShardKey().globalMin().woCompare( getMin() ) == 0;
     }
 
     bool Chunk::maxIsInf() const {
-        return _manager->getShardKey().globalMax().woCompare( getMax() ) == 0;
+        return _info->getShardKey().globalMax().woCompare( getMax() ) == 0;
     }
 
     BSONObj Chunk::_getExtremeKey( int sort ) const {
         Query q;
         if ( sort == 1 ) {
-            q.sort( _manager->getShardKey().key() );
+            q.sort( _info->getShardKey().key() );
         }
         else {
             // need to invert shard key pattern to sort backwards
             // TODO: make a helper in ShardKeyPattern?
 
-            BSONObj k = _manager->getShardKey().key();
+            BSONObj k = _info->getShardKey().key();
             BSONObjBuilder r;
 
             BSONObjIterator i(k);
@@ -149,11 +149,11 @@ namespace mongo {
         }
         // find the extreme key
         ScopedDbConnection conn(getShard().getConnString());
-        BSONObj end = conn->findOne(_manager->getns(), q);
+        BSONObj end = conn->findOne(_info->getns(), q);
         conn.done();
         if ( end.isEmpty() )
             return BSONObj();
-        return _manager->getShardKey().extractKey( end );
+        return _info->getShardKey().extractKey( end );
     }
 
     void Chunk::pickMedianKey( BSONObj& medianKey ) const {
@@ -161,8 +161,8 @@ namespace mongo {
         ScopedDbConnection conn(getShard().getConnString());
         BSONObj result;
         BSONObjBuilder cmd;
-        cmd.append( "splitVector" , _manager->getns() );
-        cmd.append( "keyPattern" , _manager->getShardKey().key() );
+        cmd.append( "splitVector" , _info->getns() );
+        cmd.append( "keyPattern" , _info->getShardKey().key() );
         cmd.append( "min" , getMin() );
         cmd.append( "max" , getMax() );
         cmd.appendBool( "force" , true );
@@ -188,8 +188,8 @@ namespace mongo {
         ScopedDbConnection conn(getShard().getConnString());
         BSONObj result;
         BSONObjBuilder cmd;
-        cmd.append( "splitVector" , _manager->getns() );
-        cmd.append( "keyPattern" , _manager->getShardKey().key() );
+        cmd.append( "splitVector" , _info->getns() );
+        cmd.append( "keyPattern" , _info->getShardKey().key() );
         cmd.append( "min" , getMin() );
         cmd.append( "max" , getMax() );
         cmd.append( "maxChunkSizeBytes" , chunkSize );
@@ -220,7 +220,7 @@ namespace mongo {
         if ( ! force ) {
             vector<BSONObj> candidates;
             const int maxPoints = 2;
-            pickSplitVector( candidates , getManager()->getCurrentDesiredChunkSize() , maxPoints , MaxObjectPerChunk );
+            pickSplitVector( candidates , _info->getCurrentDesiredChunkSize() , maxPoints , MaxObjectPerChunk );
             if ( candidates.size() <= 1 ) {
                 // no split points means there isn't enough data to split on
                 // 1 split point means we have between half the chunk size to full chunk size
@@ -281,7 +281,7 @@ namespace mongo {
     bool Chunk::multiSplit( const vector<BSONObj>& m , BSONObj& res ) const {
         const size_t maxSplitPoints = 8192;
 
-        uassert( 10165 , "can't split as shard doesn't have a manager" , _manager );
+        uassert( 10165 , "can't split as shard doesn't have a manager" , _info );
         uassert( 13332 , "need a split key to split chunk" , !m.empty() );
         uassert( 13333 , "can't split a chunk in that many parts", m.size() < maxSplitPoints );
         uassert( 13003 , "can't split a chunk with only one distinct value" , _min.woCompare(_max) );
@@ -289,8 +289,8 @@ namespace mongo {
         ScopedDbConnection conn(getShard().getConnString());
 
         BSONObjBuilder cmd;
-        cmd.append( "splitChunk" , _manager->getns() );
-        cmd.append( "keyPattern" , _manager->getShardKey().key() );
+        cmd.append( "splitChunk" , _info->getns() );
+        cmd.append( "keyPattern" , _info->getShardKey().key() );
         cmd.append( "min" , getMin() );
         cmd.append( "max" , getMax() );
         cmd.append( "from" , getShard().getName() );
@@ -304,15 +304,15 @@ namespace mongo {
             conn.done();
 
             // Mark the minor version for *eventual* reload
-            _manager->markMinorForReload( this->_lastmod );
+            _info->markMinorForReload( this->_lastmod );
 
             return false;
         }
 
         conn.done();
-        
+
         // force reload of config
-        _manager->reload();
+        grid.getDBConfig( getns() )->getChunkManager( getns(), true );
 
         return true;
     }
@@ -326,14 +326,14 @@ namespace mongo {
     {
         uassert( 10167 ,  "can't move shard to its current location!" , getShard() != to );
 
-        log() << "moving chunk ns: " << _manager->getns() << " moving ( " << toString() << ") " << _shard.toString() << " -> " << to.toString() << endl;
+        log() << "moving chunk ns: " << _info->getns() << " moving ( " << toString() << ") " << _shard.toString() << " -> " << to.toString() << endl;
 
         Shard from = _shard;
 
         ScopedDbConnection fromconn(from.getConnString());
 
         bool worked = fromconn->runCommand( "admin" ,
-                                            BSON( "moveChunk" << _manager->getns() <<
+                                            BSON( "moveChunk" << _info->getns() <<
                                                   "from" << from.getAddress().toString() <<
                                                   "to" << to.getAddress().toString() <<
                                                   // NEEDED FOR 2.0 COMPATIBILITY
@@ -357,7 +357,7 @@ namespace mongo {
         // if succeeded, needs to reload to pick up the new location
         // if failed, mongos may be stale
         // reload is excessive here as the failure could be simply because collection metadata is taken
-        _manager->reload();
+        grid.getDBConfig( getns() )->getChunkManager( getns(), true );
 
         return worked;
     }
@@ -368,19 +368,19 @@ namespace mongo {
 
         try {
             _dataWritten += dataWritten;
-            int splitThreshold = getManager()->getCurrentDesiredChunkSize();
+            int splitThreshold = _info->getCurrentDesiredChunkSize();
             if ( minIsInf() || maxIsInf() ) {
                 splitThreshold = (int) ((double)splitThreshold * .9);
             }
 
-            if ( _dataWritten < splitThreshold / ChunkManager::SplitHeuristics::splitTestFactor )
+            if ( _dataWritten < splitThreshold / ShardedCollectionInfo::SplitHeuristics::splitTestFactor )
                 return false;
-            
-            if ( ! getManager()->_splitHeuristics._splitTickets.tryAcquire() ) {
-                LOG(1) << "won't auto split because not enough tickets: " << getManager()->getns() << endl;
+
+            if ( ! _info->_splitHeuristics._splitTickets.tryAcquire() ) {
+                LOG(1) << "won't auto split because not enough tickets: " << getns() << endl;
                 return false;
             }
-            TicketHolderReleaser releaser( &(getManager()->_splitHeuristics._splitTickets) );
+            TicketHolderReleaser releaser( &(_info->_splitHeuristics._splitTickets) );
 
             // this is a bit ugly
             // we need it so that mongos blocks for the writes to actually be committed
@@ -412,9 +412,9 @@ namespace mongo {
                 _dataWritten = 0; // we're splitting, so should wait a bit
             }
 
-            bool shouldBalance = grid.shouldBalance( _manager->getns() );
+            bool shouldBalance = grid.shouldBalance( _info->getns() );
 
-            log() << "autosplitted " << _manager->getns() << " shard: " << toString()
+            log() << "autosplitted " << _info->getns() << " shard: " << toString()
                   << " on: " << splitPoint << " (splitThreshold " << splitThreshold << ")"
 #ifdef _DEBUG
                   << " size: " << getPhysicalSize() // slow - but can be useful when debugging
@@ -438,7 +438,8 @@ namespace mongo {
                     return true; // we did split even if we didn't migrate
                 }
 
-                ChunkManagerPtr cm = _manager->reload(false/*just reloaded in mulitsplit*/);
+                ChunkManagerPtr cm = grid.getDBConfig( getns() )->getChunkManager( getns(),
+                                         false/*just reloaded in mulitsplit*/);
                 ChunkPtr toMove = cm->findIntersectingChunk(min);
 
                 if ( ! (toMove->getMin() == min && toMove->getMax() == max) ){
@@ -459,7 +460,7 @@ namespace mongo {
                                                 res ) );
                 
                 // update our config
-                _manager->reload();
+                grid.getDBConfig( getns() )->getChunkManager( getns(), true );
             }
 
             return true;
@@ -472,7 +473,7 @@ namespace mongo {
             _dataWritten = mkDataWritten();
 
             // if the collection lock is taken (e.g. we're migrating), it is fine for the split to fail.
-            warning() << "could not autosplit collection " << _manager->getns() << causedBy( e ) << endl;
+            warning() << "could not autosplit collection " << _info->getns() << causedBy( e ) << endl;
             return false;
         }
     }
@@ -482,8 +483,8 @@ namespace mongo {
 
         BSONObj result;
         uassert( 10169 ,  "datasize failed!" , conn->runCommand( "admin" ,
-                 BSON( "datasize" << _manager->getns()
-                       << "keyPattern" << _manager->getShardKey().key()
+                 BSON( "datasize" << _info->getns()
+                       << "keyPattern" << _info->getShardKey().key()
                        << "min" << getMin()
                        << "max" << getMax()
                        << "maxSize" << ( MaxChunkSize + 1 )
@@ -507,7 +508,7 @@ namespace mongo {
 
     void Chunk::serialize(BSONObjBuilder& to,ChunkVersion myLastMod) {
 
-        to.append( "_id" , genID( _manager->getns() , _min ) );
+        to.append( "_id" , genID( _info->getns() , _min ) );
 
         if ( myLastMod.isSet() ) {
             myLastMod.addToBSON(to, ChunkType::DEPRECATED_lastmod());
@@ -519,7 +520,7 @@ namespace mongo {
             verify(0);
         }
 
-        to << ChunkType::ns(_manager->getns());
+        to << ChunkType::ns(_info->getns());
         to << ChunkType::min(_min);
         to << ChunkType::max(_max);
         to << ChunkType::shard(_shard.getName());
@@ -540,7 +541,7 @@ namespace mongo {
 
     string Chunk::toString() const {
         stringstream ss;
-        ss << ChunkType::ns()                 << ": " << _manager->getns()   << ", "
+        ss << ChunkType::ns()                 << ": " << _info->getns()   << ", "
            << ChunkType::shard()              << ": " << _shard.toString()   << ", "
            << ChunkType::DEPRECATED_lastmod() << ": " << _lastmod.toString() << ", "
            << ChunkType::min()                << ": " << _min                << ", "
@@ -549,7 +550,7 @@ namespace mongo {
     }
 
     ShardKeyPattern Chunk::skey() const {
-        return _manager->getShardKey();
+        return _info->getShardKey();
     }
 
     void Chunk::markAsJumbo() const {
@@ -617,6 +618,7 @@ namespace mongo {
         _ns( ns ),
         _key( pattern ),
         _unique( unique ),
+        _info( new ShardedCollectionInfo( _ns, _key, _unique ) ),
         _chunkRanges(),
         _mutex("ChunkManager"),
         _sequenceNumber(++NextSequenceNumber)
@@ -636,6 +638,7 @@ namespace mongo {
                                                         collDoc[CollectionType::keyPattern()].Obj().getOwned() :
                                                         BSONObj()),
         _unique(collDoc[CollectionType::unique()].trueValue()),
+        _info( new ShardedCollectionInfo( _ns, _key, _unique ) ),
         _chunkRanges(),
         _mutex("ChunkManager"),
         // The shard versioning mechanism hinges on keeping track of the number of times we reloaded ChunkManager's.
@@ -658,6 +661,8 @@ namespace mongo {
         _ns( oldManager->getns() ),
         _key( oldManager->getShardKey() ),
         _unique( oldManager->isUnique() ),
+        // share the old manager's collection info, so its chunks are usable as ours
+        _info( oldManager->getCollInfo() ),
         _chunkRanges(),
         _mutex("ChunkManager"),
         _sequenceNumber(++NextSequenceNumber)
@@ -701,6 +706,9 @@ namespace mongo {
                     const_cast<ShardVersionMap&>(_shardVersions).swap(shardVersions);
                     const_cast<ChunkRangeManager&>(_chunkRanges).reloadAll(_chunkMap);
 
+                    // Publish our chunk count for the shared split heuristics
+                    _info->_numChunks.set( _chunkMap.size() );
+
                     // Once we load data, clear reference to old manager
                     _oldManager.reset();
 
@@ -745,7 +753,7 @@ namespace mongo {
         virtual bool isMinKeyIndexed() const { return false; }
 
         virtual pair<BSONObj,ChunkPtr> rangeFor( const BSONObj& chunkDoc, const BSONObj& min, const BSONObj& max ) const {
-            ChunkPtr c( new Chunk( _manager, chunkDoc ) );
+            ChunkPtr c( new Chunk( _manager->getCollInfo(), chunkDoc ) );
             return make_pair( max, c );
         }
 
@@ -781,24 +789,14 @@ namespace mongo {
             // Load a copy of the old versions
             shardVersions = oldManager->_shardVersions;
 
-            // Load a copy of the chunk map, replacing the chunk manager with our own
+            // Share the old chunk map.  Chunks reference the collection info we share
+            // with the old manager rather than the manager that created them, so the
+            // old chunks are usable as-is and the diff tracker below only replaces the
+            // entries for ranges that actually changed.  This is a copy of a map of
+            // shared_ptrs - no Chunk or BSONObj is rebuilt - and it also carries the
+            // chunks' split and jumbo bookkeeping across the refresh for free.
             const ChunkMap& oldChunkMap = oldManager->getChunkMap();
-
-            // Could be v.expensive
-            // TODO: If chunks were immutable and didn't reference the manager, we could do more
-            // interesting things here
-            for( ChunkMap::const_iterator it = oldChunkMap.begin(); it != oldChunkMap.end(); it++ ){
-
-                ChunkPtr oldC = it->second;
-                ChunkPtr c( new Chunk( this, oldC->getMin(),
-                                             oldC->getMax(),
-                                             oldC->getShard(),
-                                             oldC->getLastmod() ) );
-
-                c->setBytesWritten( oldC->getBytesWritten() );
-
-                chunkMap.insert( make_pair( oldC->getMax(), c ) );
-            }
+            chunkMap = oldChunkMap;
 
             // Also get any minor versions stored for reload
             oldManager->getMarkedMinorVersions( minorVersions );
@@ -871,14 +869,22 @@ namespace mongo {
     }
 
     void ChunkManager::markMinorForReload( ChunkVersion majorVersion ) const {
-        _splitHeuristics.markMinorForReload( getns(), majorVersion );
+        _info->markMinorForReload( majorVersion );
     }
 
     void ChunkManager::getMarkedMinorVersions( set<ChunkVersion>& minorVersions ) const {
+        _info->getMarkedMinorVersions( minorVersions );
+    }
+
+    void ShardedCollectionInfo::markMinorForReload( ChunkVersion majorVersion ) {
+        _splitHeuristics.markMinorForReload( _ns, majorVersion );
+    }
+
+    void ShardedCollectionInfo::getMarkedMinorVersions( set<ChunkVersion>& minorVersions ) {
         _splitHeuristics.getMarkedMinorVersions( minorVersions );
     }
 
-    void ChunkManager::SplitHeuristics::markMinorForReload( const string& ns, ChunkVersion majorVersion ) {
+    void ShardedCollectionInfo::SplitHeuristics::markMinorForReload( const string& ns, ChunkVersion majorVersion ) {
 
         // When we get a stale minor version, it means that some *other* mongos has just split a
         // chunk into a number of smaller parts, so we shouldn't need reload the data needed to
@@ -916,11 +922,15 @@ namespace mongo {
             grid.getDBConfig( ns )->getChunkManagerIfExists( ns, true, true );
     }
 
-    void ChunkManager::SplitHeuristics::getMarkedMinorVersions( set<ChunkVersion>& minorVersions ) {
+    void ShardedCollectionInfo::SplitHeuristics::getMarkedMinorVersions( set<ChunkVersion>& minorVersions ) {
         scoped_lock lk( _staleMinorSetMutex );
         for( set<ChunkVersion>::iterator it = _staleMinorSet.begin(); it != _staleMinorSet.end(); it++ ){
             minorVersions.insert( *it );
         }
+        // The reload that reads the marks services them.  Now that the heuristics
+        // outlive a single manager, leaving them behind would grow the set (and the
+        // diff queries built from it) without bound.
+        _staleMinorSet.clear();
     }
 
     bool ChunkManager::_isValid(const ChunkMap& chunkMap) {
@@ -969,7 +979,7 @@ namespace mongo {
         verify( _chunkMap.size() == 0 );
 
         unsigned long long numObjects = 0;
-        Chunk c(this, _key.globalMin(), _key.globalMax(), primary);
+        Chunk c(_info, _key.globalMin(), _key.globalMax(), primary);
 
         if ( !initPoints || !initPoints->size() ) {
             // discover split points
@@ -1044,7 +1054,7 @@ namespace mongo {
             BSONObj min = i == 0 ? _key.globalMin() : splitPoints[i-1];
             BSONObj max = i < splitPoints.size() ? splitPoints[i] : _key.globalMax();
 
-            Chunk temp( this , min , max , shards[ i % shards.size() ], version );
+            Chunk temp( _info , min , max , shards[ i % shards.size() ], version );
 
             BSONObjBuilder chunkBuilder;
             temp.serialize( chunkBuilder );
@@ -1071,7 +1081,29 @@ namespace mongo {
         _version = ChunkVersion( 0, version.epoch() );
     }
 
+    unsigned ChunkManager::_routingKeyHash( const BSONObj& point ) {
+        unsigned h = 0;
+        const char* p = point.objdata();
+        for ( int i = 0; i < point.objsize(); i++ ) {
+            h = h * 131 + (unsigned char)p[i];
+        }
+        return h;
+    }
+
     ChunkPtr ChunkManager::findIntersectingChunk( const BSONObj& point ) const {
+        const unsigned pointHash = _routingKeyHash( point );
+
+        {
+            scoped_spinlock lk( _routingCacheLock );
+            const RoutingCacheEntry& entry = _routingCache[ pointHash % RoutingCacheSlots ];
+            if ( entry.chunk &&
+                 entry.hash == pointHash &&
+                 entry.key.binaryEqual( point ) ) {
+                dassert( entry.chunk->containsPoint( point ) );
+                return entry.chunk;
+            }
+        }
+
         {
             BSONObj foo;
             ChunkPtr c;
@@ -1086,6 +1118,16 @@ namespace mongo {
             if ( c ) {
                 if ( c->containsPoint( point ) ){
                     dassert( c->containsPoint( point ) ); // doesn't use fast-path in extractKey
+
+                    const BSONObj ownedPoint = point.getOwned();
+
+                    scoped_spinlock lk( _routingCacheLock );
+                    RoutingCacheEntry& entry =
+                        _routingCache[ pointHash % RoutingCacheSlots ];
+                    entry.hash = pointHash;
+                    entry.key = ownedPoint;
+                    entry.chunk = c;
+
                     return c;
                 }
 
@@ -1352,7 +1394,7 @@ namespace mongo {
         return ss.str();
     }
 
-    void ChunkRangeManager::assertValid() const {
+    void ChunkRangeManager::assertValid(const ChunkMap& chunks) const {
         if (_ranges.empty())
             return;
 
@@ -1378,7 +1420,6 @@ namespace mongo {
             }
 
             // Make sure we match the original chunks
-            const ChunkMap chunks = _ranges.begin()->second->getManager()->_chunkMap;
             for ( ChunkMap::const_iterator i=chunks.begin(); i!=chunks.end(); ++i ) {
                 const ChunkPtr chunk = i->second;
 
@@ -1408,7 +1449,7 @@ namespace mongo {
         _ranges.clear();
         _insertRange(chunks.begin(), chunks.end());
 
-        DEV assertValid();
+        DEV assertValid(chunks);
     }
 
     void ChunkRangeManager::_insertRange(ChunkMap::const_iterator begin, const ChunkMap::const_iterator end) {
@@ -1423,14 +1464,12 @@ namespace mongo {
         }
     }
 
-    int ChunkManager::getCurrentDesiredChunkSize() const {
+    static int currentDesiredChunkSize( int nc ) {
         // split faster in early chunks helps spread out an initial load better
         const int minChunkSize = 1 << 20;  // 1 MBytes
 
         int splitThreshold = Chunk::MaxChunkSize;
 
-        int nc = numChunks();
-
         if ( nc <= 1 ) {
             return 1024;
         }
@@ -1446,10 +1485,19 @@ namespace mongo {
 
         return splitThreshold;
     }
-    
+
+    int ChunkManager::getCurrentDesiredChunkSize() const {
+        return currentDesiredChunkSize( numChunks() );
+    }
+
+    int ShardedCollectionInfo::getCurrentDesiredChunkSize() const {
+        return currentDesiredChunkSize( numChunks() );
+    }
+
     /** This is for testing only, just setting up minimal basic defaults. */
     ChunkManager::ChunkManager() :
     _unique(),
+    _info( new ShardedCollectionInfo( _ns, _key, _unique ) ),
     _chunkRanges(),
     _mutex( "ChunkManager" ),
     _sequenceNumber()
@@ -1485,12 +1533,10 @@ namespace mongo {
     // NOTE (careful when deprecating)
     //   currently the sharding is enabled because of a write or read (as opposed to a split or migrate), the shard learns
     //   its name and through the 'setShardVersion' command call
-    bool setShardVersion( DBClientBase & conn,
-                          const string& ns,
-                          ChunkVersion version,
-                          ChunkManagerPtr manager, // Used only for reporting!
-                          bool authoritative ,
-                          BSONObj& result )
+    BSONObj buildSetShardVersionCmd( DBClientBase & conn,
+                                     const string& ns,
+                                     ChunkVersion version,
+                                     bool authoritative )
     {
         BSONObjBuilder cmdBuilder;
         cmdBuilder.append( "setShardVersion" , ns.c_str() );
@@ -1503,7 +1549,19 @@ namespace mongo {
         Shard s = Shard::make( conn.getServerAddress() );
         cmdBuilder.append( "shard" , s.getName() );
         cmdBuilder.append( "shardHost" , s.getConnString() );
-        BSONObj cmd = cmdBuilder.obj();
+        return cmdBuilder.obj();
+    }
+
+    bool setShardVersion( DBClientBase & conn,
+                          const string& ns,
+                          ChunkVersion version,
+                          ChunkManagerPtr manager, // Used only for reporting!
+                          bool authoritative ,
+                          BSONObj& result )
+    {
+        BSONObj cmd = buildSetShardVersionCmd( conn, ns, version, authoritative );
+
+        Shard s = Shard::make( conn.getServerAddress() );
 
         LOG(1).stream()
                << "    setShardVersion  " << s.getName()
@@ -36,6 +36,7 @@
 #include "mongo/s/distlock.h"
 #include "mongo/s/shard.h"
 #include "mongo/s/shardkey.h"
+#include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/concurrency/ticketholder.h"
 
 namespace mongo {
@@ -54,6 +55,84 @@ namespace mongo {
 
     typedef shared_ptr<const ChunkManager> ChunkManagerPtr;
 
+    /**
+     * Per-collection sharding state that outlives any single ChunkManager:
+     * the collection's identity (ns, shard key, unique flag) plus the split
+     * heuristics.  Successive ChunkManagers for a collection share one
+     * instance, and Chunks reference it instead of the manager that created
+     * them.  A chunk therefore stays valid no matter which managers still
+     * hold it, which is what lets a refresh share every unchanged ChunkPtr
+     * with the manager it replaces instead of deep-copying the whole map.
+     */
+    class ShardedCollectionInfo : boost::noncopyable {
+    public:
+        ShardedCollectionInfo( const string& ns, const ShardKeyPattern& key, bool unique )
+            : _ns( ns ), _key( key ), _unique( unique ), _numChunks( 0 ) {}
+
+        const string& getns() const { return _ns; }
+        const ShardKeyPattern& getShardKey() const { return _key; }
+        bool isUnique() const { return _unique; }
+
+        /** number of chunks in the most recently loaded manager for this collection.
+            an approximation for split heuristics - routing always goes through a manager */
+        int numChunks() const { return _numChunks.get(); }
+
+        int getCurrentDesiredChunkSize() const;
+
+        void markMinorForReload( ChunkVersion majorVersion );
+        void getMarkedMinorVersions( set<ChunkVersion>& minorVersions );
+
+    private:
+
+        class SplitHeuristics {
+        public:
+
+            SplitHeuristics() :
+                _splitTickets( maxParallelSplits ),
+                _staleMinorSetMutex( "SplitHeuristics::staleMinorSet" ),
+                _staleMinorCount( 0 ) {}
+
+            void markMinorForReload( const string& ns, ChunkVersion majorVersion );
+            void getMarkedMinorVersions( set<ChunkVersion>& minorVersions );
+
+            TicketHolder _splitTickets;
+
+            mutex _staleMinorSetMutex;
+
+            // mutex protects below
+            int _staleMinorCount;
+            set<ChunkVersion> _staleMinorSet;
+
+            // Test whether we should split once data * splitTestFactor > chunkSize (approximately)
+            static const int splitTestFactor = 5;
+            // Maximum number of parallel threads requesting a split
+            static const int maxParallelSplits = 5;
+
+            // The idea here is that we're over-aggressive on split testing by a factor of
+            // splitTestFactor, so we can safely wait until we get to splitTestFactor invalid splits
+            // before changing.  Unfortunately, we also potentially over-request the splits by a
+            // factor of maxParallelSplits, but since the factors are identical it works out
+            // (for now) for parallel or sequential oversplitting.
+            // TODO: Make splitting a separate thread with notifications?
+            static const int staleMinorReloadThreshold = maxParallelSplits;
+
+        };
+
+        const string _ns;
+        const ShardKeyPattern _key;
+        const bool _unique;
+
+        // updated by each manager that finishes loading; only split heuristics read it
+        AtomicUInt _numChunks;
+
+        SplitHeuristics _splitHeuristics;
+
+        friend class Chunk;        // _splitHeuristics._splitTickets
+        friend class ChunkManager; // publishes _numChunks after a load
+    };
+
+    typedef shared_ptr<ShardedCollectionInfo> ShardedCollectionInfoPtr;
+
     /**
        config.chunks
        { ns : "alleyinsider.fs.chunks" , min : {} , max : {} , server : "localhost:30001" }
@@ -63,8 +142,8 @@ namespace mongo {
      */
     class Chunk : boost::noncopyable {
     public:
-        Chunk( const ChunkManager * info , BSONObj from);
-        Chunk( const ChunkManager * info ,
+        Chunk( const ShardedCollectionInfoPtr& info , BSONObj from);
+        Chunk( const ShardedCollectionInfoPtr& info ,
                const BSONObj& min,
                const BSONObj& max,
                const Shard& shard,
@@ -226,14 +305,14 @@ namespace mongo {
 
         string getns() const;
         Shard getShard() const { return _shard; }
-        const ChunkManager* getManager() const { return _manager; }
-        
 
     private:
 
         // main shard info
-        
-        const ChunkManager * _manager;
+
+        // shared with the other chunks of the collection and with the managers
+        // holding them; never null for a chunk reachable through a manager
+        const ShardedCollectionInfoPtr _info;
 
         BSONObj _min;
         BSONObj _max;
@@ -266,7 +345,6 @@ namespace mongo {
 
     class ChunkRange {
     public:
-        const ChunkManager* getManager() const { return _manager; }
         Shard getShard() const { return _shard; }
 
         const BSONObj& getMin() const { return _min; }
@@ -281,14 +359,12 @@ namespace mongo {
         bool containsPoint( const BSONObj& point ) const;
 
         ChunkRange(ChunkMap::const_iterator begin, const ChunkMap::const_iterator end)
-            : _manager(begin->second->getManager())
-            , _shard(begin->second->getShard())
+            : _shard(begin->second->getShard())
             , _min(begin->second->getMin())
             , _max(boost::prior(end)->second->getMax()) {
             verify( begin != end );
 
             DEV while (begin != end) {
-                verify(begin->second->getManager() == _manager);
                 verify(begin->second->getShard() == _shard);
                 ++begin;
             }
@@ -296,12 +372,10 @@ namespace mongo {
 
         // Merge min and max (must be adjacent ranges)
         ChunkRange(const ChunkRange& min, const ChunkRange& max)
-            : _manager(min.getManager())
-            , _shard(min.getShard())
+            : _shard(min.getShard())
             , _min(min.getMin())
             , _max(max.getMax()) {
             verify(min.getShard() == max.getShard());
-            verify(min.getManager() == max.getManager());
             verify(min.getMax() == max.getMin());
         }
 
@@ -310,7 +384,6 @@ namespace mongo {
         }
 
     private:
-        const ChunkManager* _manager;
         const Shard _shard;
         const BSONObj _min;
         const BSONObj _max;
@@ -326,7 +399,8 @@ namespace mongo {
         void reloadAll(const ChunkMap& chunks);
 
         // Slow operation -- wrap with DEV
-        void assertValid() const;
+        // chunks must be the map the ranges were built from
+        void assertValid(const ChunkMap& chunks) const;
 
         ChunkRangeMap::const_iterator upper_bound(const BSONObj& o) const { return _ranges.upper_bound(o); }
         ChunkRangeMap::const_iterator lower_bound(const BSONObj& o) const { return _ranges.lower_bound(o); }
@@ -361,6 +435,10 @@ namespace mongo {
 
         const ShardKeyPattern& getShardKey() const {  return _key; }
 
+        /** the collection info shared by this manager, the managers it was based on,
+            and every chunk of the collection */
+        const ShardedCollectionInfoPtr& getCollInfo() const { return _info; }
+
         bool hasShardKey( const BSONObj& obj ) const;
 
         bool isUnique() const { return _unique; }
@@ -473,6 +551,9 @@ namespace mongo {
         const ShardKeyPattern _key;
         const bool _unique;
 
+        // shared with all chunks and with any manager this one was based on
+        const ShardedCollectionInfoPtr _info;
+
         const ChunkMap _chunkMap;
         const ChunkRangeManager _chunkRanges;
 
@@ -489,55 +570,33 @@ namespace mongo {
 
         mutable mutex _mutex; // only used with _nsLock
 
-        const unsigned long long _sequenceNumber;
-
-        //
-        // Split Heuristic info
-        //
-
-
-        class SplitHeuristics {
-        public:
-
-            SplitHeuristics() :
-                _splitTickets( maxParallelSplits ),
-                _staleMinorSetMutex( "SplitHeuristics::staleMinorSet" ),
-                _staleMinorCount( 0 ) {}
-
-            void markMinorForReload( const string& ns, ChunkVersion majorVersion );
-            void getMarkedMinorVersions( set<ChunkVersion>& minorVersions );
-
-            TicketHolder _splitTickets;
+        /**
+         * Small direct-mapped cache of recently routed shard keys, so hot keys
+         * resolve to their chunk with one hash probe instead of a map walk. It only
+         * memoizes _chunkMap lookups, so it is safe in this otherwise immutable
+         * object: a metadata change always installs a brand new ChunkManager and
+         * entries can never go stale within one manager.
+         */
+        enum { RoutingCacheSlots = 256 };
 
-            mutex _staleMinorSetMutex;
+        struct RoutingCacheEntry {
+            RoutingCacheEntry() : hash( 0 ) {}
 
-            // mutex protects below
-            int _staleMinorCount;
-            set<ChunkVersion> _staleMinorSet;
+            unsigned hash;
+            BSONObj key; // owned copy of the routed shard key value
+            ChunkPtr chunk;
+        };
 
-            // Test whether we should split once data * splitTestFactor > chunkSize (approximately)
-            static const int splitTestFactor = 5;
-            // Maximum number of parallel threads requesting a split
-            static const int maxParallelSplits = 5;
+        static unsigned _routingKeyHash( const BSONObj& point );
 
-            // The idea here is that we're over-aggressive on split testing by a factor of
-            // splitTestFactor, so we can safely wait until we get to splitTestFactor invalid splits
-            // before changing.  Unfortunately, we also potentially over-request the splits by a
-            // factor of maxParallelSplits, but since the factors are identical it works out
-            // (for now) for parallel or sequential oversplitting.
-            // TODO: Make splitting a separate thread with notifications?
-            static const int staleMinorReloadThreshold = maxParallelSplits;
+        mutable SpinLock _routingCacheLock;
+        mutable RoutingCacheEntry _routingCache[RoutingCacheSlots];
 
-        };
-
-        mutable SplitHeuristics _splitHeuristics;
+        const unsigned long long _sequenceNumber;
 
-        //
-        // End split heuristics
-        //
+        // The split heuristics live in _info so they survive a metadata refresh;
+        // markMinorForReload()/getMarkedMinorVersions() above just forward there.
 
-        friend class Chunk;
-        friend class ChunkRangeManager; // only needed for CRM::assertValid()
         static AtomicUInt NextSequenceNumber;
         
         /** Just for testing */
@@ -577,7 +636,13 @@ namespace mongo {
         Chunk _c;
     };
     */
-    inline string Chunk::genID() const { return genID(_manager->getns(), _min); }
+    inline string Chunk::genID() const { return genID(_info->getns(), _min); }
+
+    /** builds the setShardVersion command that setShardVersion() sends */
+    BSONObj buildSetShardVersionCmd( DBClientBase & conn,
+                                     const string& ns,
+                                     ChunkVersion version,
+                                     bool authoritative );
 
     bool setShardVersion( DBClientBase & conn,
                           const string& ns,
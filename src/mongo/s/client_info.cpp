@@ -123,6 +123,15 @@ namespace mongo {
         return info;
     }
 
+    ClientInfo* ClientInfo::releaseTL() {
+        return _tlInfo.release();
+    }
+
+    void ClientInfo::attachTL(ClientInfo* info) {
+        massert(17469, "A ClientInfo already exists for this thread", !_tlInfo.get());
+        _tlInfo.reset( info );
+    }
+
     bool ClientInfo::exists() {
         return _tlInfo.get();
     }
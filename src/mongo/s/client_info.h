@@ -142,6 +142,12 @@ namespace mongo {
         // Creates a ClientInfo and stores it in _tlInfo
         static ClientInfo* create(AbstractMessagingPort* messagingPort);
 
+        // Event-driven message server support: detaches this thread's ClientInfo without
+        // destroying it so its connection can migrate to another worker thread, and
+        // reattaches one previously released.
+        static ClientInfo* releaseTL();
+        static void attachTL(ClientInfo* info);
+
     private:
 
         int _id; // unique client id
@@ -28,6 +28,8 @@
 
 #include "mongo/s/collection_metadata.h"
 
+#include <algorithm>
+
 #include "mongo/bson/util/builder.h" // for StringBuilder
 #include "mongo/util/mongoutils/str.h"
 
@@ -35,6 +37,16 @@ namespace mongo {
 
     using mongoutils::str::stream;
 
+    namespace {
+
+        // orders a key against range minimums; matches RangeMap's BSONObjCmp ordering
+        struct RangeMinCmp {
+            bool operator()( const BSONObj& key, const pair<BSONObj,BSONObj>& range ) const {
+                return key.woCompare( range.first ) < 0;
+            }
+        };
+    }
+
     CollectionMetadata::CollectionMetadata() { }
 
     CollectionMetadata::~CollectionMetadata() { }
@@ -196,6 +208,7 @@ namespace mongo {
         metadata->_pendingMap.erase( pending.getMin() );
         metadata->_chunksMap = this->_chunksMap;
         metadata->_rangesMap = this->_rangesMap;
+        metadata->_flatRanges = this->_flatRanges;
         metadata->_shardVersion = _shardVersion;
         metadata->_collVersion = _collVersion;
 
@@ -231,6 +244,7 @@ namespace mongo {
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
         metadata->_rangesMap = this->_rangesMap;
+        metadata->_flatRanges = this->_flatRanges;
         metadata->_shardVersion = _shardVersion;
         metadata->_collVersion = _collVersion;
 
@@ -420,6 +434,7 @@ namespace mongo {
         metadata->_pendingMap = this->_pendingMap;
         metadata->_chunksMap = this->_chunksMap;
         metadata->_rangesMap = this->_rangesMap;
+        metadata->_flatRanges = this->_flatRanges;
         metadata->_shardVersion = newShardVersion;
         metadata->_collVersion =
                 newShardVersion > _collVersion ? newShardVersion : this->_collVersion;
@@ -441,12 +456,13 @@ namespace mongo {
             return true;
         }
 
-        if ( _rangesMap.size() <= 0 ) {
+        if ( _flatRanges.empty() ) {
             return false;
         }
 
-        RangeMap::const_iterator it = _rangesMap.upper_bound( key );
-        if ( it != _rangesMap.begin() ) it--;
+        vector< pair<BSONObj,BSONObj> >::const_iterator it =
+            std::upper_bound( _flatRanges.begin(), _flatRanges.end(), key, RangeMinCmp() );
+        if ( it != _flatRanges.begin() ) --it;
 
         bool good = rangeContains( it->first, it->second, key );
 
@@ -709,6 +725,8 @@ namespace mongo {
         dassert(!min.isEmpty());
 
         _rangesMap.insert(make_pair(min, max));
+
+        _flatRanges.assign(_rangesMap.begin(), _rangesMap.end());
     }
 
     void CollectionMetadata::fillKeyPatternFields() {
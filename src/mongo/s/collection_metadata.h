@@ -296,6 +296,11 @@ namespace mongo {
         // installations.
         RangeMap _rangesMap;
 
+        // _rangesMap flattened into a sorted vector.  keyBelongsToMe() runs once per
+        // document on the sharding filter path, so it binary-searches this contiguous
+        // copy instead of chasing map nodes.
+        std::vector< std::pair<BSONObj,BSONObj> > _flatRanges;
+
         /**
          * Returns true if this metadata was loaded with all necessary information.
          */
@@ -47,6 +47,7 @@
 #include "mongo/db/stats/counters.h"
 #include "mongo/db/wire_version.h"
 #include "mongo/db/write_concern.h"
+#include "mongo/s/balance.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/client_info.h"
 #include "mongo/s/cluster_write.h"
@@ -136,6 +137,26 @@ namespace mongo {
             }
         } flushRouterConfigCmd;
 
+        class BalancerDryRunCmd : public GridAdminCmd {
+        public:
+            BalancerDryRunCmd() : GridAdminCmd("balancerDryRun") { }
+            virtual void help( stringstream& help ) const {
+                help << " reports the migrations the balancer would request right now, with the"
+                        " chunk counts and load metrics behind each pick, without moving anything";
+            }
+            virtual void addRequiredPrivileges(const std::string& dbname,
+                                               const BSONObj& cmdObj,
+                                               std::vector<Privilege>* out) {
+                ActionSet actions;
+                actions.addAction(ActionType::balancerDryRun);
+                out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
+            }
+            bool run(const string& , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool) {
+                balancer.dryRun( result );
+                return true;
+            }
+        } balancerDryRunCmd;
+
         class FsyncCommand : public GridAdminCmd {
         public:
             FsyncCommand() : GridAdminCmd( "fsync" ) {}
@@ -1461,6 +1482,19 @@ namespace mongo {
                 result.append("maxWireVersion", maxWireVersion);
                 result.append("minWireVersion", minWireVersion);
 
+                // wire compression negotiation, same contract as mongod's isMaster
+                if ( cmdObj["compression"].type() == Array ) {
+                    BSONForEach( e , cmdObj["compression"].Obj() ) {
+                        if ( e.type() == String && e.str() == "snappy" ) {
+                            ClientInfo* info = ClientInfo::get();
+                            if ( info->port() )
+                                info->port()->setWireCompression( true );
+                            result.append( "compression" , BSON_ARRAY( "snappy" ) );
+                            break;
+                        }
+                    }
+                }
+
                 return true;
             }
         } ismaster;
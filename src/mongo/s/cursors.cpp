@@ -106,7 +106,7 @@ namespace mongo {
         BufBuilder buffer( INIT_REPLY_BUFFER_SIZE );
         int docCount = 0;
         bool hasMore = sendNextBatch( r, _ntoreturn, buffer, docCount );
-        replyToQuery( 0, r.p(), r.m(), buffer.buf(), buffer.len(), docCount,
+        replyToQuery( 0, r.p(), r.m(), buffer, docCount,
                 _totalSent, hasMore ? getId() : 0 );
 
         return hasMore;
@@ -174,31 +174,44 @@ namespace mongo {
         return sr->nextInt64();
     }
 
+    CursorCache::Partition::Partition()
+        : mutex( "CursorCache::Partition" ),
+          timeoutWheel( 1000 /*tickMillis*/, 1024 /*buckets*/ ) {
+    }
+
     CursorCache::CursorCache()
-        :_mutex( "CursorCache" ),
-         _random( getCCRandomSeed() ),
-         _shardedTotal(0) {
+        : _randomMutex( "CursorCache::genId" ),
+          _random( getCCRandomSeed() ),
+          _shardedTotal(0) {
     }
 
     CursorCache::~CursorCache() {
         // TODO: delete old cursors?
+        size_t sharded = 0;
+        size_t refs = 0;
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            verify( _partitions[i].refs.size() == _partitions[i].refsNS.size() );
+            sharded += _partitions[i].cursors.size();
+            refs += _partitions[i].refs.size();
+        }
+
         bool print = logger::globalLogDomain()->shouldLog(logger::LogSeverity::Debug(1));
-        if ( _cursors.size() || _refs.size() )
+        if ( sharded || refs )
             print = true;
-        verify(_refs.size() == _refsNS.size());
-        
-        if ( print ) 
+
+        if ( print )
             log() << " CursorCache at shutdown - "
-                  << " sharded: " << _cursors.size()
-                  << " passthrough: " << _refs.size()
+                  << " sharded: " << sharded
+                  << " passthrough: " << refs
                   << endl;
     }
 
     ShardedClientCursorPtr CursorCache::get( long long id ) const {
         LOG(_myLogLevel) << "CursorCache::get id: " << id << endl;
-        scoped_lock lk( _mutex );
-        MapSharded::const_iterator i = _cursors.find( id );
-        if ( i == _cursors.end() ) {
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        MapSharded::const_iterator i = p.cursors.find( id );
+        if ( i == p.cursors.end() ) {
             OCCASIONALLY log() << "Sharded CursorCache missing cursor id: " << id << endl;
             return ShardedClientCursorPtr();
         }
@@ -208,9 +221,10 @@ namespace mongo {
 
     int CursorCache::getMaxTimeMS( long long id ) const {
         verify( id );
-        scoped_lock lk( _mutex );
-        MapShardedInt::const_iterator i = _cursorsMaxTimeMS.find( id );
-        return ( i != _cursorsMaxTimeMS.end() ) ? i->second : 0;
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        MapShardedInt::const_iterator i = p.cursorsMaxTimeMS.find( id );
+        return ( i != p.cursorsMaxTimeMS.end() ) ? i->second : 0;
     }
 
     void CursorCache::store( ShardedClientCursorPtr cursor, int maxTimeMS ) {
@@ -222,10 +236,13 @@ namespace mongo {
         verify( maxTimeMS == kMaxTimeCursorTimeLimitExpired
                 || maxTimeMS == kMaxTimeCursorNoTimeLimit
                 || maxTimeMS > 0 );
-        scoped_lock lk( _mutex );
-        _cursorsMaxTimeMS[cursor->getId()] = maxTimeMS;
-        _cursors[cursor->getId()] = cursor;
-        _shardedTotal++;
+        Partition& p = _partition( cursor->getId() );
+        scoped_lock lk( p.mutex );
+        p.cursorsMaxTimeMS[cursor->getId()] = maxTimeMS;
+        p.cursors[cursor->getId()] = cursor;
+        _shardedTotal.fetchAndAdd( 1 );
+        p.timeoutWheel.schedule( cursor->getId(),
+                                 Listener::getElapsedTimeMillis() + TIMEOUT + 1 );
     }
 
     void CursorCache::updateMaxTimeMS( long long id, int maxTimeMS ) {
@@ -233,53 +250,59 @@ namespace mongo {
         verify( maxTimeMS == kMaxTimeCursorTimeLimitExpired
                 || maxTimeMS == kMaxTimeCursorNoTimeLimit
                 || maxTimeMS > 0 );
-        scoped_lock lk( _mutex );
-        _cursorsMaxTimeMS[id] = maxTimeMS;
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        p.cursorsMaxTimeMS[id] = maxTimeMS;
     }
 
     void CursorCache::remove( long long id ) {
         verify( id );
-        scoped_lock lk( _mutex );
-        _cursorsMaxTimeMS.erase( id );
-        _cursors.erase( id );
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        p.cursorsMaxTimeMS.erase( id );
+        p.cursors.erase( id );
     }
-    
+
     void CursorCache::removeRef( long long id ) {
         verify( id );
-        scoped_lock lk( _mutex );
-        _refs.erase( id );
-        _refsNS.erase( id );
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        p.refs.erase( id );
+        p.refsNS.erase( id );
     }
 
     void CursorCache::storeRef(const std::string& server, long long id, const std::string& ns) {
         LOG(_myLogLevel) << "CursorCache::storeRef server: " << server << " id: " << id << endl;
         verify( id );
-        scoped_lock lk( _mutex );
-        _refs[id] = server;
-        _refsNS[id] = ns;
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        p.refs[id] = server;
+        p.refsNS[id] = ns;
     }
 
     string CursorCache::getRef( long long id ) const {
         verify( id );
-        scoped_lock lk( _mutex );
-        MapNormal::const_iterator i = _refs.find( id );
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        MapNormal::const_iterator i = p.refs.find( id );
 
-        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == _refs.end() ? " NONE " : i->second ) << endl;
+        LOG(_myLogLevel) << "CursorCache::getRef id: " << id << " out: " << ( i == p.refs.end() ? " NONE " : i->second ) << endl;
 
-        if ( i == _refs.end() )
+        if ( i == p.refs.end() )
             return "";
         return i->second;
     }
 
     std::string CursorCache::getRefNS(long long id) const {
         verify(id);
-        scoped_lock lk(_mutex);
-        MapNormal::const_iterator i = _refsNS.find(id);
+        Partition& p = _partition( id );
+        scoped_lock lk( p.mutex );
+        MapNormal::const_iterator i = p.refsNS.find(id);
 
         LOG(_myLogLevel) << "CursorCache::getRefNs id: " << id
-                << " out: " << ( i == _refsNS.end() ? " NONE " : i->second ) << std::endl;
+                << " out: " << ( i == p.refsNS.end() ? " NONE " : i->second ) << std::endl;
 
-        if ( i == _refsNS.end() )
+        if ( i == p.refsNS.end() )
             return "";
         return i->second;
     }
@@ -287,10 +310,12 @@ namespace mongo {
 
     long long CursorCache::genId() {
         while ( true ) {
-            scoped_lock lk( _mutex );
-
-            long long x = Listener::getElapsedTimeMillis() << 32;
-            x |= _random.nextInt32();
+            long long x;
+            {
+                scoped_lock lk( _randomMutex );
+                x = Listener::getElapsedTimeMillis() << 32;
+                x |= _random.nextInt32();
+            }
 
             if ( x == 0 )
                 continue;
@@ -298,12 +323,13 @@ namespace mongo {
             if ( x < 0 )
                 x *= -1;
 
-            MapSharded::iterator i = _cursors.find( x );
-            if ( i != _cursors.end() )
+            Partition& p = _partition( x );
+            scoped_lock lk( p.mutex );
+
+            if ( p.cursors.count( x ) )
                 continue;
 
-            MapNormal::iterator j = _refs.find( x );
-            if ( j != _refs.end() )
+            if ( p.refs.count( x ) )
                 continue;
 
             return x;
@@ -337,10 +363,11 @@ namespace mongo {
 
             string server;
             {
-                scoped_lock lk( _mutex );
+                Partition& p = _partition( id );
+                scoped_lock lk( p.mutex );
 
-                MapSharded::iterator i = _cursors.find( id );
-                if ( i != _cursors.end() ) {
+                MapSharded::iterator i = p.cursors.find( id );
+                if ( i != p.cursors.end() ) {
                     const bool isAuthorized = authSession->isAuthorizedForActionsOnNamespace(
                             NamespaceString(i->second->getNS()), ActionType::killCursors);
                     audit::logKillCursorsAuthzCheck(
@@ -349,19 +376,19 @@ namespace mongo {
                             id,
                             isAuthorized ? ErrorCodes::OK : ErrorCodes::Unauthorized);
                     if (isAuthorized) {
-                        _cursorsMaxTimeMS.erase( i->second->getId() );
-                        _cursors.erase( i );
+                        p.cursorsMaxTimeMS.erase( i->second->getId() );
+                        p.cursors.erase( i );
                     }
                     continue;
                 }
 
-                MapNormal::iterator refsIt = _refs.find(id);
-                MapNormal::iterator refsNSIt = _refsNS.find(id);
-                if (refsIt == _refs.end()) {
+                MapNormal::iterator refsIt = p.refs.find(id);
+                MapNormal::iterator refsNSIt = p.refsNS.find(id);
+                if (refsIt == p.refs.end()) {
                     warning() << "can't find cursor: " << id << endl;
                     continue;
                 }
-                verify(refsNSIt != _refsNS.end());
+                verify(refsNSIt != p.refsNS.end());
                 const bool isAuthorized = authSession->isAuthorizedForActionsOnNamespace(
                         NamespaceString(refsNSIt->second), ActionType::killCursors);
                 audit::logKillCursorsAuthzCheck(
@@ -373,8 +400,8 @@ namespace mongo {
                     continue;
                 }
                 server = refsIt->second;
-                _refs.erase(refsIt);
-                _refsNS.erase(refsNSIt);
+                p.refs.erase(refsIt);
+                p.refsNS.erase(refsNSIt);
             }
 
             LOG(_myLogLevel) << "CursorCache::found gotKillCursors id: " << id << " server: " << server << endl;
@@ -387,28 +414,53 @@ namespace mongo {
     }
 
     void CursorCache::appendInfo( BSONObjBuilder& result ) const {
-        scoped_lock lk( _mutex );
-        result.append( "sharded" , (int)_cursors.size() );
-        result.appendNumber( "shardedEver" , _shardedTotal );
-        result.append( "refs" , (int)_refs.size() );
-        result.append( "totalOpen" , (int)(_cursors.size() + _refs.size() ) );
+        int sharded = 0;
+        int refs = 0;
+        for ( int i = 0; i < NumPartitions; i++ ) {
+            scoped_lock lk( _partitions[i].mutex );
+            sharded += (int)_partitions[i].cursors.size();
+            refs += (int)_partitions[i].refs.size();
+        }
+        result.append( "sharded" , sharded );
+        result.appendNumber( "shardedEver" , _shardedTotal.load() );
+        result.append( "refs" , refs );
+        result.append( "totalOpen" , sharded + refs );
     }
 
     void CursorCache::doTimeouts() {
         long long now = Listener::getElapsedTimeMillis();
-        scoped_lock lk( _mutex );
-        for ( MapSharded::iterator i=_cursors.begin(); i!=_cursors.end(); ++i ) {
-            // Note: cursors with no timeout will always have an idleTime of 0
-            long long idleFor = i->second->idleTime( now );
-            if ( idleFor < TIMEOUT ) {
+
+        // only cursors whose deadline has come up are inspected, so a pass costs
+        // proportional to expirations rather than to the number of open cursors
+        vector<unsigned long long> due;
+        for ( int pi = 0; pi < NumPartitions; pi++ ) {
+            Partition& p = _partitions[pi];
+
+            due.clear();
+            p.timeoutWheel.collectDue( now, &due );
+            if ( due.empty() )
                 continue;
+
+            scoped_lock lk( p.mutex );
+            for ( size_t j = 0; j < due.size(); j++ ) {
+                long long id = static_cast<long long>( due[j] );
+                MapSharded::iterator i = p.cursors.find( id );
+                if ( i == p.cursors.end() ) {
+                    // cursor already removed; its wheel entry was stale
+                    continue;
+                }
+
+                // Note: cursors with no timeout will always have an idleTime of 0
+                long long idleFor = i->second->idleTime( now );
+                if ( idleFor < TIMEOUT ) {
+                    // accessed since this deadline was scheduled (or exempt); re-arm
+                    p.timeoutWheel.schedule( due[j], ( now - idleFor ) + TIMEOUT + 1 );
+                    continue;
+                }
+                log() << "killing old cursor " << i->second->getId() << " idle for: " << idleFor << "ms" << endl; // TODO: make LOG(1)
+                p.cursorsMaxTimeMS.erase( id );
+                p.cursors.erase( i );
             }
-            log() << "killing old cursor " << i->second->getId() << " idle for: " << idleFor << "ms" << endl; // TODO: make LOG(1)
-            _cursorsMaxTimeMS.erase( i->second->getId() );
-            _cursors.erase( i );
-            i = _cursors.begin(); // possible 2nd entry will get skipped, will get on next pass
-            if ( i == _cursors.end() )
-                break;
         }
     }
 
@@ -37,8 +37,10 @@
 #include "mongo/client/parallel.h"
 #include "mongo/db/dbmessage.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/platform/random.h"
 #include "mongo/s/request.h"
+#include "mongo/util/timer_wheel.h"
 
 namespace mongo {
 
@@ -136,26 +138,48 @@ namespace mongo {
         void doTimeouts();
         void startTimeoutThread();
     private:
-        mutable mongo::mutex _mutex;
+        // cursors are spread across partitions by id so concurrent getMores
+        // rarely contend on a lock; each partition owns its maps and its own
+        // slice of the timeout wheel
+        enum { NumPartitions = 16 };
 
-        PseudoRandom _random;
+        struct Partition : boost::noncopyable {
+            Partition();
 
-        // Maps sharded cursor ID to ShardedClientCursorPtr.
-        MapSharded _cursors;
+            mongo::mutex mutex;
 
-        // Maps sharded cursor ID to remaining max time.  Value can be any of:
-        // - the constant "kMaxTimeCursorNoTimeLimit", or
-        // - the constant "kMaxTimeCursorTimeLimitExpired", or
-        // - a positive integer representing milliseconds of remaining time
-        MapShardedInt _cursorsMaxTimeMS;
+            // Maps sharded cursor ID to ShardedClientCursorPtr.
+            MapSharded cursors;
 
-        // Maps passthrough cursor ID to shard name.
-        MapNormal _refs;
+            // Maps sharded cursor ID to remaining max time.  Value can be any of:
+            // - the constant "kMaxTimeCursorNoTimeLimit", or
+            // - the constant "kMaxTimeCursorTimeLimitExpired", or
+            // - a positive integer representing milliseconds of remaining time
+            MapShardedInt cursorsMaxTimeMS;
 
-        // Maps passthrough cursor ID to namespace.
-        MapNormal _refsNS;
-        
-        long long _shardedTotal;
+            // Maps passthrough cursor ID to shard name.
+            MapNormal refs;
+
+            // Maps passthrough cursor ID to namespace.
+            MapNormal refsNS;
+
+            // Deadlines for this partition's sharded cursors; doTimeouts only
+            // inspects cursors the wheel hands back instead of scanning the map.
+            // Entries for removed cursors are simply ignored when they fire.
+            TimerWheel timeoutWheel;
+        };
+
+        Partition& _partition( long long id ) const {
+            return _partitions[ static_cast<unsigned long long>( id ) % NumPartitions ];
+        }
+
+        mutable Partition _partitions[NumPartitions];
+
+        // genId() is the only user of _random
+        mutable mongo::mutex _randomMutex;
+        PseudoRandom _random;
+
+        AtomicInt64 _shardedTotal;
 
         static const int _myLogLevel;
     };
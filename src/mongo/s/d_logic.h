@@ -32,6 +32,8 @@
 
 #include "mongo/pch.h"
 
+#include <boost/shared_ptr.hpp>
+
 #include "mongo/db/jsobj.h"
 #include "mongo/s/collection_metadata.h"
 #include "mongo/s/chunk_version.h"
@@ -270,6 +272,15 @@ namespace mongo {
         // Map from a namespace into the metadata we need for each collection on this shard
         typedef map<string,CollectionMetadataPtr> CollectionMetadataMap;
         CollectionMetadataMap _collMetadata;
+
+        // Immutable snapshot of _collMetadata, republished (under _mutex) after every
+        // change.  getCollectionMetadata() reads it with atomic shared_ptr loads, so
+        // the per-query metadata lookup never touches _mutex and cannot contend with
+        // a refresh or migration installing new metadata.
+        boost::shared_ptr<const CollectionMetadataMap> _collMetadataSnapshot;
+
+        /** rebuilds and publishes _collMetadataSnapshot; caller must hold _mutex */
+        void _republishMetadata();
     };
 
     extern ShardingState shardingState;
@@ -75,6 +75,7 @@
 #include "mongo/s/shard.h"
 #include "mongo/s/type_chunk.h"
 #include "mongo/util/assert_util.h"
+#include "mongo/util/compress.h"
 #include "mongo/util/elapsed_tracker.h"
 #include "mongo/util/processinfo.h"
 #include "mongo/util/queue.h"
@@ -329,7 +330,9 @@ namespace mongo {
         }
 
         void xfer( list<BSONObj> * l , BSONObjBuilder& b , const char * name , long long& size , bool explode ) {
-            const long long maxSize = 1024 * 1024;
+            // fill the reply as far as the BSON limit allows; round trips, not bytes,
+            // dominate catch-up time on write-heavy migrations
+            const long long maxSize = BSONObjMaxUserSize - ( 1024 * 1024 );
 
             if ( l->size() == 0 || size > maxSize )
                 return;
@@ -343,6 +346,10 @@ namespace mongo {
                 if ( explode ) {
                     BSONObj it;
                     if ( Helpers::findById( cc() , _ns.c_str() , t, it ) ) {
+                        // the while condition alone would let one large document
+                        // push the reply past the BSON size limit
+                        if ( size > 0 && size + it.objsize() > maxSize )
+                            break;
                         arr.append( it );
                         size += it.objsize();
                     }
@@ -360,8 +367,10 @@ namespace mongo {
         /**
          * called from the dest of a migrate
          * transfers mods from src to dest
+         * if 'useCompression', the "deleted"/"reload" arrays are wrapped in a single
+         * snappy-compressed "compressed" bindata field instead of sent plain
          */
-        bool transferMods( string& errmsg , BSONObjBuilder& b ) {
+        bool transferMods( bool useCompression , string& errmsg , BSONObjBuilder& b ) {
             if ( ! _getActive() ) {
                 errmsg = "no active migration!";
                 return false;
@@ -369,11 +378,25 @@ namespace mongo {
 
             long long size = 0;
 
+            BSONObjBuilder payload;
+
             {
                 Client::ReadContext cx( _ns );
 
-                xfer( &_deleted , b , "deleted" , size , false );
-                xfer( &_reload , b , "reload" , size , true );
+                xfer( &_deleted , payload , "deleted" , size , false );
+                xfer( &_reload , payload , "reload" , size , true );
+            }
+
+            BSONObj payloadObj = payload.obj();
+
+            if ( useCompression ) {
+                std::string compressed;
+                compress( payloadObj.objdata() , payloadObj.objsize() , &compressed );
+                b.appendBinData( "compressed" , compressed.size() , BinDataGeneral ,
+                                 compressed.data() );
+            }
+            else {
+                b.appendElements( payloadObj );
             }
 
             b.append( "size" , size );
@@ -465,7 +488,11 @@ namespace mongo {
             return true;
         }
 
-        bool clone( string& errmsg , BSONObjBuilder& result ) {
+        /**
+         * as with transferMods, 'useCompression' wraps the "objects" array in a
+         * snappy-compressed "compressed" bindata field
+         */
+        bool clone( bool useCompression , string& errmsg , BSONObjBuilder& result ) {
             if ( ! _getActive() ) {
                 errmsg = "not active";
                 return false;
@@ -537,7 +564,18 @@ namespace mongo {
                 
             }
 
-            result.appendArray( "objects" , a.arr() );
+            if ( useCompression ) {
+                BSONObjBuilder payload;
+                payload.appendArray( "objects" , a.arr() );
+                BSONObj payloadObj = payload.obj();
+                std::string compressed;
+                compress( payloadObj.objdata() , payloadObj.objsize() , &compressed );
+                result.appendBinData( "compressed" , compressed.size() , BinDataGeneral ,
+                                      compressed.data() );
+            }
+            else {
+                result.appendArray( "objects" , a.arr() );
+            }
             return true;
         }
 
@@ -683,7 +721,7 @@ namespace mongo {
             out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
         }
         bool run(const string& , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool) {
-            return migrateFromStatus.transferMods( errmsg, result );
+            return migrateFromStatus.transferMods( cmdObj["compress"].trueValue(), errmsg, result );
         }
     } transferModsCommand;
 
@@ -700,7 +738,7 @@ namespace mongo {
             out->push_back(Privilege(ResourcePattern::forClusterResource(), actions));
         }
         bool run(const string& , BSONObj& cmdObj, int, string& errmsg, BSONObjBuilder& result, bool) {
-            return migrateFromStatus.clone( errmsg, result );
+            return migrateFromStatus.clone( cmdObj["compress"].trueValue(), errmsg, result );
         }
     } initialCloneCommand;
 
@@ -1510,6 +1548,55 @@ namespace mongo {
     MONGO_FP_DECLARE(migrateThreadHangAtStep4);
     MONGO_FP_DECLARE(migrateThreadHangAtStep5);
 
+    /**
+     * Unwraps a possibly snappy-compressed transfer reply.  Returns the object
+     * holding the plain "objects"/"deleted"/"reload" arrays; when the reply was
+     * compressed that object points into 'buffer', which must outlive it.
+     */
+    static BSONObj uncompressedPayload( const BSONObj& res , string* buffer ) {
+        BSONElement e = res["compressed"];
+        if ( e.type() != BinData )
+            return res;
+        int len;
+        const char* data = e.binData( len );
+        massert( 17475 , "corrupt compressed migrate payload" ,
+                 uncompress( data , len , buffer ) );
+        return BSONObj( buffer->data() );
+    }
+
+    /**
+     * Fetches one _migrateClone batch from the donor on its own pooled connection.
+     * Also the thread entry point that lets the next batch stream from the donor
+     * while the migrate thread is still inserting the previous one.  On failure
+     * *ok is false and *res describes the error.
+     */
+    static void fetchCloneBatch( const string& from , BSONObj* res , bool* ok ) {
+        const bool ownClient = ! haveClient();
+        if ( ownClient )
+            Client::initThread( "migrateCloneFetch" );
+
+        *ok = false;
+        try {
+            ScopedDbConnection conn( from );
+            BSONObj tmp;
+            *ok = conn->runCommand( "admin" ,
+                                    BSON( "_migrateClone" << 1 << "compress" << true ) ,
+                                    tmp );
+            *res = tmp.getOwned();
+            conn.done();
+        }
+        catch ( const DBException& e ) {
+            *res = BSON( "errmsg" << e.toString() );
+        }
+        catch ( const std::exception& e ) {
+            // don't let anything escape and take down the process
+            *res = BSON( "errmsg" << e.what() );
+        }
+
+        if ( ownClient )
+            cc().shutdown();
+    }
+
     class MigrateStatus {
     public:
         
@@ -1691,9 +1778,14 @@ namespace mongo {
                 // 3. initial bulk clone
                 state = CLONE;
 
+                // double buffer: a fetcher thread streams the next batch from the
+                // donor while this thread is still inserting the previous one
+                BSONObj res;
+                bool fetchOk;
+                fetchCloneBatch( from , &res , &fetchOk );
+
                 while ( true ) {
-                    BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_migrateClone" << 1 ) , res ) ) {  // gets array of objects to copy, in disk order
+                    if ( ! fetchOk ) {  // gets array of objects to copy, in disk order
                         state = FAIL;
                         errmsg = "_migrateClone failed: ";
                         errmsg += res.toString();
@@ -1702,7 +1794,16 @@ namespace mongo {
                         return;
                     }
 
-                    BSONObj arr = res["objects"].Obj();
+                    string decompressed;
+                    BSONObj arr = uncompressedPayload( res , &decompressed )["objects"].Obj();
+
+                    if ( arr.isEmpty() )
+                        break;
+
+                    BSONObj nextRes;
+                    boost::thread fetcher( boost::bind( fetchCloneBatch , from ,
+                                                        &nextRes , &fetchOk ) );
+
                     int thisTime = 0;
 
                     BSONObjIterator i( arr );
@@ -1747,8 +1848,8 @@ namespace mongo {
                         }
                     }
 
-                    if ( thisTime == 0 )
-                        break;
+                    fetcher.join();
+                    res = nextRes;
                 }
 
                 timing.done(3);
@@ -1763,7 +1864,9 @@ namespace mongo {
                 state = CATCHUP;
                 while ( true ) {
                     BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_transferMods" << 1 ) , res ) ) {
+                    if ( ! conn->runCommand( "admin" ,
+                                             BSON( "_transferMods" << 1 << "compress" << true ) ,
+                                             res ) ) {
                         state = FAIL;
                         errmsg = "_transferMods failed: ";
                         errmsg += res.toString();
@@ -1774,7 +1877,8 @@ namespace mongo {
                     if ( res["size"].number() == 0 )
                         break;
 
-                    apply( res , &lastOpApplied );
+                    string decompressed;
+                    apply( uncompressedPayload( res , &decompressed ) , &lastOpApplied );
                     
                     const int maxIterations = 3600*50;
                     int i;
@@ -1834,7 +1938,9 @@ namespace mongo {
                     if ( state == COMMIT_START ) transferAfterCommit = true;
 
                     BSONObj res;
-                    if ( ! conn->runCommand( "admin" , BSON( "_transferMods" << 1 ) , res ) ) {
+                    if ( ! conn->runCommand( "admin" ,
+                                             BSON( "_transferMods" << 1 << "compress" << true ) ,
+                                             res ) ) {
                         log() << "_transferMods failed in STEADY state: " << res << migrateLog;
                         errmsg = res.toString();
                         state = FAIL;
@@ -1842,7 +1948,9 @@ namespace mongo {
                         return;
                     }
 
-                    if ( res["size"].number() > 0 && apply( res , &lastOpApplied ) )
+                    string decompressed;
+                    if ( res["size"].number() > 0 &&
+                         apply( uncompressedPayload( res , &decompressed ) , &lastOpApplied ) )
                         continue;
 
                     if ( state == ABORT ) {
@@ -44,6 +44,7 @@
 #include "mongo/db/clientcursor.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/dbhelpers.h"
+#include "mongo/db/index/btree_based_access_method.h"
 #include "mongo/db/index_legacy.h"
 #include "mongo/db/instance.h"
 #include "mongo/db/jsobj.h"
@@ -223,6 +224,8 @@ namespace mongo {
                  "  \n"
                  "  { splitVector : \"blog.post\" , keyPattern:{x:1} , min:{x:10} , max:{x:20}, force: true }\n"
                  "  'force' will produce one split point even if data is small; defaults to false\n"
+                 "  May specify 'sample: true' to estimate split points from btree quantile probes\n"
+                 "  instead of scanning every key; much faster on large chunks, less exact\n"
                  "NOTE: This command may take a while to run";
         }
         virtual Status checkAuthForCommand(ClientBasic* client,
@@ -366,12 +369,64 @@ namespace mongo {
                     keyCount = maxChunkObjects;
                 }
                 
+                //
+                // 2.a Sampled mode: instead of walking every key, probe the btree at evenly
+                //     spaced quantiles between min and max.  Each probe is one root-to-leaf
+                //     descent, so the whole computation is O(splits x tree height).  The
+                //     points are estimates (they assume sibling subtrees are similarly
+                //     populated), which is fine for chunk splitting -- chunk sizes are
+                //     approximations to begin with.
+                //
+
+                if ( jsobj["sample"].trueValue() ) {
+                    BtreeBasedAccessMethod* btreeIam =
+                        collection->getIndexCatalog()->getBtreeBasedIndex( idx );
+                    if ( btreeIam == NULL ) {
+                        errmsg = "sample mode requires a btree index";
+                        return false;
+                    }
+
+                    Timer timer;
+
+                    const double fMin = btreeIam->approxFractionOfKey( min );
+                    const double fMax = btreeIam->approxFractionOfKey( max );
+                    const double span = fMax - fMin;
+
+                    if ( span > 0 ) {
+                        // estimated keys in [min, max), and the resulting split count
+                        const long long rangeCount =
+                            std::max( 1LL, static_cast<long long>( span * recCount ) );
+                        long long numSplits = forceMedianSplit ? 1 : rangeCount / keyCount;
+                        if ( maxSplitPoints && numSplits > maxSplitPoints )
+                            numSplits = maxSplitPoints;
+
+                        for ( long long i = 1; i <= numSplits; i++ ) {
+                            const double f = fMin + span * i / ( numSplits + 1 );
+                            BSONObj key = btreeIam->approxKeyAtFraction( f );
+                            if ( key.isEmpty() )
+                                continue;
+                            key = prettyKey( idx->keyPattern(), key ).extractFields( keyPattern );
+                            // probes can collide on frequent keys; keep strictly ascending
+                            if ( splitKeys.empty() || key.woCompare( splitKeys.back() ) > 0 )
+                                splitKeys.push_back( key.getOwned() );
+                        }
+                    }
+
+                    log() << "splitVector sampled " << splitKeys.size() << " split points for "
+                          << ns << " " << min << " -->> " << max
+                          << " in " << timer.millis() << "ms" << endl;
+
+                    result.append( "timeMillis", timer.millis() );
+                    result.append( "splitKeys", splitKeys );
+                    return true;
+                }
+
                 //
                 // 2. Traverse the index and add the keyCount-th key to the result vector. If that key
                 //    appeared in the vector before, we omit it. The invariant here is that all the
                 //    instances of a given key value live in the same chunk.
                 //
-                
+
                 Timer timer;
                 long long currCount = 0;
                 long long numChunks = 0;
@@ -68,7 +68,14 @@ namespace mongo {
 
     ShardingState::ShardingState()
         : _enabled(false) , _mutex( "ShardingState" ),
-          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ) {
+          _configServerTickets( 3 /* max number of concurrent config server refresh threads */ ),
+          _collMetadataSnapshot( new CollectionMetadataMap() ) {
+    }
+
+    void ShardingState::_republishMetadata() {
+        boost::shared_ptr<const CollectionMetadataMap> next(
+                new CollectionMetadataMap( _collMetadata ) );
+        boost::atomic_store( &_collMetadataSnapshot, next );
     }
 
     void ShardingState::enable( const string& server ) {
@@ -122,6 +129,7 @@ namespace mongo {
         _configServer.clear();
         _shardName.clear();
         _collMetadata.clear();
+        _republishMetadata();
     }
 
     // TODO we shouldn't need three ways for checking the version. Fix this.
@@ -181,6 +189,7 @@ namespace mongo {
         // TODO: a bit dangerous to have two different zero-version states - no-metadata and
         // no-version
         _collMetadata[ns] = cloned;
+        _republishMetadata();
     }
 
     void ShardingState::undoDonateChunk( const string& ns, CollectionMetadataPtr prevMetadata ) {
@@ -190,6 +199,7 @@ namespace mongo {
         CollectionMetadataMap::iterator it = _collMetadata.find( ns );
         verify( it != _collMetadata.end() );
         it->second = prevMetadata;
+        _republishMetadata();
     }
 
     bool ShardingState::notePending( const string& ns,
@@ -231,6 +241,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _republishMetadata();
         return true;
     }
 
@@ -273,6 +284,7 @@ namespace mongo {
         if ( !cloned ) return false;
 
         _collMetadata[ns] = cloned;
+        _republishMetadata();
         return true;
     }
 
@@ -297,6 +309,7 @@ namespace mongo {
         uassert( 16857, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _republishMetadata();
     }
 
     void ShardingState::mergeChunks( const string& ns,
@@ -319,6 +332,7 @@ namespace mongo {
         uassert( 17004, errMsg, NULL != cloned.get() );
 
         _collMetadata[ns] = cloned;
+        _republishMetadata();
     }
 
     void ShardingState::resetMetadata( const string& ns ) {
@@ -328,6 +342,7 @@ namespace mongo {
                   << endl;
 
         _collMetadata.erase( ns );
+        _republishMetadata();
     }
 
     Status ShardingState::refreshMetadataIfNeeded( const string& ns,
@@ -599,6 +614,8 @@ namespace mongo {
                     _collMetadata.erase( it );
                 }
 
+                _republishMetadata();
+
                 *latestShardVersion = remoteShardVersion;
             }
         }
@@ -690,10 +707,13 @@ namespace mongo {
     }
 
     CollectionMetadataPtr ShardingState::getCollectionMetadata( const string& ns ) {
-        scoped_lock lk( _mutex );
+        // Lock-free: runs once per query, and must not contend with a refresh or
+        // migration holding _mutex.
+        boost::shared_ptr<const CollectionMetadataMap> snapshot =
+                boost::atomic_load( &_collMetadataSnapshot );
 
-        CollectionMetadataMap::const_iterator it = _collMetadata.find( ns );
-        if ( it == _collMetadata.end() ) {
+        CollectionMetadataMap::const_iterator it = snapshot->find( ns );
+        if ( it == snapshot->end() ) {
             return CollectionMetadataPtr();
         }
         else {
@@ -184,12 +184,45 @@ namespace mongo {
             // get the command issuer's (a mongos) serverID
             const OID id = e.__oid();
 
+            // a pre-batching mongos doesn't send maxBatch and gets one entry per
+            // poll as before; newer ones ask for a batch so a writeback storm
+            // doesn't cost one round trip per queued op
+            int maxBatch = 1;
+            if ( cmdObj["maxBatch"].isNumber() )
+                maxBatch = cmdObj["maxBatch"].numberInt();
+            if ( maxBatch < 1 )
+                maxBatch = 1;
+            else if ( maxBatch > 1000 )
+                maxBatch = 1000;
+
+            // keep the reply comfortably under the BSON limit; the first entry is
+            // returned regardless of size, like it always was
+            const long long maxBatchBytes = 4 * 1024 * 1024;
+
             // the command issuer is blocked awaiting a response
             // we want to do return at least at every 5 minutes so sockets don't timeout
             BSONObj z;
-            if ( writeBackManager.getWritebackQueue(id.str())->queue.blockingPop( z, 5 * 60 /* 5 minutes */ ) ) {
+            shared_ptr<WriteBackManager::QueueInfo> queueInfo =
+                writeBackManager.getWritebackQueue( id.str() );
+            if ( queueInfo->queue.blockingPop( z, 5 * 60 /* 5 minutes */ ) ) {
                 LOG(1) << "WriteBackCommand got : " << z << endl;
                 result.append( "data" , z );
+
+                if ( maxBatch > 1 ) {
+                    BSONArrayBuilder batch( result.subarrayStart( "dataBatch" ) );
+                    batch.append( z );
+                    int n = 1;
+                    long long bytes = z.objsize();
+                    BSONObj next;
+                    while ( n < maxBatch && bytes < maxBatchBytes &&
+                            queueInfo->queue.tryPop( next ) ) {
+                        LOG(1) << "WriteBackCommand got : " << next << endl;
+                        batch.append( next );
+                        n++;
+                        bytes += next.objsize();
+                    }
+                    batch.done();
+                }
             }
             else {
                 result.appendBool( "noop" , true );
@@ -37,6 +37,7 @@
 #include "mongo/s/write_ops/batch_downconvert.h"
 #include "mongo/s/write_ops/dbclient_safe_writer.h"
 #include "mongo/util/net/message.h"
+#include "mongo/util/net/message_port.h"
 
 namespace mongo {
 
@@ -47,7 +48,8 @@ namespace mongo {
         dbName( dbName.toString() ),
         cmdObj( cmdObj ),
         conn( NULL ),
-        status( Status::OK() ) {
+        status( Status::OK() ),
+        sent( false ) {
     }
 
     void DBClientMultiCommand::addCommand( const ConnectionString& endpoint,
@@ -131,6 +133,15 @@ namespace mongo {
         conn->say( toSend );
     }
 
+    /**
+     * @return true if a reply for the command is already buffered on the connection's
+     * socket, i.e. recv'ing it won't block.
+     */
+    static bool replyReady( DBClientBase* conn ) {
+        if ( conn->type() != ConnectionString::MASTER ) return false;
+        return static_cast<DBClientConnection*>( conn )->port().psock->dataPending();
+    }
+
     // THROWS
     static void recvAsCmd( DBClientBase* conn, Message* toRecv, BSONObj* result ) {
 
@@ -151,6 +162,12 @@ namespace mongo {
             it != _pendingCommands.end(); ++it ) {
 
             PendingCommand* command = *it;
+
+            // Commands already on the wire stay untouched - only newly-added commands are
+            // dispatched, so callers can interleave addCommand()/sendAll() with recvAny().
+            if ( command->sent ) continue;
+            command->sent = true;
+
             dassert( NULL == command->conn );
 
             try {
@@ -198,8 +215,24 @@ namespace mongo {
 
     Status DBClientMultiCommand::recvAny( ConnectionString* endpoint, BSONSerializable* response ) {
 
-        scoped_ptr<PendingCommand> command( _pendingCommands.front() );
-        _pendingCommands.pop_front();
+        // Prefer a command which already failed or whose reply is already buffered, so one
+        // slow host doesn't gate the responses of the fast ones.  If none is ready we block
+        // on the oldest outstanding command, as before.
+        PendingQueue::iterator next = _pendingCommands.begin();
+        for ( PendingQueue::iterator it = _pendingCommands.begin(); it != _pendingCommands.end();
+            ++it ) {
+
+            PendingCommand* candidate = *it;
+
+            if ( !candidate->status.isOK()
+                 || ( NULL != candidate->conn && replyReady( candidate->conn ) ) ) {
+                next = it;
+                break;
+            }
+        }
+
+        scoped_ptr<PendingCommand> command( *next );
+        _pendingCommands.erase( next );
 
         *endpoint = command->endpoint;
         if ( !command->status.isOK() ) return command->status;
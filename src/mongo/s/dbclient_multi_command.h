@@ -79,6 +79,10 @@ namespace mongo {
 
             // If anything goes wrong
             Status status;
+
+            // Whether sendAll() has already dispatched this command.  Allows sendAll() to
+            // be called again for newly-added commands while others are in flight.
+            bool sent;
         };
 
         typedef std::deque<PendingCommand*> PendingQueue;
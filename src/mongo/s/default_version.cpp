@@ -61,4 +61,8 @@ namespace mongo {
         return false;
     }
 
+    void VersionManager::batchSetShardVersionsCB( const string& ns, const vector<DBClientBase*>& conns ) {
+        return;
+    }
+
 }  // namespace mongo
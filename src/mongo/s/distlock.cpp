@@ -31,6 +31,7 @@ namespace mongo {
 
     LabeledLevel DistributedLock::logLvl( 1 );
     DistributedLock::LastPings DistributedLock::lastPings;
+    DistributedLock::Leases DistributedLock::leases;
 
     ThreadLocalValue<string> distLockIds("");
 
@@ -182,6 +183,23 @@ namespace mongo {
                     // Make sure no one else is adding to this list at the same time
                     scoped_lock lk( _mutex );
 
+                    // Move deferred unlocks whose lease has run out un-re-acquired into
+                    // the normal unlock queue.
+                    Date_t now = jsTime();
+                    for ( list< pair<OID, Date_t> >::iterator i = _deferredUnlockOIDs.begin();
+                          i != _deferredUnlockOIDs.end(); ) {
+                        if ( now >= i->second ) {
+                            LOG( DistributedLock::logLvl - 1 )
+                                << "lease expired for distributed lock with ts " << i->first
+                                << ", releasing" << endl;
+                            _oldLockOIDs.push_back( i->first );
+                            i = _deferredUnlockOIDs.erase( i );
+                        }
+                        else {
+                            ++i;
+                        }
+                    }
+
                     int numOldLocks = _oldLockOIDs.size();
                     if( numOldLocks > 0 ) {
                         LOG( DistributedLock::logLvl - 1 ) << "trying to delete " << _oldLockOIDs.size() << " old lock entries for process " << process << endl;
@@ -295,7 +313,33 @@ namespace mongo {
 
         bool willUnlockOID( const OID& oid ) {
             scoped_lock lk( _mutex );
-            return find( _oldLockOIDs.begin(), _oldLockOIDs.end(), oid ) != _oldLockOIDs.end();
+            if ( find( _oldLockOIDs.begin(), _oldLockOIDs.end(), oid ) != _oldLockOIDs.end() )
+                return true;
+            for ( list< pair<OID, Date_t> >::const_iterator i = _deferredUnlockOIDs.begin();
+                  i != _deferredUnlockOIDs.end(); ++i ) {
+                if ( i->first == oid ) return true;
+            }
+            return false;
+        }
+
+        void deferUnlockOID( const OID& oid, Date_t when ) {
+            // Lease-released lock, don't touch the config servers until the lease runs out
+            scoped_lock lk( _mutex );
+            _deferredUnlockOIDs.push_back( make_pair( oid, when ) );
+        }
+
+        bool cancelUnlockOID( const OID& oid ) {
+            // Re-acquiring within a lease, pull the deferred unlock back if it hasn't
+            // been promoted yet
+            scoped_lock lk( _mutex );
+            for ( list< pair<OID, Date_t> >::iterator i = _deferredUnlockOIDs.begin();
+                  i != _deferredUnlockOIDs.end(); ++i ) {
+                if ( i->first == oid ) {
+                    _deferredUnlockOIDs.erase( i );
+                    return true;
+                }
+            }
+            return false;
         }
 
         void kill( const ConnectionString& conn, const string& processId ) {
@@ -331,6 +375,8 @@ namespace mongo {
         set<string> _kill;
         set<string> _seen;
         list<OID> _oldLockOIDs;
+        // Lease-released locks waiting out their lease before being moved to _oldLockOIDs
+        list< pair<OID, Date_t> > _deferredUnlockOIDs;
 
     } distLockPinger;
 
@@ -362,6 +408,61 @@ namespace mongo {
         _lastPings[ std::pair< string, string >( conn.toString(), lockName ) ] = pd;
     }
 
+    bool DistributedLock::Leases::tryTake( const ConnectionString& conn, const string& lockName,
+                                           const string& processId, BSONObj* lockObj ) {
+        scoped_lock lock( _mutex );
+
+        map< std::pair<string, string>, LeaseData >::iterator it =
+            _leases.find( std::pair< string, string >( conn.toString(), lockName ) );
+        if ( it == _leases.end() ) return false;
+
+        LeaseData& lease = it->second;
+
+        // Must be released, ours, and still within the lease
+        if ( lease.held || lease.processId != processId || jsTime() >= lease.expires )
+            return false;
+
+        // The deferred config-side unlock must still be cancellable - if the pinger
+        // already promoted it the lock document may be freed at any moment
+        if ( ! distLockPinger.cancelUnlockOID( lease.ts ) )
+            return false;
+
+        lease.held = true;
+        *lockObj = lease.lockObj.getOwned();
+        return true;
+    }
+
+    void DistributedLock::Leases::noteAcquired( const ConnectionString& conn, const string& lockName,
+                                                const string& processId, const BSONObj& lockObj ) {
+        scoped_lock lock( _mutex );
+
+        LeaseData& lease = _leases[ std::pair< string, string >( conn.toString(), lockName ) ];
+        lease.processId = processId;
+        lease.lockObj = lockObj.getOwned();
+        lease.ts = lockObj[LocksType::lockID()].OID();
+        lease.held = true;
+        lease.expires = 0;
+    }
+
+    bool DistributedLock::Leases::noteReleased( const ConnectionString& conn, const string& lockName,
+                                                const OID& ts, unsigned long long leaseMillis ) {
+        scoped_lock lock( _mutex );
+
+        map< std::pair<string, string>, LeaseData >::iterator it =
+            _leases.find( std::pair< string, string >( conn.toString(), lockName ) );
+        if ( it == _leases.end() ) return false;
+
+        LeaseData& lease = it->second;
+
+        // Only the acquisition we recorded may be released under the lease
+        if ( ! lease.held || lease.ts != ts ) return false;
+
+        lease.held = false;
+        lease.expires = jsTime() + leaseMillis;
+        distLockPinger.deferUnlockOID( lease.ts, lease.expires );
+        return true;
+    }
+
     Date_t DistributedLock::getRemoteTime() {
         return DistributedLock::remoteTime( _conn, _maxNetSkew );
     }
@@ -601,6 +702,18 @@ namespace mongo {
         if ( other == NULL )
             other = &dummyOther;
 
+        // If we released this lock under a still-valid lease we may be able to
+        // re-acquire it locally, without any config server round trips.  Only safe
+        // for process-wide locks kept alive by the pinger.
+        if ( ! reenter && _processId == getDistLockProcess() && isLockPingerEnabled() ) {
+            if ( leases.tryTake( _conn, _name, _processId, other ) ) {
+                LOG( logLvl - 1 ) << "distributed lock '" << _name << "/" << _processId
+                                  << "' re-acquired within lease, ts : "
+                                  << (*other)[LocksType::lockID()].OID() << endl;
+                return true;
+            }
+        }
+
         ScopedDbConnection conn(_conn.toString(), timeout );
 
         BSONObjBuilder queryBuilder;
@@ -1028,6 +1141,11 @@ namespace mongo {
         else
             LOG( logLvl - 1 ) << "distributed lock '" << lockName << "' was not acquired." << endl;
 
+        // Record the acquisition so a later unlock/lock pair within the lease can be
+        // satisfied locally
+        if ( gotLock && _processId == getDistLockProcess() && isLockPingerEnabled() )
+            leases.noteAcquired( _conn, _name, _processId, currLock );
+
         conn.done();
 
         return gotLock;
@@ -1051,6 +1169,19 @@ namespace mongo {
         BSONObj oldLock;
         if( oldLockPtr ) oldLock = *oldLockPtr;
 
+        // If this lock was acquired under a lease, just mark it released locally and
+        // let the pinger free the config-side lock once the lease runs out
+        if ( isLockPingerEnabled() &&
+             ! oldLock[LocksType::state()].eoo() &&
+             oldLock[LocksType::state()].numberInt() == 2 &&
+             ! oldLock[LocksType::lockID()].eoo() &&
+             leases.noteReleased( _conn, _name, oldLock[LocksType::lockID()].OID(), _lockPing ) ) {
+            LOG( logLvl - 1 ) << "distributed lock '" << lockName
+                              << "' released under lease, ts : "
+                              << oldLock[LocksType::lockID()].OID() << endl;
+            return;
+        }
+
         while ( ++attempted <= maxAttempts ) {
 
             // Awkward, but necessary since the constructor itself throws exceptions
@@ -100,6 +100,58 @@ namespace mongo {
 
     	static LastPings lastPings;
 
+        struct LeaseData {
+
+            LeaseData() : held(false), expires(0) {}
+
+            string processId;
+            BSONObj lockObj; // the finalized lock document we hold on the config servers
+            OID ts;
+            bool held;      // some object in this process currently owns the lock
+            Date_t expires; // when a released lease stops being locally re-acquirable
+        };
+
+        /**
+         * Process-wide registry of leases on recently held locks. When a lock is
+         * released under lease, the config-side lock document stays held and its
+         * release is deferred, so a re-acquisition by this process within the lease
+         * touches only local state - no config server round trips. The pinger thread
+         * both renews the lease asynchronously (by pinging) and lazily releases the
+         * config-side lock once the lease runs out un-re-acquired.
+         */
+        class Leases {
+        public:
+            Leases() : _mutex( "DistributedLock::Leases" ) {}
+
+            /**
+             * Attempts to locally re-acquire a lock released under a still-valid lease.
+             * On success returns true and fills in lockObj with the lock document we
+             * still hold on the config servers.
+             */
+            bool tryTake( const ConnectionString& conn, const string& lockName,
+                          const string& processId, BSONObj* lockObj );
+
+            /**
+             * Records a successfully acquired (finalized) lock as lease-held.
+             */
+            void noteAcquired( const ConnectionString& conn, const string& lockName,
+                               const string& processId, const BSONObj& lockObj );
+
+            /**
+             * Marks a lease-held lock as released and schedules the deferred
+             * config-side unlock. Returns false if the lock is not covered by a lease
+             * (caller must then release it on the config servers itself).
+             */
+            bool noteReleased( const ConnectionString& conn, const string& lockName,
+                               const OID& ts, unsigned long long leaseMillis );
+
+        private:
+            mongo::mutex _mutex;
+            map< std::pair<string, string>, LeaseData > _leases;
+        };
+
+        static Leases leases;
+
         /**
          * The constructor does not connect to the configdb yet and constructing does not mean the lock was acquired.
          * Construction does trigger a lock "pinging" mechanism, though.
@@ -184,6 +184,21 @@ namespace mongo {
         virtual void disconnected( AbstractMessagingPort* p ) {
             // all things are thread local
         }
+
+        // Event-mode support: park the connection's ClientInfo between requests so any
+        // worker thread can service the next one.
+        virtual void* releaseThreadLocalState() {
+            return ClientInfo::releaseTL();
+        }
+
+        virtual void attachThreadLocalState( void* state ) {
+            if ( state )
+                ClientInfo::attachTL( static_cast<ClientInfo*>( state ) );
+        }
+
+        virtual void destroyThreadLocalState( void* state ) {
+            delete static_cast<ClientInfo*>( state );
+        }
     };
 
     void sighandler(int sig) {
@@ -46,6 +46,7 @@
 #include "mongo/db/auth/security_key.h"
 #include "mongo/db/commands.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/s/client_info.h"
 #include "mongo/s/config.h"
 #include "mongo/s/request.h"
@@ -423,11 +424,21 @@ namespace mongo {
     ShardStatus::ShardStatus( const Shard& shard , const BSONObj& obj )
         : _shard( shard ) {
         _mapped = obj.getFieldDotted( "mem.mapped" ).numberLong();
+        _opsTotal = 0;
+        if ( obj["opcounters"].isABSONObj() ) {
+            BSONObjIterator i( obj["opcounters"].Obj() );
+            while ( i.more() )
+                _opsTotal += i.next().numberLong();
+        }
         _hasOpsQueued = obj["writeBacksQueued"].Bool();
         _writeLock = 0; // TODO
         _mongoVersion = obj["version"].String();
     }
 
+    // snappy-compress traffic on connections to shards; useful when mongos and the
+    // shards are in different availability zones
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(shardWireCompression, bool, false);
+
     void ShardingConnectionHook::onCreate( DBClientBase * conn ) {
         if(getGlobalAuthorizationManager()->isAuthEnabled()) {
             LOG(2) << "calling onCreate auth for " << conn->toString() << endl;
@@ -453,6 +464,15 @@ namespace mongo {
 
         }
 
+        if ( shardWireCompression ) {
+            // only single connections own a port to compress on; replica set monitors
+            // hand out their underlying single connections through this hook too
+            DBClientConnection* single = dynamic_cast<DBClientConnection*>( conn );
+            if ( single && !single->negotiateWireCompression() ) {
+                LOG(2) << "wire compression not supported by " << conn->getServerAddress() << endl;
+            }
+        }
+
         // For every DBClient created by mongos, add a hook that will append impersonated users
         // to the end of every runCommand.  mongod uses this information to produce auditing
         // records attributed to the proper authenticated user(s).
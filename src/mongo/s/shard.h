@@ -197,8 +197,9 @@ namespace mongo {
 
         string toString() const {
             stringstream ss;
-            ss << "shard: " << _shard 
-               << " mapped: " << _mapped 
+            ss << "shard: " << _shard
+               << " mapped: " << _mapped
+               << " opsTotal: " << _opsTotal
                << " writeLock: " << _writeLock
                << " version: " << _mongoVersion;
             return ss.str();
@@ -216,6 +217,15 @@ namespace mongo {
             return _mapped;
         }
 
+        /**
+         * sum of the shard's opcounters (insert, query, update, ...) at the time
+         * serverStatus was run; the balancer diffs consecutive samples to get an
+         * ops/sec load figure per shard
+         */
+        long long opsTotal() const {
+            return _opsTotal;
+        }
+
         bool hasOpsQueued() const {
             return _hasOpsQueued;
         }
@@ -227,6 +237,7 @@ namespace mongo {
     private:
         Shard _shard;
         long long _mapped;
+        long long _opsTotal;
         bool _hasOpsQueued;  // true if 'writebacks' are pending
         double _writeLock;
         string _mongoVersion;
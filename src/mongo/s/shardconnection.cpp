@@ -253,7 +253,10 @@ namespace mongo {
             // Don't report exceptions here as errors in GetLastError
             LastError::Disabled ignoreForGLE(lastError.get(false));
 
-            // Now only check top-level shard connections
+            // Now only check top-level shard connections.  Gather them first, then
+            // version them all in one exchange so a cold pool pays one round trip
+            // total rather than one per shard.
+            vector<DBClientBase*> conns;
             for ( unsigned i=0; i<all.size(); i++ ) {
 
                 Shard& shard = all[i];
@@ -266,7 +269,7 @@ namespace mongo {
                         s->created++; // After, so failed creation doesn't get counted
                     }
 
-                    versionManager.checkShardVersionCB( s->avail, ns, false, 1 );
+                    conns.push_back( s->avail );
                 }
                 catch ( const DBException& ex ) {
 
@@ -277,6 +280,8 @@ namespace mongo {
                     // across multiple shards, and does not affect correctness.
                 }
             }
+
+            versionManager.batchSetShardVersionsCB( ns, conns );
         }
 
         void release( const string& addr , DBClientBase * conn ) {
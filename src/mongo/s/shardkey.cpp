@@ -32,6 +32,7 @@
 
 #include "mongo/s/chunk.h"
 #include "mongo/s/shard_key_pattern.h"
+#include "mongo/db/hasher.h"
 #include "mongo/db/jsobj.h"
 #include "mongo/db/json.h"
 #include "mongo/util/startup_test.h"
@@ -50,12 +51,75 @@ namespace mongo {
             BSONElement e (it.next());
             min.appendMinKey(e.fieldName());
             max.appendMaxKey(e.fieldName());
+
+            // compile the field for extractKey: split the dotted path once,
+            // keeping the remaining suffix at every level
+            CompiledField f;
+            f.dottedName = e.fieldName();
+            StringData rest( f.dottedName );
+            while ( true ) {
+                PathPart part;
+                part.suffix = rest.toString();
+                size_t dot = rest.find( '.' );
+                if ( dot == string::npos ) {
+                    part.name = part.suffix;
+                    f.parts.push_back( part );
+                    break;
+                }
+                part.name = rest.substr( 0, dot ).toString();
+                f.parts.push_back( part );
+                rest = rest.substr( dot + 1 );
+            }
+            _compiled.push_back( f );
         }
 
+        _hashed = str::equals( pattern.toBSON().firstElement().valuestrsafe(), "hashed" );
+
         gMin = min.obj();
         gMax = max.obj();
     }
 
+    BSONElement ShardKeyPattern::_descend( const BSONObj& from, const CompiledField& f ) {
+        BSONObj cur = from;
+        for ( size_t d = 0; d < f.parts.size(); d++ ) {
+            // literal match of the remaining dotted name first, as getFieldDotted does
+            BSONElement e = cur.getField( f.parts[d].suffix );
+            if ( !e.eoo() )
+                return e;
+            if ( d + 1 == f.parts.size() )
+                return BSONElement();
+            BSONElement sub = cur.getField( f.parts[d].name );
+            if ( sub.type() != Object && sub.type() != Array )
+                return BSONElement();
+            cur = sub.embeddedObject();
+        }
+        return BSONElement();
+    }
+
+    BSONObj ShardKeyPattern::_extractCompiled( const BSONObj& from ) const {
+        if ( _compiled.empty() )
+            return BSONObj();
+
+        if ( _hashed ) {
+            // mirrors KeyPattern::extractSingleKey: a leading hashed field is
+            // the whole key
+            const CompiledField& f = _compiled[0];
+            BSONObjBuilder b;
+            b.append( f.dottedName,
+                      BSONElementHasher::hash64( _descend( from, f ),
+                                                 BSONElementHasher::DEFAULT_HASH_SEED ) );
+            return b.obj();
+        }
+
+        BSONObjBuilder b(64);
+        for ( size_t i = 0; i < _compiled.size(); i++ ) {
+            BSONElement e = _descend( from, _compiled[i] );
+            if ( !e.eoo() )
+                b.appendAs( e, _compiled[i].dottedName );
+        }
+        return b.obj();
+    }
+
     bool ShardKeyPattern::hasShardKey( const BSONObj& obj ) const {
         /* this is written s.t. if obj has lots of fields, if the shard key fields are early,
            it is fast.  so a bit more work to try to be semi-fast.
@@ -203,6 +267,15 @@ namespace mongo {
             BSONObj x = fromjson("{a:1,'sub.b':2,'sub.c':3}");
             verify( k.extractKey( fromjson("{a:1,sub:{b:2,c:3}}") ).binaryEqual(x) );
             verify( k.extractKey( fromjson("{sub:{b:2,c:3},a:1}") ).binaryEqual(x) );
+
+            // literal dotted field names win over descent, as with getFieldDotted
+            verify( k.extractKey( fromjson("{a:1,'sub.b':2,sub:{c:3}}") ).binaryEqual(x) );
+
+            // hashed keys go through the compiled path too
+            ShardKeyPattern h( BSON( "a" << "hashed" ) );
+            BSONObj doc = BSON( "a" << 1 << "b" << 2 );
+            verify( h.extractKey( doc ).binaryEqual(
+                        KeyPattern( BSON( "a" << "hashed" ) ).extractSingleKey( doc ) ) );
         }
 
         void isSpecialTest() {
@@ -158,10 +158,30 @@ namespace mongo {
 
         /* question: better to have patternfields precomputed or not?  depends on if we use copy constructor often. */
         set<string> patternfields;
+
+        /** the pattern compiled once (in the constructor) into a direct
+            extraction program: per field, the pre-split path components and
+            at each level the remaining dotted suffix (getFieldDotted matches
+            literal dotted field names before descending, so we must too).
+            extractKey then never re-parses the dotted names. */
+        struct PathPart {
+            string name;   // single path component
+            string suffix; // this component plus the rest, dotted
+        };
+        struct CompiledField {
+            string dottedName;      // full pattern field name, emitted in the key
+            vector<PathPart> parts; // descent order
+        };
+
+        static BSONElement _descend( const BSONObj& from, const CompiledField& f );
+        BSONObj _extractCompiled( const BSONObj& from ) const;
+
+        vector<CompiledField> _compiled;
+        bool _hashed; // first pattern element is "hashed": emit only its hash
     };
 
     inline BSONObj ShardKeyPattern::extractKey(const BSONObj& from) const {
-        BSONObj k = pattern.extractSingleKey( from );
+        BSONObj k = _extractCompiled( from );
         uassert(13334, "Shard Key must be less than 512 bytes", k.objsize() < 512);
         return k;
     }
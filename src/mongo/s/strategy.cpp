@@ -157,7 +157,7 @@ namespace mongo {
                 cursorCache.store( cc, cursorLeftoverMillis );
             }
 
-            replyToQuery( 0, r.p(), r.m(), buffer.buf(), buffer.len(), docCount,
+            replyToQuery( 0, r.p(), r.m(), buffer, docCount,
                     startFrom, hasMore ? cc->getId() : 0 );
         }
         else{
@@ -495,7 +495,7 @@ namespace mongo {
                 cursorCache.remove( id );
             }
 
-            replyToQuery( 0, r.p(), r.m(), buffer.buf(), buffer.len(), docCount,
+            replyToQuery( 0, r.p(), r.m(), buffer, docCount,
                     startFrom, hasMore ? cursor->getId() : 0 );
             return;
         }
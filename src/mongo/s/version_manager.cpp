@@ -30,6 +30,7 @@
 
 #include "mongo/s/version_manager.h"
 
+#include "mongo/client/parallel.h"
 #include "mongo/s/chunk.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/config.h"
@@ -325,6 +326,78 @@ namespace mongo {
         return true;
     }
 
+    void VersionManager::batchSetShardVersionsCB( const string& ns, const vector<DBClientBase*>& conns ) {
+
+        DBConfigPtr conf = grid.getDBConfig( ns );
+        if ( ! conf )
+            return;
+
+        unsigned long long officialSequenceNumber = 0;
+
+        ChunkManagerPtr manager;
+        const bool isSharded = conf->isSharded( ns );
+        if ( isSharded ) {
+            manager = conf->getChunkManagerIfExists( ns, false );
+            if ( manager )
+                officialSequenceNumber = manager->getSequenceNumber();
+        }
+
+        // send phase: queue a setShardVersion on every connection that is behind,
+        // without waiting for any reply
+        vector<DBClientBase*> pending;
+        vector< shared_ptr<Future::CommandResult> > sent;
+        for ( size_t i = 0; i < conns.size(); i++ ) {
+            DBClientBase* conn_in = conns[i];
+            try {
+                WriteBackListener::init( *conn_in );
+
+                DBClientBase* conn = getVersionable( conn_in );
+                verify( conn ); // errors thrown above
+
+                if ( connectionShardStatus.getSequence( conn, ns ) == officialSequenceNumber )
+                    continue;
+
+                ChunkVersion version = ChunkVersion( 0, OID() );
+                if ( isSharded && manager )
+                    version = manager->getVersion( Shard::make( conn->getServerAddress() ) );
+
+                BSONObj cmd = buildSetShardVersionCmd( *conn, ns, version, false );
+
+                LOG(2) << "queueing setShardVersion of " << ns << " on "
+                       << conn->getServerAddress() << " version: " << version << endl;
+
+                pending.push_back( conn_in );
+                sent.push_back( Future::spawnCommand( conn->getServerAddress(),
+                                                      "admin", cmd, 0, conn ) );
+            }
+            catch ( const DBException& ex ) {
+                warning() << "could not queue setShardVersion of " << ns << " on "
+                          << conn_in->getServerAddress() << causedBy( ex ) << endl;
+            }
+        }
+
+        // receive phase: collect the replies; anything unexpected goes through
+        // the ordinary checkShardVersion retry machinery for that connection
+        for ( size_t i = 0; i < sent.size(); i++ ) {
+            DBClientBase* conn_in = pending[i];
+            try {
+                if ( sent[i]->join() ) {
+                    LOG(1) << "      setShardVersion success: " << sent[i]->result() << endl;
+                    connectionShardStatus.setSequence( getVersionable( conn_in ),
+                                                       ns, officialSequenceNumber );
+                    continue;
+                }
+
+                LOG(1) << "       setShardVersion failed!\n" << sent[i]->result() << endl;
+                checkShardVersionCB( conn_in, ns, false, 1 );
+            }
+            catch ( const DBException& ex ) {
+                warning() << "problem while bulk setting shard version of " << ns << " on "
+                          << conn_in->getServerAddress() << causedBy( ex ) << endl;
+            }
+        }
+    }
+
     bool VersionManager::checkShardVersionCB( DBClientBase* conn_in , const string& ns , bool authoritative , int tryNumber ) {
         return checkShardVersion( conn_in, ns, ChunkManagerPtr(), authoritative, tryNumber );
     }
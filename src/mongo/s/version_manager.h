@@ -46,6 +46,16 @@ namespace mongo {
         bool checkShardVersionCB( ShardConnection*, bool, int );
         void resetShardVersionCB( DBClientBase* );
 
+        /**
+         * Versions a namespace on several pooled connections at once: every
+         * connection that is behind has its setShardVersion sent before any
+         * reply is awaited, so a cold pool pays one round trip for the whole
+         * batch instead of one per connection.  Best effort - failures fall
+         * back to the ordinary per-connection retry path and are reported as
+         * warnings only.
+         */
+        void batchSetShardVersionsCB( const string& ns, const vector<DBClientBase*>& conns );
+
     };
 
     extern VersionManager versionManager;
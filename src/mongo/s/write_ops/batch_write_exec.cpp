@@ -28,6 +28,8 @@
 
 #include "mongo/s/write_ops/batch_write_exec.h"
 
+#include <deque>
+
 #include "mongo/base/error_codes.h"
 #include "mongo/base/status.h"
 #include "mongo/client/dbclientinterface.h" // ConnectionString (header-only)
@@ -76,195 +78,228 @@ namespace mongo {
         BatchWriteOp batchOp;
         batchOp.initClientRequest( &clientRequest );
 
+        const bool ordered = clientRequest.getOrdered();
+
         int numTargetErrors = 0;
         int numStaleBatches = 0;
         int numResolveFailures = 0;
 
-        for ( int rounds = 0; !batchOp.isFinished(); rounds++ ) {
+        //
+        // Each shard leg progresses independently here: as soon as one host's response
+        // arrives we retarget and redispatch any write ops it freed up, while the other
+        // hosts' batches stay out on the network.  One slow shard therefore only delays
+        // the writes actually bound for it.
+        //
+
+        // Targeted batches not yet out on the network
+        deque<TargetedWriteBatch*> readyBatches;
+
+        // Batches out on the network, mapped by endpoint
+        HostBatchMap pendingBatches;
+
+        // Whether write ops may have become ready for (re)targeting
+        bool needsTargeting = true;
+
+        while ( true ) {
+
+            if ( batchOp.isFinished() && pendingBatches.empty() )
+                break;
 
             //
-            // Refresh the targeter if we need to (no-op if nothing stale)
+            // Refresh the targeter if we need to (no-op if nothing stale) and get child
+            // batches to send.  Ordered batches are strictly one-at-a-time, so they only
+            // target when nothing is queued or in flight.
             //
 
-            Status refreshStatus = _targeter->refreshIfNeeded();
+            if ( needsTargeting && !batchOp.isFinished() &&
+                 ( !ordered || ( pendingBatches.empty() && readyBatches.empty() ) ) ) {
+
+                Status refreshStatus = _targeter->refreshIfNeeded();
+
+                if ( !refreshStatus.isOK() ) {
 
-            if ( !refreshStatus.isOK() ) {
+                    // It's okay if we can't refresh, we'll just record errors for the ops if
+                    // needed.
+                    warning() << "could not refresh targeter"
+                              << causedBy( refreshStatus.reason() ) << endl;
+                }
+
+                //
+                // Targeting errors can be caused by remote metadata changing (the collection could
+                // have been dropped and recreated, for example with a new shard key).  If a remote
+                // metadata change occurs *before* a client sends us a batch, we need to make sure
+                // that we don't error out just because we're staler than the client - otherwise
+                // mongos will be have unpredictable behavior.
+                //
+                // (If a metadata change happens *during* or *after* a client sends us a batch,
+                // however, we make no guarantees about delivery.)
+                //
+                // For this reason, we don't record targeting errors until we've refreshed our
+                // targeting metadata at least once *after* receiving the client batch - at that
+                // point, we know:
+                //
+                // 1) our new metadata is the same as the metadata when the client sent a batch,
+                //    and so targeting errors are real.
+                // OR
+                // 2) our new metadata is a newer version than when the client sent a batch, and so
+                //    the metadata must have changed after the client batch was sent.  We don't
+                //    need to deliver in this case, since for all the client knows we may have
+                //    gotten the batch exactly when the metadata changed.
+                //
+                // If we've had a targeting error or stale error, we've refreshed the metadata once
+                // and can record target errors.
+                bool recordTargetErrors = numTargetErrors > 0 || numStaleBatches > 0;
+
+                vector<TargetedWriteBatch*> childBatches;
+                Status targetStatus = batchOp.targetBatch( *_targeter,
+                                                           recordTargetErrors,
+                                                           &childBatches );
+                if ( !targetStatus.isOK() ) {
+                    _targeter->noteCouldNotTarget();
+                    ++numTargetErrors;
+                    continue;
+                }
 
-                // It's okay if we can't refresh, we'll just record errors for the ops if
-                // needed.
-                warning() << "could not refresh targeter" << causedBy( refreshStatus.reason() )
-                          << endl;
+                readyBatches.insert( readyBatches.end(),
+                                     childBatches.begin(),
+                                     childBatches.end() );
+                needsTargeting = false;
             }
 
             //
-            // Get child batches to send
+            // Send side : dispatch every ready batch whose host has nothing in flight
             //
 
-            vector<TargetedWriteBatch*> childBatches;
+            size_t numSentNow = 0;
+            for ( deque<TargetedWriteBatch*>::iterator it = readyBatches.begin();
+                !batchOp.isFinished() && it != readyBatches.end(); ) {
 
-            //
-            // Targeting errors can be caused by remote metadata changing (the collection could have
-            // been dropped and recreated, for example with a new shard key).  If a remote metadata
-            // change occurs *before* a client sends us a batch, we need to make sure that we don't
-            // error out just because we're staler than the client - otherwise mongos will be have
-            // unpredictable behavior.
-            //
-            // (If a metadata change happens *during* or *after* a client sends us a batch, however,
-            // we make no guarantees about delivery.)
-            //
-            // For this reason, we don't record targeting errors until we've refreshed our targeting
-            // metadata at least once *after* receiving the client batch - at that point, we know:
-            //
-            // 1) our new metadata is the same as the metadata when the client sent a batch, and so
-            //    targeting errors are real.
-            // OR
-            // 2) our new metadata is a newer version than when the client sent a batch, and so
-            //    the metadata must have changed after the client batch was sent.  We don't need to
-            //    deliver in this case, since for all the client knows we may have gotten the batch
-            //    exactly when the metadata changed.
-            //
-            // If we've had a targeting error or stale error, we've refreshed the metadata once and
-            // can record target errors.
-            bool recordTargetErrors = numTargetErrors > 0 || numStaleBatches > 0;
-            Status targetStatus = batchOp.targetBatch( *_targeter,
-                                                       recordTargetErrors,
-                                                       &childBatches );
-            if ( !targetStatus.isOK() ) {
-                _targeter->noteCouldNotTarget();
-                ++numTargetErrors;
+                TargetedWriteBatch* nextBatch = *it;
+
+                // Figure out what host we need to dispatch our targeted batch
+                ConnectionString shardHost;
+                Status resolveStatus = _resolver->chooseWriteHost( nextBatch->getEndpoint()
+                                                                       .shardName,
+                                                                   &shardHost );
+                if ( !resolveStatus.isOK() ) {
+
+                    ++numResolveFailures;
+
+                    // Record a resolve failure
+                    // TODO: It may be necessary to refresh the cache if stale, or maybe just
+                    // cancel and retarget the batch
+                    WriteErrorDetail error;
+                    buildErrorFrom( resolveStatus, &error );
+                    batchOp.noteBatchError( *nextBatch, error );
+
+                    // We're done with this batch
+                    delete nextBatch;
+                    it = readyBatches.erase( it );
+                    continue;
+                }
+
+                // If we already have a batch in flight for this host, wait for its response
+                // We'll only get duplicate hostEndpoints if we have broadcast and non-broadcast
+                // endpoints for the same host, so this should be pretty efficient.
+                if ( pendingBatches.find( shardHost ) != pendingBatches.end() ) {
+                    ++it;
+                    continue;
+                }
+
+                //
+                // We now have all the info needed to dispatch the batch
+                //
+
+                BatchedCommandRequest request( clientRequest.getBatchType() );
+                batchOp.buildBatchRequest( *nextBatch, &request );
+
+                // Internally we use full namespaces for request/response, but we send the
+                // command to a database with the collection name in the request.
+                NamespaceString nss( request.getNS() );
+                request.setNS( nss.coll() );
+
+                _dispatcher->addCommand( shardHost, nss.db(), request );
+
+                // Recv-side is responsible for cleaning up the nextBatch when used
+                pendingBatches.insert( make_pair( shardHost, nextBatch ) );
+                it = readyBatches.erase( it );
+                ++numSentNow;
+            }
+
+            // Send them all out
+            if ( numSentNow > 0 )
+                _dispatcher->sendAll();
+
+            if ( pendingBatches.empty() ) {
+                if ( batchOp.isFinished() )
+                    break;
+                needsTargeting = true;
                 continue;
             }
 
             //
-            // Send all child batches
+            // Recv side : take one response, note it, and loop so the freed write ops can
+            // be retargeted and redispatched while the other legs stay in flight
             //
 
-            size_t numSent = 0;
-            size_t numToSend = childBatches.size();
-            while ( numSent != numToSend ) {
+            // Get the response
+            ConnectionString shardHost;
+            BatchedCommandResponse response;
+            Status dispatchStatus = _dispatcher->recvAny( &shardHost, &response );
 
-                // Collect batches out on the network, mapped by endpoint
-                HostBatchMap pendingBatches;
+            // Get the TargetedWriteBatch to find where to put the response
+            dassert( pendingBatches.find( shardHost ) != pendingBatches.end() );
+            TargetedWriteBatch* batchRaw = pendingBatches.find( shardHost )->second;
+            pendingBatches.erase( shardHost );
+            scoped_ptr<TargetedWriteBatch> batch( batchRaw );
 
-                //
-                // Send side
-                //
+            if ( dispatchStatus.isOK() ) {
 
-                // Get as many batches as we can at once
-                for ( vector<TargetedWriteBatch*>::iterator it = childBatches.begin();
-                    it != childBatches.end(); ++it ) {
-
-                    //
-                    // Collect the info needed to dispatch our targeted batch
-                    //
-
-                    TargetedWriteBatch* nextBatch = *it;
-                    // If the batch is NULL, we sent it previously, so skip
-                    if ( nextBatch == NULL ) continue;
-
-                    // Figure out what host we need to dispatch our targeted batch
-                    ConnectionString shardHost;
-                    Status resolveStatus = _resolver->chooseWriteHost( nextBatch->getEndpoint()
-                                                                           .shardName,
-                                                                       &shardHost );
-                    if ( !resolveStatus.isOK() ) {
-
-                        ++numResolveFailures;
-
-                        // Record a resolve failure
-                        // TODO: It may be necessary to refresh the cache if stale, or maybe just
-                        // cancel and retarget the batch
-                        WriteErrorDetail error;
-                        buildErrorFrom( resolveStatus, &error );
-                        batchOp.noteBatchError( *nextBatch, error );
-
-                        // We're done with this batch
-                        *it = NULL;
-                        --numToSend;
-                        continue;
-                    }
-
-                    // If we already have a batch for this host, wait until the next time
-                    HostBatchMap::iterator pendingIt = pendingBatches.find( shardHost );
-                    if ( pendingIt != pendingBatches.end() ) continue;
-
-                    //
-                    // We now have all the info needed to dispatch the batch
-                    //
-
-                    BatchedCommandRequest request( clientRequest.getBatchType() );
-                    batchOp.buildBatchRequest( *nextBatch, &request );
-
-                    // Internally we use full namespaces for request/response, but we send the
-                    // command to a database with the collection name in the request.
-                    NamespaceString nss( request.getNS() );
-                    request.setNS( nss.coll() );
-
-                    _dispatcher->addCommand( shardHost, nss.db(), request );
-
-                    // Indicate we're done by setting the batch to NULL
-                    // We'll only get duplicate hostEndpoints if we have broadcast and non-broadcast
-                    // endpoints for the same host, so this should be pretty efficient without
-                    // moving stuff around.
-                    *it = NULL;
-
-                    // Recv-side is responsible for cleaning up the nextBatch when used
-                    pendingBatches.insert( make_pair( shardHost, nextBatch ) );
-                }
+                TrackedErrors trackedErrors;
+                trackedErrors.startTracking( ErrorCodes::StaleShardVersion );
 
-                // Send them all out
-                _dispatcher->sendAll();
-                numSent += pendingBatches.size();
+                // Dispatch was ok, note response
+                batchOp.noteBatchResponse( *batch, response, &trackedErrors );
 
-                //
-                // Recv side
-                //
+                // Note if anything was stale
+                const vector<ShardError*>& staleErrors =
+                    trackedErrors.getErrors( ErrorCodes::StaleShardVersion );
 
-                while ( _dispatcher->numPending() > 0 ) {
-
-                    // Get the response
-                    ConnectionString shardHost;
-                    BatchedCommandResponse response;
-                    Status dispatchStatus = _dispatcher->recvAny( &shardHost, &response );
-
-                    // Get the TargetedWriteBatch to find where to put the response
-                    dassert( pendingBatches.find( shardHost ) != pendingBatches.end() );
-                    TargetedWriteBatch* batchRaw = pendingBatches.find( shardHost )->second;
-                    scoped_ptr<TargetedWriteBatch> batch( batchRaw );
-
-                    if ( dispatchStatus.isOK() ) {
-
-                        TrackedErrors trackedErrors;
-                        trackedErrors.startTracking( ErrorCodes::StaleShardVersion );
-
-                        // Dispatch was ok, note response
-                        batchOp.noteBatchResponse( *batch, response, &trackedErrors );
-
-                        // Note if anything was stale
-                        const vector<ShardError*>& staleErrors =
-                            trackedErrors.getErrors( ErrorCodes::StaleShardVersion );
-
-                        if ( staleErrors.size() > 0 ) {
-                            noteStaleResponses( staleErrors, _targeter );
-                            ++numStaleBatches;
-                        }
-
-                        // Remember that we successfully wrote to this shard
-                        // NOTE: This will record lastOps for shards where we actually didn't update
-                        // or delete any documents, which preserves old behavior but is conservative
-                        _stats->noteWriteAt( shardHost,
-                                             response.isLastOpSet() ? 
-                                             response.getLastOp() : OpTime() );
-                    }
-                    else {
-
-                        // Error occurred dispatching, note it
-                        WriteErrorDetail error;
-                        buildErrorFrom( dispatchStatus, &error );
-                        batchOp.noteBatchError( *batch, error );
-                    }
+                if ( staleErrors.size() > 0 ) {
+                    noteStaleResponses( staleErrors, _targeter );
+                    ++numStaleBatches;
                 }
+
+                // Remember that we successfully wrote to this shard
+                // NOTE: This will record lastOps for shards where we actually didn't update
+                // or delete any documents, which preserves old behavior but is conservative
+                _stats->noteWriteAt( shardHost,
+                                     response.isLastOpSet() ?
+                                     response.getLastOp() : OpTime() );
             }
+            else {
+
+                // Error occurred dispatching, note it
+                WriteErrorDetail error;
+                buildErrorFrom( dispatchStatus, &error );
+                batchOp.noteBatchError( *batch, error );
+            }
+
+            needsTargeting = true;
+        }
+
+        // If the batch op completed early on a batch-level error, targeted batches that
+        // never made it onto the wire still need to be resolved
+        while ( !readyBatches.empty() ) {
+
+            scoped_ptr<TargetedWriteBatch> batch( readyBatches.front() );
+            readyBatches.pop_front();
+
+            WriteErrorDetail error;
+            buildErrorFrom( Status( ErrorCodes::UnknownError,
+                                    "batch op was aborted before this write was sent" ),
+                            &error );
+            batchOp.noteBatchError( *batch, error );
         }
 
         batchOp.buildClientResponse( clientResponse );
@@ -32,8 +32,10 @@
 
 #include "writeback_listener.h"
 
+#include "mongo/base/counter.h"
 #include "mongo/db/auth/authorization_manager.h"
 #include "mongo/db/auth/authorization_session.h"
+#include "mongo/db/commands/server_status.h"
 #include "mongo/s/chunk_version.h"
 #include "mongo/s/client_info.h"
 #include "mongo/s/config.h"
@@ -50,6 +52,27 @@ namespace mongo {
     unordered_set<string> WriteBackListener::_seenSets;
     mongo::mutex WriteBackListener::_cacheLock("WriteBackListener");
 
+    namespace {
+
+        // how many queued entries we ask a shard to return per writebacklisten
+        // poll; older mongods ignore the field and return one
+        const int maxWritebackBatchSize = 50;
+
+        // polls that came back empty after the server-side wait are wasted
+        // round trips; comparing them against entry counts shows whether a
+        // migration-heavy period is being absorbed in batches or one op at a time
+        Counter64 writebackPolls;
+        Counter64 writebackPollsNoop;
+        Counter64 writebackEntriesReceived;
+
+        ServerStatusMetricField<Counter64> displayWritebackPolls(
+                "writebacks.polls", &writebackPolls );
+        ServerStatusMetricField<Counter64> displayWritebackPollsNoop(
+                "writebacks.pollsNoop", &writebackPollsNoop );
+        ServerStatusMetricField<Counter64> displayWritebackEntries(
+                "writebacks.entries", &writebackEntriesReceived );
+    }
+
     WriteBackListener::WriteBackListener( const string& addr ) : _addr( addr ) {
         _name = str::stream() << "WriteBackListener-" << addr;
         log() << "creating WriteBackListener for: " << addr << " serverID: " << serverID << endl;
@@ -128,6 +151,8 @@ namespace mongo {
                 {
                     BSONObjBuilder cmd;
                     cmd.appendOID( "writebacklisten" , &serverID ); // Command will block for data
+                    cmd.append( "maxBatch" , maxWritebackBatchSize );
+                    writebackPolls.increment();
                     if ( ! conn->runCommand( "admin" , cmd.obj() , result ) ) {
                         result = result.getOwned();
                         log() <<  "writebacklisten command failed!  "  << result << endl;
@@ -140,23 +165,56 @@ namespace mongo {
 
                 LOG(1) << "writebacklisten result from pre-2.6 server: " << result << endl;
 
-                BSONObj data = result.getObjectField( "data" );
-                if ( data.getBoolField( "writeBack" ) ) {
-                    string ns = data["ns"].valuestrsafe();
+                // batching servers return everything in dataBatch (the first
+                // entry is duplicated in data for older mongos); others return
+                // a single entry in data
+                vector<BSONObj> entries;
+                if ( result["dataBatch"].type() == Array ) {
+                    BSONObjIterator it( result["dataBatch"].Obj() );
+                    while ( it.more() )
+                        entries.push_back( it.next().Obj() );
+                }
+                else {
+                    BSONObj single = result.getObjectField( "data" );
+                    if ( single.getBoolField( "writeBack" ) )
+                        entries.push_back( single );
+                }
+
+                if ( ! entries.empty() ) {
+                    writebackEntriesReceived.increment( entries.size() );
 
-                    if ( !data["connectionId"].isNumber() || !data["id"].type() == jstOID ) {
-                        warning() << "mongos/mongod version mismatch (1.7.5 is the split)" << endl;
-                    }
+                    map<string,int> countsByNs;
+                    for ( unsigned i = 0; i < entries.size(); i++ ) {
+                        const BSONObj& data = entries[i];
+                        countsByNs[ data["ns"].valuestrsafe() ]++;
+
+                        if ( !data["connectionId"].isNumber() || !data["id"].type() == jstOID ) {
+                            warning() << "mongos/mongod version mismatch (1.7.5 is the split)" << endl;
+                        }
 
-                    int len; // not used, but needed for next call
-                    Message msg( (void*)data["msg"].binData( len ) , false );
+                        int len; // not used, but needed for next call
+                        Message msg( (void*)data["msg"].binData( len ) , false );
+
+                        if ( !msg.header()->valid() ) {
+                            warning() << "invalid writeback message detected: " << data << endl;
+                        }
+                    }
 
-                    if ( !msg.header()->valid() ) {
-                        warning() << "invalid writeback message detected: " << result << endl;
+                    if ( entries.size() > 1 ) {
+                        StringBuilder ss;
+                        for ( map<string,int>::const_iterator i = countsByNs.begin();
+                              i != countsByNs.end(); ++i ) {
+                            if ( i != countsByNs.begin() )
+                                ss << ", ";
+                            ss << i->first << ": " << i->second;
+                        }
+                        LOG(1) << "writebacklisten batch of " << entries.size()
+                               << " entries from " << _addr << " (" << ss.str() << ")" << endl;
                     }
                 }
                 else if ( result["noop"].trueValue() ) {
-                    // no-op
+                    // wasted round trip: the server-side wait expired with nothing queued
+                    writebackPollsNoop.increment();
                 }
                 else {
                     log() << "unknown writeBack result: " << result << endl;
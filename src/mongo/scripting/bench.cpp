@@ -68,7 +68,19 @@ namespace {
 
 namespace mongo {
 
-    BenchRunEventCounter::BenchRunEventCounter() {
+    namespace {
+        // Log-spaced latency buckets: 1us, 2us, 4us, ... ~67s, with anything slower
+        // falling into the last bucket.
+        Histogram::Options latencyHistogramOptions() {
+            Histogram::Options opts;
+            opts.numBuckets = 28;
+            opts.bucketSize = 1;
+            opts.exponential = true;
+            return opts;
+        }
+    }  // namespace
+
+    BenchRunEventCounter::BenchRunEventCounter() : _histogram( latencyHistogramOptions() ) {
         reset();
     }
 
@@ -77,11 +89,28 @@ namespace mongo {
     void BenchRunEventCounter::reset() {
         _numEvents = 0;
         _totalTimeMicros = 0;
+        _histogram.reset();
     }
 
     void BenchRunEventCounter::updateFrom(const BenchRunEventCounter &other) {
         _numEvents += other._numEvents;
         _totalTimeMicros += other._totalTimeMicros;
+        _histogram.merge(other._histogram);
+    }
+
+    unsigned long long BenchRunEventCounter::getPercentileMicros( double fraction ) const {
+        if (_numEvents == 0)
+            return 0;
+
+        // Report the upper boundary of the bucket the requested quantile falls in, so
+        // the result is conservative to within one log-spaced bucket.
+        uint64_t seen = 0;
+        for (uint32_t i = 0; i < _histogram.getBucketsNum(); ++i) {
+            seen += _histogram.getCount(i);
+            if (static_cast<double>(seen) >= fraction * _numEvents)
+                return _histogram.getBoundary(i);
+        }
+        return _histogram.getBoundary(_histogram.getBucketsNum() - 1);
     }
 
     BenchRunStats::BenchRunStats() {
@@ -143,6 +172,9 @@ namespace mongo {
 
         throwGLE = false;
         breakOnTrap = true;
+
+        targetRate = 0;
+        intervalReportSecs = 0;
     }
 
     BenchRunConfig *BenchRunConfig::createFromBson( const BSONObj &args ) {
@@ -178,6 +210,11 @@ namespace mongo {
         if ( ! args["breakOnTrap"].eoo() )
             this->breakOnTrap = args["breakOnTrap"].trueValue();
 
+        if ( args["targetRate"].isNumber() )
+            this->targetRate = args["targetRate"].number();
+        if ( args["intervalReportSecs"].isNumber() )
+            this->intervalReportSecs = args["intervalReportSecs"].numberInt();
+
         uassert(16164, "loopCommands config not supported", args["loopCommands"].eoo());
 
         if ( ! args["trapPattern"].eoo() ){
@@ -323,6 +360,30 @@ namespace mongo {
 
     void doNothing(const BSONObj&) { }
 
+    static void appendLatencyPercentilesIfAvailable(
+            BSONObjBuilder &buf, const std::string &name, const BenchRunEventCounter &counter) {
+
+        if (counter.getNumEvents() == 0)
+            return;
+        BSONObjBuilder sub(buf.subobjStart(name));
+        sub.append("p50", static_cast<long long>(counter.getPercentileMicros(0.50)));
+        sub.append("p95", static_cast<long long>(counter.getPercentileMicros(0.95)));
+        sub.append("p99", static_cast<long long>(counter.getPercentileMicros(0.99)));
+        sub.append("p999", static_cast<long long>(counter.getPercentileMicros(0.999)));
+        sub.done();
+    }
+
+    void BenchRunWorker::reportIntervalStats( long long elapsedMicros ) const {
+        BSONObjBuilder b;
+        appendLatencyPercentilesIfAvailable( b, "findOne", _stats.findOneCounter );
+        appendLatencyPercentilesIfAvailable( b, "insert", _stats.insertCounter );
+        appendLatencyPercentilesIfAvailable( b, "delete", _stats.deleteCounter );
+        appendLatencyPercentilesIfAvailable( b, "update", _stats.updateCounter );
+        appendLatencyPercentilesIfAvailable( b, "query", _stats.queryCounter );
+        log() << "benchRun thread latency percentiles (micros) at "
+              << ( elapsedMicros / 1000000 ) << "s : " << b.obj() << endl;
+    }
+
     void BenchRunWorker::generateLoadOnConnection( DBClientBase* conn ) {
         verify( conn );
         long long count = 0;
@@ -330,6 +391,20 @@ namespace mongo {
 
         BsonTemplateEvaluator bsonTemplateEvaluator;
 
+        // With a fixed target rate each op gets an intended start time on a fixed
+        // schedule.  We sleep until that time when ahead; when behind, the wait is
+        // charged to the op's latency so a stall can't quietly lower the offered rate
+        // and hide itself from the percentiles (coordinated omission).
+        long long scheduleIntervalMicros = 0;
+        if ( _config->targetRate > 0 )
+            scheduleIntervalMicros =
+                static_cast<long long>( 1000000.0 * _config->parallel / _config->targetRate );
+        long long nextOpStartMicros = scheduleIntervalMicros;
+        unsigned long long opLagMicros = 0;
+
+        const long long intervalReportMicros = 1000000LL * _config->intervalReportSecs;
+        long long nextReportMicros = intervalReportMicros;
+
         while ( !shouldStop() ) {
             BSONObjIterator i( _config->ops );
             while ( i.more() ) {
@@ -379,12 +454,24 @@ namespace mongo {
                     }
                 }
 
+                if ( scheduleIntervalMicros > 0 ) {
+                    long long now = timer.micros();
+                    if ( now < nextOpStartMicros ) {
+                        sleepmicros( nextOpStartMicros - now );
+                        opLagMicros = 0;
+                    }
+                    else {
+                        opLagMicros = now - nextOpStartMicros;
+                    }
+                    nextOpStartMicros += scheduleIntervalMicros;
+                }
+
                 try {
                     if ( op == "findOne" ) {
 
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.findOneCounter);
+                            BenchRunEventTrace _bret(&_stats.findOneCounter, opLagMicros);
                             result = conn->findOne( ns , fixQuery( e["query"].Obj(),
                                                                    bsonTemplateEvaluator ) );
                         }
@@ -439,12 +526,12 @@ namespace mongo {
 
                         // use special query function for exhaust query option
                         if (options & QueryOption_Exhaust) {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, opLagMicros);
                             boost::function<void (const BSONObj&)> castedDoNothing(doNothing);
                             count =  conn->query(castedDoNothing, ns, fixedQuery, &filter, options);
                         }
                         else {
-                            BenchRunEventTrace _bret(&_stats.queryCounter);
+                            BenchRunEventTrace _bret(&_stats.queryCounter, opLagMicros);
                             cursor = conn->query(ns, fixedQuery, limit, skip, &filter, options,
                                                  batchSize);
                             count = cursor->itcount();
@@ -480,7 +567,7 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
 
                         {
-                            BenchRunEventTrace _bret(&_stats.updateCounter);
+                            BenchRunEventTrace _bret(&_stats.updateCounter, opLagMicros);
                             conn->update( ns, fixQuery( query, bsonTemplateEvaluator ), update,
                                           upsert , multi );
                             if (safe)
@@ -510,7 +597,7 @@ namespace mongo {
                         bool safe = e["safe"].trueValue();
                         BSONObj result;
                         {
-                            BenchRunEventTrace _bret(&_stats.insertCounter);
+                            BenchRunEventTrace _bret(&_stats.insertCounter, opLagMicros);
                             conn->insert( ns, fixQuery( e["doc"].Obj(), bsonTemplateEvaluator ) );
                             if (safe)
                                 result = conn->getLastErrorDetailed();
@@ -543,7 +630,7 @@ namespace mongo {
                         BSONObj result;
 
                         {
-                            BenchRunEventTrace _bret(&_stats.deleteCounter);
+                            BenchRunEventTrace _bret(&_stats.deleteCounter, opLagMicros);
                             conn->remove( ns, fixQuery( query, bsonTemplateEvaluator ), ! multi );
                             if (safe)
                                 result = conn->getLastErrorDetailed();
@@ -618,6 +705,12 @@ namespace mongo {
                     conn->getLastError();
                 }
 
+                if ( intervalReportMicros > 0 && timer.micros() >= nextReportMicros ) {
+                    reportIntervalStats( timer.micros() );
+                    while ( nextReportMicros <= timer.micros() )
+                        nextReportMicros += intervalReportMicros;
+                }
+
                 sleepmillis( delay );
             }
         }
@@ -799,6 +892,16 @@ namespace mongo {
          appendAverageMicrosIfAvailable(buf, "deleteLatencyAverageMicros", stats.deleteCounter);
          appendAverageMicrosIfAvailable(buf, "updateLatencyAverageMicros", stats.updateCounter);
          appendAverageMicrosIfAvailable(buf, "queryLatencyAverageMicros", stats.queryCounter);
+         appendLatencyPercentilesIfAvailable(buf, "findOneLatencyPercentilesMicros",
+                                             stats.findOneCounter);
+         appendLatencyPercentilesIfAvailable(buf, "insertLatencyPercentilesMicros",
+                                             stats.insertCounter);
+         appendLatencyPercentilesIfAvailable(buf, "deleteLatencyPercentilesMicros",
+                                             stats.deleteCounter);
+         appendLatencyPercentilesIfAvailable(buf, "updateLatencyPercentilesMicros",
+                                             stats.updateCounter);
+         appendLatencyPercentilesIfAvailable(buf, "queryLatencyPercentilesMicros",
+                                             stats.queryCounter);
 
          {
              BSONObjIterator i( after );
@@ -26,6 +26,7 @@
 #include "mongo/bson/util/atomic_int.h"
 #include "mongo/client/dbclientinterface.h"
 #include "mongo/db/jsobj.h"
+#include "mongo/util/histogram.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -110,6 +111,23 @@ namespace mongo {
         bool throwGLE;
         bool breakOnTrap;
 
+        /**
+         * Target rate for the whole job, in ops per second, spread evenly across the
+         * worker threads.  Zero (the default) runs every op back to back.
+         *
+         * When set, each op gets an intended start time on a fixed schedule, and its
+         * recorded latency runs from that intended start.  A stalled server is thereby
+         * charged for the ops that should have started during the stall, instead of the
+         * stall quietly lowering the offered rate (coordinated omission).
+         */
+        double targetRate;
+
+        /**
+         * If nonzero, each worker periodically logs its cumulative latency percentiles
+         * at this interval, in seconds, so latency can be watched evolving during a run.
+         */
+        int intervalReportSecs;
+
     private:
         /// Initialize a config object to its default values.
         void initializeToDefaults();
@@ -118,6 +136,10 @@ namespace mongo {
     /**
      * An event counter for events that have an associated duration.
      *
+     * Alongside the total and count, event durations are recorded in a histogram with
+     * log-spaced buckets, so tail latency percentiles can be reported as well as the
+     * mean.
+     *
      * Not thread safe.  Expected use is one instance per thread during parallel execution.
      */
     class BenchRunEventCounter : private boost::noncopyable {
@@ -142,6 +164,8 @@ namespace mongo {
         void countOne(unsigned long long timeMicros) {
             ++_numEvents;
             _totalTimeMicros += timeMicros;
+            _histogram.insert( timeMicros > 0xffffffffULL ?
+                               0xffffffffU : static_cast<uint32_t>( timeMicros ) );
         }
 
         /**
@@ -154,9 +178,17 @@ namespace mongo {
          */
         unsigned long long getNumEvents() const { return _numEvents; }
 
+        /**
+         * Get an upper bound, in microseconds, on the latency quantile "fraction",
+         * which must be in (0, 1] -- e.g. 0.99 for p99.  The bound is exact to within
+         * one log-spaced histogram bucket.  Returns 0 if no events were observed.
+         */
+        unsigned long long getPercentileMicros( double fraction ) const;
+
     private:
         unsigned long long _numEvents;
         unsigned long long _totalTimeMicros;
+        Histogram _histogram;  // log-spaced event durations, in microseconds
     };
 
     /**
@@ -170,22 +202,26 @@ namespace mongo {
      * the end of a successful event.  If an exception is thrown, the fail counter will receive the
      * event, and otherwise, the succes counter will.
      *
+     * "lagMicros" is added to the measured duration, for callers that want the event
+     * timed from an intended start that fell before the trace was constructed.
+     *
      * In all cases, the counter objects must outlive the trace object.
      */
     class BenchRunEventTrace : private boost::noncopyable {
     public:
-        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter) {
-            initialize(eventCounter, eventCounter, false);
+        explicit BenchRunEventTrace(BenchRunEventCounter *eventCounter,
+                                    unsigned long long lagMicros = 0) {
+            initialize(eventCounter, eventCounter, false, lagMicros);
         }
 
         BenchRunEventTrace(BenchRunEventCounter *successCounter,
                            BenchRunEventCounter *failCounter,
                            bool defaultToFailure=true) {
-            initialize(successCounter, failCounter, defaultToFailure);
+            initialize(successCounter, failCounter, defaultToFailure, 0);
         }
 
         ~BenchRunEventTrace() {
-            (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros());
+            (_succeeded ? _successCounter : _failCounter)->countOne(_timer.micros() + _lagMicros);
         }
 
         void succeed() { _succeeded = true; }
@@ -194,16 +230,19 @@ namespace mongo {
     private:
         void initialize(BenchRunEventCounter *successCounter,
                         BenchRunEventCounter *failCounter,
-                        bool defaultToFailure) {
+                        bool defaultToFailure,
+                        unsigned long long lagMicros) {
             _successCounter = successCounter;
             _failCounter = failCounter;
             _succeeded = !defaultToFailure;
+            _lagMicros = lagMicros;
         }
 
         Timer _timer;
         BenchRunEventCounter *_successCounter;
         BenchRunEventCounter *_failCounter;
         bool _succeeded;
+        unsigned long long _lagMicros;
     };
 
     /**
@@ -329,6 +368,9 @@ namespace mongo {
         /// The function that actually sets about generating the load described in "_config".
         void generateLoadOnConnection( DBClientBase *conn );
 
+        /// Log this worker's cumulative latency percentiles, "elapsedMicros" into the run.
+        void reportIntervalStats( long long elapsedMicros ) const;
+
         /// Predicate, used to decide whether or not it's time to terminate the worker.
         bool shouldStop() const;
 
@@ -30,11 +30,17 @@
 
 #include <cstddef>
 #include <cstdlib>
+#include <cstring>
 
 #include "mongo/util/map_util.h"
 
 namespace mongo {
 
+    namespace {
+        // cap on distinct templates cached by evaluate(BSONObj&, ...)
+        const size_t kMaxCachedTemplates = 64;
+    } // namespace
+
     void BsonTemplateEvaluator::initializeEvaluator() {
         addOperator("RAND_INT", &BsonTemplateEvaluator::evalRandInt);
         addOperator("RAND_STRING", &BsonTemplateEvaluator::evalRandString);
@@ -49,6 +55,8 @@ namespace mongo {
 
     void BsonTemplateEvaluator::addOperator(const std::string& name, const OperatorFn& op) {
         _operatorFunctions[name] = op;
+        // compiled programs bind operators at compile time
+        _compiledTemplates.clear();
     }
 
     BsonTemplateEvaluator::OperatorFn BsonTemplateEvaluator::operatorEvaluator(
@@ -62,34 +70,88 @@ namespace mongo {
      */
     BsonTemplateEvaluator::Status BsonTemplateEvaluator::evaluate(const BSONObj& in,
                                                                   BSONObjBuilder& builder) {
-        BSONForEach(e, in) {
-            Status st = _evalElem(e, builder);
+        CompiledTemplate* tmpl;
+        Status st = _compiledForm(in, &tmpl);
+        if (st != StatusSuccess)
+            return st;
+        return evaluate(*tmpl, builder);
+    }
+
+    BsonTemplateEvaluator::Status BsonTemplateEvaluator::compile(const BSONObj& src,
+                                                                 CompiledTemplate& out) {
+        out._source = src.getOwned();
+        out._steps.clear();
+        const char* runStart = NULL;
+        int runLen = 0;
+        BSONForEach(e, out._source) {
+            bool isOperator = false;
+            if (e.type() == Object)
+                isOperator = (e.embeddedObject().firstElementFieldName()[0] == '#');
+            if (!isOperator) {
+                // literal element; extend (or start) the current raw copy run
+                if (!runStart)
+                    runStart = e.rawdata();
+                runLen += e.size();
+                continue;
+            }
+            if (runStart) {
+                CompiledTemplate::Step copy = { runStart, runLen, OperatorFn(), NULL, BSONObj() };
+                out._steps.push_back(copy);
+                runStart = NULL;
+                runLen = 0;
+            }
+            BSONObj subObj = e.embeddedObject();
+            OperatorFn fn = operatorEvaluator(subObj.firstElementFieldName() + 1);
+            if (!fn)
+                return StatusBadOperator;
+            CompiledTemplate::Step step = { NULL, 0, fn, e.fieldName(), subObj };
+            out._steps.push_back(step);
+        }
+        if (runStart) {
+            CompiledTemplate::Step copy = { runStart, runLen, OperatorFn(), NULL, BSONObj() };
+            out._steps.push_back(copy);
+        }
+        return StatusSuccess;
+    }
+
+    BsonTemplateEvaluator::Status BsonTemplateEvaluator::evaluate(const CompiledTemplate& tmpl,
+                                                                  BSONObjBuilder& builder) {
+        for (std::vector<CompiledTemplate::Step>::const_iterator it = tmpl._steps.begin();
+             it != tmpl._steps.end(); ++it) {
+            if (!it->fn) {
+                builder.bb().appendBuf(it->data, it->len);
+                continue;
+            }
+            Status st = it->fn(this, it->fieldName, it->args, builder);
             if (st != StatusSuccess)
                 return st;
         }
         return StatusSuccess;
     }
 
-    BsonTemplateEvaluator::Status BsonTemplateEvaluator::_evalElem(BSONElement in,
-                                                                   BSONObjBuilder& out) {
-       if (in.type() != Object) {
-           out.append(in);
-           return StatusSuccess;
-       }
-       BSONObj subObj = in.embeddedObject();
-       const char* opOrNot = subObj.firstElementFieldName();
-       if (opOrNot[0] != '#') {
-           out.append(in);
-           return StatusSuccess;
-       }
-       const char* op = opOrNot+1;
-       OperatorFn fn = operatorEvaluator(op);
-       if (!fn)
-           return StatusBadOperator;
-       Status st = fn(this, in.fieldName(), subObj, out);
-       if (st != StatusSuccess)
-           return st;
-       return StatusSuccess;
+    BsonTemplateEvaluator::Status BsonTemplateEvaluator::_compiledForm(const BSONObj& src,
+                                                                       CompiledTemplate** out) {
+        CompiledTemplateMap::const_iterator it = _compiledTemplates.find(src.objdata());
+        if (it != _compiledTemplates.end()) {
+            CompiledTemplate* cached = it->second.get();
+            if (cached->_source.objsize() == src.objsize() &&
+                    memcmp(cached->_source.objdata(), src.objdata(), src.objsize()) == 0) {
+                *out = cached;
+                return StatusSuccess;
+            }
+            // same buffer address, different bytes: fall through and recompile
+        }
+        else if (_compiledTemplates.size() >= kMaxCachedTemplates) {
+            // keep the cache from growing without bound on transient templates
+            _compiledTemplates.clear();
+        }
+        boost::shared_ptr<CompiledTemplate> compiled(new CompiledTemplate());
+        Status st = compile(src, *compiled);
+        if (st != StatusSuccess)
+            return st;
+        *out = compiled.get();
+        _compiledTemplates[src.objdata()] = compiled;
+        return StatusSuccess;
     }
 
     BsonTemplateEvaluator::Status BsonTemplateEvaluator::evalRandInt(BsonTemplateEvaluator* btl,
@@ -33,9 +33,11 @@
 
 #include <map>
 #include <string>
+#include <vector>
 
 #include <boost/function.hpp>
 #include <boost/noncopyable.hpp>
+#include <boost/shared_ptr.hpp>
 
 #include "mongo/db/jsobj.h"
 
@@ -54,11 +56,12 @@ namespace mongo {
      * The 'evaluate' method will never throw an exception and will return an appropriate Status
      * code on success/error scenario.
      *
-     * High level working : The evaluate() method takes in a BSONObj as input, iterates over the
-     * BSON elements in the input BSONObj, and calls _evalElem() method. The _evalElem() method
-     * figures out the specific template and then calls the corresponding template function.
-     * The evaluated result is added to the BSONObjBuilder object and is returned to the evaluate()
-     * method.
+     * High level working : The evaluate() method compiles the input BSONObj into a flat
+     * program of steps (raw byte copies for literal elements, resolved operator calls for
+     * templates) the first time it sees it, caches the program, and executes the program
+     * into the BSONObjBuilder on this and every later call with the same template. Callers
+     * generating many documents from one template can also compile() explicitly and run
+     * the compiled form directly.
      *
      */
     class BsonTemplateEvaluator : private boost::noncopyable {
@@ -85,6 +88,31 @@ namespace mongo {
         typedef boost::function< Status (BsonTemplateEvaluator* btl, const char* fieldName,
                                          const BSONObj& in, BSONObjBuilder& builder) > OperatorFn;
 
+        /*
+         * A template compiled into a flat program of steps. Runs of literal elements
+         * become single copy-raw-bytes steps and template operators are resolved to
+         * their OperatorFn up front, so executing the program per generated document
+         * does no per-element type dispatch or operator map lookups.
+         * Compile once with compile() and execute per document with
+         * evaluate(const CompiledTemplate&, BSONObjBuilder&). The compiled form owns
+         * a copy of the template, so the source object need not outlive it.
+         */
+        class CompiledTemplate {
+        public:
+            const BSONObj& source() const { return _source; }
+        private:
+            friend class BsonTemplateEvaluator;
+            struct Step {
+                const char* data;      // copy step: raw element bytes inside _source
+                int len;
+                OperatorFn fn;         // set for operator steps, empty for copy steps
+                const char* fieldName; // operator step: key to evaluate into
+                BSONObj args;          // operator step: the embedded operator object
+            };
+            BSONObj _source; // owned; steps point into its buffer
+            std::vector<Step> _steps;
+        };
+
         BsonTemplateEvaluator();
         ~BsonTemplateEvaluator();
 
@@ -108,14 +136,32 @@ namespace mongo {
          */
         Status evaluate(const BSONObj& src, BSONObjBuilder& builder);
 
+        /*
+         * Compiles "src" into a flat program, resolving all operator lookups.
+         * Returns StatusBadOperator if the template names an unknown operator.
+         */
+        Status compile(const BSONObj& src, CompiledTemplate& out);
+
+        /*
+         * Executes a program produced by compile(), appending the generated
+         * document to the builder.
+         */
+        Status evaluate(const CompiledTemplate& tmpl, BSONObjBuilder& builder);
+
     private:
         void initializeEvaluator();
         // map that holds operators along with their respective function pointers
         typedef std::map< std::string, OperatorFn > OperatorMap;
         OperatorMap _operatorFunctions;
 
-        // evaluates a BSON element. This is internally called by the top level evaluate method.
-        Status _evalElem(BSONElement in, BSONObjBuilder& out);
+        // compiled forms of the templates seen by evaluate(BSONObj&, ...), keyed by
+        // the address of the template's buffer; entries are revalidated against the
+        // retained source bytes so a reused address cannot yield a stale program
+        typedef std::map< const void*, boost::shared_ptr<CompiledTemplate> > CompiledTemplateMap;
+        CompiledTemplateMap _compiledTemplates;
+
+        // returns the compiled form of "src", compiling and caching it on first sight
+        Status _compiledForm(const BSONObj& src, CompiledTemplate** out);
 
         /*
          * Operator method to support #RAND_INT :  { key : { #RAND_INT: [10, 20] } }
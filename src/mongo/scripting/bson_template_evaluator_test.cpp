@@ -366,5 +366,64 @@ namespace mongo {
             // so total string length should 1 + 13 + 5 = 19
             ASSERT_EQUALS(obj2.firstElement().str().length(), 19U);
         }
+
+        TEST(BSONTemplateEvaluatorTest, COMPILED_TEMPLATE) {
+
+            BsonTemplateEvaluator *t = new BsonTemplateEvaluator();
+            BSONObj randObj = BSON( "#RAND_INT" << BSON_ARRAY( 0 << 5 ) );
+
+            // Test failure when compiling a template with an unknown operator
+            BsonTemplateEvaluator::CompiledTemplate badTmpl;
+            BSONObj badObj = BSON( "#RAND_OP_NOT_EXISTS" << BSON_ARRAY( 5 << 0 ) );
+            ASSERT_EQUALS( BsonTemplateEvaluator::StatusBadOperator,
+                           t->compile(BSON("randField" << badObj), badTmpl) );
+
+            // Test that one compiled template can generate many documents, and that
+            // literal elements around the operator are copied through intact
+            BsonTemplateEvaluator::CompiledTemplate tmpl;
+            ASSERT_EQUALS( BsonTemplateEvaluator::StatusSuccess,
+                           t->compile(BSON("id" << 1 << "randField" << randObj <<
+                                           "hello" << "world"), tmpl) );
+            for (int i = 0; i < 10; ++i) {
+                BSONObjBuilder builder;
+                ASSERT_EQUALS( BsonTemplateEvaluator::StatusSuccess,
+                               t->evaluate(tmpl, builder) );
+                BSONObj obj = builder.obj();
+                ASSERT_EQUALS(obj.nFields(), 3);
+                BSONObjIterator iter(obj);
+                ASSERT_EQUALS(iter.next().numberInt(), 1);
+                int randValue = iter.next().numberInt();
+                ASSERT_GREATER_THAN_OR_EQUALS(randValue, 0);
+                ASSERT_LESS_THAN(randValue, 5);
+                ASSERT_EQUALS(iter.next().str(), "world");
+            }
+
+            // Test that the compiled form survives its source object; evaluate from
+            // a compile against a temporary
+            BsonTemplateEvaluator::CompiledTemplate tmpl2;
+            {
+                BSONObj tempSrc = BSON("x" << "y" << "randField" << randObj);
+                ASSERT_EQUALS( BsonTemplateEvaluator::StatusSuccess,
+                               t->compile(tempSrc, tmpl2) );
+            }
+            BSONObjBuilder builder2;
+            ASSERT_EQUALS( BsonTemplateEvaluator::StatusSuccess,
+                           t->evaluate(tmpl2, builder2) );
+            BSONObj obj2 = builder2.obj();
+            ASSERT_EQUALS(obj2.nFields(), 2);
+            ASSERT_EQUALS(obj2.firstElement().str(), "y");
+
+            // Test that repeated top level evaluate calls with the same template
+            // (the cached-compile path) keep producing correct documents
+            BSONObj src = BSON("a" << 1 << "randField" << randObj);
+            for (int i = 0; i < 3; ++i) {
+                BSONObjBuilder builder;
+                ASSERT_EQUALS( BsonTemplateEvaluator::StatusSuccess,
+                               t->evaluate(src, builder) );
+                BSONObj obj = builder.obj();
+                ASSERT_EQUALS(obj.nFields(), 2);
+                ASSERT_EQUALS(obj.firstElement().numberInt(), 1);
+            }
+        }
     } // end anonymous namespace
 } // end namespace mongo
@@ -228,6 +228,17 @@ namespace mongo {
         }
     }
 
+    // FNV-1a.  Cheap and stable; collisions are harmless since the full source is
+    // compared after the hash within the cache key.
+    static unsigned hashFunctionSource(const char* code) {
+        unsigned hash = 2166136261U;
+        for (; *code; ++code) {
+            hash ^= static_cast<unsigned char>(*code);
+            hash *= 16777619U;
+        }
+        return hash;
+    }
+
     ScriptingFunction Scope::createFunction(const char* code) {
         if (code[0] == '/' && code [1] == '*') {
             code += 2;
@@ -240,14 +251,15 @@ namespace mongo {
             }
         }
 
-        FunctionCacheMap::iterator i = _cachedFunctions.find(code);
+        const FunctionCacheKey cacheKey(hashFunctionSource(code), code);
+        FunctionCacheMap::iterator i = _cachedFunctions.find(cacheKey);
         if (i != _cachedFunctions.end())
             return i->second;
         // NB: we calculate the function number for v8 so the cache can be utilized to
         //     lookup the source on an exception, but SpiderMonkey uses the value
         //     returned by JS_CompileFunction.
         ScriptingFunction defaultFunctionNumber = getFunctionCache().size() + 1;
-        ScriptingFunction& actualFunctionNumber = _cachedFunctions[code];
+        ScriptingFunction& actualFunctionNumber = _cachedFunctions[cacheKey];
         actualFunctionNumber = _createFunction(code, defaultFunctionNumber);
         return actualFunctionNumber;
     }
@@ -300,6 +312,10 @@ namespace {
             if (scope->getTimesUsed() > kMaxScopeReuse)
                 return; // used too many times to save
 
+            if (scope->getFunctionCacheSize() > kMaxCachedFunctions)
+                return; // every distinct source seen pins a compiled function, so a
+                        // scope that has compiled too many is too big to keep warm
+
             if (!scope->getError().empty())
                 return; // not saving errored scopes
 
@@ -336,7 +352,11 @@ namespace {
 
         // Note: if these numbers change, reconsider choice of datastructure for _pools
         static const unsigned kMaxPoolSize = 10;
-        static const int kMaxScopeReuse = 10;
+        // Keep scopes warm long enough to amortize isolate/context setup across runs of
+        // scripted operations; reset() wipes per-operation state between checkouts, and
+        // the compiled-function cache carries over.
+        static const int kMaxScopeReuse = 1000;
+        static const size_t kMaxCachedFunctions = 500;
 
         typedef deque<ScopeAndPool> Pools; // More-recently used Scopes are kept at the front.
         Pools _pools;    // protected by _mutex
@@ -393,6 +413,9 @@ namespace {
             return _real->invoke(func, args, recv, timeoutMs, ignoreReturn,
                                  readOnlyArgs, readOnlyRecv);
         }
+        int invokeWithDocument(ScriptingFunction func, const BSONObj& document, int timeoutMs) {
+            return _real->invokeWithDocument(func, document, timeoutMs);
+        }
         bool exec(const StringData& code, const string& name, bool printResult, bool reportError,
                   bool assertOnError, int timeoutMs = 0) {
             return _real->exec(code, name, printResult, reportError, assertOnError, timeoutMs);
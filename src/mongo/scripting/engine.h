@@ -22,7 +22,15 @@
 namespace mongo {
     typedef unsigned long long ScriptingFunction;
     typedef BSONObj (*NativeFunction)(const BSONObj& args, void* data);
-    typedef map<string, ScriptingFunction> FunctionCacheMap;
+
+    /**
+     * Compiled functions are cached per scope, keyed by a hash of the source text
+     * followed by the text itself.  The hash is compared first, so cache misses don't
+     * compare whole sources; the full source disambiguates hash collisions and lets
+     * engines recover the source of a compiled function for error reporting.
+     */
+    typedef std::pair<unsigned, string> FunctionCacheKey;
+    typedef map<FunctionCacheKey, ScriptingFunction> FunctionCacheMap;
 
     class DBClientWithCommands;
 
@@ -89,6 +97,18 @@ namespace mongo {
                            int timeoutMs = 0, bool ignoreReturn = false, bool readOnlyArgs = false,
                            bool readOnlyRecv = false) = 0;
 
+        /**
+         * Invokes "func" with 'this' bound to "document" and the global "obj" set to
+         * the same object.  Engines can override this to convert the document once and
+         * share the wrapper between the two bindings; the default implementation falls
+         * back to setObject() followed by invoke().
+         */
+        virtual int invokeWithDocument(ScriptingFunction func, const BSONObj& document,
+                                       int timeoutMs = 0) {
+            setObject("obj", document, false);
+            return invoke(func, 0, &document, timeoutMs, false);
+        }
+
         void invokeSafe(ScriptingFunction func, const BSONObj* args, const BSONObj* recv,
                         int timeoutMs = 0, bool ignoreReturn = false, bool readOnlyArgs = false,
                         bool readOnlyRecv = false) {
@@ -140,6 +160,9 @@ namespace mongo {
         /** gets the number of times a scope was used */
         int getTimesUsed() { return _numTimesUsed; }
 
+        /** gets the number of compiled functions cached in this scope */
+        size_t getFunctionCacheSize() { return getFunctionCache().size(); }
+
         /** return true if last invoke() return'd native code */
         virtual bool isLastRetNativeCode() { return _lastRetIsNativeCode; }
 
@@ -866,11 +866,11 @@ namespace mongo {
             // find the source script based on the resource name supplied to v8::Script::Compile().
             // this is accomplished by converting the integer after the '_funcs' prefix.
             unsigned int funcNum = str::toUnsigned(resourceNameString.substr(6));
-            for (map<string, ScriptingFunction>::iterator it = getFunctionCache().begin();
+            for (FunctionCacheMap::iterator it = getFunctionCache().begin();
                  it != getFunctionCache().end();
                  ++it) {
                 if (it->second == funcNum) {
-                    code = it->first;
+                    code = it->first.second;
                     break;
                 }
             }
@@ -1064,6 +1064,49 @@ namespace mongo {
         return 0;
     }
 
+    int V8Scope::invokeWithDocument(ScriptingFunction func, const BSONObj& document,
+                                    int timeoutMs) {
+        V8_SIMPLE_HEADER
+        v8::Handle<v8::Value> funcValue = _funcs[func-1];
+        v8::TryCatch try_catch;
+        v8::Local<v8::Value> result;
+
+        // a single lazy wrapper serves as both the global "obj" and the receiver, so
+        // the document is converted once and fields materialize only when touched
+        v8::Handle<v8::Object> v8doc = mongoToLZV8(document, false);
+        _global->ForceSet(strLitToV8("obj"), v8doc);
+
+        if (!nativeEpilogue()) {
+            _error = "JavaScript execution terminated";
+            log() << _error << endl;
+            uasserted(17482, _error);
+        }
+
+        if (timeoutMs)
+            // start the deadline timer for this script
+            _engine->getDeadlineMonitor()->startDeadline(this, timeoutMs);
+
+        result = ((v8::Function*)(*funcValue))->Call(v8doc, 0, NULL);
+
+        if (timeoutMs)
+            // stop the deadline timer for this script
+            _engine->getDeadlineMonitor()->stopDeadline(this);
+
+        if (!nativePrologue()) {
+            _error = "JavaScript execution terminated";
+            log() << _error << endl;
+            uasserted(17483, _error);
+        }
+
+        // throw on error
+        checkV8ErrorState(result, try_catch);
+
+        _lastRetIsNativeCode = false;
+        _global->ForceSet(strLitToV8("__returnValue"), result);
+
+        return 0;
+    }
+
     bool V8Scope::exec(const StringData& code, const string& name, bool printResult,
                        bool reportError, bool assertOnError, int timeoutMs) {
         V8_SIMPLE_HEADER
@@ -197,6 +197,9 @@ namespace mongo {
                            int timeoutMs = 0, bool ignoreReturn = false,
                            bool readOnlyArgs = false, bool readOnlyRecv = false);
 
+        virtual int invokeWithDocument(ScriptingFunction func, const BSONObj& document,
+                                       int timeoutMs = 0);
+
         virtual bool exec(const StringData& code, const string& name, bool printResult,
                           bool reportError, bool assertOnError, int timeoutMs);
 
@@ -30,6 +30,7 @@
 
 #include <boost/filesystem/operations.hpp>
 #include <boost/filesystem/convenience.hpp>
+#include <boost/thread/thread.hpp>
 #include <fcntl.h>
 #include <fstream>
 #include <map>
@@ -40,6 +41,7 @@
 #include "mongo/db/structure/collection.h"
 #include "mongo/tools/mongodump_options.h"
 #include "mongo/tools/tool.h"
+#include "mongo/util/compress.h"
 #include "mongo/util/options_parser/option_section.h"
 
 using namespace mongo;
@@ -60,32 +62,71 @@ public:
         printMongoDumpHelp(&out);
     }
 
-    // This is a functor that writes a BSONObj to a file
+    // This is a functor that writes a BSONObj to a file, optionally buffering runs of
+    // objects into snappy-compressed blocks (the format read by BSONTool::processFile)
     struct Writer {
-        Writer(FILE* out, ProgressMeter* m) :_out(out), _m(m) {}
+        Writer(FILE* out, ProgressMeter* m, bool compress = false) :_out(out), _m(m) {
+            if (compress) {
+                // shared so that copies of this functor (e.g. inside a boost::function)
+                // all append to the same block
+                _block.reset(new BufBuilder(BlockSize));
+            }
+        }
 
         void operator () (const BSONObj& obj) {
-            size_t toWrite = obj.objsize();
+            if (_block) {
+                _block->appendBuf(obj.objdata(), obj.objsize());
+                if (_block->len() >= BlockSize) {
+                    flush();
+                }
+            }
+            else {
+                writeRaw(obj.objdata(), obj.objsize());
+            }
+
+            // if there's a progress bar, hit it
+            if (_m) {
+                _m->hit();
+            }
+        }
+
+        // writes out any buffered objects as a final compressed block; must be called
+        // after the last object when compressing
+        void flush() {
+            if (!_block || _block->len() == 0)
+                return;
+
+            std::string compressed;
+            mongo::compress(_block->buf(), _block->len(), &compressed);
+
+            int header[2];
+            header[0] = _block->len();
+            header[1] = compressed.size();
+            writeRaw(reinterpret_cast<const char*>(header), sizeof(header));
+            writeRaw(compressed.data(), compressed.size());
+
+            _block->reset();
+        }
+
+        void writeRaw(const char* data, size_t toWrite) {
             size_t written = 0;
 
             while (toWrite) {
-                size_t ret = fwrite( obj.objdata()+written, 1, toWrite, _out );
+                size_t ret = fwrite( data+written, 1, toWrite, _out );
                 uassert(14035, errnoWithPrefix("couldn't write to file"), ret);
                 toWrite -= ret;
                 written += ret;
             }
-
-            // if there's a progress bar, hit it
-            if (_m) {
-                _m->hit();
-            }
         }
 
+        enum { BlockSize = 4 * 1024 * 1024 };
+
         FILE* _out;
         ProgressMeter* _m;
+        boost::shared_ptr<BufBuilder> _block;
     };
 
-    void doCollection( const string coll , FILE* out , ProgressMeter *m ) {
+    void doCollection( const string coll , DBClientBase& connBase , FILE* out , ProgressMeter *m ) {
         Query q = _query;
 
         int queryOptions = QueryOption_SlaveOk | QueryOption_NoCursorTimeout;
@@ -94,9 +135,8 @@ public:
         else if (mongoDumpGlobalParams.snapShotQuery) {
             q.snapshot();
         }
-        
-        DBClientBase& connBase = conn(true);
-        Writer writer(out, m);
+
+        Writer writer(out, m, mongoDumpGlobalParams.compress && out != stdout);
 
         // use low-latency "exhaust" mode if going over the network
         if (!_usingMongos && typeid(connBase) == typeid(DBClientConnection&)) {
@@ -111,19 +151,22 @@ public:
                 writer(cursor->next());
             }
         }
+
+        writer.flush();
     }
 
-    void writeCollectionFile( const string coll , boost::filesystem::path outputFile ) {
+    void writeCollectionFile( const string coll , DBClientBase& connBase ,
+                              boost::filesystem::path outputFile ) {
         toolInfoLog() << "\t" << coll << " to " << outputFile.string() << std::endl;
 
         FilePtr f (fopen(outputFile.string().c_str(), "wb"));
         uassert(10262, errnoWithPrefix("couldn't open file"), f);
 
-        ProgressMeter m(conn(true).count(coll.c_str(), BSONObj(), QueryOption_SlaveOk));
+        ProgressMeter m(connBase.count(coll.c_str(), BSONObj(), QueryOption_SlaveOk));
         m.setName("Collection File Writing Progress");
         m.setUnits("objects");
 
-        doCollection(coll, f, &m);
+        doCollection(coll, connBase, f, &m);
 
         toolInfoLog() << "\t\t " << m.done() << " objects" << std::endl;
     }
@@ -163,7 +206,60 @@ public:
 
 
     void writeCollectionStdout( const string coll ) {
-        doCollection(coll, stdout, NULL);
+        doCollection(coll, conn(true), stdout, NULL);
+    }
+
+    // collection files get a .snappy suffix when compressing so that restore knows
+    // how to read them back
+    string bsonFileSuffix() const {
+        return mongoDumpGlobalParams.compress ? ".bson.snappy" : ".bson";
+    }
+
+    // Shared state for the workers dumping one database's collections in parallel.
+    struct ParallelDumpState : boost::noncopyable {
+        ParallelDumpState() : lock("Dump::ParallelDumpState"), next(0), failures(0) {}
+        mongo::mutex lock;
+        vector<string> collections;
+        size_t next;
+        int failures;
+    };
+
+    void parallelWorker( ParallelDumpState* state,
+                         const string db,
+                         const boost::filesystem::path outdir,
+                         const map<string, BSONObj>* collectionOptions,
+                         const multimap<string, BSONObj>* indexes ) {
+        string errmsg;
+        scoped_ptr<DBClientBase> myConn(openWorkerConnection(errmsg));
+        if (!myConn) {
+            toolError() << "couldn't open connection for dump worker: " << errmsg << std::endl;
+            scoped_lock lk(state->lock);
+            state->failures++;
+            return;
+        }
+
+        while (true) {
+            string name;
+            {
+                scoped_lock lk(state->lock);
+                if (state->next >= state->collections.size())
+                    break;
+                name = state->collections[state->next++];
+            }
+
+            const string filename = name.substr( db.size() + 1 );
+            try {
+                writeCollectionFile( name , *myConn , outdir / ( filename + bsonFileSuffix() ) );
+                writeMetadataFile( name, outdir / (filename + ".metadata.json"),
+                                   *collectionOptions, *indexes);
+            }
+            catch ( DBException& e ) {
+                toolError() << "error dumping collection " << name << ": " << e.toString()
+                          << std::endl;
+                scoped_lock lk(state->lock);
+                state->failures++;
+            }
+        }
     }
 
     void go( const string db , const boost::filesystem::path outdir ) {
@@ -221,18 +317,44 @@ public:
             if (nsToCollectionSubstring(name) == "system.indexes") {
               // Create system.indexes.bson for compatibility with pre 2.2 mongorestore
               const string filename = name.substr( db.size() + 1 );
-              writeCollectionFile( name.c_str() , outdir / ( filename + ".bson" ) );
+              writeCollectionFile( name.c_str() , conn( true ) ,
+                                   outdir / ( filename + bsonFileSuffix() ) );
               // Don't dump indexes as *.metadata.json
               continue;
             }
-            
+
             collections.push_back(name);
         }
-        
+
+        int numWorkers = mongoDumpGlobalParams.numParallelCollections;
+        if (numWorkers > (int)collections.size())
+            numWorkers = collections.size();
+
+        if (numWorkers > 1 && !toolGlobalParams.useDirectClient) {
+            ParallelDumpState state;
+            state.collections = collections;
+
+            vector< boost::shared_ptr<boost::thread> > workers;
+            for (int i = 0; i < numWorkers; i++) {
+                workers.push_back(boost::shared_ptr<boost::thread>(
+                        new boost::thread(boost::bind(&Dump::parallelWorker, this, &state,
+                                                      db, outdir,
+                                                      &collectionOptions, &indexes))));
+            }
+            for (size_t i = 0; i < workers.size(); i++) {
+                workers[i]->join();
+            }
+
+            uassert(17505, str::stream() << state.failures
+                                         << " collection dump(s) failed for database " << db,
+                    state.failures == 0);
+            return;
+        }
+
         for (vector<string>::iterator it = collections.begin(); it != collections.end(); ++it) {
             string name = *it;
             const string filename = name.substr( db.size() + 1 );
-            writeCollectionFile( name , outdir / ( filename + ".bson" ) );
+            writeCollectionFile( name , conn( true ) , outdir / ( filename + bsonFileSuffix() ) );
             writeMetadataFile( name, outdir / (filename + ".metadata.json"), collectionOptions, indexes);
         }
 
@@ -659,7 +781,7 @@ public:
 
             _query = BSON("ts" << b.obj());
 
-            writeCollectionFile( opLogName , root / "oplog.bson" );
+            writeCollectionFile( opLogName , conn( true ) , root / ( "oplog" + bsonFileSuffix() ) );
         }
 
         return 0;
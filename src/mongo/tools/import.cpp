@@ -30,14 +30,17 @@
 
 #include <boost/algorithm/string.hpp>
 #include <boost/filesystem/operations.hpp>
+#include <boost/thread/thread.hpp>
 #include <fstream>
 #include <iostream>
 
 #include "mongo/base/initializer.h"
 #include "mongo/db/json.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/tools/mongoimport_options.h"
 #include "mongo/tools/tool.h"
 #include "mongo/util/options_parser/option_section.h"
+#include "mongo/util/queue.h"
 #include "mongo/util/text.h"
 
 using namespace mongo;
@@ -183,11 +186,12 @@ class Import : public Tool {
     }
 
     /*
-     * Parses one object from the input file.  This usually corresponds to one line in the input
-     * file, unless the file is a CSV and contains a newline within a quoted string entry.
-     * Returns a true if a BSONObj was successfully created and false if not.
+     * Reads one complete row from the input file.  This usually corresponds to one line
+     * in the input file, unless the file is a CSV and contains a newline within a quoted
+     * string entry, in which case the continuation lines are joined here.
+     * Returns true if a row was read and false if the input is exhausted.
      */
-    bool parseRow(istream* in, BSONObj& o, int& numBytesRead) {
+    bool readRow(istream* in, string& row, int& numBytesRead) {
         boost::scoped_array<char> buffer(new char[BUF_SIZE+2]);
         char* line = buffer.get();
 
@@ -199,29 +203,29 @@ class Import : public Tool {
         }
         numBytesRead += strlen( line );
 
-        if (_type == JSON) {
-            // Strip out trailing whitespace
-            char * end = ( line + strlen( line ) ) - 1;
-            while ( end >= line && isspace(*end) ) {
-                *end = 0;
-                end--;
-            }
-            try {
-                o = fromjson( line );
-            } catch ( MsgAssertionException& e ) {
-                uasserted(13504, string("BSON representation of supplied JSON is too large: ") + e.what());
-            }
-            return true;
-        }
+        row = line;
 
-        vector<string> tokens;
         if (_type == CSV) {
-            string row;
+            // Deal with line breaks in quoted strings
             bool inside_quotes = false;
-            size_t last_quote = 0;
-            while (true) {
+            size_t last_quote = row.find_first_of('"');
+            while (last_quote != string::npos) {
+                inside_quotes = !inside_quotes;
+                last_quote = row.find_first_of('"', last_quote+1);
+            }
+
+            while (inside_quotes) {
+                row.append("\n");
+
+                line = buffer.get();
+                int num = getLine(in, line);
+                line += num;
+                numBytesRead += num;
+
+                uassert(15854, "CSV file ends while inside quoted field", line[0] != '\0');
+                numBytesRead += strlen( line );
+
                 string lineStr(line);
-                // Deal with line breaks in quoted strings
                 last_quote = lineStr.find_first_of('"');
                 while (last_quote != string::npos) {
                     inside_quotes = !inside_quotes;
@@ -229,24 +233,38 @@ class Import : public Tool {
                 }
 
                 row.append(lineStr);
+            }
+        }
 
-                if (inside_quotes) {
-                    row.append("\n");
-                    int num = getLine(in, line);
-                    line += num;
-                    numBytesRead += num;
+        return true;
+    }
 
-                    uassert(15854, "CSV file ends while inside quoted field", line[0] != '\0');
-                    numBytesRead += strlen( line );
-                } else {
-                    break;
-                }
+    /*
+     * Turns one complete row into a BSONObj.  Throws on parsing errors.  Safe to call
+     * from several threads at once, as long as the header line (if any) has already
+     * been consumed.
+     */
+    void parseRowString(const string& row, BSONObj& o) {
+        if (_type == JSON) {
+            // Strip out trailing whitespace
+            string json = row;
+            while ( !json.empty() && isspace(json[json.size()-1]) ) {
+                json.erase(json.size()-1);
+            }
+            try {
+                o = fromjson( json.c_str() );
+            } catch ( MsgAssertionException& e ) {
+                uasserted(13504, string("BSON representation of supplied JSON is too large: ") + e.what());
             }
-            // now 'row' is string corresponding to one row of the CSV file
-            // (which may span multiple lines) and represents one BSONObj
+            return;
+        }
+
+        vector<string> tokens;
+        if (_type == CSV) {
             csvTokenizeRow(row, tokens);
         }
         else {  // _type == TSV
+            const char* line = row.c_str();
             while (line[0] != '\t' && isspace(line[0])) { // Strip leading whitespace, but not tabs
                 line++;
             }
@@ -278,6 +296,19 @@ class Import : public Tool {
             }
         }
         o = b.obj();
+    }
+
+    /*
+     * Parses one object from the input file.
+     * Returns a true if a BSONObj was successfully created and false if not.
+     */
+    bool parseRow(istream* in, BSONObj& o, int& numBytesRead) {
+        string row;
+        if (!readRow(in, row, numBytesRead)) {
+            return false;
+        }
+
+        parseRowString(row, o);
         return true;
     }
 
@@ -293,9 +324,14 @@ public:
     unsigned long long lastErrorFailures;
 
     /** @return true if ok */
-    bool checkLastError() { 
-        string s = conn().getLastError();
-        if( !s.empty() ) { 
+    bool checkLastError() {
+        return checkLastError( conn() );
+    }
+
+    /** @return true if ok */
+    bool checkLastError( DBClientBase& c ) {
+        string s = c.getLastError();
+        if( !s.empty() ) {
             if( str::contains(s,"uplicate") ) {
                 // we don't want to return an error from the mongoimport process for
                 // dup key errors
@@ -333,6 +369,102 @@ public:
         }
     }
 
+    typedef boost::shared_ptr< vector<string> > RowBatch;
+    typedef boost::shared_ptr< vector<BSONObj> > DocBatch;
+
+    // Shared state for the staged import pipeline: the main thread reads complete rows,
+    // a pool of parser threads turns row batches into BSON batches, and an inserter
+    // thread sends bulk inserts over its own connection.  The bounded queues keep any
+    // one stage from running away from the others.
+    struct PipelineState : boost::noncopyable {
+        PipelineState() : rows(MAX_QUEUED_BATCHES), docs(MAX_QUEUED_BATCHES),
+                          readingDone(0), parsingDone(0), stop(0),
+                          activeParsers(0), parseErrors(0), insertErrors(0) {}
+
+        enum { ROWS_PER_BATCH = 512, MAX_QUEUED_BATCHES = 8, GLE_EVERY_N_BATCHES = 16 };
+
+        BlockingQueue<RowBatch> rows;
+        BlockingQueue<DocBatch> docs;
+        AtomicInt32 readingDone;   // reader has pushed its last batch
+        AtomicInt32 parsingDone;   // last parser has exited
+        AtomicInt32 stop;          // abort requested (--stopOnError)
+        AtomicInt32 activeParsers;
+        AtomicInt32 parseErrors;
+        AtomicInt32 insertErrors;
+    };
+
+    void parseWorker( PipelineState* state ) {
+        while (!state->stop.load()) {
+            RowBatch batch;
+            if (!state->rows.blockingPop(batch, 1)) {
+                if (state->readingDone.load() && state->rows.empty())
+                    break;
+                continue;
+            }
+
+            DocBatch out(new vector<BSONObj>());
+            out->reserve(batch->size());
+            for (size_t i = 0; i < batch->size(); i++) {
+                try {
+                    BSONObj o;
+                    parseRowString((*batch)[i], o);
+                    out->push_back(o);
+                }
+                catch ( const std::exception& e ) {
+                    toolError() << "exception:" << e.what() << std::endl;
+                    state->parseErrors.fetchAndAdd(1);
+
+                    if (mongoImportGlobalParams.stopOnError)
+                        state->stop.store(1);
+                }
+            }
+
+            if (!out->empty())
+                state->docs.push(out);
+        }
+
+        if (state->activeParsers.subtractAndFetch(1) == 0)
+            state->parsingDone.store(1);
+    }
+
+    void insertWorker( PipelineState* state, DBClientBase* insertConn, const string ns ) {
+        int batches = 0;
+        while (true) {
+            DocBatch batch;
+            if (!state->docs.blockingPop(batch, 1)) {
+                if (state->parsingDone.load() && state->docs.empty())
+                    break;
+                continue;
+            }
+
+            if (state->stop.load())
+                continue;   // keep draining so the parsers don't block on a full queue
+
+            try {
+                insertConn->insert(ns, *batch,
+                                   mongoImportGlobalParams.stopOnError ?
+                                       0 : InsertOption_ContinueOnError);
+
+                // let several batches ride the connection before synchronizing on
+                // getLastError; errors are still caught, just less promptly
+                if (++batches % PipelineState::GLE_EVERY_N_BATCHES == 0) {
+                    if (!checkLastError(*insertConn) && mongoImportGlobalParams.stopOnError)
+                        state->stop.store(1);
+                }
+            }
+            catch ( const std::exception& e ) {
+                toolError() << "exception:" << e.what() << std::endl;
+                state->insertErrors.fetchAndAdd(1);
+
+                if (mongoImportGlobalParams.stopOnError)
+                    state->stop.store(1);
+            }
+        }
+
+        if (!checkLastError(*insertConn) && mongoImportGlobalParams.stopOnError)
+            state->stop.store(1);
+    }
+
     int run() {
         long long fileSize = 0;
         int headerRows = 0;
@@ -515,6 +647,90 @@ public:
                 }
             }
         }
+        else if (mongoImportGlobalParams.doimport &&
+                 !mongoImportGlobalParams.upsert &&
+                 !toolGlobalParams.useDirectClient &&
+                 mongoImportGlobalParams.numParseThreads > 0) {
+            // staged pipeline: this thread reads rows, a pool of parser threads builds
+            // BSON batches, and an inserter thread keeps bulk inserts on the wire
+            string errmsg;
+            boost::scoped_ptr<DBClientBase> insertConn(openWorkerConnection(errmsg));
+            uassert(17506, str::stream() << "couldn't open insert connection: " << errmsg,
+                    insertConn.get());
+
+            PipelineState state;
+            state.activeParsers.store(mongoImportGlobalParams.numParseThreads);
+
+            vector< boost::shared_ptr<boost::thread> > parsers;
+            for (int i = 0; i < mongoImportGlobalParams.numParseThreads; i++) {
+                parsers.push_back(boost::shared_ptr<boost::thread>(
+                        new boost::thread(boost::bind(&Import::parseWorker, this, &state))));
+            }
+            boost::thread inserter(boost::bind(&Import::insertWorker, this, &state,
+                                               insertConn.get(), ns));
+
+            RowBatch batch(new vector<string>());
+            while (in->rdstate() == 0 && !state.stop.load()) {
+                try {
+                    string row;
+
+                    if (!readRow(in, row, len)) {
+                        continue;
+                    }
+
+                    if (mongoImportGlobalParams.headerLine) {
+                        // parse the header here so that the parser threads never see
+                        // toolGlobalParams.fields changing underneath them
+                        BSONObj o;
+                        parseRowString(row, o);
+                        mongoImportGlobalParams.headerLine = false;
+                    }
+                    else {
+                        batch->push_back(row);
+                        if ((int)batch->size() >= PipelineState::ROWS_PER_BATCH) {
+                            // tryPush so a --stopOnError abort can't leave us blocked
+                            // on a full queue the parsers have already abandoned
+                            while (!state.rows.tryPush(batch)) {
+                                if (state.stop.load())
+                                    break;
+                                sleepmillis(1);
+                            }
+                            batch.reset(new vector<string>());
+                        }
+                    }
+
+                    num++;
+                }
+                catch ( const std::exception& e ) {
+                    toolError() << "exception:" << e.what() << std::endl;
+                    errors++;
+
+                    if (mongoImportGlobalParams.stopOnError)
+                        break;
+                }
+
+                if (!toolGlobalParams.quiet) {
+                    if (pm.hit(len + 1)) {
+                        log() << "\t\t\t" << num << "\t" << (num / (time(0) - start)) << "/second"
+                              << std::endl;
+                    }
+                }
+            }
+
+            if (!batch->empty() && !state.stop.load())
+                state.rows.push(batch);
+            state.readingDone.store(1);
+
+            for (size_t i = 0; i < parsers.size(); i++) {
+                parsers[i]->join();
+            }
+            inserter.join();
+
+            errors += state.parseErrors.load() + state.insertErrors.load();
+
+            // the inserter already issued the final getLastError on its connection
+            lastNumChecked = num - 1;
+        }
         else {
             while (in->rdstate() == 0) {
                 try {
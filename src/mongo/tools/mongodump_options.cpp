@@ -86,6 +86,13 @@ namespace mongo {
                                   .format("[0-9]+:[0-9a-fA-F]+", "[file]:[hex offset]")
                                   .requires("dbpath").requires("dumpExtent").hidden();
 
+        options->addOptionChaining("numParallelCollections", "numParallelCollections,j", moe::Int,
+                "number of collections to dump in parallel (remote connections only)")
+                                  .setDefault(moe::Value(1));
+
+        options->addOptionChaining("compress", "compress", moe::Switch,
+                "compress collection files with snappy (writes .bson.snappy files)");
+
         return Status::OK();
     }
 
@@ -139,6 +146,20 @@ namespace mongo {
         mongoDumpGlobalParams.listExtents = hasParam("listExtents");
         mongoDumpGlobalParams.dumpExtent = hasParam("dumpExtent");
         mongoDumpGlobalParams.diskLoc = getParam("diskLoc");
+        mongoDumpGlobalParams.numParallelCollections = getParam("numParallelCollections", 1);
+        if (mongoDumpGlobalParams.numParallelCollections < 1 ||
+            mongoDumpGlobalParams.numParallelCollections > 64) {
+            return Status(ErrorCodes::BadValue,
+                          "numParallelCollections must be between 1 and 64");
+        }
+        if (mongoDumpGlobalParams.numParallelCollections > 1 && hasParam("dbpath")) {
+            return Status(ErrorCodes::BadValue,
+                          "cannot dump collections in parallel with --dbpath");
+        }
+        mongoDumpGlobalParams.compress = hasParam("compress");
+        if (mongoDumpGlobalParams.compress && getParam("out") == "-") {
+            return Status(ErrorCodes::BadValue, "cannot use --compress when dumping to stdout");
+        }
 
         // Make the default db "" if it was not explicitly set
         if (!params.count("db")) {
@@ -46,6 +46,8 @@ namespace mongo {
         bool listExtents;
         bool dumpExtent;
         std::string diskLoc;
+        int numParallelCollections;
+        bool compress;
     };
 
     extern MongoDumpGlobalParams mongoDumpGlobalParams;
@@ -95,6 +95,11 @@ namespace mongo {
                 "don't actually import. useful for benchmarking parser")
                                   .hidden();
 
+        options->addOptionChaining("numParseThreads", "numParseThreads", moe::Int,
+                "number of parser threads for the staged import pipeline "
+                "(0 disables pipelining)")
+                                  .setDefault(moe::Value(2));
+
 
         return Status::OK();
     }
@@ -155,6 +160,11 @@ namespace mongo {
         mongoImportGlobalParams.jsonArray = hasParam("jsonArray");
         mongoImportGlobalParams.headerLine = hasParam("headerline");
         mongoImportGlobalParams.stopOnError = hasParam("stopOnError");
+        mongoImportGlobalParams.numParseThreads = getParam("numParseThreads", 2);
+        if (mongoImportGlobalParams.numParseThreads < 0 ||
+            mongoImportGlobalParams.numParseThreads > 16) {
+            return Status(ErrorCodes::BadValue, "numParseThreads must be between 0 and 16");
+        }
 
         return Status::OK();
     }
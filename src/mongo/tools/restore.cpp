@@ -49,6 +49,10 @@ using namespace mongo;
 
 namespace {
     const char* OPLOG_SENTINEL = "$oplog";  // compare by ptr not strcmp
+
+    // caps on the buffered plain inserts sent as one batch
+    const int INSERT_BATCH_MAX_DOCS = 1000;
+    const int INSERT_BATCH_MAX_BYTES = 8 * 1024 * 1024;
 }
 
 class Restore : public BSONTool {
@@ -62,7 +66,9 @@ public:
     scoped_ptr<OpTime> _oplogLimitTS; // for oplog replay (limit)
     int _oplogEntrySkips; // oplog entries skipped
     int _oplogEntryApplies; // oplog entries applied
-    Restore() : BSONTool() { }
+    vector<BSONObj> _insertBatch; // plain inserts buffered for the current collection
+    int _insertBatchBytes;
+    Restore() : BSONTool(), _insertBatchBytes(0) { }
 
     virtual void printHelp(ostream& out) {
         printMongoRestoreHelp(&out);
@@ -90,7 +96,7 @@ public:
                 return -1;
             }
 
-            if ( ! exists(root / "oplog.bson") ) {
+            if ( ! exists(root / "oplog.bson") && ! exists(root / "oplog.bson.snappy") ) {
                 toolError() << "No oplog file to replay. Make sure you run mongodump with --oplog."
                           << std::endl;
                 return -1;
@@ -191,7 +197,10 @@ public:
         if (mongoRestoreGlobalParams.oplogReplay) {
             toolInfoLog() << "\t Replaying oplog" << std::endl;
             _curns = OPLOG_SENTINEL;
-            processFile( root / "oplog.bson" );
+            boost::filesystem::path oplogFile = root / "oplog.bson";
+            if ( ! exists(oplogFile) )
+                oplogFile = root / "oplog.bson.snappy";
+            processFile( oplogFile );
             toolInfoLog() << "Applied " << _oplogEntryApplies << " oplog entries out of "
                           << _oplogEntryApplies + _oplogEntrySkips << " (" << _oplogEntrySkips
                           << " skipped)." << std::endl;
@@ -251,10 +260,12 @@ public:
                 }
 
                 // don't insert oplog
-                if (top_level && !use_db && p.leaf() == "oplog.bson")
+                if (top_level && !use_db &&
+                    (p.leaf() == "oplog.bson" || p.leaf() == "oplog.bson.snappy"))
                     continue;
 
-                if ( p.leaf() == "system.indexes.bson" ) {
+                if ( p.leaf() == "system.indexes.bson" ||
+                     p.leaf() == "system.indexes.bson.snappy" ) {
                     indexes = p;
                 } else {
                     drillDown(p, use_db, use_coll, oplogReplayLimit);
@@ -274,14 +285,20 @@ public:
         }
 
         if ( ! ( endsWith( root.string().c_str() , ".bson" ) ||
-                 endsWith( root.string().c_str() , ".bin" ) ) ) {
+                 endsWith( root.string().c_str() , ".bin" ) ||
+                 endsWith( root.string().c_str() , ".bson.snappy" ) ) ) {
             toolError() << "don't know what to do with file [" << root.string() << "]" << std::endl;
             return;
         }
 
         toolInfoLog() << root.string() << std::endl;
 
-        if ( root.leaf() == "system.profile.bson" ) {
+        // the file name with any .snappy suffix stripped, e.g. "foo.bson" for "foo.bson.snappy"
+        string fileBaseName = root.leaf().string();
+        if ( endsWith( fileBaseName.c_str() , ".snappy" ) )
+            fileBaseName = fileBaseName.substr( 0 , fileBaseName.size() - strlen( ".snappy" ) );
+
+        if ( fileBaseName == "system.profile.bson" ) {
             toolInfoLog() << "\t skipping system.profile.bson" << std::endl;
             return;
         }
@@ -298,7 +315,7 @@ public:
 
         verify( ns.size() );
 
-        string oldCollName = root.leaf().string(); // Name of the collection that was dumped from
+        string oldCollName = fileBaseName; // Name of the collection that was dumped from
         oldCollName = oldCollName.substr( 0 , oldCollName.find_last_of( "." ) );
         if (use_coll) {
             ns += "." + toolGlobalParams.coll;
@@ -317,7 +334,7 @@ public:
         toolInfoLog() << "\tgoing into namespace [" << ns << "]" << std::endl;
 
         if (mongoRestoreGlobalParams.drop) {
-            if (root.leaf() != "system.users.bson" ) {
+            if (fileBaseName != "system.users.bson" ) {
                 toolInfoLog() << "\t dropping" << std::endl;
                 conn().dropCollection( ns );
             } else {
@@ -367,7 +384,8 @@ public:
         }
 
         processFile( root );
-        if (mongoRestoreGlobalParams.drop && root.leaf() == "system.users.bson") {
+        flushInserts();
+        if (mongoRestoreGlobalParams.drop && fileBaseName == "system.users.bson") {
             // Delete any users that used to exist but weren't in the dump file
             for (set<string>::iterator it = _users.begin(); it != _users.end(); ++it) {
                 BSONObj userMatch = BSON("user" << *it);
@@ -424,14 +442,31 @@ public:
             _users.erase(obj["user"].String());
         }
         else {
-            conn().insert( _curns , obj );
+            // buffer plain inserts and send them as batches; one network round trip
+            // (and one getLastError when -w is set) covers many documents
+            _insertBatch.push_back( obj.getOwned() );
+            _insertBatchBytes += obj.objsize();
+            if ((int)_insertBatch.size() >= INSERT_BATCH_MAX_DOCS ||
+                _insertBatchBytes >= INSERT_BATCH_MAX_BYTES) {
+                flushInserts();
+            }
+        }
+    }
 
-            // wait for insert to propagate to "w" nodes (doesn't warn if w used without replset)
-            if (mongoRestoreGlobalParams.w > 0) {
-                string err = conn().getLastError(_curdb, false, false, mongoRestoreGlobalParams.w);
-                if (!err.empty()) {
-                    toolError() << err << std::endl;
-                }
+    /** sends any buffered inserts; must be called after each collection's file */
+    void flushInserts() {
+        if (_insertBatch.empty())
+            return;
+
+        conn().insert( _curns , _insertBatch );
+        _insertBatch.clear();
+        _insertBatchBytes = 0;
+
+        // wait for inserts to propagate to "w" nodes (doesn't warn if w used without replset)
+        if (mongoRestoreGlobalParams.w > 0) {
+            string err = conn().getLastError(_curdb, false, false, mongoRestoreGlobalParams.w);
+            if (!err.empty()) {
+                toolError() << err << std::endl;
             }
         }
     }
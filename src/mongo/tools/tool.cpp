@@ -44,6 +44,7 @@
 #include "mongo/db/namespace_details.h"
 #include "mongo/db/storage_options.h"
 #include "mongo/platform/posix_fadvise.h"
+#include "mongo/util/compress.h"
 #include "mongo/util/file_allocator.h"
 #include "mongo/util/options_parser/option_section.h"
 #include "mongo/util/password.h"
@@ -251,6 +252,33 @@ namespace mongo {
                          toolGlobalParams.authenticationMechanism));
     }
 
+    DBClientBase* Tool::openWorkerConnection( std::string& errmsg ) {
+        if (toolGlobalParams.useDirectClient || toolGlobalParams.noconnection) {
+            errmsg = "worker connections require a remote server connection";
+            return NULL;
+        }
+
+        ConnectionString cs = ConnectionString::parse(toolGlobalParams.connectionString, errmsg);
+        if (!cs.isValid()) {
+            return NULL;
+        }
+
+        auto_ptr<DBClientBase> conn(cs.connect(errmsg));
+        if (!conn.get()) {
+            return NULL;
+        }
+
+        if (!toolGlobalParams.username.empty()) {
+            conn->auth(BSON(saslCommandUserDBFieldName << getAuthenticationDatabase() <<
+                            saslCommandUserFieldName << toolGlobalParams.username <<
+                            saslCommandPasswordFieldName << toolGlobalParams.password <<
+                            saslCommandMechanismFieldName <<
+                            toolGlobalParams.authenticationMechanism));
+        }
+
+        return conn.release();
+    }
+
     BSONTool::BSONTool() : Tool() { }
 
     int BSONTool::run() {
@@ -301,6 +329,13 @@ namespace mongo {
             m.setUnits( "bytes" );
         }
 
+        if ( str::endsWith( fileName.c_str() , ".snappy" ) ) {
+            // written by mongodump --compress
+            long long processed = _processSnappyFile( file, fileLength, m );
+            fclose( file );
+            return processed;
+        }
+
         while ( read < fileLength ) {
             size_t amt = fread(buf, 1, 4, file);
             verify( amt == 4 );
@@ -312,25 +347,7 @@ namespace mongo {
             verify( amt == (size_t)( size - 4 ) );
 
             BSONObj o( buf );
-            if (bsonToolGlobalParams.objcheck) {
-                const Status status = validateBSON(buf, size);
-                if (!status.isOK()) {
-                    toolError() << "INVALID OBJECT - going to try and print out " << std::endl;
-                    toolError() << "size: " << size << std::endl;
-                    toolError() << "error: " << status.reason() << std::endl;
-
-                    StringBuilder sb;
-                    try {
-                        o.toString(sb); // using StringBuilder version to get as much as possible
-                    } catch (...) {
-                        toolError() << "object up to error: " << sb.str() << endl;
-                        throw;
-                    }
-                    toolError() << "complete object: " << sb.str() << endl;
-
-                    // NOTE: continuing with object even though we know it is invalid.
-                }
-            }
+            _checkObject( buf, size, o );
 
             if (!bsonToolGlobalParams.hasFilter || _matcher->matches(o)) {
                 gotObject( o );
@@ -354,6 +371,100 @@ namespace mongo {
         return processed;
     }
 
+    void BSONTool::_checkObject( const char* buf, int size, const BSONObj& o ) {
+        if (!bsonToolGlobalParams.objcheck) {
+            return;
+        }
+
+        const Status status = validateBSON(buf, size);
+        if (!status.isOK()) {
+            toolError() << "INVALID OBJECT - going to try and print out " << std::endl;
+            toolError() << "size: " << size << std::endl;
+            toolError() << "error: " << status.reason() << std::endl;
+
+            StringBuilder sb;
+            try {
+                o.toString(sb); // using StringBuilder version to get as much as possible
+            } catch (...) {
+                toolError() << "object up to error: " << sb.str() << endl;
+                throw;
+            }
+            toolError() << "complete object: " << sb.str() << endl;
+
+            // NOTE: continuing with object even though we know it is invalid.
+        }
+    }
+
+    long long BSONTool::_processSnappyFile( FILE* file, unsigned long long fileLength,
+                                            ProgressMeter& m ) {
+        // Each block is two int32 lengths (uncompressed, compressed) followed by the
+        // snappy-compressed bytes of a run of consecutive objects.  A block normally
+        // holds several megabytes of objects, but a single max-size object may push it
+        // past the writer's nominal block size.
+        const int MAX_BLOCK_SIZE = BSONObjMaxUserSize + ( 8 * 1024 * 1024 );
+
+        unsigned long long read = 0;
+        unsigned long long num = 0;
+        unsigned long long processed = 0;
+
+        std::string compressed;
+        std::string block;
+
+        while ( read < fileLength ) {
+            int header[2];
+            size_t amt = fread(header, 1, sizeof(header), file);
+            verify( amt == sizeof(header) );
+            read += sizeof(header);
+
+            const int rawSize = header[0];
+            const int compressedSize = header[1];
+            uassert( 17500, str::stream() << "invalid compressed block header: " << rawSize
+                                          << " / " << compressedSize,
+                     rawSize > 0 && rawSize <= MAX_BLOCK_SIZE && compressedSize > 0 &&
+                     static_cast<unsigned long long>(compressedSize) <= fileLength - read );
+
+            compressed.resize( compressedSize );
+            amt = fread(&compressed[0], 1, compressedSize, file);
+            verify( amt == (size_t)compressedSize );
+            read += compressedSize;
+
+            uassert( 17501, "couldn't uncompress block",
+                     uncompress( compressed.data(), compressedSize, &block ) );
+            uassert( 17502, str::stream() << "uncompressed block has unexpected size: "
+                                          << block.size() << " != " << rawSize,
+                     block.size() == (size_t)rawSize );
+
+            const char* cur = block.data();
+            const char* end = cur + block.size();
+            while ( cur < end ) {
+                int size = ((const int*)cur)[0];
+                uassert( 17503, str::stream() << "invalid object size: " << size,
+                         size >= 5 && size <= end - cur );
+
+                BSONObj o( cur );
+                _checkObject( cur, size, o );
+
+                if (!bsonToolGlobalParams.hasFilter || _matcher->matches(o)) {
+                    gotObject( o );
+                    processed++;
+                }
+
+                cur += size;
+                num++;
+            }
+
+            if (!toolGlobalParams.quiet) {
+                m.hit( sizeof(header) + compressedSize );
+            }
+        }
+
+        uassert(17504, "counts don't match", read == fileLength);
+        toolInfoOutput() << num << " objects found" << std::endl;
+        if (bsonToolGlobalParams.hasFilter)
+            toolInfoOutput() << processed << " objects processed" << std::endl;
+        return processed;
+    }
+
 }
 
 #if defined(_WIN32)
@@ -41,6 +41,7 @@
 #include "mongo/tools/tool_logger.h"
 #include "mongo/tools/tool_options.h"
 #include "mongo/util/options_parser/environment.h"
+#include "mongo/util/progress_meter.h"
 
 using std::string;
 
@@ -76,6 +77,14 @@ namespace mongo {
 
         mongo::DBClientBase &conn( bool slaveIfPaired = false );
 
+        /**
+         * Opens and authenticates a new connection to the same server as conn(), for
+         * tools that drive several collections concurrently.  Only valid for remote
+         * connections (not --dbpath).  Returns NULL and fills in 'errmsg' if the
+         * connection cannot be established; the caller owns the returned connection.
+         */
+        mongo::DBClientBase* openWorkerConnection( std::string& errmsg );
+
         bool _autoreconnect;
 
     protected:
@@ -100,6 +109,13 @@ namespace mongo {
 
         long long processFile( const boost::filesystem::path& file );
 
+    private:
+        /** reports (but does not reject) invalid objects when --objcheck is set */
+        void _checkObject( const char* buf, int size, const BSONObj& o );
+
+        /** reader for the snappy block format written by mongodump --compress */
+        long long _processSnappyFile( FILE* file, unsigned long long fileLength,
+                                      ProgressMeter& m );
     };
 
 }
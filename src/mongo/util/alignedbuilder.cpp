@@ -34,7 +34,7 @@
 
 namespace mongo {
 
-    AlignedBuilder::AlignedBuilder(unsigned initSize) {
+    AlignedBuilder::AlignedBuilder(unsigned initSize, AlignedBufferPool* pool) : _pool(pool) {
         _len = 0;
         _malloc(initSize);
         uassert(13584, "out of memory AlignedBuilder", _p._allocationAddress);
@@ -52,11 +52,23 @@ namespace mongo {
         }
     }
 
+    /** buffer size classes: powers of two up to 32MB, then 32MB steps.  keeping
+        resizes on a small set of sizes is what makes pooling effective -- an exact
+        size match in the pool is a handoff instead of a malloc. */
+    unsigned AlignedBuilder::poolSize(unsigned sz) {
+        unsigned a = 4 * 1024 * 1024;
+        while( a < sz && a < 32 * 1024 * 1024 )
+            a *= 2;
+        if( a >= sz )
+            return a;
+        unsigned Q = 32 * 1024 * 1024 - 1;
+        return (sz+Q) & (~Q);
+    }
+
     /** reset with a hint as to the upcoming needed size specified */
-    void AlignedBuilder::reset(unsigned sz) { 
+    void AlignedBuilder::reset(unsigned sz) {
         _len = 0;
-        unsigned Q = 32 * 1024 * 1024 - 1;
-        unsigned want = (sz+Q) & (~Q);
+        unsigned want = poolSize(sz);
         if( _p._size == want ) {
             return;
         }        
@@ -109,6 +121,8 @@ namespace mongo {
     }
 
     void AlignedBuilder::_malloc(unsigned sz) {
+        if( _pool && _pool->take(sz, &_p) )
+            return;
         _p._size = sz;
 #if defined(_WIN32)
         void *p = VirtualAlloc(0, sz, MEM_COMMIT | MEM_RESERVE, PAGE_READWRITE);
@@ -134,7 +148,15 @@ namespace mongo {
         _malloc(newSize);
         verify( oldLen <= _len );
         memcpy(_p._data, old._data, oldLen);
-        _free(old._allocationAddress);
+        _release(old);
+    }
+
+    void AlignedBuilder::_release(const AllocationInfo& buf) {
+        if( _pool && buf._allocationAddress ) {
+            _pool->put(buf);
+            return;
+        }
+        _free(buf._allocationAddress);
     }
 
     void AlignedBuilder::_free(void *p) {
@@ -146,9 +168,37 @@ namespace mongo {
     }
 
     void AlignedBuilder::kill() {
-        _free(_p._allocationAddress);
+        _release(_p);
         _p._allocationAddress = 0;
         _p._data = 0;
     }
 
+    AlignedBufferPool::~AlignedBufferPool() {
+        for( unsigned i = 0; i < _buffers.size(); i++ )
+            AlignedBuilder::_free(_buffers[i]._allocationAddress);
+    }
+
+    bool AlignedBufferPool::take(unsigned sz, AlignedBuilder::AllocationInfo* out) {
+        SimpleMutex::scoped_lock lk(_mutex);
+        for( unsigned i = 0; i < _buffers.size(); i++ ) {
+            if( _buffers[i]._size == sz ) {
+                *out = _buffers[i];
+                _buffers.erase(_buffers.begin() + i);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void AlignedBufferPool::put(const AlignedBuilder::AllocationInfo& buf) {
+        {
+            SimpleMutex::scoped_lock lk(_mutex);
+            if( _buffers.size() < MaxPooled ) {
+                _buffers.push_back(buf);
+                return;
+            }
+        }
+        AlignedBuilder::_free(buf._allocationAddress);
+    }
+
 }
@@ -30,14 +30,22 @@
 
 #pragma once
 
+#include <vector>
+
 #include "mongo/base/string_data.h"
+#include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
 
+    class AlignedBufferPool;
+
     /** a page-aligned BufBuilder. */
     class AlignedBuilder {
     public:
-        AlignedBuilder(unsigned init_size);
+        /** @param pool if set, backing buffers are checked out of / returned to the
+                        pool instead of being malloced and freed each time the builder
+                        is grown or resized */
+        AlignedBuilder(unsigned init_size, AlignedBufferPool* pool = 0);
         ~AlignedBuilder() { kill(); }
 
         /** reset with a hint as to the upcoming needed size specified */
@@ -106,6 +114,12 @@ namespace mongo {
         /** @return the in-use length */
         unsigned len() const { return _len; }
 
+        struct AllocationInfo {
+            char *_data;
+            void *_allocationAddress;
+            unsigned _size;
+        };
+
     private:
         static const unsigned Alignment = 8192;
 
@@ -119,19 +133,47 @@ namespace mongo {
             return _p._data + oldlen;
         }
 
+        /** quantizes a requested size to the buffer size classes the pool deals in */
+        static unsigned poolSize(unsigned sz);
+
         void growReallocate(unsigned oldLenInUse);
         void kill();
         void mallocSelfAligned(unsigned sz);
         void _malloc(unsigned sz);
         void _realloc(unsigned newSize, unsigned oldLenInUse);
-        void _free(void*);
+        void _release(const AllocationInfo& buf);
+        static void _free(void*);
 
-        struct AllocationInfo {
-            char *_data;
-            void *_allocationAddress;
-            unsigned _size;
-        } _p;
+        AllocationInfo _p;
         unsigned _len;  // bytes in use
+        AlignedBufferPool* _pool; // optional; not owned here
+
+        friend class AlignedBufferPool;
+    };
+
+    /** a small cache of page-aligned allocations for AlignedBuilder instances that are
+        reset and regrown on a hot path (the journal group commit cycle).  checking a
+        pre-sized buffer out of the pool replaces a large malloc/free pair -- and the
+        latency jitter that comes with it -- each time a builder changes size.
+        thread safe. */
+    class AlignedBufferPool : boost::noncopyable {
+    public:
+        AlignedBufferPool() : _mutex("AlignedBufferPool") { }
+        ~AlignedBufferPool();
+
+        /** check out a cached buffer of exactly sz bytes.
+            @return true if a buffer was found and *out filled in */
+        bool take(unsigned sz, AlignedBuilder::AllocationInfo* out);
+
+        /** return a buffer previously allocated by an AlignedBuilder using this pool.
+            the pool keeps at most a few buffers; beyond that they are freed. */
+        void put(const AlignedBuilder::AllocationInfo& buf);
+
+    private:
+        static const unsigned MaxPooled = 4;
+
+        SimpleMutex _mutex;
+        std::vector<AlignedBuilder::AllocationInfo> _buffers;
     };
 
 }
@@ -25,6 +25,13 @@
 #include <boost/thread/once.hpp>
 #include <boost/thread/thread.hpp>
 
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/concurrency/spin_lock.h"
 #include "mongo/util/concurrency/thread_name.h"
@@ -116,6 +123,92 @@ namespace mongo {
 
     } // namespace
 
+    // ---- ThreadAttributes ----
+
+    Status ThreadAttributes::parseCpuList( const std::string& spec, std::vector<int>* cpus ) {
+        cpus->clear();
+        const char* p = spec.c_str();
+        while ( *p ) {
+            char* end;
+            long first = strtol( p, &end, 10 );
+            if ( end == p || first < 0 )
+                return Status( ErrorCodes::BadValue,
+                               mongoutils::str::stream() << "bad cpu list: " << spec );
+            long last = first;
+            if ( *end == '-' ) {
+                p = end + 1;
+                last = strtol( p, &end, 10 );
+                if ( end == p || last < first )
+                    return Status( ErrorCodes::BadValue,
+                                   mongoutils::str::stream() << "bad cpu range: " << spec );
+            }
+            for ( long c = first; c <= last; c++ )
+                cpus->push_back( static_cast<int>( c ) );
+            if ( *end == ',' )
+                end++;
+            else if ( *end )
+                return Status( ErrorCodes::BadValue,
+                               mongoutils::str::stream() << "bad cpu list: " << spec );
+            p = end;
+        }
+        if ( cpus->empty() )
+            return Status( ErrorCodes::BadValue, "empty cpu list" );
+        return Status::OK();
+    }
+
+#if defined(__linux__)
+
+    void ThreadAttributes::applyToCurrentThread( const std::string& threadName ) const {
+
+        if ( !_cpus.empty() ) {
+            cpu_set_t set;
+            CPU_ZERO( &set );
+            for ( size_t i = 0; i < _cpus.size(); i++ ) {
+                if ( _cpus[i] >= 0 && _cpus[i] < CPU_SETSIZE )
+                    CPU_SET( _cpus[i], &set );
+            }
+            // pid 0 == the calling thread
+            if ( sched_setaffinity( 0, sizeof(set), &set ) != 0 ) {
+                warning() << "could not set cpu affinity for thread " << threadName
+                          << ": " << errnoWithDescription() << endl;
+            }
+        }
+
+        if ( _nice != 0 ) {
+            errno = 0;
+            if ( setpriority( PRIO_PROCESS, syscall( SYS_gettid ), _nice ) != 0 && errno ) {
+                warning() << "could not set nice " << _nice << " for thread " << threadName
+                          << ": " << errnoWithDescription() << endl;
+            }
+        }
+
+        if ( _ioClass != IOClassDefault ) {
+            // no glibc wrapper for ioprio_set; IOPRIO_WHO_PROCESS == 1,
+            // class lives in the top 3 bits of the 16 bit priority word
+            if ( syscall( SYS_ioprio_set, 1, syscall( SYS_gettid ),
+                          ( static_cast<int>( _ioClass ) << 13 ) | _ioLevel ) != 0 ) {
+                warning() << "could not set io priority class " << static_cast<int>( _ioClass )
+                          << " level " << _ioLevel << " for thread " << threadName
+                          << ": " << errnoWithDescription() << endl;
+            }
+        }
+    }
+
+#else
+
+    void ThreadAttributes::applyToCurrentThread( const std::string& threadName ) const {
+        if ( !_cpus.empty() || _nice != 0 || _ioClass != IOClassDefault ) {
+            static bool logged = false;
+            if ( !logged ) {
+                logged = true;
+                log() << "thread scheduling attributes not supported on this platform, "
+                      << "ignoring (thread " << threadName << ")" << endl;
+            }
+        }
+    }
+
+#endif
+
     // both the BackgroundJob and the internal thread point to JobStatus
     struct BackgroundJob::JobStatus {
         JobStatus()
@@ -143,6 +236,8 @@ namespace mongo {
 
         LOG(1) << "BackgroundJob starting: " << threadName << endl;
 
+        threadAttributes().applyToCurrentThread( threadName );
+
         try {
             run();
         }
@@ -25,6 +25,57 @@
 
 namespace mongo {
 
+    /**
+     * Optional scheduling attributes applied to a background thread as it starts.
+     *
+     * Affinity and IO priority only exist on linux; elsewhere a non-default
+     * attribute logs once that it is unsupported and is otherwise ignored.
+     * Failures to apply (e.g. insufficient privileges) are logged, never fatal.
+     */
+    class ThreadAttributes {
+    public:
+        enum IOClass {
+            IOClassDefault = 0,  // leave the kernel's setting alone
+            IOClassRealtime = 1, // needs CAP_SYS_ADMIN
+            IOClassBestEffort = 2,
+            IOClassIdle = 3
+        };
+
+        ThreadAttributes() : _nice( 0 ), _ioClass( IOClassDefault ), _ioLevel( 4 ) {}
+
+        /** restrict the thread to the given zero-based cpu ids */
+        ThreadAttributes& cpuAffinity( const std::vector<int>& cpus ) {
+            _cpus = cpus;
+            return *this;
+        }
+
+        /** posix nice value, -20..19; negative values need privileges */
+        ThreadAttributes& schedulingNice( int nice ) {
+            _nice = nice;
+            return *this;
+        }
+
+        /** linux ioprio class and level (level 0..7, lower is served first) */
+        ThreadAttributes& ioClass( IOClass c, int level = 4 ) {
+            _ioClass = c;
+            _ioLevel = level;
+            return *this;
+        }
+
+        /** apply to the calling thread. BackgroundJob does this automatically;
+            threads started by hand (e.g. the journal thread) call it directly. */
+        void applyToCurrentThread( const std::string& threadName ) const;
+
+        /** parse a cpu list like "0,2,4-7" as accepted by cpuAffinity */
+        static Status parseCpuList( const std::string& spec, std::vector<int>* cpus );
+
+    private:
+        std::vector<int> _cpus;
+        int _nice;
+        IOClass _ioClass;
+        int _ioLevel;
+    };
+
     /**
      *  Background thread dispatching.
      *  subclass and define run()
@@ -65,6 +116,12 @@ namespace mongo {
          */
         virtual void run() = 0;
 
+        /**
+         * override to pin the job's thread or adjust its scheduling; applied on
+         * the background thread just before run()
+         */
+        virtual ThreadAttributes threadAttributes() const { return ThreadAttributes(); }
+
     public:
         enum State {
             NotStarted,
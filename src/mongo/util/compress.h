@@ -38,6 +38,11 @@ namespace mongo {
 
     bool uncompress(const char* compressed, size_t compressed_length, std::string* uncompressed);
 
+    bool rawUncompress(const char* compressed, size_t compressed_length, char* uncompressed);
+
+    /** reads the expansion size stored in the compressed stream itself */
+    bool getUncompressedLength(const char* compressed, size_t compressed_length, size_t* result);
+
     size_t maxCompressedLength(size_t source_len);
     void rawCompress(const char* input,
         size_t input_length,
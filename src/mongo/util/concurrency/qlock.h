@@ -33,6 +33,8 @@
 #include <boost/noncopyable.hpp>
 #include <boost/thread/mutex.hpp>
 #include <boost/thread/condition.hpp>
+#include "mongo/platform/atomic_word.h"
+#include "threadlocal.h"
 #include "../assert_util.h"
 #include "../time_support.h"
 
@@ -72,28 +74,73 @@ namespace mongo {
         transition, all threads in the "w" state must be blocked in w_to_X().  When all threads in
         the "w" state are blocked in w_to_X(), one thread will be released in the X state.  The
         other threads remain blocked in w_to_X() until the thread in the X state calls X_to_w().
+
+        The 'R' holder count is striped across cachelines (big-reader pattern): when no
+        writer is present or pending, lock_R/unlock_R touch only the calling thread's
+        stripe and never acquire the mutex, so uncontended global reads don't bounce a
+        shared cacheline between cores.  Writers aggregate the stripes under the mutex.
     */
     class QLock : boost::noncopyable {
-        struct Z { 
+        struct Z {
             Z() : n(0) { }
             boost::condition c;
             int n;
         };
+
+        enum { NumReaderStripes = 16 };
+        struct ReaderStripe {
+            AtomicInt32 n;
+            char pad[64 - sizeof(AtomicInt32)];
+        };
+        ReaderStripe _readers[NumReaderStripes];  // 'R' holders; replaces R.n, which stays 0
+
+        // set (under m) whenever a state or waiter exists that lock_R must coordinate
+        // with; when clear, lock_R and unlock_R may skip the mutex entirely
+        AtomicInt32 _readFastPathBlocked;
+
+        ThreadLocalValue<unsigned> _stripeIndex;  // 1-based; 0 means not yet assigned
+        AtomicUInt32 _nextStripe;
+
         boost::mutex m;
         Z r,w,R,W,U,X;
         int numPendingGlobalWrites;  // >0 if someone wants to acquire a write lock
+        int numPendingGranularWrites;  // threads waiting in lock_w()
         long long generationX;
         long long generationXExit;
         void _lock_W();
-        void _unlock_R();
         bool _areQueueJumpingGlobalWritesPending() const {
             return numPendingGlobalWrites > 0;
         }
 
-        bool W_legal() const { return r.n + w.n + R.n + W.n + X.n == 0; }
+        ReaderStripe& _myReaderStripe() {
+            unsigned ix = _stripeIndex.get();
+            if ( ix == 0 ) {
+                ix = ( _nextStripe.fetchAndAdd(1) % NumReaderStripes ) + 1;
+                _stripeIndex.set( ix );
+            }
+            return _readers[ix-1];
+        }
+
+        int _readerCount() const {
+            int total = 0;
+            for( int i = 0; i < NumReaderStripes; i++ )
+                total += _readers[i].n.load();
+            return total;
+        }
+
+        // call (under m) after changing any state the reader fast path must observe
+        void _updateReadFastPath() {
+            int blocked = w.n + W.n + X.n + U.n +
+                          numPendingGlobalWrites + numPendingGranularWrites;
+            _readFastPathBlocked.store( blocked ? 1 : 0 );
+        }
+
+        void _notifyReaderGone();
+
+        bool W_legal() const { return r.n + w.n + _readerCount() + W.n + X.n == 0; }
         bool R_legal_ignore_greed() const { return w.n + W.n + X.n == 0; }
         bool r_legal_ignore_greed() const { return W.n + X.n == 0; }
-        bool w_legal_ignore_greed() const { return R.n + W.n + X.n == 0; }
+        bool w_legal_ignore_greed() const { return _readerCount() + W.n + X.n == 0; }
 
         bool R_legal() const {
             return !_areQueueJumpingGlobalWritesPending() && R_legal_ignore_greed();
@@ -107,13 +154,14 @@ namespace mongo {
             return !_areQueueJumpingGlobalWritesPending() && r_legal_ignore_greed();
         }
 
-        bool X_legal() const { return w.n + r.n + R.n + W.n == 0; }
+        bool X_legal() const { return w.n + r.n + _readerCount() + W.n == 0; }
 
         void notifyWeUnlocked(char me);
         static bool i_block(char me, char them);
     public:
         QLock() :
             numPendingGlobalWrites(0),
+            numPendingGranularWrites(0),
             generationX(0),
             generationXExit(0) {
         }
@@ -153,7 +201,7 @@ namespace mongo {
         }
         if( U.n ) {
             // U is highest priority
-            if( (r.n + w.n + W.n + X.n == 0) && (R.n == 1) ) {
+            if( (r.n + w.n + W.n + X.n == 0) && (_readerCount() == 1) ) {
                 U.c.notify_one();
                 return;
             }
@@ -187,24 +235,59 @@ namespace mongo {
         r.n++;
     }
 
-    // "i will be writing. i promise to coordinate my activities with w's and r's as i go with more 
+    // "i will be writing. i promise to coordinate my activities with w's and r's as i go with more
     //  granular locks."
-    inline void QLock::lock_w() { 
+    inline void QLock::lock_w() {
         boost::mutex::scoped_lock lk(m);
+        ++numPendingGranularWrites;
+        _updateReadFastPath();
         while( !w_legal() ) {
             w.c.wait(m);
         }
+        --numPendingGranularWrites;
         w.n++;
+        _updateReadFastPath();
+    }
+
+    // wake waiters whose predicates depend on the reader count having dropped.
+    // unlike notifyWeUnlocked this makes no assumptions about current state: the
+    // caller's stripe decrement happened before m was acquired, so the world may
+    // have moved on in between (e.g. a W could already have been granted).
+    inline void QLock::_notifyReaderGone() {
+        if( U.n && (r.n + w.n + W.n + X.n == 0) && (_readerCount() == 1) ) {
+            U.c.notify_one();
+            return;
+        }
+        if ( X_legal() )
+            X.c.notify_one();
+        if ( W_legal() ) {
+            W.c.notify_one();
+            if( _areQueueJumpingGlobalWritesPending() )
+                return;
+        }
+        if ( w_legal_ignore_greed() )
+            w.c.notify_all();
     }
 
     // "i will be reading. i will coordinate with no one. you better stop them if they
     // are writing."
     inline void QLock::lock_R() {
+        // fast path: nothing conflicting is held or pending, so take a core-local
+        // ticket and skip the mutex.  the stripe increment is a full barrier, so
+        // either a writer aggregating the stripes sees our ticket, or we see its
+        // blocked flag and back out below.
+        ReaderStripe& stripe = _myReaderStripe();
+        stripe.n.fetchAndAdd(1);
+        if ( _readFastPathBlocked.load() == 0 )
+            return;
+        stripe.n.fetchAndAdd(-1);
+
         boost::mutex::scoped_lock lk(m);
+        _notifyReaderGone(); // a waiter may have counted our transient ticket
         while( ! R_legal() ) {
             R.c.wait(m);
         }
-        R.n++;
+        stripe.n.fetchAndAdd(1);
     }
 
     inline bool QLock::lock_R_try(int millis) {
@@ -214,7 +297,7 @@ namespace mongo {
             R.c.timed_wait(m, boost::posix_time::milliseconds(millis));
         }
         if ( R_legal() ) {
-            R.n++;
+            _myReaderStripe().n.fetchAndAdd(1);
             return true;
         }
         return false;
@@ -225,6 +308,7 @@ namespace mongo {
         boost::mutex::scoped_lock lk(m);
 
         ++numPendingGlobalWrites;
+        _updateReadFastPath();
         while (!W_legal() && curTimeMillis64() < end) {
             W.c.timed_wait(m, boost::posix_time::milliseconds(millis));
         }
@@ -233,21 +317,24 @@ namespace mongo {
         if (W_legal()) {
             W.n++;
             fassert( 16202, W.n == 1 );
+            _updateReadFastPath();
             return true;
         }
 
+        _updateReadFastPath();
         return false;
     }
 
 
     // downgrade from W state to R state
-    inline void QLock::W_to_R() { 
+    inline void QLock::W_to_R() {
         boost::mutex::scoped_lock lk(m);
         fassert(16203, W.n == 1);
-        fassert(16204, R.n == 0);
+        fassert(16204, _readerCount() == 0);
         fassert(16205, U.n == 0);
         W.n = 0;
-        R.n = 1;
+        _myReaderStripe().n.fetchAndAdd(1);
+        _updateReadFastPath();
         notifyWeUnlocked('W');
     }
 
@@ -261,28 +348,30 @@ namespace mongo {
     //
     // NOTE: ONLY CALL THIS FUNCTION ON A THREAD THAT GOT TO R BY CALLING W_to_R(), OR
     // YOU MAY DEADLOCK WITH THREADS LEAVING THE X STATE.
-    inline void QLock::R_to_W() { 
+    inline void QLock::R_to_W() {
         boost::mutex::scoped_lock lk(m);
-        fassert(16206, R.n > 0);
+        fassert(16206, _readerCount() > 0);
         fassert(16207, W.n == 0);
         fassert(16208, U.n == 0);
 
         U.n = 1;
 
         ++numPendingGlobalWrites;
+        _updateReadFastPath();
 
-        while( W.n + R.n + w.n + r.n > 1 ) {
+        while( W.n + _readerCount() + w.n + r.n > 1 ) {
             U.c.wait(m);
         }
         --numPendingGlobalWrites;
 
-        fassert(16209, R.n == 1);
+        fassert(16209, _readerCount() == 1);
         fassert(16210, W.n == 0);
         fassert(16211, U.n == 1);
 
-        R.n = 0;
+        _myReaderStripe().n.fetchAndAdd(-1);
         W.n = 1;
         U.n = 0;
+        _updateReadFastPath();
     }
 
     inline bool QLock::w_to_X() {
@@ -292,6 +381,7 @@ namespace mongo {
 
         ++X.n;
         --w.n;
+        _updateReadFastPath();
 
         long long myGeneration = generationX;
 
@@ -309,7 +399,7 @@ namespace mongo {
         while ( myGeneration == generationXExit )
             X.c.wait(m);
 
-        fassert( 16216, R.n == 0 );
+        fassert( 16216, _readerCount() == 0 );
         fassert( 16217, w.n > 0 );
         return false;
     }
@@ -318,24 +408,27 @@ namespace mongo {
         boost::mutex::scoped_lock lk(m);
 
         fassert( 16219, W.n == 0 );
-        fassert( 16220, R.n == 0 );
+        fassert( 16220, _readerCount() == 0 );
         fassert( 16221, w.n == 0 );
         fassert( 16222, X.n > 0 );
 
         w.n = X.n;
         X.n = 0;
         ++generationXExit;
+        _updateReadFastPath();
         notifyWeUnlocked('X');
     }
 
     // "i will be writing. i will coordinate with no one. you better stop them all"
     inline void QLock::_lock_W() {
         ++numPendingGlobalWrites;
+        _updateReadFastPath();
         while( !W_legal() ) {
             W.c.wait(m);
         }
         --numPendingGlobalWrites;
         W.n++;
+        _updateReadFastPath();
     }
     inline void QLock::lock_W() {
         boost::mutex::scoped_lock lk(m);
@@ -352,24 +445,26 @@ namespace mongo {
         boost::mutex::scoped_lock lk(m);
         fassert(16138, w.n > 0);
         --w.n;
+        _updateReadFastPath();
         notifyWeUnlocked('w');
     }
 
     inline void QLock::unlock_R() {
+        ReaderStripe& stripe = _myReaderStripe();
+        fassert(16139, stripe.n.load() > 0);
+        stripe.n.fetchAndAdd(-1);
+        if ( _readFastPathBlocked.load() == 0 )
+            return;
+        // someone is present or pending that our going away may unblock
         boost::mutex::scoped_lock lk(m);
-        _unlock_R();
-    }
-
-    inline void QLock::_unlock_R() {
-        fassert(16139, R.n > 0);
-        --R.n;
-        notifyWeUnlocked('R');
+        _notifyReaderGone();
     }
 
     inline void QLock::unlock_W() {
         boost::mutex::scoped_lock lk(m);
         fassert(16140, W.n == 1);
         --W.n;
+        _updateReadFastPath();
         notifyWeUnlocked('W');
     }
 
@@ -0,0 +1,84 @@
+#pragma once
+
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#include <boost/noncopyable.hpp>
+
+#include "mongo/platform/atomic_word.h"
+
+namespace mongo {
+
+    /** A monotonically increasing counter striped across cache lines.
+        Each thread is assigned a stripe (round-robin on first use; the
+        assignment is shared by all StripedCounters) and increments only its own
+        slot, so an uncontended increment is one atomic add on a line no other
+        core is writing instead of a cross-core cacheline transfer; the total is
+        summed over the stripes at read time.  Use for hot, write-mostly
+        counters (opcounters, network totals) that are only read for
+        serverStatus-style reporting.
+    */
+    class StripedCounter : boost::noncopyable {
+    public:
+        StripedCounter() {}
+
+        void increment( long long by = 1 ) {
+            _slots[_myStripe()].value.addAndFetch( by );
+        }
+
+        /** sum over all stripes.  not a point-in-time snapshot across
+            concurrent increments, which is fine for statistics. */
+        long long get() const {
+            long long total = 0;
+            for ( int i = 0; i < NumStripes; i++ )
+                total += _slots[i].value.load();
+            return total;
+        }
+
+        void zero() {
+            for ( int i = 0; i < NumStripes; i++ )
+                _slots[i].value.store( 0 );
+        }
+
+        enum { NumStripes = 32 };
+
+    private:
+        struct Slot {
+            Slot() : value( 0 ) {}
+            AtomicInt64 value;
+            // each stripe gets its own cache line; that's the whole point
+            char pad[64 - sizeof(AtomicInt64)];
+        };
+
+        Slot _slots[NumStripes];
+
+        /** the stripe this thread increments. */
+        static int _myStripe();
+    };
+
+}
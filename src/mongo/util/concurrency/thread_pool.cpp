@@ -20,48 +20,88 @@
 
 #include "mongo/util/concurrency/thread_pool.h"
 
+#include <deque>
+
 #include <boost/thread/thread.hpp>
 
-#include "mongo/util/concurrency/mvar.h"
+#include "mongo/util/concurrency/spin_lock.h"
 
 namespace mongo {
     namespace threadpool {
 
-        // Worker thread
+        // Worker thread with its own task deque.  The owner takes from the back
+        // (newest first, keeps its cache warm); thieves take from the front, so
+        // stolen work is the oldest and the victim loses the least locality.
         class Worker : boost::noncopyable {
         public:
-            explicit Worker(ThreadPool& owner)
+            Worker(ThreadPool& owner, int ix)
                 : _owner(owner)
-                , _is_done(true)
-                , _thread(boost::bind(&Worker::loop, this))
+                , _ix(ix)
             {}
 
-            // destructor will block until current operation is completed
-            // Acts as a "join" on this thread
+            // start the thread; deferred from the constructor because loop()
+            // scans the owner's full worker list when stealing
+            void start() {
+                _thread.reset(new boost::thread(boost::bind(&Worker::loop, this)));
+            }
+
+            void joinThread() {
+                if (_thread) {
+                    _thread->join();
+                    _thread.reset();
+                }
+            }
+
             ~Worker() {
-                _task.put(Task());
-                _thread.join();
+                joinThread();
+                verify(_queue.empty());
+            }
+
+            // any thread
+            void push(const Task& task) {
+                scoped_spinlock lk(_lock);
+                _queue.push_back(task);
             }
 
-            void set_task(Task& func) {
-                verify(!func.empty());
-                verify(_is_done);
-                _is_done = false;
+            // owner's thread only
+            bool popLocal(Task* out) {
+                scoped_spinlock lk(_lock);
+                if (_queue.empty())
+                    return false;
+                *out = _queue.back();
+                _queue.pop_back();
+                return true;
+            }
 
-                _task.put(func);
+            // other workers
+            bool steal(Task* out) {
+                scoped_spinlock lk(_lock);
+                if (_queue.empty())
+                    return false;
+                *out = _queue.front();
+                _queue.pop_front();
+                return true;
             }
 
         private:
-            ThreadPool& _owner;
-            MVar<Task> _task;
-            bool _is_done; // only used for error detection
-            boost::thread _thread;
-
             void loop() {
                 while (true) {
-                    Task task = _task.take();
-                    if (task.empty())
-                        break; // ends the thread
+                    Task task;
+                    bool got = popLocal(&task) || _owner._steal(_ix, &task);
+                    if (!got) {
+                        // nothing anywhere: go to sleep.  we re-check the queues
+                        // after registering as idle, so a push that saw no idlers
+                        // (and skipped the notify) is guaranteed to be seen here.
+                        scoped_lock lk(_owner._mutex);
+                        _owner._idleWorkers.fetchAndAdd(1);
+                        while (!(got = (popLocal(&task) || _owner._steal(_ix, &task))) &&
+                               !_owner._shutdown) {
+                            _owner._taskAvailable.wait(lk.boost());
+                        }
+                        _owner._idleWorkers.fetchAndAdd(-1);
+                        if (!got)
+                            return; // shutting down and the queues are drained
+                    }
 
                     try {
                         task();
@@ -75,73 +115,90 @@ namespace mongo {
                     catch (...) {
                         log() << "Unhandled non-exception in worker thread" << endl;
                     }
-                    _is_done = true;
-                    _owner.task_done(this);
+                    _owner._taskDone();
                 }
             }
+
+            ThreadPool& _owner;
+            const int _ix;
+
+            SpinLock _lock;
+            std::deque<Task> _queue;
+
+            scoped_ptr<boost::thread> _thread;
         };
 
         ThreadPool::ThreadPool(int nThreads)
-            : _mutex("ThreadPool"), _tasksRemaining(0)
-            , _nThreads(nThreads) {
-            scoped_lock lock(_mutex);
-            while (nThreads-- > 0) {
-                Worker* worker = new Worker(*this);
-                _freeWorkers.push_front(worker);
-            }
+            : _mutex("ThreadPool")
+            , _shutdown(false) {
+            verify(nThreads > 0);
+            for (int i = 0; i < nThreads; i++)
+                _workers.push_back(new Worker(*this, i));
+            for (size_t i = 0; i < _workers.size(); i++)
+                _workers[i]->start();
         }
 
         ThreadPool::~ThreadPool() {
             join();
 
-            verify(_tasks.empty());
-
-            // O(n) but n should be small
-            verify(_freeWorkers.size() == (unsigned)_nThreads);
-
-            while(!_freeWorkers.empty()) {
-                delete _freeWorkers.front();
-                _freeWorkers.pop_front();
+            {
+                scoped_lock lk(_mutex);
+                _shutdown = true;
+                _taskAvailable.notify_all();
             }
+
+            // join all threads before deleting any worker: a live worker may still
+            // be scanning its siblings' queues on the way out
+            for (size_t i = 0; i < _workers.size(); i++)
+                _workers[i]->joinThread();
+            for (size_t i = 0; i < _workers.size(); i++)
+                delete _workers[i];
         }
 
         void ThreadPool::join() {
-            scoped_lock lock(_mutex);
-            while(_tasksRemaining) {
-                _condition.wait(lock.boost());
+            scoped_lock lk(_mutex);
+            while (_tasksRemaining.load()) {
+                _poolIsIdle.wait(lk.boost());
             }
         }
 
         void ThreadPool::schedule(Task task) {
-            scoped_lock lock(_mutex);
+            _push(task, _nextQueue.fetchAndAdd(1));
+        }
 
-            _tasksRemaining++;
+        void ThreadPool::scheduleWithAffinity(Task task, unsigned affinityHint) {
+            _push(task, affinityHint);
+        }
 
-            if (!_freeWorkers.empty()) {
-                _freeWorkers.front()->set_task(task);
-                _freeWorkers.pop_front();
-            }
-            else {
-                _tasks.push_back(task);
+        void ThreadPool::_push(Task& task, unsigned queueIx) {
+            verify(!task.empty());
+            _tasksRemaining.fetchAndAdd(1);
+            _workers[queueIx % _workers.size()]->push(task);
+
+            // lazy wake: only touch the mutex when a worker is actually asleep.
+            // the atomic push above and the sleeper's re-check under the mutex
+            // make skipping the notify safe when _idleWorkers reads zero.
+            if (_idleWorkers.load() > 0) {
+                scoped_lock lk(_mutex);
+                _taskAvailable.notify_one();
             }
         }
 
-        // should only be called by a worker from the worker thread
-        void ThreadPool::task_done(Worker* worker) {
-            scoped_lock lock(_mutex);
-
-            if (!_tasks.empty()) {
-                worker->set_task(_tasks.front());
-                _tasks.pop_front();
-            }
-            else {
-                _freeWorkers.push_front(worker);
+        bool ThreadPool::_steal(int thiefIx, Task* out) {
+            const int n = _workers.size();
+            for (int i = 1; i < n; i++) {
+                if (_workers[(thiefIx + i) % n]->steal(out))
+                    return true;
             }
+            return false;
+        }
 
-            _tasksRemaining--;
-
-            if(_tasksRemaining == 0)
-                _condition.notify_all();
+        // called by a worker when it finishes a task
+        void ThreadPool::_taskDone() {
+            if (_tasksRemaining.subtractAndFetch(1) == 0) {
+                scoped_lock lk(_mutex);
+                _poolIsIdle.notify_all();
+            }
         }
 
     } //namespace threadpool
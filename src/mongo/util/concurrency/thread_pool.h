@@ -17,12 +17,13 @@
 
 #pragma once
 
-#include <list>
+#include <vector>
 
 #include <boost/bind.hpp>
 #include <boost/function.hpp>
 #include <boost/thread/condition.hpp>
 
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/concurrency/mutex.h"
 
 namespace mongo {
@@ -32,6 +33,13 @@ namespace mongo {
 
         typedef boost::function<void(void)> Task; //nullary function or functor
 
+        /**
+         * Each worker owns its own task deque: the owner takes from one end, idle
+         * workers steal from the other, and schedule() distributes across the queues,
+         * so there is no single queue lock for fine-grained tasks to convoy on.  The
+         * pool mutex is only touched to put workers to sleep and wake them (and only
+         * when someone is actually asleep -- see _push), and for join().
+         */
         // exported to the mongo namespace
         class ThreadPool : boost::noncopyable {
         public:
@@ -49,6 +57,11 @@ namespace mongo {
             // task will be copied a few times so make sure it's relatively cheap
             void schedule(Task task);
 
+            // like schedule(), but tasks with equal hints land on the same worker's
+            // queue (modulo stealing), so related tasks keep their data warm on one
+            // core.  the hint is any stable number, e.g. a chunk or collection hash.
+            void scheduleWithAffinity(Task task, unsigned affinityHint);
+
             // Helpers that wrap schedule and boost::bind.
             // Functor and args will be copied a few times so make sure it's relatively cheap
             template<typename F, typename A>
@@ -62,20 +75,25 @@ namespace mongo {
             template<typename F, typename A, typename B, typename C, typename D, typename E>
             void schedule(F f, A a, B b, C c, D d, E e) { schedule(boost::bind(f,a,b,c,d,e)); }
 
-            int tasks_remaining() { return _tasksRemaining; }
+            int tasks_remaining() { return _tasksRemaining.load(); }
 
         private:
-            mongo::mutex _mutex;
-            boost::condition _condition;
+            friend class Worker;
 
-            std::list<Worker*> _freeWorkers; //used as LIFO stack (always front)
-            std::list<Task> _tasks; //used as FIFO queue (push_back, pop_front)
-            int _tasksRemaining; // in queue + currently processing
-            int _nThreads; // only used for sanity checking. could be removed in the future.
+            void _push(Task& task, unsigned queueIx);
+            bool _steal(int thiefIx, Task* out);   // scan the other workers' queues
+            void _taskDone();
 
-            // should only be called by a worker from the worker's thread
-            void task_done(Worker* worker);
-            friend class Worker;
+            std::vector<Worker*> _workers;
+            AtomicInt32 _tasksRemaining;  // in queues + currently processing
+            AtomicUInt32 _nextQueue;      // round-robin cursor for schedule()
+            AtomicInt32 _idleWorkers;     // modified under _mutex, read without it
+
+            // guards sleep/wake and join only -- never the task queues
+            mongo::mutex _mutex;
+            boost::condition _taskAvailable;
+            boost::condition _poolIsIdle;
+            bool _shutdown;
         };
 
     } //namespace threadpool
@@ -94,12 +94,19 @@ namespace mongo {
     public:
         T* get() const;
         void reset(T* v);
-        T* getMake() { 
+        T* getMake() {
             T *t = get();
             if( t == 0 )
                 reset( t = new T() );
             return t;
         }
+        /** relinquish ownership of the current value without deleting it */
+        T* release() {
+            T* v = get();
+            tsp.release();
+            reset(0);
+            return v;
+        }
     };
 
 # if defined(MONGO_HAVE___DECLSPEC_THREAD)
@@ -151,13 +158,13 @@ namespace mongo {
             return reinterpret_cast<T*>( pthread_getspecific( _key ) ); 
         }
         
-        void reset(T* v) { 
+        void reset(T* v) {
             T* old = get();
             delete old;
-            verify( pthread_setspecific( _key, v ) == 0 ); 
+            verify( pthread_setspecific( _key, v ) == 0 );
         }
 
-        T* getMake() { 
+        T* getMake() {
             T *t = get();
             if( t == 0 ) {
                 t = new T();
@@ -165,6 +172,13 @@ namespace mongo {
             }
             return t;
         }
+
+        /** relinquish ownership of the current value without deleting it */
+        T* release() {
+            T* v = get();
+            verify( pthread_setspecific( _key, 0 ) == 0 );
+            return v;
+        }
     };
 
 #  define TSP_DECLARE(T,p) extern TSP<T> p;
@@ -179,7 +193,9 @@ namespace mongo {
     public:
         T* get() const { return tsp.get(); }
         void reset(T* v) { tsp.reset(v); }
-        T* getMake() { 
+        /** relinquish ownership of the current value without deleting it */
+        T* release() { return tsp.release(); }
+        T* getMake() {
             T *t = get();
             if( t == 0 )
                 reset( t = new T() );
@@ -0,0 +1,135 @@
+/**
+*    Copyright (C) 2013 10gen Inc.
+*
+*    This program is free software: you can redistribute it and/or  modify
+*    it under the terms of the GNU Affero General Public License, version 3,
+*    as published by the Free Software Foundation.
+*
+*    This program is distributed in the hope that it will be useful,
+*    but WITHOUT ANY WARRANTY; without even the implied warranty of
+*    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+*    GNU Affero General Public License for more details.
+*
+*    You should have received a copy of the GNU Affero General Public License
+*    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*
+*    As a special exception, the copyright holders give permission to link the
+*    code of portions of this program with the OpenSSL library under certain
+*    conditions as described in each individual source file and distribute
+*    linked combinations including the program with the OpenSSL library. You
+*    must comply with the GNU Affero General Public License in all respects
+*    for all of the code used other than as permitted herein. If you modify
+*    file(s) with this exception, you may extend this exception to your
+*    version of the file(s), but you are not obligated to do so. If you do not
+*    wish to do so, delete this exception statement from your version. If you
+*    delete this exception statement from all source files in the program,
+*    then also delete it in the license file.
+*/
+
+#include "mongo/pch.h"
+
+#include "mongo/util/crc32c.h"
+
+#if defined(__x86_64__) && defined(__GNUC__)
+#include <cpuid.h>
+#define MONGO_HAVE_CRC32_HARDWARE
+#endif
+
+namespace mongo {
+
+    namespace {
+
+        // reflected form of the Castagnoli polynomial 0x1EDC6F41
+        const uint32_t Poly = 0x82f63b78U;
+
+        uint32_t table[8][256];
+        bool hardware = false;
+
+        bool detectHardware() {
+#if defined(MONGO_HAVE_CRC32_HARDWARE)
+            unsigned eax, ebx, ecx, edx;
+            if( __get_cpuid(1, &eax, &ebx, &ecx, &edx) )
+                return ( ecx & ( 1 << 20 ) ) != 0; // SSE4.2
+#endif
+            return false;
+        }
+
+        // builds the slicing-by-8 tables at startup rather than pasting 8KB of
+        // literals here.  static initialization is fine: crc32c() is first called
+        // from journal recovery / group commit, well after static init.
+        struct Crc32cInit {
+            Crc32cInit() {
+                for( unsigned i = 0; i < 256; i++ ) {
+                    uint32_t c = i;
+                    for( int k = 0; k < 8; k++ )
+                        c = ( c & 1 ) ? ( Poly ^ ( c >> 1 ) ) : ( c >> 1 );
+                    table[0][i] = c;
+                }
+                for( unsigned k = 1; k < 8; k++ ) {
+                    for( unsigned i = 0; i < 256; i++ )
+                        table[k][i] = table[0][ table[k-1][i] & 0xff ] ^ ( table[k-1][i] >> 8 );
+                }
+                hardware = detectHardware();
+            }
+        } crc32cInit;
+
+#if defined(MONGO_HAVE_CRC32_HARDWARE)
+        uint32_t crcHardware(const void* buf, size_t len) {
+            const char* p = static_cast<const char*>(buf);
+            // 64 bit register even though the crc is 32 bits -- crc32q wants one
+            uint64_t crc = 0xffffffffU;
+            while( len && ( (size_t) p ) % 8 ) {
+                asm( "crc32b %1, %0" : "+r"(crc) : "rm"(*p) );
+                p++; len--;
+            }
+            while( len >= 8 ) {
+                asm( "crc32q %1, %0" : "+r"(crc) : "rm"(*(const uint64_t*)p) );
+                p += 8; len -= 8;
+            }
+            while( len ) {
+                asm( "crc32b %1, %0" : "+r"(crc) : "rm"(*p) );
+                p++; len--;
+            }
+            return static_cast<uint32_t>(crc) ^ 0xffffffffU;
+        }
+#endif
+
+        uint32_t crcSoftware(const void* buf, size_t len) {
+            const char* p = static_cast<const char*>(buf);
+            uint32_t crc = 0xffffffffU;
+            while( len && ( (size_t) p ) % 8 ) {
+                crc = table[0][ ( crc ^ *p ) & 0xff ] ^ ( crc >> 8 );
+                p++; len--;
+            }
+            while( len >= 8 ) {
+                // unpadded little-endian loads; we only target little-endian processors
+                const uint32_t a = crc ^ *(const uint32_t*)p;
+                const uint32_t b = *(const uint32_t*)(p + 4);
+                crc = table[7][ a & 0xff ]          ^ table[6][ ( a >> 8 ) & 0xff ] ^
+                      table[5][ ( a >> 16 ) & 0xff ] ^ table[4][ a >> 24 ] ^
+                      table[3][ b & 0xff ]          ^ table[2][ ( b >> 8 ) & 0xff ] ^
+                      table[1][ ( b >> 16 ) & 0xff ] ^ table[0][ b >> 24 ];
+                p += 8; len -= 8;
+            }
+            while( len ) {
+                crc = table[0][ ( crc ^ *p ) & 0xff ] ^ ( crc >> 8 );
+                p++; len--;
+            }
+            return crc ^ 0xffffffffU;
+        }
+
+    }
+
+    uint32_t crc32c(const void* buf, size_t len) {
+#if defined(MONGO_HAVE_CRC32_HARDWARE)
+        if( hardware )
+            return crcHardware(buf, len);
+#endif
+        return crcSoftware(buf, len);
+    }
+
+    bool crc32cHardwareAvailable() {
+        return hardware;
+    }
+
+}
@@ -24,12 +24,12 @@
 
 #include "mongo/pch.h"
 #include <map>
+#include <vector>
 #include "../db/dur.h"
+#include "mongo/platform/unordered_map.h"
 
 namespace mongo {
 
-#pragma pack(1)
-
     /* you should define:
 
        int Key::hash() return > 0 always.
@@ -39,6 +39,7 @@ namespace mongo {
     class HashTable : boost::noncopyable {
     public:
         const char *name;
+#pragma pack(1)
         struct Node {
             int hash;
             Key k;
@@ -50,6 +51,7 @@ namespace mongo {
                 hash = 0;
             }
         };
+#pragma pack()
         void* _buf;
         int n; // number of hashtable buckets
         int maxChain;
@@ -111,13 +113,24 @@ namespace mongo {
                 verify( sizeof(Node) == 628 );
             }
 
+            // Build the in-memory index with one pass over the mapped table.
+            for ( int i = 0; i < n; i++ ) {
+                if ( nodes(i).inUse() )
+                    _index[nodes(i).hash].push_back(i);
+            }
         }
 
         Type* get(const Key& k) {
-            bool found;
-            int i = _find(k, found);
-            if ( found )
-                return &nodes(i).value;
+            const int h = k.hash();
+            typename IndexMap::const_iterator it = _index.find(h);
+            if ( it == _index.end() )
+                return 0;
+            const std::vector<int>& slots = it->second;
+            for ( size_t j = 0; j < slots.size(); j++ ) {
+                Node& node = nodes(slots[j]);
+                if ( node.hash == h && node.k == k )
+                    return &node.value;
+            }
             return 0;
         }
 
@@ -126,6 +139,7 @@ namespace mongo {
             int i = _find(k, found);
             if ( i >= 0 && found ) {
                 Node* n = &nodes(i);
+                _removeFromIndex( n->hash, i );
                 n = getDur().writing(n);
                 n->k.kill();
                 n->setUnused();
@@ -142,6 +156,7 @@ namespace mongo {
             if ( !found ) {
                 n->k = k;
                 n->hash = k.hash();
+                _index[n->hash].push_back(i);
             }
             else {
                 verify( n->hash == k.hash() );
@@ -169,8 +184,31 @@ namespace mongo {
             }
         }
 
-    };
+    private:
+        void _removeFromIndex( int h, int i ) {
+            typename IndexMap::iterator it = _index.find( h );
+            if ( it == _index.end() )
+                return;
+            std::vector<int>& slots = it->second;
+            for ( size_t j = 0; j < slots.size(); j++ ) {
+                if ( slots[j] == i ) {
+                    slots.erase( slots.begin() + j );
+                    break;
+                }
+            }
+            if ( slots.empty() )
+                _index.erase( it );
+        }
 
-#pragma pack()
+        /* In-memory index over the mapped table: node hash -> slots holding that
+           hash.  Built by one scan at open and maintained by put/kill, it makes
+           get() O(1) at any fill factor instead of walking collision chains.  The
+           on-disk format is untouched - put still places nodes exactly where the
+           linear probe would - so .ns files stay interchangeable with older
+           binaries.
+        */
+        typedef unordered_map< int, std::vector<int> > IndexMap;
+        IndexMap _index;
+    };
 
 } // namespace mongo
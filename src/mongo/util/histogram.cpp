@@ -32,6 +32,8 @@
 #include <limits>
 #include <sstream>
 
+#include "mongo/util/assert_util.h"
+
 namespace mongo {
 
     using std::ostringstream;
@@ -80,6 +82,21 @@ namespace mongo {
         _buckets[ _findBucket(element) ] += 1;
     }
 
+    void Histogram::merge( const Histogram& other ) {
+        verify( _numBuckets == other._numBuckets );
+
+        for ( uint32_t i = 0; i < _numBuckets; i++ ) {
+            verify( _boundaries[i] == other._boundaries[i] );
+            _buckets[i] += other._buckets[i];
+        }
+    }
+
+    void Histogram::reset() {
+        for ( uint32_t i = 0; i < _numBuckets; i++ ) {
+            _buckets[i] = 0;
+        }
+    }
+
     std::string Histogram::toHTML() const {
         uint64_t max = 0;
         for ( uint32_t i = 0; i < _numBuckets; i++ ) {
@@ -87,6 +87,17 @@ namespace mongo {
          */
         void insert( uint32_t element );
 
+        /**
+         * Add the counts from 'other', which must have the same bucket
+         * boundaries as this histogram.
+         */
+        void merge( const Histogram& other );
+
+        /**
+         * Zero out all bucket counts.
+         */
+        void reset();
+
         /**
          * Render the histogram as string that can be used inside an
          * HTML doc.
@@ -44,6 +44,24 @@ namespace mongo {
         ~MAdvise(); // destructor resets the range to MADV_NORMAL
     };
 
+    /** one-shot asynchronous readahead hint (MADV_WILLNEED) for a mapped range.
+        unlike MAdvise this is fire-and-forget -- the kernel starts paging the range
+        in and the call returns immediately.  no-op where unsupported. */
+    void adviseWillNeed(void *p, size_t len);
+
+    /** opt-in transparent hugepage hinting for data file mappings -- see the
+        hugepageHintMappings server parameter.  large mapped regions get
+        MADV_HUGEPAGE so scans of big collections take fewer dTLB misses.
+        linux only; a no-op elsewhere.  MAP_HUGETLB is not an option here as it
+        does not work on regular file-backed mappings. */
+    extern bool hugepageHintMappings;
+    /** hint that the range should be hugepage-backed.
+        @param count accumulate into the coverage counters below (pass false when
+                     re-hinting a region whose VMA was replaced, e.g. on remap) */
+    void adviseHugePages(void *p, size_t len, bool count = true);
+    unsigned long long hugepageBytesHinted();   // cumulative, for serverStatus
+    long long hugepageRegionsHinted();          // cumulative, for serverStatus
+
     // lock order: lock dbMutex before this if you lock both
     class MONGO_CLIENT_API LockMongoFilesShared {
         friend class LockMongoFilesExclusive;
@@ -232,6 +250,13 @@ namespace mongo {
 
         /** close the current private view and open a new replacement */
         void* remapPrivateView(void *oldPrivateAddr);
+
+        /** remap just [regionOfs, regionOfs+regionLen) of the private view, discarding
+            copy-on-write pages in that range only.  offsets must be page aligned.  on
+            platforms that cannot replace part of a view (windows, solaris) this falls
+            back to remapping the whole view.
+        */
+        void* remapPrivateView(void *oldPrivateAddr, size_t regionOfs, size_t regionLen);
     };
 
     /** p is called from within a mutex that MongoFile uses.  so be careful not to deadlock. */
@@ -24,9 +24,11 @@
 #include <sys/types.h>
 
 #include "mongo/db/d_concurrency.h"
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/file_allocator.h"
 #include "mongo/util/mmap.h"
 #include "mongo/util/mongoutils/str.h"
+#include "mongo/util/numa.h"
 #include "mongo/util/processinfo.h"
 
 using namespace mongoutils;
@@ -89,11 +91,51 @@ namespace mongo {
         }
         
     }
-    MAdvise::~MAdvise() { 
+    MAdvise::~MAdvise() {
         madvise(_p,_len,MADV_NORMAL);
     }
 #endif
 
+    bool hugepageHintMappings = false; // server parameter; see hugepage_server_status.cpp
+
+    namespace {
+        AtomicInt64 _hugepageBytesHinted;
+        AtomicInt64 _hugepageRegionsHinted;
+    }
+
+    unsigned long long hugepageBytesHinted() { return _hugepageBytesHinted.load(); }
+    long long hugepageRegionsHinted() { return _hugepageRegionsHinted.load(); }
+
+#if defined(__sunos__) || !defined(MADV_HUGEPAGE)
+    void adviseHugePages(void *, size_t, bool) { }
+#else
+    void adviseHugePages(void *p, size_t len, bool count) {
+        const size_t HugePageSize = 2 * 1024 * 1024;
+        if ( len < HugePageSize )
+            return;
+        if ( madvise( p, len, MADV_HUGEPAGE ) ) {
+            LOG(2) << "madvise HUGEPAGE failed: " << errnoWithDescription() << endl;
+            return;
+        }
+        if ( count ) {
+            _hugepageBytesHinted.addAndFetch( len );
+            _hugepageRegionsHinted.addAndFetch( 1 );
+        }
+    }
+#endif
+
+#if defined(__sunos__) || !defined(MADV_WILLNEED)
+    void adviseWillNeed(void *, size_t) { }
+#else
+    void adviseWillNeed(void *p, size_t len) {
+        void* aligned = (void*)((long)p & ~(g_minOSPageSizeBytes-1));
+        len += (unsigned long long)p - (unsigned long long)aligned;
+        if ( madvise( aligned, len, MADV_WILLNEED ) ) {
+            LOG(2) << "madvise WILLNEED failed: " << errnoWithDescription() << endl;
+        }
+    }
+#endif
+
     void* MemoryMappedFile::map(const char *filename, unsigned long long &length, int options) {
         // length may be updated by callee.
         setFilename(filename);
@@ -136,6 +178,15 @@ namespace mongo {
         }
 #endif
 
+        if ( numaInterleaveMappings ) {
+            // must precede the first fault of each page; mbind doesn't migrate
+            numaInterleaveMemory( view, length );
+        }
+
+        if ( hugepageHintMappings ) {
+            adviseHugePages( view, length );
+        }
+
         views.push_back( view );
 
         return view;
@@ -172,6 +223,14 @@ namespace mongo {
             return 0;
         }
 
+        if ( numaInterleaveMappings ) {
+            numaInterleaveMemory( x, len );
+        }
+
+        if ( hugepageHintMappings ) {
+            adviseHugePages( x, len );
+        }
+
         views.push_back(x);
         return x;
     }
@@ -192,9 +251,46 @@ namespace mongo {
             abort();
         }
         verify( x == oldPrivateAddr );
+        if ( numaInterleaveMappings ) {
+            // the remap replaced the VMA, which drops its memory policy too
+            numaInterleaveMemory( x, len, false );
+        }
+        if ( hugepageHintMappings ) {
+            // the remap replaced the VMA, which drops any prior hugepage advice
+            adviseHugePages( x, len, false );
+        }
         return x;
     }
 
+    void* MemoryMappedFile::remapPrivateView(void *oldPrivateAddr, size_t regionOfs, size_t regionLen) {
+#if defined(__sunos__) // SERVER-8795 - no atomic way to replace part of a view
+        return remapPrivateView( oldPrivateAddr );
+#else
+        verify( regionOfs + regionLen <= len );
+
+        // don't unmap, just mmap over the dirtied part of the old region
+        void *target = static_cast<char*>( oldPrivateAddr ) + regionOfs;
+        void * x = mmap( target, regionLen , PROT_READ|PROT_WRITE , MAP_PRIVATE|MAP_NORESERVE|MAP_FIXED , fd , regionOfs );
+        if( x == MAP_FAILED ) {
+            int err = errno;
+            error()  << "13601 Couldn't remap private view: " << errnoWithDescription(err) << endl;
+            log() << "aborting" << endl;
+            printMemInfo();
+            abort();
+        }
+        verify( x == target );
+        if ( numaInterleaveMappings ) {
+            // the remap replaced the VMA, which drops its memory policy too
+            numaInterleaveMemory( x, regionLen, false );
+        }
+        if ( hugepageHintMappings ) {
+            // the remap replaced the VMA, which drops any prior hugepage advice
+            adviseHugePages( x, regionLen, false );
+        }
+        return x;
+#endif
+    }
+
     void MemoryMappedFile::flush(bool sync) {
         if ( views.empty() || fd == 0 )
             return;
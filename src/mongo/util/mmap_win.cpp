@@ -43,6 +43,13 @@ namespace mongo {
     MAdvise::MAdvise(void *,unsigned, Advice) { }
     MAdvise::~MAdvise() { }
 
+    void adviseWillNeed(void *, size_t) { }
+
+    bool hugepageHintMappings = false;
+    void adviseHugePages(void *, size_t, bool) { }
+    unsigned long long hugepageBytesHinted() { return 0; }
+    long long hugepageRegionsHinted() { return 0; }
+
     static unsigned long long _nextMemoryMappedFileLocation = 256LL * 1024LL * 1024LL * 1024LL;
     static SimpleMutex _nextMemoryMappedFileLocationMutex( "nextMemoryMappedFileLocationMutex" );
 
@@ -327,6 +334,12 @@ namespace mongo {
         return newPrivateView;
     }
 
+    void* MemoryMappedFile::remapPrivateView(void *oldPrivateAddr, size_t regionOfs, size_t regionLen) {
+        // UnmapViewOfFile only unmaps whole views, so a region cannot be replaced in
+        // isolation here; remap everything
+        return remapPrivateView( oldPrivateAddr );
+    }
+
     // prevent WRITETODATAFILES() from running at the same time as FlushViewOfFile()
     SimpleMutex globalFlushMutex("globalFlushMutex");
 
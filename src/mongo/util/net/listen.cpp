@@ -20,7 +20,11 @@
 
 #include "mongo/util/net/listen.h"
 
+#include <boost/thread/thread.hpp>
+
 #include "mongo/base/owned_pointer_vector.h"
+#include "mongo/db/server_parameters.h"
+#include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/net/message_port.h"
 #include "mongo/util/net/ssl_manager.h"
 #include "mongo/util/scopeguard.h"
@@ -60,6 +64,14 @@ namespace mongo {
 
     const Listener* Listener::_timeTracker;
 
+#ifdef SO_REUSEPORT
+    // Number of acceptor threads. With more than one, every acceptor gets its own
+    // SO_REUSEPORT listening socket per address and the kernel load-balances incoming
+    // connections across them, so connection storms are drained in parallel instead of
+    // backing up behind a single accept loop.
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(listenerAcceptorThreads, int, 1);
+#endif
+
     vector<SockAddr> ipToAddrs(const char* ips, int port, bool useUnixSockets) {
         vector<SockAddr> out;
         if (*ips == '\0') {
@@ -154,6 +166,16 @@ namespace mongo {
             }
 #endif
 
+#ifdef SO_REUSEPORT
+            if (listenerAcceptorThreads > 1 && me.getType() != AF_UNIX) {
+                // all sockets bound to this address must carry SO_REUSEPORT, including
+                // the primary's, or the extra acceptors' bind() calls below will fail
+                const int one = 1;
+                if ( setsockopt( sock , SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0 )
+                    out() << "Failed to set socket opt, SO_REUSEPORT" << endl;
+            }
+#endif
+
             if ( ::bind(sock, me.raw(), me.addressSize) != 0 ) {
                 int x = errno;
                 error() << "listen(): bind() failed " << errnoWithDescription(x) << " for socket: " << me.toString() << endl;
@@ -181,7 +203,54 @@ namespace mongo {
             _socks.push_back(sock);
             socketGuard.Dismiss();
         }
-        
+
+#ifdef SO_REUSEPORT
+        if (listenerAcceptorThreads > 1) {
+            _extraAcceptorSocks.resize(listenerAcceptorThreads - 1);
+            for (size_t shard = 0; shard < _extraAcceptorSocks.size(); shard++) {
+                for (vector<SockAddr>::const_iterator it=_mine.begin(), end=_mine.end();
+                        it != end; ++it) {
+                    const SockAddr& me = *it;
+
+                    if (me.getType() == AF_UNIX)
+                        continue; // can't be bound twice; served by the primary acceptor
+
+                    SOCKET sock = ::socket(me.getType(), SOCK_STREAM, 0);
+                    ScopeGuard socketGuard = MakeGuard(&closesocket, sock);
+                    massert( 17470 , str::stream() << "listen(): invalid socket? "
+                                                   << errnoWithDescription() , sock >= 0 );
+
+                    if (me.getType() == AF_INET6) {
+                        const int one = 1;
+                        setsockopt(sock, IPPROTO_IPV6, IPV6_V6ONLY, (const char*) &one, sizeof(one));
+                    }
+
+                    const int one = 1;
+                    if ( setsockopt( sock , SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one)) < 0 )
+                        out() << "Failed to set socket opt, SO_REUSEADDR" << endl;
+                    if ( setsockopt( sock , SOL_SOCKET, SO_REUSEPORT, &one, sizeof(one)) < 0 )
+                        out() << "Failed to set socket opt, SO_REUSEPORT" << endl;
+
+                    if ( ::bind(sock, me.raw(), me.addressSize) != 0 ) {
+                        error() << "listen(): bind() failed " << errnoWithDescription(errno)
+                                << " for acceptor socket: " << me.toString() << endl;
+                        return;
+                    }
+
+                    if ( ::listen(sock, 128) != 0 ) {
+                        error() << "listen(): listen() failed " << errnoWithDescription() << endl;
+                        return;
+                    }
+
+                    ListeningSockets::get()->add( sock );
+
+                    _extraAcceptorSocks[shard].push_back(sock);
+                    socketGuard.Dismiss();
+                }
+            }
+        }
+#endif
+
         _setupSocketsSuccessful = true;
     }
     
@@ -192,30 +261,48 @@ namespace mongo {
             return;
         }
 
+#ifdef MONGO_SSL
+        _logListen(_port, _ssl);
+#else
+        _logListen(_port, false);
+#endif
+
+        // extra acceptors (if any) each drain their own SO_REUSEPORT sockets; the
+        // kernel spreads incoming connections across all of them
+        for (size_t i = 0; i < _extraAcceptorSocks.size(); i++) {
+            if (!_extraAcceptorSocks[i].empty()) {
+                boost::thread( boost::bind( &Listener::_acceptLoop, this,
+                                            &_extraAcceptorSocks[i], false ) );
+            }
+        }
+
+        _acceptLoop(&_socks, true);
+    }
+
+    void Listener::_acceptLoop( const vector<SOCKET>* socksPtr, bool primary ) {
+        const vector<SOCKET>& socks = *socksPtr;
+
+        if (!primary)
+            setThreadName( "listener" );
+
         SOCKET maxfd = 0; // needed for select()
-        for (unsigned i = 0; i < _socks.size(); i++) {
-            if (_socks[i] > maxfd)
-                maxfd = _socks[i];
+        for (unsigned i = 0; i < socks.size(); i++) {
+            if (socks[i] > maxfd)
+                maxfd = socks[i];
         }
 
         if ( maxfd >= FD_SETSIZE ) {
-            error() << "socket " << maxfd << " is higher than " << FD_SETSIZE-1 << 
+            error() << "socket " << maxfd << " is higher than " << FD_SETSIZE-1 <<
                 "; not supported" << warnings;
             return;
         }
 
-#ifdef MONGO_SSL
-        _logListen(_port, _ssl);
-#else
-        _logListen(_port, false);
-#endif
-
         struct timeval maxSelectTime;
         while ( ! inShutdown() ) {
             fd_set fds[1];
             FD_ZERO(fds);
-            
-            for (vector<SOCKET>::iterator it=_socks.begin(), end=_socks.end(); it != end; ++it) {
+
+            for (vector<SOCKET>::const_iterator it=socks.begin(), end=socks.end(); it != end; ++it) {
                 FD_SET(*it, fds);
             }
 
@@ -224,11 +311,13 @@ namespace mongo {
             const int ret = select(maxfd+1, fds, NULL, NULL, &maxSelectTime);
 
             if (ret == 0) {
+                if (primary) {
 #if defined(__linux__)
-                _elapsedTime += ( 10000 - maxSelectTime.tv_usec ) / 1000;
+                    _elapsedTime += ( 10000 - maxSelectTime.tv_usec ) / 1000;
 #else
-                _elapsedTime += 10;
+                    _elapsedTime += 10;
 #endif
+                }
                 continue;
             }
 
@@ -245,13 +334,15 @@ namespace mongo {
                 return;
             }
 
+            if (primary) {
 #if defined(__linux__)
-            _elapsedTime += max(ret, (int)(( 10000 - maxSelectTime.tv_usec ) / 1000));
+                _elapsedTime += max(ret, (int)(( 10000 - maxSelectTime.tv_usec ) / 1000));
 #else
-            _elapsedTime += ret; // assume 1ms to grab connection. very rough
+                _elapsedTime += ret; // assume 1ms to grab connection. very rough
 #endif
+            }
 
-            for (vector<SOCKET>::iterator it=_socks.begin(), end=_socks.end(); it != end; ++it) {
+            for (vector<SOCKET>::const_iterator it=socks.begin(), end=socks.end(); it != end; ++it) {
                 if (! (FD_ISSET(*it, fds)))
                     continue;
                 SockAddr from;
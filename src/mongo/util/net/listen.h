@@ -85,6 +85,9 @@ namespace mongo {
     private:
         std::vector<SockAddr> _mine;
         std::vector<SOCKET> _socks;
+        // one socket set per extra acceptor thread, bound with SO_REUSEPORT so the
+        // kernel load-balances incoming connections across acceptors
+        std::vector<std::vector<SOCKET> > _extraAcceptorSocks;
         std::string _name;
         std::string _ip;
         bool _setupSocketsSuccessful;
@@ -97,6 +100,10 @@ namespace mongo {
         
         void _logListen( int port , bool ssl );
 
+        // accept loop over one acceptor's sockets; only the primary maintains
+        // _elapsedTime. (POSIX only; the Windows initAndListen has its own loop.)
+        void _acceptLoop( const std::vector<SOCKET>* socks, bool primary );
+
         static const Listener* _timeTracker;
         
         virtual bool useUnixSockets() const { return false; }
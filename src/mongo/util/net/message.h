@@ -19,7 +19,10 @@
 
 #include <vector>
 
+#include <boost/shared_ptr.hpp>
+
 #include "mongo/bson/util/atomic_int.h"
+#include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/goodies.h"
 #include "mongo/util/net/hostandport.h"
 #include "mongo/util/net/sock.h"
@@ -46,7 +49,11 @@ namespace mongo {
         dbQuery = 2004,
         dbGetMore = 2005,
         dbDelete = 2006,
-        dbKillCursors = 2007
+        dbKillCursors = 2007,
+        /* wraps another message, snappy-compressed.  body is: int originalOpcode;
+           int uncompressedSize; compressed bytes of the original message body.
+           see MessagingPort::setWireCompression() */
+        dbCompressed = 2012
     };
 
     bool doesOpGetAResponse( int op );
@@ -62,6 +69,7 @@ namespace mongo {
         case dbGetMore: return "getmore";
         case dbDelete: return "remove";
         case dbKillCursors: return "killcursors";
+        case dbCompressed: return "compressed";
         default:
             massert( 16141, str::stream() << "cannot translate opcode " << op, !op );
             return "";
@@ -77,6 +85,7 @@ namespace mongo {
         case dbQuery:
         case dbGetMore:
         case dbKillCursors:
+        case dbCompressed:
             return false;
 
         case dbUpdate:
@@ -150,15 +159,87 @@ namespace mongo {
     }
 #pragma pack()
 
+    /**
+     * A small cache of reusable message buffers, normally one per MessagingPort, so
+     * steady traffic doesn't pay an alloc/free pair per operation.  Buffers enter the
+     * ring through put() -- Message::reset() returns recycled buffers here instead of
+     * freeing them -- and leave through get().  Held by shared_ptr from both the port
+     * and any in-flight Message, so a buffer can safely outlive its port.
+     */
+    class MessageBufferRing : boost::noncopyable {
+    public:
+        /** messages bigger than this get one-off allocations and are never cached,
+            so a single jumbo message doesn't pin memory on an idle connection */
+        static const int MaxRecycledSize = 256 * 1024;
+
+        explicit MessageBufferRing( unsigned slots = 4 )
+            : _mutex( "MessageBufferRing" ), _slots( slots ) {}
+
+        ~MessageBufferRing() {
+            for ( size_t i = 0; i < _free.size(); i++ )
+                free( _free[i].first );
+        }
+
+        /** get a buffer of at least *sz bytes.  *sz is updated to the buffer's actual
+            capacity, which must be handed back to put() with the buffer. */
+        char* get( int* sz ) {
+            {
+                SimpleMutex::scoped_lock lk( _mutex );
+                for ( size_t i = 0; i < _free.size(); i++ ) {
+                    if ( _free[i].second >= *sz ) {
+                        char* buf = _free[i].first;
+                        *sz = _free[i].second;
+                        _free[i] = _free.back();
+                        _free.pop_back();
+                        return buf;
+                    }
+                }
+            }
+            return (char*)malloc( *sz );
+        }
+
+        /** return a buffer obtained from get(); cached for reuse or freed */
+        void put( char* buf, int capacity ) {
+            if ( capacity > MaxRecycledSize ) {
+                free( buf );
+                return;
+            }
+            SimpleMutex::scoped_lock lk( _mutex );
+            if ( _free.size() < _slots ) {
+                _free.push_back( std::make_pair( buf, capacity ) );
+                return;
+            }
+            // full: keep whichever buffers are largest, so the ring converges on the
+            // connection's typical message size
+            size_t smallest = 0;
+            for ( size_t i = 1; i < _free.size(); i++ ) {
+                if ( _free[i].second < _free[smallest].second )
+                    smallest = i;
+            }
+            if ( _free[smallest].second < capacity ) {
+                free( _free[smallest].first );
+                _free[smallest] = std::make_pair( buf, capacity );
+            }
+            else {
+                free( buf );
+            }
+        }
+
+    private:
+        SimpleMutex _mutex;
+        std::vector< std::pair<char*, int> > _free;
+        const size_t _slots;
+    };
+
     class Message {
     public:
         // we assume here that a vector with initial size 0 does no allocation (0 is the default, but wanted to make it explicit).
-        Message() : _buf( 0 ), _data( 0 ), _freeIt( false ) {}
+        Message() : _buf( 0 ), _data( 0 ), _freeIt( false ), _bufCapacity( 0 ) {}
         Message( void * data , bool freeIt ) :
-            _buf( 0 ), _data( 0 ), _freeIt( false ) {
+            _buf( 0 ), _data( 0 ), _freeIt( false ), _bufCapacity( 0 ) {
             _setData( reinterpret_cast< MsgData* >( data ), freeIt );
         };
-        Message(Message& r) : _buf( 0 ), _data( 0 ), _freeIt( false ) {
+        Message(Message& r) : _buf( 0 ), _data( 0 ), _freeIt( false ), _bufCapacity( 0 ) {
             *this = r;
         }
         ~Message() {
@@ -228,6 +309,9 @@ namespace mongo {
             if ( r._data.size() > 0 ) {
                 _data.swap( r._data );
             }
+            _ring.swap( r._ring );
+            _bufCapacity = r._bufCapacity;
+            r._bufCapacity = 0;
             r._freeIt = false;
             _freeIt = true;
             return *this;
@@ -236,7 +320,10 @@ namespace mongo {
         void reset() {
             if ( _freeIt ) {
                 if ( _buf ) {
-                    free( _buf );
+                    if ( _ring )
+                        _ring->put( (char*)_buf, _bufCapacity );
+                    else
+                        free( _buf );
                 }
                 for (std::vector< std::pair< char *, int > >::const_iterator i = _data.begin();
                      i != _data.end(); ++i) {
@@ -246,6 +333,8 @@ namespace mongo {
             _buf = 0;
             _data.clear();
             _freeIt = false;
+            _ring.reset();
+            _bufCapacity = 0;
         }
 
         // use to add a buffer
@@ -261,6 +350,7 @@ namespace mongo {
                 return;
             }
             verify( _freeIt );
+            verify( !_ring ); // recycled buffers stay single-buffer; see setRecycledData()
             if ( _buf ) {
                 _data.push_back(std::make_pair((char*)_buf, _buf->len));
                 _buf = 0;
@@ -274,6 +364,16 @@ namespace mongo {
             verify( empty() );
             _setData( d, freeIt );
         }
+
+        /** like setData(d, true), but on reset() the buffer goes back to ring for
+            reuse instead of being freed.  capacity is what ring->get() reported. */
+        void setRecycledData( MsgData* d, int capacity,
+                              const boost::shared_ptr<MessageBufferRing>& ring ) {
+            verify( empty() );
+            _setData( d, true );
+            _ring = ring;
+            _bufCapacity = capacity;
+        }
         void setData(int operation, const char *msgtxt) {
             setData(operation, msgtxt, strlen(msgtxt)+1);
         }
@@ -306,6 +406,10 @@ namespace mongo {
         typedef std::vector< std::pair< char*, int > > MsgVec;
         MsgVec _data;
         bool _freeIt;
+        // set when _buf came from a MessageBufferRing; keeps the ring alive until
+        // the buffer has been returned to it
+        boost::shared_ptr<MessageBufferRing> _ring;
+        int _bufCapacity;
     };
 
 
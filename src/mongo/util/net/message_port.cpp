@@ -23,6 +23,7 @@
 #include <time.h>
 
 #include "mongo/util/background.h"
+#include "mongo/util/compress.h"
 #include "mongo/util/goodies.h"
 #include "mongo/util/net/listen.h"
 #include "mongo/util/net/message.h"
@@ -45,7 +46,15 @@ namespace mongo {
 // if you want trace output:
 #define mmm(x)
 
-    void AbstractMessagingPort::setConnectionId( long long connectionId ) { 
+    AtomicInt64 wireCompressionBytesSavedIn;
+    AtomicInt64 wireCompressionBytesSavedOut;
+
+    namespace {
+        // a dbCompressed body is: int originalOpcode; int uncompressedSize; compressed bytes
+        const int compressedMetaSize = 2 * sizeof(int);
+    }
+
+    void AbstractMessagingPort::setConnectionId( long long connectionId ) {
         verify( _connectionId == 0 );
         _connectionId = connectionId; 
     }
@@ -124,19 +133,19 @@ namespace mongo {
         ports.closeAll(mask);
     }
 
-    MessagingPort::MessagingPort(int fd, const SockAddr& remote) 
-        : psock( new Socket( fd , remote ) ) , piggyBackData(0) {
+    MessagingPort::MessagingPort(int fd, const SockAddr& remote)
+        : psock( new Socket( fd , remote ) ) , piggyBackData(0) , _compressOut(false) {
         ports.insert(this);
     }
 
-    MessagingPort::MessagingPort( double timeout, logger::LogSeverity ll ) 
-        : psock( new Socket( timeout, ll ) ) {
+    MessagingPort::MessagingPort( double timeout, logger::LogSeverity ll )
+        : psock( new Socket( timeout, ll ) ) , _compressOut(false) {
         ports.insert(this);
         piggyBackData = 0;
     }
 
     MessagingPort::MessagingPort( boost::shared_ptr<Socket> sock )
-        : psock( sock ), piggyBackData( 0 ) {
+        : psock( sock ), piggyBackData( 0 ), _compressOut( false ) {
         ports.insert(this);
     }
 
@@ -211,17 +220,39 @@ again:
             psock->setHandshakeReceived();
             int z = (len+1023)&0xfffffc00;
             verify(z>=len);
-            MsgData *md = (MsgData *) malloc(z);
-            ScopeGuard guard = MakeGuard(free, md);
-            verify(md);
 
-            memcpy(md, &header, headerLen);
-            int left = len - headerLen;
+            MsgData *md;
+            if ( z <= MessageBufferRing::MaxRecycledSize ) {
+                if ( !_recvRing )
+                    _recvRing.reset( new MessageBufferRing() );
+                int capacity = z;
+                md = (MsgData *) _recvRing->get( &capacity );
+                ScopeGuard guard = MakeObjGuard( *_recvRing, &MessageBufferRing::put,
+                                                 (char*)md, capacity );
+                verify(md);
+
+                memcpy(md, &header, headerLen);
+                psock->recv( (char *)&md->_data, len - headerLen );
+
+                guard.Dismiss();
+                m.setRecycledData( md, capacity, _recvRing );
+            }
+            else {
+                // jumbo message - not worth caching a buffer this big per connection
+                md = (MsgData *) malloc(z);
+                ScopeGuard guard = MakeGuard(free, md);
+                verify(md);
+
+                memcpy(md, &header, headerLen);
+                psock->recv( (char *)&md->_data, len - headerLen );
+
+                guard.Dismiss();
+                m.setData(md, true);
+            }
 
-            psock->recv( (char *)&md->_data, left );
+            if ( md->operation() == dbCompressed )
+                return _uncompressMessage( m );
 
-            guard.Dismiss();
-            m.setData(md, true);
             return true;
 
         }
@@ -292,9 +323,98 @@ again:
             }
         }
 
+        if ( _compressOut && toSend.operation() != dbCompressed ) {
+            Message compressed;
+            if ( _compressMessage( toSend , compressed ) ) {
+                compressed.send( *this , "say" );
+                return;
+            }
+            // incompressible message - send it as-is
+        }
+
         toSend.send( *this, "say" );
     }
 
+    bool MessagingPort::_compressMessage( Message& toSend , Message& out ) {
+        toSend.concat(); // snappy needs contiguous input; no-op for single-buffer messages
+        MsgData* md = toSend.singleData();
+        const int bodyLen = md->len - MsgDataHeaderSize;
+        if ( bodyLen <= 0 )
+            return false;
+
+        size_t compressedLen = maxCompressedLength( bodyLen );
+        MsgData* cmd = (MsgData*) malloc( MsgDataHeaderSize + compressedMetaSize + compressedLen );
+        verify( cmd );
+
+        int* meta = (int*) cmd->_data;
+        meta[0] = md->operation();
+        meta[1] = bodyLen;
+        rawCompress( md->_data , bodyLen , cmd->_data + compressedMetaSize , &compressedLen );
+
+        const int wrappedLen = MsgDataHeaderSize + compressedMetaSize + (int)compressedLen;
+        if ( wrappedLen >= md->len ) {
+            free( cmd );
+            return false;
+        }
+
+        cmd->len = wrappedLen;
+        cmd->id = md->id;
+        cmd->responseTo = md->responseTo;
+        cmd->setOperation( dbCompressed );
+        out.setData( cmd , true );
+        wireCompressionBytesSavedOut.fetchAndAdd( md->len - wrappedLen );
+        return true;
+    }
+
+    bool MessagingPort::_uncompressMessage( Message& m ) {
+        MsgData* md = m.singleData();
+        if ( md->len < MsgDataHeaderSize + compressedMetaSize ) {
+            LOG(0) << "recv(): compressed message too short: " << md->len << endl;
+            return false;
+        }
+
+        const int* meta = (const int*) md->_data;
+        const int originalOp = meta[0];
+        const int uncompressedSize = meta[1];
+        if ( uncompressedSize < 0 ||
+             uncompressedSize > MaxMessageSizeBytes - (int)MsgDataHeaderSize ) {
+            LOG(0) << "recv(): bad uncompressed size " << uncompressedSize
+                   << " in compressed message" << endl;
+            return false;
+        }
+
+        // the stream carries its own expansion size; it must agree with the meta header
+        // we sized the allocation from, or a hostile peer could overflow the buffer
+        size_t streamSize = 0;
+        if ( ! getUncompressedLength( md->_data + compressedMetaSize ,
+                                      md->len - MsgDataHeaderSize - compressedMetaSize ,
+                                      &streamSize ) ||
+             streamSize != (size_t) uncompressedSize ) {
+            LOG(0) << "recv(): compressed message length mismatch from "
+                   << remote().toString() << endl;
+            return false;
+        }
+
+        MsgData* ud = (MsgData*) malloc( MsgDataHeaderSize + uncompressedSize );
+        verify( ud );
+        if ( ! rawUncompress( md->_data + compressedMetaSize ,
+                              md->len - MsgDataHeaderSize - compressedMetaSize ,
+                              ud->_data ) ) {
+            free( ud );
+            LOG(0) << "recv(): corrupt compressed message from " << remote().toString() << endl;
+            return false;
+        }
+
+        ud->len = MsgDataHeaderSize + uncompressedSize;
+        ud->id = md->id;
+        ud->responseTo = md->responseTo;
+        ud->setOperation( originalOp );
+        wireCompressionBytesSavedIn.fetchAndAdd( ud->len - md->len );
+        m.reset();
+        m.setData( ud , true );
+        return true;
+    }
+
     void MessagingPort::piggyBack( Message& toSend , int responseTo ) {
 
         if ( toSend.header()->len > 1300 ) {
@@ -19,6 +19,7 @@
 
 #include <vector>
 
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/net/message.h"
 #include "mongo/util/net/sock.h"
 
@@ -52,6 +53,11 @@ namespace mongo {
         long long connectionId() const { return _connectionId; }
         void setConnectionId( long long connectionId );
 
+        /** wire compression support -- see MessagingPort.  default is a no-op so
+            in-process ports (DBDirectClient) simply never compress. */
+        virtual void setWireCompression( bool on ) {}
+        virtual bool isWireCompressed() const { return false; }
+
     public:
         // TODO make this private with some helpers
 
@@ -137,14 +143,37 @@ namespace mongo {
             return psock->isStillConnected();
         }
 
+        /** When enabled, messages sent on this port go out snappy-compressed inside a
+            dbCompressed wrapper (unless compression wouldn't shrink them).  Incoming
+            dbCompressed messages are always accepted, enabled or not, so it is safe to
+            turn this on as soon as the peer has advertised support (via the isMaster
+            "compression" field).
+        */
+        virtual void setWireCompression( bool on ) { _compressOut = on; }
+        virtual bool isWireCompressed() const { return _compressOut; }
+
         uint64_t getSockCreationMicroSec() const {
             return psock->getSockCreationMicroSec();
         }
 
     private:
-        
+
         PiggyBackData * piggyBackData;
 
+        bool _compressOut; // see setWireCompression()
+
+        // reusable receive buffers for this connection; created on first recv().
+        // shared with in-flight Messages so buffers can outlive the port.
+        boost::shared_ptr<MessageBufferRing> _recvRing;
+
+        /** wrap toSend in a dbCompressed message.
+            @return false if compression wouldn't save any bytes */
+        bool _compressMessage( Message& toSend , Message& out );
+
+        /** replace m, a dbCompressed message as read off the wire, with its
+            uncompressed original.  @return false if the message is corrupt */
+        bool _uncompressMessage( Message& m );
+
         // this is the parsed version of remote
         // mutable because its initialized only on call to remote()
         mutable HostAndPort _remoteParsed; 
@@ -155,5 +184,8 @@ namespace mongo {
         friend class PiggyBackData;
     };
 
+    /** total bytes saved by wire compression, reported in serverStatus' network section */
+    extern AtomicInt64 wireCompressionBytesSavedIn;
+    extern AtomicInt64 wireCompressionBytesSavedOut;
 
 } // namespace mongo
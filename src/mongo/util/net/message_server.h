@@ -47,6 +47,23 @@ namespace mongo {
          * called once when a socket is disconnected
          */
         virtual void disconnected( AbstractMessagingPort* p ) = 0;
+
+        /**
+         * Event-mode support. In the event-driven server a connection is serviced by
+         * whichever worker thread picks it up, so a handler whose per-connection state
+         * lives in thread-local storage must be able to detach that state after each
+         * message and reattach it on the next thread. The default implementations are
+         * for handlers with no such state.
+         */
+
+        /** detach this thread's per-connection state; pairs with attachThreadLocalState() */
+        virtual void* releaseThreadLocalState() { return NULL; }
+
+        /** reattach state from a previous releaseThreadLocalState(); may be NULL */
+        virtual void attachThreadLocalState( void* state ) {}
+
+        /** destroy state from releaseThreadLocalState() once the connection is done */
+        virtual void destroyThreadLocalState( void* state ) {}
     };
 
     class MessageServer {
@@ -23,7 +23,9 @@
 
 
 #include "mongo/db/lasterror.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/db/stats/counters.h"
+#include "mongo/util/concurrency/thread_pool.h"
 #include "mongo/util/concurrency/ticketholder.h"
 #include "mongo/util/concurrency/thread_name.h"
 #include "mongo/util/net/listen.h"
@@ -33,11 +35,25 @@
 #include "mongo/util/net/ssl_manager.h"
 
 #ifdef __linux__  // TODO: consider making this ifndef _WIN32
+# include <sys/epoll.h>
 # include <sys/resource.h>
 #endif
 
 namespace mongo {
 
+#ifdef __linux__
+    /**
+     * When enabled, an epoll reactor owns all client sockets and dispatches each request
+     * to a bounded worker pool instead of dedicating a thread (and its stack) to every
+     * connection. Off by default; the thread-per-connection server below remains the
+     * default and the fallback on other platforms.
+     */
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(messageServerEventMode, bool, false);
+
+    // 0 means one worker per CPU core
+    MONGO_EXPORT_STARTUP_SERVER_PARAMETER(messageServerEventModeThreads, int, 0);
+#endif
+
     class PortMessageServer : public MessageServer , public Listener {
     public:
         /**
@@ -244,7 +260,221 @@ namespace mongo {
     };
 
 
+#ifdef __linux__
+    /**
+     * Event-driven message server. An epoll reactor owns every client socket between
+     * requests; when a socket becomes readable the connection is handed to a bounded
+     * worker pool which reads and processes exactly one message, then rearms the socket
+     * in the reactor. Idle connections therefore cost a few hundred bytes instead of a
+     * thread and its stack.
+     *
+     * Per-connection thread-local state (Client/ClientInfo, LastError) is detached from
+     * the worker after each message and reattached on whichever worker services the
+     * connection next; see MessageHandler::releaseThreadLocalState().
+     *
+     * Tradeoff: sockets stay blocking, so a worker that has started reading a request
+     * is held until the whole message arrives. The reactor only dispatches readable
+     * sockets, which keeps that window small for well-behaved clients.
+     */
+    class EPollMessageServer : public MessageServer , public Listener {
+    public:
+        EPollMessageServer( const MessageServer::Options& opts,
+                            MessageHandler* handler,
+                            int nThreads ) :
+            Listener( "" , opts.ipList, opts.port ),
+            _handler(handler),
+            _workers(nThreads) {
+
+            _epollFd = epoll_create( 1 ); // size hint is ignored by modern kernels
+            verify( _epollFd >= 0 );
+        }
+
+        virtual void acceptedMP(MessagingPort * p) {
+            if ( ! Listener::globalTicketHolder.tryAcquire() ) {
+                log() << "connection refused because too many open connections: " << Listener::globalTicketHolder.used() << endl;
+
+                p->shutdown();
+                delete p;
+
+                sleepmillis(2); // otherwise we'll hard loop
+                return;
+            }
+
+            p->psock->setLogLevel(logger::LogSeverity::Debug(1));
+
+            Connection* conn = new Connection( p ); // owns p and the conn ticket from here
+
+            struct epoll_event ev;
+            ev.events = EPOLLIN | EPOLLONESHOT;
+            ev.data.ptr = conn;
+            if ( epoll_ctl( _epollFd, EPOLL_CTL_ADD, p->psock->rawFD(), &ev ) != 0 ) {
+                log() << "epoll_ctl failed to register new connection: "
+                      << errnoWithDescription() << endl;
+
+                p->shutdown();
+                delete conn;
+
+                sleepmillis(2);
+            }
+        }
+
+        virtual void setAsTimeTracker() {
+            Listener::setAsTimeTracker();
+        }
+
+        virtual void setupSockets() {
+            Listener::setupSockets();
+        }
+
+        void run() {
+            boost::thread reactor( boost::bind( &EPollMessageServer::reactorLoop, this ) );
+            initAndListen();
+        }
+
+        virtual bool useUnixSockets() const { return true; }
+
+    private:
+        /** Everything a connection needs between messages. */
+        struct Connection : boost::noncopyable {
+            explicit Connection( MessagingPort* p )
+                : port( p )
+                , le( new LastError() )
+                , handlerState( NULL )
+                , seenConnect( false )
+            {}
+
+            ~Connection() {
+                delete port;
+                delete le;
+                Listener::globalTicketHolder.release();
+            }
+
+            MessagingPort* port;
+            LastError* le;
+            void* handlerState; // handler thread-local state parked between messages
+            bool seenConnect;   // whether handler->connected() has been called
+        };
+
+        void reactorLoop() {
+            setThreadName( "epollReactor" );
+
+            const int kMaxEvents = 256;
+            struct epoll_event events[kMaxEvents];
+
+            while ( !inShutdown() ) {
+                const int n = epoll_wait( _epollFd, events, kMaxEvents, 100 /*ms*/ );
+                if ( n < 0 ) {
+                    if ( errno == EINTR )
+                        continue;
+                    log() << "epoll_wait failed: " << errnoWithDescription() << endl;
+                    sleepmillis(2);
+                    continue;
+                }
+
+                for ( int i = 0; i < n; i++ ) {
+                    // EPOLLONESHOT disarmed the fd, so the connection can't be
+                    // dispatched again until the worker rearms it.
+                    Connection* conn = static_cast<Connection*>( events[i].data.ptr );
+                    _workers.schedule(
+                            boost::bind( &EPollMessageServer::handleEvent, this, conn ) );
+                }
+            }
+        }
+
+        /** Services exactly one message for conn on a pool worker. */
+        void handleEvent( Connection* conn ) {
+            bool keepOpen = false;
+
+            _handler->attachThreadLocalState( conn->handlerState );
+            conn->handlerState = NULL;
+            lastError.reset( conn->le ); // conn keeps ownership, see release() below
+
+            try {
+                if ( !conn->seenConnect ) {
+                    conn->seenConnect = true;
+                    _handler->connected( conn->port );
+                }
+
+                Message m;
+                conn->port->psock->clearCounters();
+
+                if ( ! conn->port->recv(m) ) {
+                    if (!serverGlobalParams.quiet) {
+                        int conns = Listener::globalTicketHolder.used()-1;
+                        const char* word = (conns == 1 ? " connection" : " connections");
+                        log() << "end connection " << conn->port->psock->remoteString()
+                              << " (" << conns << word << " now open)" << endl;
+                    }
+                }
+                else {
+                    _handler->process( m , conn->port , conn->le );
+                    networkCounter.hit( conn->port->psock->getBytesIn(),
+                                        conn->port->psock->getBytesOut() );
+                    keepOpen = !inShutdown();
+                }
+            }
+            catch ( AssertionException& e ) {
+                log() << "AssertionException handling request, closing client connection: " << e << endl;
+            }
+            catch ( SocketException& e ) {
+                log() << "SocketException handling request, closing client connection: " << e << endl;
+            }
+            catch ( const DBException& e ) { // must be right above std::exception to avoid catching subclasses
+                log() << "DBException handling request, closing client connection: " << e << endl;
+            }
+            catch ( std::exception &e ) {
+                error() << "Uncaught std::exception: " << e.what() << ", terminating" << endl;
+                dbexit( EXIT_UNCAUGHT );
+            }
+
+            lastError.release(); // doesn't delete; conn->le still owns it
+
+            if ( keepOpen ) {
+                // Detach the handler's thread-local state *before* rearming the fd:
+                // once the fd is armed another worker may pick this connection up.
+                conn->handlerState = _handler->releaseThreadLocalState();
+
+                struct epoll_event ev;
+                ev.events = EPOLLIN | EPOLLONESHOT;
+                ev.data.ptr = conn;
+                if ( epoll_ctl( _epollFd, EPOLL_CTL_MOD, conn->port->psock->rawFD(), &ev ) == 0 )
+                    return;
+
+                log() << "epoll_ctl failed to rearm connection: "
+                      << errnoWithDescription() << endl;
+
+                // fall through to teardown with the state reattached
+                _handler->attachThreadLocalState( conn->handlerState );
+                conn->handlerState = NULL;
+            }
+
+            _handler->disconnected( conn->port );
+            _handler->destroyThreadLocalState( _handler->releaseThreadLocalState() );
+
+            conn->port->shutdown();
+            delete conn; // releases the conn ticket; the closed fd drops out of epoll
+        }
+
+        MessageHandler* _handler;
+        ThreadPool _workers;
+        int _epollFd;
+    };
+#endif // __linux__
+
     MessageServer * createServer( const MessageServer::Options& opts , MessageHandler * handler ) {
+#ifdef __linux__
+        if ( messageServerEventMode ) {
+            int nThreads = messageServerEventModeThreads;
+            if ( nThreads <= 0 )
+                nThreads = boost::thread::hardware_concurrency();
+            if ( nThreads <= 0 )
+                nThreads = 8;
+
+            log() << "using event-driven message server with " << nThreads
+                  << " worker threads" << endl;
+            return new EPollMessageServer( opts , handler , nThreads );
+        }
+#endif
         return new PortMessageServer( opts , handler );
     }
 
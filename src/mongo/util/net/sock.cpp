@@ -785,6 +785,17 @@ namespace mongo {
         setSockTimeouts( _fd, secs );
     }
 
+    bool Socket::dataPending() {
+        if ( ! isPollSupported() ) return false; // nothing we can do
+
+        pollfd pollInfo;
+        pollInfo.fd = _fd;
+        pollInfo.events = POLLIN;
+
+        // Poll( info[], size, timeout ) - timeout == 0 => nonblocking
+        return socketPoll( &pollInfo, 1, 0 ) > 0 && ( pollInfo.revents & POLLIN );
+    }
+
     // TODO: allow modification?
     //
     // <positive value> : secs to wait between stillConnected checks
@@ -228,6 +228,12 @@ namespace mongo {
         void setTimeout( double secs );
         bool isStillConnected();
 
+        /**
+         * @return true if bytes (or a hangup) are waiting to be read without blocking.
+         * Never blocks; returns false when polling isn't supported on this platform.
+         */
+        bool dataPending();
+
         void setHandshakeReceived() {
             _awaitingHandshake = false;
         }
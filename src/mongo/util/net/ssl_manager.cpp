@@ -24,6 +24,7 @@
 
 #include "mongo/base/init.h"
 #include "mongo/bson/util/atomic_int.h"
+#include "mongo/db/server_parameters.h"
 #include "mongo/util/concurrency/mutex.h"
 #include "mongo/util/mongoutils/str.h"
 #include "mongo/util/net/sock.h"
@@ -127,6 +128,16 @@ namespace mongo {
         SSLManagerInterface* theSSLManager = NULL;
         static const int BUFFER_SIZE = 8*1024;
 
+        // Size of the server-side session cache used for session-ID resumption.
+        // Resumed handshakes skip the full key exchange, which matters a lot for
+        // clients that open a fresh connection per request.  0 disables the cache
+        // and restores the old full-handshake-per-connection behavior.
+        MONGO_EXPORT_STARTUP_SERVER_PARAMETER(sslSessionCacheSize, int,
+                                              SSL_SESSION_CACHE_MAX_SIZE_DEFAULT);
+
+        // How long a cached session may be resumed, in seconds.
+        MONGO_EXPORT_STARTUP_SERVER_PARAMETER(sslSessionTimeoutSeconds, int, 300);
+
         struct Params {
             Params(const std::string& pemfile,
                    const std::string& pempwd,
@@ -537,8 +548,23 @@ namespace mongo {
         // Note: this is for blocking sockets only.
         SSL_CTX_set_mode(*context, SSL_MODE_AUTO_RETRY);
 
-        // Disable session caching (see SERVER-10261)
-        SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_OFF);
+        if (context == &_serverContext && sslSessionCacheSize > 0) {
+            // Enable session-ID resumption for incoming connections.  Session
+            // tickets (RFC 5077) are on by default in OpenSSL and give stateless
+            // resumption to clients that support them; the cache below serves
+            // clients that only do session-ID resumption.  Unlike the unbounded
+            // cache behind SERVER-10261, this one is capped and entries expire.
+            SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_SERVER);
+            SSL_CTX_sess_set_cache_size(*context, sslSessionCacheSize);
+            SSL_CTX_set_timeout(*context, sslSessionTimeoutSeconds);
+            static const unsigned char sessionIdContext[] = "mongodb";
+            SSL_CTX_set_session_id_context(*context, sessionIdContext,
+                                           sizeof(sessionIdContext) - 1);
+        }
+        else {
+            // Disable session caching (see SERVER-10261)
+            SSL_CTX_set_session_cache_mode(*context, SSL_SESS_CACHE_OFF);
+        }
  
         // Use the clusterfile for internal outgoing SSL connections if specified 
         if (context == &_clientContext && !params.clusterfile.empty()) {
@@ -0,0 +1,176 @@
+// numa.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#include "mongo/pch.h"
+
+#include "mongo/util/numa.h"
+
+#include <fstream>
+#include <sstream>
+
+#if defined(__linux__)
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+#include "mongo/platform/atomic_word.h"
+#include "mongo/util/mmap.h"
+
+namespace mongo {
+
+    bool numaInterleaveMappings = false; // server parameter; see numa_server_status.cpp
+
+    namespace {
+        AtomicInt64 _numaBytesInterleaved;
+        AtomicInt64 _numaRegionsInterleaved;
+    }
+
+    unsigned long long numaBytesInterleaved() { return _numaBytesInterleaved.load(); }
+    long long numaRegionsInterleaved() { return _numaRegionsInterleaved.load(); }
+
+#if defined(__linux__)
+
+    namespace {
+        int _countNodes() {
+            int n = 0;
+            while ( true ) {
+                std::stringstream ss;
+                ss << "/sys/devices/system/node/node" << n;
+                if ( ::access( ss.str().c_str(), F_OK ) != 0 )
+                    break;
+                n++;
+            }
+            return n > 0 ? n : 1;
+        }
+    }
+
+    int numaNodeCount() {
+        static const int count = _countNodes();
+        return count;
+    }
+
+    bool numaAvailable() {
+        return numaNodeCount() > 1;
+    }
+
+#if defined(__NR_mbind)
+
+    // from linux/mempolicy.h; we invoke mbind(2) directly to avoid a libnuma
+    // build dependency for what is a single syscall
+#ifndef MPOL_INTERLEAVE
+#define MPOL_INTERLEAVE 3
+#endif
+
+    void numaInterleaveMemory( void *p, size_t len, bool count ) {
+        const int nodes = numaNodeCount();
+        if ( nodes < 2 )
+            return;
+
+        void* aligned = (void*)((long)p & ~(g_minOSPageSizeBytes-1));
+        len += (unsigned long long)p - (unsigned long long)aligned;
+
+        // one word of node mask covers 64 nodes, which is plenty
+        unsigned long nodemask = ( nodes >= (int)( 8 * sizeof(unsigned long) ) ) ?
+            ~0UL : ( ( 1UL << nodes ) - 1 );
+
+        if ( syscall( __NR_mbind, aligned, len, MPOL_INTERLEAVE,
+                      &nodemask, 8 * sizeof(nodemask) + 1, 0 ) ) {
+            LOG(2) << "mbind MPOL_INTERLEAVE failed: " << errnoWithDescription() << endl;
+            return;
+        }
+        if ( count ) {
+            _numaBytesInterleaved.addAndFetch( len );
+            _numaRegionsInterleaved.addAndFetch( 1 );
+        }
+    }
+
+#else
+    void numaInterleaveMemory( void *, size_t, bool ) { }
+#endif
+
+    bool numaBindThreadToNode( int node ) {
+        if ( node < 0 || node >= numaNodeCount() ) {
+            warning() << "cannot bind thread to NUMA node " << node
+                      << ": machine has " << numaNodeCount() << " node(s)" << endl;
+            return false;
+        }
+
+        std::stringstream ss;
+        ss << "/sys/devices/system/node/node" << node << "/cpulist";
+        std::ifstream f( ss.str().c_str() );
+        std::string cpulist;
+        if ( !f.is_open() || !std::getline( f, cpulist ) ) {
+            warning() << "cannot read " << ss.str() << endl;
+            return false;
+        }
+
+        // cpulist looks like "0-7,16-23"
+        cpu_set_t cpus;
+        CPU_ZERO( &cpus );
+        std::stringstream ranges( cpulist );
+        std::string range;
+        while ( std::getline( ranges, range, ',' ) ) {
+            int lo = -1, hi = -1;
+            if ( sscanf( range.c_str(), "%d-%d", &lo, &hi ) < 1 )
+                continue;
+            if ( hi < lo )
+                hi = lo;
+            for ( int c = lo; c <= hi && c < CPU_SETSIZE; c++ )
+                CPU_SET( c, &cpus );
+        }
+
+        if ( sched_setaffinity( 0, sizeof(cpus), &cpus ) ) {
+            warning() << "sched_setaffinity to NUMA node " << node
+                      << " (cpus " << cpulist << ") failed: "
+                      << errnoWithDescription() << endl;
+            return false;
+        }
+        log() << "bound thread to NUMA node " << node << " (cpus " << cpulist << ")" << endl;
+        return true;
+    }
+
+    void numaPerNodePages( std::map<int, long long>* pages ) {
+        pages->clear();
+        std::ifstream f( "/proc/self/numa_maps" );
+        if ( !f.is_open() )
+            return;
+        std::string line;
+        while ( std::getline( f, line ) ) {
+            // each line carries per-node residency as "N<node>=<pages>" tokens
+            std::stringstream tokens( line );
+            std::string tok;
+            while ( tokens >> tok ) {
+                int node;
+                long long n;
+                if ( sscanf( tok.c_str(), "N%d=%lld", &node, &n ) == 2 )
+                    (*pages)[node] += n;
+            }
+        }
+    }
+
+#else
+
+    int numaNodeCount() { return 1; }
+    bool numaAvailable() { return false; }
+    void numaInterleaveMemory( void *, size_t, bool ) { }
+    bool numaBindThreadToNode( int ) { return false; }
+    void numaPerNodePages( std::map<int, long long>* pages ) { pages->clear(); }
+
+#endif
+
+} // namespace mongo
@@ -0,0 +1,60 @@
+// numa.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+#pragma once
+
+#include <cstddef>
+#include <map>
+
+namespace mongo {
+
+    /** number of NUMA memory nodes on this machine (1 when not NUMA, and on
+        platforms where we can't tell).  linux only; cheap after the first call. */
+    int numaNodeCount();
+
+    /** true when the machine has more than one memory node */
+    bool numaAvailable();
+
+    /** opt-in page interleaving for data file mappings -- see the
+        numaInterleaveMappings server parameter.  without it, pages land on
+        whichever node first touches them, so a collection loaded by one thread
+        sits entirely on one node and scans from elsewhere pay the remote-access
+        penalty.  uses mbind(2) directly rather than adding a libnuma
+        dependency.  linux only; a no-op elsewhere. */
+    extern bool numaInterleaveMappings;
+
+    /** set MPOL_INTERLEAVE across all nodes on the given range.  must be
+        applied before the pages are faulted in; already-resident pages are not
+        migrated.  no-op when the machine is not NUMA.
+        @param count accumulate into the coverage counters below (pass false when
+                     re-applying to a region whose VMA was replaced, e.g. on remap) */
+    void numaInterleaveMemory( void *p, size_t len, bool count = true );
+    unsigned long long numaBytesInterleaved();  // cumulative, for serverStatus
+    long long numaRegionsInterleaved();         // cumulative, for serverStatus
+
+    /** pin the calling thread to the cpus of the given node, so memory it
+        first-touches (e.g. the journal's private buffers) stays local to it.
+        returns false (logging why) if the node does not exist or the affinity
+        call fails. */
+    bool numaBindThreadToNode( int node );
+
+    /** per-node resident page counts for this process, aggregated from
+        /proc/self/numa_maps.  walks every mapping, so this is for diagnostics
+        (serverStatus), not hot paths.  leaves the map empty where unsupported. */
+    void numaPerNodePages( std::map<int, long long>* pages );
+
+} // namespace mongo
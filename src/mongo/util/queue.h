@@ -21,9 +21,12 @@
 
 #include <limits>
 #include <queue>
+#include <vector>
 
+#include <boost/scoped_array.hpp>
 #include <boost/thread/condition.hpp>
 
+#include "mongo/platform/atomic_word.h"
 #include "mongo/util/timer.h"
 
 namespace mongo {
@@ -69,6 +72,21 @@ namespace mongo {
             _cvNoLongerEmpty.notify_one();
         }
 
+        /**
+         * Non-blocking push; returns false (leaving the queue unchanged)
+         * instead of waiting when the queue is full.
+         */
+        bool tryPush(T const& t) {
+            scoped_lock l( _lock );
+            size_t tSize = _getSize(t);
+            if (_currentSize + tSize >= _maxSize)
+                return false;
+            _queue.push( t );
+            _currentSize += tSize;
+            _cvNoLongerEmpty.notify_one();
+            return true;
+        }
+
         bool empty() const {
             scoped_lock l( _lock );
             return _queue.empty();
@@ -200,4 +218,411 @@ namespace mongo {
         boost::condition _cvNoLongerEmpty;
     };
 
+    /**
+     * Bounded single-producer / single-consumer ring buffer.  The steady-state
+     * paths (push with room, peek/pop with data) are plain atomic loads and
+     * stores on the head and tail cursors -- no mutex -- so the producer and
+     * consumer never serialize on a queue lock.  The mutex below is only taken
+     * to sleep and wake when the ring is full or empty, and only when someone
+     * is actually asleep (the waiter advertises itself first).
+     *
+     * Bounded by bytes (via the sizing function), like BlockingQueue with a
+     * custom size function.  Strictly one producer thread and one consumer
+     * thread; peek() and pop are consumer-side only.
+     */
+    template<typename T>
+    class SPSCQueue : boost::noncopyable {
+        typedef size_t (*getSizeFunc)(const T& t);
+        // ring slots; entries are separately bounded by _maxBytes so this just
+        // needs to exceed maxBytes / min-entry-size for typical payloads
+        enum { NumSlots = 1 << 17, SlotMask = NumSlots - 1 };
+    public:
+        SPSCQueue(size_t maxBytes, getSizeFunc f) :
+            _ring(NumSlots),
+            _maxBytes(maxBytes),
+            _getSize(f),
+            _lock("SPSCQueue") {}
+
+        /** producer only.  blocks while the ring is full or over the byte bound. */
+        void push(T const& t) {
+            size_t tSize = _getSize(t);
+            if (!_haveRoom(tSize)) {
+                scoped_lock l(_lock);
+                _producerWaiting.store(1);
+                while (!_haveRoom(tSize))
+                    _cvNoLongerFull.wait(l.boost());
+                _producerWaiting.store(0);
+            }
+            unsigned tail = _tail.load();
+            _ring[tail & SlotMask] = t;
+            _bytes.fetchAndAdd(static_cast<long long>(tSize));
+            _tail.store(tail + 1);  // publishes the slot
+            if (_consumerWaiting.load()) {
+                scoped_lock l(_lock);
+                _cvNoLongerEmpty.notify_one();
+            }
+        }
+
+        bool empty() const {
+            return _head.load() == _tail.load();
+        }
+
+        /** bytes queued, as measured by the sizing function */
+        size_t size() const {
+            return static_cast<size_t>(_bytes.load());
+        }
+
+        size_t maxSize() const { return _maxBytes; }
+
+        int count() const {
+            return static_cast<int>(_tail.load() - _head.load());
+        }
+
+        /** consumer only */
+        bool peek(T& t) {
+            unsigned head = _head.load();
+            if (head == _tail.load())
+                return false;
+            t = _ring[head & SlotMask];
+            return true;
+        }
+
+        /** consumer only */
+        bool blockingPeek(T& t, int maxSecondsToWait) {
+            if (peek(t))
+                return true;
+
+            boost::xtime xt;
+            boost::xtime_get(&xt, MONGO_BOOST_TIME_UTC);
+            xt.sec += maxSecondsToWait;
+
+            scoped_lock l(_lock);
+            _consumerWaiting.store(1);
+            while (empty()) {
+                if (!_cvNoLongerEmpty.timed_wait(l.boost(), xt)) {
+                    _consumerWaiting.store(0);
+                    return false;
+                }
+            }
+            _consumerWaiting.store(0);
+            return peek(t);
+        }
+
+        /** consumer only */
+        T blockingPop() {
+            if (empty()) {
+                scoped_lock l(_lock);
+                _consumerWaiting.store(1);
+                while (empty())
+                    _cvNoLongerEmpty.wait(l.boost());
+                _consumerWaiting.store(0);
+            }
+            unsigned head = _head.load();
+            T t = _ring[head & SlotMask];
+            _ring[head & SlotMask] = T();  // release the payload now, not a lap later
+            _bytes.fetchAndAdd(-static_cast<long long>(_getSize(t)));
+            _head.store(head + 1);
+            if (_producerWaiting.load()) {
+                scoped_lock l(_lock);
+                _cvNoLongerFull.notify_one();
+            }
+            return t;
+        }
+
+    private:
+        bool _haveRoom(size_t tSize) const {
+            if (_tail.load() - _head.load() >= NumSlots)
+                return false;
+            return static_cast<size_t>(_bytes.load()) + tSize < _maxBytes;
+        }
+
+        std::vector<T> _ring;
+        const size_t _maxBytes;
+        getSizeFunc _getSize;
+
+        AtomicUInt32 _head;  // consumer cursor
+        AtomicUInt32 _tail;  // producer cursor
+        AtomicInt64 _bytes;
+
+        // sleep/wake only; never held on the fast paths
+        mongo::mutex _lock;
+        AtomicInt32 _producerWaiting;
+        AtomicInt32 _consumerWaiting;
+        boost::condition _cvNoLongerFull;
+        boost::condition _cvNoLongerEmpty;
+    };
+
+    /**
+     * Bounded multi-producer / multi-consumer ring buffer, Vyukov-style: each
+     * slot carries its own sequence number, so a producer claims a slot with
+     * one CAS on the tail cursor and publishes it with a plain store of the
+     * slot's sequence; consumers mirror that on the head cursor.  No mutex is
+     * touched while the queue is neither full nor empty, unlike BlockingQueue
+     * which takes one per push/pop.
+     *
+     * The blocking operations adapt: they spin briefly (the common case when
+     * the other side is active), then park on a condvar like SPSCQueue above
+     * -- the waiter advertises itself under the lock and re-checks before
+     * sleeping, so wakeups are only sent when someone is actually asleep.
+     *
+     * Bounded by item count (rounded up to a power of two), not by bytes.
+     * The batch operations amortize the wakeup and cursor traffic but still
+     * claim slots one CAS at a time; slots only become reusable in FIFO slot
+     * order, so a range claim could observe a later slot free while an
+     * earlier one is still being drained.
+     */
+    template<typename T>
+    class MPMCQueue : boost::noncopyable {
+        enum { SpinsBeforeParking = 1000 };
+    public:
+        explicit MPMCQueue(size_t capacity) : _lock("MPMCQueue") {
+            size_t cap = 2;
+            while (cap < capacity)
+                cap <<= 1;
+            _mask = static_cast<unsigned>(cap - 1);
+            _slots.reset(new Slot[cap]);
+            for (size_t i = 0; i < cap; i++)
+                _slots[i].seq.store(static_cast<unsigned>(i));
+        }
+
+        /** returns false (leaving the queue unchanged) when full */
+        bool tryPush(const T& t) {
+            if (!_pushOne(t))
+                return false;
+            _wakeConsumer();
+            return true;
+        }
+
+        /** blocks while the queue is full; spins first, then parks */
+        void push(const T& t) {
+            if (_pushOne(t)) {
+                _wakeConsumer();
+                return;
+            }
+            for (int i = 0; i < SpinsBeforeParking; i++) {
+#if defined(__i386__) || defined(__x86_64__)
+                asm volatile ( "pause" ) ;
+#endif
+                if (_pushOne(t)) {
+                    _wakeConsumer();
+                    return;
+                }
+            }
+            {
+                scoped_lock l(_lock);
+                _producersWaiting.fetchAndAdd(1);
+                while (!_pushOne(t))
+                    _cvNoLongerFull.wait(l.boost());
+                _producersWaiting.fetchAndAdd(-1);
+            }
+            _wakeConsumer();
+        }
+
+        /** blocking push of every element, waking the consumers once at the end */
+        void pushBatch(const std::vector<T>& ts) {
+            for (size_t i = 0; i < ts.size(); i++) {
+                if (_pushOne(ts[i]))
+                    continue;
+                scoped_lock l(_lock);
+                _producersWaiting.fetchAndAdd(1);
+                while (!_pushOne(ts[i]))
+                    _cvNoLongerFull.wait(l.boost());
+                _producersWaiting.fetchAndAdd(-1);
+            }
+            if (!ts.empty())
+                _wakeConsumers(ts.size());
+        }
+
+        bool tryPop(T& t) {
+            if (!_popOne(t))
+                return false;
+            _wakeProducer();
+            return true;
+        }
+
+        /** pop up to maxElements without blocking, waking producers once.
+            @return number of elements appended to out */
+        size_t popBatch(std::vector<T>* out, size_t maxElements) {
+            size_t n = 0;
+            T t;
+            while (n < maxElements && _popOne(t)) {
+                out->push_back(t);
+                n++;
+            }
+            if (n)
+                _wakeProducers(n);
+            return n;
+        }
+
+        T blockingPop() {
+            T t;
+            if (_popSpinning(t)) {
+                _wakeProducer();
+                return t;
+            }
+            {
+                scoped_lock l(_lock);
+                _consumersWaiting.fetchAndAdd(1);
+                while (!_popOne(t))
+                    _cvNoLongerEmpty.wait(l.boost());
+                _consumersWaiting.fetchAndAdd(-1);
+            }
+            _wakeProducer();
+            return t;
+        }
+
+        /**
+         * like blockingPop but gives up after maxSecondsToWait; returns false
+         * leaving t unchanged on timeout
+         */
+        bool blockingPop(T& t, int maxSecondsToWait) {
+            if (_popSpinning(t)) {
+                _wakeProducer();
+                return true;
+            }
+
+            boost::xtime xt;
+            boost::xtime_get(&xt, MONGO_BOOST_TIME_UTC);
+            xt.sec += maxSecondsToWait;
+
+            {
+                scoped_lock l(_lock);
+                _consumersWaiting.fetchAndAdd(1);
+                while (!_popOne(t)) {
+                    if (!_cvNoLongerEmpty.timed_wait(l.boost(), xt)) {
+                        _consumersWaiting.fetchAndAdd(-1);
+                        return false;
+                    }
+                }
+                _consumersWaiting.fetchAndAdd(-1);
+            }
+            _wakeProducer();
+            return true;
+        }
+
+        bool empty() const {
+            return _head.load() == _tail.load();
+        }
+
+        int count() const {
+            return static_cast<int>(_tail.load() - _head.load());
+        }
+
+        size_t maxSize() const { return static_cast<size_t>(_mask) + 1; }
+
+    private:
+        struct Slot {
+            AtomicUInt32 seq;
+            T payload;
+        };
+
+        /** claim-and-publish; returns false when full */
+        bool _pushOne(const T& t) {
+            unsigned tail = _tail.load();
+            for (;;) {
+                Slot& slot = _slots[tail & _mask];
+                unsigned seq = slot.seq.load();
+                int diff = static_cast<int>(seq - tail);
+                if (diff == 0) {
+                    if (_tail.compareAndSwap(tail, tail + 1) == tail) {
+                        slot.payload = t;
+                        slot.seq.store(tail + 1); // publishes the slot
+                        return true;
+                    }
+                    tail = _tail.load();
+                }
+                else if (diff < 0) {
+                    return false; // a full lap behind: no free slot
+                }
+                else {
+                    tail = _tail.load(); // another producer claimed this slot
+                }
+            }
+        }
+
+        bool _popOne(T& t) {
+            unsigned head = _head.load();
+            for (;;) {
+                Slot& slot = _slots[head & _mask];
+                unsigned seq = slot.seq.load();
+                int diff = static_cast<int>(seq - (head + 1));
+                if (diff == 0) {
+                    if (_head.compareAndSwap(head, head + 1) == head) {
+                        t = slot.payload;
+                        slot.payload = T(); // release the payload now, not a lap later
+                        slot.seq.store(head + _mask + 1); // frees the slot for producers
+                        return true;
+                    }
+                    head = _head.load();
+                }
+                else if (diff < 0) {
+                    return false; // empty
+                }
+                else {
+                    head = _head.load(); // another consumer claimed this slot
+                }
+            }
+        }
+
+        bool _popSpinning(T& t) {
+            if (_popOne(t))
+                return true;
+            for (int i = 0; i < SpinsBeforeParking; i++) {
+#if defined(__i386__) || defined(__x86_64__)
+                asm volatile ( "pause" ) ;
+#endif
+                if (_popOne(t))
+                    return true;
+            }
+            return false;
+        }
+
+        void _wakeConsumer() {
+            if (_consumersWaiting.load()) {
+                scoped_lock l(_lock);
+                _cvNoLongerEmpty.notify_one();
+            }
+        }
+
+        void _wakeConsumers(size_t n) {
+            if (_consumersWaiting.load()) {
+                scoped_lock l(_lock);
+                if (n > 1)
+                    _cvNoLongerEmpty.notify_all();
+                else
+                    _cvNoLongerEmpty.notify_one();
+            }
+        }
+
+        void _wakeProducer() {
+            if (_producersWaiting.load()) {
+                scoped_lock l(_lock);
+                _cvNoLongerFull.notify_one();
+            }
+        }
+
+        void _wakeProducers(size_t n) {
+            if (_producersWaiting.load()) {
+                scoped_lock l(_lock);
+                if (n > 1)
+                    _cvNoLongerFull.notify_all();
+                else
+                    _cvNoLongerFull.notify_one();
+            }
+        }
+
+        boost::scoped_array<Slot> _slots;
+        unsigned _mask;
+
+        AtomicUInt32 _head; // consumer cursor
+        AtomicUInt32 _tail; // producer cursor
+
+        // sleep/wake only; never held while the queue is neither full nor empty
+        mongo::mutex _lock;
+        AtomicInt32 _producersWaiting;
+        AtomicInt32 _consumersWaiting;
+        boost::condition _cvNoLongerFull;
+        boost::condition _cvNoLongerEmpty;
+    };
+
 }
@@ -170,4 +170,41 @@ namespace {
         y = m;
         ASSERT_EQUALS( 5, y["eliot"] );
     }
+
+    TEST( StringMapTest, EraseReinsert1 ) {
+        // Probes have to walk through deleted buckets, at scales where the
+        // metadata is scanned a group at a time.
+        StringMap<int> m;
+        char buf[64];
+
+        for ( int i = 0; i < 10000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i;
+        }
+        for ( int i = 0; i < 10000; i += 2 ) {
+            sprintf( buf, "foo%d", i );
+            ASSERT_EQUALS( 1U, m.erase( buf ) );
+        }
+        ASSERT_EQUALS( 5000U, m.size() );
+
+        for ( int i = 0; i < 10000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            if ( i % 2 ) {
+                ASSERT_EQUALS( i, m.find( buf )->second );
+            }
+            else {
+                ASSERT( m.end() == m.find( buf ) );
+            }
+        }
+
+        for ( int i = 0; i < 10000; i += 2 ) {
+            sprintf( buf, "foo%d", i );
+            m[buf] = i + 1;
+        }
+        ASSERT_EQUALS( 10000U, m.size() );
+        for ( int i = 0; i < 10000; i++ ) {
+            sprintf( buf, "foo%d", i );
+            ASSERT_EQUALS( i % 2 ? i : i + 1, m.find( buf )->second );
+        }
+    }
 }
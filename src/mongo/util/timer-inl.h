@@ -34,6 +34,16 @@
 // On Windows, prefer the Windows-specific implementation, which employs QueryPerformanceCounter.
 #include "mongo/util/timer-win32-inl.h"
 
+#elif defined(__x86_64__) and defined(__GNUC__) and \
+    defined(_POSIX_TIMERS) and _POSIX_TIMERS > 0 and \
+    defined(_POSIX_MONOTONIC_CLOCK) and _POSIX_MONOTONIC_CLOCK >= 0
+
+// On x86-64, use the TSC when the processor advertises it as invariant,
+// falling back to CLOCK_MONOTONIC at runtime otherwise.  Note glibc defines
+// _POSIX_MONOTONIC_CLOCK as 0 ("ask at runtime"); the startup fassert in
+// timer.cpp covers the runtime check.
+#include "mongo/util/timer-tsc-inl.h"
+
 #elif defined(_POSIX_TIMERS) and _POSIX_TIMERS > 0 and defined(_POSIX_MONOTONIC_CLOCK) and _POSIX_MONOTONIC_CLOCK > 0
 
 // On systems that support the POSIX clock_gettime function, and the "monotonic" clock,
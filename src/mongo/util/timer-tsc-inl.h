@@ -0,0 +1,55 @@
+/*    Copyright 2013 10gen Inc.
+ *
+ *    Licensed under the Apache License, Version 2.0 (the "License");
+ *    you may not use this file except in compliance with the License.
+ *    You may obtain a copy of the License at
+ *
+ *    http://www.apache.org/licenses/LICENSE-2.0
+ *
+ *    Unless required by applicable law or agreed to in writing, software
+ *    distributed under the License is distributed on an "AS IS" BASIS,
+ *    WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+ *    See the License for the specific language governing permissions and
+ *    limitations under the License.
+ */
+
+/**
+ * Inline function implementations for timers on x86-64 systems with an
+ * invariant TSC.  A timestamp is a single rdtsc (~20 cycles) instead of a
+ * clock_gettime call; the TSC frequency is calibrated against
+ * CLOCK_MONOTONIC at startup.  If the processor does not advertise an
+ * invariant TSC we fall back to CLOCK_MONOTONIC at runtime, so the decision
+ * is per-host, not per-build.
+ *
+ * This file should only be included through timer-inl.h, which selects the
+ * particular implementation based on target platform.
+ */
+
+#define MONGO_TIMER_IMPL_TSC
+
+namespace mongo {
+
+    namespace timer_tsc {
+
+        // set at startup, after calibration, iff the invariant-TSC cpuid bit
+        // is present; false means every now() takes the fallback path
+        extern bool usingTsc;
+
+        // the CLOCK_MONOTONIC path, in nanoseconds; also used for calibration
+        unsigned long long fallbackNow();
+
+        inline unsigned long long rdtsc() {
+            unsigned lo, hi;
+            __asm__ __volatile__ ( "rdtsc" : "=a" (lo), "=d" (hi) );
+            return ( static_cast<unsigned long long>(hi) << 32 ) | lo;
+        }
+
+    }  // namespace timer_tsc
+
+    unsigned long long Timer::now() const {
+        if ( timer_tsc::usingTsc )
+            return timer_tsc::rdtsc();
+        return timer_tsc::fallbackNow();
+    }
+
+}  // namespace mongo
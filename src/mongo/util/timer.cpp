@@ -19,8 +19,50 @@
 
 #include <limits>
 
+#if defined(MONGO_TIMER_IMPL_TSC)
+#include <cpuid.h>
+#include <ctime>
+#include "mongo/util/assert_util.h"
+#endif
+
 namespace mongo {
 
+#if defined(MONGO_TIMER_IMPL_TSC)
+
+    namespace timer_tsc {
+
+        bool usingTsc = false;
+
+        unsigned long long fallbackNow() {
+            timespec the_time;
+            fassert(17487, !clock_gettime(CLOCK_MONOTONIC, &the_time));
+            unsigned long long result = static_cast<unsigned long long>(the_time.tv_sec);
+            result *= Timer::nanosPerSecond;
+            result += static_cast<unsigned long long>(the_time.tv_nsec);
+            return result;
+        }
+
+        namespace {
+
+            // invariant TSC (constant rate, keeps counting in deep C-states,
+            // synchronized across cores): cpuid leaf 0x80000007, EDX bit 8
+            bool hasInvariantTsc() {
+                unsigned eax, ebx, ecx, edx;
+                if (!__get_cpuid(0x80000000u, &eax, &ebx, &ecx, &edx))
+                    return false;
+                if (eax < 0x80000007u)
+                    return false;
+                if (!__get_cpuid(0x80000007u, &eax, &ebx, &ecx, &edx))
+                    return false;
+                return (edx & (1u << 8)) != 0;
+            }
+
+        }  // namespace
+
+    }  // namespace timer_tsc
+
+#endif
+
     // default value of 1 so that during startup initialization if referenced no division by zero
     unsigned long long Timer::_countsPerSecond = 1;
 
@@ -31,7 +73,41 @@ namespace mongo {
             AtStartup();
         } atstartuputil;
 
-#if defined(MONGO_TIMER_IMPL_WIN32)
+#if defined(MONGO_TIMER_IMPL_TSC)
+
+        AtStartup::AtStartup() {
+            using namespace timer_tsc;
+
+            // fallback default: fallbackNow() counts nanoseconds
+            Timer::_countsPerSecond = Timer::nanosPerSecond;
+
+            unsigned long long maxSecs = std::numeric_limits<unsigned long long>::max() /
+                Timer::nanosPerSecond;
+            timespec the_time;
+            fassert(17488, !clock_gettime(CLOCK_MONOTONIC, &the_time));
+            fassert(17489, static_cast<unsigned long long>(the_time.tv_sec) < maxSecs);
+
+            if (!hasInvariantTsc())
+                return;
+
+            // calibrate the tick rate against the monotonic clock over ~10ms
+            const unsigned long long calibrationNanos = 10 * 1000 * 1000;
+            unsigned long long t0 = fallbackNow();
+            unsigned long long c0 = rdtsc();
+            unsigned long long t1;
+            do {
+                t1 = fallbackNow();
+            } while (t1 - t0 < calibrationNanos);
+            unsigned long long c1 = rdtsc();
+
+            if (c1 <= c0)
+                return;  // broken counter; stay on the fallback clock
+
+            Timer::_countsPerSecond = (c1 - c0) * Timer::nanosPerSecond / (t1 - t0);
+            usingTsc = true;
+        }
+
+#elif defined(MONGO_TIMER_IMPL_WIN32)
 
         AtStartup::AtStartup() {
             LARGE_INTEGER x;
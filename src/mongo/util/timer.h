@@ -49,15 +49,14 @@ namespace mongo {
          */
         inline int millisReset() {
             unsigned long long nextNow = now();
-            unsigned long long deltaMicros =
-                ((nextNow - _old) * microsPerSecond) / _countsPerSecond;
+            unsigned long long deltaMicros = _ticksToMicros(nextNow - _old);
 
             _old = nextNow;
             return static_cast<int>(deltaMicros / 1000);
         }
 
         inline unsigned long long micros() const {
-            return ((now() - _old) * microsPerSecond) / _countsPerSecond;
+            return _ticksToMicros(now() - _old);
         }
 
         inline void reset() { _old = now(); }
@@ -73,6 +72,17 @@ namespace mongo {
         static unsigned long long _countsPerSecond;
 
     private:
+        /**
+         * Split into whole seconds and a remainder so ticks * microsPerSecond
+         * can't overflow 64 bits when the tick frequency is in the GHz range
+         * (the TSC backend); the old single-divide form capped measurable
+         * spans at under two hours there.
+         */
+        static inline unsigned long long _ticksToMicros(unsigned long long ticks) {
+            return (ticks / _countsPerSecond) * microsPerSecond +
+                ((ticks % _countsPerSecond) * microsPerSecond) / _countsPerSecond;
+        }
+
         inline unsigned long long now() const;
 
         unsigned long long _old;
@@ -0,0 +1,84 @@
+// timer_wheel.cpp
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mongo/util/timer_wheel.h"
+
+#include "mongo/util/assert_util.h"
+
+namespace mongo {
+
+    TimerWheel::TimerWheel( unsigned tickMillis, unsigned numBuckets )
+        : _tickMillis( tickMillis ),
+          _numBuckets( numBuckets ),
+          _mutex( "TimerWheel" ),
+          _currentTick( 0 ),
+          _buckets( numBuckets ) {
+        verify( tickMillis > 0 );
+        verify( numBuckets > 1 );
+    }
+
+    void TimerWheel::schedule( unsigned long long id, unsigned long long deadlineMillis ) {
+        Entry e;
+        e.id = id;
+        e.deadlineMillis = deadlineMillis;
+
+        SimpleMutex::scoped_lock lk( _mutex );
+
+        unsigned long long tick = deadlineMillis / _tickMillis;
+        if ( tick < _currentTick ) {
+            // already overdue; the current tick's bucket is the next one swept
+            tick = _currentTick;
+        }
+        _buckets[ tick % _numBuckets ].push_back( e );
+    }
+
+    void TimerWheel::collectDue( unsigned long long nowMillis,
+                                 std::vector<unsigned long long>* due ) {
+        SimpleMutex::scoped_lock lk( _mutex );
+
+        unsigned long long targetTick = nowMillis / _tickMillis;
+        if ( targetTick < _currentTick )
+            return;
+
+        // one full rotation visits every bucket, so there is no point sweeping further
+        unsigned long long nTicks = targetTick - _currentTick + 1;
+        if ( nTicks > _numBuckets )
+            nTicks = _numBuckets;
+
+        for ( unsigned long long t = 0; t < nTicks; t++ ) {
+            std::vector<Entry>& bucket = _buckets[ ( _currentTick + t ) % _numBuckets ];
+
+            size_t keep = 0;
+            for ( size_t i = 0; i < bucket.size(); i++ ) {
+                if ( bucket[i].deadlineMillis <= nowMillis ) {
+                    due->push_back( bucket[i].id );
+                }
+                else {
+                    // visited a rotation early; stays for a later pass
+                    bucket[keep++] = bucket[i];
+                }
+            }
+            bucket.resize( keep );
+        }
+
+        // targetTick has only partially elapsed -- an entry later in it may not be due
+        // yet -- so resume from it rather than past it, or that entry would wait a full
+        // rotation for its bucket to come around again
+        _currentTick = targetTick;
+    }
+
+} // namespace mongo
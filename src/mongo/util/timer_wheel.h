@@ -0,0 +1,67 @@
+// timer_wheel.h
+
+/*    Copyright 2013 10gen Inc.
+ *
+ *    This program is free software: you can redistribute it and/or  modify
+ *    it under the terms of the GNU Affero General Public License, version 3,
+ *    as published by the Free Software Foundation.
+ *
+ *    This program is distributed in the hope that it will be useful,
+ *    but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *    MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *    GNU Affero General Public License for more details.
+ *
+ *    You should have received a copy of the GNU Affero General Public License
+ *    along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#pragma once
+
+#include <vector>
+
+#include "mongo/util/concurrency/mutex.h"
+
+namespace mongo {
+
+    /**
+     * A hashed timer wheel: deadlines hash into a ring of buckets by tick, so scheduling
+     * is O(1) and each sweep only looks at the buckets whose ticks have elapsed, making
+     * expiry processing proportional to (near-)due entries rather than to the total
+     * population.  There is no explicit cancel: entries are identified by an opaque id
+     * and callers simply ignore ids that no longer resolve to anything ("lazy cancel").
+     * An entry fires at most one tick-length late.  Thread safe.
+     */
+    class TimerWheel : boost::noncopyable {
+    public:
+        /**
+         * @param tickMillis  granularity of the wheel; deadlines are rounded up to it
+         * @param numBuckets  ring size; tickMillis * numBuckets is the span within which
+         *                    an entry is examined only once
+         */
+        TimerWheel( unsigned tickMillis, unsigned numBuckets );
+
+        /** registers 'id' to come due at 'deadlineMillis' (same clock as collectDue) */
+        void schedule( unsigned long long id, unsigned long long deadlineMillis );
+
+        /**
+         * advances the wheel to 'nowMillis' and appends the ids of all entries whose
+         * deadline has passed to *due.  entries visited early (deadline beyond the
+         * wheel's span) are kept for a later rotation.
+         */
+        void collectDue( unsigned long long nowMillis, std::vector<unsigned long long>* due );
+
+    private:
+        struct Entry {
+            unsigned long long id;
+            unsigned long long deadlineMillis;
+        };
+
+        const unsigned _tickMillis;
+        const unsigned _numBuckets;
+
+        SimpleMutex _mutex;
+        unsigned long long _currentTick;            // next tick to be swept
+        std::vector< std::vector<Entry> > _buckets; // protected by _mutex
+    };
+
+} // namespace mongo
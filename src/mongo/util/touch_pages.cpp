@@ -28,4 +28,8 @@ namespace mongo {
             _touch_pages_char_reader += buf[i];
         }
     }
+
+    void prefetch_pages( const char* buf, size_t length ) {
+        adviseWillNeed( const_cast<char*>( buf ), length );
+    }
 }
@@ -24,4 +24,9 @@ namespace mongo {
     // Takes a file descriptor, offset, and length, for Linux use.
     // Additionally takes an Extent pointer for use on other platforms.
     void touch_pages( const char* buf, size_t length );
+
+    // Hint to the OS that a range of pages will be needed soon, without
+    // blocking.  Unlike touch_pages this never faults the pages in
+    // synchronously; the read happens in the background.
+    void prefetch_pages( const char* buf, size_t length );
 }
@@ -19,6 +19,11 @@
 
 #include <boost/smart_ptr/scoped_array.hpp>
 
+#if defined(__x86_64__) || defined(_M_X64)
+#define MONGO_UNORDERED_FAST_KEY_TABLE_SSE2 1
+#include <emmintrin.h>
+#endif
+
 #include "mongo/base/disallow_copying.h"
 
 namespace mongo {
@@ -45,13 +50,20 @@ namespace mongo {
         typedef V mapped_type;
 
     private:
-        struct Entry {
-            Entry()
-                : used( false ), everUsed( false ) {
-            }
+        // Packed per-bucket metadata, one byte per bucket: kMetaEmpty for a
+        // never-used bucket, kMetaDeleted for an erased one, otherwise the low 7
+        // bits of the resident key's hash (its "fingerprint").  Probes scan this
+        // array - 16 buckets per SSE2 step on x86-64 - so full hash and key
+        // compares only happen on fingerprint hits.
+        static const unsigned char kMetaEmpty = 0x80;
+        static const unsigned char kMetaDeleted = 0xFE;
+
+        static unsigned char _fingerprintFor( size_t hash ) {
+            return static_cast<unsigned char>( hash & 0x7f );
+        }
 
-            bool used;
-            bool everUsed;
+        struct Entry {
+            // Only meaningful when the bucket's metadata says it's occupied.
             size_t curHash;
             value_type data;
         };
@@ -64,16 +76,21 @@ namespace mongo {
 
             bool transfer( Area* newArea, const UnorderedFastKeyTable& sm ) const;
 
+            // Does the bucket at pos hold a live entry?
+            bool _occupied( unsigned pos ) const { return _meta[pos] < kMetaEmpty; }
+
             void swap( Area* other ) {
                 using std::swap;
                 swap( _capacity, other->_capacity );
                 swap( _maxProbe, other->_maxProbe );
                 swap( _entries, other->_entries );
+                swap( _meta, other->_meta );
             }
 
             unsigned _capacity;
             unsigned _maxProbe;
             boost::scoped_array<Entry> _entries;
+            boost::scoped_array<unsigned char> _meta;
         };
 
     public:
@@ -159,7 +176,7 @@ namespace mongo {
 
             void _skip() {
                 while ( true ) {
-                    if ( _area->_entries[_position].used )
+                    if ( _area->_occupied( _position ) )
                         break;
                     if ( _position >= _max ) {
                         _position = -1;
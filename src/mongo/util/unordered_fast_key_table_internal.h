@@ -16,6 +16,8 @@
  *    limitations under the License.
  */
 
+#include <cstring>
+
 #include "mongo/util/assert_util.h"
 
 namespace mongo {
@@ -24,17 +26,21 @@ namespace mongo {
                                                                    double maxProbeRatio)
         : _capacity( capacity ),
           _maxProbe( static_cast<unsigned>( capacity * maxProbeRatio ) ),
-          _entries( new Entry[_capacity] ) {
+          _entries( new Entry[_capacity] ),
+          _meta( new unsigned char[_capacity] ) {
+        memset( _meta.get(), kMetaEmpty, _capacity );
     }
 
     template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
     inline UnorderedFastKeyTable<K_L, K_S, V, H, E, C, C_LS>::Area::Area(const Area& other )
         : _capacity( other._capacity ),
           _maxProbe( other._maxProbe ),
-          _entries( new Entry[_capacity] ) {
+          _entries( new Entry[_capacity] ),
+          _meta( new unsigned char[_capacity] ) {
         for ( unsigned i = 0; i < _capacity; i++ ) {
             _entries[i] = other._entries[i];
         }
+        memcpy( _meta.get(), other._meta.get(), _capacity );
     }
 
     template< typename K_L, typename K_S, typename V, typename H, typename E, typename C, typename C_LS >
@@ -46,26 +52,85 @@ namespace mongo {
         if ( firstEmpty )
             *firstEmpty = -1;
 
-        for ( unsigned probe = 0; probe < _maxProbe; probe++ ) {
+        const unsigned char fingerprint = _fingerprintFor( hash );
+
+        unsigned probe = 0;
+        while ( probe < _maxProbe ) {
             unsigned pos = (hash + probe) % _capacity;
 
-            if ( ! _entries[pos].used ) {
-                // space is empty
+#if defined(MONGO_UNORDERED_FAST_KEY_TABLE_SSE2)
+            // Scan 16 buckets at a time once a probe sequence has shown itself to
+            // be long; the table is kept sparse enough that most lookups resolve
+            // in the first couple of buckets, where the scalar step's single byte
+            // compare beats the vector setup.  The wrap-around tail also falls
+            // through to the scalar step.
+            if ( probe >= 4 && probe + 16 <= _maxProbe && pos + 16 <= _capacity ) {
+                const __m128i group =
+                    _mm_loadu_si128( reinterpret_cast<const __m128i*>( &_meta[pos] ) );
+
+                // Buckets whose fingerprint matches: candidates for a full compare.
+                int hits = _mm_movemask_epi8(
+                    _mm_cmpeq_epi8( group, _mm_set1_epi8( static_cast<char>( fingerprint ) ) ) );
+                // Never-used buckets: the probe sequence ends at the first one.
+                const int empties = _mm_movemask_epi8(
+                    _mm_cmpeq_epi8( group, _mm_set1_epi8( static_cast<char>( kMetaEmpty ) ) ) );
+
+                if ( firstEmpty && *firstEmpty == -1 ) {
+                    // Empty and deleted buckets both have the metadata high bit set.
+                    const int frees = _mm_movemask_epi8( group );
+                    if ( frees )
+                        *firstEmpty = pos + __builtin_ctz( frees );
+                }
+
+                if ( empties ) {
+                    // Only hits before the first never-used bucket are reachable.
+                    hits &= ( 1 << __builtin_ctz( empties ) ) - 1;
+                }
+
+                while ( hits ) {
+                    const unsigned where = pos + __builtin_ctz( hits );
+                    hits &= hits - 1;
+                    if ( _entries[where].curHash == hash &&
+                         sm._equals( key, sm._convertor( _entries[where].data.first ) ) ) {
+                        return where;
+                    }
+                }
+
+                if ( empties )
+                    return -1;
+
+                probe += 16;
+                continue;
+            }
+#endif
+
+#if defined(__GNUC__)
+            // The entry load depends on the metadata compare; start it early so a
+            // fingerprint hit doesn't pay two serialized cache misses.
+            __builtin_prefetch( &_entries[pos] );
+#endif
+            const unsigned char meta = _meta[pos];
+
+            if ( meta & 0x80 ) {
+                // space is empty or deleted
                 if ( firstEmpty && *firstEmpty == -1 )
                     *firstEmpty = pos;
-                if ( ! _entries[pos].everUsed )
+                if ( meta == kMetaEmpty )
                     return -1;
+                probe++;
                 continue;
             }
 
-            if ( _entries[pos].curHash != hash ) {
+            if ( meta != fingerprint || _entries[pos].curHash != hash ) {
                 // space has something else
+                probe++;
                 continue;
             }
 
             if ( ! sm._equals(key, sm._convertor( _entries[pos].data.first ) ) ) {
-                // hashes match
+                // fingerprints and hashes match
                 // strings are not equals
+                probe++;
                 continue;
             }
 
@@ -81,7 +146,7 @@ namespace mongo {
             Area* newArea,
             const UnorderedFastKeyTable& sm) const {
         for ( unsigned i = 0; i < _capacity; i++ ) {
-            if ( ! _entries[i].used )
+            if ( ! _occupied( i ) )
                 continue;
 
             int firstEmpty = -1;
@@ -96,6 +161,7 @@ namespace mongo {
             }
 
             newArea->_entries[firstEmpty] = _entries[i];
+            newArea->_meta[firstEmpty] = _fingerprintFor( _entries[i].curHash );
         }
         return true;
     }
@@ -143,8 +209,7 @@ namespace mongo {
             // need to add
             if ( firstEmpty >= 0 ) {
                 _size++;
-                _area._entries[firstEmpty].used = true;
-                _area._entries[firstEmpty].everUsed = true;
+                _area._meta[firstEmpty] = _fingerprintFor( hash );
                 _area._entries[firstEmpty].curHash = hash;
                 _area._entries[firstEmpty].data.first = _convertorOther(key);
                 return _area._entries[firstEmpty].data.second;
@@ -165,7 +230,8 @@ namespace mongo {
         if ( pos < 0 )
             return 0;
 
-        _area._entries[pos].used = false;
+        _size--;
+        _area._meta[pos] = kMetaDeleted;
         _area._entries[pos].data.second = V();
         return 1;
     }
@@ -175,7 +241,8 @@ namespace mongo {
         dassert(it._position >= 0);
         dassert(it._area == &_area);
 
-        _area._entries[it._position].used = false;
+        _size--;
+        _area._meta[it._position] = kMetaDeleted;
         _area._entries[it._position].data.second = V();
     }
 